@@ -18,8 +18,11 @@
 #ifndef itkAnalyticSignalImageFilter_h
 #define itkAnalyticSignalImageFilter_h
 
+#include <algorithm>
 #include <complex>
+#include <vector>
 
+#include "UltrasoundExport.h"
 #include "itkComplexToComplex1DFFTImageFilter.h"
 #include "itkForward1DFFTImageFilter.h"
 #include "itkFrequencyDomain1DImageFilter.h"
@@ -52,7 +55,8 @@ namespace itk
  * \ingroup FourierTransform
  * \ingroup Ultrasound
  */
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage,
+          typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
 class ITK_TEMPLATE_EXPORT AnalyticSignalImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
 {
 public:
@@ -98,6 +102,10 @@ public:
     }
   }
 
+  /** Set a frequency filter to apply to the spectrum.  Only the filter
+   * function of the frequency filter is used: it is multiplied into the
+   * spectrum in the same pass as the analytic signal mask, so filtering
+   * costs no additional image pass or allocation. */
   virtual void
   SetFrequencyFilter(FrequencyFilterType * filter)
   {
@@ -108,6 +116,41 @@ public:
       this->Modified();
     }
   }
+  itkGetModifiableObjectMacro(FrequencyFilter, FrequencyFilterType);
+
+  /** When on, the one-sided spectrum weights are applied in place to the
+   * output of the forward FFT, and the inverse FFT writes into that same
+   * buffer, which becomes the output.  This saves two complex image
+   * allocations and one copy pass.  Off by default. */
+  itkSetMacro(InPlace, bool);
+  itkGetConstMacro(InPlace, bool);
+  itkBooleanMacro(InPlace);
+
+  /** Set/Get the planner rigor, e.g. FFTW_ESTIMATE or FFTW_MEASURE, of the
+   * internal FFT filters when they use FFTW, see
+   * FFTWForward1DFFTImageFilter::SetPlanRigor().  The other backends ignore
+   * it.  The default is the one of the FFTW filters,
+   * FFTWGlobalConfiguration::GetPlanRigor(). */
+  virtual void
+  SetPlanRigor(int value);
+  itkGetConstMacro(PlanRigor, int);
+
+  /** Get the greatest prime factor of the line length that both of the FFT
+   * backends used internally support efficiently. */
+  virtual SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    return std::min(this->m_FFTRealToComplexFilter->GetSizeGreatestPrimeFactor(),
+                    this->m_FFTComplexToComplexFilter->GetSizeGreatestPrimeFactor());
+  }
+
+  /** Estimate, in bytes, the complex images that an update of the given
+   * output region allocates, including the output: one in place, the
+   * spectrum, the weighted spectrum and the inverse transform otherwise.
+   * The region is enlarged along the direction of the transform, as in an
+   * update.  The input is not counted, and nothing is computed. */
+  SizeValueType
+  EstimateMemoryFootprint(const OutputImageRegionType & region) const;
 
 protected:
   AnalyticSignalImageFilter();
@@ -122,6 +165,11 @@ protected:
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
+  /** Allocate the output with AllocateFirstTouch(), so that its pages are
+   * first touched by the work units that generate them. */
+  void
+  AllocateOutputs() override;
+
   void
   GenerateData() override;
 
@@ -131,8 +179,29 @@ protected:
   using FFTComplexToComplexType = ComplexToComplex1DFFTImageFilter<OutputImageType, OutputImageType>;
   typename FFTComplexToComplexType::Pointer m_FFTComplexToComplexFilter;
 
+  using SpectrumValueType = typename NumericTraits<typename OutputImageType::PixelType>::ValueType;
+
+  /** Compute the one-sided spectrum weights for lines of the given size,
+   * unless they are up to date. */
+  void
+  UpdateSpectrumWeights(SizeValueType size);
+  const std::vector<SpectrumValueType> &
+  GetSpectrumWeights() const
+  {
+    return m_SpectrumWeights;
+  }
+
 private:
+
   typename FrequencyFilterType::Pointer m_FrequencyFilter;
+
+  bool m_InPlace;
+  int  m_PlanRigor;
+
+  /** One-sided spectrum weights for lines of the last size processed,
+   * including the transfer function of the frequency filter, if any. */
+  std::vector<SpectrumValueType> m_SpectrumWeights;
+  bool                           m_SpectrumWeightsFiltered;
 };
 } // namespace itk
 
@@ -140,4 +209,18 @@ private:
 #  include "itkAnalyticSignalImageFilter.hxx"
 #endif
 
+// The common instantiations are compiled into the Ultrasound library.
+#if !defined(ITK_TEMPLATE_EXPLICIT_AnalyticSignalImageFilter)
+namespace itk
+{
+ITK_GCC_PRAGMA_DIAG_PUSH()
+ITK_GCC_PRAGMA_DIAG(ignored "-Wattributes")
+extern template class Ultrasound_EXPORT_EXPLICIT AnalyticSignalImageFilter<Image<float, 2>>;
+extern template class Ultrasound_EXPORT_EXPLICIT AnalyticSignalImageFilter<Image<float, 3>>;
+extern template class Ultrasound_EXPORT_EXPLICIT AnalyticSignalImageFilter<Image<double, 2>>;
+extern template class Ultrasound_EXPORT_EXPLICIT AnalyticSignalImageFilter<Image<double, 3>>;
+ITK_GCC_PRAGMA_DIAG_POP()
+} // end namespace itk
+#endif
+
 #endif // itkAnalyticSignalImageFilter_h
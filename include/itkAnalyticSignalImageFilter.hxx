@@ -19,6 +19,8 @@
 #define itkAnalyticSignalImageFilter_hxx
 
 #include "itkAnalyticSignalImageFilter.h"
+#include "itkAnalyticSignalLineTransform.h"
+#include "itkFirstTouchImageContainer.h"
 
 #include "itkVnlForward1DFFTImageFilter.h"
 #include "itkVnlComplexToComplex1DFFTImageFilter.h"
@@ -28,17 +30,69 @@
 #  include "itkFFTWComplexToComplex1DFFTImageFilter.h"
 #endif
 
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
 
 namespace itk
 {
 
+template <typename TForward, typename TComplexToComplex, typename TPixel>
+struct Dispatch_AnalyticSignal_FFTW_SetPlanRigor
+{
+  static void
+  Apply(TForward *, TComplexToComplex *, int)
+  {}
+};
+
+#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
+template <typename TForward, typename TComplexToComplex>
+struct Dispatch_AnalyticSignal_FFTW_SetPlanRigorImpl
+{
+  static void
+  Apply(TForward * forward, TComplexToComplex * complexToComplex, int planRigor)
+  {
+    using FFTWForwardType =
+      FFTWForward1DFFTImageFilter<typename TForward::InputImageType, typename TForward::OutputImageType>;
+    using FFTWComplexToComplexType =
+      FFTWComplexToComplex1DFFTImageFilter<typename TComplexToComplex::InputImageType,
+                                           typename TComplexToComplex::OutputImageType>;
+    if (auto * fftwForward = dynamic_cast<FFTWForwardType *>(forward))
+    {
+      fftwForward->SetPlanRigor(planRigor);
+    }
+    if (auto * fftwComplexToComplex = dynamic_cast<FFTWComplexToComplexType *>(complexToComplex))
+    {
+      fftwComplexToComplex->SetPlanRigor(planRigor);
+    }
+  }
+};
+#endif
+
+#ifdef ITK_USE_FFTWD
+template <typename TForward, typename TComplexToComplex>
+struct Dispatch_AnalyticSignal_FFTW_SetPlanRigor<TForward, TComplexToComplex, double>
+  : Dispatch_AnalyticSignal_FFTW_SetPlanRigorImpl<TForward, TComplexToComplex>
+{};
+#endif
+
+#ifdef ITK_USE_FFTWF
+template <typename TForward, typename TComplexToComplex>
+struct Dispatch_AnalyticSignal_FFTW_SetPlanRigor<TForward, TComplexToComplex, float>
+  : Dispatch_AnalyticSignal_FFTW_SetPlanRigorImpl<TForward, TComplexToComplex>
+{};
+#endif
+
+
 template <typename TInputImage, typename TOutputImage>
 AnalyticSignalImageFilter<TInputImage, TOutputImage>::AnalyticSignalImageFilter()
+  : m_InPlace(false)
+  , m_PlanRigor(static_cast<int>(AnalyticSignalLineTransform<SpectrumValueType>::GetDefaultPlanRigor()))
+  , m_SpectrumWeightsFiltered(false)
 {
   m_FFTRealToComplexFilter = FFTRealToComplexType::New();
+  // The negative frequencies are discarded below, so there is no need to
+  // reconstruct them from Hermitian symmetry.
+  m_FFTRealToComplexFilter->FullSpectrumOff();
   m_FFTComplexToComplexFilter = FFTComplexToComplexType::New();
   m_FFTComplexToComplexFilter->SetTransformDirection(FFTComplexToComplexType::INVERSE);
 
@@ -46,6 +100,20 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::AnalyticSignalImageFilter(
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::SetPlanRigor(int value)
+{
+  if (m_PlanRigor != value)
+  {
+    m_PlanRigor = value;
+    Dispatch_AnalyticSignal_FFTW_SetPlanRigor<FFTRealToComplexType, FFTComplexToComplexType, SpectrumValueType>::Apply(
+      m_FFTRealToComplexFilter.GetPointer(), m_FFTComplexToComplexFilter.GetPointer(), value);
+    this->Modified();
+  }
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
@@ -115,6 +183,35 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegi
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::AllocateOutputs()
+{
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  AllocateFirstTouch(output, this->GetMultiThreader(), this->GetNumberOfWorkUnits(), this->GetDirection());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+SizeValueType
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::EstimateMemoryFootprint(
+  const OutputImageRegionType & region) const
+{
+  OutputImageRegionType         enlargedRegion = region;
+  const unsigned int            direction = this->GetDirection();
+  const OutputImageRegionType & largestRegion = this->GetOutput()->GetLargestPossibleRegion();
+  if (largestRegion.GetNumberOfPixels() > 0)
+  {
+    enlargedRegion.SetIndex(direction, largestRegion.GetIndex(direction));
+    enlargedRegion.SetSize(direction, largestRegion.GetSize(direction));
+  }
+
+  const SizeValueType numberOfImages = m_InPlace ? 1 : 3;
+  return numberOfImages * enlargedRegion.GetNumberOfPixels() * sizeof(typename OutputImageType::PixelType);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 AnalyticSignalImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -123,6 +220,8 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & o
 
   const unsigned int direction = this->GetDirection();
   os << indent << "Direction: " << direction << std::endl;
+  os << indent << "InPlace: " << m_InPlace << std::endl;
+  os << indent << "PlanRigor: " << m_PlanRigor << std::endl;
 
   os << indent << "FFTRealToComplexFilter: " << std::endl;
   m_FFTRealToComplexFilter->Print(os, indent);
@@ -138,105 +237,109 @@ AnalyticSignalImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & o
 
 template <typename TInputImage, typename TOutputImage>
 void
-AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateData()
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::UpdateSpectrumWeights(SizeValueType size)
 {
-  this->AllocateOutputs();
-
-  OutputImageType * output = this->GetOutput();
-
-  m_FFTRealToComplexFilter->SetInput(this->GetInput());
-  if (m_FrequencyFilter.IsNotNull())
+  const bool filtered = m_FrequencyFilter.IsNotNull();
+  if (m_SpectrumWeights.size() != size || filtered || m_SpectrumWeightsFiltered)
   {
-    m_FrequencyFilter->SetInput(m_FFTRealToComplexFilter->GetOutput());
-    m_FrequencyFilter->GetOutput()->SetRequestedRegion(output->GetRequestedRegion());
-    m_FrequencyFilter->GetOutput()->SetLargestPossibleRegion(output->GetLargestPossibleRegion());
-    m_FrequencyFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-    m_FrequencyFilter->Update();
+    // The inverse FFT takes care of the normalization.
+    m_SpectrumWeights.resize(size);
+    AnalyticSignalLineTransformBase<SpectrumValueType>::FillOneSidedWeights(
+      m_SpectrumWeights.data(), size, static_cast<SpectrumValueType>(1));
+    if (filtered)
+    {
+      // Fold the transfer function of the frequency filter into the
+      // weights instead of running the filter over the spectrum image.
+      FrequencyDomain1DFilterFunction * filterFunction = m_FrequencyFilter->GetModifiableFilterFunction();
+      filterFunction->Precompute(size);
+      for (SizeValueType ii = 0; ii < size; ++ii)
+      {
+        m_SpectrumWeights[ii] *= static_cast<SpectrumValueType>(filterFunction->EvaluateIndex(ii));
+      }
+    }
+    m_SpectrumWeightsFiltered = filtered;
   }
-  else
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+AnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  // In place, the output buffer is the one of the forward FFT.
+  if (!m_InPlace)
   {
-    m_FFTRealToComplexFilter->GetOutput()->SetRequestedRegion(output->GetRequestedRegion());
-    m_FFTRealToComplexFilter->GetOutput()->SetLargestPossibleRegion(output->GetLargestPossibleRegion());
-    m_FFTRealToComplexFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-    m_FFTRealToComplexFilter->Update();
+    this->AllocateOutputs();
   }
 
+  OutputImageType * output = this->GetOutput();
+
+  // Shallow copy of the input, so that the internal pipeline only processes
+  // the requested region and does not update the upstream pipeline.
+  typename InputImageType::Pointer localInput = InputImageType::New();
+  localInput->Graft(this->GetInput());
+  m_FFTRealToComplexFilter->SetInput(localInput);
+  m_FFTRealToComplexFilter->GetOutput()->SetRequestedRegion(output->GetRequestedRegion());
+  m_FFTRealToComplexFilter->GetOutput()->SetLargestPossibleRegion(output->GetLargestPossibleRegion());
+  m_FFTRealToComplexFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  m_FFTRealToComplexFilter->Update();
+
   // get pointers to the input and output
-  const typename FFTRealToComplexType::OutputImageType * input;
-  if (m_FrequencyFilter.IsNotNull())
-  {
-    input = m_FrequencyFilter->GetOutput();
-  }
-  else
-  {
-    input = m_FFTRealToComplexFilter->GetOutput();
-  }
+  OutputImageType * spectrum = m_FFTRealToComplexFilter->GetOutput();
+  OutputImageType * masked = m_InPlace ? spectrum : output;
 
-  const typename FFTRealToComplexType::OutputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
-  const unsigned int                                               direction = this->GetDirection();
-  const unsigned int                                               size = inputSize[direction];
-  unsigned int                                                     dubSize;
-  bool                                                             even;
-  if (size % 2 == 0)
-  {
-    even = true;
-    dubSize = size / 2 - 1;
-  }
-  else
-  {
-    even = false;
-    dubSize = (size + 1) / 2 - 1;
-  }
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType size = spectrum->GetRequestedRegion().GetSize()[direction];
+  this->UpdateSpectrumWeights(size);
 
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
   multiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
     direction,
-    output->GetRequestedRegion(),
-    [this, dubSize, even, input](const typename OutputImageType::RegionType & lambdaRegion) {
-      OutputImageType *  output = this->GetOutput();
-      const unsigned int direction = this->GetDirection();
-
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<typename FFTRealToComplexType::OutputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+    masked->GetRequestedRegion(),
+    [this, spectrum, masked, direction, size](const typename OutputImageType::RegionType & lambdaRegion) {
+      using PixelType = typename OutputImageType::PixelType;
+      const SpectrumValueType * weights = this->m_SpectrumWeights.data();
+      const OffsetValueType     inputStride = spectrum->GetOffsetTable()[direction];
+      const OffsetValueType     outputStride = masked->GetOffsetTable()[direction];
+      const PixelType *         inputBuffer = spectrum->GetBufferPointer();
+      PixelType *               outputBuffer = masked->GetBufferPointer();
+
+      // Visit the first sample of every fft line; the lines are then
+      // addressed directly in the buffers, so that the contiguous case
+      // vectorizes.
+      typename OutputImageType::RegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(direction, 1);
+      ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(masked, lineStartRegion);
+      for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
       {
-        inputIt.GoToBeginOfLine();
-        outputIt.GoToBeginOfLine();
-
-        // DC
-        outputIt.Set(inputIt.Get());
-        ++inputIt;
-        ++outputIt;
-        for (unsigned int i = 0; i < dubSize; i++)
+        const PixelType * inputLine = inputBuffer + spectrum->ComputeOffset(lineIt.GetIndex());
+        PixelType *       outputLine = outputBuffer + masked->ComputeOffset(lineIt.GetIndex());
+        if (inputStride == 1 && outputStride == 1)
         {
-          outputIt.Set(inputIt.Get() * static_cast<typename TInputImage::PixelType>(2));
-          ++outputIt;
-          ++inputIt;
+          for (SizeValueType ii = 0; ii < size; ++ii)
+          {
+            outputLine[ii] = inputLine[ii] * weights[ii];
+          }
         }
-        if (even)
+        else
         {
-          outputIt.Set(inputIt.Get());
-          ++inputIt;
-          ++outputIt;
-        }
-        while (!outputIt.IsAtEndOfLine())
-        {
-          outputIt.Set(static_cast<typename TInputImage::PixelType>(0));
-          ++outputIt;
+          for (SizeValueType ii = 0; ii < size; ++ii)
+          {
+            outputLine[ii * outputStride] = inputLine[ii * inputStride] * weights[ii];
+          }
         }
       }
     },
     this);
 
   // Trippy, eh?
-  m_FFTComplexToComplexFilter->SetInput(output);
+  m_FFTComplexToComplexFilter->SetInput(masked);
+  if (m_InPlace)
+  {
+    // The inverse transform writes into the buffer it reads from.
+    m_FFTComplexToComplexFilter->GraftOutput(masked);
+  }
   m_FFTComplexToComplexFilter->GetOutput()->SetRequestedRegion(output->GetRequestedRegion());
   m_FFTComplexToComplexFilter->GetOutput()->SetLargestPossibleRegion(output->GetLargestPossibleRegion());
   m_FFTComplexToComplexFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
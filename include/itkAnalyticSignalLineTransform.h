@@ -0,0 +1,312 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyticSignalLineTransform_h
+#define itkAnalyticSignalLineTransform_h
+
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+#include "itkNumericTraits.h"
+#include "vnl/algo/vnl_fft_1d.h"
+#include "vnl/vnl_vector.h"
+
+#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
+#  include "itkFFTW1DPlanCache.h"
+#  include "itkFFTWBufferPool.h"
+#endif
+
+namespace itk
+{
+
+/** Whether AnalyticSignalLineTransform uses FFTW for the given precision. */
+template <typename TPixel>
+struct AnalyticSignalLineTransformUsesFFTW : std::false_type
+{};
+#ifdef ITK_USE_FFTWD
+template <>
+struct AnalyticSignalLineTransformUsesFFTW<double> : std::true_type
+{};
+#endif
+#ifdef ITK_USE_FFTWF
+template <>
+struct AnalyticSignalLineTransformUsesFFTW<float> : std::true_type
+{};
+#endif
+
+/** \class AnalyticSignalLineTransformBase
+ * \brief Spectrum operations shared by the AnalyticSignalLineTransform
+ * implementations.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TPixel>
+class AnalyticSignalLineTransformBase
+{
+public:
+  using PixelType = TPixel;
+  using ComplexType = std::complex<TPixel>;
+
+  /** Fill size weights that keep the DC and Nyquist bins, double the
+   * positive frequencies and zero the negative frequencies of a spectrum of
+   * size bins, all times scale.  Pass 1 / size as the scale to include the
+   * normalization of the inverse transform. */
+  static void
+  FillOneSidedWeights(PixelType * weights, SizeValueType size, PixelType scale)
+  {
+    const SizeValueType positiveEnd = (size + 1) / 2;
+    std::fill(weights, weights + size, static_cast<PixelType>(0));
+    weights[0] = scale;
+    std::fill(weights + 1, weights + positiveEnd, static_cast<PixelType>(2) * scale);
+    if (size % 2 == 0)
+    {
+      weights[size / 2] = scale;
+    }
+  }
+
+  /** Multiply the non-negative frequencies, the first size / 2 + 1 bins, of
+   * a spectrum by the weights and zero the negative frequencies, whatever
+   * their weights.  Since the negative frequencies are not read, the
+   * spectrum may come from a real-to-complex transform. */
+  static void
+  ApplyOneSidedWeights(ComplexType * spectrum, const PixelType * weights, SizeValueType size)
+  {
+    const SizeValueType halfSize = size / 2 + 1;
+    for (SizeValueType ii = 0; ii < halfSize; ++ii)
+    {
+      spectrum[ii] *= weights[ii];
+    }
+    std::fill(spectrum + halfSize, spectrum + size, ComplexType(0, 0));
+  }
+};
+
+
+/**
+ * \class AnalyticSignalLineTransform
+ * \brief Compute the analytic signal of one line at a time in a scratch
+ * buffer.
+ *
+ * This is the per-line building block of AnalyticSignalImageFilter for
+ * filters that fuse the analytic signal with further per-sample operations,
+ * such as BModeImageFilter, and that do not want to allocate the complex
+ * intermediate images.  An instance is meant to be created per work unit.
+ *
+ * Fill the first samples of GetInputBuffer() with a line, call Compute()
+ * with the number of samples written; the remainder of the buffer is zero
+ * padded.  The analytic signal of the padded line is then available in
+ * GetOutputBuffer().  Compute() multiplies the spectrum by precomputed
+ * weights, see FillOneSidedWeights() with a scale of 1 / GetSize(), which
+ * can be shared by all the work units and also include a frequency domain
+ * filter.
+ *
+ * FFTW is used when it is available for TPixel, the VNL FFT otherwise.
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ */
+template <typename TPixel, bool VUseFFTW = AnalyticSignalLineTransformUsesFFTW<TPixel>::value>
+class AnalyticSignalLineTransform : public AnalyticSignalLineTransformBase<TPixel>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(AnalyticSignalLineTransform);
+
+  using Superclass = AnalyticSignalLineTransformBase<TPixel>;
+  using PixelType = typename Superclass::PixelType;
+  using ComplexType = typename Superclass::ComplexType;
+
+  /** Prepare the transform of lines of size samples, after zero padding.
+   * The size must only have prime factors up to
+   * GetSizeGreatestPrimeFactor().  The VNL FFT does not plan, so the
+   * planner rigor is ignored. */
+  explicit AnalyticSignalLineTransform(SizeValueType size, unsigned = 0)
+    : m_Size(size)
+    , m_InputBuffer(size)
+    , m_Buffer(size)
+    , m_FFT(size)
+  {}
+
+  /** The VNL FFT supports sizes whose prime factors are 2, 3 and 5. */
+  static SizeValueType
+  GetSizeGreatestPrimeFactor()
+  {
+    return 5;
+  }
+
+  /** The planner rigor passed by default to the constructor. */
+  static unsigned
+  GetDefaultPlanRigor()
+  {
+    return 0;
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  PixelType *
+  GetInputBuffer()
+  {
+    return m_InputBuffer.data_block();
+  }
+
+  const ComplexType *
+  GetOutputBuffer() const
+  {
+    return m_Buffer.data_block();
+  }
+
+  /** Compute the analytic signal of the first inputLength samples of the
+   * input buffer.  weights holds GetSize() spectrum weights. */
+  void
+  Compute(SizeValueType inputLength, const PixelType * weights)
+  {
+    for (SizeValueType ii = 0; ii < inputLength; ++ii)
+    {
+      m_Buffer[ii] = ComplexType(m_InputBuffer[ii], 0);
+    }
+    std::fill(m_Buffer.begin() + inputLength, m_Buffer.end(), ComplexType(0, 0));
+
+    // VNL's backward transform has the sign of the forward DFT.
+    m_FFT.bwd_transform(m_Buffer);
+    Superclass::ApplyOneSidedWeights(m_Buffer.data_block(), weights, m_Size);
+    m_FFT.fwd_transform(m_Buffer);
+  }
+
+private:
+  SizeValueType                                            m_Size;
+  vnl_vector<PixelType>                                    m_InputBuffer;
+  vnl_vector<ComplexType>                                  m_Buffer;
+  vnl_fft_1d<typename NumericTraits<PixelType>::ValueType> m_FFT;
+};
+
+
+#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
+/** The FFTW implementation runs a real-to-complex transform into the
+ * complex buffer, so only the non-negative frequencies are computed, and an
+ * in-place inverse transform.  The plans are shared through
+ * fftw::Plan1DCache and the buffers come from fftw::BufferPool. */
+template <typename TPixel>
+class AnalyticSignalLineTransform<TPixel, true> : public AnalyticSignalLineTransformBase<TPixel>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(AnalyticSignalLineTransform);
+
+  using Superclass = AnalyticSignalLineTransformBase<TPixel>;
+  using PixelType = typename Superclass::PixelType;
+  using ComplexType = typename Superclass::ComplexType;
+
+  using PlanCacheType = fftw::Plan1DCache<TPixel>;
+  using BufferPoolType = fftw::BufferPool<TPixel>;
+  using ProxyType = typename PlanCacheType::ProxyType;
+  using FFTWComplexType = typename ProxyType::ComplexType;
+  using PlanType = typename ProxyType::PlanType;
+
+  /** The flags are the planner rigor of the plans, e.g. FFTW_ESTIMATE or
+   * FFTW_MEASURE, as for FFTWForward1DFFTImageFilter::SetPlanRigor(). */
+  explicit AnalyticSignalLineTransform(SizeValueType size, unsigned flags = GetDefaultPlanRigor())
+    : m_Size(size)
+  {
+    // The real input buffer is counted in complex elements.
+    m_InputBuffer = BufferPoolType::Acquire(size / 2 + 1);
+    m_Buffer = BufferPoolType::Acquire(size);
+    if (m_InputBuffer == nullptr || m_Buffer == nullptr)
+    {
+      BufferPoolType::Release(m_InputBuffer);
+      BufferPoolType::Release(m_Buffer);
+      itkGenericExceptionMacro("Problem allocating memory for the analytic signal line transform");
+    }
+    const int length = static_cast<int>(size);
+    const int inputAlignment = ProxyType::Alignment_of(this->GetInputBuffer());
+    const int outputAlignment = ProxyType::Alignment_of(reinterpret_cast<PixelType *>(m_Buffer));
+    m_ForwardPlan = PlanCacheType::GetManyRealToComplexPlan(
+      length, 1, 1, length, 1, length / 2 + 1, flags, inputAlignment, outputAlignment);
+    m_InversePlan = PlanCacheType::GetManyComplexToComplexPlan(
+      length, 1, 1, length, 1, length, FFTW_BACKWARD, flags, outputAlignment, outputAlignment, true);
+  }
+
+  ~AnalyticSignalLineTransform()
+  {
+    BufferPoolType::Release(m_InputBuffer);
+    BufferPoolType::Release(m_Buffer);
+  }
+
+  /** FFTW transforms any size, but it only has optimized codelets for the
+   * prime factors up to 13. */
+  static SizeValueType
+  GetSizeGreatestPrimeFactor()
+  {
+    return 13;
+  }
+
+  /** The planner rigor of the FFTW filters, by default
+   * FFTWGlobalConfiguration::GetPlanRigor(). */
+  static unsigned
+  GetDefaultPlanRigor()
+  {
+#  ifndef ITK_USE_CUFFTW
+    return static_cast<unsigned>(FFTWGlobalConfiguration::GetPlanRigor());
+#  else
+    return FFTW_ESTIMATE;
+#  endif
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  PixelType *
+  GetInputBuffer()
+  {
+    return reinterpret_cast<PixelType *>(m_InputBuffer);
+  }
+
+  const ComplexType *
+  GetOutputBuffer() const
+  {
+    return reinterpret_cast<const ComplexType *>(m_Buffer);
+  }
+
+  void
+  Compute(SizeValueType inputLength, const PixelType * weights)
+  {
+    PixelType * input = this->GetInputBuffer();
+    std::fill(input + inputLength, input + m_Size, static_cast<PixelType>(0));
+
+    ProxyType::Execute_dft_r2c(m_ForwardPlan, input, m_Buffer);
+    Superclass::ApplyOneSidedWeights(reinterpret_cast<ComplexType *>(m_Buffer), weights, m_Size);
+    ProxyType::Execute_dft(m_InversePlan, m_Buffer, m_Buffer);
+  }
+
+private:
+  SizeValueType     m_Size;
+  FFTWComplexType * m_InputBuffer = nullptr;
+  FFTWComplexType * m_Buffer = nullptr;
+  PlanType          m_ForwardPlan;
+  PlanType          m_InversePlan;
+};
+#endif
+
+} // end namespace itk
+
+#endif // itkAnalyticSignalLineTransform_h
@@ -18,19 +18,63 @@
 #ifndef itkBModeImageFilter_h
 #define itkBModeImageFilter_h
 
+#include <cmath>
+
+#include "UltrasoundExport.h"
 #include "itkAddImageFilter.h"
 #include "itkComplexToModulusImageFilter.h"
 #include "itkConstantPadImageFilter.h"
 #include "itkRegionFromReferenceImageFilter.h"
 #include "itkImageToImageFilter.h"
 #include "itkImage.h"
-#include "itkLog10ImageFilter.h"
+#include "itkQuadratureDemodulationImageFilter.h"
+#include "itkTimeGainCompensationImageFilter.h"
+#include "itkUnaryFunctorImageFilter.h"
 
 #include "itkAnalyticSignalImageFilter.h"
+#include "itkAnalyticSignalLineTransform.h"
 
 namespace itk
 {
 
+namespace Functor
+{
+/**
+ * \class BModeLog10
+ * \brief Logarithmic intensity transform of the B-Mode envelope.
+ *
+ * Unlike Functor::Log10, which goes through double, the logarithm is taken
+ * in the floating point precision of the output pixel, so that a float
+ * pipeline stays in float.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInput, typename TOutput>
+class BModeLog10
+{
+public:
+  using RealType = typename NumericTraits<TOutput>::FloatType;
+
+  bool
+  operator==(const BModeLog10 &) const
+  {
+    return true;
+  }
+
+  bool
+  operator!=(const BModeLog10 & other) const
+  {
+    return !(*this == other);
+  }
+
+  inline TOutput
+  operator()(const TInput & A) const
+  {
+    return static_cast<TOutput>(std::log10(static_cast<RealType>(A)));
+  }
+};
+} // end namespace Functor
+
 /**
  * \class BModeImageFilter
  *
@@ -43,6 +87,29 @@ namespace itk
  * Use SetFrequencyFilter() to add a filtering step before the analytic
  * signal computation.
  *
+ * Use SetTimeGainCompensationFilter() to compensate the envelope for the
+ * attenuation with depth before the logarithmic intensity transform.
+ *
+ * Use SetPaddingPolicy() to select how the input is zero padded in the
+ * direction of propagation before the FFT.
+ *
+ * Use FusedOn() to compute the B-Mode image line by line without the
+ * intermediate images of the internal pipeline.
+ *
+ * Use SetDemodulationFilter() to take the envelope from demodulated and
+ * decimated IQ data instead of the analytic signal.  The output then has the
+ * decimated samples of the demodulation along the direction of propagation.
+ *
+ * Use CacheEnvelopeOn() to keep the linear envelope between updates, so that
+ * changing the time gain compensation only re-runs it and the log
+ * compression.
+ *
+ * The filter supports streaming: only the requested region of the output is
+ * computed, enlarged to the full extent of the direction of propagation.
+ * To bound the memory use, stream with a region splitter that does not
+ * split along that direction, e.g. ImageRegionSplitterDirection with
+ * StreamingImageFilter::SetRegionSplitter().
+ *
  * \sa AnalyticSignalImageFilter
  *
  * \ingroup Ultrasound
@@ -112,6 +179,156 @@ public:
     m_AnalyticFilter->SetFrequencyFilter(filter);
   }
 
+  using TimeGainCompensationFilterType = TimeGainCompensationImageFilter<OutputImageType, OutputImageType>;
+
+  /** Set/Get a time gain compensation applied to the envelope before the log
+   * compression.  Its Gain or SampleGain is used along the direction of
+   * propagation, which must then be the zeroth direction.  In the internal
+   * pipeline, the filter runs in place on the envelope; with Fused on, its
+   * gain profile multiplies the envelope of each line in the scratch
+   * buffers.  In either case, no additional image is allocated.  Not set by
+   * default. */
+  itkSetObjectMacro(TimeGainCompensationFilter, TimeGainCompensationFilterType);
+  itkGetModifiableObjectMacro(TimeGainCompensationFilter, TimeGainCompensationFilterType);
+
+  using DemodulationFilterType = QuadratureDemodulationImageFilter<InputImageType, ComplexImageType>;
+
+  /** Set/Get a quadrature demodulation that replaces the analytic signal.
+   * The envelope is the modulus of its IQ data, which is low-pass filtered
+   * and decimated, so that the FFTs of the full lines are avoided and the
+   * following stages, and the output, have DecimationFactor times fewer
+   * samples along the direction of propagation.  Its Direction is the one of
+   * this filter.  The padding policy, Fused and the frequency filter do not
+   * apply.  Not set by default. */
+  itkSetObjectMacro(DemodulationFilter, DemodulationFilterType);
+  itkGetModifiableObjectMacro(DemodulationFilter, DemodulationFilterType);
+
+  /** Zero padding applied in the direction of propagation.
+   *
+   * PAD_TO_POWER_OF_TWO pads the line length to the next power of two, which
+   * every FFT backend supports.  PAD_TO_FIVE_SMOOTH pads to the next length
+   * whose prime factors are 2, 3 or 5.  PAD_IF_UNSUPPORTED only pads when the
+   * length has a prime factor larger than the FFT backend handles
+   * efficiently, see GetSizeGreatestPrimeFactor(), and then to the next
+   * length the backend supports. */
+  using PaddingPolicyType = enum { PAD_TO_POWER_OF_TWO = 0, PAD_TO_FIVE_SMOOTH, PAD_IF_UNSUPPORTED };
+
+  /** Set/Get the padding policy.  Default is PAD_TO_POWER_OF_TWO. */
+  itkSetMacro(PaddingPolicy, PaddingPolicyType);
+  itkGetConstMacro(PaddingPolicy, PaddingPolicyType);
+
+  /** When on, the forward FFT, the analytic signal mask, the inverse FFT,
+   * the modulus and the log compression are applied to one line at a time in
+   * per work unit scratch buffers, and only the output image is allocated.
+   * The internal pipeline, by contrast, allocates the padded input, the
+   * complex spectrum and analytic signal, and the envelope.  The fused path
+   * uses FFTW when it is available for the pixel type, the VNL FFT
+   * otherwise.  A frequency filter set with SetFrequencyFilter() is folded
+   * into the spectrum weights.  Off by default. */
+  itkSetMacro(Fused, bool);
+  itkGetConstMacro(Fused, bool);
+  itkBooleanMacro(Fused);
+
+  /** Set/Get the planner rigor, e.g. FFTW_ESTIMATE or FFTW_MEASURE, of the
+   * FFTW transforms of both the internal pipeline and the fused path, so
+   * that they plan the same way.  The other backends ignore it.  The
+   * default is FFTWGlobalConfiguration::GetPlanRigor(). */
+  virtual void
+  SetPlanRigor(int value)
+  {
+    if (m_AnalyticFilter->GetPlanRigor() != value)
+    {
+      m_AnalyticFilter->SetPlanRigor(value);
+      this->Modified();
+    }
+  }
+  virtual int
+  GetPlanRigor() const
+  {
+    return m_AnalyticFilter->GetPlanRigor();
+  }
+
+  /** When on, no filter of the internal pipeline runs in place, so that each
+   * intermediate image keeps its buffer across updates, and is only
+   * reallocated when its region grows.  Repeated updates on frames of the
+   * same size then do not allocate image buffers after the first one.  This
+   * costs the copy of the cropped envelope when the input is padded, and
+   * turns InPlace off on the time gain compensation filter.  Off by default.
+   */
+  itkSetMacro(ReuseAllocations, bool);
+  itkGetConstMacro(ReuseAllocations, bool);
+  itkBooleanMacro(ReuseAllocations);
+
+  /** When on, the linear envelope of an update, before the time gain
+   * compensation, is kept, see GetEnvelope().  The following updates apply
+   * the time gain compensation and the log compression to it without
+   * computing it again, e.g. the FFTs of the analytic signal, as long as
+   * neither this filter nor its input are modified and the same output region
+   * is requested.  Changing the parameters of the TimeGainCompensationFilter,
+   * which is part of the modification time of this filter, then re-runs those
+   * two stages only.  The frequency filter and the demodulation filter are
+   * part of the envelope: call Modified() on this filter after changing them.
+   * The envelope is computed by the internal pipeline, even when Fused is on,
+   * and the time gain compensation does not run in place on it.  Off by
+   * default. */
+  itkSetMacro(CacheEnvelope, bool);
+  itkGetConstMacro(CacheEnvelope, bool);
+  itkBooleanMacro(CacheEnvelope);
+
+  /** The linear envelope of the requested region of the last update that
+   * computed it, when CacheEnvelope is on, nullptr otherwise. */
+  const OutputImageType *
+  GetEnvelope() const
+  {
+    return m_Envelope.GetPointer();
+  }
+
+  /** The modification time includes the one of the
+   * TimeGainCompensationFilter. */
+  ModifiedTimeType
+  GetMTime() const override;
+
+  /** Get the greatest prime factor of the line length supported by the FFT
+   * backend. */
+  virtual SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    if (m_Fused)
+    {
+      return LineTransformType::GetSizeGreatestPrimeFactor();
+    }
+    return m_AnalyticFilter->GetSizeGreatestPrimeFactor();
+  }
+
+  /** Length of the lines passed to the FFT, after zero padding, for lines of
+   * the given length. */
+  SizeValueType
+  GetPaddedSize(SizeValueType size) const;
+
+  /** Estimate, in bytes, the memory that an update of the given output
+   * region allocates: the output, and either the intermediate images of the
+   * internal pipeline or the line buffers of the fused path.  The internal
+   * filters keep their images between updates, so their sum is the peak.
+   * The region is enlarged along the direction of propagation, as in an
+   * update.  The input is not counted, and nothing is computed. */
+  SizeValueType
+  EstimateMemoryFootprint(const InputRegionType & region) const;
+
+  /** Estimate the memory footprint of an update of the largest possible
+   * region, after updating the output information. */
+  SizeValueType
+  EstimateMemoryFootprint();
+
+  /** Run the filter once on a frame with the geometry of the given image,
+   * whose pixels are not read, so that the first frame of that geometry
+   * runs at the speed of the following ones: the FFT plans or OpenCL
+   * kernels, the pooled transforms and the buffers are set up by this
+   * update.  With ReuseAllocations, the frames then reuse its buffers.  The
+   * input is restored, and the output holds the warmup frame until the next
+   * update. */
+  void
+  Prepare(const InputImageType * geometry);
+
 protected:
   BModeImageFilter();
   ~BModeImageFilter() {}
@@ -119,9 +336,30 @@ protected:
   virtual void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** The output is decimated along the direction of propagation when a
+   * DemodulationFilter is set. */
+  void
+  GenerateOutputInformation() override;
+
   virtual void
   GenerateData() override;
 
+  /** Single pass implementation used when Fused is on. */
+  void
+  FusedGenerateData();
+
+  /** Set up the internal pipeline up to the envelope, from the analytic
+   * signal or from the IQ data of the DemodulationFilter, and return the
+   * envelope, which is not updated. */
+  OutputImageType *
+  AnalyticEnvelope(const InputImageType * inputPtr);
+  OutputImageType *
+  DemodulatedEnvelope(const InputImageType * inputPtr);
+
+  /** Whether the cached envelope is the one of this update. */
+  bool
+  IsEnvelopeCached() const;
+
   // These behave like their analogs in Forward1DFFTImageFilter.
   virtual void
   GenerateInputRequestedRegion() override;
@@ -133,8 +371,11 @@ protected:
   using ComplexToModulusType = ComplexToModulusImageFilter<typename AnalyticType::OutputImageType, OutputImageType>;
   using PadType = ConstantPadImageFilter<InputImageType, InputImageType>;
   using AddConstantType = AddImageFilter<InputImageType, InputImageType>;
-  using LogType = Log10ImageFilter<InputImageType, OutputImageType>;
+  using LogType =
+    UnaryFunctorImageFilter<InputImageType, OutputImageType, Functor::BModeLog10<InputPixelType, OutputPixelType>>;
   using ROIType = RegionFromReferenceImageFilter<OutputImageType, OutputImageType>;
+  using LineTransformType =
+    AnalyticSignalLineTransform<typename NumericTraits<typename ComplexImageType::PixelType>::ValueType>;
 
 private:
   BModeImageFilter(const Self &); // purposely not implemented
@@ -147,6 +388,17 @@ private:
   typename AddConstantType::Pointer      m_AddConstantFilter;
   typename LogType::Pointer              m_LogFilter;
   typename ROIType::Pointer              m_ROIFilter;
+
+  typename TimeGainCompensationFilterType::Pointer m_TimeGainCompensationFilter;
+  typename DemodulationFilterType::Pointer         m_DemodulationFilter;
+
+  typename OutputImageType::Pointer m_Envelope;
+  TimeStamp                         m_EnvelopeTime;
+
+  PaddingPolicyType m_PaddingPolicy;
+  bool              m_Fused;
+  bool              m_ReuseAllocations;
+  bool              m_CacheEnvelope;
 };
 
 } // end namespace itk
@@ -155,4 +407,18 @@ private:
 #  include "itkBModeImageFilter.hxx"
 #endif
 
+// The common instantiations are compiled into the Ultrasound library.
+#if !defined(ITK_TEMPLATE_EXPLICIT_BModeImageFilter)
+namespace itk
+{
+ITK_GCC_PRAGMA_DIAG_PUSH()
+ITK_GCC_PRAGMA_DIAG(ignored "-Wattributes")
+extern template class Ultrasound_EXPORT_EXPLICIT BModeImageFilter<Image<float, 2>, Image<float, 2>>;
+extern template class Ultrasound_EXPORT_EXPLICIT BModeImageFilter<Image<float, 3>, Image<float, 3>>;
+extern template class Ultrasound_EXPORT_EXPLICIT BModeImageFilter<Image<double, 2>, Image<double, 2>>;
+extern template class Ultrasound_EXPORT_EXPLICIT BModeImageFilter<Image<double, 3>, Image<double, 3>>;
+ITK_GCC_PRAGMA_DIAG_POP()
+} // end namespace itk
+#endif
+
 #endif // itkBModeImageFilter_h
@@ -20,17 +20,26 @@
 
 #include "itkBModeImageFilter.h"
 
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkMetaDataDictionary.h"
+#include "itkWarmupImage.h"
 
 #include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace itk
 {
 
 template <typename TInputImage, typename TOutputImage, typename TComplexImage>
 BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::BModeImageFilter()
+  : m_PaddingPolicy(PAD_TO_POWER_OF_TWO)
+  , m_Fused(false)
+  , m_ReuseAllocations(false)
+  , m_CacheEnvelope(false)
 {
   m_AnalyticFilter = AnalyticType::New();
   m_ComplexToModulusFilter = ComplexToModulusType::New();
@@ -43,6 +52,9 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::BModeImageFilter()
   // from a digitizer that outputs integer types, so 1 is small.
   m_AddConstantFilter->SetConstant2(1);
   m_PadFilter->SetConstant(0.);
+  // The envelope is only generated in the region of the input, so cropping
+  // the padding grafts the envelope instead of copying it.
+  m_ROIFilter->InPlaceOn();
 
   m_ComplexToModulusFilter->SetInput(m_AnalyticFilter->GetOutput());
   m_ROIFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
@@ -55,6 +67,203 @@ void
 BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "PaddingPolicy: ";
+  switch (m_PaddingPolicy)
+  {
+    case PAD_TO_POWER_OF_TWO:
+      os << "PAD_TO_POWER_OF_TWO";
+      break;
+    case PAD_TO_FIVE_SMOOTH:
+      os << "PAD_TO_FIVE_SMOOTH";
+      break;
+    case PAD_IF_UNSUPPORTED:
+      os << "PAD_IF_UNSUPPORTED";
+      break;
+  }
+  os << std::endl;
+  os << indent << "Fused: " << m_Fused << std::endl;
+  os << indent << "PlanRigor: " << this->GetPlanRigor() << std::endl;
+  os << indent << "ReuseAllocations: " << m_ReuseAllocations << std::endl;
+  os << indent << "CacheEnvelope: " << m_CacheEnvelope << std::endl;
+  itkPrintSelfObjectMacro(TimeGainCompensationFilter);
+  itkPrintSelfObjectMacro(DemodulationFilter);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+ModifiedTimeType
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GetMTime() const
+{
+  ModifiedTimeType mtime = Superclass::GetMTime();
+  if (m_TimeGainCompensationFilter.IsNotNull())
+  {
+    mtime = std::max(mtime, m_TimeGainCompensationFilter->GetMTime());
+  }
+  return mtime;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+SizeValueType
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GetPaddedSize(SizeValueType size) const
+{
+  SizeValueType greatestPrimeFactor = 2;
+  switch (m_PaddingPolicy)
+  {
+    case PAD_TO_POWER_OF_TWO:
+      greatestPrimeFactor = 2;
+      break;
+    case PAD_TO_FIVE_SMOOTH:
+      greatestPrimeFactor = std::min<SizeValueType>(5, this->GetSizeGreatestPrimeFactor());
+      break;
+    case PAD_IF_UNSUPPORTED:
+      greatestPrimeFactor = this->GetSizeGreatestPrimeFactor();
+      break;
+  }
+  // Every backend supports powers of two.
+  greatestPrimeFactor = std::max<SizeValueType>(greatestPrimeFactor, 2);
+
+  for (SizeValueType paddedSize = std::max<SizeValueType>(size, 1);; ++paddedSize)
+  {
+    // Divide out the supported factors; composite factors never divide what
+    // is left after their prime factors.
+    SizeValueType remainder = paddedSize;
+    for (SizeValueType factor = 2; factor <= greatestPrimeFactor && remainder > 1; ++factor)
+    {
+      while (remainder % factor == 0)
+      {
+        remainder /= factor;
+      }
+    }
+    if (remainder == 1)
+    {
+      return paddedSize;
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+SizeValueType
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::EstimateMemoryFootprint(
+  const InputRegionType & region) const
+{
+  const unsigned int      direction = this->GetDirection();
+  InputRegionType         enlargedRegion = region;
+  const InputRegionType & largestRegion = this->GetOutput()->GetLargestPossibleRegion();
+  if (largestRegion.GetNumberOfPixels() > 0)
+  {
+    enlargedRegion.SetIndex(direction, largestRegion.GetIndex(direction));
+    enlargedRegion.SetSize(direction, largestRegion.GetSize(direction));
+  }
+
+  const SizeValueType lineLength = enlargedRegion.GetSize(direction);
+  const SizeValueType paddedLength = this->GetPaddedSize(lineLength);
+  const SizeValueType pixels = enlargedRegion.GetNumberOfPixels();
+  const SizeValueType paddedPixels = lineLength > 0 ? pixels / lineLength * paddedLength : 0;
+
+  using ComplexPixelType = typename ComplexImageType::PixelType;
+  SizeValueType footprint = pixels * sizeof(OutputPixelType);
+  if (m_DemodulationFilter.IsNotNull())
+  {
+    // The region is decimated: the IQ data, the envelope, and the envelope
+    // plus one.
+    footprint += pixels * (sizeof(ComplexPixelType) + sizeof(OutputPixelType) + sizeof(InputPixelType));
+    if (m_TimeGainCompensationFilter.IsNotNull() && (m_ReuseAllocations || m_CacheEnvelope))
+    {
+      footprint += pixels * sizeof(OutputPixelType);
+    }
+    return footprint;
+  }
+  if (m_Fused && !m_CacheEnvelope)
+  {
+    // The spectrum weights and the gain are shared, the line buffers of the
+    // transform are per work unit.
+    using WeightType = typename LineTransformType::PixelType;
+    footprint += 2 * paddedLength * sizeof(WeightType);
+    footprint += this->GetNumberOfWorkUnits() * paddedLength * (sizeof(WeightType) + sizeof(ComplexPixelType));
+    return footprint;
+  }
+
+  const bool doPadding = paddedLength != lineLength;
+  if (doPadding)
+  {
+    // The padded input and the cropped envelope.
+    footprint += paddedPixels * sizeof(InputPixelType) + pixels * sizeof(OutputPixelType);
+  }
+  // The complex images of the analytic signal, and the envelope.
+  const SizeValueType numberOfComplexImages = m_AnalyticFilter->GetInPlace() ? 1 : 3;
+  footprint += numberOfComplexImages * paddedPixels * sizeof(ComplexPixelType);
+  footprint += paddedPixels * sizeof(OutputPixelType);
+  if (m_TimeGainCompensationFilter.IsNotNull() && (m_ReuseAllocations || m_CacheEnvelope))
+  {
+    footprint += pixels * sizeof(OutputPixelType);
+  }
+  // The envelope plus one, before the log compression into the output.
+  footprint += pixels * sizeof(InputPixelType);
+  return footprint;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+SizeValueType
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::EstimateMemoryFootprint()
+{
+  this->UpdateOutputInformation();
+  return this->EstimateMemoryFootprint(this->GetOutput()->GetLargestPossibleRegion());
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+void
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::Prepare(const InputImageType * geometry)
+{
+  if (geometry == nullptr)
+  {
+    itkExceptionMacro(<< "The geometry of the frames is required.");
+  }
+
+  const typename InputImageType::ConstPointer input = this->GetInput();
+  this->SetInput(CreateWarmupImage<InputImageType>(geometry));
+  try
+  {
+    this->UpdateLargestPossibleRegion();
+  }
+  catch (...)
+  {
+    this->SetInput(input);
+    throw;
+  }
+  this->SetInput(input);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+void
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * inputPtr = this->GetInput();
+  if (m_DemodulationFilter.IsNull() || !inputPtr)
+  {
+    return;
+  }
+
+  // The demodulation decides the samples along the direction of
+  // propagation.  It is given the information of the input only, so that it
+  // does not update the pipeline upstream of this filter.
+  typename InputImageType::Pointer inputInformation = InputImageType::New();
+  inputInformation->CopyInformation(inputPtr);
+  m_DemodulationFilter->SetDirection(this->GetDirection());
+  m_DemodulationFilter->SetInput(inputInformation);
+  m_DemodulationFilter->UpdateOutputInformation();
+  const ComplexImageType * demodulated = m_DemodulationFilter->GetOutput();
+  OutputImageType *        outputPtr = this->GetOutput();
+  outputPtr->SetLargestPossibleRegion(demodulated->GetLargestPossibleRegion());
+  outputPtr->SetSpacing(demodulated->GetSpacing());
+  outputPtr->SetOrigin(demodulated->GetOrigin());
 }
 
 
@@ -123,41 +332,108 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::EnlargeOutputRequest
 
 
 template <typename TInputImage, typename TOutputImage, typename TComplexImage>
-void
-BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateData()
+bool
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::IsEnvelopeCached() const
 {
-  this->AllocateOutputs();
-
+  if (!m_CacheEnvelope || m_Envelope.IsNull())
+  {
+    return false;
+  }
+  // The modification time of this filter without the time gain compensation.
   const InputImageType * inputPtr = this->GetInput();
-  OutputImageType *      outputPtr = this->GetOutput();
+  const ModifiedTimeType envelopeTime = m_EnvelopeTime.GetMTime();
+  return Superclass::GetMTime() < envelopeTime && inputPtr->GetMTime() < envelopeTime &&
+         inputPtr->GetUpdateMTime() < envelopeTime &&
+         m_Envelope->GetBufferedRegion() == this->GetOutput()->GetRequestedRegion();
+}
 
-  const unsigned int                direction = m_AnalyticFilter->GetDirection();
-  typename InputImageType::SizeType size = inputPtr->GetLargestPossibleRegion().GetSize();
 
-  // Zero padding.  FFT direction should be factorable by 2 for all FFT
-  // implementations to work.
-  unsigned int n = size[direction];
-  while (n % 2 == 0)
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+void
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateData()
+{
+  if (m_TimeGainCompensationFilter.IsNotNull() && this->GetDirection() != 0)
   {
-    n /= 2;
+    itkExceptionMacro("The time gain compensation requires the direction of propagation to be 0.");
   }
-  bool doPadding;
-  if (n == 1)
+
+  if (m_Fused && m_DemodulationFilter.IsNull() && !m_CacheEnvelope)
   {
-    doPadding = false;
+    m_Envelope = nullptr;
+    this->FusedGenerateData();
+    return;
+  }
+
+  this->AllocateOutputs();
+  OutputImageType * outputPtr = this->GetOutput();
+
+  OutputImageType * envelope = nullptr;
+  if (this->IsEnvelopeCached())
+  {
+    // Only the display stages run, on the envelope of a previous update.
+    envelope = m_Envelope;
+    m_LogFilter->Modified();
   }
   else
   {
-    doPadding = true;
+    // The internal pipeline works on a shallow copy of the input, so that it
+    // only processes the requested region, e.g. one chunk when streaming, and
+    // does not update the pipeline upstream of this filter.
+    typename InputImageType::Pointer inputPtr = InputImageType::New();
+    inputPtr->Graft(this->GetInput());
+    envelope =
+      m_DemodulationFilter.IsNotNull() ? this->DemodulatedEnvelope(inputPtr) : this->AnalyticEnvelope(inputPtr);
+    m_Envelope = nullptr;
+    if (m_CacheEnvelope)
+    {
+      envelope->UpdateOutputInformation();
+      envelope->SetRequestedRegion(outputPtr->GetRequestedRegion());
+      envelope->Update();
+      m_Envelope = OutputImageType::New();
+      m_Envelope->Graft(envelope);
+      m_EnvelopeTime.Modified();
+      envelope = m_Envelope;
+    }
   }
-  if (doPadding)
+
+  if (m_TimeGainCompensationFilter.IsNotNull())
   {
-    n = size[direction];
-    unsigned int newSizeDirection = 1;
-    while (newSizeDirection < n)
+    // The gain is applied in place on the envelope, unless the allocations
+    // are reused or the envelope is cached.
+    if (m_ReuseAllocations || m_CacheEnvelope)
     {
-      newSizeDirection *= 2;
+      m_TimeGainCompensationFilter->InPlaceOff();
     }
+    m_TimeGainCompensationFilter->SetInput(envelope);
+    envelope = m_TimeGainCompensationFilter->GetOutput();
+  }
+  m_AddConstantFilter->SetInput(envelope);
+  // The grafted output carries the requested region.
+  m_LogFilter->GraftOutput(outputPtr);
+  m_LogFilter->Update();
+  this->GraftOutput(m_LogFilter->GetOutput());
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+auto
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::AnalyticEnvelope(const InputImageType * inputPtr)
+  -> OutputImageType *
+{
+  const unsigned int                direction = m_AnalyticFilter->GetDirection();
+  typename InputImageType::SizeType size = inputPtr->GetLargestPossibleRegion().GetSize();
+  m_ComplexToModulusFilter->SetInput(m_AnalyticFilter->GetOutput());
+
+  // Running in place hands the buffer of the input over to the output, and
+  // the upstream filter allocates a new one on the next update.
+  m_ROIFilter->SetInPlace(!m_ReuseAllocations);
+
+  // Zero padding.  The FFT direction must only have prime factors that the
+  // FFT backend supports.
+  const SizeValueType newSizeDirection = this->GetPaddedSize(size[direction]);
+  const bool          doPadding = (newSizeDirection != size[direction]);
+  if (doPadding)
+  {
     typename InputImageType::SizeType padSize;
     padSize.Fill(0);
     padSize[direction] = newSizeDirection - size[direction];
@@ -167,16 +443,129 @@ BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::GenerateData()
     m_AnalyticFilter->SetInput(m_PadFilter->GetOutput());
     m_ROIFilter->SetReferenceImage(inputPtr);
     m_ROIFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
-    m_AddConstantFilter->SetInput(m_ROIFilter->GetOutput());
   }
   else // padding is not required
   {
     m_AnalyticFilter->SetInput(inputPtr);
-    m_AddConstantFilter->SetInput(m_ComplexToModulusFilter->GetOutput());
   }
-  m_LogFilter->GraftOutput(outputPtr);
-  m_LogFilter->Update();
-  this->GraftOutput(m_LogFilter->GetOutput());
+  return doPadding ? m_ROIFilter->GetOutput() : m_ComplexToModulusFilter->GetOutput();
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+auto
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::DemodulatedEnvelope(const InputImageType * inputPtr)
+  -> OutputImageType *
+{
+  m_DemodulationFilter->SetDirection(this->GetDirection());
+  m_DemodulationFilter->SetInput(inputPtr);
+  m_ComplexToModulusFilter->SetInput(m_DemodulationFilter->GetOutput());
+  return m_ComplexToModulusFilter->GetOutput();
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComplexImage>
+void
+BModeImageFilter<TInputImage, TOutputImage, TComplexImage>::FusedGenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType size = inputPtr->GetLargestPossibleRegion().GetSize()[direction];
+  const SizeValueType paddedSize = this->GetPaddedSize(size);
+
+  // The spectrum weights are shared by all the work units: the one-sided
+  // analytic signal mask times the optional frequency filter.
+  using WeightType = typename LineTransformType::PixelType;
+  std::vector<WeightType> weights(paddedSize);
+  LineTransformType::FillOneSidedWeights(
+    weights.data(), paddedSize, static_cast<WeightType>(1) / static_cast<WeightType>(paddedSize));
+  FrequencyFilterType * frequencyFilter = m_AnalyticFilter->GetModifiableFrequencyFilter();
+  if (frequencyFilter != nullptr)
+  {
+    FrequencyDomain1DFilterFunction * filterFunction = frequencyFilter->GetModifiableFilterFunction();
+    filterFunction->Precompute(paddedSize);
+    for (SizeValueType ii = 0; ii < paddedSize; ++ii)
+    {
+      weights[ii] *= static_cast<WeightType>(filterFunction->EvaluateIndex(ii));
+    }
+  }
+
+  // The optional time gain compensation of every sample of the lines, in
+  // the precision of the transform.
+  std::vector<WeightType> lineGain;
+  if (m_TimeGainCompensationFilter.IsNotNull())
+  {
+    std::vector<double> computedLineGain;
+    m_TimeGainCompensationFilter->ComputeLineGain(inputPtr, computedLineGain);
+    lineGain.assign(computedLineGain.begin(), computedLineGain.end());
+  }
+
+  // The plans of the line transforms have the rigor of the internal pipeline.
+  const auto planRigor = static_cast<unsigned>(this->GetPlanRigor());
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
+    direction,
+    outputPtr->GetRequestedRegion(),
+    [inputPtr, outputPtr, direction, size, paddedSize, planRigor, &weights, &lineGain](
+      const InputRegionType & lambdaRegion) {
+      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
+      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
+      InputIteratorType  inputIt(inputPtr, lambdaRegion);
+      OutputIteratorType outputIt(outputPtr, lambdaRegion);
+      inputIt.SetDirection(direction);
+      outputIt.SetDirection(direction);
+
+      LineTransformType transform(paddedSize, planRigor);
+      WeightType *      lineBuffer = transform.GetInputBuffer();
+
+      // for every fft line
+      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      {
+        inputIt.GoToBeginOfLine();
+        SizeValueType ii = 0;
+        while (!inputIt.IsAtEndOfLine())
+        {
+          lineBuffer[ii] = static_cast<WeightType>(inputIt.Get());
+          ++inputIt;
+          ++ii;
+        }
+
+        transform.Compute(size, weights.data());
+
+        // Envelope, time gain compensation, plus one to avoid taking the log
+        // of zero, and log compression, as in the internal pipeline.
+        const typename LineTransformType::ComplexType * analytic = transform.GetOutputBuffer();
+        outputIt.GoToBeginOfLine();
+        if (lineGain.empty())
+        {
+          while (!outputIt.IsAtEndOfLine())
+          {
+            outputIt.Set(static_cast<OutputPixelType>(std::log10(std::abs(*analytic) + static_cast<WeightType>(1))));
+            ++outputIt;
+            ++analytic;
+          }
+        }
+        else
+        {
+          const WeightType * gain = lineGain.data();
+          while (!outputIt.IsAtEndOfLine())
+          {
+            const WeightType envelope = std::abs(*analytic) * *gain;
+            outputIt.Set(static_cast<OutputPixelType>(std::log10(envelope + static_cast<WeightType>(1))));
+            ++outputIt;
+            ++analytic;
+            ++gain;
+          }
+        }
+      }
+    },
+    this);
 }
 
 } // end namespace itk
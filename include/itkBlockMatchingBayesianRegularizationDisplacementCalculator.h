@@ -25,7 +25,8 @@
 #include "itkNeighborhoodIterator.h"
 
 #include "itkBlockMatchingMetricImageToDisplacementCalculator.h"
-#include "itkZeroFluxNeumannPadImageFilter.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -56,6 +57,14 @@ namespace BlockMatching
  *
  * Assumes that all metric images have th same spacing.
  *
+ * Every iteration computes the posterior of every block in one multithreaded
+ * pass over the blocks, directly on the buffers of the metric images: the
+ * product of the prior with the likelihoods of the neighbors, its scaling to
+ * unity and its mean change.  The prior and posterior images swap their roles
+ * between the iterations, and the prior images share one contiguous buffer.
+ * The Gaussian like kernels are separable, so the maximum of the prior of a
+ * neighbor weighted by the kernel is taken along one direction at a time.
+ *
  * \ingroup Ultrasound
  */
 template <typename TMetricImage, typename TDisplacementImage>
@@ -104,6 +113,8 @@ public:
   using PointType = typename Superclass::PointType;
   using VectorType = typename PointType::VectorType;
 
+  /** Regularize, between a StartEvent and an EndEvent, and compute the
+   * displacements with the DisplacementCalculator. */
   void
   Compute() override;
 
@@ -174,8 +185,7 @@ protected:
   void
   AllocatePriorPrImage();
 
-  /** Scale the metric image to unity, and calculate the mean change in
-   * probability if needed. */
+  /** Scale the metric images to unity. */
   virtual void
   ScaleToUnity();
 
@@ -184,14 +194,29 @@ protected:
   void
   GenerateGaussianLikeKernels();
 
-  /** Calculate apply the conditional probability of neighbors */
+  /** Scratch buffers of ImpartLikelihood(), one per work unit. */
+  struct LikelihoodScratch
+  {
+    std::vector<PixelType>       Buffer;
+    std::vector<PixelType>       OtherBuffer;
+    std::vector<OffsetValueType> PriorOffsets[ImageDimension];
+  };
+
+  /** Multiply the posterior by the likelihood given the prior of the neighbor
+   * block at shift along direction: at every displacement, the maximum of the
+   * prior around the same displacement weighted by the Gaussian like kernel.
+   * The prior is extended with its values at its boundary. */
   void
-  ImpartLikelihood(MetricImagePointerType & postImage,
-                   MetricImagePointerType & priorImage,
-                   const unsigned int       direction,
-                   const VectorType &       shift);
+  ImpartLikelihood(MetricImageType *       posterior,
+                   const MetricImageType * prior,
+                   const unsigned int      direction,
+                   const VectorType &      shift,
+                   LikelihoodScratch &     scratch) const;
+
+  /** Compute the posterior of the blocks in the region from the priors, scale
+   * it to unity, and add up its change if the MeanChangeThreshold is set. */
   void
-  ThreadedImpartLikelihood(const RegionType & region);
+  ThreadedRegularize(const RegionType & region);
 
   typename Superclass::Pointer m_DisplacementCalculator;
 
@@ -203,14 +228,16 @@ protected:
   bool         m_MetricLowerBoundDefined;
 
   MetricImageImagePointerType m_PriorPr;
-
-  using ImageImageBoundaryConditionType = typename itk::ConstantImagePointerBoundaryCondition<MetricImageImageType>;
-  ImageImageBoundaryConditionType m_ImageImageBoundaryCondition;
-
-  using GaussianKernelType = MetricImageType;
-  using GaussianKernelArrayType = typename std::vector<typename GaussianKernelType::Pointer>;
+  // The contiguous buffer of the prior metric images, in the order of the
+  // displacements.
+  typename MetricImageType::PixelContainerPointer m_PriorBuffer;
+
+  // The separable Gaussian like kernels: for every direction to a neighbor,
+  // the factor of the kernel along every direction.
+  using GaussianKernelType = std::vector<PixelType>;
+  using GaussianKernelArrayType = std::vector<std::vector<GaussianKernelType>>;
   GaussianKernelArrayType m_GaussianKernels;
-  using GaussianKernelRadiusType = typename GaussianKernelType::SizeType;
+  using GaussianKernelRadiusType = SizeType;
   using GaussianKernelRadiusArrayType = typename std::vector<GaussianKernelRadiusType>;
   GaussianKernelRadiusArrayType m_GaussianKernelRadii;
 
@@ -219,8 +246,6 @@ protected:
 
   unsigned int m_CurrentIteration;
 
-  using PadFilterType = ZeroFluxNeumannPadImageFilter<MetricImageType, MetricImageType>;
-
   /** We shift the minimum value of the metric image so 0 corresponds to
    * the theoretical lower bound. */
   void
@@ -230,15 +255,6 @@ protected:
   void
   ThreadedScaleToUnity(const RegionType & region);
 
-  /** Copy the contents of the prior metric images to the posterior metric
-   * images. */
-  void
-  ThreadedCopyPriorToPosterior(const RegionType & region);
-
-  /** Calculate the mean change in probability. */
-  void
-  ThreadedMeanChange(const RegionType & region);
-
 private:
   /** Some helper quanitites for the mean change calculator. */
   std::atomic<double>   m_ChangeSum;
@@ -21,12 +21,15 @@
 #include "itkBlockMatchingBayesianRegularizationDisplacementCalculator.h"
 #include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
 
-#include "itkNeighborhoodAlgorithm.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkCompensatedSummation.h"
+#include "itkUltrasoundTrace.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
@@ -84,9 +87,9 @@ BayesianRegularizationDisplacementCalculator<TMetricImage,
   m_DisplacementCalculator = MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::New();
 
   m_PriorPr = nullptr;
+  m_PriorBuffer = nullptr;
 
-  for (unsigned int dim = 0; dim < ImageDimension; dim++)
-    m_GaussianKernels.push_back(MetricImageType::New());
+  m_GaussianKernels.resize(ImageDimension, std::vector<GaussianKernelType>(ImageDimension));
 
   m_GaussianKernelRadii.resize(ImageDimension);
 }
@@ -98,21 +101,77 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
 {
   using PrIteratorType = typename itk::ImageRegionIterator<MetricImageImageType>;
   using PrConstIteratorType = typename itk::ImageRegionConstIterator<MetricImageImageType>;
-  MetricImagePointerType imagePr;
-  m_PriorPr = MetricImageImageType::New();
-  m_PriorPr->CopyInformation(this->m_MetricImageImage);
-  m_PriorPr->SetRegions(this->m_MetricImageImage->GetLargestPossibleRegion());
-  m_PriorPr->Allocate();
-  PrIteratorType      priorIt(m_PriorPr, m_PriorPr->GetLargestPossibleRegion());
-  PrConstIteratorType postIt(this->m_MetricImageImage, this->m_MetricImageImage->GetLargestPossibleRegion());
+  const RegionType & blocksRegion = this->m_MetricImageImage->GetLargestPossibleRegion();
+
+  // The prior images are only ever held by this class, so they are kept
+  // across the frames while the blocks and their metric images keep their
+  // regions.
+  bool reuse = m_PriorPr.IsNotNull() && m_PriorPr->GetLargestPossibleRegion() == blocksRegion;
+  if (reuse)
+  {
+    PrConstIteratorType priorIt(m_PriorPr, blocksRegion);
+    PrConstIteratorType postIt(this->m_MetricImageImage, blocksRegion);
+    for (priorIt.GoToBegin(), postIt.GoToBegin(); reuse && !priorIt.IsAtEnd(); ++priorIt, ++postIt)
+    {
+      // The missing blocks have neither.
+      if (priorIt.Get() == nullptr || postIt.Get() == nullptr)
+      {
+        reuse = priorIt.Get() == postIt.Get();
+        continue;
+      }
+      reuse = priorIt.Get()->GetLargestPossibleRegion() == postIt.Get()->GetLargestPossibleRegion();
+    }
+  }
+
+  if (!reuse)
+  {
+    m_PriorPr = MetricImageImageType::New();
+    m_PriorPr->SetRegions(blocksRegion);
+    m_PriorPr->Allocate();
+
+    PrConstIteratorType postIt(this->m_MetricImageImage, blocksRegion);
+    SizeValueType       numberOfPixels = 0;
+    for (postIt.GoToBegin(); !postIt.IsAtEnd(); ++postIt)
+    {
+      if (postIt.Get() != nullptr)
+      {
+        numberOfPixels += postIt.Get()->GetLargestPossibleRegion().GetNumberOfPixels();
+      }
+    }
+    using PixelContainerType = typename MetricImageType::PixelContainer;
+    m_PriorBuffer = PixelContainerType::New();
+    m_PriorBuffer->Reserve(numberOfPixels);
+
+    // The prior images are slices of one buffer, in the order of the blocks.
+    PrIteratorType priorIt(m_PriorPr, blocksRegion);
+    SizeValueType  offset = 0;
+    for (priorIt.GoToBegin(), postIt.GoToBegin(); !priorIt.IsAtEnd(); ++priorIt, ++postIt)
+    {
+      if (postIt.Get() == nullptr)
+      {
+        priorIt.Set(nullptr);
+        continue;
+      }
+      MetricImagePointerType imagePr = MetricImageType::New();
+      imagePr->SetRegions(postIt.Get()->GetLargestPossibleRegion());
+      const SizeValueType                  imagePixels = imagePr->GetLargestPossibleRegion().GetNumberOfPixels();
+      typename PixelContainerType::Pointer container = PixelContainerType::New();
+      container->SetImportPointer(m_PriorBuffer->GetBufferPointer() + offset, imagePixels);
+      imagePr->SetPixelContainer(container);
+      offset += imagePixels;
+      priorIt.Set(imagePr);
+    }
+  }
 
+  m_PriorPr->CopyInformation(this->m_MetricImageImage);
+  PrIteratorType      priorIt(m_PriorPr, blocksRegion);
+  PrConstIteratorType postIt(this->m_MetricImageImage, blocksRegion);
   for (priorIt.GoToBegin(), postIt.GoToBegin(); !priorIt.IsAtEnd(); ++priorIt, ++postIt)
   {
-    imagePr = MetricImageType::New();
-    imagePr->CopyInformation(postIt.Get());
-    imagePr->SetRegions(postIt.Get()->GetLargestPossibleRegion());
-    imagePr->Allocate();
-    priorIt.Set(imagePr);
+    if (postIt.Get() != nullptr)
+    {
+      priorIt.Get()->CopyInformation(postIt.Get());
+    }
   }
 }
 
@@ -125,18 +184,6 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
     this->m_DisplacementImage->GetRequestedRegion(),
     [this](const RegionType & outputRegion) { this->ThreadedScaleToUnity(outputRegion); },
     nullptr);
-
-  if (m_MeanChangeThresholdDefined && m_CurrentIteration > 0)
-  {
-    m_ChangeSum.store(0.0);
-    m_ChangeCount.store(0);
-    // This adds up m_ChangeSum and m_ChangeCount.
-    this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
-      this->m_DisplacementImage->GetRequestedRegion(),
-      [this](const RegionType & outputRegion) { this->ThreadedMeanChange(outputRegion); },
-      nullptr);
-    m_MeanChange = m_ChangeSum.load() / static_cast<double>(m_ChangeCount.load());
-  }
 }
 
 
@@ -144,64 +191,53 @@ template <typename TMetricImage, typename TDisplacementImage>
 void
 BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::GenerateGaussianLikeKernels()
 {
-  typename GaussianKernelArrayType::iterator it;
-  typename GaussianKernelType::RegionType    region;
-  typename GaussianKernelType::IndexType     index;
-  typename GaussianKernelType::SizeType      size;
-  typename GaussianKernelType::Pointer       image;
-  GaussianKernelRadiusType                   radius;
   // This is where the equal metric image spacing assumption comes in.  We could
   // avoid the assumption, but then we may have to regenerate the gaussian
   // kernels every time.
-  typename MetricImageType::IndexType dummyIndex;
-  dummyIndex.Fill(0);
-  SpacingType  maxStrain;
-  SpacingType  metricSpacing = this->m_MetricImageImage->GetPixel(dummyIndex)->GetSpacing();
-  SpacingType  displacementSpacing = this->m_DisplacementImage->GetSpacing();
-  unsigned int dimIt;
-  unsigned int dimIt2;
-  PixelType    temp;
-  PixelType    temp2;
-  PixelType    neighborValue;
+  // The first block that is not missing gives the spacing.
+  const MetricImageType *                             firstMetricImage = nullptr;
+  itk::ImageRegionConstIterator<MetricImageImageType> imageImageIt(this->m_MetricImageImage,
+                                                                   this->m_MetricImageImage->GetBufferedRegion());
+  for (imageImageIt.GoToBegin(); !imageImageIt.IsAtEnd() && firstMetricImage == nullptr; ++imageImageIt)
+  {
+    firstMetricImage = imageImageIt.Get();
+  }
+  if (firstMetricImage == nullptr)
+  {
+    return;
+  }
+  SpacingType       maxStrain;
+  const SpacingType metricSpacing = firstMetricImage->GetSpacing();
+  const SpacingType displacementSpacing = this->m_DisplacementImage->GetSpacing();
 
   // Set the maximum strain if it has not been specified.
-  for (dimIt = 0; dimIt < ImageDimension; dimIt++)
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
   {
-    if (m_MaximumStrain[dimIt] == 0.0)
-      maxStrain[dimIt] = 3.0 * m_StrainSigma[dimIt];
+    if (m_MaximumStrain[dim] == 0.0)
+      maxStrain[dim] = 3.0 * m_StrainSigma[dim];
     else
-      maxStrain[dimIt] = m_MaximumStrain[dimIt];
+      maxStrain[dim] = m_MaximumStrain[dim];
   }
 
-  for (it = m_GaussianKernels.begin(), dimIt = 0; it != m_GaussianKernels.end(); ++it, ++dimIt)
+  // The kernel towards the neighbor along a direction is a product of
+  // Gaussians along every direction.
+  for (unsigned int direction = 0; direction < ImageDimension; ++direction)
   {
-    image = *it;
-    for (dimIt2 = 0; dimIt2 < ImageDimension; dimIt2++)
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
     {
-      radius[dimIt2] = static_cast<typename GaussianKernelRadiusType::SizeValueType>(
-        std::ceil(displacementSpacing[dimIt] * maxStrain[dimIt2] / metricSpacing[dimIt2]));
-      size[dimIt2] = radius[dimIt2] * 2 + 1;
-      index[dimIt2] = -1 * radius[dimIt2];
-    }
-    m_GaussianKernelRadii[dimIt] = radius;
-    region.SetSize(size);
-    region.SetIndex(index);
-    image->SetRegions(region);
-    image->Allocate();
-
-    itk::ImageRegionIteratorWithIndex<GaussianKernelType> imageIt(image, region);
-    for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
-    {
-      neighborValue = 0.0;
-      index = imageIt.GetIndex();
-      for (dimIt2 = 0; dimIt2 < ImageDimension; dimIt2++)
+      const auto radius = static_cast<SizeValueType>(
+        std::ceil(displacementSpacing[direction] * maxStrain[dim] / metricSpacing[dim]));
+      m_GaussianKernelRadii[direction][dim] = radius;
+
+      GaussianKernelType & kernel = m_GaussianKernels[direction][dim];
+      kernel.resize(2 * radius + 1);
+      const PixelType sigma = displacementSpacing[direction] * m_StrainSigma[dim];
+      for (SizeValueType ii = 0; ii < kernel.size(); ++ii)
       {
-        temp = std::abs(index[dimIt2]) * metricSpacing[dimIt2];
-        temp2 = displacementSpacing[dimIt] * m_StrainSigma[dimIt2];
-        neighborValue += temp * temp / (temp2 * temp2);
+        const PixelType distance =
+          std::abs(static_cast<IndexValueType>(ii) - static_cast<IndexValueType>(radius)) * metricSpacing[dim];
+        kernel[ii] = std::exp(static_cast<PixelType>(-0.5) * distance * distance / (sigma * sigma));
       }
-      neighborValue *= -0.5;
-      imageIt.Set(std::exp(neighborValue));
     }
   }
 }
@@ -210,98 +246,116 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
 template <typename TMetricImage, typename TDisplacementImage>
 void
 BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::ImpartLikelihood(
-  MetricImagePointerType & postImage,
-  MetricImagePointerType & priorImage,
-  const unsigned int       direction,
-  const VectorType &       shift)
+  MetricImageType *       posterior,
+  const MetricImageType * prior,
+  const unsigned int      direction,
+  const VectorType &      shift,
+  LikelihoodScratch &     scratch) const
 {
-  // We apply Neumann padding to the prior.
-  SizeType lowerBoundPad;
-  lowerBoundPad.Fill(0);
-  SizeType upperBoundPad;
-  upperBoundPad.Fill(0);
-  IndexType  priorLeftIndex = priorImage->GetBufferedRegion().GetIndex();
-  IndexType  priorRightIndex = priorLeftIndex + priorImage->GetBufferedRegion().GetSize();
-  RegionType postRegion = postImage->GetBufferedRegion();
-  postRegion.PadByRadius(m_GaussianKernelRadii[direction]);
-  IndexType    postLeftIndex = postRegion.GetIndex();
-  IndexType    postRightIndex = postLeftIndex + postRegion.GetSize();
-  unsigned int dim;
-  unsigned int padding;
-  PointType    point;
-  IndexType    index;
-  postImage->TransformIndexToPhysicalPoint(postLeftIndex, point);
-  priorImage->TransformPhysicalPointToIndex(point + shift, index);
-  for (dim = 0; dim < ImageDimension; dim++)
+  const RegionType & postRegion = posterior->GetBufferedRegion();
+  const RegionType & priorRegion = prior->GetBufferedRegion();
+  const SizeType &   postSize = postRegion.GetSize();
+  const SizeType &   radius = m_GaussianKernelRadii[direction];
+  PointType          point;
+  IndexType          priorStart;
+  posterior->TransformIndexToPhysicalPoint(postRegion.GetIndex(), point);
+  prior->TransformPhysicalPointToIndex(point + shift, priorStart);
+
+  // The offsets of the prior samples under the kernels, along every
+  // direction.  They are clamped to the buffered region of the prior, which
+  // is its Neumann extension.
+  const typename MetricImageType::OffsetValueType * priorOffsetTable = prior->GetOffsetTable();
+  SizeType                                          size;
+  SizeValueType                                     numberOfPixels = 1;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
   {
-    if (index[dim] < priorLeftIndex[dim])
+    size[dim] = postSize[dim] + 2 * radius[dim];
+    numberOfPixels *= size[dim];
+    const IndexValueType lower = priorRegion.GetIndex(dim);
+    const IndexValueType upper = lower + static_cast<IndexValueType>(priorRegion.GetSize(dim)) - 1;
+    const IndexValueType first = priorStart[dim] - static_cast<IndexValueType>(radius[dim]);
+    scratch.PriorOffsets[dim].resize(size[dim]);
+    for (SizeValueType ii = 0; ii < size[dim]; ++ii)
     {
-      padding = priorLeftIndex[dim] - index[dim];
-      if (padding > lowerBoundPad[dim])
-        lowerBoundPad[dim] = padding;
-    }
-    if (index[dim] > priorRightIndex[dim])
-    {
-      padding = index[dim] - priorRightIndex[dim];
-      if (padding > upperBoundPad[dim])
-        upperBoundPad[dim] = padding;
+      const IndexValueType index = std::min(std::max(first + static_cast<IndexValueType>(ii), lower), upper);
+      scratch.PriorOffsets[dim][ii] = (index - lower) * priorOffsetTable[dim];
     }
   }
-  postImage->TransformIndexToPhysicalPoint(postRightIndex, point);
-  priorImage->TransformPhysicalPointToIndex(point + shift, index);
-  for (dim = 0; dim < ImageDimension; dim++)
+
+  // Gather the prior under the kernels into a contiguous buffer.
+  scratch.Buffer.resize(numberOfPixels);
+  const PixelType *   priorBuffer = prior->GetBufferPointer();
+  const SizeValueType lineLength = size[0];
+  const SizeValueType numberOfLines = numberOfPixels / lineLength;
+  for (SizeValueType line = 0; line < numberOfLines; ++line)
   {
-    if (index[dim] < priorLeftIndex[dim])
+    OffsetValueType lineOffset = 0;
+    SizeValueType   remainder = line;
+    for (unsigned int dim = 1; dim < ImageDimension; ++dim)
     {
-      padding = priorLeftIndex[dim] - index[dim];
-      if (padding > lowerBoundPad[dim])
-        lowerBoundPad[dim] = padding;
+      lineOffset += scratch.PriorOffsets[dim][remainder % size[dim]];
+      remainder /= size[dim];
     }
-    if (index[dim] > priorRightIndex[dim])
+    const PixelType *       priorLine = priorBuffer + lineOffset;
+    const OffsetValueType * lineOffsets = scratch.PriorOffsets[0].data();
+    PixelType *             bufferLine = scratch.Buffer.data() + line * lineLength;
+    for (SizeValueType ii = 0; ii < lineLength; ++ii)
     {
-      padding = index[dim] - priorRightIndex[dim];
-      if (padding > upperBoundPad[dim])
-        upperBoundPad[dim] = padding;
+      bufferLine[ii] = priorLine[lineOffsets[ii]];
     }
   }
-  typename PadFilterType::Pointer padFilter;
-  padFilter = PadFilterType::New();
-  padFilter->SetInput(priorImage);
-  padFilter->SetPadLowerBound(lowerBoundPad);
-  padFilter->SetPadUpperBound(upperBoundPad);
-  padFilter->UpdateLargestPossibleRegion();
-  MetricImagePointerType paddedPrior = padFilter->GetOutput();
-
-  MetricImageIteratorType kernelIt(m_GaussianKernels[direction],
-                                   m_GaussianKernels[direction]->GetLargestPossibleRegion());
-
-  postRegion = postImage->GetBufferedRegion();
-  MetricImageIteratorType postIt(postImage, postRegion);
-
-  postImage->TransformIndexToPhysicalPoint(postRegion.GetIndex(), point);
-  paddedPrior->TransformPhysicalPointToIndex(point + shift, index);
-  RegionType priorRegion;
-  priorRegion.SetIndex(index);
-  priorRegion.SetSize(postRegion.GetSize());
-  using NeighborhoodIteratorType = NeighborhoodIterator<MetricImageType>;
-  NeighborhoodIteratorType priorIt(m_GaussianKernelRadii[direction], paddedPrior, priorRegion);
-
-  const unsigned int neighborhoodSize = priorIt.Size();
-
-  PixelType       maxPr;
-  PixelType       localPr;
-  const PixelType nonPositiveMin = NumericTraits<PixelType>::NonpositiveMin();
-  unsigned int    neighbor;
-  for (priorIt.GoToBegin(), postIt.GoToBegin(); !postIt.IsAtEnd(); ++priorIt, ++postIt)
+
+  // The maximum of the prior weighted by the kernel, one direction at a time.
+  // The kernel is separable and the probabilities are not negative, so this
+  // is the maximum over the whole kernel.  Along the later directions, the
+  // innermost loop runs over the contiguous samples of the earlier ones.
+  const PixelType nonpositiveMin = NumericTraits<PixelType>::NonpositiveMin();
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
   {
-    maxPr = nonPositiveMin;
-    for (neighbor = 0, kernelIt.GoToBegin(); neighbor < neighborhoodSize; ++neighbor, ++kernelIt)
+    const GaussianKernelType & kernel = m_GaussianKernels[direction][dim];
+    SizeValueType              inner = 1;
+    for (unsigned int innerDim = 0; innerDim < dim; ++innerDim)
     {
-      localPr = priorIt.GetPixel(neighbor) * kernelIt.Get();
-      if (localPr > maxPr)
-        maxPr = localPr;
+      inner *= size[innerDim];
     }
-    postIt.Value() *= maxPr;
+    SizeValueType outer = 1;
+    for (unsigned int outerDim = dim + 1; outerDim < ImageDimension; ++outerDim)
+    {
+      outer *= size[outerDim];
+    }
+    const SizeValueType inLength = size[dim];
+    const SizeValueType outLength = postSize[dim];
+    scratch.OtherBuffer.resize(inner * outLength * outer);
+    const PixelType * in = scratch.Buffer.data();
+    PixelType *       out = scratch.OtherBuffer.data();
+    for (SizeValueType oo = 0; oo < outer; ++oo)
+    {
+      for (SizeValueType uu = 0; uu < outLength; ++uu)
+      {
+        PixelType *       outRow = out + (oo * outLength + uu) * inner;
+        const PixelType * inRow = in + (oo * inLength + uu) * inner;
+        std::fill(outRow, outRow + inner, nonpositiveMin);
+        for (SizeValueType jj = 0; jj < kernel.size(); ++jj)
+        {
+          const PixelType   weight = kernel[jj];
+          const PixelType * inSample = inRow + jj * inner;
+          for (SizeValueType ii = 0; ii < inner; ++ii)
+          {
+            outRow[ii] = std::max(outRow[ii], inSample[ii] * weight);
+          }
+        }
+      }
+    }
+    std::swap(scratch.Buffer, scratch.OtherBuffer);
+    size[dim] = outLength;
+  }
+
+  PixelType *         postBuffer = posterior->GetBufferPointer();
+  const PixelType *   likelihood = scratch.Buffer.data();
+  const SizeValueType postPixels = postRegion.GetNumberOfPixels();
+  for (SizeValueType ii = 0; ii < postPixels; ++ii)
+  {
+    postBuffer[ii] *= likelihood[ii];
   }
 }
 
@@ -310,6 +364,8 @@ template <typename TMetricImage, typename TDisplacementImage>
 void
 BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::Compute()
 {
+  this->InvokeEvent(StartEvent());
+
   const ThreadIdType defaultThreads = std::max(1u, itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
   this->m_MultiThreader->SetNumberOfWorkUnits(8 * defaultThreads);
 
@@ -331,115 +387,174 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
 
   this->GenerateGaussianLikeKernels();
 
-  // The radius for regularization.
-  typename MetricImageImageType::SizeType regRadius;
-  regRadius.Fill(1);
-
-  using FaceCalculatorType = typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<MetricImageImageType>;
-  FaceCalculatorType                        faceCalculator;
-  typename FaceCalculatorType::FaceListType faceList =
-    faceCalculator(this->m_MetricImageImage, this->m_MetricImageImage->GetLargestPossibleRegion(), regRadius);
-  typename FaceCalculatorType::FaceListType::iterator fit;
-
   MetricImageImagePointerType tempMetricImageImagePtr;
-  MetricImagePointerType      postImage;
-  MetricImagePointerType      priorImage;
   m_CurrentIteration = 0;
-  // Hack to make the SplitRequestedRegion method operate on the face list
-  // regions;
-  const RegionType requestedRegion = this->m_DisplacementImage->GetRequestedRegion();
+  m_MeanChange = NumericTraits<double>::max();
   while (m_CurrentIteration < this->m_MaximumIterations && m_MeanChange > m_MeanChangeThreshold)
   {
+    itkUltrasoundTraceScopeMacro("BayesianRegularizationIteration");
     // We evoke iteration events starting from 0,
     // when no regularization has occured yet.
     this->InvokeEvent(IterationEvent());
 
-    // switcheroo
+    // switcheroo: the posterior of the last iteration is the prior of this
+    // one, and its prior is overwritten with the new posterior.
     tempMetricImageImagePtr = this->m_PriorPr;
     m_PriorPr = this->m_MetricImageImage;
     this->m_MetricImageImage = tempMetricImageImagePtr;
 
+    m_ChangeSum.store(0.0);
+    m_ChangeCount.store(0);
     this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
       this->m_DisplacementImage->GetRequestedRegion(),
-      [this](const RegionType & outputRegion) { this->ThreadedCopyPriorToPosterior(outputRegion); },
+      [this](const RegionType & outputRegion) { this->ThreadedRegularize(outputRegion); },
       nullptr);
 
-    const ThreadIdType workUnits = this->m_MultiThreader->GetNumberOfWorkUnits();
-    for (fit = faceList.begin(); fit != faceList.end(); ++fit)
+    ++m_CurrentIteration;
+
+    if (m_MeanChangeThresholdDefined)
     {
-      // TODO: FIX-ME: hangs if this is not set
-      this->m_MultiThreader->SetNumberOfWorkUnits(2);
-      this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
-        *fit, [this](const RegionType & outputRegion) { this->ThreadedImpartLikelihood(outputRegion); }, nullptr);
+      m_MeanChange = m_ChangeSum.load() / static_cast<double>(m_ChangeCount.load());
     }
-    this->m_MultiThreader->SetNumberOfWorkUnits(workUnits);
-
-    ++m_CurrentIteration;
+  }
 
-    this->ScaleToUnity();
+  // After an odd number of iterations, the posterior is in the prior images.
+  // Hand the metric images back, so the prior images are never shared.
+  if (m_CurrentIteration % 2 == 1)
+  {
+    tempMetricImageImagePtr = this->m_PriorPr;
+    m_PriorPr = this->m_MetricImageImage;
+    this->m_MetricImageImage = tempMetricImageImagePtr;
+    this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
+      this->m_DisplacementImage->GetRequestedRegion(),
+      [this](const RegionType & outputRegion) {
+        itk::ImageRegionConstIterator<MetricImageImageType> priorImageImageIt(m_PriorPr, outputRegion);
+        MetricImageImageIteratorType                        imageImageIt(this->m_MetricImageImage, outputRegion);
+        for (priorImageImageIt.GoToBegin(), imageImageIt.GoToBegin(); !imageImageIt.IsAtEnd();
+             ++priorImageImageIt, ++imageImageIt)
+        {
+          const MetricImageType * prior = priorImageImageIt.Get();
+          if (prior == nullptr)
+          {
+            continue;
+          }
+          std::copy(prior->GetBufferPointer(),
+                    prior->GetBufferPointer() + prior->GetBufferedRegion().GetNumberOfPixels(),
+                    imageImageIt.Get()->GetBufferPointer());
+        }
+      },
+      nullptr);
   }
 
   // Calculate the displacements from the regularized probablity images.
   m_DisplacementCalculator->SetDisplacementImage(this->m_DisplacementImage);
-  itk::ImageRegionConstIteratorWithIndex<MetricImageImageType> metricImageImageConstIt(
-    this->m_MetricImageImage, this->m_MetricImageImage->GetLargestPossibleRegion());
-
-  itk::ImageRegionConstIterator<CenterPointsImageType> centerPointsConstIt(
-    this->m_CenterPointsImage, this->m_CenterPointsImage->GetLargestPossibleRegion());
-  for (metricImageImageConstIt.GoToBegin(), centerPointsConstIt.GoToBegin(); !metricImageImageConstIt.IsAtEnd();
-       ++metricImageImageConstIt, ++centerPointsConstIt)
+  m_DisplacementCalculator->SetBlockMask(this->m_BlockMask);
+  if (m_DisplacementCalculator->GetCacheMetricImage())
   {
-    this->m_DisplacementCalculator->SetMetricImagePixel(
-      centerPointsConstIt.Get(), metricImageImageConstIt.GetIndex(), metricImageImageConstIt.Get());
+    // A caching calculator works on the regularized images themselves,
+    // instead of a copy.
+    m_DisplacementCalculator->SetMetricImageImage(this->m_MetricImageImage);
+    m_DisplacementCalculator->SetCenterPointsImage(this->m_CenterPointsImage);
+  }
+  else
+  {
+    itk::ImageRegionConstIteratorWithIndex<MetricImageImageType> metricImageImageConstIt(
+      this->m_MetricImageImage, this->m_MetricImageImage->GetLargestPossibleRegion());
+
+    itk::ImageRegionConstIterator<CenterPointsImageType> centerPointsConstIt(
+      this->m_CenterPointsImage, this->m_CenterPointsImage->GetLargestPossibleRegion());
+    for (metricImageImageConstIt.GoToBegin(), centerPointsConstIt.GoToBegin(); !metricImageImageConstIt.IsAtEnd();
+         ++metricImageImageConstIt, ++centerPointsConstIt)
+    {
+      if (metricImageImageConstIt.Get() != nullptr)
+      {
+        this->m_DisplacementCalculator->SetMetricImagePixel(
+          centerPointsConstIt.Get(), metricImageImageConstIt.GetIndex(), metricImageImageConstIt.Get());
+      }
+    }
   }
+  this->InvokeEvent(EndEvent());
+
   this->m_DisplacementCalculator->Compute();
 }
 
 
 template <typename TMetricImage, typename TDisplacementImage>
 void
-BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::ThreadedImpartLikelihood(
-  const RegionType & splitRegion)
+BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::ThreadedRegularize(
+  const RegionType & region)
 {
-  MetricImageImageIteratorType imageImageIt(this->m_MetricImageImage, splitRegion);
-  // The radius for regularization.
-  typename MetricImageImageType::SizeType regRadius;
-  regRadius.Fill(1);
-  MetricImageImageNeighborhoodIteratorType priorImageImageIt(regRadius, this->m_PriorPr, splitRegion);
-  priorImageImageIt.OverrideBoundaryCondition(&(this->m_ImageImageBoundaryCondition));
+  itk::ImageRegionConstIteratorWithIndex<MetricImageImageType> priorImageImageIt(m_PriorPr, region);
+  MetricImageImageIteratorType                                 imageImageIt(this->m_MetricImageImage, region);
+  const RegionType &                                           blocksRegion = m_PriorPr->GetBufferedRegion();
+  const SpacingType                                            spacing = this->m_DisplacementImage->GetSpacing();
 
-  MetricImagePointerType postImage;
-  MetricImagePointerType priorImage;
-
-  unsigned int      direction;
+  LikelihoodScratch scratch;
   VectorType        shift;
-  const SpacingType spacing = this->m_DisplacementImage->GetSpacing();
-
-  for (imageImageIt.GoToBegin(), priorImageImageIt.GoToBegin(); !imageImageIt.IsAtEnd();
-       ++imageImageIt, ++priorImageImageIt)
+  double            changeSum = 0.0;
+  uint64_t          changeCount = 0;
+  for (priorImageImageIt.GoToBegin(), imageImageIt.GoToBegin(); !imageImageIt.IsAtEnd();
+       ++priorImageImageIt, ++imageImageIt)
   {
-    postImage = imageImageIt.Get();
-
-    // perform regularization along every direction;
-    for (direction = 0; direction < ImageDimension; ++direction)
+    MetricImageType *       posterior = imageImageIt.Get();
+    const MetricImageType * prior = priorImageImageIt.Get();
+    if (posterior == nullptr)
+    {
+      // A missing block, which does not impart its likelihood either.
+      continue;
+    }
+    PixelType *             postBuffer = posterior->GetBufferPointer();
+    const PixelType *       priorBuffer = prior->GetBufferPointer();
+    const SizeValueType     numberOfPixels = posterior->GetBufferedRegion().GetNumberOfPixels();
+    std::copy(priorBuffer, priorBuffer + numberOfPixels, postBuffer);
+
+    // perform regularization along every direction, with the previous then
+    // the next neighbor, if we are inside the boundary.
+    for (unsigned int direction = 0; direction < ImageDimension; ++direction)
     {
-      priorImage = priorImageImageIt.GetPrevious(direction);
-      // If we are inside the boundary.
-      if (priorImage.GetPointer() != nullptr)
+      for (int side = -1; side <= 1; side += 2)
       {
+        IndexType neighborIndex = priorImageImageIt.GetIndex();
+        neighborIndex[direction] += side;
+        if (!blocksRegion.IsInside(neighborIndex))
+        {
+          continue;
+        }
+        const MetricImageType * neighbor = m_PriorPr->GetPixel(neighborIndex);
+        if (neighbor == nullptr)
+        {
+          continue;
+        }
         shift.Fill(0.0);
-        shift[direction] = -1 * spacing[direction];
-        this->ImpartLikelihood(postImage, priorImage, direction, shift);
+        shift[direction] = side * spacing[direction];
+        this->ImpartLikelihood(posterior, neighbor, direction, shift, scratch);
       }
-      priorImage = priorImageImageIt.GetNext(direction);
-      if (priorImage.GetPointer() != nullptr)
+    }
+
+    PixelType sum = NumericTraits<PixelType>::Zero;
+    for (SizeValueType ii = 0; ii < numberOfPixels; ++ii)
+    {
+      sum += postBuffer[ii];
+    }
+    for (SizeValueType ii = 0; ii < numberOfPixels; ++ii)
+    {
+      postBuffer[ii] /= sum;
+    }
+
+    if (m_MeanChangeThresholdDefined)
+    {
+      for (SizeValueType ii = 0; ii < numberOfPixels; ++ii)
       {
-        shift.Fill(0.0);
-        shift[direction] = spacing[direction];
-        this->ImpartLikelihood(postImage, priorImage, direction, shift);
+        changeSum += std::abs(postBuffer[ii] - std::exp(priorBuffer[ii]));
       }
-    } // for every direction
-  }   // for every probability image
+      changeCount += numberOfPixels;
+    }
+  }
+  if (m_MeanChangeThresholdDefined)
+  {
+    AtomicCompensatedSummation<double>(this->m_ChangeSum, changeSum);
+    this->m_ChangeCount.fetch_add(changeCount);
+  }
 }
 
 
@@ -456,6 +571,10 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
   for (imageImageIt.GoToBegin(); !imageImageIt.IsAtEnd(); ++imageImageIt)
   {
     image = imageImageIt.Get();
+    if (image.IsNull())
+    {
+      continue;
+    }
     MetricImageIteratorType it(image, image->GetLargestPossibleRegion());
 
     for (it.GoToBegin(); !it.IsAtEnd(); ++it)
@@ -476,6 +595,10 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
   for (imageImageIt.GoToBegin(); !imageImageIt.IsAtEnd(); ++imageImageIt)
   {
     image = imageImageIt.Get();
+    if (image.IsNull())
+    {
+      continue;
+    }
     PixelType               sum = NumericTraits<PixelType>::Zero;
     MetricImageIteratorType it(image, image->GetLargestPossibleRegion());
 
@@ -491,64 +614,6 @@ BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::
   }
 }
 
-
-template <typename TMetricImage, typename TDisplacementImage>
-void
-BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::ThreadedMeanChange(
-  const RegionType & region)
-{
-  MetricImageImageIteratorType imageImageIt(this->m_MetricImageImage, region);
-
-  MetricImageImageIteratorType priorImageImageIt(this->m_PriorPr, region);
-  MetricImagePointerType       image;
-  MetricImagePointerType       priorPtr;
-  double                       changeSum = 0.0;
-  unsigned long long           changeCount = 0;
-  for (imageImageIt.GoToBegin(), priorImageImageIt.GoToBegin(); !imageImageIt.IsAtEnd();
-       ++imageImageIt, ++priorImageImageIt)
-  {
-    image = imageImageIt.Get();
-    priorPtr = priorImageImageIt.Get();
-
-    MetricImageConstIteratorType it(image, image->GetLargestPossibleRegion());
-
-    MetricImageConstIteratorType priorIt(priorPtr, priorPtr->GetLargestPossibleRegion());
-    for (it.GoToBegin(), priorIt.GoToBegin(); !it.IsAtEnd(); ++it, ++priorIt)
-    {
-      changeSum += std::abs(it.Get() - std::exp(priorIt.Get()));
-      ++changeCount;
-    }
-  }
-  AtomicCompensatedSummation<double>(this->m_ChangeSum, changeSum);
-  this->m_ChangeCount.fetch_add(changeCount);
-}
-
-template <typename TMetricImage, typename TDisplacementImage>
-void
-BayesianRegularizationDisplacementCalculator<TMetricImage, TDisplacementImage>::ThreadedCopyPriorToPosterior(
-  const RegionType & region)
-{
-  MetricImageImageIteratorType imageImageIt(this->m_MetricImageImage, region);
-
-  MetricImageImageIteratorType priorImageImageIt(this->m_PriorPr, region);
-  MetricImagePointerType       image;
-  MetricImagePointerType       priorPtr;
-  for (imageImageIt.GoToBegin(), priorImageImageIt.GoToBegin(); !imageImageIt.IsAtEnd();
-       ++imageImageIt, ++priorImageImageIt)
-  {
-    image = imageImageIt.Get();
-    priorPtr = priorImageImageIt.Get();
-
-    MetricImageIteratorType it(image, image->GetLargestPossibleRegion());
-
-    MetricImageConstIteratorType priorIt(priorPtr, priorPtr->GetLargestPossibleRegion());
-    for (it.GoToBegin(), priorIt.GoToBegin(); !it.IsAtEnd(); ++it, ++priorIt)
-    {
-      it.Set(priorIt.Get());
-    }
-  }
-}
-
 } // end namespace BlockMatching
 } // end namespace itk
 
@@ -107,6 +107,11 @@ public:
 protected:
   BlockAffineTransformMetricImageFilter();
 
+  /** The clone has a clone of the internal MetricImageFilter and shares the
+   * strain image. */
+  LightObject::Pointer
+  InternalClone() const override;
+
   /** We need the entire input because we don't know where we will be resampling
    * from. */
   virtual void
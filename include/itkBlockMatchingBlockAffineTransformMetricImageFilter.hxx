@@ -43,6 +43,24 @@ BlockAffineTransformMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, T
   m_TransformedFixedImage = FixedImageType::New();
 }
 
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TStrainValueType>
+LightObject::Pointer
+BlockAffineTransformMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TStrainValueType>::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+  typename Self::Pointer rval = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (rval.IsNull())
+  {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+  }
+  if (m_MetricImageFilter.GetPointer() != nullptr)
+  {
+    rval->m_MetricImageFilter = m_MetricImageFilter->Clone();
+  }
+  rval->m_StrainImage = m_StrainImage;
+  return loPtr;
+}
+
 template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TStrainValueType>
 void
 BlockAffineTransformMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TStrainValueType>::
@@ -137,6 +155,7 @@ BlockAffineTransformMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, T
   }
 
   m_MetricImageFilter->SetMovingImage(movingPtr);
+  m_MetricImageFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
   m_MetricImageFilter->SetFixedImageRegion(this->m_FixedImageRegion);
   m_MetricImageFilter->SetMovingImageRegion(this->m_MovingImageRegion);
   m_MetricImageFilter->GraftOutput(this->GetOutput());
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingCorrelationBlockRadiusImageSource_h
+#define itkBlockMatchingCorrelationBlockRadiusImageSource_h
+
+#include "itkImageSource.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class CorrelationBlockRadiusImageSource
+ *
+ * \brief Creates a RadiusImage for input into a
+ * BlockMatching::ImageRegistrationMethod, with small blocks where the fixed and
+ * moving images correlate well.
+ *
+ * Small blocks resolve displacement gradients, but large blocks are needed
+ * where the speckle decorrelates or the signal to noise ratio is low.  At every
+ * point of the grid of the Displacements, the fixed block centered on the point
+ * is compared with the moving block centered on the point plus its
+ * displacement, e.g. the displacement predicted by the previous level of a
+ * MultiResolutionImageRegistrationMethod.  NumberOfRadii radii are tried,
+ * evenly spaced from MinimumRadiusFactor times the MaximumRadius up to the
+ * MaximumRadius, and the block gets the smallest one whose normalized cross
+ * correlation reaches the CorrelationThreshold.  Otherwise, or when a block is
+ * not inside the images, it gets the MaximumRadius.
+ *
+ * The fixed and moving images must have the same spacing.
+ *
+ * \sa ImageRegistrationMethod::SetRadiusImage()
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+class ITK_TEMPLATE_EXPORT CorrelationBlockRadiusImageSource
+  : public ImageSource<Image<typename TFixedImage::SizeType, TDisplacementImage::ImageDimension>>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(CorrelationBlockRadiusImageSource);
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TDisplacementImage::ImageDimension);
+
+  /** Type of the fixed image. */
+  using FixedImageType = TFixedImage;
+  using FixedRegionType = typename FixedImageType::RegionType;
+
+  /** Type of the radius used to characterized the fixed image block. */
+  using RadiusType = typename FixedImageType::SizeType;
+
+  /** Type of the moving image. */
+  using MovingImageType = TMovingImage;
+  using MovingRegionType = typename MovingImageType::RegionType;
+
+  /** Type of the displacement image. */
+  using DisplacementImageType = TDisplacementImage;
+
+  /** Type of the radius image. */
+  using OutputImageType = Image<RadiusType, ImageDimension>;
+  using OutputRegionType = typename OutputImageType::RegionType;
+
+  /** Standard class type alias. */
+  using Self = CorrelationBlockRadiusImageSource;
+  using Superclass = ImageSource<OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** New macro for creation of through a Smart Pointer. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(CorrelationBlockRadiusImageSource, ImageSource);
+
+  /** Set/Get the fixed image. */
+  itkSetConstObjectMacro(FixedImage, FixedImageType);
+  itkGetConstObjectMacro(FixedImage, FixedImageType);
+
+  /** Set/Get the moving image. */
+  itkSetConstObjectMacro(MovingImage, MovingImageType);
+  itkGetConstObjectMacro(MovingImage, MovingImageType);
+
+  /** Set/Get the displacements the moving blocks are centered on.  The output
+   * has their grid. */
+  itkSetConstObjectMacro(Displacements, DisplacementImageType);
+  itkGetConstObjectMacro(Displacements, DisplacementImageType);
+
+  /** Set/Get the largest radius, used where the images do not correlate. */
+  itkSetMacro(MaximumRadius, RadiusType);
+  itkGetConstReferenceMacro(MaximumRadius, RadiusType);
+
+  /** Set/Get the fraction of the MaximumRadius of the smallest radius, in
+   * [0, 1].  The smallest radius is at least one.  Defaults to 0.5. */
+  itkSetClampMacro(MinimumRadiusFactor, double, 0.0, 1.0);
+  itkGetConstMacro(MinimumRadiusFactor, double);
+
+  /** Set/Get the number of radii tried, at least one.  Defaults to 3. */
+  itkSetClampMacro(NumberOfRadii, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfRadii, unsigned int);
+
+  /** Set/Get the normalized cross correlation a block must reach to get a
+   * radius smaller than the MaximumRadius.  Defaults to 0.9. */
+  itkSetMacro(CorrelationThreshold, double);
+  itkGetConstMacro(CorrelationThreshold, double);
+
+protected:
+  CorrelationBlockRadiusImageSource();
+
+  void
+  GenerateOutputInformation() override;
+
+  /** Generates the entire radius image. */
+  void
+  EnlargeOutputRequestedRegion(DataObject * data) override
+  {
+    OutputImageType * output = this->GetOutput(0);
+    output->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputRegionType & outputRegion) override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Normalized cross correlation of the fixed and moving blocks with the
+   * radius centered on the indices, or -1 if a block is not inside its
+   * image. */
+  double
+  ComputeCorrelation(const typename FixedImageType::IndexType &  fixedCenter,
+                     const typename MovingImageType::IndexType & movingCenter,
+                     const RadiusType &                          radius) const;
+
+  typename FixedImageType::ConstPointer        m_FixedImage;
+  typename MovingImageType::ConstPointer       m_MovingImage;
+  typename DisplacementImageType::ConstPointer m_Displacements;
+
+  RadiusType   m_MaximumRadius;
+  double       m_MinimumRadiusFactor;
+  unsigned int m_NumberOfRadii;
+  double       m_CorrelationThreshold;
+
+  // The radii tried, from the smallest.
+  std::vector<RadiusType> m_Radii;
+
+private:
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkBlockMatchingCorrelationBlockRadiusImageSource.hxx"
+#endif
+
+#endif
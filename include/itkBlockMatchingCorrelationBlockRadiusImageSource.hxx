@@ -0,0 +1,209 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingCorrelationBlockRadiusImageSource_hxx
+#define itkBlockMatchingCorrelationBlockRadiusImageSource_hxx
+
+#include "itkBlockMatchingCorrelationBlockRadiusImageSource.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>::CorrelationBlockRadiusImageSource()
+  : m_MinimumRadiusFactor(0.5)
+  , m_NumberOfRadii(3)
+  , m_CorrelationThreshold(0.9)
+{
+  m_MaximumRadius.Fill(0);
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+void
+CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>::GenerateOutputInformation()
+{
+  OutputImageType * outputPtr = this->GetOutput();
+  if (!outputPtr)
+  {
+    return;
+  }
+
+  if (m_Displacements.GetPointer() == nullptr)
+  {
+    itkExceptionMacro(<< "Displacements are not present.");
+  }
+  outputPtr->CopyInformation(m_Displacements);
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+void
+CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>::BeforeThreadedGenerateData()
+{
+  if (m_FixedImage.GetPointer() == nullptr)
+  {
+    itkExceptionMacro(<< "Fixed Image is not present.");
+  }
+  if (m_MovingImage.GetPointer() == nullptr)
+  {
+    itkExceptionMacro(<< "Moving Image is not present.");
+  }
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    if (itk::Math::NotAlmostEquals(m_FixedImage->GetSpacing()[i], m_MovingImage->GetSpacing()[i]))
+    {
+      itkExceptionMacro(<< "The FixedImage and MovingImage must have the same spacing.");
+    }
+  }
+
+  RadiusType nullRadius;
+  nullRadius.Fill(0);
+  if (m_MaximumRadius == nullRadius)
+  {
+    itkExceptionMacro(<< "The MaximumRadius has not been set.");
+  }
+
+  m_Radii.resize(m_NumberOfRadii);
+  for (unsigned int step = 0; step < m_NumberOfRadii; ++step)
+  {
+    const double fraction = m_NumberOfRadii > 1 ? static_cast<double>(step) / (m_NumberOfRadii - 1) : 1.0;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      const double minimum = std::max(1.0, std::round(m_MinimumRadiusFactor * m_MaximumRadius[i]));
+      const double radius = std::round(minimum + fraction * (m_MaximumRadius[i] - minimum));
+      m_Radii[step][i] = static_cast<SizeValueType>(std::min(radius, static_cast<double>(m_MaximumRadius[i])));
+    }
+  }
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+void
+CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>::DynamicThreadedGenerateData(
+  const OutputRegionType & outputRegion)
+{
+  OutputImageType * outputPtr = this->GetOutput();
+
+  typename DisplacementImageType::PointType point;
+  typename FixedImageType::IndexType        fixedCenter;
+  typename MovingImageType::IndexType       movingCenter;
+
+  ImageRegionIteratorWithIndex<OutputImageType> it(outputPtr, outputRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    m_Displacements->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    m_FixedImage->TransformPhysicalPointToIndex(point, fixedCenter);
+    const typename DisplacementImageType::PixelType & displacement = m_Displacements->GetPixel(it.GetIndex());
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      point[i] += displacement[i];
+    }
+    m_MovingImage->TransformPhysicalPointToIndex(point, movingCenter);
+
+    RadiusType radius = m_MaximumRadius;
+    for (const RadiusType & candidate : m_Radii)
+    {
+      if (this->ComputeCorrelation(fixedCenter, movingCenter, candidate) >= m_CorrelationThreshold)
+      {
+        radius = candidate;
+        break;
+      }
+    }
+    it.Set(radius);
+  }
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+double
+CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>::ComputeCorrelation(
+  const typename FixedImageType::IndexType &  fixedCenter,
+  const typename MovingImageType::IndexType & movingCenter,
+  const RadiusType &                          radius) const
+{
+  FixedRegionType fixedRegion;
+  fixedRegion.SetIndex(fixedCenter);
+  fixedRegion.SetSize(RadiusType::Filled(1));
+  fixedRegion.PadByRadius(radius);
+  MovingRegionType movingRegion;
+  movingRegion.SetIndex(movingCenter);
+  movingRegion.SetSize(RadiusType::Filled(1));
+  movingRegion.PadByRadius(radius);
+  if (!m_FixedImage->GetBufferedRegion().IsInside(fixedRegion) ||
+      !m_MovingImage->GetBufferedRegion().IsInside(movingRegion))
+  {
+    return -1.0;
+  }
+
+  double fixedSum = 0.0;
+  double fixedSquaredSum = 0.0;
+  double movingSum = 0.0;
+  double movingSquaredSum = 0.0;
+  double crossSum = 0.0;
+
+  ImageRegionConstIterator<FixedImageType>  fixedIt(m_FixedImage, fixedRegion);
+  ImageRegionConstIterator<MovingImageType> movingIt(m_MovingImage, movingRegion);
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+  {
+    const double fixedValue = fixedIt.Get();
+    const double movingValue = movingIt.Get();
+    fixedSum += fixedValue;
+    fixedSquaredSum += fixedValue * fixedValue;
+    movingSum += movingValue;
+    movingSquaredSum += movingValue * movingValue;
+    crossSum += fixedValue * movingValue;
+  }
+
+  const double numberOfPixels = fixedRegion.GetNumberOfPixels();
+  const double fixedVariance = fixedSquaredSum - fixedSum * fixedSum / numberOfPixels;
+  const double movingVariance = movingSquaredSum - movingSum * movingSum / numberOfPixels;
+  const double denominator = std::sqrt(fixedVariance * movingVariance);
+  if (denominator <= 0.0)
+  {
+    return -1.0;
+  }
+  return (crossSum - fixedSum * movingSum / numberOfPixels) / denominator;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+void
+CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>::PrintSelf(std::ostream & os,
+                                                                                            Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "MaximumRadius: " << m_MaximumRadius << std::endl;
+  os << indent << "MinimumRadiusFactor: " << m_MinimumRadiusFactor << std::endl;
+  os << indent << "NumberOfRadii: " << m_NumberOfRadii << std::endl;
+  os << indent << "CorrelationThreshold: " << m_CorrelationThreshold << std::endl;
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
@@ -62,20 +62,38 @@ public:
   using PointType = typename Superclass::PointType;
   using IndexType = typename Superclass::IndexType;
 
+  using MetricImageImageType = typename Superclass::MetricImageImageType;
+  using CenterPointsImageType = typename Superclass::CenterPointsImageType;
+  using DisplacementImageType = typename Superclass::DisplacementImageType;
+  using DisplacementType = typename DisplacementImageType::PixelType;
+  using RegionType = typename Superclass::RegionType;
+
   virtual void
   SetMetricImagePixel(const PointType & point, const IndexType & index, MetricImageType * image);
 
+  /** The metric images are cached by default, and the displacements of all
+   * the blocks are interpolated here, multithreaded.  Without the cache, they
+   * are interpolated in SetMetricImagePixel(). */
   virtual void
-  Compute()
-  {
-    // We do this here instead of SetMetricImagePixel so it only has to be done
-    // once.
-    this->m_DisplacementImage->Modified();
-  };
+  Compute();
+
+  /** Only pass the 3^N neighborhood of the maximum of the metric images, see
+   * MetricImageToDisplacementCalculator::GetPeakNeighborhoodOnly(). */
+  itkSetMacro(PeakNeighborhoodOnly, bool);
+  itkBooleanMacro(PeakNeighborhoodOnly);
 
 protected:
   CosineInterpolationDisplacementCalculator();
 
+  /** The displacement of the block centered at the point to the interpolated
+   * peak of its metric image. */
+  DisplacementType
+  ComputeDisplacement(const PointType & centerPoint, const MetricImageType * metricImage) const;
+
+  /** Compute the displacements of the cached metric images in the region. */
+  void
+  ThreadedComputeDisplacements(const RegionType & region);
+
 private:
   CosineInterpolationDisplacementCalculator(const Self &);
   void
@@ -20,7 +20,9 @@
 
 #include "itkBlockMatchingCosineInterpolationDisplacementCalculator.h"
 
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 
 namespace itk
 {
@@ -30,7 +32,10 @@ namespace BlockMatching
 template <typename TMetricImage, typename TDisplacementImage, typename TCoordRep>
 CosineInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::
   CosineInterpolationDisplacementCalculator()
-{}
+{
+  this->m_CacheMetricImage = true;
+}
+
 
 template <typename TMetricImage, typename TDisplacementImage, typename TCoordRep>
 void
@@ -41,6 +46,36 @@ CosineInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoo
 {
   Superclass::SetMetricImagePixel(centerPoint, displacementIndex, metricImage);
 
+  if (!this->m_CacheMetricImage)
+  {
+    this->m_DisplacementImage->SetPixel(displacementIndex, this->ComputeDisplacement(centerPoint, metricImage));
+  }
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage, typename TCoordRep>
+void
+CosineInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::Compute()
+{
+  if (this->m_CacheMetricImage)
+  {
+    this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
+      this->m_DisplacementImage->GetRequestedRegion(),
+      [this](const RegionType & outputRegion) { this->ThreadedComputeDisplacements(outputRegion); },
+      nullptr);
+  }
+  // We do this here instead of SetMetricImagePixel so it only has to be done
+  // once.
+  this->m_DisplacementImage->Modified();
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage, typename TCoordRep>
+auto
+CosineInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::ComputeDisplacement(
+  const PointType &       centerPoint,
+  const MetricImageType * metricImage) const -> DisplacementType
+{
   // Find index of the maximum value.
   PixelType max = NumericTraits<PixelType>::min();
   IndexType maxIndex;
@@ -92,7 +127,29 @@ CosineInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoo
     maxPoint[i] += spacing[i] / ::itk::Math::pi * -1 * theta / omega;
   }
 
-  this->m_DisplacementImage->SetPixel(displacementIndex, maxPoint - centerPoint);
+  return maxPoint - centerPoint;
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage, typename TCoordRep>
+void
+CosineInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::ThreadedComputeDisplacements(
+  const RegionType & region)
+{
+  ImageRegionConstIterator<MetricImageImageType>  imageImageIt(this->m_MetricImageImage, region);
+  ImageRegionConstIterator<CenterPointsImageType> centerPointsIt(this->m_CenterPointsImage, region);
+  ImageRegionIterator<DisplacementImageType>      displacementIt(this->m_DisplacementImage, region);
+  for (imageImageIt.GoToBegin(), centerPointsIt.GoToBegin(), displacementIt.GoToBegin(); !imageImageIt.IsAtEnd();
+       ++imageImageIt, ++centerPointsIt, ++displacementIt)
+  {
+    if (imageImageIt.Get() == nullptr)
+    {
+      // A missing block.
+      displacementIt.Set(NumericTraits<typename DisplacementImageType::PixelType>::ZeroValue());
+      continue;
+    }
+    displacementIt.Set(this->ComputeDisplacement(centerPointsIt.Get(), imageImageIt.Get()));
+  }
 }
 
 } // end namespace BlockMatching
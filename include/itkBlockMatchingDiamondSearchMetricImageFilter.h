@@ -0,0 +1,152 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingDiamondSearchMetricImageFilter_h
+#define itkBlockMatchingDiamondSearchMetricImageFilter_h
+
+#include "itkBlockMatchingMetricImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class DiamondSearchMetricImageFilter
+ *
+ * \brief Evaluate a delegate MetricImageFilter only along a shrinking diamond
+ * pattern in the search region, instead of at every pixel.
+ *
+ * The search starts from the better of the center of the search region and
+ * the center displaced by the best displacement of the previous block this
+ * filter matched.  The center of the search region is the displacement of the
+ * previous level of a multi-resolution search, or of the previous frame;
+ * the previous block is usually the neighbor along the first direction.  The
+ * large diamond, two pixels along each direction and one pixel along the
+ * diagonals, moves to its best position until the best is its center, and then
+ * the small diamond, one pixel along each direction, does the same.  This is
+ * the diamond search of the video codecs, and it evaluates a few tens of
+ * positions where the exhaustive search evaluates hundreds.
+ *
+ * The metric image has the metric at the positions that were evaluated, and
+ * the lowest metric value elsewhere.  The neighbors of the maximum along each
+ * direction are evaluated, so that the MetricImageToDisplacementCalculator
+ * can interpolate the maximum.  Where the maximum is not above
+ * ExhaustiveSearchThreshold, the match is considered unreliable, and the
+ * delegate computes the whole metric image.
+ *
+ * The delegate must implement MetricImageFilter::ComputeMetricImage(), as
+ * NormalizedCrossCorrelationKernelMetricImageFilter and
+ * SumOfDifferencesMetricImageFilter do.  Otherwise the delegate computes the
+ * whole metric image with its pipeline.
+ *
+ * \sa MetricImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+class ITK_TEMPLATE_EXPORT DiamondSearchMetricImageFilter
+  : public MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(DiamondSearchMetricImageFilter);
+
+  /** Standard class type alias. */
+  using Self = DiamondSearchMetricImageFilter;
+  using Superclass = MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DiamondSearchMetricImageFilter, MetricImageFilter);
+
+  itkNewMacro(Self);
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TFixedImage::ImageDimension);
+
+  /** Type of the fixed image. */
+  using FixedImageType = typename Superclass::FixedImageType;
+  using FixedImageRegionType = typename Superclass::FixedImageRegionType;
+
+  /** Type of the moving image. */
+  using MovingImageType = typename Superclass::MovingImageType;
+  using MovingImageRegionType = typename Superclass::MovingImageRegionType;
+  using MovingImageIndexType = typename MovingImageType::IndexType;
+  using MovingImageOffsetType = typename MovingImageType::OffsetType;
+
+  /** Type of the metric image. */
+  using MetricImageType = typename Superclass::MetricImageType;
+  using MetricImagePointerType = typename MetricImageType::Pointer;
+  using MetricImagePixelType = typename MetricImageType::PixelType;
+  using MetricImageRegionType = typename Superclass::MetricImageRegionType;
+
+  /** Set/Get the delegate MetricImageFilter that evaluates the metric. */
+  itkSetObjectMacro(MetricImageFilter, Superclass);
+  itkGetConstObjectMacro(MetricImageFilter, Superclass);
+
+  /** Set/Get the metric value at or below which the maximum found by the
+   * diamond search is not trusted, and the whole search region is evaluated.
+   * Defaults to the lowest metric value, so that it only is when no position
+   * the diamonds reached was valid. */
+  itkSetMacro(ExhaustiveSearchThreshold, MetricImagePixelType);
+  itkGetConstMacro(ExhaustiveSearchThreshold, MetricImagePixelType);
+
+  /** Get the number of positions where the metric was evaluated for the last
+   * block. */
+  itkGetConstMacro(NumberOfMetricEvaluations, SizeValueType);
+
+  bool
+  ComputeMetricImage(const FixedImageRegionType &  fixedRegion,
+                     const MovingImageRegionType & movingRegion,
+                     MetricImageType *             metricImage) override;
+
+protected:
+  DiamondSearchMetricImageFilter();
+
+  /** The clone has a clone of the delegate MetricImageFilter. */
+  LightObject::Pointer
+  InternalClone() const override;
+
+  void
+  GenerateData() override;
+
+  typename Superclass::Pointer m_MetricImageFilter;
+
+private:
+  MetricImagePixelType m_ExhaustiveSearchThreshold;
+  SizeValueType        m_NumberOfMetricEvaluations;
+
+  // The best displacement from the center of the search region of the
+  // previous block.
+  MovingImageOffsetType m_PreviousOffset;
+
+  // The metric of a single position, and which positions of the metric image
+  // have been evaluated.
+  MetricImagePointerType m_PositionMetricImage;
+  std::vector<bool>      m_Evaluated;
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkBlockMatchingDiamondSearchMetricImageFilter.hxx"
+#endif
+
+#endif
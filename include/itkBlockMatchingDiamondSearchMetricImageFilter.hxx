@@ -0,0 +1,264 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingDiamondSearchMetricImageFilter_hxx
+#define itkBlockMatchingDiamondSearchMetricImageFilter_hxx
+
+#include "itkBlockMatchingDiamondSearchMetricImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+DiamondSearchMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::DiamondSearchMetricImageFilter()
+  : m_ExhaustiveSearchThreshold(NumericTraits<MetricImagePixelType>::NonpositiveMin())
+  , m_NumberOfMetricEvaluations(0)
+{
+  m_MetricImageFilter = nullptr;
+  m_PreviousOffset.Fill(0);
+  m_PositionMetricImage = MetricImageType::New();
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+LightObject::Pointer
+DiamondSearchMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::InternalClone() const
+{
+  LightObject::Pointer   loPtr = Superclass::InternalClone();
+  typename Self::Pointer rval = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (rval.IsNull())
+  {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+  }
+  if (m_MetricImageFilter.GetPointer() != nullptr)
+  {
+    rval->m_MetricImageFilter = m_MetricImageFilter->Clone();
+  }
+  rval->m_ExhaustiveSearchThreshold = m_ExhaustiveSearchThreshold;
+  return loPtr;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+bool
+DiamondSearchMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::ComputeMetricImage(
+  const FixedImageRegionType &  fixedRegion,
+  const MovingImageRegionType & movingRegion,
+  MetricImageType *             metricImage)
+{
+  const FixedImageType *  fixedPtr = this->GetInput(0);
+  const MovingImageType * movingPtr = this->GetInput(1);
+  if (m_MetricImageFilter.IsNull() || !fixedPtr || !movingPtr || !metricImage)
+  {
+    return false;
+  }
+  if (!(fixedPtr->GetSpacing() == movingPtr->GetSpacing()))
+  {
+    return false;
+  }
+  typename Superclass::RadiusType radius;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    if (fixedRegion.GetSize()[i] % 2 == 0)
+    {
+      return false;
+    }
+    radius[i] = (fixedRegion.GetSize()[i] - 1) / 2;
+  }
+  m_MetricImageFilter->SetFixedImage(const_cast<FixedImageType *>(fixedPtr));
+  m_MetricImageFilter->SetMovingImage(const_cast<MovingImageType *>(movingPtr));
+
+  const MetricImagePixelType lowest = NumericTraits<MetricImagePixelType>::NonpositiveMin();
+  MovingImageRegionType      validRegion;
+  const bool                 isValid = this->AllocateMetricImage(movingRegion, radius, metricImage, validRegion);
+  metricImage->FillBuffer(lowest);
+  m_NumberOfMetricEvaluations = 0;
+  if (!isValid)
+  {
+    return true;
+  }
+
+  // The metric at a position of the search region, evaluated once.
+  m_Evaluated.assign(metricImage->GetBufferedRegion().GetNumberOfPixels(), false);
+  MetricImagePixelType * metricBuffer = metricImage->GetBufferPointer();
+  MovingImageRegionType  positionRegion;
+  positionRegion.GetModifiableSize().Fill(1);
+  bool isSupported = true;
+  auto evaluate = [&](const MovingImageIndexType & position) -> MetricImagePixelType {
+    if (!isSupported || !validRegion.IsInside(position))
+    {
+      return lowest;
+    }
+    typename MetricImageType::IndexType metricIndex;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      metricIndex[i] = position[i] - movingRegion.GetIndex()[i];
+    }
+    const OffsetValueType offset = metricImage->ComputeOffset(metricIndex);
+    if (!m_Evaluated[offset])
+    {
+      positionRegion.SetIndex(position);
+      if (!m_MetricImageFilter->ComputeMetricImage(fixedRegion, positionRegion, m_PositionMetricImage))
+      {
+        isSupported = false;
+        return lowest;
+      }
+      metricBuffer[offset] = m_PositionMetricImage->GetBufferPointer()[0];
+      m_Evaluated[offset] = true;
+      ++m_NumberOfMetricEvaluations;
+    }
+    return metricBuffer[offset];
+  };
+
+  // The large diamond, and the small diamond.
+  std::vector<MovingImageOffsetType> largePattern;
+  std::vector<MovingImageOffsetType> smallPattern;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    for (OffsetValueType sign = -1; sign <= 1; sign += 2)
+    {
+      MovingImageOffsetType offset;
+      offset.Fill(0);
+      offset[i] = 2 * sign;
+      largePattern.push_back(offset);
+      offset[i] = sign;
+      smallPattern.push_back(offset);
+      for (unsigned int j = i + 1; j < ImageDimension; ++j)
+      {
+        for (OffsetValueType otherSign = -1; otherSign <= 1; otherSign += 2)
+        {
+          offset[j] = otherSign;
+          largePattern.push_back(offset);
+        }
+        offset[j] = 0;
+      }
+    }
+  }
+
+  // Start from the better of the center and the displacement of the previous
+  // block.
+  MovingImageIndexType center;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    center[i] = movingRegion.GetIndex()[i] + static_cast<OffsetValueType>(movingRegion.GetSize()[i] / 2);
+  }
+  MovingImageIndexType best = center;
+  MetricImagePixelType bestMetric = evaluate(center);
+  const MovingImageIndexType previous = center + m_PreviousOffset;
+  const MetricImagePixelType previousMetric = evaluate(previous);
+  if (previousMetric > bestMetric)
+  {
+    best = previous;
+    bestMetric = previousMetric;
+  }
+
+  // Move each pattern to its best position until that is its center.  The
+  // metric increases at every move, so this ends.
+  auto search = [&](const std::vector<MovingImageOffsetType> & pattern) {
+    bool moved = true;
+    while (moved)
+    {
+      moved = false;
+      const MovingImageIndexType patternCenter = best;
+      for (const auto & offset : pattern)
+      {
+        const MovingImageIndexType position = patternCenter + offset;
+        const MetricImagePixelType metric = evaluate(position);
+        if (metric > bestMetric)
+        {
+          best = position;
+          bestMetric = metric;
+          moved = true;
+        }
+      }
+    }
+  };
+  search(largePattern);
+  search(smallPattern);
+  if (!isSupported)
+  {
+    return false;
+  }
+
+  if (bestMetric <= m_ExhaustiveSearchThreshold)
+  {
+    if (!m_MetricImageFilter->ComputeMetricImage(fixedRegion, movingRegion, metricImage))
+    {
+      return false;
+    }
+    m_NumberOfMetricEvaluations = validRegion.GetNumberOfPixels();
+    MetricImageRegionType validMetricRegion;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      validMetricRegion.SetIndex(i, validRegion.GetIndex()[i] - movingRegion.GetIndex()[i]);
+    }
+    validMetricRegion.SetSize(validRegion.GetSize());
+    ImageRegionConstIteratorWithIndex<MetricImageType> metricIt(metricImage, validMetricRegion);
+    bestMetric = lowest;
+    for (metricIt.GoToBegin(); !metricIt.IsAtEnd(); ++metricIt)
+    {
+      if (metricIt.Get() > bestMetric)
+      {
+        bestMetric = metricIt.Get();
+        for (unsigned int i = 0; i < ImageDimension; ++i)
+        {
+          best[i] = movingRegion.GetIndex()[i] + metricIt.GetIndex()[i];
+        }
+      }
+    }
+  }
+
+  m_PreviousOffset = best - center;
+  return true;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+void
+DiamondSearchMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::GenerateData()
+{
+  if (m_MetricImageFilter.GetPointer() == nullptr)
+  {
+    itkExceptionMacro(<< "The internal MetricImageFilter must be set.");
+  }
+
+  this->AllocateOutputs();
+  if (this->ComputeMetricImage(this->m_FixedImageRegion, this->m_MovingImageRegion, this->GetOutput()))
+  {
+    return;
+  }
+
+  // The delegate cannot evaluate single positions: evaluate all of them.
+  m_MetricImageFilter->SetFixedImage(const_cast<FixedImageType *>(this->GetInput(0)));
+  m_MetricImageFilter->SetMovingImage(const_cast<MovingImageType *>(this->GetInput(1)));
+  m_MetricImageFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  m_MetricImageFilter->SetFixedImageRegion(this->m_FixedImageRegion);
+  m_MetricImageFilter->SetMovingImageRegion(this->m_MovingImageRegion);
+  m_MetricImageFilter->GraftOutput(this->GetOutput());
+  m_MetricImageFilter->Update();
+  this->GraftOutput(m_MetricImageFilter->GetOutput());
+  m_NumberOfMetricEvaluations = this->m_MovingImageRegion.GetNumberOfPixels();
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
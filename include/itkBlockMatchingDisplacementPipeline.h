@@ -18,16 +18,20 @@
 #ifndef itkBlockMatchingDisplacementPipeline_h
 #define itkBlockMatchingDisplacementPipeline_h
 
+#include "UltrasoundExport.h"
 #include "itkAmoebaOptimizer.h"
+#include "itkCommand.h"
 #include "itkExpNegativeImageFilter.h"
 #include "itkImage.h"
 #include "itkImageToImageFilter.h"
+#include "itkMemoryUsageObserver.h"
 #include "itkVector.h"
 #include "itkWindowedSincInterpolateImageFunction.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 
 #include "itkBlockMatchingBayesianRegularizationDisplacementCalculator.h"
 #include "itkBlockMatchingBlockAffineTransformMetricImageFilter.h"
+#include "itkBlockMatchingCorrelationBlockRadiusImageSource.h"
 #include "itkBlockMatchingImageRegistrationMethod.h"
 #include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
 #include "itkBlockMatchingMultiResolutionImageRegistrationMethod.h"
@@ -45,8 +49,15 @@
 #include "itkBSplineApproximationGradientImageFilter.h"
 #include "itkLinearLeastSquaresGradientImageFilter.h"
 #include "itkHigherOrderAccurateGradientImageFilter.h"
+#include "itkSeparableWindowedSincResampleImageFilter.h"
 #include "itkStrainImageFilter.h"
 
+#include <chrono>
+#include <map>
+#include <utility>
+#include <ostream>
+#include <vector>
+
 
 namespace itk
 {
@@ -57,6 +68,14 @@ namespace BlockMatching
  *
  * \brief Sets up and runs deformable image registration pipeline with block-matching.
  *
+ * The metric images, the helper images of the metric and the displacements
+ * have the TMetricPixel.  A float TMetricPixel halves their memory and the
+ * bandwidth of the metric and the regularization, which are bound by it, and
+ * the normalized cross correlation in [-1, 1] does not need more precision to
+ * locate its peaks: the sums of the metric are accumulated in double, see
+ * NumericTraits::RealType, directly from the fixed and moving pixels, e.g.
+ * the signed short RF samples, without converted copies of the images.
+ *
  * \ingroup Ultrasound
  */
 template <typename TFixedPixel = signed short,
@@ -102,23 +121,14 @@ public:
 
   using CoordRepType = TCoordRep;
 
-  using FixedResamplerType = ResampleImageFilter<FixedImageType, FixedImageType, CoordRepType>;
-  using MovingResamplerType = ResampleImageFilter<MovingImageType, MovingImageType, CoordRepType>;
-
+  /** The inputs are upsampled uniformly, with a separable windowed sinc
+   * kernel whose weights are computed once per output sample and direction. */
   const static unsigned int RESAMPLE_RADIUS = 4;
   using ResampleWindowType = Function::WelchWindowFunction<RESAMPLE_RADIUS>;
-  using FixedBoundaryConditionType = ZeroFluxNeumannBoundaryCondition<FixedImageType>;
-  using FixedResamplerInterpolatorType = WindowedSincInterpolateImageFunction<FixedImageType,
-                                                                              RESAMPLE_RADIUS,
-                                                                              ResampleWindowType,
-                                                                              FixedBoundaryConditionType,
-                                                                              CoordRepType>;
-  using MovingBoundaryConditionType = ZeroFluxNeumannBoundaryCondition<MovingImageType>;
-  using MovingResamplerInterpolatorType = WindowedSincInterpolateImageFunction<MovingImageType,
-                                                                               RESAMPLE_RADIUS,
-                                                                               ResampleWindowType,
-                                                                               MovingBoundaryConditionType,
-                                                                               CoordRepType>;
+  using FixedResamplerType =
+    SeparableWindowedSincResampleImageFilter<FixedImageType, FixedImageType, RESAMPLE_RADIUS, ResampleWindowType>;
+  using MovingResamplerType =
+    SeparableWindowedSincResampleImageFilter<MovingImageType, MovingImageType, RESAMPLE_RADIUS, ResampleWindowType>;
 
   /** The block radius calculator. */
   using BlockRadiusCalculatorType = BlockMatching::MultiResolutionMinMaxBlockRadiusCalculator<FixedImageType>;
@@ -127,10 +137,17 @@ public:
   using SearchRegionImageSourceType =
     BlockMatching::MultiResolutionMinMaxSearchRegionImageSource<FixedImageType, MovingImageType, DisplacementImageType>;
 
+  /** The source of the radius of every block, for adaptive block sizes. */
+  using BlockRadiusImageSourceType =
+    BlockMatching::CorrelationBlockRadiusImageSource<FixedImageType, MovingImageType, DisplacementImageType>;
+
   /** The registration method. */
   using LevelRegistrationMethodType = BlockMatching::
     ImageRegistrationMethod<FixedImageType, MovingImageType, MetricImageType, DisplacementImageType, CoordRepType>;
 
+  /** The mask of the region of interest. */
+  using MaskImageType = typename LevelRegistrationMethodType::MaskImageType;
+
   /** Interpolation classes. */
   using ParabolicInterpolatorType =
     BlockMatching::ParabolicInterpolationDisplacementCalculator<MetricImageType, DisplacementImageType>;
@@ -273,6 +290,64 @@ public:
   itkSetMacro(RegularizationStrainSigma, RegularizationStrainSigmaType);
   itkGetConstReferenceMacro(RegularizationStrainSigma, RegularizationStrainSigmaType);
 
+  /** Number of levels of the pyramid, from one to three, the default.  The
+   * levels that are removed are the coarsest ones, and the top block radius and
+   * search region factor apply to the top of the remaining levels. */
+  itkSetClampMacro(NumberOfLevels, unsigned int, 1, 3);
+  itkGetConstMacro(NumberOfLevels, unsigned int);
+
+  /** Set/Get the displacements that center the search regions of the top
+   * level, instead of the blocks.  For a cine sequence, this is the output for
+   * the previous frame, so that fewer levels and a smaller top search region
+   * factor suffice.  Set to nullptr to start from no displacement. */
+  void
+  SetInitialDisplacements(const DisplacementImageType * displacements)
+  {
+    m_SearchRegionImageSource->SetInitialDisplacements(displacements);
+    this->Modified();
+  }
+  const DisplacementImageType *
+  GetInitialDisplacements() const
+  {
+    return m_SearchRegionImageSource->GetInitialDisplacements();
+  }
+
+  /** Set/Get whether the moving image of the last update, when it is the fixed
+   * image of this one, is not resampled and decomposed into a pyramid again.
+   * This is the case of the consecutive frames of a cine sequence.  See
+   * MultiResolutionImageRegistrationMethod::SetReuseMovingImagePyramid().
+   * Defaults to false. */
+  itkSetMacro(ReuseMovingImagePyramid, bool);
+  itkGetConstMacro(ReuseMovingImagePyramid, bool);
+  itkBooleanMacro(ReuseMovingImagePyramid);
+
+  /** Set/Get the number of slabs along the last direction the displacement
+   * grid of every level is matched in, so that only the parts of the images
+   * and the metric images of a slab are needed at a time, for volumes.  See
+   * ImageRegistrationMethod::SetNumberOfSlabs().  Defaults to 1. */
+  itkSetClampMacro(NumberOfSlabs, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfSlabs, unsigned int);
+
+  /** Set/Get whether the blocks of the levels below the top one, or of every
+   * level with initial displacements, are sized by how well they correlate at
+   * the displacements of the level above: the blocks that match well shrink,
+   * down to half the block radius of the level by default.  See
+   * GetBlockRadiusImageSource() to tune the sizing.  Defaults to false. */
+  itkSetMacro(AdaptiveBlockRadius, bool);
+  itkGetConstMacro(AdaptiveBlockRadius, bool);
+  itkBooleanMacro(AdaptiveBlockRadius);
+
+  /** Get the source of the radius of every block, used with
+   * AdaptiveBlockRadius. */
+  itkGetModifiableObjectMacro(BlockRadiusImageSource, BlockRadiusImageSourceType);
+
+  /** Set/Get the mask of the region of interest, in the physical space of the
+   * fixed image.  Only the blocks whose center is in the mask are matched, at
+   * every level; the others are missing for the regularization and the strain
+   * window, and their displacements are zero.  By default there is none. */
+  itkSetObjectMacro(Mask, MaskImageType);
+  itkGetConstObjectMacro(Mask, MaskImageType);
+
   /** Maximum number of iterations during regularization at the bottom level. */
   itkSetMacro(RegularizationMaximumNumberOfIterations, unsigned int);
   itkGetConstMacro(RegularizationMaximumNumberOfIterations, unsigned int);
@@ -280,6 +355,81 @@ public:
   /** Get the multi-resolution image registration method. */
   itkGetModifiableObjectMacro(MultiResolutionRegistrationMethod, RegistrationMethodType);
 
+  /** Set/Get the registration method of every level, for example an
+   * OpenCLImageRegistrationMethod to match the blocks on a device.  The
+   * pipeline sets its metric image filter and its options. */
+  itkSetObjectMacro(LevelRegistrationMethod, LevelRegistrationMethodType);
+  itkGetModifiableObjectMacro(LevelRegistrationMethod, LevelRegistrationMethodType);
+
+  /** Wall times, in seconds, and counters of a level of the pyramid.  The
+   * metric time is the time of the level registration method less the
+   * regularization and the strain window iterations, so it includes the peak
+   * interpolation.  The number of metric evaluations is the number of positions
+   * of the search regions.  PeakMemory is the largest memory use of the
+   * process, in kB as reported by MemoryUsageObserver, at the start and end of
+   * the stages of the level. */
+  struct LevelStatistics
+  {
+    double        SearchRegionTime{ 0.0 };
+    double        MetricTime{ 0.0 };
+    double        RegularizationTime{ 0.0 };
+    double        StrainWindowTime{ 0.0 };
+    SizeValueType NumberOfBlocks{ 0 };
+    SizeValueType NumberOfMetricEvaluations{ 0 };
+    SizeValueType RegularizationIterations{ 0 };
+    SizeValueType StrainWindowIterations{ 0 };
+    double        PeakMemory{ 0.0 };
+  };
+
+  /** The statistics of the last update.  The inputs are upsampled and
+   * decomposed into pyramids before the first level, so the resampling time is
+   * for all the levels. */
+  struct Statistics
+  {
+    double                       ResamplingTime{ 0.0 };
+    double                       TotalTime{ 0.0 };
+    std::vector<LevelStatistics> Levels;
+  };
+
+  /** Set/Get whether the statistics of the updates are collected.  Defaults
+   * to false. */
+  itkSetMacro(CollectStatistics, bool);
+  itkGetConstMacro(CollectStatistics, bool);
+  itkBooleanMacro(CollectStatistics);
+
+  /** Get the statistics of the last update, when CollectStatistics is on. */
+  const Statistics &
+  GetStatistics() const
+  {
+    return m_Statistics;
+  }
+
+  /** Write the statistics of the last update as a JSON object, with one
+   * object per level in "Levels", from the coarsest. */
+  void
+  WriteStatistics(std::ostream & os) const;
+
+  /** Estimate, in bytes, the peak memory of an update from the geometry of the
+   * inputs and the parameters, without matching any block.  This counts the
+   * upsampled inputs, their pyramids, the output, and the level that needs
+   * the most: its search regions, displacements and strains, and the metric
+   * images cached for one slab of blocks, as large as the search regions,
+   * twice at the bottom level for the priors of the regularization.  The
+   * output information is updated; the inputs are not counted. */
+  SizeValueType
+  EstimateMemoryFootprint();
+
+  /** Run the pipeline once on a pair of frames with the geometry of the given
+   * image, whose pixels are not read, so that the first pair of that
+   * geometry runs at the speed of the following ones: the internal filters
+   * of every level are created and set up, the Gaussian kernels of the
+   * regularization and the FFT plans computed, and the pyramids, search
+   * regions and metric images allocated by this update.  The fixed and
+   * moving images are restored, and the output holds the warmup
+   * displacements until the next update. */
+  void
+  Prepare(const FixedImageType * geometry);
+
 protected:
   DisplacementPipeline();
 
@@ -295,15 +445,37 @@ protected:
 
 
 private:
-  typename FixedResamplerType::Pointer              m_FixedResampler;
-  typename MovingResamplerType::Pointer             m_MovingResampler;
-  typename FixedResamplerInterpolatorType::Pointer  m_FixedResamplerInterpolator;
-  typename MovingResamplerInterpolatorType::Pointer m_MovingResamplerInterpolator;
+  /** Exchange the resamplers if the moving resampler has the fixed image as
+   * input, so that its output is the fixed image of the registration method.
+   * The template matches different fixed and moving image types, whose
+   * resamplers cannot be exchanged. */
+  void
+  ExchangeResamplers(const FixedImageType *                 fixed,
+                     typename FixedResamplerType::Pointer & fixedResampler,
+                     typename FixedResamplerType::Pointer & movingResampler);
+  template <typename TMovingResamplerPointer>
+  void
+  ExchangeResamplers(const FixedImageType *, typename FixedResamplerType::Pointer &, TMovingResamplerPointer &)
+  {}
+
+  /** Time the stage that starts or ends with the event, and sample the memory
+   * use, for the statistics. */
+  void
+  CollectStatisticsEvent(Object * caller, const EventObject & event);
+
+  using StatisticsClockType = std::chrono::steady_clock;
+
+  typename FixedResamplerType::Pointer  m_FixedResampler;
+  typename MovingResamplerType::Pointer m_MovingResampler;
 
   typename BlockRadiusCalculatorType::Pointer m_BlockRadiusCalculator;
 
   typename SearchRegionImageSourceType::Pointer m_SearchRegionImageSource;
 
+  typename BlockRadiusImageSourceType::Pointer m_BlockRadiusImageSource;
+
+  typename MaskImageType::Pointer m_Mask;
+
   typename LevelRegistrationMethodType::Pointer m_LevelRegistrationMethod;
   TextProgressBarCommand::Pointer               m_TextProgressBar;
   bool                                          m_LevelRegistrationMethodTextProgressBar;
@@ -338,12 +510,23 @@ private:
   SearchRegionFactorType m_SearchRegionBottomFactor;
 
   unsigned int m_Direction;
+  unsigned int m_NumberOfLevels;
   double       m_BlockOverlap;
   double       m_MaximumAbsStrainAllowed;
   bool         m_ScaleBlockByStrain;
+  bool         m_ReuseMovingImagePyramid;
+  unsigned int m_NumberOfSlabs;
+  bool         m_AdaptiveBlockRadius;
 
   RegularizationStrainSigmaType m_RegularizationStrainSigma;
   unsigned int                  m_RegularizationMaximumNumberOfIterations;
+
+  bool                                                      m_CollectStatistics;
+  Statistics                                                m_Statistics;
+  typename MemberCommand<Self>::Pointer                     m_StatisticsCommand;
+  std::vector<std::pair<Object *, unsigned long>>           m_StatisticsObservers;
+  std::map<const Object *, StatisticsClockType::time_point> m_StatisticsStartTimes;
+  MemoryUsageObserver                                       m_MemoryUsageObserver;
 };
 
 } // end namespace BlockMatching
@@ -353,4 +536,19 @@ private:
 #  include "itkBlockMatchingDisplacementPipeline.hxx"
 #endif
 
+// The common instantiations are compiled into the Ultrasound library.
+#if !defined(ITK_TEMPLATE_EXPLICIT_DisplacementPipeline)
+namespace itk
+{
+namespace BlockMatching
+{
+ITK_GCC_PRAGMA_DIAG_PUSH()
+ITK_GCC_PRAGMA_DIAG(ignored "-Wattributes")
+extern template class Ultrasound_EXPORT_EXPLICIT DisplacementPipeline<signed short, signed short, float, double, 2>;
+extern template class Ultrasound_EXPORT_EXPLICIT DisplacementPipeline<signed short, signed short, double, double, 2>;
+ITK_GCC_PRAGMA_DIAG_POP()
+} // end namespace BlockMatching
+} // end namespace itk
+#endif
+
 #endif
@@ -20,6 +20,13 @@
 
 #include "itkBlockMatchingDisplacementPipeline.h"
 
+#include "itkImageRegionConstIterator.h"
+#include "itkWarmupImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 namespace itk
 {
 namespace BlockMatching
@@ -33,24 +40,29 @@ template <typename TFixedPixel,
 DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageDimension>::DisplacementPipeline()
   : m_LevelRegistrationMethodTextProgressBar(false)
   , m_Direction(0)
+  , m_NumberOfLevels(3)
   , m_MaximumAbsStrainAllowed(0.075)
   , m_BlockOverlap(0.75)
   , m_ScaleBlockByStrain(true)
+  , m_ReuseMovingImagePyramid(false)
+  , m_NumberOfSlabs(1)
+  , m_AdaptiveBlockRadius(false)
   , m_RegularizationMaximumNumberOfIterations(2)
+  , m_CollectStatistics(false)
 {
   this->SetNumberOfRequiredInputs(2);
 
   m_FixedResampler = FixedResamplerType::New();
   m_MovingResampler = MovingResamplerType::New();
-  m_FixedResamplerInterpolator = FixedResamplerInterpolatorType::New();
-  m_MovingResamplerInterpolator = MovingResamplerInterpolatorType::New();
-  m_FixedResampler->SetInterpolator(m_FixedResamplerInterpolator);
-  m_MovingResampler->SetInterpolator(m_MovingResamplerInterpolator);
 
   m_BlockRadiusCalculator = BlockRadiusCalculatorType::New();
 
   m_SearchRegionImageSource = SearchRegionImageSourceType::New();
 
+  m_BlockRadiusImageSource = BlockRadiusImageSourceType::New();
+
+  m_Mask = nullptr;
+
   m_LevelRegistrationMethod = LevelRegistrationMethodType::New();
   m_TextProgressBar = TextProgressBarCommand::New();
 
@@ -120,6 +132,20 @@ DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageD
 
   m_RegularizationStrainSigma[0] = 0.075;
   m_RegularizationStrainSigma[1] = 0.15;
+
+  // The elevational direction of a volume has the lateral defaults.
+  for (unsigned int i = 2; i < ImageDimension; ++i)
+  {
+    m_UpsamplingRatio[i] = m_UpsamplingRatio[1];
+    m_TopBlockRadius[i] = m_TopBlockRadius[1];
+    m_BottomBlockRadius[i] = m_BottomBlockRadius[1];
+    m_SearchRegionTopFactor[i] = m_SearchRegionTopFactor[1];
+    m_SearchRegionBottomFactor[i] = m_SearchRegionBottomFactor[1];
+    m_RegularizationStrainSigma[i] = m_RegularizationStrainSigma[1];
+  }
+
+  m_StatisticsCommand = MemberCommand<Self>::New();
+  m_StatisticsCommand->SetCallbackFunction(this, &Self::CollectStatisticsEvent);
 }
 
 
@@ -165,42 +191,49 @@ DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageD
   fixed->UpdateOutputInformation();
   moving->UpdateOutputInformation();
 
-  // Upsampling.
+  // Upsampling.  The resampler of the last moving image, when it is the fixed
+  // image, is up to date, and its output is the image whose pyramid may be
+  // reused.
+  if (m_ReuseMovingImagePyramid)
+  {
+    this->ExchangeResamplers(fixed, m_FixedResampler, m_MovingResampler);
+  }
   m_FixedResampler->SetInput(fixed);
   m_FixedResampler->SetOutputOrigin(fixed->GetOrigin());
-  m_FixedResampler->SetOutputDirection(fixed->GetDirection());
   m_FixedResampler->SetOutputStartIndex(fixed->GetLargestPossibleRegion().GetIndex());
 
   typename FixedImageType::SizeType    size;
   typename FixedImageType::SpacingType spacing;
-  size[0] = static_cast<typename FixedImageType::SizeType::SizeValueType>(
-    fixed->GetLargestPossibleRegion().GetSize()[0] * m_UpsamplingRatio[0]);
-  size[1] = static_cast<typename FixedImageType::SizeType::SizeValueType>(
-    fixed->GetLargestPossibleRegion().GetSize()[1] * m_UpsamplingRatio[1]);
-  spacing[0] = fixed->GetSpacing()[0] / m_UpsamplingRatio[0];
-  spacing[1] = fixed->GetSpacing()[1] / m_UpsamplingRatio[1];
+  bool                                 upsampling = false;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    size[i] = static_cast<typename FixedImageType::SizeType::SizeValueType>(
+      fixed->GetLargestPossibleRegion().GetSize()[i] * m_UpsamplingRatio[i]);
+    spacing[i] = fixed->GetSpacing()[i] / m_UpsamplingRatio[i];
+    upsampling = upsampling || m_UpsamplingRatio[i] != 1.0;
+  }
   m_FixedResampler->SetOutputSpacing(spacing);
   m_FixedResampler->SetSize(size);
   m_MovingResampler->SetInput(moving);
   m_MovingResampler->SetOutputOrigin(moving->GetOrigin());
-  m_MovingResampler->SetOutputDirection(moving->GetDirection());
   m_MovingResampler->SetOutputStartIndex(moving->GetLargestPossibleRegion().GetIndex());
-  size[0] = static_cast<typename MovingImageType::SizeType::SizeValueType>(
-    moving->GetLargestPossibleRegion().GetSize()[0] * m_UpsamplingRatio[0]);
-  size[1] = static_cast<typename MovingImageType::SizeType::SizeValueType>(
-    moving->GetLargestPossibleRegion().GetSize()[1] * m_UpsamplingRatio[1]);
-  spacing[0] = moving->GetSpacing()[0] / m_UpsamplingRatio[0];
-  spacing[1] = moving->GetSpacing()[1] / m_UpsamplingRatio[1];
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    size[i] = static_cast<typename MovingImageType::SizeType::SizeValueType>(
+      moving->GetLargestPossibleRegion().GetSize()[i] * m_UpsamplingRatio[i]);
+    spacing[i] = moving->GetSpacing()[i] / m_UpsamplingRatio[i];
+  }
   m_MovingResampler->SetOutputSpacing(spacing);
   m_MovingResampler->SetSize(size);
 
   // Block Radius Calculator
   RadiusType minBlockRadius;
   RadiusType maxBlockRadius;
-  minBlockRadius[0] = m_BottomBlockRadius[0];
-  minBlockRadius[1] = m_BottomBlockRadius[1];
-  maxBlockRadius[0] = m_TopBlockRadius[0];
-  maxBlockRadius[1] = m_TopBlockRadius[1];
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    minBlockRadius[i] = m_BottomBlockRadius[i];
+    maxBlockRadius[i] = m_TopBlockRadius[i];
+  }
   m_BlockRadiusCalculator->SetMinRadius(minBlockRadius);
   m_BlockRadiusCalculator->SetMaxRadius(maxBlockRadius);
 
@@ -208,34 +241,45 @@ DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageD
   m_SearchRegionImageSource->SetMaxFactor(m_SearchRegionTopFactor);
   m_SearchRegionImageSource->SetMinFactor(m_SearchRegionBottomFactor);
 
-  typename SearchRegionImageSourceType::PyramidScheduleType pyramidSchedule(3, ImageDimension);
-  if (m_Direction == 1)
+  // The shrink factors of the levels are 3, 2, 1 along the axial direction and
+  // 2, 1, 1 along the others.
+  typename SearchRegionImageSourceType::PyramidScheduleType fullPyramidSchedule(3, ImageDimension);
+  for (unsigned int i = 0; i < ImageDimension; ++i)
   {
-    pyramidSchedule(0, 0) = 2;
-    pyramidSchedule(0, 1) = 3;
-    pyramidSchedule(1, 0) = 1;
-    pyramidSchedule(1, 1) = 2;
-    pyramidSchedule(2, 0) = 1;
-    pyramidSchedule(2, 1) = 1;
+    const bool axial = i == m_Direction;
+    fullPyramidSchedule(0, i) = axial ? 3 : 2;
+    fullPyramidSchedule(1, i) = axial ? 2 : 1;
+    fullPyramidSchedule(2, i) = 1;
   }
-  else
+  // The finest levels.
+  typename SearchRegionImageSourceType::PyramidScheduleType pyramidSchedule(m_NumberOfLevels, ImageDimension);
+  for (unsigned int level = 0; level < m_NumberOfLevels; ++level)
   {
-    pyramidSchedule(0, 0) = 3;
-    pyramidSchedule(0, 1) = 2;
-    pyramidSchedule(1, 0) = 2;
-    pyramidSchedule(1, 1) = 1;
-    pyramidSchedule(2, 0) = 1;
-    pyramidSchedule(2, 1) = 1;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      pyramidSchedule(level, i) = fullPyramidSchedule(level + fullPyramidSchedule.rows() - m_NumberOfLevels, i);
+    }
   }
   m_SearchRegionImageSource->SetPyramidSchedule(pyramidSchedule);
   m_SearchRegionImageSource->SetOverlapSchedule(m_BlockOverlap);
 
   // The registration method.
+  m_MultiResolutionRegistrationMethod->SetImageRegistrationMethod(m_LevelRegistrationMethod);
   m_LevelRegistrationMethod->RemoveAllObservers();
   if (m_LevelRegistrationMethodTextProgressBar)
   {
     m_LevelRegistrationMethod->AddObserver(itk::ProgressEvent(), m_TextProgressBar);
   }
+  m_LevelRegistrationMethod->SetNumberOfSlabs(m_NumberOfSlabs);
+  if (m_AdaptiveBlockRadius)
+  {
+    m_MultiResolutionRegistrationMethod->SetBlockRadiusImageSource(m_BlockRadiusImageSource);
+  }
+  else
+  {
+    m_MultiResolutionRegistrationMethod->SetBlockRadiusImageSource(nullptr);
+  }
+  m_MultiResolutionRegistrationMethod->SetMask(m_Mask);
 
   // Filter out peak hopping.
   using StrainTensorType = typename StrainWindowDisplacementCalculatorType::StrainTensorType;
@@ -285,7 +329,7 @@ DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageD
   // regularizer->SetMeanChangeThreshold( 1.0e-25 );
   // regularizer->SetDisplacementCalculator( interpolator );
 
-  if (m_UpsamplingRatio[0] == 1.0 && m_UpsamplingRatio[1] == 1.0)
+  if (!upsampling)
   {
     m_MultiResolutionRegistrationMethod->SetFixedImage(fixed);
     m_MultiResolutionRegistrationMethod->SetMovingImage(moving);
@@ -296,6 +340,25 @@ DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageD
     m_MultiResolutionRegistrationMethod->SetMovingImage(m_MovingResampler->GetOutput());
   }
   m_MultiResolutionRegistrationMethod->SetSchedules(pyramidSchedule, pyramidSchedule);
+  m_MultiResolutionRegistrationMethod->SetReuseMovingImagePyramid(m_ReuseMovingImagePyramid);
+}
+
+
+template <typename TFixedPixel,
+          typename TMovingPixel,
+          typename TMetricPixel,
+          typename TCoordRep,
+          unsigned int VImageDimension>
+void
+DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageDimension>::ExchangeResamplers(
+  const FixedImageType *                 fixed,
+  typename FixedResamplerType::Pointer & fixedResampler,
+  typename FixedResamplerType::Pointer & movingResampler)
+{
+  if (movingResampler->GetInput() == fixed && fixedResampler->GetInput() != fixed)
+  {
+    std::swap(fixedResampler, movingResampler);
+  }
 }
 
 
@@ -316,9 +379,301 @@ DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageD
   m_DisplacementCalculatorCommand->SetLevelNRegularizerIterations(m_RegularizationMaximumNumberOfIterations);
   m_DisplacementCalculatorCommand->SetMultiResolutionMethod(m_MultiResolutionRegistrationMethod);
   m_MultiResolutionRegistrationMethod->AddObserver(itk::IterationEvent(), m_DisplacementCalculatorCommand);
+
+  // Time the stages, which start and end one after the other, except the
+  // regularization and the strain window iterations, in the level
+  // registration method.  The observers of an update that threw are removed
+  // first.
+  for (const auto & observer : m_StatisticsObservers)
+  {
+    observer.first->RemoveObserver(observer.second);
+  }
+  m_StatisticsObservers.clear();
+  m_StatisticsStartTimes.clear();
+  m_Statistics = Statistics();
+  if (m_CollectStatistics)
+  {
+    Object * stages[] = { m_FixedResampler.GetPointer(),
+                          m_MovingResampler.GetPointer(),
+                          m_MultiResolutionRegistrationMethod->GetModifiableFixedImagePyramid(),
+                          m_MultiResolutionRegistrationMethod->GetModifiableMovingImagePyramid(),
+                          m_SearchRegionImageSource.GetPointer(),
+                          m_LevelRegistrationMethod.GetPointer(),
+                          m_Regularizer.GetPointer(),
+                          m_StrainWindower.GetPointer() };
+    for (Object * stage : stages)
+    {
+      if (stage)
+      {
+        m_StatisticsObservers.emplace_back(stage, stage->AddObserver(StartEvent(), m_StatisticsCommand));
+        m_StatisticsObservers.emplace_back(stage, stage->AddObserver(EndEvent(), m_StatisticsCommand));
+      }
+    }
+  }
+  const StatisticsClockType::time_point start = StatisticsClockType::now();
+
   m_MultiResolutionRegistrationMethod->GraftOutput(this->GetOutput());
   m_MultiResolutionRegistrationMethod->Update();
   this->GraftOutput(m_MultiResolutionRegistrationMethod->GetOutput());
+
+  if (m_CollectStatistics)
+  {
+    m_Statistics.TotalTime = std::chrono::duration<double>(StatisticsClockType::now() - start).count();
+  }
+  for (const auto & observer : m_StatisticsObservers)
+  {
+    observer.first->RemoveObserver(observer.second);
+  }
+  m_StatisticsObservers.clear();
+}
+
+
+template <typename TFixedPixel,
+          typename TMovingPixel,
+          typename TMetricPixel,
+          typename TCoordRep,
+          unsigned int VImageDimension>
+void
+DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageDimension>::CollectStatisticsEvent(
+  Object *            caller,
+  const EventObject & event)
+{
+  const bool starts = StartEvent().CheckEvent(&event);
+  if (!starts && !EndEvent().CheckEvent(&event))
+  {
+    return;
+  }
+  const StatisticsClockType::time_point now = StatisticsClockType::now();
+
+  // The inputs are resampled before the first level.
+  const bool resampling = caller == m_FixedResampler.GetPointer() || caller == m_MovingResampler.GetPointer() ||
+                          caller == m_MultiResolutionRegistrationMethod->GetFixedImagePyramid() ||
+                          caller == m_MultiResolutionRegistrationMethod->GetMovingImagePyramid();
+  LevelStatistics * level = nullptr;
+  if (!resampling)
+  {
+    const unsigned int currentLevel = m_MultiResolutionRegistrationMethod->GetCurrentLevel();
+    if (m_Statistics.Levels.size() <= currentLevel)
+    {
+      m_Statistics.Levels.resize(currentLevel + 1);
+    }
+    level = &m_Statistics.Levels[currentLevel];
+    level->PeakMemory =
+      std::max(level->PeakMemory, static_cast<double>(m_MemoryUsageObserver.GetMemoryUsage()));
+  }
+
+  if (starts)
+  {
+    m_StatisticsStartTimes[caller] = now;
+    if (caller == m_LevelRegistrationMethod.GetPointer())
+    {
+      using SearchRegionImageType = typename LevelRegistrationMethodType::SearchRegionImageType;
+      const SearchRegionImageType * searchRegions = m_LevelRegistrationMethod->GetInput();
+      level->NumberOfBlocks = searchRegions->GetBufferedRegion().GetNumberOfPixels();
+      ImageRegionConstIterator<SearchRegionImageType> searchIt(searchRegions, searchRegions->GetBufferedRegion());
+      for (searchIt.GoToBegin(); !searchIt.IsAtEnd(); ++searchIt)
+      {
+        level->NumberOfMetricEvaluations += searchIt.Get().GetNumberOfPixels();
+      }
+    }
+    return;
+  }
+
+  const double seconds = std::chrono::duration<double>(now - m_StatisticsStartTimes[caller]).count();
+  if (resampling)
+  {
+    m_Statistics.ResamplingTime += seconds;
+  }
+  else if (caller == m_SearchRegionImageSource.GetPointer())
+  {
+    level->SearchRegionTime += seconds;
+  }
+  else if (caller == m_Regularizer.GetPointer())
+  {
+    level->RegularizationTime += seconds;
+    level->RegularizationIterations = m_Regularizer->GetCurrentIteration();
+  }
+  else if (caller == m_StrainWindower.GetPointer())
+  {
+    level->StrainWindowTime += seconds;
+    level->StrainWindowIterations = m_StrainWindower->GetCurrentIteration();
+  }
+  else if (caller == m_LevelRegistrationMethod.GetPointer())
+  {
+    level->MetricTime += seconds - level->RegularizationTime - level->StrainWindowTime;
+  }
+}
+
+
+template <typename TFixedPixel,
+          typename TMovingPixel,
+          typename TMetricPixel,
+          typename TCoordRep,
+          unsigned int VImageDimension>
+void
+DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageDimension>::WriteStatistics(
+  std::ostream & os) const
+{
+  os << "{\n";
+  os << "  \"ResamplingTime\": " << m_Statistics.ResamplingTime << ",\n";
+  os << "  \"TotalTime\": " << m_Statistics.TotalTime << ",\n";
+  os << "  \"Levels\": [";
+  for (size_t ii = 0; ii < m_Statistics.Levels.size(); ++ii)
+  {
+    const LevelStatistics & level = m_Statistics.Levels[ii];
+    os << (ii > 0 ? "," : "") << "\n    {\n";
+    os << "      \"Level\": " << ii << ",\n";
+    os << "      \"SearchRegionTime\": " << level.SearchRegionTime << ",\n";
+    os << "      \"MetricTime\": " << level.MetricTime << ",\n";
+    os << "      \"RegularizationTime\": " << level.RegularizationTime << ",\n";
+    os << "      \"StrainWindowTime\": " << level.StrainWindowTime << ",\n";
+    os << "      \"NumberOfBlocks\": " << level.NumberOfBlocks << ",\n";
+    os << "      \"NumberOfMetricEvaluations\": " << level.NumberOfMetricEvaluations << ",\n";
+    os << "      \"RegularizationIterations\": " << level.RegularizationIterations << ",\n";
+    os << "      \"StrainWindowIterations\": " << level.StrainWindowIterations << ",\n";
+    os << "      \"PeakMemory\": " << level.PeakMemory << "\n";
+    os << "    }";
+  }
+  os << "\n  ]\n}\n";
+}
+
+
+template <typename TFixedPixel,
+          typename TMovingPixel,
+          typename TMetricPixel,
+          typename TCoordRep,
+          unsigned int VImageDimension>
+SizeValueType
+DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageDimension>::EstimateMemoryFootprint()
+{
+  this->UpdateOutputInformation();
+
+  const typename FixedImageType::SizeType & inputFixedSize =
+    this->GetFixedImage()->GetLargestPossibleRegion().GetSize();
+  const typename MovingImageType::SizeType & inputMovingSize =
+    this->GetMovingImage()->GetLargestPossibleRegion().GetSize();
+  typename FixedImageType::SizeType  fixedSize;
+  typename MovingImageType::SizeType movingSize;
+  bool                               upsampling = false;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    fixedSize[i] = static_cast<SizeValueType>(inputFixedSize[i] * m_UpsamplingRatio[i]);
+    movingSize[i] = static_cast<SizeValueType>(inputMovingSize[i] * m_UpsamplingRatio[i]);
+    upsampling = upsampling || m_UpsamplingRatio[i] != 1.0;
+  }
+
+  SizeValueType footprint = this->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(VectorType);
+  if (upsampling)
+  {
+    footprint += typename FixedImageType::RegionType(fixedSize).GetNumberOfPixels() * sizeof(FixedPixelType);
+    footprint += typename MovingImageType::RegionType(movingSize).GetNumberOfPixels() * sizeof(MovingPixelType);
+  }
+
+  // The search region, the displacements of the level and of the level above,
+  // the strain of the strain window, and the cached metric image and its
+  // center point, for every block.
+  using StrainTensorType = typename StrainWindowDisplacementCalculatorType::StrainTensorType;
+  const SizeValueType blockBytes = sizeof(typename FixedImageType::RegionType) + 2 * sizeof(VectorType) +
+                                   sizeof(StrainTensorType) + sizeof(typename MetricImageType::Pointer) +
+                                   sizeof(typename MetricImageType::PointType);
+
+  // The block radius and the search region factor go linearly from the top
+  // level to the bottom one, as in the block radius calculator and the
+  // search region image source.
+  const typename SearchRegionImageSourceType::PyramidScheduleType & schedule =
+    m_SearchRegionImageSource->GetPyramidSchedule();
+  const double  distance = static_cast<double>(m_NumberOfLevels - 1);
+  SizeValueType peakLevelFootprint = 0;
+  for (unsigned int level = 0; level < m_NumberOfLevels; ++level)
+  {
+    SizeValueType levelFixedPixels = 1;
+    SizeValueType levelMovingPixels = 1;
+    SizeValueType numberOfBlocks = 1;
+    SizeValueType slabBlocks = 1;
+    SizeValueType searchRegionPixels = 1;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      const SizeValueType shrink = std::max<SizeValueType>(schedule(level, i), 1);
+      const SizeValueType levelFixedSize = std::max<SizeValueType>(fixedSize[i] / shrink, 1);
+      levelFixedPixels *= levelFixedSize;
+      levelMovingPixels *= std::max<SizeValueType>(movingSize[i] / shrink, 1);
+
+      double radiusSlope = 0.0;
+      double factorSlope = 0.0;
+      if (distance > 0.0)
+      {
+        radiusSlope =
+          (static_cast<double>(m_BottomBlockRadius[i]) - static_cast<double>(m_TopBlockRadius[i])) / distance;
+        factorSlope = (m_SearchRegionBottomFactor[i] - m_SearchRegionTopFactor[i]) / distance;
+      }
+      const SizeValueType blockRadius = std::max<SizeValueType>(
+        static_cast<SizeValueType>(radiusSlope * level + static_cast<double>(m_TopBlockRadius[i])), 1);
+      const SizeValueType searchRadius =
+        static_cast<SizeValueType>(std::ceil(blockRadius * (factorSlope * level + m_SearchRegionTopFactor[i])));
+      searchRegionPixels *= 2 * searchRadius + 1;
+
+      // The size of the displacement grid of the search region image source.
+      const double gridSize = std::floor((static_cast<double>(levelFixedSize) - 2.0 * blockRadius - 2.0) /
+                                         (2.0 * blockRadius * m_BlockOverlap)) -
+                              2.0;
+      const SizeValueType blocks = gridSize > 0.0 ? static_cast<SizeValueType>(gridSize) : 0;
+      numberOfBlocks *= blocks;
+      if (i == ImageDimension - 1)
+      {
+        slabBlocks *= (blocks + m_NumberOfSlabs - 1) / m_NumberOfSlabs;
+      }
+      else
+      {
+        slabBlocks *= blocks;
+      }
+    }
+    footprint += levelFixedPixels * sizeof(FixedPixelType) + levelMovingPixels * sizeof(MovingPixelType);
+
+    const bool          regularized = level == m_NumberOfLevels - 1 && m_RegularizationMaximumNumberOfIterations > 0;
+    const SizeValueType metricImageBytes = searchRegionPixels * sizeof(MetricPixelType) + sizeof(MetricImageType);
+    const SizeValueType levelFootprint =
+      numberOfBlocks * blockBytes + (regularized ? 2 : 1) * slabBlocks * metricImageBytes;
+    peakLevelFootprint = std::max(peakLevelFootprint, levelFootprint);
+  }
+  footprint += peakLevelFootprint;
+
+  return footprint;
+}
+
+
+template <typename TFixedPixel,
+          typename TMovingPixel,
+          typename TMetricPixel,
+          typename TCoordRep,
+          unsigned int VImageDimension>
+void
+DisplacementPipeline<TFixedPixel, TMovingPixel, TMetricPixel, TCoordRep, VImageDimension>::Prepare(
+  const FixedImageType * geometry)
+{
+  if (geometry == nullptr)
+  {
+    itkExceptionMacro(<< "The geometry of the frames is required.");
+  }
+
+  // Different frames, so that the blocks match as in an acquisition.
+  const typename FixedImageType::ConstPointer  fixedImage = this->GetFixedImage();
+  const typename MovingImageType::ConstPointer movingImage = this->GetMovingImage();
+  this->SetFixedImage(CreateWarmupImage<FixedImageType>(geometry, 1));
+  this->SetMovingImage(CreateWarmupImage<MovingImageType>(geometry, 2));
+  const auto restoreImages = [&]() {
+    this->SetFixedImage(const_cast<FixedImageType *>(fixedImage.GetPointer()));
+    this->SetMovingImage(const_cast<MovingImageType *>(movingImage.GetPointer()));
+  };
+  try
+  {
+    this->UpdateLargestPossibleRegion();
+  }
+  catch (...)
+  {
+    restoreImages();
+    throw;
+  }
+  restoreImages();
 }
 
 } // end namespace BlockMatching
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingDisplacementSequenceImageFilter_h
+#define itkBlockMatchingDisplacementSequenceImageFilter_h
+
+#include "UltrasoundExport.h"
+#include "itkBlockMatchingDisplacementPipeline.h"
+#include "itkStrainComponentImageFilter.h"
+#include "itkVectorImage.h"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class DisplacementSequenceImageFilter
+ *
+ * \brief Displacements, and optionally strains, of every pair of consecutive
+ * frames of a stack, in one update.
+ *
+ * The input is a stack of frames along its last direction, such as a cine
+ * loop read from a sequence file or an array of frames from Python.  Output 0
+ * stacks, along the same direction, the displacements of frame k + 1 relative
+ * to frame k computed by a DisplacementPipeline, so it has one frame less than
+ * the input.  When ComputeStrain is on, output 1 stacks the strains of the
+ * displacements computed by a StrainImageFilter.  Both are VectorImages, with
+ * the components of the displacement vectors and of the symmetric strain
+ * tensors, so that they are viewed from Python as (frames, ..., components)
+ * arrays.  When StrainComponentOnly is also on, output 1 has the single
+ * component of the strains chosen with GetStrainComponentFilter(), e.g. the
+ * axial strain for display, computed in one pass over the displacements
+ * without the gradient and tensor images of the StrainImageFilter.
+ *
+ * The frames are not copied: the fixed and the moving images of the pipeline
+ * import the frames of the input buffer, and since the moving frame of a pair
+ * is the fixed frame of the next one, its resampled image and pyramid are
+ * reused, see DisplacementPipeline::SetReuseMovingImagePyramid().  The pipeline
+ * is set up once for the geometry of the frames.  Configure it, e.g. its
+ * block radii and number of levels, with GetDisplacementPipeline().
+ *
+ * When UsePreviousDisplacements is on, the displacements of a pair center the
+ * search regions of the next pair, which suits the slowly changing motion of
+ * a cine loop with fewer levels or a smaller top search region factor.
+ *
+ * The spacing and origin of the last direction are the ones of the input, so
+ * that the displacements of a pair are at the time of its fixed frame.  The
+ * direction cosines between the frame directions and the last direction are
+ * ignored.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TPixel = signed short, typename TMetricPixel = float, unsigned int VFrameDimension = 2>
+class ITK_TEMPLATE_EXPORT DisplacementSequenceImageFilter
+  : public ImageToImageFilter<Image<TPixel, VFrameDimension + 1>, VectorImage<TMetricPixel, VFrameDimension + 1>>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(DisplacementSequenceImageFilter);
+
+  static constexpr unsigned int FrameDimension = VFrameDimension;
+  static constexpr unsigned int ImageDimension = VFrameDimension + 1;
+
+  using InputImageType = Image<TPixel, ImageDimension>;
+  using OutputImageType = VectorImage<TMetricPixel, ImageDimension>;
+
+  /** Standard class type alias. */
+  using Self = DisplacementSequenceImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DisplacementSequenceImageFilter, ImageToImageFilter);
+
+  using DisplacementPipelineType = DisplacementPipeline<TPixel, TPixel, TMetricPixel, double, VFrameDimension>;
+  using FrameImageType = typename DisplacementPipelineType::FixedImageType;
+  using DisplacementFrameType = typename DisplacementPipelineType::DisplacementImageType;
+  using StrainFilterType = typename DisplacementPipelineType::StrainFilterType;
+  using StrainFrameType = typename DisplacementPipelineType::TensorImageType;
+  using StrainImageType = VectorImage<TMetricPixel, ImageDimension>;
+  using StrainComponentFilterType =
+    StrainComponentImageFilter<DisplacementFrameType, Image<TMetricPixel, FrameDimension>>;
+
+  /** The pipeline that computes the displacements of every pair. */
+  itkGetModifiableObjectMacro(DisplacementPipeline, DisplacementPipelineType);
+
+  /** The filter that computes the strains of every pair, when ComputeStrain
+   * is on. */
+  itkGetModifiableObjectMacro(StrainFilter, StrainFilterType);
+
+  /** Set/Get whether output 1 holds the strains.  Defaults to false. */
+  itkSetMacro(ComputeStrain, bool);
+  itkGetConstMacro(ComputeStrain, bool);
+  itkBooleanMacro(ComputeStrain);
+
+  /** The filter that computes the strain component of every pair, when
+   * ComputeStrain and StrainComponentOnly are on.  Its component defaults to
+   * the axial strain, (0, 0). */
+  itkGetModifiableObjectMacro(StrainComponentFilter, StrainComponentFilterType);
+
+  /** Set/Get whether output 1 only holds one component of the strains.
+   * Defaults to false. */
+  itkSetMacro(StrainComponentOnly, bool);
+  itkGetConstMacro(StrainComponentOnly, bool);
+  itkBooleanMacro(StrainComponentOnly);
+
+  /** Set/Get whether the displacements of a pair are the initial
+   * displacements of the next one.  Defaults to false. */
+  itkSetMacro(UsePreviousDisplacements, bool);
+  itkGetConstMacro(UsePreviousDisplacements, bool);
+  itkBooleanMacro(UsePreviousDisplacements);
+
+  /** The stacked strains, computed when ComputeStrain is on. */
+  StrainImageType *
+  GetStrainOutput();
+  const StrainImageType *
+  GetStrainOutput() const;
+
+  using DataObjectPointerArraySizeType = ProcessObject::DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  DataObject::Pointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
+protected:
+  DisplacementSequenceImageFilter();
+  ~DisplacementSequenceImageFilter() override = default;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * data) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Copy the geometry of the frames of the input. */
+  void
+  CopyFrameInformation(FrameImageType * frame) const;
+
+  /** Point the frame at the frame of the input with the given index along
+   * the last direction. */
+  void
+  ImportFrame(SizeValueType frameIndex, FrameImageType * frame) const;
+
+  /** Point the displacement frame at the pair of the output with the given
+   * index. */
+  void
+  ImportDisplacements(SizeValueType pairIndex, DisplacementFrameType * displacements) const;
+
+  typename DisplacementPipelineType::Pointer  m_DisplacementPipeline;
+  typename StrainFilterType::Pointer          m_StrainFilter;
+  typename StrainComponentFilterType::Pointer m_StrainComponentFilter;
+  typename FrameImageType::Pointer            m_Frames[2];
+  typename DisplacementFrameType::Pointer     m_PreviousDisplacements;
+
+  bool m_ComputeStrain{ false };
+  bool m_StrainComponentOnly{ false };
+  bool m_UsePreviousDisplacements{ false };
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkBlockMatchingDisplacementSequenceImageFilter.hxx"
+#endif
+
+// The common instantiations are compiled into the Ultrasound library.
+#if !defined(ITK_TEMPLATE_EXPLICIT_DisplacementSequenceImageFilter)
+namespace itk
+{
+namespace BlockMatching
+{
+ITK_GCC_PRAGMA_DIAG_PUSH()
+ITK_GCC_PRAGMA_DIAG(ignored "-Wattributes")
+extern template class Ultrasound_EXPORT_EXPLICIT DisplacementSequenceImageFilter<signed short, float, 2>;
+ITK_GCC_PRAGMA_DIAG_POP()
+} // end namespace BlockMatching
+} // end namespace itk
+#endif
+
+#endif
@@ -0,0 +1,318 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingDisplacementSequenceImageFilter_hxx
+#define itkBlockMatchingDisplacementSequenceImageFilter_hxx
+
+#include "itkBlockMatchingDisplacementSequenceImageFilter.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::DisplacementSequenceImageFilter()
+{
+  m_DisplacementPipeline = DisplacementPipelineType::New();
+  m_DisplacementPipeline->ReuseMovingImagePyramidOn();
+  m_StrainFilter = StrainFilterType::New();
+  m_StrainComponentFilter = StrainComponentFilterType::New();
+  m_Frames[0] = FrameImageType::New();
+  m_Frames[1] = FrameImageType::New();
+  m_PreviousDisplacements = DisplacementFrameType::New();
+
+  this->SetNumberOfRequiredOutputs(2);
+  this->SetNthOutput(1, this->MakeOutput(1));
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+DataObject::Pointer
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::MakeOutput(DataObjectPointerArraySizeType idx)
+{
+  if (idx == 1)
+  {
+    return StrainImageType::New().GetPointer();
+  }
+  return Superclass::MakeOutput(idx);
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+auto
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::GetStrainOutput() -> StrainImageType *
+{
+  return static_cast<StrainImageType *>(this->ProcessObject::GetOutput(1));
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+auto
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::GetStrainOutput() const
+  -> const StrainImageType *
+{
+  return static_cast<const StrainImageType *>(this->ProcessObject::GetOutput(1));
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::CopyFrameInformation(
+  FrameImageType * frame) const
+{
+  const InputImageType *                      input = this->GetInput();
+  const typename InputImageType::RegionType & region = input->GetLargestPossibleRegion();
+
+  typename FrameImageType::RegionType    frameRegion;
+  typename FrameImageType::SpacingType   spacing;
+  typename FrameImageType::PointType     origin;
+  typename FrameImageType::DirectionType direction;
+  for (unsigned int i = 0; i < FrameDimension; ++i)
+  {
+    frameRegion.SetIndex(i, region.GetIndex(i));
+    frameRegion.SetSize(i, region.GetSize(i));
+    spacing[i] = input->GetSpacing()[i];
+    origin[i] = input->GetOrigin()[i];
+    for (unsigned int j = 0; j < FrameDimension; ++j)
+    {
+      direction[i][j] = input->GetDirection()[i][j];
+    }
+  }
+  frame->SetRegions(frameRegion);
+  frame->SetSpacing(spacing);
+  frame->SetOrigin(origin);
+  frame->SetDirection(direction);
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::ImportFrame(SizeValueType    frameIndex,
+                                                                                    FrameImageType * frame) const
+{
+  this->CopyFrameInformation(frame);
+
+  // The input buffer holds the largest possible region, frame after frame.
+  const SizeValueType frameSize = frame->GetLargestPossibleRegion().GetNumberOfPixels();
+  auto                container = FrameImageType::PixelContainer::New();
+  container->SetImportPointer(
+    const_cast<TPixel *>(this->GetInput()->GetBufferPointer()) + frameIndex * frameSize, frameSize, false);
+  frame->SetPixelContainer(container);
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::ImportDisplacements(
+  SizeValueType           pairIndex,
+  DisplacementFrameType * displacements) const
+{
+  displacements->CopyInformation(m_DisplacementPipeline->GetOutput());
+  displacements->SetRegions(m_DisplacementPipeline->GetOutput()->GetLargestPossibleRegion());
+
+  // The vectors are laid out like the components of the output.
+  const SizeValueType frameSize = displacements->GetLargestPossibleRegion().GetNumberOfPixels();
+  TMetricPixel *      buffer = const_cast<OutputImageType *>(this->GetOutput())->GetBufferPointer();
+  auto                container = DisplacementFrameType::PixelContainer::New();
+  container->SetImportPointer(reinterpret_cast<typename DisplacementFrameType::PixelType *>(buffer) +
+                                pairIndex * frameSize,
+                              frameSize,
+                              false);
+  displacements->SetPixelContainer(container);
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::GenerateOutputInformation()
+{
+  const InputImageType * input = this->GetInput();
+  if (input == nullptr)
+  {
+    itkExceptionMacro(<< "The input is not set.");
+  }
+  const typename InputImageType::RegionType & inputRegion = input->GetLargestPossibleRegion();
+  const SizeValueType                         numberOfFrames = inputRegion.GetSize(FrameDimension);
+  if (numberOfFrames < 2)
+  {
+    itkExceptionMacro(<< "The input has " << numberOfFrames << " frames, at least 2 are required.");
+  }
+
+  // The geometry of the displacements of a pair.
+  this->CopyFrameInformation(m_Frames[0]);
+  this->CopyFrameInformation(m_Frames[1]);
+  m_DisplacementPipeline->SetFixedImage(m_Frames[0]);
+  m_DisplacementPipeline->SetMovingImage(m_Frames[1]);
+  m_DisplacementPipeline->UpdateOutputInformation();
+  const DisplacementFrameType * displacements = m_DisplacementPipeline->GetOutput();
+
+  typename OutputImageType::RegionType    region;
+  typename OutputImageType::SpacingType   spacing;
+  typename OutputImageType::PointType     origin;
+  typename OutputImageType::DirectionType direction;
+  direction.SetIdentity();
+  for (unsigned int i = 0; i < FrameDimension; ++i)
+  {
+    region.SetIndex(i, displacements->GetLargestPossibleRegion().GetIndex(i));
+    region.SetSize(i, displacements->GetLargestPossibleRegion().GetSize(i));
+    spacing[i] = displacements->GetSpacing()[i];
+    origin[i] = displacements->GetOrigin()[i];
+    for (unsigned int j = 0; j < FrameDimension; ++j)
+    {
+      direction[i][j] = displacements->GetDirection()[i][j];
+    }
+  }
+  region.SetIndex(FrameDimension, inputRegion.GetIndex(FrameDimension));
+  region.SetSize(FrameDimension, numberOfFrames - 1);
+  spacing[FrameDimension] = input->GetSpacing()[FrameDimension];
+  origin[FrameDimension] = input->GetOrigin()[FrameDimension];
+  direction[FrameDimension][FrameDimension] = input->GetDirection()[FrameDimension][FrameDimension];
+
+  OutputImageType * output = this->GetOutput();
+  output->SetLargestPossibleRegion(region);
+  output->SetSpacing(spacing);
+  output->SetOrigin(origin);
+  output->SetDirection(direction);
+  output->SetNumberOfComponentsPerPixel(FrameDimension);
+
+  StrainImageType * strain = this->GetStrainOutput();
+  strain->SetLargestPossibleRegion(region);
+  strain->SetSpacing(spacing);
+  strain->SetOrigin(origin);
+  strain->SetDirection(direction);
+  strain->SetNumberOfComponentsPerPixel(m_StrainComponentOnly ? 1 : StrainFrameType::PixelType::Length);
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * input = const_cast<InputImageType *>(this->GetInput());
+  if (input != nullptr)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::EnlargeOutputRequestedRegion(DataObject * data)
+{
+  data->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  OutputImageType * output = this->GetOutput();
+  StrainImageType * strain = this->GetStrainOutput();
+  if (m_ComputeStrain)
+  {
+    strain->SetBufferedRegion(strain->GetLargestPossibleRegion());
+    strain->Allocate();
+  }
+  if (m_UsePreviousDisplacements)
+  {
+    m_DisplacementPipeline->SetInitialDisplacements(nullptr);
+  }
+
+  const SizeValueType numberOfPairs = output->GetLargestPossibleRegion().GetSize(FrameDimension);
+  for (SizeValueType pair = 0; pair < numberOfPairs; ++pair)
+  {
+    // The moving frame of the last pair is the fixed frame of this one.
+    FrameImageType * fixed = m_Frames[pair % 2];
+    FrameImageType * moving = m_Frames[(pair + 1) % 2];
+    if (pair == 0)
+    {
+      this->ImportFrame(0, fixed);
+    }
+    this->ImportFrame(pair + 1, moving);
+    m_DisplacementPipeline->SetFixedImage(fixed);
+    m_DisplacementPipeline->SetMovingImage(moving);
+    m_DisplacementPipeline->Update();
+
+    const DisplacementFrameType * displacements = m_DisplacementPipeline->GetOutput();
+    const SizeValueType           frameSize = displacements->GetBufferedRegion().GetNumberOfPixels();
+    if (frameSize * numberOfPairs != output->GetBufferedRegion().GetNumberOfPixels())
+    {
+      itkExceptionMacro(<< "The displacements of pair " << pair << " do not have the geometry of the output.");
+    }
+    const SizeValueType  displacementLength = frameSize * FrameDimension;
+    const TMetricPixel * displacementComponents =
+      reinterpret_cast<const TMetricPixel *>(displacements->GetBufferPointer());
+    std::copy(displacementComponents,
+              displacementComponents + displacementLength,
+              output->GetBufferPointer() + pair * displacementLength);
+    this->ImportDisplacements(pair, m_PreviousDisplacements);
+
+    if (m_ComputeStrain && m_StrainComponentOnly)
+    {
+      m_StrainComponentFilter->SetInput(m_PreviousDisplacements);
+      m_StrainComponentFilter->Update();
+      const TMetricPixel * strainComponents = m_StrainComponentFilter->GetOutput()->GetBufferPointer();
+      std::copy(strainComponents, strainComponents + frameSize, strain->GetBufferPointer() + pair * frameSize);
+    }
+    else if (m_ComputeStrain)
+    {
+      m_StrainFilter->SetInput(m_PreviousDisplacements);
+      m_StrainFilter->Update();
+      const SizeValueType  strainLength = frameSize * StrainFrameType::PixelType::Length;
+      const TMetricPixel * strainComponents =
+        reinterpret_cast<const TMetricPixel *>(m_StrainFilter->GetOutput()->GetBufferPointer());
+      std::copy(
+        strainComponents, strainComponents + strainLength, strain->GetBufferPointer() + pair * strainLength);
+    }
+    if (m_UsePreviousDisplacements)
+    {
+      m_DisplacementPipeline->SetInitialDisplacements(m_PreviousDisplacements);
+    }
+
+    this->UpdateProgress(static_cast<float>(pair + 1) / static_cast<float>(numberOfPairs));
+  }
+}
+
+
+template <typename TPixel, typename TMetricPixel, unsigned int VFrameDimension>
+void
+DisplacementSequenceImageFilter<TPixel, TMetricPixel, VFrameDimension>::PrintSelf(std::ostream & os,
+                                                                                  Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ComputeStrain: " << (m_ComputeStrain ? "On" : "Off") << std::endl;
+  os << indent << "StrainComponentOnly: " << (m_StrainComponentOnly ? "On" : "Off") << std::endl;
+  os << indent << "UsePreviousDisplacements: " << (m_UsePreviousDisplacements ? "On" : "Off") << std::endl;
+  os << indent << "DisplacementPipeline: " << m_DisplacementPipeline.GetPointer() << std::endl;
+  os << indent << "StrainFilter: " << m_StrainFilter.GetPointer() << std::endl;
+  os << indent << "StrainComponentFilter: " << m_StrainComponentFilter.GetPointer() << std::endl;
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
@@ -22,6 +22,9 @@
 
 #include "itkBlockMatchingMetricImageFilter.h"
 #include "itkBlockMatchingMetricImageToDisplacementCalculator.h"
+#include "itkBlockMatchingProgressCounter.h"
+
+#include <memory>
 
 namespace itk
 {
@@ -36,13 +39,21 @@ namespace BlockMatching
  * Displacements are calculated at every block from the FixedImage to the Moving
  * Image.
  *
- * Blocks are neighborhoods with a fixed radius, and they are located on a grid
- * in the fixed image.
+ * Blocks are neighborhoods with a fixed radius, or the radii of a RadiusImage,
+ * and they are located on a grid in the fixed image.
  *
  * An Image of search Regions in the moving image specifies each block's search
  * area.  The information from the search region image (origin, spacing, region,
  * etc) determines the information in the output displacement image.
  *
+ * With a Mask, only the blocks whose center is in the mask are matched.  The
+ * others are missing for the MetricImageToDisplacementCalculator, see its
+ * BlockMask, and their displacements are zero.
+ *
+ * When the MetricImageFilter implements ComputeMetricImage() and streaming is
+ * off, the metric images are computed without executing the pipeline for
+ * every block.
+ *
  * \sa ImageRegistrationMethod
  *
  * \ingroup RegistrationFilters
@@ -91,6 +102,12 @@ public:
   /** Type of the search region image. */
   using SearchRegionImageType = Image<typename MovingImageType::RegionType, ImageDimension>;
 
+  /** Type of the image of the radii of the blocks. */
+  using RadiusImageType = Image<RadiusType, ImageDimension>;
+
+  /** Type of the mask of the fixed image, and of the mask of the blocks. */
+  using MaskImageType = Image<unsigned char, ImageDimension>;
+
   /** Standard class type alias. */
   using Self = ImageRegistrationMethod;
   using Superclass = ImageToImageFilter<SearchRegionImageType, TDisplacementImage>;
@@ -147,6 +164,40 @@ public:
   itkGetConstMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
 
+  /** Whether or not to match the blocks in parallel.  The blocks of the
+   * displacement grid are handed out in chunks to the work units, each of
+   * which matches them with its own clone of the MetricImageFilter, see
+   * MetricImageFilter::Clone(), run on a single work unit.  This scales much
+   * better than the parallelism within a block for the small blocks of strain
+   * imaging.  The MetricImageToDisplacementCalculator receives the metric
+   * images one at a time, but not in grid order.  Blocks are matched serially
+   * when UseStreaming is on.  By default it is OFF. */
+  itkSetMacro(ParallelizeBlocks, bool);
+  itkGetConstMacro(ParallelizeBlocks, bool);
+  itkBooleanMacro(ParallelizeBlocks);
+
+  /** Set/Get the number of slabs the requested region of the displacement
+   * image is divided into along its last, e.g. elevational, direction when
+   * UseStreaming is off.  The fixed and moving images are updated for one slab
+   * at a time, on the regions that the blocks of the slab and their search
+   * regions cover, and the blocks of the slab are matched before the next
+   * slab is requested.  When the upstream filters support streaming, only the
+   * sub-volumes for a slab and its metric images are then in memory, which
+   * makes the registration of large volumes possible.  The metric images
+   * cached by the MetricImageToDisplacementCalculator are still kept for the
+   * whole grid; they are small when its PeakNeighborhoodOnly is on.  By
+   * default it is 1, and the fixed and moving images are updated whole. */
+  itkSetClampMacro(NumberOfSlabs, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfSlabs, unsigned int);
+
+  /** Set/Get the minimum time, in seconds, between the progress events
+   * invoked while the blocks are matched.  The work units count their blocks
+   * in batches, and check AbortGenerateData for every block, so that an abort
+   * takes effect within a block; a ProcessAborted exception is then thrown.
+   * By default it is 0.1 s. \sa ProgressCounter */
+  itkSetClampMacro(ProgressEventInterval, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(ProgressEventInterval, double);
+
   /** Set the radius for blocks in the fixed image to be matched against the
    * moving image.  This is a radius defined similarly to an itk::Neighborhood
    * radius, i.e., the size of the block in the i'th direction is 2*radius[i] +
@@ -168,6 +219,25 @@ public:
   }
   itkGetConstReferenceMacro(Radius, RadiusType);
 
+  /** Set/Get the radius of every block, on the grid of the displacement
+   * image, for blocks that vary in size across the image.  The radii are
+   * clamped by Radius, which the search regions must accommodate.  When it is
+   * not set, the default, every block has the Radius.
+   * \sa CorrelationBlockRadiusImageSource */
+  itkSetConstObjectMacro(RadiusImage, RadiusImageType);
+  itkGetConstObjectMacro(RadiusImage, RadiusImageType);
+
+  /** Set/Get the mask of the region of interest, in the physical space of the
+   * fixed image.  The blocks whose center is outside the mask, or where it is
+   * zero, are not matched.  When it is not set, the default, every block is
+   * matched. */
+  itkSetObjectMacro(Mask, MaskImageType);
+  itkGetConstObjectMacro(Mask, MaskImageType);
+
+  /** Get the mask of the blocks of the last update, on the grid of the
+   * displacement image, or nullptr without a Mask. */
+  itkGetConstObjectMacro(BlockMask, MaskImageType);
+
   /** Set/Get the search region image.  The SearchRegionImage has the same
    * LargestPossibleRegion as the output displacement image.  It contains
    * ImageRegions in the moving image that define the search region for each
@@ -207,14 +277,74 @@ protected:
   void
   GenerateData() override;
 
+  /** Match the blocks of the requested region one after the other.  The size
+   * of the blockRegion is the size of the fixed image blocks. */
+  virtual void
+  MatchBlocks(const RegionType & requestedRegion, const FixedRegionType & blockRegion);
+
+  /** Match the blocks of the requested region on the work units.  The size of
+   * the blockRegion is the size of the fixed image blocks. */
+  virtual void
+  ParallelMatchBlocks(const RegionType & requestedRegion, const FixedRegionType & blockRegion);
+
+  /** Update the fixed and moving images for every slab of the requested
+   * region, and match its blocks, see SetNumberOfSlabs(). */
+  virtual void
+  MatchSlabs(const RegionType & requestedRegion, const FixedRegionType & blockRegion);
+
+  /** Compute the regions of the fixed and moving images that the blocks of
+   * the slab and their search regions cover, cropped by the
+   * LargestPossibleRegions. */
+  void
+  ComputeSlabInputRegions(const RegionType &      slabRegion,
+                          const FixedRegionType & blockRegion,
+                          FixedRegionType &       fixedSlabRegion,
+                          MovingRegionType &      movingSlabRegion) const;
+
+  /** Copy the 3^N neighborhood of the maximum of the metric image, cropped by
+   * the metric image, into peakNeighborhood, when the
+   * MetricImageToDisplacementCalculator only needs it.  It keeps the indices
+   * and the physical points of the metric image.  Returns peakNeighborhood. */
+  MetricImageType *
+  ExtractPeakNeighborhood(const MetricImageType * metricImage, MetricImageType * peakNeighborhood) const;
+
+  /** Set the fixed image block of the block at the index of the displacement
+   * grid, centered on its physical point, with the radius of the RadiusImage
+   * or the Radius. */
+  void
+  ComputeFixedBlockRegion(const IndexType & index, const CoordRepType & coord, FixedRegionType & fixedRegion) const;
+
+  /** Compute the BlockMask from the Mask on the LargestPossibleRegion of the
+   * displacement image. */
+  void
+  ComputeBlockMask();
+
+  /** Whether the block at the index of the displacement grid is not matched. */
+  bool
+  IsBlockMasked(const IndexType & index) const
+  {
+    return m_BlockMask.IsNotNull() && !m_BlockMask->GetPixel(index);
+  }
+
   typename FixedImageType::Pointer  m_FixedImage;
   typename MovingImageType::Pointer m_MovingImage;
 
   typename MetricImageFilterType::Pointer                   m_MetricImageFilter;
   typename MetricImageToDisplacementCalculatorType::Pointer m_MetricImageToDisplacementCalculator;
 
-  bool       m_UseStreaming;
-  RadiusType m_Radius;
+  bool         m_UseStreaming;
+  bool         m_ParallelizeBlocks;
+  unsigned int m_NumberOfSlabs;
+  double       m_ProgressEventInterval;
+  RadiusType   m_Radius;
+
+  /** The blocks matched over the requested region, during GenerateData(). */
+  std::unique_ptr<ProgressCounter> m_ProgressCounter;
+
+  typename RadiusImageType::ConstPointer m_RadiusImage;
+
+  typename MaskImageType::Pointer m_Mask;
+  typename MaskImageType::Pointer m_BlockMask;
 
 private:
 };
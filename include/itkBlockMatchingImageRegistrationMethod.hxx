@@ -19,8 +19,16 @@
 #define itkBlockMatchingImageRegistrationMethod_hxx
 
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkProgressReporter.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+#include "itkMath.h"
+#include "itkUltrasoundTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 #include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
 #include "itkBlockMatchingImageRegistrationMethod.h"
@@ -39,10 +47,15 @@ template <typename TFixedImage,
 ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
   ImageRegistrationMethod()
   : m_UseStreaming(false)
+  , m_ParallelizeBlocks(false)
+  , m_NumberOfSlabs(1)
+  , m_ProgressEventInterval(0.1)
 {
   m_FixedImage = nullptr;
   m_MovingImage = nullptr;
   m_MetricImageFilter = nullptr;
+  m_Mask = nullptr;
+  m_BlockMask = nullptr;
   m_MetricImageToDisplacementCalculator = MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::New();
 
   m_Radius.Fill(0);
@@ -147,62 +160,433 @@ template <typename TFixedImage,
 void
 ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::GenerateData()
 {
-  const SearchRegionImageType * input = this->GetInput();
-
   this->Initialize();
 
-  ImageType * output = this->GetOutput();
-
-  RegionType requestedRegion = output->GetRequestedRegion();
-  using IteratorType = ImageRegionIteratorWithIndex<ImageType>;
-  IteratorType it(output, requestedRegion);
-  using SearchRegionImageIteratorType = ImageRegionConstIterator<SearchRegionImageType>;
-  SearchRegionImageIteratorType searchIt(input, requestedRegion);
+  const RegionType requestedRegion = this->GetOutput()->GetRequestedRegion();
 
   // The fixed image region is the kernel block size, and its size is constant.
-  FixedRegionType                     fixedRegion;
-  typename FixedRegionType::SizeType  fixedSize;
-  typename FixedRegionType::IndexType fixedIndex;
+  FixedRegionType                    fixedRegion;
+  typename FixedRegionType::SizeType fixedSize;
   for (unsigned int i = 0; i < ImageDimension; i++)
   {
     fixedSize[i] = m_Radius[i] * 2 + 1;
   }
   fixedRegion.SetSize(fixedSize);
-  FixedRegionType fixedLargestPossibleRegion = m_FixedImage->GetLargestPossibleRegion();
 
-  CoordRepType coord;
+  m_ProgressCounter.reset(new ProgressCounter(this, requestedRegion.GetNumberOfPixels(), m_ProgressEventInterval));
 
-  if (!m_UseStreaming)
+  if (m_UseStreaming)
+  {
+    this->MatchBlocks(requestedRegion, fixedRegion);
+  }
+  else if (m_NumberOfSlabs > 1)
+  {
+    this->MatchSlabs(requestedRegion, fixedRegion);
+  }
+  else
   {
     m_FixedImage->Update();
     m_MovingImage->Update();
     m_FixedImage->DisconnectPipeline();
     m_MovingImage->DisconnectPipeline();
+
+    if (m_ParallelizeBlocks)
+    {
+      this->ParallelMatchBlocks(requestedRegion, fixedRegion);
+    }
+    else
+    {
+      this->MatchBlocks(requestedRegion, fixedRegion);
+    }
   }
+  m_ProgressCounter->CheckAbort();
+  m_ProgressCounter.reset();
+
+  m_MetricImageToDisplacementCalculator->Compute();
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::MatchBlocks(
+  const RegionType &      requestedRegion,
+  const FixedRegionType & blockRegion)
+{
+  const SearchRegionImageType * input = this->GetInput();
+  ImageType *                   output = this->GetOutput();
+
+  using IteratorType = ImageRegionIteratorWithIndex<ImageType>;
+  IteratorType it(output, requestedRegion);
+  using SearchRegionImageIteratorType = ImageRegionConstIterator<SearchRegionImageType>;
+  SearchRegionImageIteratorType searchIt(input, requestedRegion);
+
+  FixedRegionType fixedRegion = blockRegion;
+  CoordRepType    coord;
 
   // Note that this may not be accurate if
   // m_MetricImageToDisplacementCalculator->Compute() takes a long time.  In
   // that case one may want to monitor the progress of
   // m_MetricImageToDisplacementCalculator separately.
-  ProgressReporter progress(this, 0, requestedRegion.GetNumberOfPixels());
+  ProgressCounter::Batch progress(*m_ProgressCounter);
+
+  // Where the metric image filter computes the metric directly on the buffers,
+  // see MetricImageFilter::ComputeMetricImage(), it goes in this image.
+  typename MetricImageType::Pointer blockMetricImage = MetricImageType::New();
+  // Where the calculator only needs the neighborhood of the peak, it goes in
+  // this image.
+  typename MetricImageType::Pointer peakNeighborhood = MetricImageType::New();
+
+  const bool peakNeighborhoodOnly = m_MetricImageToDisplacementCalculator->GetPeakNeighborhoodOnly();
 
   for (it.GoToBegin(), searchIt.GoToBegin(); !it.IsAtEnd(); ++it, ++searchIt)
   {
+    if (this->IsBlockMasked(it.GetIndex()))
+    {
+      if (!progress.CompletedBlock())
+      {
+        return;
+      }
+      continue;
+    }
+    itkUltrasoundTraceScopeMacro("BlockMatchingMetric");
     output->TransformIndexToPhysicalPoint(it.GetIndex(), coord);
+    this->ComputeFixedBlockRegion(it.GetIndex(), coord, fixedRegion);
+    MetricImageType * metricImage = blockMetricImage;
+    if (m_UseStreaming || !m_MetricImageFilter->ComputeMetricImage(fixedRegion, searchIt.Get(), metricImage))
+    {
+      m_MetricImageFilter->SetFixedImageRegion(fixedRegion);
+      m_MetricImageFilter->SetMovingImageRegion(searchIt.Get());
+      m_MetricImageFilter->Update();
+      metricImage = m_MetricImageFilter->GetOutput();
+    }
+    if (peakNeighborhoodOnly)
+    {
+      metricImage = this->ExtractPeakNeighborhood(metricImage, peakNeighborhood);
+    }
+    m_MetricImageToDisplacementCalculator->SetMetricImagePixel(coord, it.GetIndex(), metricImage);
+    if (!progress.CompletedBlock())
+    {
+      return;
+    }
+  }
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::ParallelMatchBlocks(
+  const RegionType &      requestedRegion,
+  const FixedRegionType & blockRegion)
+{
+  const SearchRegionImageType * input = this->GetInput();
+  const ImageType *             output = this->GetOutput();
+
+  const SizeValueType numberOfBlocks = requestedRegion.GetNumberOfPixels();
+  if (numberOfBlocks == 0)
+  {
+    return;
+  }
+  const ThreadIdType numberOfWorkUnits = static_cast<ThreadIdType>(
+    std::min<SizeValueType>(std::max<ThreadIdType>(this->GetNumberOfWorkUnits(), 1), numberOfBlocks));
+
+  // Every work unit has its own metric image filter, on its own fixed and
+  // moving images that share the buffers of the inputs, so that the requested
+  // regions the metric image filters set do not interfere.
+  std::vector<typename MetricImageFilterType::Pointer> metricImageFilters(numberOfWorkUnits);
+  for (ThreadIdType workUnit = 0; workUnit < numberOfWorkUnits; ++workUnit)
+  {
+    typename FixedImageType::Pointer fixedImage = FixedImageType::New();
+    fixedImage->Graft(m_FixedImage);
+    typename MovingImageType::Pointer movingImage = MovingImageType::New();
+    movingImage->Graft(m_MovingImage);
+
+    typename MetricImageFilterType::Pointer metricImageFilter = m_MetricImageFilter->Clone();
+    metricImageFilter->SetNumberOfWorkUnits(1);
+    metricImageFilter->SetFixedImage(fixedImage);
+    metricImageFilter->SetMovingImage(movingImage);
+    metricImageFilters[workUnit] = metricImageFilter;
+  }
+
+  // The blocks are taken in chunks from a shared counter, so the work units
+  // that get the faster blocks match more of them.
+  const SizeValueType        chunkSize = std::max<SizeValueType>(numberOfBlocks / (8 * numberOfWorkUnits), 1);
+  std::atomic<SizeValueType> nextBlock(0);
+  std::mutex                 calculatorMutex;
+  const bool                 peakNeighborhoodOnly = m_MetricImageToDisplacementCalculator->GetPeakNeighborhoodOnly();
+
+  const IndexType & requestedIndex = requestedRegion.GetIndex();
+  const SizeType &  requestedSize = requestedRegion.GetSize();
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(numberOfWorkUnits);
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkUnits,
+    [&](SizeValueType workUnit) {
+      MetricImageFilterType *           metricImageFilter = metricImageFilters[workUnit];
+      ProgressCounter::Batch            progress(*m_ProgressCounter);
+      typename MetricImageType::Pointer blockMetricImage = MetricImageType::New();
+      typename MetricImageType::Pointer peakNeighborhood = MetricImageType::New();
+
+      FixedRegionType fixedRegion = blockRegion;
+      IndexType       index;
+      CoordRepType    coord;
+      for (SizeValueType chunkStart = nextBlock.fetch_add(chunkSize); chunkStart < numberOfBlocks;
+           chunkStart = nextBlock.fetch_add(chunkSize))
+      {
+        const SizeValueType chunkEnd = std::min(chunkStart + chunkSize, numberOfBlocks);
+        for (SizeValueType block = chunkStart; block < chunkEnd; ++block)
+        {
+          SizeValueType remainder = block;
+          for (unsigned int i = 0; i < ImageDimension; ++i)
+          {
+            index[i] = requestedIndex[i] + static_cast<IndexValueType>(remainder % requestedSize[i]);
+            remainder /= requestedSize[i];
+          }
+          if (this->IsBlockMasked(index))
+          {
+            if (!progress.CompletedBlock())
+            {
+              return;
+            }
+            continue;
+          }
+          itkUltrasoundTraceScopeMacro("BlockMatchingMetric");
+
+          output->TransformIndexToPhysicalPoint(index, coord);
+          this->ComputeFixedBlockRegion(index, coord, fixedRegion);
+          const MovingRegionType & searchRegion = input->GetPixel(index);
+          MetricImageType *        metricImage = blockMetricImage;
+          if (!metricImageFilter->ComputeMetricImage(fixedRegion, searchRegion, metricImage))
+          {
+            metricImageFilter->SetFixedImageRegion(fixedRegion);
+            metricImageFilter->SetMovingImageRegion(searchRegion);
+            metricImageFilter->Update();
+            metricImage = metricImageFilter->GetOutput();
+          }
+          if (peakNeighborhoodOnly)
+          {
+            metricImage = this->ExtractPeakNeighborhood(metricImage, peakNeighborhood);
+          }
+
+          {
+            std::lock_guard<std::mutex> lock(calculatorMutex);
+            m_MetricImageToDisplacementCalculator->SetMetricImagePixel(coord, index, metricImage);
+          }
+          if (!progress.CompletedBlock())
+          {
+            return;
+          }
+        }
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::MatchSlabs(
+  const RegionType &      requestedRegion,
+  const FixedRegionType & blockRegion)
+{
+  // The slabs are split along the slowest direction first, like the streamed
+  // regions of a StreamingImageFilter.
+  using SplitterType = ImageRegionSplitterSlowDimension;
+  SplitterType::Pointer splitter = SplitterType::New();
+  const unsigned int    numberOfSlabs = splitter->GetNumberOfSplits(requestedRegion, m_NumberOfSlabs);
+
+  FixedRegionType  fixedSlabRegion;
+  MovingRegionType movingSlabRegion;
+  for (unsigned int slab = 0; slab < numberOfSlabs; ++slab)
+  {
+    RegionType slabRegion = requestedRegion;
+    splitter->GetSplit(slab, numberOfSlabs, slabRegion);
+    if (m_ProgressCounter->IsAborted())
+    {
+      return;
+    }
+    this->ComputeSlabInputRegions(slabRegion, blockRegion, fixedSlabRegion, movingSlabRegion);
+
+    // The images stay connected to their sources, which only generate the
+    // regions of the slab when they support streaming.
+    m_FixedImage->SetRequestedRegion(fixedSlabRegion);
+    m_FixedImage->PropagateRequestedRegion();
+    m_FixedImage->UpdateOutputData();
+    m_MovingImage->SetRequestedRegion(movingSlabRegion);
+    m_MovingImage->PropagateRequestedRegion();
+    m_MovingImage->UpdateOutputData();
+
+    if (m_ParallelizeBlocks)
+    {
+      this->ParallelMatchBlocks(slabRegion, blockRegion);
+    }
+    else
+    {
+      this->MatchBlocks(slabRegion, blockRegion);
+    }
+  }
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  ComputeSlabInputRegions(const RegionType &      slabRegion,
+                          const FixedRegionType & blockRegion,
+                          FixedRegionType &       fixedSlabRegion,
+                          MovingRegionType &      movingSlabRegion) const
+{
+  const SearchRegionImageType * input = this->GetInput();
+  const ImageType *             output = this->GetOutput();
+
+  // The bounds of the blocks and of the search regions dilated by the block
+  // radius in the moving image, as in MetricImageFilter, which the metric
+  // images are computed on.
+  IndexType movingRadius;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    movingRadius[i] = Math::Ceil<IndexValueType>(m_FixedImage->GetSpacing()[i] * m_Radius[i] /
+                                                 m_MovingImage->GetSpacing()[i]);
+  }
+
+  using FixedIndexType = typename FixedRegionType::IndexType;
+  using MovingIndexType = typename MovingRegionType::IndexType;
+  FixedIndexType  fixedLower;
+  FixedIndexType  fixedUpper;
+  MovingIndexType movingLower;
+  MovingIndexType movingUpper;
+  fixedLower.Fill(NumericTraits<IndexValueType>::max());
+  fixedUpper.Fill(NumericTraits<IndexValueType>::NonpositiveMin());
+  movingLower.Fill(NumericTraits<IndexValueType>::max());
+  movingUpper.Fill(NumericTraits<IndexValueType>::NonpositiveMin());
+
+  FixedIndexType fixedIndex;
+  CoordRepType   coord;
+  ImageRegionConstIteratorWithIndex<SearchRegionImageType> searchIt(input, slabRegion);
+  for (searchIt.GoToBegin(); !searchIt.IsAtEnd(); ++searchIt)
+  {
+    output->TransformIndexToPhysicalPoint(searchIt.GetIndex(), coord);
     m_FixedImage->TransformPhysicalPointToIndex(coord, fixedIndex);
+    const MovingRegionType & searchRegion = searchIt.Get();
     for (unsigned int i = 0; i < ImageDimension; ++i)
     {
-      fixedIndex[i] -= m_Radius[i];
+      const IndexValueType radius = static_cast<IndexValueType>(m_Radius[i]);
+      fixedLower[i] = std::min(fixedLower[i], fixedIndex[i] - radius);
+      fixedUpper[i] = std::max(fixedUpper[i], fixedIndex[i] + radius);
+      movingLower[i] = std::min(movingLower[i], searchRegion.GetIndex(i) - movingRadius[i]);
+      movingUpper[i] = std::max(movingUpper[i],
+                                searchRegion.GetIndex(i) + static_cast<IndexValueType>(searchRegion.GetSize(i)) - 1 +
+                                  movingRadius[i]);
     }
-    fixedRegion.SetIndex(fixedIndex);
-    m_MetricImageFilter->SetFixedImageRegion(fixedRegion);
-    m_MetricImageFilter->SetMovingImageRegion(searchIt.Get());
-    m_MetricImageFilter->Update();
-    m_MetricImageToDisplacementCalculator->SetMetricImagePixel(coord, it.GetIndex(), m_MetricImageFilter->GetOutput());
-    progress.CompletedPixel();
   }
 
-  m_MetricImageToDisplacementCalculator->Compute();
+  fixedSlabRegion = blockRegion;
+  movingSlabRegion = m_MovingImage->GetLargestPossibleRegion();
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    fixedSlabRegion.SetIndex(i, fixedLower[i]);
+    fixedSlabRegion.SetSize(i, static_cast<SizeValueType>(fixedUpper[i] - fixedLower[i] + 1));
+    movingSlabRegion.SetIndex(i, movingLower[i]);
+    movingSlabRegion.SetSize(i, static_cast<SizeValueType>(movingUpper[i] - movingLower[i] + 1));
+  }
+  fixedSlabRegion.Crop(m_FixedImage->GetLargestPossibleRegion());
+  movingSlabRegion.Crop(m_MovingImage->GetLargestPossibleRegion());
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+auto
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  ExtractPeakNeighborhood(const MetricImageType * metricImage, MetricImageType * peakNeighborhood) const
+  -> MetricImageType *
+{
+  using MetricRegionType = typename MetricImageType::RegionType;
+  using MetricPixelType = typename MetricImageType::PixelType;
+
+  // The first maximum in the buffer, like the displacement calculators.
+  const MetricRegionType & region = metricImage->GetBufferedRegion();
+  const MetricPixelType *  buffer = metricImage->GetBufferPointer();
+  const SizeValueType      numberOfPixels = region.GetNumberOfPixels();
+  SizeValueType            maxOffset = 0;
+  for (SizeValueType ii = 1; ii < numberOfPixels; ++ii)
+  {
+    if (buffer[ii] > buffer[maxOffset])
+    {
+      maxOffset = ii;
+    }
+  }
+
+  MetricRegionType neighborhood;
+  neighborhood.SetIndex(metricImage->ComputeIndex(static_cast<OffsetValueType>(maxOffset)));
+  neighborhood.PadByRadius(1);
+  neighborhood.Crop(region);
+
+  // The buffer is only reallocated when the size of the neighborhood changes.
+  const bool reallocate = peakNeighborhood->GetBufferedRegion().GetSize() != neighborhood.GetSize();
+  peakNeighborhood->CopyInformation(metricImage);
+  peakNeighborhood->SetRegions(neighborhood);
+  if (reallocate)
+  {
+    peakNeighborhood->Allocate();
+  }
+
+  ImageRegionConstIterator<MetricImageType> neighborhoodIt(metricImage, neighborhood);
+  MetricPixelType *                         peakBuffer = peakNeighborhood->GetBufferPointer();
+  for (neighborhoodIt.GoToBegin(); !neighborhoodIt.IsAtEnd(); ++neighborhoodIt, ++peakBuffer)
+  {
+    *peakBuffer = neighborhoodIt.Get();
+  }
+  return peakNeighborhood;
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  ComputeFixedBlockRegion(const IndexType & index, const CoordRepType & coord, FixedRegionType & fixedRegion) const
+{
+  typename FixedRegionType::IndexType fixedIndex;
+  m_FixedImage->TransformPhysicalPointToIndex(coord, fixedIndex);
+  RadiusType radius = m_Radius;
+  if (m_RadiusImage)
+  {
+    const RadiusType & blockRadius = m_RadiusImage->GetPixel(index);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      radius[i] = std::min(blockRadius[i], m_Radius[i]);
+    }
+  }
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    fixedIndex[i] -= radius[i];
+    fixedRegion.SetSize(i, 2 * radius[i] + 1);
+  }
+  fixedRegion.SetIndex(fixedIndex);
 }
 
 
@@ -251,6 +635,55 @@ ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementIm
   {
     itkExceptionMacro(<< "Input SearchRegionImage is not present.");
   }
+
+  if (m_RadiusImage && !m_RadiusImage->GetBufferedRegion().IsInside(output->GetRequestedRegion()))
+  {
+    itkExceptionMacro(<< "The RadiusImage does not cover the requested displacements.");
+  }
+
+  // The masked blocks are not matched, so their displacements stay zero.
+  if (m_Mask)
+  {
+    this->ComputeBlockMask();
+    output->FillBuffer(NumericTraits<typename ImageType::PixelType>::ZeroValue());
+  }
+  else
+  {
+    m_BlockMask = nullptr;
+  }
+  m_MetricImageToDisplacementCalculator->SetBlockMask(m_BlockMask);
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::ComputeBlockMask()
+{
+  m_Mask->Update();
+
+  const ImageType * output = this->GetOutput();
+  if (m_BlockMask.IsNull())
+  {
+    m_BlockMask = MaskImageType::New();
+  }
+  m_BlockMask->CopyInformation(output);
+  m_BlockMask->SetRegions(output->GetLargestPossibleRegion());
+  m_BlockMask->Allocate();
+
+  CoordRepType                                coord;
+  typename MaskImageType::IndexType           maskIndex;
+  const typename MaskImageType::RegionType &  maskRegion = m_Mask->GetBufferedRegion();
+  ImageRegionIteratorWithIndex<MaskImageType> blockMaskIt(m_BlockMask, m_BlockMask->GetBufferedRegion());
+  for (blockMaskIt.GoToBegin(); !blockMaskIt.IsAtEnd(); ++blockMaskIt)
+  {
+    output->TransformIndexToPhysicalPoint(blockMaskIt.GetIndex(), coord);
+    const bool inside = m_Mask->TransformPhysicalPointToIndex(coord, maskIndex) && maskRegion.IsInside(maskIndex);
+    blockMaskIt.Set(inside && m_Mask->GetPixel(maskIndex) ? 1 : 0);
+  }
 }
 
 } // end namespace BlockMatching
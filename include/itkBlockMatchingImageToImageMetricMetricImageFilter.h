@@ -76,6 +76,9 @@ protected:
   ImageToImageMetricMetricImageFilter();
   virtual ~ImageToImageMetricMetricImageFilter() {}
 
+  LightObject::Pointer
+  InternalClone() const override;
+
   virtual void
   GenerateOutputInformation() override;
 
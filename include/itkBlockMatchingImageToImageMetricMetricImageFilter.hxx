@@ -31,6 +31,22 @@ ImageToImageMetricMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::Im
 {}
 
 
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+LightObject::Pointer
+ImageToImageMetricMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+  typename Self::Pointer rval = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (rval.IsNull())
+  {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+  }
+  rval->m_MetricImageSpacing = m_MetricImageSpacing;
+  rval->m_MetricImageSpacingDefined = m_MetricImageSpacingDefined;
+  return loPtr;
+}
+
+
 template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
 void
 ImageToImageMetricMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::SetMetricImageSpacing(
@@ -32,6 +32,10 @@ namespace BlockMatching
  *
  * This is the simplest and fastest of the MetricImageToDisplacementCalculator's.
  *
+ * The metric images are cached by default, and the maxima are found for all
+ * the blocks at once in the multithreaded Compute().  Without the cache, the
+ * maximum of every block is found in SetMetricImagePixel().
+ *
  * \ingroup Ultrasound
  */
 template <typename TMetricImage, typename TDisplacementImage>
@@ -45,6 +49,9 @@ public:
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int, Superclass::ImageDimension);
+
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
@@ -55,6 +62,12 @@ public:
   using MetricImagePointerType = typename Superclass::MetricImagePointerType;
   using PixelType = typename MetricImageType::PixelType;
 
+  using MetricImageImageType = typename Superclass::MetricImageImageType;
+  using CenterPointsImageType = typename Superclass::CenterPointsImageType;
+  using DisplacementImageType = typename Superclass::DisplacementImageType;
+  using DisplacementType = typename DisplacementImageType::PixelType;
+  using RegionType = typename Superclass::RegionType;
+
   using PointType = typename Superclass::PointType;
 
   using IndexType = typename Superclass::IndexType;
@@ -63,15 +76,24 @@ public:
   SetMetricImagePixel(const PointType & point, const IndexType & index, MetricImageType * image) override;
 
   void
-  Compute() override
-  {
-    // We do this here instead of SetMetricImagePixel so it only has to be done
-    // once.
-    this->m_DisplacementImage->Modified();
-  };
+  Compute() override;
+
+  /** Only pass the 3^N neighborhood of the maximum of the metric images, see
+   * MetricImageToDisplacementCalculator::GetPeakNeighborhoodOnly(). */
+  itkSetMacro(PeakNeighborhoodOnly, bool);
+  itkBooleanMacro(PeakNeighborhoodOnly);
 
 protected:
-  MaximumPixelDisplacementCalculator() {}
+  MaximumPixelDisplacementCalculator();
+
+  /** The displacement of the block centered at the point to the maximum of its
+   * metric image. */
+  DisplacementType
+  ComputeDisplacement(const PointType & point, const MetricImageType * metricImage) const;
+
+  /** Compute the displacements of the cached metric images in the region. */
+  void
+  ThreadedComputeDisplacements(const RegionType & region);
 
 private:
   MaximumPixelDisplacementCalculator(const Self &);
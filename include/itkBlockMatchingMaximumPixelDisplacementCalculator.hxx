@@ -20,13 +20,22 @@
 
 #include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
 
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 
 namespace itk
 {
 namespace BlockMatching
 {
 
+template <typename TMetricImage, typename TDisplacementImage>
+MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::MaximumPixelDisplacementCalculator()
+{
+  this->m_CacheMetricImage = true;
+}
+
+
 template <typename TMetricImage, typename TDisplacementImage>
 void
 MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::SetMetricImagePixel(const PointType & point,
@@ -35,6 +44,36 @@ MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::SetMetricI
 {
   Superclass::SetMetricImagePixel(point, index, metricImage);
 
+  if (!this->m_CacheMetricImage)
+  {
+    this->m_DisplacementImage->SetPixel(index, this->ComputeDisplacement(point, metricImage));
+  }
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage>
+void
+MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::Compute()
+{
+  if (this->m_CacheMetricImage)
+  {
+    this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
+      this->m_DisplacementImage->GetRequestedRegion(),
+      [this](const RegionType & outputRegion) { this->ThreadedComputeDisplacements(outputRegion); },
+      nullptr);
+  }
+  // We do this here instead of SetMetricImagePixel so it only has to be done
+  // once.
+  this->m_DisplacementImage->Modified();
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage>
+auto
+MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::ComputeDisplacement(
+  const PointType &       point,
+  const MetricImageType * metricImage) const -> DisplacementType
+{
   PixelType max = NumericTraits<PixelType>::min();
   IndexType maxIndex;
   maxIndex.Fill(0);
@@ -51,7 +90,29 @@ MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::SetMetricI
 
   PointType maxPoint;
   metricImage->TransformIndexToPhysicalPoint(maxIndex, maxPoint);
-  this->m_DisplacementImage->SetPixel(index, maxPoint - point);
+  return maxPoint - point;
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage>
+void
+MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::ThreadedComputeDisplacements(
+  const RegionType & region)
+{
+  ImageRegionConstIterator<MetricImageImageType>  imageImageIt(this->m_MetricImageImage, region);
+  ImageRegionConstIterator<CenterPointsImageType> centerPointsIt(this->m_CenterPointsImage, region);
+  ImageRegionIterator<DisplacementImageType>      displacementIt(this->m_DisplacementImage, region);
+  for (imageImageIt.GoToBegin(), centerPointsIt.GoToBegin(), displacementIt.GoToBegin(); !imageImageIt.IsAtEnd();
+       ++imageImageIt, ++centerPointsIt, ++displacementIt)
+  {
+    if (imageImageIt.Get() == nullptr)
+    {
+      // A missing block.
+      displacementIt.Set(NumericTraits<typename DisplacementImageType::PixelType>::ZeroValue());
+      continue;
+    }
+    displacementIt.Set(this->ComputeDisplacement(centerPointsIt.Get(), imageImageIt.Get()));
+  }
 }
 
 } // end namespace BlockMatching
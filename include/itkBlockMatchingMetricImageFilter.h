@@ -66,6 +66,13 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(MetricImageFilter, ImageToImageFilter);
 
+  /** Create a filter of the same type with the same parameters, but without
+   * the inputs and the regions.  This is how
+   * BlockMatching::ImageRegistrationMethod gets a filter for every work unit
+   * when it matches blocks in parallel.  Subclasses with parameters override
+   * InternalClone() to copy them. */
+  itkCloneMacro(Self);
+
   /** ImageDimension enumeration. */
   itkStaticConstMacro(ImageDimension, unsigned int, TFixedImage::ImageDimension);
 
@@ -108,6 +115,19 @@ public:
   SetMovingImageRegion(const MovingImageRegionType & region);
   itkGetConstReferenceMacro(MovingImageRegion, MovingImageRegionType);
 
+  /** Compute the metric image of the block fixedRegion over the search region
+   * movingRegion into metricImage, directly on the buffers of the inputs and
+   * without executing the pipeline.  The metric image gets the information the
+   * output would have, and its buffer is reused when it is large enough.  The
+   * inputs must be buffered over the block and the search region dilated by
+   * the block radius.  This returns false when a subclass cannot compute the
+   * metric this way, or not for these regions, and then the filter has to be
+   * updated for the block instead.  By default it returns false. */
+  virtual bool
+  ComputeMetricImage(const FixedImageRegionType &  fixedRegion,
+                     const MovingImageRegionType & movingRegion,
+                     MetricImageType *             metricImage);
+
 protected:
   MetricImageFilter();
   virtual ~MetricImageFilter(){};
@@ -125,6 +145,17 @@ protected:
   void
   EnlargeOutputRequestedRegion(DataObject * data) override;
 
+  /** For the implementations of ComputeMetricImage(): give metricImage the
+   * information the output would have for the search region movingRegion,
+   * and allocate it.  validRegion is the part of the search region where the
+   * window of the block radius is inside the buffer of the moving image.
+   * This returns false when there is no such position. */
+  bool
+  AllocateMetricImage(const MovingImageRegionType & movingRegion,
+                      const RadiusType &            radius,
+                      MetricImageType *             metricImage,
+                      MovingImageRegionType &       validRegion) const;
+
   FixedImageRegionType  m_FixedImageRegion;
   MovingImageRegionType m_MovingImageRegion;
 
@@ -20,6 +20,8 @@
 
 #include "itkBlockMatchingMetricImageFilter.h"
 
+#include <algorithm>
+
 namespace itk
 {
 namespace BlockMatching
@@ -107,6 +109,64 @@ MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::SetMovingImageRegion
 }
 
 
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+bool
+MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::ComputeMetricImage(const FixedImageRegionType &,
+                                                                               const MovingImageRegionType &,
+                                                                               MetricImageType *)
+{
+  return false;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+bool
+MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::AllocateMetricImage(
+  const MovingImageRegionType & movingRegion,
+  const RadiusType &            radius,
+  MetricImageType *             metricImage,
+  MovingImageRegionType &       validRegion) const
+{
+  const MovingImageType * movingPtr = this->GetInput(1);
+
+  // The same information as GenerateOutputInformation().
+  MetricImageRegionType                     metricRegion;
+  typename MetricImageRegionType::IndexType metricIndex;
+  metricIndex.Fill(0);
+  metricRegion.SetIndex(metricIndex);
+  metricRegion.SetSize(movingRegion.GetSize());
+  metricImage->SetRegions(metricRegion);
+  metricImage->SetSpacing(movingPtr->GetSpacing());
+  typename MetricImageType::PointType origin;
+  movingPtr->TransformIndexToPhysicalPoint(movingRegion.GetIndex(), origin);
+  metricImage->SetOrigin(origin);
+  metricImage->SetDirection(movingPtr->GetDirection());
+  metricImage->Allocate();
+
+  // The positions whose window is inside the moving buffer.
+  const MovingImageRegionType &       bufferedRegion = movingPtr->GetBufferedRegion();
+  typename MovingImageType::IndexType validIndex;
+  typename MovingImageType::SizeType  validSize;
+  bool                                isValid = true;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    const OffsetValueType radiusValue = static_cast<OffsetValueType>(radius[i]);
+    const OffsetValueType movingBegin = movingRegion.GetIndex()[i];
+    const OffsetValueType movingEnd = movingBegin + static_cast<OffsetValueType>(movingRegion.GetSize()[i]);
+    const OffsetValueType bufferedBegin = bufferedRegion.GetIndex()[i];
+    const OffsetValueType bufferedEnd = bufferedBegin + static_cast<OffsetValueType>(bufferedRegion.GetSize()[i]);
+    const OffsetValueType lower = std::max(movingBegin, bufferedBegin + radiusValue);
+    const OffsetValueType upper = std::min(movingEnd, bufferedEnd - radiusValue);
+    isValid = isValid && upper > lower;
+    validIndex[i] = lower;
+    validSize[i] = upper > lower ? static_cast<SizeValueType>(upper - lower) : 0;
+  }
+  validRegion.SetIndex(validIndex);
+  validRegion.SetSize(validSize);
+  return isValid;
+}
+
+
 template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
 void
 MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::GenerateOutputInformation()
@@ -19,7 +19,6 @@
 #define itkBlockMatchingMetricImageToDisplacementCalculator_h
 
 #include "itkImage.h"
-#include "itkImageDuplicator.h"
 #include "itkMultiThreaderBase.h"
 #include "itkProcessObject.h"
 
@@ -46,6 +45,14 @@ namespace BlockMatching
  * set to do nothing.
  *
  * Caching of the MetricImage can be enabled by SetCacheMetricImageOn();
+ * The cached metric images of the same size share one contiguous buffer,
+ * in the order of the displacement image pixels, and the images and the
+ * buffer are reused from one frame to the next.  They are valid until the
+ * LargestPossibleRegion of the displacement image changes.
+ *
+ * With a BlockMask, the blocks where the mask is zero are missing: no metric
+ * image is set for them, their pixels of the MetricImageImage are null, and
+ * the calculators leave their displacements at zero.
  *
  * The behavior of the associated BlockMatching::ImageRegistrationMethod
  * GenerateInputRequestedRegion() and EnlargeOutputRequestedRegion() with
@@ -73,6 +80,8 @@ public:
   using MetricImageType = TMetricImage;
   using MetricImagePointerType = typename MetricImageType::Pointer;
   using IndexType = typename MetricImageType::IndexType;
+  using MetricImageRegionType = typename MetricImageType::RegionType;
+  using MetricImagePixelContainerType = typename MetricImageType::PixelContainer;
 
   /** Type of the displacement image (output). */
   using DisplacementImageType = TDisplacementImage;
@@ -91,12 +100,23 @@ public:
   using MetricImageImageType = itk::Image<MetricImagePointerType, ImageDimension>;
   using MetricImageImagePointerType = typename MetricImageImageType::Pointer;
 
+  /** Type of the mask of the blocks. */
+  using BlockMaskImageType = itk::Image<unsigned char, ImageDimension>;
+
   /** Ensure all the metric images are stored in the class's MetricImageImage.
    * */
   itkSetMacro(CacheMetricImage, bool);
   itkGetConstMacro(CacheMetricImage, bool);
   itkBooleanMacro(CacheMetricImage);
 
+  /** Whether the displacement only depends on the maximum of every metric
+   * image and the 3^N neighborhood around it.  Then the
+   * BlockMatching::ImageRegistrationMethod passes only that neighborhood,
+   * cropped by the metric image, to SetMetricImagePixel(), and the full metric
+   * images are never stored.  The calculators that support it can turn it on;
+   * by default it is off. */
+  itkGetConstMacro(PeakNeighborhoodOnly, bool);
+
   /** Set a metric image pixel.  This is the way to supply input to this class.
    * The point is the center point of the corresponding fixed block.
    * The index is the index of the corresponding displacement image pixel.  The
@@ -117,6 +137,21 @@ public:
     return this->m_DisplacementImage.GetPointer();
   }
 
+  /** Set/Get the mask of the blocks, on the grid of the displacement image.
+   * The blocks where it is zero are missing, and their cached metric images
+   * are released.  Set it after the displacement image.  When it is not set,
+   * the default, no block is missing. */
+  virtual void
+  SetBlockMask(const BlockMaskImageType * mask);
+  itkGetConstObjectMacro(BlockMask, BlockMaskImageType);
+
+  /** Whether the block at the index of the displacement image is missing. */
+  bool
+  IsBlockMissing(const IndexType & index) const
+  {
+    return this->m_BlockMask.IsNotNull() && !this->m_BlockMask->GetPixel(index);
+  }
+
   /** Get the MetricImage image (The image of metric images.)  This should only
    * be called after all the the metric image pixels have been set with
    * SetMetricImagePixel(). */
@@ -129,6 +164,10 @@ public:
   itkSetObjectMacro(CenterPointsImage, CenterPointsImageType);
   itkGetConstObjectMacro(CenterPointsImage, CenterPointsImageType);
 
+  /** Get the multithreader of Compute(), for example to set its number of
+   * work units. */
+  itkGetModifiableObjectMacro(MultiThreader, MultiThreaderBase);
+
   /** Subclasses must implement this method.  If the displacement calculation takes place in
    * SetMetricImagePixel(), then this can do nothing. */
   virtual void
@@ -147,17 +186,27 @@ public:
   {}
 
 protected:
-  using MetricImageDuplicatorType = ImageDuplicator<MetricImageType>;
   MetricImageToDisplacementCalculator();
 
+  /** Create the cached metric image at the index of the MetricImageImage, on
+   * the contiguous buffer when it has the size of the first cached image. */
+  MetricImageType *
+  AllocateCachedMetricImage(const IndexType & index, const MetricImageRegionType & region);
+
   CenterPointsImagePointerType m_CenterPointsImage;
   MetricImageImagePointerType  m_MetricImageImage;
   DisplacementImagePointerType m_DisplacementImage;
 
+  typename BlockMaskImageType::ConstPointer m_BlockMask;
+
   bool m_CacheMetricImage;
+  bool m_PeakNeighborhoodOnly;
   bool m_RegionsDefined;
 
-  typename MetricImageDuplicatorType::Pointer m_MetricImageDuplicator;
+  // The contiguous buffer of the cached metric images with the size
+  // m_MetricImageBufferImageSize.
+  typename MetricImagePixelContainerType::Pointer m_MetricImageBuffer;
+  typename MetricImageRegionType::SizeType        m_MetricImageBufferImageSize;
 
   MultiThreaderBase::Pointer m_MultiThreader;
 
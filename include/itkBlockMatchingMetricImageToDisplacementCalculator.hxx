@@ -23,6 +23,8 @@
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 
+#include <algorithm>
+
 namespace itk
 {
 namespace BlockMatching
@@ -31,11 +33,14 @@ namespace BlockMatching
 template <typename TMetricImage, typename TDisplacementImage>
 MetricImageToDisplacementCalculator<TMetricImage, TDisplacementImage>::MetricImageToDisplacementCalculator()
   : m_CacheMetricImage(false)
+  , m_PeakNeighborhoodOnly(false)
   , m_RegionsDefined(false)
 {
   m_MetricImageImage = nullptr;
   m_DisplacementImage = nullptr;
-  m_MetricImageDuplicator = MetricImageDuplicatorType::New();
+  m_MetricImageBuffer = nullptr;
+  m_MetricImageBufferImageSize.Fill(0);
+  m_BlockMask = nullptr;
   m_MultiThreader = MultiThreaderBase::New();
 }
 
@@ -49,15 +54,57 @@ MetricImageToDisplacementCalculator<TMetricImage, TDisplacementImage>::SetMetric
 {
   if (m_CacheMetricImage)
   {
-    // Copy the image contents to a new image.
-    m_MetricImageDuplicator->SetInputImage(metricImage);
-    m_MetricImageDuplicator->Update();
-    m_MetricImageImage->SetPixel(index, m_MetricImageDuplicator->GetOutput());
+    // Copy the image contents to the cached image, which is only created
+    // when there is none of this size yet.
+    const MetricImageRegionType & region = metricImage->GetBufferedRegion();
+    MetricImageType *             cachedImage = m_MetricImageImage->GetPixel(index).GetPointer();
+    if (cachedImage == nullptr || cachedImage->GetBufferedRegion().GetSize() != region.GetSize())
+    {
+      cachedImage = this->AllocateCachedMetricImage(index, region);
+    }
+    cachedImage->CopyInformation(metricImage);
+    cachedImage->SetRegions(region);
+    std::copy(metricImage->GetBufferPointer(),
+              metricImage->GetBufferPointer() + region.GetNumberOfPixels(),
+              cachedImage->GetBufferPointer());
     m_CenterPointsImage->SetPixel(index, point);
   }
 }
 
 
+template <typename TMetricImage, typename TDisplacementImage>
+auto
+MetricImageToDisplacementCalculator<TMetricImage, TDisplacementImage>::AllocateCachedMetricImage(
+  const IndexType &             index,
+  const MetricImageRegionType & region) -> MetricImageType *
+{
+  MetricImagePointerType cachedImage = MetricImageType::New();
+  cachedImage->SetRegions(region);
+
+  const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+  if (m_MetricImageBuffer.IsNull())
+  {
+    m_MetricImageBufferImageSize = region.GetSize();
+    m_MetricImageBuffer = MetricImagePixelContainerType::New();
+    m_MetricImageBuffer->Reserve(numberOfPixels * m_MetricImageImage->GetLargestPossibleRegion().GetNumberOfPixels());
+  }
+  if (region.GetSize() == m_MetricImageBufferImageSize)
+  {
+    const OffsetValueType offset = m_MetricImageImage->ComputeOffset(index);
+    typename MetricImagePixelContainerType::Pointer container = MetricImagePixelContainerType::New();
+    container->SetImportPointer(m_MetricImageBuffer->GetBufferPointer() + offset * numberOfPixels, numberOfPixels);
+    cachedImage->SetPixelContainer(container);
+  }
+  else
+  {
+    cachedImage->Allocate();
+  }
+
+  m_MetricImageImage->SetPixel(index, cachedImage);
+  return cachedImage.GetPointer();
+}
+
+
 template <typename TMetricImage, typename TDisplacementImage>
 void
 MetricImageToDisplacementCalculator<TMetricImage, TDisplacementImage>::SetDisplacementImage(
@@ -83,8 +130,41 @@ MetricImageToDisplacementCalculator<TMetricImage, TDisplacementImage>::SetDispla
     m_CenterPointsImage->CopyInformation(image);
     m_CenterPointsImage->SetRegions(image->GetLargestPossibleRegion());
     m_CenterPointsImage->Allocate();
+    m_MetricImageBuffer = nullptr;
+    this->Modified();
+  }
+}
+
+
+template <typename TMetricImage, typename TDisplacementImage>
+void
+MetricImageToDisplacementCalculator<TMetricImage, TDisplacementImage>::SetBlockMask(const BlockMaskImageType * mask)
+{
+  if (this->m_BlockMask.GetPointer() != mask)
+  {
+    this->m_BlockMask = mask;
     this->Modified();
   }
+  if (!mask || m_MetricImageImage.IsNull())
+  {
+    return;
+  }
+
+  // The cached images of the missing blocks are stale.
+  RegionType region = mask->GetBufferedRegion();
+  if (!region.Crop(m_MetricImageImage->GetBufferedRegion()))
+  {
+    return;
+  }
+  ImageRegionConstIterator<BlockMaskImageType> maskIt(mask, region);
+  ImageRegionIterator<MetricImageImageType>    imageImageIt(m_MetricImageImage, region);
+  for (maskIt.GoToBegin(), imageImageIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt, ++imageImageIt)
+  {
+    if (!maskIt.Get())
+    {
+      imageImageIt.Set(nullptr);
+    }
+  }
 }
 
 } // end namespace BlockMatching
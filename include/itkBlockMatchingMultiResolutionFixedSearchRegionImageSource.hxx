@@ -118,7 +118,7 @@ MultiResolutionFixedSearchRegionImageSource<TFixedImage, TMovingImage, TDisplace
       startIndex[i] + this->m_MovingImage->GetLargestPossibleRegion().GetSize()[i] - 1 - minimumRegionSize[i];
   }
 
-  if (this->m_CurrentLevel == 0)
+  if (!this->UsesDisplacements())
   {
     ImageRegionIteratorWithIndex<OutputImageType> it(outputPtr, outputRegion);
     for (it.GoToBegin(); !it.IsAtEnd(); ++it)
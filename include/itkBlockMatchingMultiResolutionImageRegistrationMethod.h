@@ -21,10 +21,13 @@
 #include "itkImageSource.h"
 #include "itkMultiResolutionPyramidImageFilter.h"
 
+#include "itkBlockMatchingCorrelationBlockRadiusImageSource.h"
 #include "itkBlockMatchingImageRegistrationMethod.h"
 #include "itkBlockMatchingMultiResolutionBlockRadiusCalculator.h"
 #include "itkBlockMatchingMultiResolutionSearchRegionImageSource.h"
 
+#include <vector>
+
 namespace itk
 {
 namespace BlockMatching
@@ -42,6 +45,20 @@ namespace BlockMatching
  * The SetNumberOfLevels() or SetSchedule() is used to set up the
  * MultiResolutionPyramidImageFilter.
  *
+ * For a cine sequence, where the moving image of a frame is the fixed image of
+ * the next one, ReuseMovingImagePyramid keeps the levels of the moving image
+ * pyramid, and uses them as the fixed image levels of the next update instead
+ * of computing them again.
+ *
+ * When a BlockRadiusImageSource is set, the blocks of the levels whose search
+ * regions are centered on displacements, i.e. the previous level or the
+ * initial displacements, get the radii it computes at those displacements,
+ * which the radius of the BlockRadiusCalculator bounds.
+ *
+ * The Mask, in the physical space of the fixed image, is given to the
+ * ImageRegistrationMethod of every level, so the blocks outside it are not
+ * matched at any level.
+ *
  * \sa ImageRegistrationMethod
  *
  * \ingroup RegistrationFilters
@@ -127,6 +144,14 @@ public:
     typename BlockMatching::MultiResolutionSearchRegionImageSource<TFixedImage, TMovingImage, TDisplacementImage>;
   using SearchRegionImageSourcePointer = typename SearchRegionImageSourceType::Pointer;
 
+  /** Type of the class to calculate the radius of every block from the
+   * displacements the search regions are centered on. */
+  using BlockRadiusImageSourceType = CorrelationBlockRadiusImageSource<TFixedImage, TMovingImage, TDisplacementImage>;
+  using BlockRadiusImageSourcePointer = typename BlockRadiusImageSourceType::Pointer;
+
+  /** Type of the mask of the region of interest. */
+  using MaskImageType = typename ImageRegistrationMethodType::MaskImageType;
+
   /** Method to stop the registration after registering a level. */
   void
   StopRegistration();
@@ -141,11 +166,24 @@ public:
 
   /** Set/Get the Fixed image pyramid. */
   itkSetObjectMacro(FixedImagePyramid, FixedImagePyramidType);
-  itkGetConstObjectMacro(FixedImagePyramid, FixedImagePyramidType);
+  itkGetModifiableObjectMacro(FixedImagePyramid, FixedImagePyramidType);
 
   /** Set/Get the Moving image pyramid. */
   itkSetObjectMacro(MovingImagePyramid, MovingImagePyramidType);
-  itkGetConstObjectMacro(MovingImagePyramid, MovingImagePyramidType);
+  itkGetModifiableObjectMacro(MovingImagePyramid, MovingImagePyramidType);
+
+  /** Set/Get whether the levels of the moving image pyramid of the last
+   * update are used as the fixed image levels when the fixed image is the last
+   * moving image, it was not modified since, and the schedules match.  This
+   * requires the same fixed and moving image types, and is ignored otherwise.
+   * Defaults to false. */
+  itkSetMacro(ReuseMovingImagePyramid, bool);
+  itkGetConstMacro(ReuseMovingImagePyramid, bool);
+  itkBooleanMacro(ReuseMovingImagePyramid);
+
+  /** Get whether the fixed image levels of the last update were the moving
+   * image levels of the update before. */
+  itkGetConstMacro(ReusedMovingImagePyramid, bool);
 
   /** Set/Get the schedules . */
   void
@@ -180,6 +218,16 @@ public:
   itkSetObjectMacro(SearchRegionImageSource, SearchRegionImageSourceType);
   itkGetConstObjectMacro(SearchRegionImageSource, SearchRegionImageSourceType);
 
+  /** Set/Get the object used to generate the radius of every block, or
+   * nullptr, the default, for blocks of the same radius. */
+  itkSetObjectMacro(BlockRadiusImageSource, BlockRadiusImageSourceType);
+  itkGetModifiableObjectMacro(BlockRadiusImageSource, BlockRadiusImageSourceType);
+
+  /** Set/Get the mask of the region of interest, see
+   * ImageRegistrationMethod::SetMask().  By default there is none. */
+  itkSetObjectMacro(Mask, MaskImageType);
+  itkGetConstObjectMacro(Mask, MaskImageType);
+
 protected:
   MultiResolutionImageRegistrationMethod();
   virtual ~MultiResolutionImageRegistrationMethod(){};
@@ -213,6 +261,20 @@ protected:
   void
   PreparePyramids();
 
+  /** Use the moving image levels as the fixed image levels, if they were
+   * computed for the fixed image.  Return whether they were used.  The
+   * template matches different fixed and moving image types, whose levels
+   * cannot be exchanged. */
+  bool
+  ReuseMovingImageLevels(std::vector<FixedImagePointer> &       fixedImageLevels,
+                         const std::vector<FixedImagePointer> & movingImageLevels);
+  template <typename TMovingImageLevels>
+  bool
+  ReuseMovingImageLevels(std::vector<FixedImagePointer> &, const TMovingImageLevels &)
+  {
+    return false;
+  }
+
   /** Set up the fixed block radius calculator. */
   void
   PrepareBlockRadiusCalculator();
@@ -230,6 +292,18 @@ protected:
   FixedImagePyramidPointer  m_FixedImagePyramid;
   MovingImagePyramidPointer m_MovingImagePyramid;
 
+  // The images of every level, which the level registration method
+  // disconnects from the pyramids, and the image and schedule the moving
+  // image levels were computed for.
+  std::vector<FixedImagePointer>         m_FixedImageLevels;
+  std::vector<MovingImagePointer>        m_MovingImageLevels;
+  typename MovingImageType::ConstPointer m_MovingImageLevelsSource;
+  ModifiedTimeType                       m_MovingImageLevelsSourceMTime;
+  ScheduleType                           m_MovingImageLevelsSchedule;
+
+  bool m_ReuseMovingImagePyramid;
+  bool m_ReusedMovingImagePyramid;
+
   unsigned long m_NumberOfLevels;
   unsigned long m_CurrentLevel;
 
@@ -244,6 +318,9 @@ protected:
   ImageRegistrationMethodPointer m_ImageRegistrationMethod;
   BlockRadiusCalculatorPointer   m_BlockRadiusCalculator;
   SearchRegionImageSourcePointer m_SearchRegionImageSource;
+  BlockRadiusImageSourcePointer  m_BlockRadiusImageSource;
+
+  typename MaskImageType::Pointer m_Mask;
 
 private:
 };
@@ -40,11 +40,16 @@ MultiResolutionImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage,
   , m_NumberOfLevels(1)
   , m_CurrentLevel(0)
   , m_Stop(false)
+  , m_MovingImageLevelsSourceMTime(0)
+  , m_ReuseMovingImagePyramid(false)
+  , m_ReusedMovingImagePyramid(false)
   , m_ScheduleSpecified(false)
   , m_NumberOfLevelsSpecified(false)
   , m_ImageRegistrationMethod(nullptr)
   , m_BlockRadiusCalculator(nullptr)
   , m_SearchRegionImageSource(nullptr)
+  , m_BlockRadiusImageSource(nullptr)
+  , m_Mask(nullptr)
 {
   m_FixedImagePyramid = RecursiveMultiResolutionPyramidImageFilter<FixedImageType, FixedImageType>::New();
   m_MovingImagePyramid = RecursiveMultiResolutionPyramidImageFilter<MovingImageType, MovingImageType>::New();
@@ -245,11 +250,55 @@ MultiResolutionImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage,
     m_MovingImagePyramid->SetSchedule(m_MovingImagePyramidSchedule);
   }
 
-  m_FixedImagePyramid->SetInput(m_FixedImage);
-  m_FixedImagePyramid->UpdateLargestPossibleRegion();
+  // If the fixed image is the last moving image, use the levels kept for it.
+  m_ReusedMovingImagePyramid = false;
+  if (m_ReuseMovingImagePyramid && !m_MovingImageLevels.empty() &&
+      m_MovingImageLevelsSchedule == m_FixedImagePyramid->GetSchedule())
+  {
+    m_FixedImage->Update();
+    m_ReusedMovingImagePyramid = this->ReuseMovingImageLevels(m_FixedImageLevels, m_MovingImageLevels);
+  }
+  if (!m_ReusedMovingImagePyramid)
+  {
+    m_FixedImagePyramid->SetInput(m_FixedImage);
+    m_FixedImagePyramid->UpdateLargestPossibleRegion();
+    m_FixedImageLevels.resize(m_FixedImagePyramid->GetNumberOfLevels());
+    for (unsigned int level = 0; level < m_FixedImageLevels.size(); ++level)
+    {
+      m_FixedImageLevels[level] = m_FixedImagePyramid->GetOutput(level);
+    }
+  }
 
   m_MovingImagePyramid->SetInput(m_MovingImage);
   m_MovingImagePyramid->UpdateLargestPossibleRegion();
+  m_MovingImageLevels.resize(m_MovingImagePyramid->GetNumberOfLevels());
+  for (unsigned int level = 0; level < m_MovingImageLevels.size(); ++level)
+  {
+    m_MovingImageLevels[level] = m_MovingImagePyramid->GetOutput(level);
+  }
+  m_MovingImageLevelsSource = m_MovingImage;
+  m_MovingImageLevelsSourceMTime = m_MovingImage->GetMTime();
+  m_MovingImageLevelsSchedule = m_MovingImagePyramid->GetSchedule();
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+bool
+MultiResolutionImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  ReuseMovingImageLevels(std::vector<FixedImagePointer> &       fixedImageLevels,
+                         const std::vector<FixedImagePointer> & movingImageLevels)
+{
+  if (m_MovingImageLevelsSource.GetPointer() != m_FixedImage.GetPointer() ||
+      m_FixedImage->GetMTime() != m_MovingImageLevelsSourceMTime)
+  {
+    return false;
+  }
+  fixedImageLevels = movingImageLevels;
+  return true;
 }
 
 
@@ -315,14 +364,32 @@ MultiResolutionImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage,
       break;
     }
 
-    m_SearchRegionImageSource->SetFixedImage(m_FixedImagePyramid->GetOutput(m_CurrentLevel));
-    m_SearchRegionImageSource->SetMovingImage(m_MovingImagePyramid->GetOutput(m_CurrentLevel));
+    m_SearchRegionImageSource->SetFixedImage(m_FixedImageLevels[m_CurrentLevel]);
+    m_SearchRegionImageSource->SetMovingImage(m_MovingImageLevels[m_CurrentLevel]);
     m_SearchRegionImageSource->SetCurrentLevel(m_CurrentLevel);
     m_SearchRegionImageSource->SetFixedBlockRadius(m_BlockRadiusCalculator->Compute(m_CurrentLevel));
     m_SearchRegionImageSource->UpdateLargestPossibleRegion();
     m_ImageRegistrationMethod->SetRadius(m_BlockRadiusCalculator->Compute(m_CurrentLevel));
-    m_ImageRegistrationMethod->SetFixedImage(m_FixedImagePyramid->GetOutput(m_CurrentLevel));
-    m_ImageRegistrationMethod->SetMovingImage(m_MovingImagePyramid->GetOutput(m_CurrentLevel));
+    m_ImageRegistrationMethod->SetFixedImage(m_FixedImageLevels[m_CurrentLevel]);
+    m_ImageRegistrationMethod->SetMovingImage(m_MovingImageLevels[m_CurrentLevel]);
+    m_ImageRegistrationMethod->SetMask(m_Mask);
+
+    // Size the blocks by how well they match at the displacements the search
+    // regions are centered on.
+    const DisplacementImageType * centerDisplacements = m_SearchRegionImageSource->GetCenterDisplacements();
+    if (m_BlockRadiusImageSource && centerDisplacements)
+    {
+      m_BlockRadiusImageSource->SetFixedImage(m_FixedImageLevels[m_CurrentLevel]);
+      m_BlockRadiusImageSource->SetMovingImage(m_MovingImageLevels[m_CurrentLevel]);
+      m_BlockRadiusImageSource->SetDisplacements(centerDisplacements);
+      m_BlockRadiusImageSource->SetMaximumRadius(m_BlockRadiusCalculator->Compute(m_CurrentLevel));
+      m_BlockRadiusImageSource->UpdateLargestPossibleRegion();
+      m_ImageRegistrationMethod->SetRadiusImage(m_BlockRadiusImageSource->GetOutput());
+    }
+    else
+    {
+      m_ImageRegistrationMethod->SetRadiusImage(nullptr);
+    }
 
     // Invoke an iteration event.
     // This allows a UI to reset any of the components between
@@ -334,6 +401,14 @@ MultiResolutionImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage,
   }
 
   this->GraftOutput(m_ImageRegistrationMethod->GetOutput());
+
+  // Only the moving image levels may be used again.
+  m_FixedImageLevels.clear();
+  if (!m_ReuseMovingImagePyramid)
+  {
+    m_MovingImageLevels.clear();
+    m_MovingImageLevelsSource = nullptr;
+  }
 }
 
 } // namespace BlockMatching
@@ -79,11 +79,15 @@ public:
   const RadiusType &
   Compute(unsigned long level) override
   {
-    double slope;
+    double slope = 0.0;
     double distance = static_cast<double>(this->m_PyramidSchedule.rows() - 1);
     for (unsigned int i = 0; i < this->m_PyramidSchedule.cols(); ++i)
     {
-      slope = (static_cast<double>(m_MinRadius[i]) - static_cast<double>(m_MaxRadius[i])) / distance;
+      // A single level is the top level.
+      if (distance > 0.0)
+      {
+        slope = (static_cast<double>(m_MinRadius[i]) - static_cast<double>(m_MaxRadius[i])) / distance;
+      }
       m_Radius[i] = static_cast<typename RadiusType::SizeValueType>(slope * level + m_MaxRadius[i]);
     }
     return m_Radius;
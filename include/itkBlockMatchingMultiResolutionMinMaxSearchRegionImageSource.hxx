@@ -48,11 +48,15 @@ MultiResolutionMinMaxSearchRegionImageSource<TFixedImage, TMovingImage, TDisplac
   IndexType endIndex;
   IndexType closestIndex;
 
-  double     slope;
+  double     slope = 0.0;
   RadiusType radius;
   for (unsigned int i = 0; i < ImageDimension; ++i)
   {
-    slope = (this->m_MinFactor[i] - this->m_MaxFactor[i]) / (this->m_PyramidSchedule.rows() - 1.0);
+    // A single level is the top level.
+    if (this->m_PyramidSchedule.rows() > 1)
+    {
+      slope = (this->m_MinFactor[i] - this->m_MaxFactor[i]) / (this->m_PyramidSchedule.rows() - 1.0);
+    }
     radius[i] = Math::Ceil<typename RadiusType::SizeValueType>(this->m_FixedBlockRadius[i] *
                                                                (slope * this->m_CurrentLevel + this->m_MaxFactor[i]));
     minimumRegionSize[i] = 2 * radius[i] + 1;
@@ -60,7 +64,7 @@ MultiResolutionMinMaxSearchRegionImageSource<TFixedImage, TMovingImage, TDisplac
       startIndex[i] + this->m_MovingImage->GetLargestPossibleRegion().GetSize()[i] - 1 - minimumRegionSize[i];
   }
 
-  if (this->m_CurrentLevel == 0)
+  if (!this->UsesDisplacements())
   {
     ImageRegionIteratorWithIndex<OutputImageType> it(output, outputRegion);
     for (it.GoToBegin(); !it.IsAtEnd(); ++it)
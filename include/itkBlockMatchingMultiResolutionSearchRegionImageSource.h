@@ -183,6 +183,25 @@ public:
 
   itkGetConstObjectMacro(PreviousDisplacements, DisplacementImageType);
 
+  /** Set/Get the displacements that center the search regions of the top
+   * level, instead of the blocks, such as the displacements of the previous
+   * frame of a cine sequence.  With a good initial displacement, a smaller
+   * search region and fewer levels suffice.  The displacements are copied and
+   * resampled onto the blocks of the top level.  Set to nullptr to start from
+   * no displacement again, which is the default. */
+  virtual void
+  SetInitialDisplacements(const DisplacementImageType * displacements);
+  itkGetConstObjectMacro(InitialDisplacements, DisplacementImageType);
+
+  /** Get the displacements the search regions of the current level are
+   * centered on, on the grid of the output, after an update, or nullptr when
+   * they are centered on the blocks. */
+  const DisplacementImageType *
+  GetCenterDisplacements() const
+  {
+    return this->UsesDisplacements() ? m_DisplacementResampler->GetOutput() : nullptr;
+  }
+
 protected:
   using DisplacementDuplicatorType = ImageDuplicator<DisplacementImageType>;
 
@@ -214,7 +233,18 @@ protected:
 
   unsigned long m_CurrentLevel;
 
+  /** Whether the search regions of the current level are centered on the
+   * displacements resampled by m_DisplacementResampler: the previous
+   * displacements below the top level, and the initial displacements, if any,
+   * at the top level. */
+  bool
+  UsesDisplacements() const
+  {
+    return m_CurrentLevel != 0 || m_InitialDisplacements.IsNotNull();
+  }
+
   DisplacementImagePointer                     m_PreviousDisplacements;
+  DisplacementImagePointer                     m_InitialDisplacements;
   typename DisplacementDuplicatorType::Pointer m_DisplacementDuplicator;
 
   DisplacementResamplerPointer m_DisplacementResampler;
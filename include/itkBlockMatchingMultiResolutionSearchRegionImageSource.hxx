@@ -55,6 +55,31 @@ MultiResolutionSearchRegionImageSource<TFixedImage, TMovingImage, TDisplacementI
 }
 
 
+template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
+void
+MultiResolutionSearchRegionImageSource<TFixedImage, TMovingImage, TDisplacementImage>::SetInitialDisplacements(
+  const DisplacementImageType * displacements)
+{
+  if (displacements == nullptr)
+  {
+    if (m_InitialDisplacements.IsNotNull())
+    {
+      m_InitialDisplacements = nullptr;
+      this->Modified();
+    }
+    return;
+  }
+
+  // A copy, so that the displacements of the previous frame can be the
+  // output of the registration that is executed again.
+  typename DisplacementDuplicatorType::Pointer duplicator = DisplacementDuplicatorType::New();
+  duplicator->SetInputImage(displacements);
+  duplicator->Update();
+  m_InitialDisplacements = duplicator->GetOutput();
+  this->Modified();
+}
+
+
 template <typename TFixedImage, typename TMovingImage, typename TDisplacementImage>
 void
 MultiResolutionSearchRegionImageSource<TFixedImage, TMovingImage, TDisplacementImage>::SetOverlapSchedule(
@@ -136,12 +161,19 @@ template <typename TFixedImage, typename TMovingImage, typename TDisplacement>
 void
 MultiResolutionSearchRegionImageSource<TFixedImage, TMovingImage, TDisplacement>::BeforeThreadedGenerateData()
 {
-  if (this->m_CurrentLevel != 0)
+  if (this->UsesDisplacements())
   {
     // ! @todo these resampler should be replaced by resamplers for each
     // component that can specify a neumann boundary condition
     // ditto with FixedSearchRegionImageSource
-    m_DisplacementResampler->SetInput(this->m_PreviousDisplacements);
+    if (this->m_CurrentLevel != 0)
+    {
+      m_DisplacementResampler->SetInput(this->m_PreviousDisplacements);
+    }
+    else
+    {
+      m_DisplacementResampler->SetInput(this->m_InitialDisplacements);
+    }
     typename OutputImageType::Pointer output = this->GetOutput();
     m_DisplacementResampler->SetSize(output->GetRequestedRegion().GetSize());
     m_DisplacementResampler->SetOutputStartIndex(output->GetRequestedRegion().GetIndex());
@@ -44,7 +44,10 @@ namespace BlockMatching
  * This size is interpolated is interpolated at the following levels.
  *
  * In order to examine the metric image values, this class also inherits from
- * MetricImageToDisplacementCalculator.
+ * MetricImageToDisplacementCalculator.  The metric images are cached, and
+ * Compute() evaluates them in parallel, every work unit with a clone of the
+ * Interpolator.  The search regions are generated with dynamic
+ * multi-threading over the output.
  *
  * A second displacment calculator is used to
  * calculate the displacement from similarity metric images.  This can be set with
@@ -275,8 +278,13 @@ protected:
   virtual void
   BeforeThreadedGenerateData() override;
 
-  virtual void
-  ThreadedGenerateData(const OutputRegionType & outputRegion, ThreadIdType threadID);
+  void
+  DynamicThreadedGenerateData(const OutputRegionType & outputRegion) override;
+
+  /** Compute the search region radii of the blocks of the region from their
+   * cached metric images, with an interpolator of the work unit. */
+  void
+  ThreadedComputeSearchRegionRadii(const OutputRegionType & region);
 
   RadiusType m_TopLevelRadius;
   bool       m_TopLevelRadiusSpecified;
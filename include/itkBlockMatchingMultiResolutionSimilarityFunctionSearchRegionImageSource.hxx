@@ -62,6 +62,8 @@ MultiResolutionSimilarityFunctionSearchRegionImageSource<
   m_DisplacementCalculator = MaximumPixelDisplacementCalculator<TMetricImage, TDisplacementImage>::New();
 
   m_Interpolator = LinearInterpolateImageFunction<MetricImageType, TInterpolatorPrecisionType>::New();
+
+  this->DynamicMultiThreadingOn();
 }
 
 
@@ -133,12 +135,47 @@ MultiResolutionSimilarityFunctionSearchRegionImageSource<TFixedImage,
 {
   m_DisplacementCalculator->Compute();
 
-  OutputImageType * outputPtr = this->GetOutput();
-  if (!outputPtr)
+  if (!this->GetOutput())
   {
     return;
   }
 
+  // The blocks are independent, so they are split among the work units.
+  this->DisplacementCalculatorSuperclass::GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+    this->m_MetricImageImage->GetBufferedRegion(),
+    [this](const OutputRegionType & region) { this->ThreadedComputeSearchRegionRadii(region); },
+    nullptr);
+}
+
+
+template <class TFixedImage,
+          class TMovingImage,
+          class TMetricImage,
+          class TDisplacementImage,
+          class TFunctor,
+          class TInterpolatorPrecisionType>
+void
+MultiResolutionSimilarityFunctionSearchRegionImageSource<
+  TFixedImage,
+  TMovingImage,
+  TMetricImage,
+  TDisplacementImage,
+  TFunctor,
+  TInterpolatorPrecisionType>::ThreadedComputeSearchRegionRadii(const OutputRegionType & region)
+{
+  // The interpolator holds the metric image of the block, so every work unit
+  // has its own.
+  InterpolatorPointerType interpolator = m_Interpolator;
+  if (this->DisplacementCalculatorSuperclass::GetMultiThreader()->GetNumberOfWorkUnits() > 1)
+  {
+    interpolator = dynamic_cast<InterpolatorType *>(m_Interpolator->Clone().GetPointer());
+    if (interpolator.IsNull())
+    {
+      itkExceptionMacro(<< "Could not clone the interpolator.");
+    }
+  }
+
+  const OutputImageType *                         outputPtr = this->GetOutput();
   PointType                                       point;
   typename MetricImageType::PixelType             metric;
   typename SearchRegionRadiusImageType::PixelType radius;
@@ -146,15 +183,11 @@ MultiResolutionSimilarityFunctionSearchRegionImageSource<TFixedImage,
 
   // Iterate over the displacements and get the corresponding metric image value
   // at the given point.
-  ImageRegionConstIteratorWithIndex<MetricImageImageType> metricImageImageConstIt(
-    this->m_MetricImageImage, this->m_MetricImageImage->GetBufferedRegion());
-  ImageRegionConstIterator<CenterPointsImageType>  centerPointsConstIt(this->m_CenterPointsImage,
-                                                                      this->m_CenterPointsImage->GetBufferedRegion());
-  ImageRegionConstIterator<DisplacementImageType>  displacementIt(this->m_DisplacementImage,
-                                                                 this->m_DisplacementImage->GetBufferedRegion());
-  ImageRegionIterator<OutputImageType>             previousSearchRegionIt(outputPtr, outputPtr->GetBufferedRegion());
-  ImageRegionIterator<SearchRegionRadiusImageType> searchRegionRadiusIt(
-    this->m_SearchRegionRadiusImage, this->m_SearchRegionRadiusImage->GetBufferedRegion());
+  ImageRegionConstIterator<MetricImageImageType>   metricImageImageConstIt(this->m_MetricImageImage, region);
+  ImageRegionConstIterator<CenterPointsImageType>  centerPointsConstIt(this->m_CenterPointsImage, region);
+  ImageRegionConstIterator<DisplacementImageType>  displacementIt(this->m_DisplacementImage, region);
+  ImageRegionConstIterator<OutputImageType>        previousSearchRegionIt(outputPtr, region);
+  ImageRegionIterator<SearchRegionRadiusImageType> searchRegionRadiusIt(this->m_SearchRegionRadiusImage, region);
   for (metricImageImageConstIt.GoToBegin(),
        centerPointsConstIt.GoToBegin(),
        displacementIt.GoToBegin(),
@@ -167,10 +200,20 @@ MultiResolutionSimilarityFunctionSearchRegionImageSource<TFixedImage,
        ++previousSearchRegionIt,
        ++searchRegionRadiusIt)
   {
-    point = centerPointsConstIt.Get() + displacementIt.Get();
-    m_Interpolator->SetInputImage(metricImageImageConstIt.Get());
-    metric = m_Interpolator->Evaluate(point);
     size = previousSearchRegionIt.Get().GetSize();
+    // The missing blocks of a mask keep their search region radius.
+    if (metricImageImageConstIt.Get() == nullptr)
+    {
+      for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+        radius[i] = (size[i] - 1) / 2;
+      }
+      searchRegionRadiusIt.Set(radius);
+      continue;
+    }
+    point = centerPointsConstIt.Get() + displacementIt.Get();
+    interpolator->SetInputImage(metricImageImageConstIt.Get());
+    metric = interpolator->Evaluate(point);
     for (unsigned int i = 0; i < ImageDimension; ++i)
     {
       radius[i] = (size[i] - 1) / 2 * m_Functor(metric);
@@ -232,7 +275,7 @@ MultiResolutionSimilarityFunctionSearchRegionImageSource<
   TMetricImage,
   TDisplacementImage,
   TFunctor,
-  TInterpolatorPrecisionType>::ThreadedGenerateData(const OutputRegionType & outputRegion, ThreadIdType threadID)
+  TInterpolatorPrecisionType>::DynamicThreadedGenerateData(const OutputRegionType & outputRegion)
 {
   OutputImageType * outputPtr = this->GetOutput();
   if (!outputPtr)
@@ -250,11 +293,21 @@ MultiResolutionSimilarityFunctionSearchRegionImageSource<
 
   if (this->m_CurrentLevel == 0)
   {
+    // Centered on the initial displacements, if any.
+    const DisplacementImageType * initialDisplacements = nullptr;
+    if (this->m_InitialDisplacements.IsNotNull())
+    {
+      initialDisplacements = this->m_DisplacementResampler->GetOutput();
+    }
     ImageRegionIteratorWithIndex<OutputImageType> it(outputPtr, outputRegion);
     for (it.GoToBegin(); !it.IsAtEnd(); ++it)
     {
       index = it.GetIndex();
       outputPtr->TransformIndexToPhysicalPoint(index, point);
+      if (initialDisplacements)
+      {
+        point += initialDisplacements->GetPixel(index);
+      }
       this->m_MovingImage->TransformPhysicalPointToIndex(point, index);
       region.SetIndex(index);
       region.SetSize(unitySize);
@@ -43,7 +43,9 @@ namespace BlockMatching
  *
  * In order to examine the metric image values, this class also inherits from
  * MetricImageToDisplacementCalculator.  The center of the search region is
- * taken to be the displacement.
+ * taken to be the displacement.  The metric images are cached, and Compute()
+ * finds their bounding boxes in parallel.  The search regions are generated
+ * with dynamic multi-threading over the output.
  *
  * \ingroup Ultrasound
  * */
@@ -106,6 +108,8 @@ public:
 
   /** Types inherited from the DisplacementCalculator superclass. */
   using MetricImageType = typename DisplacementCalculatorSuperclass::MetricImageType;
+  using MetricImageImageType = typename DisplacementCalculatorSuperclass::MetricImageImageType;
+  using CenterPointsImageType = typename DisplacementCalculatorSuperclass::CenterPointsImageType;
   using PointType = typename DisplacementCalculatorSuperclass::PointType;
   using IndexType = typename DisplacementCalculatorSuperclass::IndexType;
 
@@ -185,13 +189,10 @@ public:
   virtual void
   SetMetricImagePixel(const PointType & point, const IndexType & index, MetricImageType * image);
 
+  /** Computes the search region radii of the cached metric images in
+   * parallel. */
   virtual void
-  Compute()
-  {
-    // We do this here instead of SetMetricImagePixel so it only has to be done
-    // once.
-    this->m_DisplacementImage->Modified();
-  }
+  Compute();
 
   /** This is needed to avoid resolution ambiguities that occur with multiple
    * inheritance. */
@@ -227,8 +228,18 @@ protected:
   virtual void
   BeforeThreadedGenerateData() override;
 
-  virtual void
-  ThreadedGenerateData(const OutputRegionType & outputRegion, ThreadIdType threadID) override;
+  void
+  DynamicThreadedGenerateData(const OutputRegionType & outputRegion) override;
+
+  /** Compute the search region radii and the displacements of the blocks of
+   * the region from the bounding boxes of their cached metric images. */
+  void
+  ThreadedComputeSearchRegionRadii(const OutputRegionType & region);
+
+  /** Set the search region radius and the displacement of the block at the
+   * index from the bounding box of its metric image above the threshold. */
+  void
+  ComputeSearchRegionRadius(const PointType & point, const IndexType & index, const MetricImageType * metricImage);
 
   ThresholdScheduleType m_ThresholdSchedule;
   bool                  m_ThresholdScheduleSpecified;
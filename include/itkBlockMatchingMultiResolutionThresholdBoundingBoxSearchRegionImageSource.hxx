@@ -22,6 +22,7 @@
 
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkResampleImageFilter.h"
 #include "itkNearestNeighborExtrapolateImageFunction.h"
@@ -52,6 +53,9 @@ MultiResolutionThresholdBoundingBoxSearchRegionImageSource<
 
   // Sane default.
   m_MinimumSearchRegionRadius.Fill(1);
+
+  this->m_CacheMetricImage = true;
+  this->DynamicMultiThreadingOn();
 }
 
 template <class TFixedImage, class TMovingImage, class TMetricImage, class TDisplacementImage>
@@ -111,7 +115,65 @@ MultiResolutionThresholdBoundingBoxSearchRegionImageSource<
   {
     itkExceptionMacro(<< "Threshold has not been set.");
   }
+  if (!this->m_CacheMetricImage)
+  {
+    this->ComputeSearchRegionRadius(point, index, metricImage);
+  }
+}
+
+
+template <class TFixedImage, class TMovingImage, class TMetricImage, class TDisplacementImage>
+void
+MultiResolutionThresholdBoundingBoxSearchRegionImageSource<TFixedImage,
+                                                           TMovingImage,
+                                                           TMetricImage,
+                                                           TDisplacementImage>::Compute()
+{
+  if (this->m_CacheMetricImage)
+  {
+    // The blocks are independent, so they are split among the work units.
+    this->DisplacementCalculatorSuperclass::GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+      this->m_DisplacementImage->GetRequestedRegion(),
+      [this](const OutputRegionType & region) { this->ThreadedComputeSearchRegionRadii(region); },
+      nullptr);
+  }
+  // We do this here instead of SetMetricImagePixel so it only has to be done
+  // once.
+  this->m_DisplacementImage->Modified();
+}
+
+
+template <class TFixedImage, class TMovingImage, class TMetricImage, class TDisplacementImage>
+void
+MultiResolutionThresholdBoundingBoxSearchRegionImageSource<
+  TFixedImage,
+  TMovingImage,
+  TMetricImage,
+  TDisplacementImage>::ThreadedComputeSearchRegionRadii(const OutputRegionType & region)
+{
+  ImageRegionConstIteratorWithIndex<MetricImageImageType> imageImageIt(this->m_MetricImageImage, region);
+  ImageRegionConstIterator<CenterPointsImageType>         centerPointsIt(this->m_CenterPointsImage, region);
+  for (imageImageIt.GoToBegin(), centerPointsIt.GoToBegin(); !imageImageIt.IsAtEnd(); ++imageImageIt, ++centerPointsIt)
+  {
+    // The missing blocks of a mask are skipped.
+    if (imageImageIt.Get() != nullptr)
+    {
+      this->ComputeSearchRegionRadius(centerPointsIt.Get(), imageImageIt.GetIndex(), imageImageIt.Get());
+    }
+  }
+}
+
 
+template <class TFixedImage, class TMovingImage, class TMetricImage, class TDisplacementImage>
+void
+MultiResolutionThresholdBoundingBoxSearchRegionImageSource<
+  TFixedImage,
+  TMovingImage,
+  TMetricImage,
+  TDisplacementImage>::ComputeSearchRegionRadius(const PointType &       point,
+                                                 const IndexType &       index,
+                                                 const MetricImageType * metricImage)
+{
   using MetricRegionType = typename MetricImageType::RegionType;
   using MetricIndexType = typename MetricRegionType::IndexType;
 
@@ -204,12 +266,19 @@ MultiResolutionThresholdBoundingBoxSearchRegionImageSource<TFixedImage,
                                                            TMetricImage,
                                                            TDisplacementImage>::BeforeThreadedGenerateData()
 {
-  if (this->m_CurrentLevel != 0)
+  if (this->UsesDisplacements())
   {
     //! @todo these resampler should be replaced by resamplers for each
     // component that can specify a neumann boundary condition
     // ditto with FixedSearchRegionImageSource
-    m_DisplacementResampler->SetInput(this->m_PreviousDisplacements);
+    if (this->m_CurrentLevel != 0)
+    {
+      m_DisplacementResampler->SetInput(this->m_PreviousDisplacements);
+    }
+    else
+    {
+      m_DisplacementResampler->SetInput(this->m_InitialDisplacements);
+    }
     typename OutputImageType::Pointer outputPtr = this->GetOutput();
     if (!outputPtr)
       return;
@@ -219,7 +288,13 @@ MultiResolutionThresholdBoundingBoxSearchRegionImageSource<TFixedImage,
     m_DisplacementResampler->SetOutputOrigin(outputPtr->GetOrigin());
     m_DisplacementResampler->SetOutputDirection(outputPtr->GetDirection());
     m_DisplacementResampler->UpdateLargestPossibleRegion();
+  }
 
+  if (this->m_CurrentLevel != 0)
+  {
+    typename OutputImageType::Pointer outputPtr = this->GetOutput();
+    if (!outputPtr)
+      return;
     m_SearchRegionRadiusResampler->SetInput(this->m_SearchRegionRadiusImage);
     m_SearchRegionRadiusResampler->SetSize(outputPtr->GetRequestedRegion().GetSize());
     m_SearchRegionRadiusResampler->SetOutputStartIndex(outputPtr->GetRequestedRegion().GetIndex());
@@ -241,7 +316,7 @@ MultiResolutionThresholdBoundingBoxSearchRegionImageSource<
   TFixedImage,
   TMovingImage,
   TMetricImage,
-  TDisplacementImage>::ThreadedGenerateData(const OutputRegionType & outputRegion, ThreadIdType threadID)
+  TDisplacementImage>::DynamicThreadedGenerateData(const OutputRegionType & outputRegion)
 {
   OutputImageType * outputPtr = this->GetOutput();
   if (!outputPtr)
@@ -259,11 +334,21 @@ MultiResolutionThresholdBoundingBoxSearchRegionImageSource<
 
   if (this->m_CurrentLevel == 0)
   {
+    // Centered on the initial displacements, if any.
+    const DisplacementImageType * initialDisplacements = nullptr;
+    if (this->m_InitialDisplacements.IsNotNull())
+    {
+      initialDisplacements = m_DisplacementResampler->GetOutput();
+    }
     ImageRegionIteratorWithIndex<OutputImageType> it(outputPtr, outputRegion);
     for (it.GoToBegin(); !it.IsAtEnd(); ++it)
     {
       index = it.GetIndex();
       outputPtr->TransformIndexToPhysicalPoint(index, point);
+      if (initialDisplacements)
+      {
+        point += initialDisplacements->GetPixel(index);
+      }
       this->m_MovingImage->TransformPhysicalPointToIndex(point, index);
       region.SetIndex(index);
       region.SetSize(unitySize);
@@ -18,6 +18,7 @@
 #ifndef itkBlockMatchingNormalizedCrossCorrelationFFTMetricImageFilter_h
 #define itkBlockMatchingNormalizedCrossCorrelationFFTMetricImageFilter_h
 
+#include "itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter.h"
 #include "itkBlockMatchingNormalizedCrossCorrelationMetricImageFilter.h"
 
 #include "itkComplexConjugateImageFilter.h"
@@ -29,6 +30,8 @@
 
 #include "itkMultiplyImageFilter.h"
 
+#include <vector>
+
 namespace itk
 {
 namespace BlockMatching
@@ -39,6 +42,25 @@ namespace BlockMatching
  * \brief Create an image of the the normalized cross correlation with a kernel
  * calculated with FFT based correlation (multiply forward FFT's and take IFFT).
  *
+ * When a MovingTileSize is set, the moving image less its local means is
+ * transformed in tiles of at least that size, and the spectrum of a tile is
+ * reused by all the blocks whose search region, dilated by the block radius,
+ * falls inside it.  Only the block is transformed for every block, on the
+ * padded buffers of the tile size kept from one block to the next.  The
+ * spectra are kept until the moving image or the block radius changes.  The
+ * tiles are taken from the buffered region of the moving image, so it should
+ * be buffered whole, as it is in BlockMatching::ImageRegistrationMethod.
+ *
+ * The direct correlation of NormalizedCrossCorrelationKernelMetricImageFilter
+ * is cheaper than the FFT's for small blocks and search regions, such as those
+ * of the last levels of a multi-resolution registration.  When a
+ * DirectCorrelationCostFactor is set, ComputeMetricImage() uses it for the
+ * blocks where it costs less, so that
+ * BlockMatching::ImageRegistrationMethod picks one or the other at every
+ * level.  Since the direct correlation normalizes with the mean of every
+ * window, and it is zero where the window is not inside the moving image, its
+ * metric differs slightly from the FFT's.
+ *
  * \sa NormalizedCrossCorrelationMetricImageFilter
  *
  * \ingroup Ultrasound
@@ -70,6 +92,8 @@ public:
   /** Type of the moving image. */
   using MovingImageType = typename Superclass::MovingImageType;
   using MovingImageConstPointerType = typename MovingImageType::ConstPointer;
+  using MovingImageRegionType = typename MovingImageType::RegionType;
+  using MovingImageSizeType = typename MovingImageRegionType::SizeType;
 
   /** Type of the metric image. */
   using MetricImageType = typename Superclass::MetricImageType;
@@ -91,9 +115,51 @@ e  */
   itkGetConstMacro(SizeGreatestPrimeFactor, SizeValueType);
   itkSetMacro(SizeGreatestPrimeFactor, SizeValueType);
 
+  /** Set/Get the minimum size of the tiles of the moving image whose spectra
+   * are reused across blocks.  The tiles are enlarged as needed to contain a
+   * block's search region dilated by the block radius, and to satisfy the
+   * SizeGreatestPrimeFactor.  Tiles that are about the size of the dilated
+   * search regions of a few neighboring blocks work best.  A size of zero,
+   * the default, disables the tiles. */
+  itkGetConstReferenceMacro(MovingTileSize, MovingImageSizeType);
+  itkSetMacro(MovingTileSize, MovingImageSizeType);
+
+  /** Set/Get the factor of the cost of the FFT correlation, estimated as
+   * N log2(N) for the N pixels of the padded search region, under which the
+   * cost of the direct correlation, the number of pixels of the block times
+   * the number of pixels of the search region, makes ComputeMetricImage() use
+   * it.  The default of zero never uses the direct correlation. */
+  itkSetMacro(DirectCorrelationCostFactor, double);
+  itkGetConstMacro(DirectCorrelationCostFactor, double);
+
+  /** Set/Get whether the internal pipeline keeps its buffers from one block
+   * to the next.  When on, the product of the spectra is not computed in
+   * place, so that the conjugate kernel spectrum keeps its buffer, and the
+   * intermediate images are only reallocated when their region grows.  This
+   * costs one more complex image, and saves an allocation per block.  Off by
+   * default. */
+  itkSetMacro(ReuseAllocations, bool);
+  itkGetConstMacro(ReuseAllocations, bool);
+  itkBooleanMacro(ReuseAllocations);
+
+  /** Type of the filter for the direct correlation. */
+  using DirectMetricImageFilterType =
+    NormalizedCrossCorrelationKernelMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>;
+
+  /** Compute the metric image with the direct correlation when it costs
+   * less.  Otherwise, this returns false, and the filter is updated for the
+   * block. */
+  bool
+  ComputeMetricImage(const typename Superclass::FixedImageRegionType & fixedRegion,
+                     const MovingImageRegionType &                     movingRegion,
+                     MetricImageType *                                 metricImage) override;
+
 protected:
   NormalizedCrossCorrelationFFTMetricImageFilter();
 
+  LightObject::Pointer
+  InternalClone() const override;
+
   virtual void
   GenerateData() override;
 
@@ -117,6 +183,41 @@ protected:
   typename CropFilterType::Pointer             m_CropFilter;
 
   SizeValueType m_SizeGreatestPrimeFactor;
+  bool          m_ReuseAllocations;
+
+  /** Whether or not the MovingTileSize is set. */
+  bool
+  UsesMovingTiles() const;
+
+  /** The correlation of the fixed image less its mean with the moving image
+   * less its local means, from the spectrum of the tile that contains the
+   * search region.  The returned image has the region of the tile. */
+  const MetricImageType *
+  CorrelateWithMovingTile(const MetricImageType * fixedMinusMean);
+
+  struct MovingTile
+  {
+    MovingImageRegionType              Region;
+    typename ComplexImageType::Pointer Spectrum;
+  };
+
+  MovingImageSizeType                m_MovingTileSize;
+  std::vector<MovingTile>            m_MovingTiles;
+  const MovingImageType *            m_MovingTilesImage;
+  ModifiedTimeType                   m_MovingTilesTime;
+  typename Superclass::RadiusType    m_MovingTilesRadius;
+  MetricImagePointerType             m_TileMean;
+  MetricImagePointerType             m_TilePseudoSigma;
+  MetricImagePointerType             m_TileImage;
+  MetricImagePointerType             m_TileKernel;
+  typename ComplexImageType::Pointer m_TileProduct;
+  MetricImagePointerType             m_TileCorrelation;
+  typename FFTFilterType::Pointer    m_TileFFTFilter;
+  typename FFTFilterType::Pointer    m_TileKernelFFTFilter;
+  typename IFFTFilterType::Pointer   m_TileIFFTFilter;
+
+  double                                        m_DirectCorrelationCostFactor;
+  typename DirectMetricImageFilterType::Pointer m_DirectMetricImageFilter;
 
 private:
   NormalizedCrossCorrelationFFTMetricImageFilter(const Self &); // purposely not implemented
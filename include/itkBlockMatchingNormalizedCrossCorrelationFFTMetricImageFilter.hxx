@@ -21,8 +21,11 @@
 #include "itkBlockMatchingNormalizedCrossCorrelationFFTMetricImageFilter.h"
 
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 
+#include <cmath>
+
 namespace itk
 {
 namespace BlockMatching
@@ -46,6 +49,7 @@ NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetri
   m_MovingFFTFilter->SetInput(m_MovingPadFilter->GetOutput());
 
   m_SizeGreatestPrimeFactor = m_MovingFFTFilter->GetSizeGreatestPrimeFactor();
+  m_ReuseAllocations = false;
 
   m_ComplexConjugateImageFilter = ComplexConjugateFilterType::New();
   m_ComplexConjugateImageFilter->SetInput(m_KernelFFTFilter->GetOutput());
@@ -60,6 +64,241 @@ NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetri
 
   m_CropFilter = CropFilterType::New();
   m_CropFilter->SetInput(m_IFFTFilter->GetOutput());
+
+  m_MovingTileSize.Fill(0);
+  m_MovingTilesImage = nullptr;
+  m_MovingTilesTime = 0;
+  m_MovingTilesRadius.Fill(0);
+  m_TileMean = MetricImageType::New();
+  m_TilePseudoSigma = MetricImageType::New();
+  m_TileImage = MetricImageType::New();
+  m_TileKernel = MetricImageType::New();
+  m_TileProduct = ComplexImageType::New();
+  m_TileCorrelation = MetricImageType::New();
+  m_TileFFTFilter = FFTFilterType::New();
+  m_TileKernelFFTFilter = FFTFilterType::New();
+  m_TileKernelFFTFilter->SetInput(m_TileKernel);
+  m_TileIFFTFilter = IFFTFilterType::New();
+  m_TileIFFTFilter->SetInput(m_TileProduct);
+
+  m_DirectCorrelationCostFactor = 0.0;
+  m_DirectMetricImageFilter = DirectMetricImageFilterType::New();
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+LightObject::Pointer
+NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::InternalClone() const
+{
+  LightObject::Pointer loPtr = Superclass::InternalClone();
+  typename Self::Pointer rval = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (rval.IsNull())
+  {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+  }
+  rval->m_SizeGreatestPrimeFactor = m_SizeGreatestPrimeFactor;
+  rval->m_ReuseAllocations = m_ReuseAllocations;
+  rval->m_MovingTileSize = m_MovingTileSize;
+  rval->m_DirectCorrelationCostFactor = m_DirectCorrelationCostFactor;
+  return loPtr;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+bool
+NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::ComputeMetricImage(
+  const typename Superclass::FixedImageRegionType & fixedRegion,
+  const MovingImageRegionType &                     movingRegion,
+  MetricImageType *                                 metricImage)
+{
+  if (!(m_DirectCorrelationCostFactor > 0.0))
+  {
+    return false;
+  }
+
+  double directCost = 1.0;
+  double paddedPixels = 1.0;
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    directCost *= static_cast<double>(fixedRegion.GetSize()[ii]) * static_cast<double>(movingRegion.GetSize()[ii]);
+    paddedPixels *= static_cast<double>(movingRegion.GetSize()[ii] + fixedRegion.GetSize()[ii] - 1);
+  }
+  if (directCost > m_DirectCorrelationCostFactor * paddedPixels * std::log2(paddedPixels))
+  {
+    return false;
+  }
+
+  m_DirectMetricImageFilter->SetFixedImage(const_cast<FixedImageType *>(this->GetInput(0)));
+  m_DirectMetricImageFilter->SetMovingImage(const_cast<MovingImageType *>(this->GetInput(1)));
+  return m_DirectMetricImageFilter->ComputeMetricImage(fixedRegion, movingRegion, metricImage);
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+bool
+NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::UsesMovingTiles() const
+{
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    if (m_MovingTileSize[ii] > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+auto
+NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::CorrelateWithMovingTile(
+  const MetricImageType * fixedMinusMean) -> const MetricImageType *
+{
+  // GenerateHelperImages then subtracts the mean of the whole search region
+  // instead of the local means.
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    if (2 * this->m_MovingRadius[ii] + 1 >= this->m_MovingImageRegion.GetSize()[ii])
+    {
+      return nullptr;
+    }
+  }
+
+  MovingImageConstPointerType movingPtr = this->GetInput(1);
+  if (movingPtr.GetPointer() != m_MovingTilesImage || movingPtr->GetMTime() != m_MovingTilesTime ||
+      m_MovingTilesRadius != this->m_MovingRadius)
+  {
+    m_MovingTiles.clear();
+    m_MovingTilesImage = movingPtr.GetPointer();
+    m_MovingTilesTime = movingPtr->GetMTime();
+    m_MovingTilesRadius = this->m_MovingRadius;
+  }
+
+  // The moving samples the block is compared with.  The tile must contain
+  // them, including the ones outside the image, which are zero, so that the
+  // circular correlation does not wrap around.
+  MovingImageRegionType neededRegion = this->m_MovingImageRegion;
+  neededRegion.PadByRadius(this->m_MovingRadius);
+
+  // The blocks are usually matched one line after the other, so the last
+  // tiles are the most likely to contain the next search region.
+  const MovingTile * tile = nullptr;
+  for (auto tileIt = m_MovingTiles.rbegin(); tileIt != m_MovingTiles.rend(); ++tileIt)
+  {
+    if (tileIt->Region.IsInside(neededRegion))
+    {
+      tile = &(*tileIt);
+      break;
+    }
+  }
+
+  if (tile == nullptr)
+  {
+    MovingImageSizeType tileSize;
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      tileSize[ii] = std::max(m_MovingTileSize[ii], neededRegion.GetSize()[ii]);
+      if (m_SizeGreatestPrimeFactor > 1)
+      {
+        while (Math::GreatestPrimeFactor(tileSize[ii]) > m_SizeGreatestPrimeFactor)
+        {
+          ++tileSize[ii];
+        }
+      }
+      else if (m_SizeGreatestPrimeFactor == 1)
+      {
+        // make sure the total size is even
+        tileSize[ii] += tileSize[ii] % 2;
+      }
+    }
+    const MovingImageRegionType tileRegion(neededRegion.GetIndex(), tileSize);
+
+    // The moving image less the local means in the buffered part of the tile,
+    // and zero elsewhere.
+    m_TileImage->CopyInformation(movingPtr);
+    m_TileImage->SetRegions(tileRegion);
+    m_TileImage->Allocate();
+    m_TileImage->FillBuffer(NumericTraits<MetricImagePixelType>::Zero);
+    MovingImageRegionType dataRegion = tileRegion;
+    if (dataRegion.Crop(movingPtr->GetBufferedRegion()))
+    {
+      m_TileMean->SetRegions(dataRegion);
+      m_TileMean->Allocate();
+      m_TilePseudoSigma->SetRegions(dataRegion);
+      m_TilePseudoSigma->Allocate();
+      this->ComputeMovingBoxStatistics(dataRegion, m_TilePseudoSigma, m_TileMean);
+
+      ImageRegionIterator<MetricImageType>      tileImageIt(m_TileImage, dataRegion);
+      ImageRegionConstIterator<MetricImageType> meanIt(m_TileMean, dataRegion);
+      ImageRegionConstIterator<MovingImageType> movingIt(movingPtr, dataRegion);
+      for (tileImageIt.GoToBegin(), meanIt.GoToBegin(), movingIt.GoToBegin(); !tileImageIt.IsAtEnd();
+           ++tileImageIt, ++meanIt, ++movingIt)
+      {
+        tileImageIt.Set(movingIt.Get() - meanIt.Get());
+      }
+    }
+    m_TileImage->Modified();
+
+    m_TileFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_TileFFTFilter->SetInput(m_TileImage);
+    m_TileFFTFilter->Update();
+    MovingTile newTile;
+    newTile.Region = tileRegion;
+    newTile.Spectrum = m_TileFFTFilter->GetOutput();
+    newTile.Spectrum->DisconnectPipeline();
+    m_MovingTiles.push_back(newTile);
+    tile = &m_MovingTiles.back();
+  }
+  const MovingImageRegionType & tileRegion = tile->Region;
+  const MovingImageSizeType &   tileSize = tileRegion.GetSize();
+
+  // The block less its mean, with its center at the origin of the tile and
+  // wrapped around.
+  m_TileKernel->CopyInformation(fixedMinusMean);
+  m_TileKernel->SetRegions(tileRegion);
+  m_TileKernel->Allocate();
+  m_TileKernel->FillBuffer(NumericTraits<MetricImagePixelType>::Zero);
+  ImageRegionConstIteratorWithIndex<MetricImageType> fixedIt(fixedMinusMean, this->m_FixedImageRegion);
+  typename MetricImageType::IndexType                kernelIndex;
+  for (fixedIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt)
+  {
+    const typename MetricImageType::IndexType & fixedIndex = fixedIt.GetIndex();
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      const OffsetValueType tileLength = static_cast<OffsetValueType>(tileSize[ii]);
+      const OffsetValueType offset = fixedIndex[ii] - this->m_FixedImageRegion.GetIndex()[ii] -
+                                     static_cast<OffsetValueType>(this->m_FixedRadius[ii]);
+      kernelIndex[ii] = tileRegion.GetIndex()[ii] + (offset + tileLength) % tileLength;
+    }
+    m_TileKernel->SetPixel(kernelIndex, fixedIt.Get());
+  }
+  m_TileKernel->Modified();
+  m_TileKernelFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  m_TileKernelFFTFilter->Update();
+
+  // Correlate with the spectrum of the tile.
+  const ComplexImageType * kernelSpectrum = m_TileKernelFFTFilter->GetOutput();
+  const ComplexImageType * tileSpectrum = tile->Spectrum;
+  m_TileProduct->CopyInformation(tileSpectrum);
+  m_TileProduct->SetRegions(tileSpectrum->GetLargestPossibleRegion());
+  m_TileProduct->Allocate();
+  const typename ComplexImageType::PixelType * kernelBuffer = kernelSpectrum->GetBufferPointer();
+  const typename ComplexImageType::PixelType * tileBuffer = tileSpectrum->GetBufferPointer();
+  typename ComplexImageType::PixelType *       productBuffer = m_TileProduct->GetBufferPointer();
+  const SizeValueType                          numberOfFrequencies = tileSpectrum->GetPixelContainer()->Size();
+  for (SizeValueType ii = 0; ii < numberOfFrequencies; ++ii)
+  {
+    productBuffer[ii] = std::conj(kernelBuffer[ii]) * tileBuffer[ii];
+  }
+  m_TileProduct->Modified();
+
+  m_TileIFFTFilter->SetActualXDimensionIsOdd(tileSize[0] % 2 == 1);
+  m_TileIFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  m_TileIFFTFilter->Update();
+
+  m_TileCorrelation->SetRegions(tileRegion);
+  m_TileCorrelation->SetPixelContainer(m_TileIFFTFilter->GetOutput()->GetPixelContainer());
+  return m_TileCorrelation;
 }
 
 
@@ -83,79 +322,93 @@ NormalizedCrossCorrelationFFTMetricImageFilter<TFixedImage, TMovingImage, TMetri
   MetricImagePointerType      fixedMinusMean = this->GetOutput(2);
   MetricImageConstPointerType movingMinusMean = this->GetOutput(3);
 
-  // The moving search region for this thread.
-  m_MovingPadFilter->SetInput(movingMinusMean);
-  m_KernelPadFilter->SetInput(fixedMinusMean);
-
-  const MetricImageRegionType &                     fixedMinusMeanRegion = fixedMinusMean->GetLargestPossibleRegion();
-  const typename MetricImageRegionType::SizeType &  fixedMinusMeanSize = fixedMinusMeanRegion.GetSize();
-  const typename MetricImageRegionType::IndexType & fixedMinusMeanIndex = fixedMinusMeanRegion.GetIndex();
-  const MetricImageRegionType &                     movingMinusMeanRegion = movingMinusMean->GetLargestPossibleRegion();
-  const typename MetricImageRegionType::SizeType &  movingMinusMeanSize = movingMinusMeanRegion.GetSize();
-  const typename MetricImageRegionType::IndexType & movingMinusMeanIndex = movingMinusMeanRegion.GetIndex();
-  typename MetricImageRegionType::IndexType         paddedIndex;
-  typename MetricImageRegionType::SizeType          paddedSize;
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  const MetricImageType * correlation = nullptr;
+  if (this->UsesMovingTiles())
   {
-    SizeValueType padSize = std::max(static_cast<SizeValueType>(0), fixedMinusMeanSize[ii] - 1);
-    if (m_SizeGreatestPrimeFactor > 1)
+    correlation = this->CorrelateWithMovingTile(fixedMinusMean);
+  }
+  if (correlation == nullptr)
+  {
+    // The moving search region for this thread.
+    m_MovingPadFilter->SetInput(movingMinusMean);
+    m_KernelPadFilter->SetInput(fixedMinusMean);
+
+    const MetricImageRegionType &                     fixedMinusMeanRegion = fixedMinusMean->GetLargestPossibleRegion();
+    const typename MetricImageRegionType::SizeType &  fixedMinusMeanSize = fixedMinusMeanRegion.GetSize();
+    const typename MetricImageRegionType::IndexType & fixedMinusMeanIndex = fixedMinusMeanRegion.GetIndex();
+    const MetricImageRegionType &                     movingMinusMeanRegion =
+      movingMinusMean->GetLargestPossibleRegion();
+    const typename MetricImageRegionType::SizeType &  movingMinusMeanSize = movingMinusMeanRegion.GetSize();
+    const typename MetricImageRegionType::IndexType & movingMinusMeanIndex = movingMinusMeanRegion.GetIndex();
+    typename MetricImageRegionType::IndexType         paddedIndex;
+    typename MetricImageRegionType::SizeType          paddedSize;
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
     {
-      while (Math::GreatestPrimeFactor(movingMinusMeanSize[ii] + padSize) > m_SizeGreatestPrimeFactor)
+      SizeValueType padSize = std::max(static_cast<SizeValueType>(0), fixedMinusMeanSize[ii] - 1);
+      if (m_SizeGreatestPrimeFactor > 1)
       {
-        ++padSize;
+        while (Math::GreatestPrimeFactor(movingMinusMeanSize[ii] + padSize) > m_SizeGreatestPrimeFactor)
+        {
+          ++padSize;
+        }
       }
+      else if (m_SizeGreatestPrimeFactor == 1)
+      {
+        // make sure the total size is even
+        padSize += (movingMinusMeanSize[ii] + padSize) % 2;
+      }
+      paddedIndex[ii] = movingMinusMeanIndex.GetIndex()[ii] - padSize / 2;
+      paddedSize[ii] = movingMinusMeanSize[ii] + padSize;
     }
-    else if (m_SizeGreatestPrimeFactor == 1)
+
+    typename MetricImageRegionType::SizeType padding;
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
     {
-      // make sure the total size is even
-      padSize += (movingMinusMeanSize[ii] + padSize) % 2;
+      padding[ii] = movingMinusMeanIndex[ii] - paddedIndex[ii];
     }
-    paddedIndex[ii] = movingMinusMeanIndex.GetIndex()[ii] - padSize / 2;
-    paddedSize[ii] = movingMinusMeanSize[ii] + padSize;
-  }
+    m_MovingPadFilter->SetPadLowerBound(padding);
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      padding[ii] = paddedSize[ii] - (movingMinusMeanIndex[ii] - paddedIndex[ii] + movingMinusMeanSize[ii]);
+    }
+    m_MovingPadFilter->SetPadUpperBound(padding);
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      padding[ii] = fixedMinusMeanIndex[ii] - paddedIndex[ii];
+    }
+    m_KernelPadFilter->SetPadLowerBound(padding);
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      padding[ii] = paddedSize[ii] - (fixedMinusMeanIndex[ii] - paddedIndex[ii] + fixedMinusMeanSize[ii]);
+    }
+    m_KernelPadFilter->SetPadUpperBound(padding);
 
-  typename MetricImageRegionType::SizeType padding;
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-  {
-    padding[ii] = movingMinusMeanIndex[ii] - paddedIndex[ii];
-  }
-  m_MovingPadFilter->SetPadLowerBound(padding);
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-  {
-    padding[ii] = paddedSize[ii] - (movingMinusMeanIndex[ii] - paddedIndex[ii] + movingMinusMeanSize[ii]);
-  }
-  m_MovingPadFilter->SetPadUpperBound(padding);
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-  {
-    padding[ii] = fixedMinusMeanIndex[ii] - paddedIndex[ii];
-  }
-  m_KernelPadFilter->SetPadLowerBound(padding);
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-  {
-    padding[ii] = paddedSize[ii] - (fixedMinusMeanIndex[ii] - paddedIndex[ii] + fixedMinusMeanSize[ii]);
-  }
-  m_KernelPadFilter->SetPadUpperBound(padding);
+    m_MovingPadFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_KernelPadFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_FFTShiftFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_KernelFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_MovingFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_ComplexConjugateImageFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_MultiplyFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    // In place, the product takes over the buffer of the conjugate kernel
+    // spectrum, which is then allocated again for the next block.
+    m_MultiplyFilter->SetInPlace(!m_ReuseAllocations);
+    m_IFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
 
-  m_MovingPadFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_KernelPadFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_FFTShiftFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_KernelFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_MovingFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_ComplexConjugateImageFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_MultiplyFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-  m_IFFTFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_CropFilter->SetReferenceImage(denom);
+    m_CropFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
 
-  m_CropFilter->SetReferenceImage(denom);
-  m_CropFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    m_CropFilter->UpdateLargestPossibleRegion();
 
-  m_CropFilter->UpdateLargestPossibleRegion();
+    correlation = m_CropFilter->GetOutput();
+  }
 
   using ConstIteratorType = ImageRegionConstIterator<MetricImageType>;
   using IteratorType = ImageRegionIterator<MetricImageType>;
 
   ConstIteratorType denomIt(denom, this->m_MovingImageRegion);
 
-  ConstIteratorType corrIt(m_CropFilter->GetOutput(), this->m_MovingImageRegion);
+  ConstIteratorType corrIt(correlation, this->m_MovingImageRegion);
   IteratorType      metricIt(metricPtr, metricPtr->GetLargestPossibleRegion());
 
   const MetricImagePixelType negativeOne = -1 * NumericTraits<MetricImagePixelType>::One;
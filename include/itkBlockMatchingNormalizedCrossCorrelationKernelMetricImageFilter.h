@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter_h
+#define itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter_h
+
+#include "itkBlockMatchingMetricImageFilter.h"
+#include "itkBlockMatchingNormalizedCrossCorrelationMetricKernel.h"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class NormalizedCrossCorrelationKernelMetricImageFilter
+ *
+ * \brief Create an image of the normalized cross correlation with a kernel
+ * calculated directly on the input buffers.
+ *
+ * This wraps a NormalizedCrossCorrelationMetricKernel.  The metric is the
+ * normalized cross correlation coefficient of the fixed block with the moving
+ * window centered on every pixel of the moving image region, with the mean of
+ * that window.  It is zero where the window is not inside the moving image.
+ *
+ * It has a single output, and it implements ComputeMetricImage(), so that
+ * BlockMatching::ImageRegistrationMethod matches the blocks without executing
+ * the pipeline.  The fixed and moving images must have the same spacing.
+ *
+ * \sa NormalizedCrossCorrelationMetricKernel
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+class ITK_TEMPLATE_EXPORT NormalizedCrossCorrelationKernelMetricImageFilter
+  : public MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NormalizedCrossCorrelationKernelMetricImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NormalizedCrossCorrelationKernelMetricImageFilter;
+  using Superclass = MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NormalizedCrossCorrelationKernelMetricImageFilter, MetricImageFilter);
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TFixedImage::ImageDimension);
+
+  /** Type of the fixed image. */
+  using FixedImageType = typename Superclass::FixedImageType;
+  using FixedImageRegionType = typename Superclass::FixedImageRegionType;
+
+  /** Type of the moving image. */
+  using MovingImageType = typename Superclass::MovingImageType;
+  using MovingImageRegionType = typename Superclass::MovingImageRegionType;
+
+  /** Type of the metric image. */
+  using MetricImageType = typename Superclass::MetricImageType;
+  using MetricImageRegionType = typename Superclass::MetricImageRegionType;
+  using MetricImagePixelType = typename MetricImageType::PixelType;
+
+  /** Type of the kernel. */
+  using KernelType = NormalizedCrossCorrelationMetricKernel<typename FixedImageType::PixelType,
+                                                            typename MovingImageType::PixelType,
+                                                            MetricImagePixelType,
+                                                            ImageDimension>;
+
+  bool
+  ComputeMetricImage(const FixedImageRegionType &  fixedRegion,
+                     const MovingImageRegionType & movingRegion,
+                     MetricImageType *             metricImage) override;
+
+protected:
+  NormalizedCrossCorrelationKernelMetricImageFilter() {}
+
+  void
+  GenerateData() override;
+
+private:
+  typename KernelType::Scratch m_Scratch;
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter.hxx"
+#endif
+
+#endif
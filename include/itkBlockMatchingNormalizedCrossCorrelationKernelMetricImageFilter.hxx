@@ -0,0 +1,100 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter_hxx
+#define itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter_hxx
+
+#include "itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter.h"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+bool
+NormalizedCrossCorrelationKernelMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::ComputeMetricImage(
+  const FixedImageRegionType &  fixedRegion,
+  const MovingImageRegionType & movingRegion,
+  MetricImageType *             metricImage)
+{
+  const FixedImageType *  fixedPtr = this->GetInput(0);
+  const MovingImageType * movingPtr = this->GetInput(1);
+  if (!fixedPtr || !movingPtr || !metricImage)
+  {
+    return false;
+  }
+  if (!(fixedPtr->GetSpacing() == movingPtr->GetSpacing()) || !fixedPtr->GetBufferedRegion().IsInside(fixedRegion))
+  {
+    return false;
+  }
+  typename MovingImageRegionType::SizeType radius;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    if (fixedRegion.GetSize()[i] % 2 == 0)
+    {
+      return false;
+    }
+    radius[i] = (fixedRegion.GetSize()[i] - 1) / 2;
+  }
+
+  MovingImageRegionType validRegion;
+  const bool            isValid = this->AllocateMetricImage(movingRegion, radius, metricImage, validRegion);
+  if (!isValid || validRegion != movingRegion)
+  {
+    metricImage->FillBuffer(NumericTraits<MetricImagePixelType>::ZeroValue());
+  }
+  if (!isValid)
+  {
+    return true;
+  }
+
+  MovingImageRegionType windowsRegion = validRegion;
+  windowsRegion.PadByRadius(radius);
+  MetricImageRegionType                     validMetricRegion;
+  typename MetricImageRegionType::IndexType metricIndex;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    metricIndex[i] = validRegion.GetIndex()[i] - movingRegion.GetIndex()[i];
+  }
+  validMetricRegion.SetIndex(metricIndex);
+  validMetricRegion.SetSize(validRegion.GetSize());
+
+  KernelType::ComputeMetric(KernelType::MakeBufferView(fixedPtr, fixedRegion),
+                            KernelType::MakeBufferView(movingPtr, windowsRegion),
+                            KernelType::MakeBufferView(metricImage, validMetricRegion),
+                            m_Scratch);
+  return true;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+void
+NormalizedCrossCorrelationKernelMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  if (!this->ComputeMetricImage(this->m_FixedImageRegion, this->m_MovingImageRegion, this->GetOutput()))
+  {
+    itkExceptionMacro(<< "This metric image filter assumes the moving and fixed image have the same spacing.");
+  }
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
@@ -18,7 +18,6 @@
 #ifndef itkBlockMatchingNormalizedCrossCorrelationMetricImageFilter_h
 #define itkBlockMatchingNormalizedCrossCorrelationMetricImageFilter_h
 
-#include "itkBoxMeanImageFilter.h"
 #include "itkBoxSigmaSqrtNMinusOneImageFilter.h"
 
 #include "itkBlockMatchingMetricImageFilter.h"
@@ -39,6 +38,13 @@ namespace BlockMatching
  * This is an abstract base class that does the mean and standard deviation
  * calculation.  The cross correlation is left to inherited classes.
  *
+ * The box means and standard deviations of the moving image are taken from a
+ * summed-area table of the sums and the sums of squares of its buffered
+ * region.  The table is computed once for each moving image, and it is shared
+ * by all the blocks matched in that image, as long as the buffered region
+ * contains the boxes of the block.  Otherwise, they are computed for the
+ * block only.
+ *
  * \sa MetricImageFilter
  *
  * \ingroup Ultrasound
@@ -102,12 +108,29 @@ protected:
   virtual void
   GenerateHelperImages();
 
-  using BoxMeanFilterType = BoxMeanImageFilter<MovingImageType, MetricImageType>;
+  /** Compute the box means and pseudo standard deviations of the moving
+   * image over region, which must be allocated in both images, from the
+   * summed-area table of its buffered region.  The boxes are cropped by the
+   * buffered region.  The table is computed when the moving image or its
+   * buffered region changes. */
+  void
+  ComputeMovingBoxStatistics(const MovingImageRegionType & region,
+                             MetricImageType *             pseudoSigma,
+                             MetricImageType *             mean);
+
   using BoxPseudoSigmaFilterType = BoxSigmaSqrtNMinusOneImageFilter<MovingImageType, MetricImageType>;
 
-  typename BoxMeanFilterType::Pointer        m_BoxMeanFilter;
   typename BoxPseudoSigmaFilterType::Pointer m_BoxPseudoSigmaFilter;
 
+  /** Summed-area table of the moving image less a shift, and of its square. */
+  using SummedAreaValueType = typename NumericTraits<typename MovingImageType::PixelType>::RealType;
+  using SummedAreaImageType = Image<Vector<SummedAreaValueType, 2>, ImageDimension>;
+
+  typename SummedAreaImageType::Pointer m_MovingSummedAreaTable;
+  const MovingImageType *               m_MovingSummedAreaTableImage;
+  ModifiedTimeType                      m_MovingSummedAreaTableTime;
+  SummedAreaValueType                   m_MovingSummedAreaTableShift;
+
 private:
   using BoundaryConditionType = ConstantBoundaryCondition<MetricImageType>;
   BoundaryConditionType m_BoundaryCondition;
@@ -50,9 +50,13 @@ NormalizedCrossCorrelationMetricImageFilter<TFixedImage, TMovingImage, TMetricIm
   for (unsigned int i = 1; i < 7; i++)
     this->SetNthOutput(i, this->MakeOutput(i));
 
-  m_BoxMeanFilter = BoxMeanFilterType::New();
   m_BoxPseudoSigmaFilter = BoxPseudoSigmaFilterType::New();
 
+  m_MovingSummedAreaTable = SummedAreaImageType::New();
+  m_MovingSummedAreaTableImage = nullptr;
+  m_MovingSummedAreaTableTime = 0;
+  m_MovingSummedAreaTableShift = NumericTraits<SummedAreaValueType>::ZeroValue();
+
   m_BoundaryCondition.SetConstant(NumericTraits<MetricImagePixelType>::Zero);
 }
 
@@ -190,20 +194,38 @@ NormalizedCrossCorrelationMetricImageFilter<TFixedImage, TMovingImage, TMetricIm
       movingMean += static_cast<MetricImagePixelType>(movingIt.Get());
     }
     movingMean /= static_cast<MetricImagePixelType>(movingRequestedRegion.GetNumberOfPixels());
-    MetricImagePointerType movingMeanImg = m_BoxMeanFilter->GetOutput();
+    MetricImagePointerType movingMeanImg = m_BoxPseudoSigmaFilter->GetMeanOutput();
     movingMeanImg->SetBufferedRegion(movingRequestedRegion);
     movingMeanImg->Allocate();
     movingMeanImg->FillBuffer(movingMean);
   }
   else
   {
-    // Calculate the means.
-    m_BoxMeanFilter->SetRadius(this->m_MovingRadius);
-
-    m_BoxMeanFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-    m_BoxMeanFilter->SetInput(movingPtr);
-    m_BoxMeanFilter->GetOutput()->SetRequestedRegion(movingRequestedRegion);
-    m_BoxMeanFilter->Update();
+    // Calculate the means and the pseudo sigmas in the moving image from the
+    // same summed-area table.  The boxes are cropped by the
+    // LargestPossibleRegion, so the table of the buffered region gives the
+    // same statistics when it contains them.
+    MovingImageRegionType boxesRegion = movingRequestedRegion;
+    boxesRegion.PadByRadius(this->m_MovingRadius);
+    boxesRegion.Crop(movingPtr->GetLargestPossibleRegion());
+    if (movingPtr->GetBufferedRegion().IsInside(boxesRegion))
+    {
+      MetricImagePointerType movingPseudoSigma = m_BoxPseudoSigmaFilter->GetOutput();
+      movingPseudoSigma->SetBufferedRegion(movingRequestedRegion);
+      movingPseudoSigma->Allocate();
+      MetricImagePointerType movingMeanImg = m_BoxPseudoSigmaFilter->GetMeanOutput();
+      movingMeanImg->SetBufferedRegion(movingRequestedRegion);
+      movingMeanImg->Allocate();
+      this->ComputeMovingBoxStatistics(movingRequestedRegion, movingPseudoSigma, movingMeanImg);
+    }
+    else
+    {
+      m_BoxPseudoSigmaFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+      m_BoxPseudoSigmaFilter->SetRadius(this->m_MovingRadius);
+      m_BoxPseudoSigmaFilter->SetInput(movingPtr);
+      m_BoxPseudoSigmaFilter->GetOutput()->SetRequestedRegion(movingRequestedRegion);
+      m_BoxPseudoSigmaFilter->Update();
+    }
   }
 
   MetricImagePixelType fixedMean = NumericTraits<MetricImagePixelType>::Zero;
@@ -283,7 +305,7 @@ NormalizedCrossCorrelationMetricImageFilter<TFixedImage, TMovingImage, TMetricIm
   // Calculate the moving search region less the moving kernel means.
   MetricImagePointerType                    movingMinusMean = this->GetOutput(3);
   ImageRegionIterator<MetricImageType>      movingMinusMeanIt(movingMinusMean, movingRequestedRegion);
-  ImageRegionConstIterator<MetricImageType> meanIt(m_BoxMeanFilter->GetOutput(), movingRequestedRegion);
+  ImageRegionConstIterator<MetricImageType> meanIt(m_BoxPseudoSigmaFilter->GetMeanOutput(), movingRequestedRegion);
   ImageRegionConstIterator<MovingImageType> movingIt(movingPtr, movingRequestedRegion);
   for (movingMinusMeanIt.GoToBegin(), meanIt.GoToBegin(), movingIt.GoToBegin(); !movingMinusMeanIt.IsAtEnd();
        ++movingMinusMeanIt, ++meanIt, ++movingIt)
@@ -306,15 +328,6 @@ NormalizedCrossCorrelationMetricImageFilter<TFixedImage, TMovingImage, TMetricIm
     movingPseudoSigma->Allocate();
     movingPseudoSigma->FillBuffer(movingPseudoSigmaVal);
   }
-  else
-  {
-    // Calculate the pseudo sigma in the moving image.
-    m_BoxPseudoSigmaFilter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
-    m_BoxPseudoSigmaFilter->SetRadius(this->m_MovingRadius);
-    m_BoxPseudoSigmaFilter->SetInput(movingPtr);
-    m_BoxPseudoSigmaFilter->GetOutput()->SetRequestedRegion(this->m_MovingImageRegion);
-    m_BoxPseudoSigmaFilter->Update();
-  }
 
   MetricImagePointerType                    denom = this->GetOutput(1);
   ImageRegionConstIterator<MetricImageType> fixedPseudoSigmaConstIt(fixedPseudoSigmaImage, this->m_MovingImageRegion);
@@ -330,6 +343,40 @@ NormalizedCrossCorrelationMetricImageFilter<TFixedImage, TMovingImage, TMetricIm
 }
 
 
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+void
+NormalizedCrossCorrelationMetricImageFilter<TFixedImage, TMovingImage, TMetricImage>::ComputeMovingBoxStatistics(
+  const MovingImageRegionType & region,
+  MetricImageType *             pseudoSigma,
+  MetricImageType *             mean)
+{
+  MovingImageConstPointerType   movingPtr = this->GetInput(1);
+  const MovingImageRegionType & bufferedRegion = movingPtr->GetBufferedRegion();
+  if (movingPtr.GetPointer() != m_MovingSummedAreaTableImage ||
+      movingPtr->GetMTime() != m_MovingSummedAreaTableTime ||
+      m_MovingSummedAreaTable->GetBufferedRegion() != bufferedRegion)
+  {
+    // The sums are taken about the first sample, as in the
+    // BoxSigmaSqrtNMinusOneImageFilter.
+    m_MovingSummedAreaTableShift = static_cast<SummedAreaValueType>(movingPtr->GetPixel(bufferedRegion.GetIndex()));
+    m_MovingSummedAreaTable->SetRegions(bufferedRegion);
+    m_MovingSummedAreaTable->Allocate();
+    BoxSquareCompensatedAccumulateFunction<MovingImageType, SummedAreaImageType>(
+      movingPtr, m_MovingSummedAreaTable.GetPointer(), bufferedRegion, m_MovingSummedAreaTableShift);
+    m_MovingSummedAreaTableImage = movingPtr.GetPointer();
+    m_MovingSummedAreaTableTime = movingPtr->GetMTime();
+  }
+
+  BoxSigmaSqrtNMinusOneCalculatorFunction<SummedAreaImageType, MetricImageType>(m_MovingSummedAreaTable.GetPointer(),
+                                                                                pseudoSigma,
+                                                                                bufferedRegion,
+                                                                                region,
+                                                                                this->m_MovingRadius,
+                                                                                mean,
+                                                                                m_MovingSummedAreaTableShift);
+}
+
+
 } // end namespace BlockMatching
 } // end namespace itk
 
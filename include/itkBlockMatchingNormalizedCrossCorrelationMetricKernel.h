@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingNormalizedCrossCorrelationMetricKernel_h
+#define itkBlockMatchingNormalizedCrossCorrelationMetricKernel_h
+
+#include "itkIntTypes.h"
+#include "itkNumericTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class NormalizedCrossCorrelationMetricKernel
+ *
+ * \brief Compute a normalized cross correlation metric image directly on pixel
+ * buffers.
+ *
+ * This is the arithmetic of a normalized cross correlation metric image
+ * without the pipeline: there are no outputs or requested regions, and the
+ * only memory is the Scratch supplied by the caller, which is reused from one
+ * block to the next.  The buffers are given as views, the first pixel with
+ * the size and the stride in pixels along every direction, so that a region
+ * of an image is a view of its buffer, see MakeBufferView().
+ *
+ * The metric at a position of the metric view is the normalized cross
+ * correlation coefficient of the fixed block with the window of the moving
+ * view of the same size that starts at that position.  The moving view is
+ * therefore larger than the metric view by the size of the fixed block less
+ * one.  The metric is zero where a window has no variation.
+ *
+ * The windows are walked one row along the first direction at a time, which
+ * is contiguous in the moving buffer.  The sums of a row go to one partial
+ * sum per column, which are independent, so that the compiler vectorizes the
+ * loop over the row with the instructions of the target.  The loop is
+ * instantiated for the common odd block widths, where it is unrolled
+ * completely.
+ *
+ * ComputeMetric() is reentrant: concurrent calls only need their own Scratch
+ * and metric views.
+ *
+ * \sa NormalizedCrossCorrelationKernelMetricImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TFixedPixel, typename TMovingPixel, typename TMetricPixel, unsigned int VDimension>
+class ITK_TEMPLATE_EXPORT NormalizedCrossCorrelationMetricKernel
+{
+public:
+  static constexpr unsigned int Dimension = VDimension;
+
+  using FixedPixelType = TFixedPixel;
+  using MovingPixelType = TMovingPixel;
+  using MetricPixelType = TMetricPixel;
+  using RealType = typename NumericTraits<MetricPixelType>::RealType;
+
+  /** A view of a pixel buffer: a pointer to the first pixel, with the size and
+   * the stride, in pixels, along every direction. */
+  template <typename TPixel>
+  struct BufferView
+  {
+    TPixel *        Buffer;
+    SizeValueType   Size[VDimension];
+    OffsetValueType Strides[VDimension];
+  };
+  using FixedBufferViewType = BufferView<const FixedPixelType>;
+  using MovingBufferViewType = BufferView<const MovingPixelType>;
+  using MetricBufferViewType = BufferView<MetricPixelType>;
+
+  /** Working memory of ComputeMetric(), kept by the caller. */
+  struct Scratch
+  {
+    std::vector<RealType>        FixedMinusMean;
+    std::vector<OffsetValueType> WindowOffsets;
+    std::vector<OffsetValueType> RowOffsets;
+  };
+
+  /** View of a region of the buffer of an image.  The region must be inside
+   * the buffered region. */
+  template <typename TImage>
+  static BufferView<typename TImage::PixelType>
+  MakeBufferView(TImage * image, const typename TImage::RegionType & region);
+  template <typename TImage>
+  static BufferView<const typename TImage::PixelType>
+  MakeBufferView(const TImage * image, const typename TImage::RegionType & region);
+
+  /** Compute the metric of the fixed block over the moving view into the
+   * metric view.  The size of the moving view must be the size of the metric
+   * view plus the size of the fixed block less one. */
+  static void
+  ComputeMetric(const FixedBufferViewType &  fixed,
+                const MovingBufferViewType & moving,
+                const MetricBufferViewType & metric,
+                Scratch &                    scratch);
+
+protected:
+  /** The sums over a window of the moving values, their squares, and their
+   * products with the fixed block less its mean. */
+  struct WindowSums
+  {
+    RealType Sum;
+    RealType SumOfSquares;
+    RealType CrossSum;
+  };
+
+  /** Accumulate the sums over the rows of a window.  The rows are contiguous,
+   * rowLength long, and start at the rowOffsets from window.  With a
+   * VRowLength, it must be the rowLength.  Otherwise, the rows are processed
+   * in chunks of a fixed number of columns. */
+  template <unsigned int VRowLength>
+  static WindowSums
+  AccumulateWindow(const RealType *        fixedMinusMean,
+                   const MovingPixelType * window,
+                   const OffsetValueType * rowOffsets,
+                   SizeValueType           numberOfRows,
+                   SizeValueType           rowLength);
+
+  using AccumulateWindowFunctionType = WindowSums (*)(const RealType *,
+                                                      const MovingPixelType *,
+                                                      const OffsetValueType *,
+                                                      SizeValueType,
+                                                      SizeValueType);
+
+  /** The instantiation of AccumulateWindow() for a row length. */
+  static AccumulateWindowFunctionType
+  SelectAccumulateWindow(SizeValueType rowLength);
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkBlockMatchingNormalizedCrossCorrelationMetricKernel.hxx"
+#endif
+
+#endif
@@ -0,0 +1,288 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingNormalizedCrossCorrelationMetricKernel_hxx
+#define itkBlockMatchingNormalizedCrossCorrelationMetricKernel_hxx
+
+#include "itkBlockMatchingNormalizedCrossCorrelationMetricKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TFixedPixel, typename TMovingPixel, typename TMetricPixel, unsigned int VDimension>
+template <typename TImage>
+auto
+NormalizedCrossCorrelationMetricKernel<TFixedPixel, TMovingPixel, TMetricPixel, VDimension>::MakeBufferView(
+  TImage *                            image,
+  const typename TImage::RegionType & region) -> BufferView<typename TImage::PixelType>
+{
+  BufferView<typename TImage::PixelType> view;
+  view.Buffer = image->GetBufferPointer() + image->ComputeOffset(region.GetIndex());
+  const OffsetValueType * offsetTable = image->GetOffsetTable();
+  for (unsigned int i = 0; i < VDimension; ++i)
+  {
+    view.Size[i] = region.GetSize()[i];
+    view.Strides[i] = offsetTable[i];
+  }
+  return view;
+}
+
+
+template <typename TFixedPixel, typename TMovingPixel, typename TMetricPixel, unsigned int VDimension>
+template <typename TImage>
+auto
+NormalizedCrossCorrelationMetricKernel<TFixedPixel, TMovingPixel, TMetricPixel, VDimension>::MakeBufferView(
+  const TImage *                      image,
+  const typename TImage::RegionType & region) -> BufferView<const typename TImage::PixelType>
+{
+  BufferView<const typename TImage::PixelType> view;
+  view.Buffer = image->GetBufferPointer() + image->ComputeOffset(region.GetIndex());
+  const OffsetValueType * offsetTable = image->GetOffsetTable();
+  for (unsigned int i = 0; i < VDimension; ++i)
+  {
+    view.Size[i] = region.GetSize()[i];
+    view.Strides[i] = offsetTable[i];
+  }
+  return view;
+}
+
+
+template <typename TFixedPixel, typename TMovingPixel, typename TMetricPixel, unsigned int VDimension>
+template <unsigned int VRowLength>
+auto
+NormalizedCrossCorrelationMetricKernel<TFixedPixel, TMovingPixel, TMetricPixel, VDimension>::AccumulateWindow(
+  const RealType *        fixedMinusMean,
+  const MovingPixelType * window,
+  const OffsetValueType * rowOffsets,
+  SizeValueType           numberOfRows,
+  SizeValueType           rowLength) -> WindowSums
+{
+  constexpr unsigned int Columns = VRowLength > 0 ? VRowLength : 8;
+  const SizeValueType    length = VRowLength > 0 ? VRowLength : rowLength;
+  const SizeValueType    chunksLength = length - length % Columns;
+
+  RealType sum[Columns];
+  RealType sumOfSquares[Columns];
+  RealType crossSum[Columns];
+  for (unsigned int column = 0; column < Columns; ++column)
+  {
+    sum[column] = NumericTraits<RealType>::ZeroValue();
+    sumOfSquares[column] = NumericTraits<RealType>::ZeroValue();
+    crossSum[column] = NumericTraits<RealType>::ZeroValue();
+  }
+  for (SizeValueType row = 0; row < numberOfRows; ++row)
+  {
+    const MovingPixelType * movingRow = window + rowOffsets[row];
+    const RealType *        fixedRow = fixedMinusMean + row * length;
+    SizeValueType           jj = 0;
+    for (; jj < chunksLength; jj += Columns)
+    {
+      for (unsigned int column = 0; column < Columns; ++column)
+      {
+        const RealType value = static_cast<RealType>(movingRow[jj + column]);
+        sum[column] += value;
+        sumOfSquares[column] += value * value;
+        crossSum[column] += fixedRow[jj + column] * value;
+      }
+    }
+    for (; jj < length; ++jj)
+    {
+      const RealType value = static_cast<RealType>(movingRow[jj]);
+      sum[0] += value;
+      sumOfSquares[0] += value * value;
+      crossSum[0] += fixedRow[jj] * value;
+    }
+  }
+
+  WindowSums sums;
+  sums.Sum = NumericTraits<RealType>::ZeroValue();
+  sums.SumOfSquares = NumericTraits<RealType>::ZeroValue();
+  sums.CrossSum = NumericTraits<RealType>::ZeroValue();
+  for (unsigned int column = 0; column < Columns; ++column)
+  {
+    sums.Sum += sum[column];
+    sums.SumOfSquares += sumOfSquares[column];
+    sums.CrossSum += crossSum[column];
+  }
+  return sums;
+}
+
+
+template <typename TFixedPixel, typename TMovingPixel, typename TMetricPixel, unsigned int VDimension>
+auto
+NormalizedCrossCorrelationMetricKernel<TFixedPixel, TMovingPixel, TMetricPixel, VDimension>::SelectAccumulateWindow(
+  SizeValueType rowLength) -> AccumulateWindowFunctionType
+{
+  switch (rowLength)
+  {
+    case 3:
+      return &AccumulateWindow<3>;
+    case 5:
+      return &AccumulateWindow<5>;
+    case 7:
+      return &AccumulateWindow<7>;
+    case 9:
+      return &AccumulateWindow<9>;
+    case 11:
+      return &AccumulateWindow<11>;
+    case 13:
+      return &AccumulateWindow<13>;
+    case 15:
+      return &AccumulateWindow<15>;
+    case 17:
+      return &AccumulateWindow<17>;
+    case 19:
+      return &AccumulateWindow<19>;
+    case 21:
+      return &AccumulateWindow<21>;
+    case 25:
+      return &AccumulateWindow<25>;
+    case 31:
+      return &AccumulateWindow<31>;
+    default:
+      return &AccumulateWindow<0>;
+  }
+}
+
+
+template <typename TFixedPixel, typename TMovingPixel, typename TMetricPixel, unsigned int VDimension>
+void
+NormalizedCrossCorrelationMetricKernel<TFixedPixel, TMovingPixel, TMetricPixel, VDimension>::ComputeMetric(
+  const FixedBufferViewType &  fixed,
+  const MovingBufferViewType & moving,
+  const MetricBufferViewType & metric,
+  Scratch &                    scratch)
+{
+  SizeValueType windowSize = 1;
+  SizeValueType numberOfPositions = 1;
+  for (unsigned int i = 0; i < VDimension; ++i)
+  {
+    windowSize *= fixed.Size[i];
+    numberOfPositions *= metric.Size[i];
+  }
+  if (windowSize == 0 || numberOfPositions == 0)
+  {
+    return;
+  }
+
+  // The fixed block less its mean, and the offsets of the pixels of a window
+  // in the moving buffer, in the same order.
+  scratch.FixedMinusMean.resize(windowSize);
+  scratch.WindowOffsets.resize(windowSize);
+  RealType *        fixedMinusMean = scratch.FixedMinusMean.data();
+  OffsetValueType * windowOffsets = scratch.WindowOffsets.data();
+  RealType          fixedMean = NumericTraits<RealType>::ZeroValue();
+  for (SizeValueType k = 0; k < windowSize; ++k)
+  {
+    SizeValueType   remainder = k;
+    OffsetValueType fixedOffset = 0;
+    OffsetValueType movingOffset = 0;
+    for (unsigned int i = 0; i < VDimension; ++i)
+    {
+      const OffsetValueType coordinate = static_cast<OffsetValueType>(remainder % fixed.Size[i]);
+      remainder /= fixed.Size[i];
+      fixedOffset += coordinate * fixed.Strides[i];
+      movingOffset += coordinate * moving.Strides[i];
+    }
+    fixedMinusMean[k] = static_cast<RealType>(fixed.Buffer[fixedOffset]);
+    fixedMean += fixedMinusMean[k];
+    windowOffsets[k] = movingOffset;
+  }
+  fixedMean /= static_cast<RealType>(windowSize);
+  RealType fixedPseudoSigma = NumericTraits<RealType>::ZeroValue();
+  for (SizeValueType k = 0; k < windowSize; ++k)
+  {
+    fixedMinusMean[k] -= fixedMean;
+    fixedPseudoSigma += fixedMinusMean[k] * fixedMinusMean[k];
+  }
+  fixedPseudoSigma = std::sqrt(fixedPseudoSigma);
+
+  // The rows of a window along the first direction, which are contiguous in
+  // image buffers.
+  const bool          contiguousRows = moving.Strides[0] == 1;
+  const SizeValueType rowLength = fixed.Size[0];
+  const SizeValueType numberOfRows = windowSize / rowLength;
+  scratch.RowOffsets.resize(numberOfRows);
+  for (SizeValueType row = 0; row < numberOfRows; ++row)
+  {
+    scratch.RowOffsets[row] = windowOffsets[row * rowLength];
+  }
+  const AccumulateWindowFunctionType accumulateWindow = SelectAccumulateWindow(rowLength);
+
+  // Since the fixed block less its mean sums to zero, the numerator does not
+  // need the window mean, and one pass over the window gives both the
+  // numerator and the moving pseudo sigma.
+  const RealType        windowSizeReal = static_cast<RealType>(windowSize);
+  const MetricPixelType negativeOne = -1 * NumericTraits<MetricPixelType>::One;
+  const MetricPixelType positiveOne = NumericTraits<MetricPixelType>::One;
+  for (SizeValueType position = 0; position < numberOfPositions; ++position)
+  {
+    SizeValueType   remainder = position;
+    OffsetValueType movingOffset = 0;
+    OffsetValueType metricOffset = 0;
+    for (unsigned int i = 0; i < VDimension; ++i)
+    {
+      const OffsetValueType coordinate = static_cast<OffsetValueType>(remainder % metric.Size[i]);
+      remainder /= metric.Size[i];
+      movingOffset += coordinate * moving.Strides[i];
+      metricOffset += coordinate * metric.Strides[i];
+    }
+
+    const MovingPixelType * window = moving.Buffer + movingOffset;
+    RealType                sum = NumericTraits<RealType>::ZeroValue();
+    RealType                sumOfSquares = NumericTraits<RealType>::ZeroValue();
+    RealType                crossSum = NumericTraits<RealType>::ZeroValue();
+    if (contiguousRows)
+    {
+      const WindowSums sums =
+        accumulateWindow(fixedMinusMean, window, scratch.RowOffsets.data(), numberOfRows, rowLength);
+      sum = sums.Sum;
+      sumOfSquares = sums.SumOfSquares;
+      crossSum = sums.CrossSum;
+    }
+    else
+    {
+      for (SizeValueType k = 0; k < windowSize; ++k)
+      {
+        const RealType value = static_cast<RealType>(window[windowOffsets[k]]);
+        sum += value;
+        sumOfSquares += value * value;
+        crossSum += fixedMinusMean[k] * value;
+      }
+    }
+    const RealType movingPseudoSigmaSquared = sumOfSquares - sum * sum / windowSizeReal;
+    if (!(movingPseudoSigmaSquared > NumericTraits<RealType>::epsilon() * sumOfSquares) ||
+        fixedPseudoSigma == NumericTraits<RealType>::ZeroValue())
+    {
+      metric.Buffer[metricOffset] = NumericTraits<MetricPixelType>::ZeroValue();
+      continue;
+    }
+    const MetricPixelType normXcorr =
+      static_cast<MetricPixelType>(crossSum / (fixedPseudoSigma * std::sqrt(movingPseudoSigmaSquared)));
+    metric.Buffer[metricOffset] = std::min(std::max(normXcorr, negativeOne), positiveOne);
+  }
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
@@ -28,6 +28,8 @@
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkNeighborhoodInnerProduct.h"
 
+#include <vector>
+
 namespace itk
 {
 namespace BlockMatching
@@ -111,6 +113,25 @@ NormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter<TFixedImage, TMo
   fixedKernelOperator.CreateToRadius(radius);
   NeighborhoodInnerProduct<MetricImageType> innerProduct;
 
+  // In the non-boundary face, the inner product is computed directly on the
+  // buffer, without the boundary condition, with the offsets of the
+  // neighborhood in the moving minus mean buffer.
+  using RealType = typename NumericTraits<MetricImagePixelType>::RealType;
+  const SizeValueType          kernelSize = fixedKernelOperator.Size();
+  std::vector<RealType>        kernel(kernelSize);
+  std::vector<OffsetValueType> kernelOffsets(kernelSize);
+  const OffsetValueType *      offsetTable = movingMinusMean->GetOffsetTable();
+  for (SizeValueType k = 0; k < kernelSize; ++k)
+  {
+    kernel[k] = static_cast<RealType>(fixedKernelOperator[k]);
+    const typename MovingImageType::OffsetType offset = fixedKernelOperator.GetOffset(k);
+    kernelOffsets[k] = 0;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      kernelOffsets[k] += offset[i] * offsetTable[i];
+    }
+  }
+
   using FaceCalculatorType = typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<MovingImageType>;
   FaceCalculatorType                        faceCalculator;
   typename FaceCalculatorType::FaceListType faceList = faceCalculator(movingPtr, this->m_MovingImageRegion, radius);
@@ -134,7 +155,38 @@ NormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter<TFixedImage, TMo
 
     MetricIteratorType metricIt(metricPtr, metricRegion);
 
-    MetricConstIteratorType  denomIt(denom, *fit);
+    MetricConstIteratorType denomIt(denom, *fit);
+
+    // The faces are relative to the moving image buffer, so check that the
+    // neighborhoods are also in the moving minus mean buffer.
+    MetricImageRegionType paddedRegion = *fit;
+    paddedRegion.PadByRadius(radius);
+    if (fit == faceList.begin() && movingMinusMean->GetBufferedRegion().IsInside(paddedRegion))
+    {
+      MetricConstIteratorType centerIt(movingMinusMean, *fit);
+      for (metricIt.GoToBegin(), denomIt.GoToBegin(), centerIt.GoToBegin(); !metricIt.IsAtEnd();
+           ++metricIt, ++denomIt, ++centerIt)
+      {
+        if (!(denomIt.Get() == NumericTraits<MetricImagePixelType>::Zero))
+        {
+          const MetricImagePixelType * center = &(centerIt.Value());
+          RealType                     sum = NumericTraits<RealType>::ZeroValue();
+          for (SizeValueType k = 0; k < kernelSize; ++k)
+          {
+            sum += kernel[k] * static_cast<RealType>(center[kernelOffsets[k]]);
+          }
+          normXcorr = static_cast<MetricImagePixelType>(sum / denomIt.Get());
+          if (normXcorr < negativeOne)
+            metricIt.Set(negativeOne);
+          else if (normXcorr > positiveOne)
+            metricIt.Set(positiveOne);
+          else
+            metricIt.Set(normXcorr);
+        }
+      }
+      continue;
+    }
+
     NeighborhoodIteratorType movingNeighborIt(radius, movingMinusMean, *fit);
     movingNeighborIt.OverrideBoundaryCondition(&boundaryCondition);
 
@@ -0,0 +1,165 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkBlockMatchingOpenCLImageRegistrationMethod_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkBlockMatchingOpenCLImageRegistrationMethod_h
+
+#  include <string>
+#  include <type_traits>
+
+#  include "itkBlockMatchingImageRegistrationMethod.h"
+#  include "itkBlockMatchingParabolicInterpolationDisplacementCalculator.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class OpenCLImageRegistrationMethod
+ *
+ * \brief Block matching by normalized cross correlation on an OpenCL device.
+ *
+ * The fixed and moving images are uploaded once per update, i.e. once per
+ * level of a MultiResolutionImageRegistrationMethod, and one kernel computes
+ * the metric images of all the blocks.  A work group matches a block: the
+ * fixed block less its mean goes in local memory, and the box sums and sums
+ * of squares of the moving windows come from summed-area tables of the moving
+ * image, so only the cross sums are accumulated per position.  The metric is
+ * the one of NormalizedCrossCorrelationKernelMetricImageFilter, up to the
+ * rounding of the sums: it is zero at the positions whose window is not inside
+ * the moving image.
+ *
+ * When the MetricImageToDisplacementCalculator is a
+ * ParabolicInterpolationDisplacementCalculator, the peaks are also
+ * interpolated on the device, and only the displacements are read back.
+ * Otherwise, the metric images are read back and passed to the calculator.
+ *
+ * The blocks are matched on the device when the MetricImageFilter is a
+ * normalized cross correlation filter, the fixed and moving images have the
+ * same spacing, the blocks fit in local memory and have the same radius,
+ * there is no Mask, and UseStreaming is off with one slab.  Otherwise, the superclass matches them,
+ * see GetMatchedOnDevice().  The blocks that are not inside the fixed image
+ * are matched by the MetricImageFilter.  The images have at most three
+ * dimensions, and the metric pixels are float or double.
+ *
+ * \sa ImageRegistrationMethod
+ * \sa NormalizedCrossCorrelationKernelMetricImageFilter
+ *
+ * \ingroup RegistrationFilters
+ * \ingroup Ultrasound
+ */
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+class ITK_TEMPLATE_EXPORT OpenCLImageRegistrationMethod
+  : public ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(OpenCLImageRegistrationMethod);
+
+  /** Standard class type alias. */
+  using Self = OpenCLImageRegistrationMethod;
+  using Superclass = ImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  static constexpr unsigned int ImageDimension = Superclass::ImageDimension;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(OpenCLImageRegistrationMethod, ImageRegistrationMethod);
+
+  using FixedImageType = typename Superclass::FixedImageType;
+  using FixedRegionType = typename Superclass::FixedRegionType;
+  using MovingImageType = typename Superclass::MovingImageType;
+  using MovingRegionType = typename Superclass::MovingRegionType;
+  using MetricImageType = typename Superclass::MetricImageType;
+  using MetricPixelType = typename MetricImageType::PixelType;
+  using ImageType = typename Superclass::ImageType;
+  using RegionType = typename Superclass::RegionType;
+  using IndexType = typename Superclass::IndexType;
+  using SearchRegionImageType = typename Superclass::SearchRegionImageType;
+  using CoordRepType = typename Superclass::CoordRepType;
+
+  using ParabolicInterpolationDisplacementCalculatorType =
+    ParabolicInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>;
+
+  static_assert(std::is_same<MetricPixelType, float>::value || std::is_same<MetricPixelType, double>::value,
+                "OpenCLImageRegistrationMethod computes float or double metric images");
+  static_assert(ImageDimension <= 3, "OpenCLImageRegistrationMethod matches blocks in at most three dimensions");
+
+  /** Get whether the blocks of the last update were matched on the device. */
+  itkGetConstMacro(MatchedOnDevice, bool);
+
+protected:
+  OpenCLImageRegistrationMethod();
+  ~OpenCLImageRegistrationMethod() override
+  {
+    delete m_clMetricKernel;
+    delete m_clParabolicPeakKernel;
+    delete m_clProgram;
+    delete m_clQueue;
+    delete m_clContext;
+  }
+
+  void
+  GenerateData() override;
+
+private:
+  /** OpenCL C source of the kernels, for the precision of MetricPixelType. */
+  static std::string
+  GetKernelSource();
+
+  /** Whether the blocks of this update can be matched on the device. */
+  bool
+  CanMatchOnDevice();
+
+  /** Match the blocks of the requested region on the device.  Returns whether
+   * the displacements were interpolated on the device, in which case the
+   * MetricImageToDisplacementCalculator is not used. */
+  bool
+  DeviceMatchBlocks(const RegionType & requestedRegion, const FixedRegionType & blockRegion);
+
+  cl::Context *      m_clContext = nullptr;
+  cl::CommandQueue * m_clQueue = nullptr;
+  cl::Program *      m_clProgram = nullptr;
+  cl::Kernel *       m_clMetricKernel = nullptr;
+  cl::Kernel *       m_clParabolicPeakKernel = nullptr;
+
+  // The work group size of the metric kernel, a power of two, and the number
+  // of pixels of the largest fixed block that fits in its local memory.
+  SizeValueType m_WorkGroupSize = 1;
+  SizeValueType m_MaximumBlockPixels = 0;
+
+  bool m_MatchedOnDevice = false;
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkBlockMatchingOpenCLImageRegistrationMethod.hxx"
+#  endif
+
+#endif // itkBlockMatchingOpenCLImageRegistrationMethod_h
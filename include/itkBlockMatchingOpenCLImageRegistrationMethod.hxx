@@ -0,0 +1,731 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkBlockMatchingOpenCLImageRegistrationMethod_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkBlockMatchingOpenCLImageRegistrationMethod_hxx
+
+#  include "itkBlockMatchingOpenCLImageRegistrationMethod.h"
+
+#  include <algorithm>
+#  include <sstream>
+#  include <vector>
+
+#  include "itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter.h"
+#  include "itkBlockMatchingNormalizedCrossCorrelationMetricImageFilter.h"
+#  include "itkImageRegionConstIteratorWithIndex.h"
+#  include "itkImportImageContainer.h"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+OpenCLImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  OpenCLImageRegistrationMethod()
+{
+  try
+  {
+    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
+    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
+    if (devices.size() < 1)
+    {
+      itkExceptionMacro("No OpenCL devices found.");
+    }
+    // @todo: code to select the fastest device, or the device that is
+    // CL_DEVICE_TYPE_ACCELERATOR
+    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
+
+    const std::string source = GetKernelSource();
+    this->m_clProgram =
+      new cl::Program(*m_clContext, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+    try
+    {
+      this->m_clProgram->build(std::vector<cl::Device>(1, devices[0]));
+    }
+    catch (const cl::Error &)
+    {
+      itkExceptionMacro("Could not build the OpenCL block matching kernels: "
+                        << this->m_clProgram->getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+    }
+    this->m_clMetricKernel = new cl::Kernel(*m_clProgram, "Metric");
+    this->m_clParabolicPeakKernel = new cl::Kernel(*m_clProgram, "ParabolicPeak");
+
+    // The largest power of two work group, of at most 128 work items, and the
+    // local memory left for the fixed block after the reduction.
+    const SizeValueType maximumWorkGroupSize = std::min<SizeValueType>(
+      128, m_clMetricKernel->getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(devices[0]));
+    while (2 * m_WorkGroupSize <= maximumWorkGroupSize)
+    {
+      m_WorkGroupSize *= 2;
+    }
+    const SizeValueType localMemorySize = devices[0].getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    const SizeValueType usedLocalMemory = m_clMetricKernel->getWorkGroupInfo<CL_KERNEL_LOCAL_MEM_SIZE>(devices[0]);
+    const SizeValueType reductionSize = m_WorkGroupSize * sizeof(MetricPixelType);
+    if (localMemorySize > usedLocalMemory + reductionSize)
+    {
+      m_MaximumBlockPixels = (localMemorySize - usedLocalMemory - reductionSize) / sizeof(MetricPixelType);
+    }
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+std::string
+OpenCLImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  GetKernelSource()
+{
+  std::ostringstream source;
+  if (std::is_same<MetricPixelType, double>::value)
+  {
+    source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+              "typedef double REAL;\n"
+              "typedef double4 REAL4;\n";
+  }
+  else
+  {
+    source << "typedef float REAL;\n"
+              "typedef float4 REAL4;\n";
+  }
+  // Every block has five int4: the start of the fixed block in the fixed
+  // buffer, the start and the size of the search region in the moving buffer,
+  // and the begin and end of the positions of the search region whose window
+  // is inside the moving buffer.  The images are three dimensional, with a
+  // size of one along the missing directions, and the summed-area tables have
+  // one more sample along every direction, with zeros first.
+  source << R"(
+#define BLOCK_FIELDS 5
+
+REAL ReduceSum(REAL value, __local REAL * reduction)
+{
+  const uint lid = get_local_id(0);
+  reduction[lid] = value;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  for (uint stride = get_local_size(0) / 2; stride > 0; stride /= 2)
+  {
+    if (lid < stride)
+    {
+      reduction[lid] += reduction[lid + stride];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+  const REAL sum = reduction[0];
+  barrier(CLK_LOCAL_MEM_FENCE);
+  return sum;
+}
+
+REAL BoxSum(__global const REAL * table, const int4 tableSize, const int4 start, const int4 size)
+{
+  const int x0 = start.x;
+  const int y0 = start.y;
+  const int z0 = start.z;
+  const int x1 = start.x + size.x;
+  const int y1 = start.y + size.y;
+  const int z1 = start.z + size.z;
+  const int sx = tableSize.x;
+  const int sxy = tableSize.x * tableSize.y;
+  return table[z1 * sxy + y1 * sx + x1] - table[z1 * sxy + y1 * sx + x0] - table[z1 * sxy + y0 * sx + x1] +
+         table[z1 * sxy + y0 * sx + x0] - table[z0 * sxy + y1 * sx + x1] + table[z0 * sxy + y1 * sx + x0] +
+         table[z0 * sxy + y0 * sx + x1] - table[z0 * sxy + y0 * sx + x0];
+}
+
+__kernel void Metric(__global const REAL * fixed,
+                     const int4 fixedSize,
+                     __global const REAL * moving,
+                     const int4 movingSize,
+                     __global const REAL * movingSums,
+                     __global const REAL * movingSquaredSums,
+                     __global const int4 * blocks,
+                     __global const ulong * metricOffsets,
+                     const int4 blockSize,
+                     const REAL epsilon,
+                     const REAL movingMean,
+                     __local REAL * fixedTile,
+                     __local REAL * reduction,
+                     __global REAL * metric)
+{
+  const uint block = get_group_id(0);
+  const int lid = get_local_id(0);
+  const int localSize = get_local_size(0);
+  const int4 fixedStart = blocks[BLOCK_FIELDS * block];
+  const int4 searchStart = blocks[BLOCK_FIELDS * block + 1];
+  const int4 searchSize = blocks[BLOCK_FIELDS * block + 2];
+  const int4 validBegin = blocks[BLOCK_FIELDS * block + 3];
+  const int4 validEnd = blocks[BLOCK_FIELDS * block + 4];
+  const int blockPixels = blockSize.x * blockSize.y * blockSize.z;
+  const int4 radius = (blockSize - 1) / 2;
+  const int4 tableSize = movingSize + 1;
+
+  // The fixed block less its mean, in local memory.
+  REAL partial = 0;
+  for (int k = lid; k < blockPixels; k += localSize)
+  {
+    const int x = k % blockSize.x;
+    const int y = (k / blockSize.x) % blockSize.y;
+    const int z = k / (blockSize.x * blockSize.y);
+    const REAL value =
+      fixed[((fixedStart.z + z) * fixedSize.y + fixedStart.y + y) * fixedSize.x + fixedStart.x + x];
+    fixedTile[k] = value;
+    partial += value;
+  }
+  const REAL fixedMean = ReduceSum(partial, reduction) / blockPixels;
+  partial = 0;
+  for (int k = lid; k < blockPixels; k += localSize)
+  {
+    const REAL centered = fixedTile[k] - fixedMean;
+    fixedTile[k] = centered;
+    partial += centered * centered;
+  }
+  const REAL fixedPseudoSigma = sqrt(ReduceSum(partial, reduction));
+
+  // Since the fixed block less its mean sums to zero, the cross sum does not
+  // need the window mean.
+  __global REAL * blockMetric = metric + metricOffsets[block];
+  const int       positions = searchSize.x * searchSize.y * searchSize.z;
+  const REAL      windowPixels = blockPixels;
+  for (int position = lid; position < positions; position += localSize)
+  {
+    const int x = position % searchSize.x;
+    const int y = (position / searchSize.x) % searchSize.y;
+    const int z = position / (searchSize.x * searchSize.y);
+    if (x < validBegin.x || x >= validEnd.x || y < validBegin.y || y >= validEnd.y || z < validBegin.z ||
+        z >= validEnd.z || fixedPseudoSigma == 0)
+    {
+      blockMetric[position] = 0;
+      continue;
+    }
+    const int4 windowStart = (int4)(searchStart.x + x, searchStart.y + y, searchStart.z + z, 0) - radius;
+    REAL       crossSum = 0;
+    int        k = 0;
+    for (int kz = 0; kz < blockSize.z; ++kz)
+    {
+      for (int ky = 0; ky < blockSize.y; ++ky)
+      {
+        __global const REAL * row =
+          moving + ((windowStart.z + kz) * movingSize.y + windowStart.y + ky) * movingSize.x + windowStart.x;
+        for (int kx = 0; kx < blockSize.x; ++kx, ++k)
+        {
+          crossSum += fixedTile[k] * row[kx];
+        }
+      }
+    }
+    const REAL sum = BoxSum(movingSums, tableSize, windowStart, blockSize);
+    const REAL sumOfSquares = BoxSum(movingSquaredSums, tableSize, windowStart, blockSize);
+    const REAL movingPseudoSigmaSquared = sumOfSquares - sum * sum / windowPixels;
+    // The sum of squares of the window itself, for the same tolerance as on
+    // the host.
+    const REAL windowSumOfSquares = sumOfSquares + movingMean * (2 * sum + windowPixels * movingMean);
+    if (!(movingPseudoSigmaSquared > epsilon * windowSumOfSquares))
+    {
+      blockMetric[position] = 0;
+      continue;
+    }
+    blockMetric[position] = clamp(crossSum / (fixedPseudoSigma * sqrt(movingPseudoSigmaSquared)), (REAL)-1, (REAL)1);
+  }
+}
+
+// The first maximum of the metric image of a block, and the vertices of the
+// parabolas through it and its neighbors along every direction, as in
+// ParabolicInterpolationDisplacementCalculator.
+__kernel void ParabolicPeak(__global const REAL * metric,
+                            __global const int4 * blocks,
+                            __global const ulong * metricOffsets,
+                            const uint numberOfBlocks,
+                            const REAL initialMaximum,
+                            __global int4 * peakIndices,
+                            __global REAL4 * peakOffsets)
+{
+  const uint block = get_global_id(0);
+  if (block >= numberOfBlocks)
+  {
+    return;
+  }
+  const int4              size = blocks[BLOCK_FIELDS * block + 2];
+  __global const REAL *   blockMetric = metric + metricOffsets[block];
+  const int               positions = size.x * size.y * size.z;
+  REAL                    maximum = initialMaximum;
+  int                     maximumPosition = 0;
+  for (int position = 0; position < positions; ++position)
+  {
+    if (blockMetric[position] > maximum)
+    {
+      maximum = blockMetric[position];
+      maximumPosition = position;
+    }
+  }
+  const int4 index = (int4)(maximumPosition % size.x,
+                            (maximumPosition / size.x) % size.y,
+                            maximumPosition / (size.x * size.y),
+                            0);
+  const int  strides[3] = { 1, size.x, size.x * size.y };
+  const int  indices[3] = { index.x, index.y, index.z };
+  const int  sizes[3] = { size.x, size.y, size.z };
+  REAL       offsets[3] = { 0, 0, 0 };
+  for (int i = 0; i < 3; ++i)
+  {
+    if (indices[i] < 1 || indices[i] + 1 >= sizes[i])
+    {
+      continue;
+    }
+    const REAL y0 = blockMetric[maximumPosition - strides[i]];
+    const REAL y2 = blockMetric[maximumPosition + strides[i]];
+    offsets[i] = (y0 - y2) / (2 * (y0 - 2 * maximum + y2));
+  }
+  peakIndices[block] = index;
+  peakOffsets[block] = (REAL4)(offsets[0], offsets[1], offsets[2], 0);
+}
+)";
+  return source.str();
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+bool
+OpenCLImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  CanMatchOnDevice()
+{
+  if (this->m_UseStreaming || this->m_NumberOfSlabs > 1 || this->m_RadiusImage || this->m_Mask ||
+      !this->m_FixedImage || !this->m_MovingImage || !this->m_MetricImageFilter)
+  {
+    return false;
+  }
+  using NormalizedCrossCorrelationType =
+    NormalizedCrossCorrelationMetricImageFilter<FixedImageType, MovingImageType, MetricImageType>;
+  using NormalizedCrossCorrelationKernelType =
+    NormalizedCrossCorrelationKernelMetricImageFilter<FixedImageType, MovingImageType, MetricImageType>;
+  if (!dynamic_cast<NormalizedCrossCorrelationType *>(this->m_MetricImageFilter.GetPointer()) &&
+      !dynamic_cast<NormalizedCrossCorrelationKernelType *>(this->m_MetricImageFilter.GetPointer()))
+  {
+    return false;
+  }
+
+  this->m_FixedImage->UpdateOutputInformation();
+  this->m_MovingImage->UpdateOutputInformation();
+  if (!(this->m_FixedImage->GetSpacing() == this->m_MovingImage->GetSpacing()))
+  {
+    return false;
+  }
+  SizeValueType blockPixels = 1;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    blockPixels *= 2 * this->m_Radius[i] + 1;
+  }
+  return blockPixels <= m_MaximumBlockPixels;
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+void
+OpenCLImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::GenerateData()
+{
+  m_MatchedOnDevice = this->CanMatchOnDevice();
+  if (!m_MatchedOnDevice)
+  {
+    Superclass::GenerateData();
+    return;
+  }
+
+  this->Initialize();
+
+  this->m_FixedImage->Update();
+  this->m_MovingImage->Update();
+  this->m_FixedImage->DisconnectPipeline();
+  this->m_MovingImage->DisconnectPipeline();
+
+  FixedRegionType                    blockRegion;
+  typename FixedRegionType::SizeType blockSize;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    blockSize[i] = 2 * this->m_Radius[i] + 1;
+  }
+  blockRegion.SetSize(blockSize);
+
+  if (!this->DeviceMatchBlocks(this->GetOutput()->GetRequestedRegion(), blockRegion))
+  {
+    this->m_MetricImageToDisplacementCalculator->Compute();
+  }
+}
+
+
+template <typename TFixedImage,
+          typename TMovingImage,
+          typename TMetricImage,
+          typename TDisplacementImage,
+          typename TCoordRep>
+bool
+OpenCLImageRegistrationMethod<TFixedImage, TMovingImage, TMetricImage, TDisplacementImage, TCoordRep>::
+  DeviceMatchBlocks(const RegionType & requestedRegion, const FixedRegionType & blockRegion)
+{
+  const SearchRegionImageType * input = this->GetInput();
+  ImageType *                   output = this->GetOutput();
+  const FixedImageType *        fixed = this->m_FixedImage;
+  const MovingImageType *       moving = this->m_MovingImage;
+  const FixedRegionType &       fixedBuffered = fixed->GetBufferedRegion();
+  const MovingRegionType &      movingBuffered = moving->GetBufferedRegion();
+
+  auto toInt4 = [](const OffsetValueType * values, cl_int missing) {
+    cl_int4 vector;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+      vector.s[i] = i < ImageDimension ? static_cast<cl_int>(values[i]) : missing;
+    }
+    return vector;
+  };
+  OffsetValueType values[ImageDimension];
+
+  // The descriptors of the blocks inside the fixed buffer, and the offsets of
+  // their metric images in the metric buffer.
+  std::vector<cl_int4>  blocks;
+  std::vector<cl_ulong> metricOffsets;
+  std::vector<IndexType> deviceIndices;
+  std::vector<IndexType> hostIndices;
+  cl_ulong               metricBufferSize = 0;
+  FixedRegionType        fixedRegion = blockRegion;
+  typename FixedImageType::IndexType fixedIndex;
+  CoordRepType                       coord;
+  ImageRegionConstIteratorWithIndex<SearchRegionImageType> searchIt(input, requestedRegion);
+  for (searchIt.GoToBegin(); !searchIt.IsAtEnd(); ++searchIt)
+  {
+    output->TransformIndexToPhysicalPoint(searchIt.GetIndex(), coord);
+    fixed->TransformPhysicalPointToIndex(coord, fixedIndex);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      fixedIndex[i] -= this->m_Radius[i];
+    }
+    fixedRegion.SetIndex(fixedIndex);
+    if (!fixedBuffered.IsInside(fixedRegion))
+    {
+      hostIndices.push_back(searchIt.GetIndex());
+      continue;
+    }
+    deviceIndices.push_back(searchIt.GetIndex());
+
+    const MovingRegionType & searchRegion = searchIt.Get();
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      values[i] = fixedIndex[i] - fixedBuffered.GetIndex(i);
+    }
+    blocks.push_back(toInt4(values, 0));
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      values[i] = searchRegion.GetIndex(i) - movingBuffered.GetIndex(i);
+    }
+    blocks.push_back(toInt4(values, 0));
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      values[i] = static_cast<OffsetValueType>(searchRegion.GetSize(i));
+    }
+    blocks.push_back(toInt4(values, 1));
+
+    // The positions whose window is inside the moving buffer, as in
+    // MetricImageFilter::AllocateMetricImage().
+    OffsetValueType begins[ImageDimension];
+    OffsetValueType ends[ImageDimension];
+    bool            isValid = true;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      const OffsetValueType radius = static_cast<OffsetValueType>(this->m_Radius[i]);
+      const OffsetValueType searchBegin = searchRegion.GetIndex(i);
+      const OffsetValueType searchEnd = searchBegin + static_cast<OffsetValueType>(searchRegion.GetSize(i));
+      const OffsetValueType bufferedBegin = movingBuffered.GetIndex(i);
+      const OffsetValueType bufferedEnd = bufferedBegin + static_cast<OffsetValueType>(movingBuffered.GetSize(i));
+      begins[i] = std::max(searchBegin, bufferedBegin + radius) - searchBegin;
+      ends[i] = std::min(searchEnd, bufferedEnd - radius) - searchBegin;
+      isValid = isValid && ends[i] > begins[i];
+    }
+    if (!isValid)
+    {
+      std::fill(begins, begins + ImageDimension, 0);
+      std::fill(ends, ends + ImageDimension, 0);
+    }
+    blocks.push_back(toInt4(begins, 0));
+    blocks.push_back(toInt4(ends, 1));
+
+    metricOffsets.push_back(metricBufferSize);
+    metricBufferSize += searchRegion.GetNumberOfPixels();
+  }
+  const SizeValueType numberOfDeviceBlocks = deviceIndices.size();
+
+  // The displacements are interpolated on the device when the calculator is
+  // the parabolic interpolation and every block is matched there.
+  const bool peaksOnDevice = hostIndices.empty() && dynamic_cast<ParabolicInterpolationDisplacementCalculatorType *>(
+                                                       this->m_MetricImageToDisplacementCalculator.GetPointer());
+
+  // The images, and the summed-area tables of the moving image less its mean,
+  // which does not change the normalized cross correlation, to keep the
+  // differences of the table accurate.
+  const SizeValueType fixedPixels = fixedBuffered.GetNumberOfPixels();
+  const SizeValueType movingPixels = movingBuffered.GetNumberOfPixels();
+  std::vector<MetricPixelType> fixedValues(fixedPixels);
+  std::vector<MetricPixelType> movingValues(movingPixels);
+  double                       movingMean = 0.0;
+  for (SizeValueType ii = 0; ii < fixedPixels; ++ii)
+  {
+    fixedValues[ii] = static_cast<MetricPixelType>(fixed->GetBufferPointer()[ii]);
+  }
+  for (SizeValueType ii = 0; ii < movingPixels; ++ii)
+  {
+    movingValues[ii] = static_cast<MetricPixelType>(moving->GetBufferPointer()[ii]);
+    movingMean += static_cast<double>(moving->GetBufferPointer()[ii]);
+  }
+  movingMean /= static_cast<double>(std::max<SizeValueType>(movingPixels, 1));
+
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    values[i] = static_cast<OffsetValueType>(fixedBuffered.GetSize(i));
+  }
+  const cl_int4 fixedSize = toInt4(values, 1);
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    values[i] = static_cast<OffsetValueType>(movingBuffered.GetSize(i));
+  }
+  const cl_int4       movingSize = toInt4(values, 1);
+  const SizeValueType tableX = movingSize.s[0] + 1;
+  const SizeValueType tableXY = tableX * (movingSize.s[1] + 1);
+  const SizeValueType tablePixels = tableXY * (movingSize.s[2] + 1);
+  std::vector<double> sums(tablePixels, 0.0);
+  std::vector<double> squaredSums(tablePixels, 0.0);
+  SizeValueType       movingOffset = 0;
+  for (SizeValueType z = 1; z <= static_cast<SizeValueType>(movingSize.s[2]); ++z)
+  {
+    for (SizeValueType y = 1; y <= static_cast<SizeValueType>(movingSize.s[1]); ++y)
+    {
+      for (SizeValueType x = 1; x <= static_cast<SizeValueType>(movingSize.s[0]); ++x, ++movingOffset)
+      {
+        const double        value = static_cast<double>(moving->GetBufferPointer()[movingOffset]) - movingMean;
+        const SizeValueType t = z * tableXY + y * tableX + x;
+        // Inclusion-exclusion over the seven preceding corners.
+        const SizeValueType corners[7] = { t - 1,          t - tableX,           t - tableXY,
+                                           t - 1 - tableX, t - 1 - tableXY,      t - tableX - tableXY,
+                                           t - 1 - tableX - tableXY };
+        const double        signs[7] = { 1.0, 1.0, 1.0, -1.0, -1.0, -1.0, 1.0 };
+        double              sum = value;
+        double              squaredSum = value * value;
+        for (unsigned int c = 0; c < 7; ++c)
+        {
+          sum += signs[c] * sums[corners[c]];
+          squaredSum += signs[c] * squaredSums[corners[c]];
+        }
+        sums[t] = sum;
+        squaredSums[t] = squaredSum;
+      }
+    }
+  }
+  std::vector<MetricPixelType> movingSums(sums.begin(), sums.end());
+  std::vector<MetricPixelType> movingSquaredSums(squaredSums.begin(), squaredSums.end());
+
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    values[i] = static_cast<OffsetValueType>(blockRegion.GetSize(i));
+  }
+  const cl_int4 blockSize = toInt4(values, 1);
+  SizeValueType blockPixels = 1;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    blockPixels *= blockRegion.GetSize(i);
+  }
+
+  using Real4Type =
+    typename std::conditional<std::is_same<MetricPixelType, double>::value, cl_double4, cl_float4>::type;
+  std::vector<MetricPixelType> metricValues;
+  std::vector<cl_int4>         peakIndices;
+  std::vector<Real4Type>       peakOffsets;
+  try
+  {
+    if (numberOfDeviceBlocks > 0)
+    {
+      const cl_mem_flags readHost = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+      cl::Buffer fixedBuffer(*m_clContext, readHost, fixedPixels * sizeof(MetricPixelType), fixedValues.data());
+      cl::Buffer movingBuffer(*m_clContext, readHost, movingPixels * sizeof(MetricPixelType), movingValues.data());
+      cl::Buffer sumsBuffer(*m_clContext, readHost, tablePixels * sizeof(MetricPixelType), movingSums.data());
+      cl::Buffer squaredSumsBuffer(
+        *m_clContext, readHost, tablePixels * sizeof(MetricPixelType), movingSquaredSums.data());
+      cl::Buffer blocksBuffer(*m_clContext, readHost, blocks.size() * sizeof(cl_int4), blocks.data());
+      cl::Buffer metricOffsetsBuffer(
+        *m_clContext, readHost, metricOffsets.size() * sizeof(cl_ulong), metricOffsets.data());
+      cl::Buffer metricBuffer(*m_clContext, CL_MEM_READ_WRITE, metricBufferSize * sizeof(MetricPixelType));
+
+      cl::Kernel & metric = *this->m_clMetricKernel;
+      metric.setArg(0, fixedBuffer);
+      metric.setArg(1, fixedSize);
+      metric.setArg(2, movingBuffer);
+      metric.setArg(3, movingSize);
+      metric.setArg(4, sumsBuffer);
+      metric.setArg(5, squaredSumsBuffer);
+      metric.setArg(6, blocksBuffer);
+      metric.setArg(7, metricOffsetsBuffer);
+      metric.setArg(8, blockSize);
+      metric.setArg(9, NumericTraits<MetricPixelType>::epsilon());
+      metric.setArg(10, static_cast<MetricPixelType>(movingMean));
+      metric.setArg(11, cl::Local(blockPixels * sizeof(MetricPixelType)));
+      metric.setArg(12, cl::Local(m_WorkGroupSize * sizeof(MetricPixelType)));
+      metric.setArg(13, metricBuffer);
+      m_clQueue->enqueueNDRangeKernel(
+        metric, cl::NullRange, cl::NDRange(numberOfDeviceBlocks * m_WorkGroupSize), cl::NDRange(m_WorkGroupSize));
+
+      if (peaksOnDevice)
+      {
+        cl::Buffer peakIndicesBuffer(*m_clContext, CL_MEM_WRITE_ONLY, numberOfDeviceBlocks * sizeof(cl_int4));
+        cl::Buffer peakOffsetsBuffer(*m_clContext, CL_MEM_WRITE_ONLY, numberOfDeviceBlocks * sizeof(Real4Type));
+        cl::Kernel & parabolicPeak = *this->m_clParabolicPeakKernel;
+        parabolicPeak.setArg(0, metricBuffer);
+        parabolicPeak.setArg(1, blocksBuffer);
+        parabolicPeak.setArg(2, metricOffsetsBuffer);
+        parabolicPeak.setArg(3, static_cast<cl_uint>(numberOfDeviceBlocks));
+        parabolicPeak.setArg(4, NumericTraits<MetricPixelType>::min());
+        parabolicPeak.setArg(5, peakIndicesBuffer);
+        parabolicPeak.setArg(6, peakOffsetsBuffer);
+        const SizeValueType peakGroupSize = 64;
+        const SizeValueType peakGlobalSize = (numberOfDeviceBlocks + peakGroupSize - 1) / peakGroupSize * peakGroupSize;
+        m_clQueue->enqueueNDRangeKernel(
+          parabolicPeak, cl::NullRange, cl::NDRange(peakGlobalSize), cl::NDRange(peakGroupSize));
+
+        peakIndices.resize(numberOfDeviceBlocks);
+        peakOffsets.resize(numberOfDeviceBlocks);
+        m_clQueue->enqueueReadBuffer(
+          peakIndicesBuffer, CL_TRUE, 0, numberOfDeviceBlocks * sizeof(cl_int4), peakIndices.data());
+        m_clQueue->enqueueReadBuffer(
+          peakOffsetsBuffer, CL_TRUE, 0, numberOfDeviceBlocks * sizeof(Real4Type), peakOffsets.data());
+      }
+      else
+      {
+        metricValues.resize(metricBufferSize);
+        m_clQueue->enqueueReadBuffer(
+          metricBuffer, CL_TRUE, 0, metricBufferSize * sizeof(MetricPixelType), metricValues.data());
+      }
+    }
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+
+  if (peaksOnDevice)
+  {
+    // The vertex of the parabolas from the peak of the metric image, whose
+    // origin is the start of the search region, less the center of the block.
+    const typename MovingImageType::SpacingType & spacing = moving->GetSpacing();
+    typename MovingImageType::IndexType           peakIndex;
+    CoordRepType                                  peakPoint;
+    for (SizeValueType block = 0; block < numberOfDeviceBlocks; ++block)
+    {
+      const IndexType & index = deviceIndices[block];
+      const MovingRegionType & searchRegion = input->GetPixel(index);
+      for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+        peakIndex[i] = searchRegion.GetIndex(i) + peakIndices[block].s[i];
+      }
+      moving->TransformIndexToPhysicalPoint(peakIndex, peakPoint);
+      for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+        peakPoint[i] += spacing[i] * peakOffsets[block].s[i];
+      }
+      output->TransformIndexToPhysicalPoint(index, coord);
+      output->SetPixel(index, peakPoint - coord);
+    }
+    output->Modified();
+    this->UpdateProgress(1.0f);
+    return true;
+  }
+
+  // The metric images share the buffer they were read back into.
+  const bool                        peakNeighborhoodOnly =
+    this->m_MetricImageToDisplacementCalculator->GetPeakNeighborhoodOnly();
+  typename MetricImageType::Pointer metricImage = MetricImageType::New();
+  typename MetricImageType::Pointer peakNeighborhood = MetricImageType::New();
+  for (SizeValueType block = 0; block < numberOfDeviceBlocks; ++block)
+  {
+    const IndexType &        index = deviceIndices[block];
+    const MovingRegionType & searchRegion = input->GetPixel(index);
+
+    typename MetricImageType::RegionType metricRegion;
+    metricRegion.SetSize(searchRegion.GetSize());
+    metricImage->SetRegions(metricRegion);
+    metricImage->SetSpacing(moving->GetSpacing());
+    typename MetricImageType::PointType origin;
+    moving->TransformIndexToPhysicalPoint(searchRegion.GetIndex(), origin);
+    metricImage->SetOrigin(origin);
+    metricImage->SetDirection(moving->GetDirection());
+    using MetricContainerType = typename MetricImageType::PixelContainer;
+    typename MetricContainerType::Pointer container = MetricContainerType::New();
+    container->SetImportPointer(metricValues.data() + metricOffsets[block], searchRegion.GetNumberOfPixels());
+    metricImage->SetPixelContainer(container);
+
+    MetricImageType * blockMetricImage = metricImage;
+    if (peakNeighborhoodOnly)
+    {
+      blockMetricImage = this->ExtractPeakNeighborhood(metricImage, peakNeighborhood);
+    }
+    output->TransformIndexToPhysicalPoint(index, coord);
+    this->m_MetricImageToDisplacementCalculator->SetMetricImagePixel(coord, index, blockMetricImage);
+  }
+
+  // The blocks that are not inside the fixed image are matched by the metric
+  // image filter.
+  typename MetricImageType::Pointer hostMetricImage = MetricImageType::New();
+  for (const IndexType & index : hostIndices)
+  {
+    output->TransformIndexToPhysicalPoint(index, coord);
+    fixed->TransformPhysicalPointToIndex(coord, fixedIndex);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      fixedIndex[i] -= this->m_Radius[i];
+    }
+    fixedRegion.SetIndex(fixedIndex);
+    const MovingRegionType & searchRegion = input->GetPixel(index);
+    MetricImageType *        blockMetricImage = hostMetricImage;
+    if (!this->m_MetricImageFilter->ComputeMetricImage(fixedRegion, searchRegion, blockMetricImage))
+    {
+      this->m_MetricImageFilter->SetFixedImageRegion(fixedRegion);
+      this->m_MetricImageFilter->SetMovingImageRegion(searchRegion);
+      this->m_MetricImageFilter->Update();
+      blockMetricImage = this->m_MetricImageFilter->GetOutput();
+    }
+    if (peakNeighborhoodOnly)
+    {
+      blockMetricImage = this->ExtractPeakNeighborhood(blockMetricImage, peakNeighborhood);
+    }
+    this->m_MetricImageToDisplacementCalculator->SetMetricImagePixel(coord, index, blockMetricImage);
+  }
+  this->UpdateProgress(1.0f);
+  return false;
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif // itkBlockMatchingOpenCLImageRegistrationMethod_hxx
@@ -78,16 +78,20 @@ public:
   /** Type of the optimizer. */
   using OptimizerType = SingleValuedNonLinearOptimizer;
 
+  using MetricImageImageType = typename Superclass::MetricImageImageType;
+  using CenterPointsImageType = typename Superclass::CenterPointsImageType;
+  using DisplacementImageType = typename Superclass::DisplacementImageType;
+  using DisplacementType = typename DisplacementImageType::PixelType;
+  using RegionType = typename Superclass::RegionType;
+
   void
   SetMetricImagePixel(const PointType & point, const IndexType & index, MetricImageType * image) override;
 
+  /** The metric images are cached by default, and the displacements of all
+   * the blocks are optimized here, multithreaded.  Without the cache, they
+   * are optimized in SetMetricImagePixel(). */
   void
-  Compute() override
-  {
-    // We do this here instead of SetMetricImagePixel so it only has to be done
-    // once.
-    this->m_DisplacementImage->Modified();
-  };
+  Compute() override;
 
   /** Set the interpolator.  Windowed sinc interpolators are recommended. */
   virtual void
@@ -104,7 +108,13 @@ public:
 
   /** Set the optimizer.  The parameter step size is in pixel indices; it should
    * be less than unity.  Since some optimizer only support minimization, the
-   * metric image value is inverted. */
+   * metric image value is inverted.
+   *
+   * With more than one work unit of the MultiThreader, every work unit of
+   * Compute() optimizes with its own Clone() of the optimizer and of the
+   * interpolator, and the scales of the optimizer.  Settings that the Clone()
+   * of the optimizer does not copy take their default values; with one work
+   * unit, the optimizer and the interpolator are used themselves. */
   virtual void
   SetOptimizer(OptimizerType * optimizer)
   {
@@ -188,6 +198,18 @@ public:
 protected:
   OptimizingInterpolationDisplacementCalculator();
 
+  /** The displacement of the block centered at the point to the optimized
+   * peak of its metric image. */
+  DisplacementType
+  ComputeDisplacement(const PointType &                     centerPoint,
+                      const MetricImageType *               metricImage,
+                      OptimizerType *                       optimizer,
+                      OptimizingInterpolationCostFunction * costFunction) const;
+
+  /** Compute the displacements of the cached metric images in the region. */
+  void
+  ThreadedComputeDisplacements(const RegionType & region);
+
   typename OptimizingInterpolationCostFunction::Pointer m_CostFunction;
   typename OptimizerType::Pointer                       m_Optimizer;
 
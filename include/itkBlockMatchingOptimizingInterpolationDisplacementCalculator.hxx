@@ -20,7 +20,9 @@
 
 #include "itkBlockMatchingOptimizingInterpolationDisplacementCalculator.h"
 
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 
 namespace itk
 {
@@ -31,6 +33,8 @@ template <class TMetricImage, class TDisplacementImage, class TCoordRep>
 OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::
   OptimizingInterpolationDisplacementCalculator()
 {
+  this->m_CacheMetricImage = true;
+
   m_CostFunction = OptimizingInterpolationCostFunction::New();
 
   // @todo sensible default optimizer and interpolator
@@ -46,6 +50,81 @@ OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage,
 {
   Superclass::SetMetricImagePixel(centerPoint, displacementIndex, metricImage);
 
+  if (!this->m_CacheMetricImage)
+  {
+    this->m_DisplacementImage->SetPixel(
+      displacementIndex,
+      this->ComputeDisplacement(centerPoint, metricImage, m_Optimizer.GetPointer(), m_CostFunction.GetPointer()));
+  }
+}
+
+
+template <class TMetricImage, class TDisplacementImage, class TCoordRep>
+void
+OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::Compute()
+{
+  if (this->m_CacheMetricImage)
+  {
+    this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
+      this->m_DisplacementImage->GetRequestedRegion(),
+      [this](const RegionType & outputRegion) { this->ThreadedComputeDisplacements(outputRegion); },
+      nullptr);
+  }
+  // We do this here instead of SetMetricImagePixel so it only has to be done
+  // once.
+  this->m_DisplacementImage->Modified();
+}
+
+
+template <class TMetricImage, class TDisplacementImage, class TCoordRep>
+void
+OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::
+  ThreadedComputeDisplacements(const RegionType & region)
+{
+  // The optimizer and the interpolator hold the state of the optimization of
+  // a block, so every work unit has its own.
+  typename OptimizerType::Pointer                       optimizer = m_Optimizer;
+  typename OptimizingInterpolationCostFunction::Pointer costFunction = m_CostFunction;
+  if (this->m_MultiThreader->GetNumberOfWorkUnits() > 1)
+  {
+    typename InterpolatorType::Pointer interpolator =
+      dynamic_cast<InterpolatorType *>(m_CostFunction->GetInterpolator()->Clone().GetPointer());
+    optimizer = dynamic_cast<OptimizerType *>(m_Optimizer->Clone().GetPointer());
+    if (interpolator.IsNull() || optimizer.IsNull())
+    {
+      itkExceptionMacro(<< "Could not clone the optimizer or the interpolator.");
+    }
+    costFunction = OptimizingInterpolationCostFunction::New();
+    costFunction->SetInterpolator(interpolator);
+    optimizer->SetScales(m_Optimizer->GetScales());
+    optimizer->SetCostFunction(costFunction);
+  }
+
+  ImageRegionConstIterator<MetricImageImageType>  imageImageIt(this->m_MetricImageImage, region);
+  ImageRegionConstIterator<CenterPointsImageType> centerPointsIt(this->m_CenterPointsImage, region);
+  ImageRegionIterator<DisplacementImageType>      displacementIt(this->m_DisplacementImage, region);
+  for (imageImageIt.GoToBegin(), centerPointsIt.GoToBegin(), displacementIt.GoToBegin(); !imageImageIt.IsAtEnd();
+       ++imageImageIt, ++centerPointsIt, ++displacementIt)
+  {
+    if (imageImageIt.Get() == nullptr)
+    {
+      // A missing block.
+      displacementIt.Set(NumericTraits<typename DisplacementImageType::PixelType>::ZeroValue());
+      continue;
+    }
+    displacementIt.Set(this->ComputeDisplacement(centerPointsIt.Get(), imageImageIt.Get(), optimizer, costFunction));
+  }
+}
+
+
+template <class TMetricImage, class TDisplacementImage, class TCoordRep>
+auto
+OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, TCoordRep>::ComputeDisplacement(
+  const PointType &                     centerPoint,
+  const MetricImageType *               metricImage,
+  OptimizerType *                       optimizer,
+  OptimizingInterpolationCostFunction * costFunction) const -> DisplacementType
+{
   // Find index of the maximum value.
   PixelType max = NumericTraits<PixelType>::min();
   IndexType maxIndex;
@@ -88,15 +167,15 @@ OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage,
     {
       parameters[i] = static_cast<typename OptimizingInterpolationCostFunction::ParametersValueType>(maxIndex[i]);
     }
-    m_Optimizer->SetInitialPosition(parameters);
+    optimizer->SetInitialPosition(parameters);
     // Is this the right offset?
     for (unsigned int i = 0; i < ImageDimension; i++)
       parameters[i] += 0.1;
-    m_CostFunction->Initialize(parameters);
-    m_CostFunction->GetInterpolator()->SetInputImage(metricImage);
-    m_Optimizer->StartOptimization();
+    costFunction->Initialize(parameters);
+    costFunction->m_Interpolator->SetInputImage(metricImage);
+    optimizer->StartOptimization();
 
-    parameters = m_Optimizer->GetCurrentPosition();
+    parameters = optimizer->GetCurrentPosition();
 
     ContinuousIndexType continuousIndex;
     for (unsigned int i = 0; i < ImageDimension; i++)
@@ -106,7 +185,7 @@ OptimizingInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage,
     metricImage->TransformContinuousIndexToPhysicalPoint(continuousIndex, maxPoint);
   }
 
-  this->m_DisplacementImage->SetPixel(displacementIndex, maxPoint - centerPoint);
+  return maxPoint - centerPoint;
 }
 
 
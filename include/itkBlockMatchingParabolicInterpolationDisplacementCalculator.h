@@ -77,6 +77,11 @@ public:
   void
   Compute() override;
 
+  /** Only pass the 3^N neighborhood of the maximum of the metric images, see
+   * MetricImageToDisplacementCalculator::GetPeakNeighborhoodOnly(). */
+  itkSetMacro(PeakNeighborhoodOnly, bool);
+  itkBooleanMacro(PeakNeighborhoodOnly);
+
 protected:
   ParabolicInterpolationDisplacementCalculator();
 
@@ -62,6 +62,12 @@ ParabolicInterpolationDisplacementCalculator<TMetricImage, TDisplacementImage, T
   for (imageImageIt.GoToBegin(), centerPointsIt.GoToBegin(), displacementIt.GoToBegin(); !imageImageIt.IsAtEnd();
        ++imageImageIt, ++centerPointsIt, ++displacementIt)
   {
+    if (imageImageIt.Get() == nullptr)
+    {
+      // A missing block.
+      displacementIt.Set(NumericTraits<typename DisplacementImageType::PixelType>::ZeroValue());
+      continue;
+    }
     metricImage = imageImageIt.Get();
     spacing = metricImage->GetSpacing();
 
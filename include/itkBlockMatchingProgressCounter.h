@@ -0,0 +1,149 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingProgressCounter_h
+#define itkBlockMatchingProgressCounter_h
+
+#include "itkProcessObject.h"
+
+#include "UltrasoundExport.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class ProgressCounter
+ *
+ * \brief Count the matched blocks of the work units of a filter, invoke its
+ * progress events at a bounded rate, and check cheaply for an abort request.
+ *
+ * The work units add their blocks in batches with a single atomic addition.
+ * A progress event is only invoked when the event interval has elapsed since
+ * the last one, by the work unit whose batch crossed it; when another work
+ * unit is invoking one, the work unit does not wait for it.  The abort flag of
+ * the filter is checked for every block, so the matching stops within a block
+ * of AbortGenerateDataOn().
+ *
+ * \ingroup Ultrasound
+ */
+class Ultrasound_EXPORT ProgressCounter
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ProgressCounter);
+
+  /** Count numberOfBlocks blocks of the filter, with at most one progress
+   * event every eventInterval seconds. */
+  ProgressCounter(ProcessObject * filter, SizeValueType numberOfBlocks, double eventInterval);
+
+  /** Add the blocks a work unit completed.  Returns false when the filter was
+   * asked to abort.  Thread safe. */
+  bool
+  CompletedBlocks(SizeValueType numberOfBlocks);
+
+  /** Whether the filter was asked to abort.  Thread safe. */
+  bool
+  IsAborted()
+  {
+    if (m_Aborted.load(std::memory_order_relaxed))
+    {
+      return true;
+    }
+    if (m_Filter->GetAbortGenerateData())
+    {
+      m_Aborted.store(true, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  /** Throw a ProcessAborted exception when the filter was asked to abort.  To
+   * be called from the thread of the update, after the work units returned. */
+  void
+  CheckAbort();
+
+  SizeValueType
+  GetNumberOfBlocks() const
+  {
+    return m_NumberOfBlocks;
+  }
+
+  SizeValueType
+  GetNumberOfCompletedBlocks() const
+  {
+    return m_CompletedBlocks.load(std::memory_order_relaxed);
+  }
+
+  /** The blocks of a work unit, added to the ProgressCounter in batches of
+   * about a thousandth of the blocks.  Every work unit has its own. */
+  class Batch
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(Batch);
+
+    explicit Batch(ProgressCounter & counter)
+      : m_Counter(counter)
+    {}
+
+    ~Batch() { this->Flush(); }
+
+    /** Count a block.  Returns false when the filter was asked to abort. */
+    bool
+    CompletedBlock()
+    {
+      if (++m_NumberOfBlocks >= m_Counter.m_BatchSize)
+      {
+        return this->Flush();
+      }
+      return !m_Counter.IsAborted();
+    }
+
+    /** Add the blocks of the batch to the ProgressCounter. */
+    bool
+    Flush()
+    {
+      const SizeValueType numberOfBlocks = m_NumberOfBlocks;
+      m_NumberOfBlocks = 0;
+      return m_Counter.CompletedBlocks(numberOfBlocks);
+    }
+
+  private:
+    ProgressCounter & m_Counter;
+    SizeValueType     m_NumberOfBlocks{ 0 };
+  };
+
+private:
+  static std::int64_t
+  Now();
+
+  ProcessObject *            m_Filter;
+  const SizeValueType        m_NumberOfBlocks;
+  const SizeValueType        m_BatchSize;
+  const std::int64_t         m_EventInterval;
+  std::atomic<SizeValueType> m_CompletedBlocks{ 0 };
+  std::atomic<std::int64_t>  m_NextEventTime;
+  std::atomic_flag           m_InvokingEvent = ATOMIC_FLAG_INIT;
+  std::atomic<bool>          m_Aborted{ false };
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
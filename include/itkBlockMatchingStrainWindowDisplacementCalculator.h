@@ -20,10 +20,7 @@
 
 #include "itkBlockMatchingMetricImageToDisplacementCalculator.h"
 
-#include "itkAbsImageFilter.h"
-#include "itkBoxMeanImageFilter.h"
 #include "itkImageToImageFilter.h"
-#include "itkNthElementImageAdaptor.h"
 #include "itkSymmetricSecondRankTensor.h"
 
 namespace itk
@@ -50,7 +47,14 @@ namespace BlockMatching
  * displacement image type, and strain image component value type.
  *
  * The filter can be applied iteratively to remove regions of high strain with
- * SetMaximumIterations().
+ * SetMaximumIterations().  The intermediate images are allocated once for the
+ * displacement grid, and after the first iteration only the neighborhoods of
+ * the strain values that changed are evaluated again against the window.
+ *
+ * The missing blocks of a BlockMask are first interpolated from the
+ * surrounding blocks, so that their zero displacements do not bias the
+ * strains of their neighbors.  They are then always replaced, never take part
+ * in the window of another block, and are set back to zero at the end.
  *
  * \ingroup Ultrasound
  */
@@ -148,14 +152,30 @@ protected:
 
   /** Determine the values outside the strain window, and set the internal mask
    * image to true if the value needs to be replaced.  Return the number of
-   * values outside the strain window. */
+   * values outside the strain window.  Unless m_UpdateWholeMask is set, only
+   * the mask values whose box contains a strain value that changed since the
+   * last call are evaluated. */
   unsigned long long
   GenerateMask(const RegionType & region);
 
-  /** Replace the displacements where the mask is true. */
+  /** Replace the displacements where the mask is true.  The lines in every
+   * direction are interpolated in parallel. */
   void
   ReplaceDisplacements(const RegionType & region);
 
+  /** Interpolate the displacements of the missing blocks from the others.
+   * Return whether there is a block that is not missing. */
+  bool
+  FillMissingDisplacements(const RegionType & region);
+
+  /** Set the displacements of the missing blocks back to zero. */
+  void
+  ClearMissingDisplacements(const RegionType & region);
+
+  /** Allocate the intermediate images for the displacement grid. */
+  void
+  AllocateIntermediates(const RegionType & region);
+
   typename Superclass::Pointer m_DisplacementCalculator;
 
   typename StrainImageFilterType::Pointer m_StrainImageFilter;
@@ -169,17 +189,18 @@ protected:
   using MaskType = Image<bool, ImageDimension>;
   typename MaskType::Pointer m_Mask;
 
-  using NthElementAdaptorType = NthElementImageAdaptor<StrainImageType, MetricPixelType>;
-  typename NthElementAdaptorType::Pointer m_NthElementAdaptor;
-
-  using AbsFilterType = AbsImageFilter<NthElementAdaptorType, MetricImageType>;
-  typename AbsFilterType::Pointer m_AbsFilter;
-
   // There are cases where you will get a large negative pixel, followed by a
   // normal pixel, followed by a large positive strain pixel, for instance.
-  // This filter helps address that problem.
-  using BoxMeanImageFilterType = BoxMeanImageFilter<MetricImageType, MetricImageType>;
-  typename BoxMeanImageFilterType::Pointer m_BoxMeanFilter;
+  // The mask is evaluated on the mean absolute strain components in a box of
+  // radius 1, cropped at the boundary, to address that problem.
+  static constexpr IndexValueType BoxRadius = 1;
+
+  // The strain of the last mask, and where the current strain differs, so that
+  // the later iterations only evaluate the neighborhoods of the changes.
+  typename StrainImageType::Pointer m_PreviousStrain;
+  typename MaskType::Pointer        m_StrainChanged;
+  bool                              m_UpdateWholeMask;
+  unsigned long long                m_NumberOfMaskedValues;
 
 private:
 };
@@ -27,9 +27,16 @@
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
 #include <set>
+#include <vector>
 
 namespace itk
 {
@@ -41,6 +48,8 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
   StrainWindowDisplacementCalculator()
   : m_CurrentIteration(0)
   , m_MaximumIterations(1)
+  , m_UpdateWholeMask(true)
+  , m_NumberOfMaskedValues(0)
 {
   this->m_CacheMetricImage = true;
 
@@ -55,12 +64,8 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
   m_MaximumAbsStrain.Fill(NumericTraits<TStrainValueType>::max());
 
   m_Mask = MaskType::New();
-  m_NthElementAdaptor = NthElementAdaptorType::New();
-  m_AbsFilter = AbsFilterType::New();
-  m_AbsFilter->SetInput(m_NthElementAdaptor);
-  m_BoxMeanFilter = BoxMeanImageFilterType::New();
-  m_BoxMeanFilter->SetRadius(1);
-  m_BoxMeanFilter->SetInput(m_AbsFilter->GetOutput());
+  m_PreviousStrain = StrainImageType::New();
+  m_StrainChanged = MaskType::New();
 }
 
 
@@ -72,7 +77,11 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
   MetricImageType * image)
 {
   Superclass::SetMetricImagePixel(point, index, image);
-  this->m_DisplacementCalculator->SetMetricImagePixel(point, index, image);
+  // A caching calculator gets the cached images in Compute().
+  if (!this->m_CacheMetricImage || !this->m_DisplacementCalculator->GetCacheMetricImage())
+  {
+    this->m_DisplacementCalculator->SetMetricImagePixel(point, index, image);
+  }
 }
 
 
@@ -83,44 +92,107 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
 {
   // Create the strain image.
   m_StrainImageFilter->SetInput(this->m_DisplacementImage);
-  typename StrainImageType::Pointer strain = m_StrainImageFilter->GetOutput();
+  m_StrainImageFilter->Update();
+  const StrainImageType * strain = m_StrainImageFilter->GetOutput();
 
-  // Determine which displacements we need to displace.
-  if (m_Mask->GetBufferedRegion() != region)
+  this->AllocateIntermediates(region);
+  if (m_UpdateWholeMask)
   {
-    m_Mask->SetRegions(region);
-    m_Mask->Allocate();
+    m_Mask->FillBuffer(false);
+    m_NumberOfMaskedValues = 0;
   }
-  m_Mask->FillBuffer(false);
-  m_NthElementAdaptor->SetImage(strain);
-  m_BoxMeanFilter->GetOutput()->SetRegions(region);
-  unsigned long long            count = 0;
-  ImageRegionIterator<MaskType> maskIt(m_Mask, region);
-
-  //! @todo multithread me
-  for (unsigned int i = 0; i < m_MaximumAbsStrain.GetNumberOfComponents(); ++i)
+
+  // Flag the strain values that changed since the last mask.
+  std::atomic<SizeValueType> changedValues(0);
+  this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
+    region,
+    [this, strain, &changedValues](const RegionType & subregion) {
+      ImageRegionConstIterator<StrainImageType> strainIt(strain, subregion);
+      ImageRegionIterator<StrainImageType>      previousIt(this->m_PreviousStrain, subregion);
+      ImageRegionIterator<MaskType>             changedIt(this->m_StrainChanged, subregion);
+      SizeValueType                             threadChangedValues = 0;
+      for (strainIt.GoToBegin(), previousIt.GoToBegin(), changedIt.GoToBegin(); !strainIt.IsAtEnd();
+           ++strainIt, ++previousIt, ++changedIt)
+      {
+        const bool changed = this->m_UpdateWholeMask || strainIt.Get() != previousIt.Get();
+        changedIt.Set(changed);
+        previousIt.Set(strainIt.Get());
+        threadChangedValues += changed;
+      }
+      changedValues += threadChangedValues;
+    },
+    nullptr);
+  m_UpdateWholeMask = false;
+  if (changedValues == 0)
   {
-    m_NthElementAdaptor->SelectNthElement(i);
-    // this will be correct after this is multi-threaded and a fixer-uper for
-    // now
-    m_BoxMeanFilter->SetNumberOfWorkUnits(1);
-    m_BoxMeanFilter->Update();
-    ImageRegionIterator<MetricImageType> strainCompIt(m_BoxMeanFilter->GetOutput(), region);
-
-    for (maskIt.GoToBegin(), strainCompIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt, ++strainCompIt)
-    {
-      if (!maskIt.Value())
+    return m_NumberOfMaskedValues;
+  }
+
+  // Only the boxes that contain a change are evaluated again.
+  std::atomic<long long> maskedChange(0);
+  this->m_MultiThreader->template ParallelizeImageRegion<ImageDimension>(
+    region,
+    [this, strain, &region, &maskedChange](const RegionType & subregion) {
+      const unsigned int  numberOfComponents = this->m_MaximumAbsStrain.GetNumberOfComponents();
+      std::vector<double> absStrainSum(numberOfComponents);
+      long long           threadMaskedChange = 0;
+
+      typename RegionType::SizeType boxSize;
+      boxSize.Fill(2 * BoxRadius + 1);
+      ImageRegionIteratorWithIndex<MaskType> maskIt(this->m_Mask, subregion);
+      for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
       {
-        if (strainCompIt.Value() > m_MaximumAbsStrain[i])
+        typename RegionType::IndexType boxIndex = maskIt.GetIndex();
+        for (unsigned int dim = 0; dim < ImageDimension; ++dim)
         {
-          maskIt.Set(true);
-          ++count;
+          boxIndex[dim] -= BoxRadius;
         }
+        RegionType box(boxIndex, boxSize);
+        box.Crop(region);
+
+        bool                               boxChanged = false;
+        ImageRegionConstIterator<MaskType> changedIt(this->m_StrainChanged, box);
+        for (changedIt.GoToBegin(); !changedIt.IsAtEnd() && !boxChanged; ++changedIt)
+        {
+          boxChanged = changedIt.Get();
+        }
+        if (!boxChanged)
+        {
+          continue;
+        }
+
+        // The missing blocks are always replaced, and are not in the boxes.
+        std::fill(absStrainSum.begin(), absStrainSum.end(), 0.0);
+        SizeValueType                                      boxPixels = 0;
+        ImageRegionConstIteratorWithIndex<StrainImageType> strainIt(strain, box);
+        for (strainIt.GoToBegin(); !strainIt.IsAtEnd(); ++strainIt)
+        {
+          if (this->IsBlockMissing(strainIt.GetIndex()))
+          {
+            continue;
+          }
+          const StrainTensorType & tensor = strainIt.Get();
+          for (unsigned int i = 0; i < numberOfComponents; ++i)
+          {
+            absStrainSum[i] += std::abs(static_cast<double>(tensor[i]));
+          }
+          ++boxPixels;
+        }
+        bool outside = this->IsBlockMissing(maskIt.GetIndex());
+        for (unsigned int i = 0; i < numberOfComponents && boxPixels > 0; ++i)
+        {
+          outside = outside || static_cast<MetricPixelType>(absStrainSum[i] / boxPixels) > this->m_MaximumAbsStrain[i];
+        }
+        threadMaskedChange += static_cast<long long>(outside) - static_cast<long long>(maskIt.Get());
+        maskIt.Set(outside);
       }
-    }
-  }
+      maskedChange += threadMaskedChange;
+    },
+    nullptr);
+  m_NumberOfMaskedValues =
+    static_cast<unsigned long long>(static_cast<long long>(m_NumberOfMaskedValues) + maskedChange.load());
 
-  return count;
+  return m_NumberOfMaskedValues;
 }
 
 
@@ -135,6 +207,7 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
   using NeedsExtrapolationType = itk::FixedArray<NeedsExtrapolationSetType, ImageDimension>;
   NeedsExtrapolationType needsExtrapolation;
   IndexType              needsExtrapolationIndex;
+  std::mutex             needsExtrapolationMutex;
 
   using DisplacementIteratorType = itk::ImageLinearIteratorWithIndex<DisplacementImageType>;
   DisplacementIteratorType dispIt(this->m_DisplacementImage, region);
@@ -142,100 +215,116 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
   using DisplacementConstIteratorType = itk::ImageLinearConstIteratorWithIndex<DisplacementImageType>;
   DisplacementConstIteratorType extrapolationDispIt(this->m_DisplacementImage, region);
   using MaskIteratorType = itk::ImageLinearConstIteratorWithIndex<MaskType>;
-  MaskIteratorType maskIt(this->m_Mask, region);
-  TStrainValueType normalStrain;
   using DisplacementVectorType = typename DisplacementImageType::PixelType;
-  DisplacementVectorType            displacementStart;
-  DisplacementVectorType            displacementEnd;
-  double                            spacing;
-  double                            slope;
-  long                              offset;
-  IndexType                         offsetIndex;
-  typename StrainImageType::Pointer strain = m_StrainImageFilter->GetOutput();
+  long                    offset;
+  IndexType               offsetIndex;
+  const StrainImageType * strain = m_StrainImageFilter->GetOutput();
   for (unsigned int dim = 0; dim < ImageDimension; ++dim)
   {
-    dispIt.SetDirection(dim);
-    maskIt.SetDirection(dim);
-    for (dispIt.GoToBegin(), maskIt.GoToBegin(); !dispIt.IsAtEnd(); dispIt.NextLine(), maskIt.NextLine())
-    {
-      dispIt.GoToBeginOfLine();
-      maskIt.GoToBeginOfLine();
-      if (maskIt.Get())
-      {
-        while (!maskIt.IsAtEndOfLine() && maskIt.Get())
-        {
-          ++maskIt;
-        }
-
-        if (maskIt.IsAtEndOfLine())
-        {
-          needsExtrapolation[dim].insert(maskIt.GetIndex()[dim]);
-          continue;
-        }
-        else
-        {
-          // The normal strain in this direction.
-          normalStrain = strain->GetPixel(maskIt.GetIndex())(dim, dim);
-          dispIt.SetIndex(maskIt.GetIndex());
-          displacementEnd = dispIt.Get();
-          spacing = this->m_DisplacementImage->GetSpacing()[dim];
-          slope = normalStrain * spacing;
-          --dispIt;
-          while (!dispIt.IsAtReverseEndOfLine())
-          {
-            displacementEnd[dim] -= slope;
-            dispIt.Set(displacementEnd);
-            --dispIt;
-          }
-        }
-        dispIt.SetIndex(maskIt.GetIndex());
-      }
-      while (!dispIt.IsAtEndOfLine())
-      {
-        if (maskIt.Get())
+    // The lines along the direction are independent.
+    this->m_MultiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
+      dim,
+      region,
+      [this, dim, strain, &needsExtrapolation, &needsExtrapolationMutex](const RegionType & subregion) {
+        NeedsExtrapolationSetType threadNeedsExtrapolation;
+        DisplacementIteratorType  lineDispIt(this->m_DisplacementImage, subregion);
+        MaskIteratorType          maskIt(this->m_Mask, subregion);
+        TStrainValueType          normalStrain;
+        DisplacementVectorType    displacementStart;
+        DisplacementVectorType    displacementEnd;
+        const double              spacing = this->m_DisplacementImage->GetSpacing()[dim];
+        double                    slope;
+        lineDispIt.SetDirection(dim);
+        maskIt.SetDirection(dim);
+        for (lineDispIt.GoToBegin(), maskIt.GoToBegin(); !lineDispIt.IsAtEnd();
+             lineDispIt.NextLine(), maskIt.NextLine())
         {
-          --dispIt;
-          displacementStart = dispIt.Get();
-          while (!maskIt.IsAtEndOfLine() && maskIt.Get())
+          lineDispIt.GoToBeginOfLine();
+          maskIt.GoToBeginOfLine();
+          if (maskIt.Get())
           {
-            ++maskIt;
-          }
-
-          if (maskIt.IsAtEndOfLine())
-          {
-            // The normal strain in this direction.
-            normalStrain = strain->GetPixel(dispIt.GetIndex())(dim, dim);
-            spacing = this->m_DisplacementImage->GetSpacing()[dim];
-            slope = normalStrain * spacing;
-            ++dispIt;
-            while (!dispIt.IsAtEndOfLine())
+            while (!maskIt.IsAtEndOfLine() && maskIt.Get())
             {
-              displacementStart[dim] += slope;
-              dispIt.Set(displacementStart);
-              ++dispIt;
+              ++maskIt;
             }
 
-            continue;
+            if (maskIt.IsAtEndOfLine())
+            {
+              threadNeedsExtrapolation.insert(maskIt.GetIndex()[dim]);
+              continue;
+            }
+            else
+            {
+              // The normal strain in this direction.
+              normalStrain = strain->GetPixel(maskIt.GetIndex())(dim, dim);
+              lineDispIt.SetIndex(maskIt.GetIndex());
+              displacementEnd = lineDispIt.Get();
+              slope = normalStrain * spacing;
+              --lineDispIt;
+              while (!lineDispIt.IsAtReverseEndOfLine())
+              {
+                displacementEnd[dim] -= slope;
+                lineDispIt.Set(displacementEnd);
+                --lineDispIt;
+              }
+            }
+            lineDispIt.SetIndex(maskIt.GetIndex());
           }
-          else
+          while (!lineDispIt.IsAtEndOfLine())
           {
-            displacementEnd = this->m_DisplacementImage->GetPixel(maskIt.GetIndex());
-            slope = (displacementEnd[dim] - displacementStart[dim]) / (maskIt.GetIndex()[dim] - dispIt.GetIndex()[dim]);
-            ++dispIt;
-            maskIt.SetIndex(dispIt.GetIndex());
-            while (maskIt.Get())
+            if (maskIt.Get())
             {
-              displacementStart[dim] += slope;
-              dispIt.Set(displacementStart);
-              ++maskIt;
-              ++dispIt;
+              --lineDispIt;
+              displacementStart = lineDispIt.Get();
+              while (!maskIt.IsAtEndOfLine() && maskIt.Get())
+              {
+                ++maskIt;
+              }
+
+              if (maskIt.IsAtEndOfLine())
+              {
+                // The normal strain in this direction.
+                normalStrain = strain->GetPixel(lineDispIt.GetIndex())(dim, dim);
+                slope = normalStrain * spacing;
+                ++lineDispIt;
+                while (!lineDispIt.IsAtEndOfLine())
+                {
+                  displacementStart[dim] += slope;
+                  lineDispIt.Set(displacementStart);
+                  ++lineDispIt;
+                }
+
+                continue;
+              }
+              else
+              {
+                displacementEnd = this->m_DisplacementImage->GetPixel(maskIt.GetIndex());
+                slope = (displacementEnd[dim] - displacementStart[dim]) /
+                        (maskIt.GetIndex()[dim] - lineDispIt.GetIndex()[dim]);
+                ++lineDispIt;
+                maskIt.SetIndex(lineDispIt.GetIndex());
+                while (maskIt.Get())
+                {
+                  displacementStart[dim] += slope;
+                  lineDispIt.Set(displacementStart);
+                  ++maskIt;
+                  ++lineDispIt;
+                }
+              }
             }
+            ++lineDispIt;
+            ++maskIt;
           }
         }
-        ++dispIt;
-        ++maskIt;
-      }
-    }
+        if (!threadNeedsExtrapolation.empty())
+        {
+          std::lock_guard<std::mutex> lock(needsExtrapolationMutex);
+          needsExtrapolation[dim].insert(threadNeedsExtrapolation.begin(), threadNeedsExtrapolation.end());
+        }
+      },
+      nullptr);
+
+    dispIt.SetDirection(dim);
     for (setIt = needsExtrapolation[dim].begin(); setIt != needsExtrapolation[dim].end(); ++setIt)
     {
       needsExtrapolationIndex = region.GetIndex();
@@ -289,16 +378,93 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
 }
 
 
+template <class TMetricImage, class TDisplacementImage, class TStrainValueType>
+void
+StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValueType>::AllocateIntermediates(
+  const RegionType & region)
+{
+  // The intermediates are allocated once for the displacement grid.
+  if (m_Mask->GetBufferedRegion() != region)
+  {
+    m_Mask->SetRegions(region);
+    m_Mask->Allocate();
+    m_PreviousStrain->SetRegions(region);
+    m_PreviousStrain->Allocate();
+    m_StrainChanged->SetRegions(region);
+    m_StrainChanged->Allocate();
+    m_UpdateWholeMask = true;
+  }
+}
+
+
+template <class TMetricImage, class TDisplacementImage, class TStrainValueType>
+bool
+StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValueType>::FillMissingDisplacements(
+  const RegionType & region)
+{
+  this->AllocateIntermediates(region);
+  bool                                   present = false;
+  ImageRegionIteratorWithIndex<MaskType> maskIt(m_Mask, region);
+  for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+  {
+    const bool missing = this->IsBlockMissing(maskIt.GetIndex());
+    maskIt.Set(missing);
+    present = present || !missing;
+  }
+  if (!present)
+  {
+    return false;
+  }
+
+  // The extrapolation at the ends of the lines needs the strain.
+  m_StrainImageFilter->SetInput(this->m_DisplacementImage);
+  m_StrainImageFilter->Update();
+  this->ReplaceDisplacements(region);
+  return true;
+}
+
+
+template <class TMetricImage, class TDisplacementImage, class TStrainValueType>
+void
+StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValueType>::ClearMissingDisplacements(
+  const RegionType & region)
+{
+  ImageRegionIteratorWithIndex<DisplacementImageType> displacementIt(this->m_DisplacementImage, region);
+  for (displacementIt.GoToBegin(); !displacementIt.IsAtEnd(); ++displacementIt)
+  {
+    if (this->IsBlockMissing(displacementIt.GetIndex()))
+    {
+      displacementIt.Set(NumericTraits<typename DisplacementImageType::PixelType>::ZeroValue());
+    }
+  }
+  this->m_DisplacementImage->Modified();
+}
+
+
 template <class TMetricImage, class TDisplacementImage, class TStrainValueType>
 void
 StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValueType>::Compute()
 {
+  if (this->m_CacheMetricImage && this->m_DisplacementCalculator->GetCacheMetricImage())
+  {
+    this->m_DisplacementCalculator->SetMetricImageImage(this->m_MetricImageImage);
+    this->m_DisplacementCalculator->SetCenterPointsImage(this->m_CenterPointsImage);
+  }
+  this->m_DisplacementCalculator->SetBlockMask(this->m_BlockMask);
   this->m_DisplacementCalculator->Compute();
 
   this->InvokeEvent(StartEvent());
 
   typename DisplacementImageType::RegionType region = this->m_DisplacementImage->GetBufferedRegion();
 
+  if (this->m_BlockMask && !this->FillMissingDisplacements(region))
+  {
+    this->InvokeEvent(EndEvent());
+    return;
+  }
+
+  // The displacements are new, so the whole mask is evaluated first.
+  this->m_UpdateWholeMask = true;
   unsigned long long valuesToReplace = this->GenerateMask(region);
   this->ReplaceDisplacements(region);
 
@@ -313,6 +479,11 @@ StrainWindowDisplacementCalculator<TMetricImage, TDisplacementImage, TStrainValu
     ++this->m_CurrentIteration;
   }
 
+  if (this->m_BlockMask)
+  {
+    this->ClearMissingDisplacements(region);
+  }
+
   this->InvokeEvent(EndEvent());
 }
 
@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingSumOfDifferencesMetricImageFilter_h
+#define itkBlockMatchingSumOfDifferencesMetricImageFilter_h
+
+#include "itkBlockMatchingMetricImageFilter.h"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+/** \class SumOfDifferencesMetricImageFilter
+ *
+ * \brief Create an image of the sum of a function of the differences between
+ * the block and the moving image, calculated directly on the input buffers.
+ *
+ * The metric at a pixel of the moving image region is the negative of the sum
+ * over the block of TDifferenceFunction::Evaluate() of the differences with
+ * the window centered on that pixel, so that the best match is the maximum,
+ * as for the other metrics.  It is the lowest metric value where the window
+ * is not inside the moving image.  The sums are integers for integer pixels,
+ * such as the signed short radio frequency samples, and they are computed
+ * one contiguous row of the window at a time.
+ *
+ * With EarlyTermination on, a window is abandoned once its partial sum
+ * exceeds the smallest sum of the windows computed so far, starting with the
+ * window without displacement, and the metric there is the negative of the
+ * partial sum.  This does not change the maximum, but the metric around it is
+ * not the full metric any more, so it is meant for the MaximumPixel
+ * displacement, as for the coarse top level of a multi-resolution search.
+ *
+ * It has a single output, and it implements ComputeMetricImage(), so that
+ * BlockMatching::ImageRegistrationMethod matches the blocks without executing
+ * the pipeline.  The fixed and moving images must have the same spacing.
+ *
+ * \sa SumOfSquaredDifferencesMetricImageFilter
+ * \sa SumOfAbsoluteDifferencesMetricImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TDifferenceFunction>
+class ITK_TEMPLATE_EXPORT SumOfDifferencesMetricImageFilter
+  : public MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SumOfDifferencesMetricImageFilter);
+
+  /** Standard class type alias. */
+  using Self = SumOfDifferencesMetricImageFilter;
+  using Superclass = MetricImageFilter<TFixedImage, TMovingImage, TMetricImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SumOfDifferencesMetricImageFilter, MetricImageFilter);
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TFixedImage::ImageDimension);
+
+  /** Type of the fixed image. */
+  using FixedImageType = typename Superclass::FixedImageType;
+  using FixedImageRegionType = typename Superclass::FixedImageRegionType;
+  using FixedPixelType = typename FixedImageType::PixelType;
+
+  /** Type of the moving image. */
+  using MovingImageType = typename Superclass::MovingImageType;
+  using MovingImageRegionType = typename Superclass::MovingImageRegionType;
+  using MovingPixelType = typename MovingImageType::PixelType;
+
+  /** Type of the metric image. */
+  using MetricImageType = typename Superclass::MetricImageType;
+  using MetricImageRegionType = typename Superclass::MetricImageRegionType;
+  using MetricImagePixelType = typename MetricImageType::PixelType;
+
+  /** Type of the differences and of their sums: 64 bit integers for integer
+   * pixels, and double otherwise. */
+  using AccumulateType = typename std::conditional<std::is_integral<FixedPixelType>::value &&
+                                                     std::is_integral<MovingPixelType>::value,
+                                                   std::int64_t,
+                                                   double>::type;
+
+  /** Set/Get whether to abandon a window once its partial sum exceeds the
+   * smallest sum so far.  Defaults to false. */
+  itkSetMacro(EarlyTermination, bool);
+  itkGetConstMacro(EarlyTermination, bool);
+  itkBooleanMacro(EarlyTermination);
+
+  bool
+  ComputeMetricImage(const FixedImageRegionType &  fixedRegion,
+                     const MovingImageRegionType & movingRegion,
+                     MetricImageType *             metricImage) override;
+
+protected:
+  SumOfDifferencesMetricImageFilter();
+
+  LightObject::Pointer
+  InternalClone() const override;
+
+  void
+  GenerateData() override;
+
+  /** The sum over the window starting at window, or the partial sum once it
+   * exceeds bound. */
+  AccumulateType
+  SumWindow(const MovingPixelType * window, AccumulateType bound) const;
+
+private:
+  bool m_EarlyTermination;
+
+  // The block, row after row, and the offsets of the rows of a window in the
+  // moving buffer.
+  std::vector<AccumulateType>  m_FixedValues;
+  std::vector<OffsetValueType> m_RowOffsets;
+  SizeValueType                m_RowLength;
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkBlockMatchingSumOfDifferencesMetricImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,217 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingSumOfDifferencesMetricImageFilter_hxx
+#define itkBlockMatchingSumOfDifferencesMetricImageFilter_hxx
+
+#include "itkBlockMatchingSumOfDifferencesMetricImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TDifferenceFunction>
+SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TDifferenceFunction>::
+  SumOfDifferencesMetricImageFilter()
+  : m_EarlyTermination(false)
+  , m_RowLength(0)
+{}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TDifferenceFunction>
+LightObject::Pointer
+SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TDifferenceFunction>::InternalClone() const
+{
+  LightObject::Pointer   loPtr = Superclass::InternalClone();
+  typename Self::Pointer rval = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (rval.IsNull())
+  {
+    itkExceptionMacro(<< "downcast to type " << this->GetNameOfClass() << " failed.");
+  }
+  rval->m_EarlyTermination = m_EarlyTermination;
+  return loPtr;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TDifferenceFunction>
+auto
+SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TDifferenceFunction>::SumWindow(
+  const MovingPixelType * window,
+  AccumulateType          bound) const -> AccumulateType
+{
+  const SizeValueType    numberOfRows = m_RowOffsets.size();
+  const SizeValueType    rowLength = m_RowLength;
+  const AccumulateType * fixedRow = m_FixedValues.data();
+  AccumulateType         sum = 0;
+  for (SizeValueType row = 0; row < numberOfRows; ++row, fixedRow += rowLength)
+  {
+    const MovingPixelType * movingRow = window + m_RowOffsets[row];
+    AccumulateType          rowSum = 0;
+    for (SizeValueType jj = 0; jj < rowLength; ++jj)
+    {
+      rowSum += TDifferenceFunction::Evaluate(fixedRow[jj] - static_cast<AccumulateType>(movingRow[jj]));
+    }
+    sum += rowSum;
+    if (sum > bound)
+    {
+      return sum;
+    }
+  }
+  return sum;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TDifferenceFunction>
+bool
+SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TDifferenceFunction>::ComputeMetricImage(
+  const FixedImageRegionType &  fixedRegion,
+  const MovingImageRegionType & movingRegion,
+  MetricImageType *             metricImage)
+{
+  const FixedImageType *  fixedPtr = this->GetInput(0);
+  const MovingImageType * movingPtr = this->GetInput(1);
+  if (!fixedPtr || !movingPtr || !metricImage)
+  {
+    return false;
+  }
+  if (!(fixedPtr->GetSpacing() == movingPtr->GetSpacing()) || !fixedPtr->GetBufferedRegion().IsInside(fixedRegion))
+  {
+    return false;
+  }
+  typename MovingImageRegionType::SizeType radius;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    if (fixedRegion.GetSize()[i] % 2 == 0)
+    {
+      return false;
+    }
+    radius[i] = (fixedRegion.GetSize()[i] - 1) / 2;
+  }
+
+  MovingImageRegionType validRegion;
+  const bool            isValid = this->AllocateMetricImage(movingRegion, radius, metricImage, validRegion);
+  if (!isValid || validRegion != movingRegion)
+  {
+    metricImage->FillBuffer(NumericTraits<MetricImagePixelType>::NonpositiveMin());
+  }
+  if (!isValid)
+  {
+    return true;
+  }
+
+  // The block row after row, and the offsets of the rows of a window.
+  m_RowLength = fixedRegion.GetSize()[0];
+  m_FixedValues.clear();
+  m_RowOffsets.clear();
+  FixedImageRegionType rowsRegion = fixedRegion;
+  rowsRegion.SetSize(0, 1);
+  const OffsetValueType *                           movingOffsetTable = movingPtr->GetOffsetTable();
+  ImageRegionConstIteratorWithIndex<FixedImageType> rowIt(fixedPtr, rowsRegion);
+  for (rowIt.GoToBegin(); !rowIt.IsAtEnd(); ++rowIt)
+  {
+    const FixedPixelType * fixedRow = fixedPtr->GetBufferPointer() + fixedPtr->ComputeOffset(rowIt.GetIndex());
+    for (SizeValueType jj = 0; jj < m_RowLength; ++jj)
+    {
+      m_FixedValues.push_back(static_cast<AccumulateType>(fixedRow[jj]));
+    }
+    OffsetValueType rowOffset = 0;
+    for (unsigned int i = 1; i < ImageDimension; ++i)
+    {
+      rowOffset += (rowIt.GetIndex()[i] - fixedRegion.GetIndex()[i]) * movingOffsetTable[i];
+    }
+    m_RowOffsets.push_back(rowOffset);
+  }
+
+  const MovingPixelType * movingBuffer = movingPtr->GetBufferPointer();
+  auto                    windowStart = [&](typename MovingImageType::IndexType center) -> const MovingPixelType * {
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      center[i] -= static_cast<OffsetValueType>(radius[i]);
+    }
+    return movingBuffer + movingPtr->ComputeOffset(center);
+  };
+  const AccumulateType unbounded = std::numeric_limits<AccumulateType>::max();
+
+  // Without displacement first, which is usually close to the best match and
+  // gives a tight bound to the early termination.
+  AccumulateType                      best = unbounded;
+  typename MovingImageType::IndexType zeroDisplacement;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    zeroDisplacement[i] = movingRegion.GetIndex()[i] + static_cast<OffsetValueType>(movingRegion.GetSize()[i] / 2);
+  }
+  const bool zeroDisplacementIsValid = m_EarlyTermination && validRegion.IsInside(zeroDisplacement);
+  if (zeroDisplacementIsValid)
+  {
+    best = this->SumWindow(windowStart(zeroDisplacement), unbounded);
+  }
+
+  MetricImageRegionType                     validMetricRegion;
+  typename MetricImageRegionType::IndexType metricIndex;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    metricIndex[i] = validRegion.GetIndex()[i] - movingRegion.GetIndex()[i];
+  }
+  validMetricRegion.SetIndex(metricIndex);
+  validMetricRegion.SetSize(validRegion.GetSize());
+  ImageRegionIteratorWithIndex<MetricImageType> metricIt(metricImage, validMetricRegion);
+  typename MovingImageType::IndexType           center;
+  for (metricIt.GoToBegin(); !metricIt.IsAtEnd(); ++metricIt)
+  {
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      center[i] = movingRegion.GetIndex()[i] + metricIt.GetIndex()[i];
+    }
+    AccumulateType sum;
+    if (zeroDisplacementIsValid && center == zeroDisplacement)
+    {
+      sum = best;
+    }
+    else
+    {
+      sum = this->SumWindow(windowStart(center), m_EarlyTermination ? best : unbounded);
+      best = std::min(best, sum);
+    }
+    metricIt.Set(-static_cast<MetricImagePixelType>(sum));
+  }
+  return true;
+}
+
+
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage, typename TDifferenceFunction>
+void
+SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, TDifferenceFunction>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  if (!this->ComputeMetricImage(this->m_FixedImageRegion, this->m_MovingImageRegion, this->GetOutput()))
+  {
+    itkExceptionMacro(<< "This metric image filter assumes the moving and fixed image have the same spacing.");
+  }
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
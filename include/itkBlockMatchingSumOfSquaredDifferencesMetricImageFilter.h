@@ -0,0 +1,84 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBlockMatchingSumOfSquaredDifferencesMetricImageFilter_h
+#define itkBlockMatchingSumOfSquaredDifferencesMetricImageFilter_h
+
+#include "itkBlockMatchingSumOfDifferencesMetricImageFilter.h"
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+namespace Functor
+{
+
+/** \class SquaredDifference
+ *
+ * \brief The square of a difference, for the SumOfDifferencesMetricImageFilter.
+ *
+ * \ingroup Ultrasound
+ */
+struct SquaredDifference
+{
+  template <typename TValue>
+  static TValue
+  Evaluate(const TValue & difference)
+  {
+    return difference * difference;
+  }
+};
+
+} // end namespace Functor
+
+/** \class SumOfSquaredDifferencesMetricImageFilter
+ *
+ * \brief Create a metric image of the negative of the sums of squared differences (SSD).
+ *
+ * \sa SumOfDifferencesMetricImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TFixedImage, typename TMovingImage, typename TMetricImage>
+class ITK_TEMPLATE_EXPORT SumOfSquaredDifferencesMetricImageFilter
+  : public SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, Functor::SquaredDifference>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SumOfSquaredDifferencesMetricImageFilter);
+
+  /** Standard class type alias. */
+  using Self = SumOfSquaredDifferencesMetricImageFilter;
+  using Superclass =
+    SumOfDifferencesMetricImageFilter<TFixedImage, TMovingImage, TMetricImage, Functor::SquaredDifference>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SumOfSquaredDifferencesMetricImageFilter, SumOfDifferencesMetricImageFilter);
+
+protected:
+  SumOfSquaredDifferencesMetricImageFilter() {}
+};
+
+} // end namespace BlockMatching
+} // end namespace itk
+
+#endif
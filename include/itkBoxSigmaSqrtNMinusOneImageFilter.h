@@ -18,21 +18,85 @@
 #ifndef itkBoxSigmaSqrtNMinusOneImageFilter_h
 #define itkBoxSigmaSqrtNMinusOneImageFilter_h
 
+#include <algorithm>
+
 #include "itkBoxUtilities.h"
 #include "itkBoxImageFilter.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkVersion.h"
 
 namespace itk
 {
 
+// Summed-area table of the values and the squared values, less shift, built
+// with a compensated running sum along each direction in turn.  Subtracting
+// a value close to the image's from the samples and compensating the sums
+// keep the sum of squares accurate for the calculator's difference.
+template <class TInputImage, class TOutputImage>
+void
+BoxSquareCompensatedAccumulateFunction(const TInputImage *                                 inputImage,
+                                       TOutputImage *                                      outputImage,
+                                       const typename TOutputImage::RegionType &           region,
+                                       const typename TOutputImage::PixelType::ValueType & shift)
+{
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using ValueType = typename OutputPixelType::ValueType;
+
+  ImageRegionConstIterator<TInputImage> inputIt(inputImage, region);
+  ImageRegionIterator<TOutputImage>     outputIt(outputImage, region);
+  OutputPixelType                       sample;
+  for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++outputIt)
+  {
+    const ValueType value = static_cast<ValueType>(inputIt.Get()) - shift;
+    sample[0] = value;
+    sample[1] = value * value;
+    outputIt.Set(sample);
+  }
+
+  using LineIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
+  for (unsigned int dim = 0; dim < TOutputImage::ImageDimension; ++dim)
+  {
+    LineIteratorType lineIt(outputImage, region);
+    lineIt.SetDirection(dim);
+    lineIt.GoToBegin();
+    while (!lineIt.IsAtEnd())
+    {
+      OutputPixelType sum;
+      OutputPixelType compensation;
+      sum.Fill(NumericTraits<ValueType>::ZeroValue());
+      compensation.Fill(NumericTraits<ValueType>::ZeroValue());
+      while (!lineIt.IsAtEndOfLine())
+      {
+        const OutputPixelType & value = lineIt.Get();
+        for (unsigned int k = 0; k < 2; ++k)
+        {
+          const ValueType compensated = value[k] - compensation[k];
+          const ValueType total = sum[k] + compensated;
+          compensation[k] = (total - sum[k]) - compensated;
+          sum[k] = total;
+        }
+        lineIt.Set(sum);
+        ++lineIt;
+      }
+      lineIt.NextLine();
+    }
+  }
+}
+
+
 // copied and tweaked from BoxSigmaCalculatorFunction
+// If meanImage is not null, the box mean, plus shift, is also computed from
+// the same summed-area table.
 template <class TInputImage, class TOutputImage>
 void
-BoxSigmaSqrtNMinusOneCalculatorFunction(const TInputImage *                       accImage,
-                                        TOutputImage *                            outputImage,
-                                        const typename TInputImage::RegionType &  inputRegion,
-                                        const typename TOutputImage::RegionType & outputRegion,
-                                        const typename TInputImage::SizeType &    Radius)
+BoxSigmaSqrtNMinusOneCalculatorFunction(
+  const TInputImage *                                                       accImage,
+  TOutputImage *                                                            outputImage,
+  const typename TInputImage::RegionType &                                  inputRegion,
+  const typename TOutputImage::RegionType &                                 outputRegion,
+  const typename TInputImage::SizeType &                                    Radius,
+  TOutputImage *                                                            meanImage = nullptr,
+  const typename NumericTraits<typename TOutputImage::PixelType>::RealType & shift = 0)
 {
   // type alias
   using InputImageType = TInputImage;
@@ -123,8 +187,14 @@ BoxSigmaSqrtNMinusOneCalculatorFunction(const TInputImage *
         tempIt.GoToBegin();
         CornerItVec.push_back(tempIt);
       }
-      // set up the output iterator
+      // set up the output iterators
       OutputIteratorType oIt(outputImage, *fit);
+      OutputIteratorType mIt;
+      if (meanImage)
+      {
+        mIt = OutputIteratorType(meanImage, *fit);
+        mIt.GoToBegin();
+      }
       // now do the work
       for (oIt.GoToBegin(); !oIt.IsAtEnd(); ++oIt)
       {
@@ -140,7 +210,13 @@ BoxSigmaSqrtNMinusOneCalculatorFunction(const TInputImage *
           ++(CornerItVec[k]);
         }
 
-        oIt.Set(static_cast<OutputPixelType>(std::sqrt(SquareSum - Sum * Sum / pixelscount)));
+        const AccPixType variance = std::max(SquareSum - Sum * Sum / pixelscount, AccPixType{});
+        oIt.Set(static_cast<OutputPixelType>(std::sqrt(variance)));
+        if (meanImage)
+        {
+          mIt.Set(static_cast<OutputPixelType>(Sum / pixelscount + shift));
+          ++mIt;
+        }
       }
     }
     else
@@ -208,7 +284,12 @@ BoxSigmaSqrtNMinusOneCalculatorFunction(const TInputImage *
           }
         }
 
-        oIt.Set(static_cast<OutputPixelType>(std::sqrt(SquareSum - Sum * Sum / edgepixelscount)));
+        const AccPixType variance = std::max(SquareSum - Sum * Sum / edgepixelscount, AccPixType{});
+        oIt.Set(static_cast<OutputPixelType>(std::sqrt(variance)));
+        if (meanImage)
+        {
+          meanImage->SetPixel(oIt.GetIndex(), static_cast<OutputPixelType>(Sum / edgepixelscount + shift));
+        }
       }
     }
   }
@@ -221,6 +302,11 @@ BoxSigmaSqrtNMinusOneCalculatorFunction(const TInputImage *
  * deviation over a box, but calculates the standard deviation time sqrt( N-1 ).
  * Used in calculating the normalized cross correlation.
  *
+ * The sums over the boxes are taken from a summed-area table of the values
+ * and squared values, so the cost per pixel does not depend on the radius.
+ * The box mean, which comes from the same table, is the second output,
+ * GetMeanOutput().
+ *
  * \sa BoxSigmaImageFilter
  * \sa NormalizedCrossCorrelationMetricImageFilter
  *
@@ -258,6 +344,13 @@ public:
   itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
 
 
+  /** The box mean of the input. */
+  OutputImageType *
+  GetMeanOutput()
+  {
+    return this->GetOutput(1);
+  }
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
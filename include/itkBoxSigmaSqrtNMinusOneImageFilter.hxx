@@ -34,7 +34,11 @@ namespace itk
 
 template <class TInputImage, class TOutputImage>
 BoxSigmaSqrtNMinusOneImageFilter<TInputImage, TOutputImage>::BoxSigmaSqrtNMinusOneImageFilter()
-{}
+{
+  // The second output is the box mean.
+  this->SetNumberOfRequiredOutputs(2);
+  this->SetNthOutput(1, this->MakeOutput(1));
+}
 
 
 template <class TInputImage, class TOutputImage>
@@ -65,27 +69,22 @@ BoxSigmaSqrtNMinusOneImageFilter<TInputImage, TOutputImage>
   accumRegion.PadByRadius(internalRadius);
   accumRegion.Crop(inputImage->GetRequestedRegion());
 
-#if ITK_VERSION_MAJOR < 5 || defined(ITKV4_COMPATIBILITY)
-  // Dummy reporter for compatibility
-  ProgressReporter progress(this, 1, 2 * accumRegion.GetNumberOfPixels());
-#endif
-
   typename AccumImageType::Pointer accImage = AccumImageType::New();
   accImage->SetRegions(accumRegion);
   accImage->Allocate();
 
-  BoxSquareAccumulateFunction<TInputImage, AccumImageType>(inputImage,
-                                                           accImage.GetPointer(),
-                                                           accumRegion,
-                                                           accumRegion
-#if ITK_VERSION_MAJOR < 5 || defined(ITKV4_COMPATIBILITY)
-                                                           ,
-                                                           progress);
-#else
-  );
-#endif
-  BoxSigmaSqrtNMinusOneCalculatorFunction<AccumImageType, TOutputImage>(
-    accImage.GetPointer(), outputImage, accumRegion, outputRegionForThread, this->GetRadius());
+  // The sums are taken about the first sample, which leaves the sigma
+  // unchanged and is added back to the mean.
+  const AccValueType shift = static_cast<AccValueType>(inputImage->GetPixel(accumRegion.GetIndex()));
+  BoxSquareCompensatedAccumulateFunction<TInputImage, AccumImageType>(
+    inputImage, accImage.GetPointer(), accumRegion, shift);
+  BoxSigmaSqrtNMinusOneCalculatorFunction<AccumImageType, TOutputImage>(accImage.GetPointer(),
+                                                                        outputImage,
+                                                                        accumRegion,
+                                                                        outputRegionForThread,
+                                                                        this->GetRadius(),
+                                                                        this->GetMeanOutput(),
+                                                                        shift);
 }
 
 
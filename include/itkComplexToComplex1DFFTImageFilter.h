@@ -22,6 +22,7 @@
 
 #include "itkImage.h"
 #include "itkImageToImageFilter.h"
+#include "itkFFT1DBackendSelector.h"
 
 namespace itk
 {
@@ -61,11 +62,23 @@ public:
   /** Customized object creation methods that support configuration-based
    * selection of FFT implementation.
    *
-   * Default implementation is VnlFFT1D.
+   * Default implementation is VnlFFT1D.  The backend set as the override of
+   * FFT1DBackendSelector, if any, takes precedence over the build time
+   * preference.
    */
   static Pointer
   New();
 
+  /** Create the filter of the given backend, or a null pointer when the
+   * backend is not available for the pixel type. */
+  static Pointer
+  New(FFT1DBackendSelector::BackendType backend);
+
+  /** Create the filter of the backend that is the fastest on this machine for
+   * numberOfLines lines of lineLength samples.  See FFT1DBackendSelector. */
+  static Pointer
+  NewForGeometry(SizeValueType lineLength, SizeValueType numberOfLines);
+
   /** Transform direction. */
   using TransformDirectionType = enum { DIRECT = 1, INVERSE };
 
@@ -102,6 +115,11 @@ protected:
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
+  /** Allocate the output with AllocateFirstTouch(), so that its pages are
+   * first touched by the work units that generate them. */
+  void
+  AllocateOutputs() override;
+
   /** Direction in which the filter is to be applied
    * this should be in the range [0,ImageDimension-1]. */
   unsigned int m_Direction;
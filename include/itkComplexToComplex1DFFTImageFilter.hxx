@@ -19,6 +19,7 @@
 #define itkComplexToComplex1DFFTImageFilter_hxx
 
 #include "itkComplexToComplex1DFFTImageFilter.h"
+#include "itkFirstTouchImageContainer.h"
 
 #include "itkVnlComplexToComplex1DFFTImageFilter.h"
 
@@ -36,12 +37,52 @@
 namespace itk
 {
 
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage, typename TPixel>
+struct Dispatch_1DComplexToComplex_FFTW_New
+{
+  static TSelfPointer
+  Apply()
+  {
+    return nullptr;
+  }
+};
+
+#ifdef ITK_USE_FFTWD
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DComplexToComplex_FFTW_New<TSelfPointer, TInputImage, TOutputImage, double>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
+#ifdef ITK_USE_FFTWF
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DComplexToComplex_FFTW_New<TSelfPointer, TInputImage, TOutputImage, float>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
 template <typename TInputImage, typename TOutputImage>
 typename ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
 ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New()
 {
   Pointer smartPtr = ObjectFactory<Self>::Create();
 
+  const FFT1DBackendSelector::BackendType backend = FFT1DBackendSelector::GetOverride();
+  if (smartPtr.IsNull() && backend != FFT1DBackendSelector::DEFAULT_BACKEND)
+  {
+    smartPtr = New(backend);
+  }
+
 #ifdef ITKUltrasound_USE_clFFT
   if (smartPtr.IsNull())
   {
@@ -79,6 +120,38 @@ ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New()
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+typename ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New(FFT1DBackendSelector::BackendType backend)
+{
+  using ValueType = typename NumericTraits<typename TInputImage::PixelType>::ValueType;
+  switch (backend)
+  {
+    case FFT1DBackendSelector::VNL_BACKEND:
+      return VnlComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case FFT1DBackendSelector::FFTW_BACKEND:
+      return Dispatch_1DComplexToComplex_FFTW_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+    case FFT1DBackendSelector::OPENCL_BACKEND:
+#ifdef ITKUltrasound_USE_clFFT
+      return OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+#else
+      return nullptr;
+#endif
+    default:
+      return New();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::NewForGeometry(SizeValueType lineLength,
+                                                                            SizeValueType numberOfLines)
+{
+  return FFT1DBackendSelector::New<Self>("ComplexToComplex", lineLength, numberOfLines);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::ComplexToComplex1DFFTImageFilter()
   : m_Direction(0)
@@ -154,6 +227,16 @@ ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::EnlargeOutputReques
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::AllocateOutputs()
+{
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  AllocateFirstTouch(output, this->GetMultiThreader(), this->GetNumberOfWorkUnits(), this->m_Direction);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
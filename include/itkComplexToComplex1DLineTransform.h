@@ -0,0 +1,220 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkComplexToComplex1DLineTransform_h
+#define itkComplexToComplex1DLineTransform_h
+
+#include <complex>
+#include <type_traits>
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+#include "vnl/algo/vnl_fft_1d.h"
+#include "vnl/vnl_vector.h"
+
+#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
+#  include "itkFFTW1DPlanCache.h"
+#  include "itkFFTWBufferPool.h"
+#endif
+
+namespace itk
+{
+
+/** Whether ComplexToComplex1DLineTransform uses FFTW for the given
+ * precision by default. */
+template <typename TPixel>
+struct ComplexToComplex1DLineTransformUsesFFTW : std::false_type
+{};
+#ifdef ITK_USE_FFTWD
+template <>
+struct ComplexToComplex1DLineTransformUsesFFTW<double> : std::true_type
+{};
+#endif
+#ifdef ITK_USE_FFTWF
+template <>
+struct ComplexToComplex1DLineTransformUsesFFTW<float> : std::true_type
+{};
+#endif
+
+/**
+ * \class ComplexToComplex1DLineTransform
+ * \brief Forward DFT of one line, or a batch of lines, at a time in a
+ * scratch buffer.
+ *
+ * The transform tables, or the FFTW plan, and the buffer are set up once
+ * at construction, so an instance is meant to be created per work unit and
+ * reused for every line of the same size.
+ *
+ * Fill the GetNumberOfLines() consecutive lines of GetSize() samples of
+ * GetBuffer() and call Forward(); the unnormalized spectra then replace the
+ * samples.  With FFTW, all the lines are transformed by a single plan.
+ *
+ * FFTW is used when it is available for TPixel, the VNL FFT otherwise.
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ */
+template <typename TPixel, bool VUseFFTW = ComplexToComplex1DLineTransformUsesFFTW<TPixel>::value>
+class ComplexToComplex1DLineTransform
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ComplexToComplex1DLineTransform);
+
+  using PixelType = TPixel;
+  using ComplexType = std::complex<TPixel>;
+
+  /** The size must only have prime factors up to
+   * GetSizeGreatestPrimeFactor(). */
+  explicit ComplexToComplex1DLineTransform(SizeValueType size, SizeValueType numberOfLines = 1)
+    : m_Size(size)
+    , m_NumberOfLines(numberOfLines)
+    , m_Buffer(size * numberOfLines)
+    , m_FFT(size)
+  {}
+
+  /** The VNL FFT supports sizes whose prime factors are 2, 3 and 5. */
+  static SizeValueType
+  GetSizeGreatestPrimeFactor()
+  {
+    return 5;
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  SizeValueType
+  GetNumberOfLines() const
+  {
+    return m_NumberOfLines;
+  }
+
+  ComplexType *
+  GetBuffer()
+  {
+    return m_Buffer.data_block();
+  }
+
+  void
+  Forward()
+  {
+    // VNL's backward transform has the sign of the forward DFT.
+    for (SizeValueType line = 0; line < m_NumberOfLines; ++line)
+    {
+      m_FFT.transform(m_Buffer.data_block() + line * m_Size, -1);
+    }
+  }
+
+private:
+  SizeValueType           m_Size;
+  SizeValueType           m_NumberOfLines;
+  vnl_vector<ComplexType> m_Buffer;
+  vnl_fft_1d<TPixel>      m_FFT;
+};
+
+
+#if defined(ITK_USE_FFTWD) || defined(ITK_USE_FFTWF)
+/** The FFTW implementation runs an in-place plan shared through
+ * fftw::Plan1DCache on a buffer from fftw::BufferPool. */
+template <typename TPixel>
+class ComplexToComplex1DLineTransform<TPixel, true>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ComplexToComplex1DLineTransform);
+
+  using PixelType = TPixel;
+  using ComplexType = std::complex<TPixel>;
+
+  using PlanCacheType = fftw::Plan1DCache<TPixel>;
+  using BufferPoolType = fftw::BufferPool<TPixel>;
+  using ProxyType = typename PlanCacheType::ProxyType;
+  using FFTWComplexType = typename ProxyType::ComplexType;
+  using PlanType = typename ProxyType::PlanType;
+
+  explicit ComplexToComplex1DLineTransform(SizeValueType size,
+                                           SizeValueType numberOfLines = 1,
+                                           unsigned      flags = FFTW_ESTIMATE)
+    : m_Size(size)
+    , m_NumberOfLines(numberOfLines)
+  {
+    m_Buffer = BufferPoolType::Acquire(size * numberOfLines);
+    if (m_Buffer == nullptr)
+    {
+      itkGenericExceptionMacro("Problem allocating memory for the 1D line transform");
+    }
+    const int length = static_cast<int>(size);
+    const int alignment = ProxyType::Alignment_of(reinterpret_cast<PixelType *>(m_Buffer));
+    m_Plan = PlanCacheType::GetManyComplexToComplexPlan(length,
+                                                        static_cast<int>(numberOfLines),
+                                                        1,
+                                                        length,
+                                                        1,
+                                                        length,
+                                                        FFTW_FORWARD,
+                                                        flags,
+                                                        alignment,
+                                                        alignment,
+                                                        true);
+  }
+
+  ~ComplexToComplex1DLineTransform() { BufferPoolType::Release(m_Buffer); }
+
+  /** FFTW transforms any size, but it only has optimized codelets for the
+   * prime factors up to 13. */
+  static SizeValueType
+  GetSizeGreatestPrimeFactor()
+  {
+    return 13;
+  }
+
+  SizeValueType
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  SizeValueType
+  GetNumberOfLines() const
+  {
+    return m_NumberOfLines;
+  }
+
+  ComplexType *
+  GetBuffer()
+  {
+    return reinterpret_cast<ComplexType *>(m_Buffer);
+  }
+
+  void
+  Forward()
+  {
+    ProxyType::Execute_dft(m_Plan, m_Buffer, m_Buffer);
+  }
+
+private:
+  SizeValueType     m_Size;
+  SizeValueType     m_NumberOfLines;
+  FFTWComplexType * m_Buffer = nullptr;
+  PlanType          m_Plan;
+};
+#endif
+
+} // end namespace itk
+
+#endif // itkComplexToComplex1DLineTransform_h
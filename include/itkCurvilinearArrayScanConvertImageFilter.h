@@ -0,0 +1,214 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkCurvilinearArrayScanConvertImageFilter_h
+#define itkCurvilinearArrayScanConvertImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class CurvilinearArrayScanConvertImageFilter
+ * \brief Scan convert a CurvilinearArraySpecialCoordinatesImage onto a
+ * Cartesian image with a precomputed lookup table.
+ *
+ * The result is the one of a ResampleImageFilter with an identity transform
+ * and a LinearInterpolateImageFunction, without the cost of the
+ * TransformPhysicalPointToContinuousIndex() of the special coordinates image
+ * for every output pixel.  The first time the filter runs, it finds the
+ * location in the input buffer of the first of the neighbors to blend, and
+ * the weights of all of them, for every output pixel.  Each following update
+ * is then a gather of the neighbors and a weighted sum, multithreaded over the
+ * output lines.  The table is built with the batched
+ * TransformPhysicalPointsToContinuousIndices() of the input, whose arc
+ * tangent is accurate to about 1e-8 radians.
+ *
+ * The table is rebuilt only when the geometry it depends on changes: the
+ * size, LateralAngularSeparation, RadiusSampleSize, FirstSampleDistance,
+ * origin, spacing and direction of the input, and the region, origin, spacing
+ * and direction of the output.  New frames with the same geometry, such as
+ * the frames of a live acquisition, reuse it.  It takes
+ * sizeof(OffsetValueType) + 2^ImageDimension * sizeof(WeightType) bytes per
+ * output pixel.
+ *
+ * Output pixels outside of the input are set to the DefaultPixelValue.  The
+ * whole input and the whole output are always processed.
+ *
+ * \sa CurvilinearArraySpecialCoordinatesImage
+ * \sa ResampleImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT CurvilinearArrayScanConvertImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(CurvilinearArrayScanConvertImageFilter);
+
+  /** Standard class type alias. */
+  using Self = CurvilinearArrayScanConvertImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(CurvilinearArrayScanConvertImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using SizeType = typename OutputImageType::SizeType;
+  using IndexType = typename OutputImageType::IndexType;
+  using SpacingType = typename OutputImageType::SpacingType;
+  using PointType = typename OutputImageType::PointType;
+  using DirectionType = typename OutputImageType::DirectionType;
+
+  /** Type of the interpolation weights held by the lookup table. */
+  using WeightType = float;
+
+  /** Size of the output image. */
+  itkSetMacro(Size, SizeType);
+  itkGetConstReferenceMacro(Size, SizeType);
+
+  /** Start index of the output image. */
+  itkSetMacro(OutputStartIndex, IndexType);
+  itkGetConstReferenceMacro(OutputStartIndex, IndexType);
+
+  /** Spacing of the output image. */
+  itkSetMacro(OutputSpacing, SpacingType);
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  /** Origin of the output image. */
+  itkSetMacro(OutputOrigin, PointType);
+  itkGetConstReferenceMacro(OutputOrigin, PointType);
+
+  /** Direction of the output image. */
+  itkSetMacro(OutputDirection, DirectionType);
+  itkGetConstReferenceMacro(OutputDirection, DirectionType);
+
+  /** Copy the size, start index, spacing, origin and direction of the output
+   * from an image. */
+  void
+  SetOutputParametersFromImage(const ImageBase<ImageDimension> * image);
+
+  /** Value of the output pixels outside of the input. */
+  itkSetMacro(DefaultPixelValue, OutputPixelType);
+  itkGetConstReferenceMacro(DefaultPixelValue, OutputPixelType);
+
+  /** Number of times the lookup table was built, i.e. the number of updates
+   * where the geometry had changed. */
+  itkGetConstMacro(NumberOfLookupTableBuilds, SizeValueType);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  // Begin concept checking
+  itkConceptMacro(SameDimensionCheck, (Concept::SameDimension<InputImageDimension, ImageDimension>));
+  // End concept checking
+#endif
+
+protected:
+  CurvilinearArrayScanConvertImageFilter();
+  virtual ~CurvilinearArrayScanConvertImageFilter() {}
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  /** The output is always generated whole, so that it is laid out as the
+   * lookup table. */
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  /** Number of input pixels blended into an output pixel. */
+  static constexpr unsigned int NumberOfNeighbors = 1u << ImageDimension;
+
+  /** The lookup table, for subclasses that apply it on other devices. It is
+   * up to date after BeforeThreadedGenerateData(). */
+  const std::vector<OffsetValueType> &
+  GetLookupTableSourceOffsets() const
+  {
+    return m_SourceOffsets;
+  }
+  const std::vector<WeightType> &
+  GetLookupTableWeights() const
+  {
+    return m_Weights;
+  }
+  const OffsetValueType *
+  GetLookupTableNeighborOffsets() const
+  {
+    return m_NeighborOffsets;
+  }
+
+private:
+  using GeometryKeyType = std::vector<double>;
+
+  /** Everything the lookup table depends on. */
+  GeometryKeyType
+  ComputeGeometryKey() const;
+
+  void
+  BuildLookupTable();
+
+  SizeType        m_Size;
+  IndexType       m_OutputStartIndex;
+  SpacingType     m_OutputSpacing;
+  PointType       m_OutputOrigin;
+  DirectionType   m_OutputDirection;
+  OutputPixelType m_DefaultPixelValue;
+
+  /** For every output pixel, the offset in the input buffer of the neighbor
+   * with the smallest index, or -1 if the pixel is outside of the input, and
+   * the weights of the neighbors. */
+  std::vector<OffsetValueType> m_SourceOffsets;
+  std::vector<WeightType>      m_Weights;
+
+  /** Offsets of the neighbors from the first one in the input buffer. */
+  OffsetValueType m_NeighborOffsets[NumberOfNeighbors];
+
+  GeometryKeyType m_LookupTableKey;
+  SizeValueType   m_NumberOfLookupTableBuilds{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkCurvilinearArrayScanConvertImageFilter.hxx"
+#endif
+
+#endif // itkCurvilinearArrayScanConvertImageFilter_h
@@ -0,0 +1,333 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkCurvilinearArrayScanConvertImageFilter_hxx
+#define itkCurvilinearArrayScanConvertImageFilter_hxx
+
+#include "itkCurvilinearArrayScanConvertImageFilter.h"
+
+#include "itkContinuousIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::CurvilinearArrayScanConvertImageFilter()
+  : m_DefaultPixelValue(NumericTraits<OutputPixelType>::ZeroValue())
+{
+  m_Size.Fill(0);
+  m_OutputStartIndex.Fill(0);
+  m_OutputSpacing.Fill(1.0);
+  m_OutputOrigin.Fill(0.0);
+  m_OutputDirection.SetIdentity();
+  for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+  {
+    m_NeighborOffsets[nn] = 0;
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::SetOutputParametersFromImage(
+  const ImageBase<ImageDimension> * image)
+{
+  itkAssertInDebugAndIgnoreInReleaseMacro(image != nullptr);
+  this->SetSize(image->GetLargestPossibleRegion().GetSize());
+  this->SetOutputStartIndex(image->GetLargestPossibleRegion().GetIndex());
+  this->SetOutputSpacing(image->GetSpacing());
+  this->SetOutputOrigin(image->GetOrigin());
+  this->SetOutputDirection(image->GetDirection());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  OutputImageType * output = this->GetOutput();
+  if (!output)
+  {
+    return;
+  }
+
+  const OutputImageRegionType outputRegion(m_OutputStartIndex, m_Size);
+  output->SetLargestPossibleRegion(outputRegion);
+  output->SetSpacing(m_OutputSpacing);
+  output->SetOrigin(m_OutputOrigin);
+  output->SetDirection(m_OutputDirection);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::ComputeGeometryKey() const -> GeometryKeyType
+{
+  const InputImageType *  input = this->GetInput();
+  const OutputImageType * output = this->GetOutput();
+
+  GeometryKeyType key;
+  key.push_back(input->GetLateralAngularSeparation());
+  key.push_back(input->GetRadiusSampleSize());
+  key.push_back(input->GetFirstSampleDistance());
+  const typename InputImageType::RegionType & inputRegion = input->GetLargestPossibleRegion();
+  const OutputImageRegionType &               outputRegion = output->GetLargestPossibleRegion();
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    key.push_back(static_cast<double>(inputRegion.GetIndex(ii)));
+    key.push_back(static_cast<double>(inputRegion.GetSize(ii)));
+    key.push_back(input->GetOrigin()[ii]);
+    key.push_back(input->GetSpacing()[ii]);
+    key.push_back(static_cast<double>(outputRegion.GetIndex(ii)));
+    key.push_back(static_cast<double>(outputRegion.GetSize(ii)));
+    key.push_back(output->GetOrigin()[ii]);
+    key.push_back(output->GetSpacing()[ii]);
+    for (unsigned int jj = 0; jj < ImageDimension; ++jj)
+    {
+      key.push_back(input->GetDirection()[ii][jj]);
+      key.push_back(output->GetDirection()[ii][jj]);
+    }
+  }
+  return key;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::BuildLookupTable()
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  const OutputImageRegionType outputRegion = output->GetLargestPossibleRegion();
+  const SizeValueType         numberOfPixels = outputRegion.GetNumberOfPixels();
+  m_SourceOffsets.resize(numberOfPixels);
+  m_Weights.resize(numberOfPixels * NumberOfNeighbors);
+
+  // A neighbor along a direction with a single sample is the sample itself.
+  const typename InputImageType::RegionType & inputRegion = input->GetBufferedRegion();
+  const OffsetValueType *                     inputOffsetTable = input->GetOffsetTable();
+  for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+  {
+    m_NeighborOffsets[nn] = 0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      if (((nn >> dim) & 1u) && inputRegion.GetSize(dim) > 1)
+      {
+        m_NeighborOffsets[nn] += inputOffsetTable[dim];
+      }
+    }
+  }
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegion<ImageDimension>(
+    outputRegion,
+    [this, input, output, &inputRegion, inputOffsetTable](const OutputImageRegionType & lambdaRegion) {
+      // The points of each output line are mapped at once with the batched
+      // transform of the input.
+      using ContinuousIndexType = ContinuousIndex<double, ImageDimension>;
+      const SizeValueType              lineSize = lambdaRegion.GetSize(0);
+      std::vector<PointType>           points(lineSize);
+      std::vector<ContinuousIndexType> continuousIndices(lineSize);
+
+      OutputImageRegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(0, 1);
+      ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+      for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+      {
+        IndexType index = lineIt.GetIndex();
+        for (SizeValueType ii = 0; ii < lineSize; ++ii, ++index[0])
+        {
+          output->TransformIndexToPhysicalPoint(index, points[ii]);
+        }
+        input->TransformPhysicalPointsToContinuousIndices(points.data(), continuousIndices.data(), lineSize);
+
+        const SizeValueType lineOffset = output->ComputeOffset(lineIt.GetIndex());
+        for (SizeValueType ii = 0; ii < lineSize; ++ii)
+        {
+          const SizeValueType tableOffset = lineOffset + ii;
+          WeightType *        weights = &(this->m_Weights[tableOffset * NumberOfNeighbors]);
+
+          // The same bounds and edge handling as LinearInterpolateImageFunction:
+          // the neighbors past the last sample are the last sample.
+          OffsetValueType sourceOffset = 0;
+          double          fractions[ImageDimension];
+          bool            inside = true;
+          for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+          {
+            const IndexValueType start = inputRegion.GetIndex(dim);
+            const IndexValueType end = start + static_cast<IndexValueType>(inputRegion.GetSize(dim)) - 1;
+            const double         value = continuousIndices[ii][dim];
+            if (!(value >= start - 0.5 && value < end + 0.5))
+            {
+              inside = false;
+              break;
+            }
+            IndexValueType base = Math::Floor<IndexValueType>(value);
+            double         fraction = value - base;
+            if (base < start)
+            {
+              base = start;
+              fraction = 0.0;
+            }
+            else if (base >= end)
+            {
+              base = end > start ? end - 1 : end;
+              fraction = end > start ? 1.0 : 0.0;
+            }
+            sourceOffset += (base - start) * inputOffsetTable[dim];
+            fractions[dim] = fraction;
+          }
+
+          if (!inside)
+          {
+            this->m_SourceOffsets[tableOffset] = -1;
+            std::fill(weights, weights + NumberOfNeighbors, WeightType{ 0 });
+            continue;
+          }
+          this->m_SourceOffsets[tableOffset] = sourceOffset;
+          for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+          {
+            double weight = 1.0;
+            for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+            {
+              weight *= ((nn >> dim) & 1u) ? fractions[dim] : 1.0 - fractions[dim];
+            }
+            weights[nn] = static_cast<WeightType>(weight);
+          }
+        }
+      }
+    },
+    nullptr);
+
+  ++m_NumberOfLookupTableBuilds;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  GeometryKeyType key = this->ComputeGeometryKey();
+  if (m_SourceOffsets.empty() || key != m_LookupTableKey)
+  {
+    this->BuildLookupTable();
+    m_LookupTableKey = std::move(key);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  using RealType = typename NumericTraits<InputPixelType>::RealType;
+  const InputPixelType * inputBuffer = input->GetBufferPointer();
+  OutputPixelType *      outputBuffer = output->GetBufferPointer();
+  const SizeValueType    lineSize = outputRegionForThread.GetSize(0);
+
+  OffsetValueType neighborOffsets[NumberOfNeighbors];
+  std::copy(m_NeighborOffsets, m_NeighborOffsets + NumberOfNeighbors, neighborOffsets);
+
+  // The output buffer is laid out as the table, so both are addressed with
+  // the offset of the output pixel.
+  OutputImageRegionType lineStartRegion = outputRegionForThread;
+  lineStartRegion.SetSize(0, 1);
+  ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+  {
+    const SizeValueType     lineOffset = output->ComputeOffset(lineIt.GetIndex());
+    const OffsetValueType * sourceOffsets = m_SourceOffsets.data() + lineOffset;
+    const WeightType *      weights = m_Weights.data() + lineOffset * NumberOfNeighbors;
+    OutputPixelType *       outputLine = outputBuffer + lineOffset;
+    for (SizeValueType ii = 0; ii < lineSize; ++ii)
+    {
+      const OffsetValueType sourceOffset = sourceOffsets[ii];
+      if (sourceOffset < 0)
+      {
+        outputLine[ii] = m_DefaultPixelValue;
+        continue;
+      }
+      const InputPixelType * source = inputBuffer + sourceOffset;
+      const WeightType *     pixelWeights = weights + ii * NumberOfNeighbors;
+      RealType               value = NumericTraits<RealType>::ZeroValue();
+      for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+      {
+        value += pixelWeights[nn] * static_cast<RealType>(source[neighborOffsets[nn]]);
+      }
+      outputLine[ii] = static_cast<OutputPixelType>(value);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Size: " << m_Size << std::endl;
+  os << indent << "OutputStartIndex: " << m_OutputStartIndex << std::endl;
+  os << indent << "OutputSpacing: " << m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << m_OutputDirection << std::endl;
+  os << indent << "DefaultPixelValue: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(m_DefaultPixelValue) << std::endl;
+  os << indent << "NumberOfLookupTableBuilds: " << m_NumberOfLookupTableBuilds << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkCurvilinearArrayScanConvertImageFilter_hxx
@@ -23,6 +23,8 @@
 #include "vnl/vnl_math.h"
 #include "itkNeighborhoodAccessorFunctor.h"
 
+#include <cmath>
+
 namespace itk
 {
 /** \class CurvilinearArraySpecialCoordinatesImage
@@ -396,6 +398,114 @@ public:
     return point;
   }
 
+  /** \brief Get the continuous indices of an array of physical points.
+   *
+   * The batched version of TransformPhysicalPointToContinuousIndex(), for
+   * interpolators and filters that map many points at once.  The geometry
+   * is fetched once per call, the divisions are replaced by multiplications
+   * with precomputed reciprocals, and the lateral angle is computed with a
+   * polynomial arc tangent without branches, accurate to about 1e-8
+   * radians, so that the loop vectorizes.  As in the single point version,
+   * the lateral angle is the arc tangent of x / y.  If isInside is not
+   * null, it receives whether each index is within the image.
+   * \sa TransformPhysicalPointToContinuousIndex */
+  template <typename TCoordRep, typename TIndexRep>
+  void
+  TransformPhysicalPointsToContinuousIndices(const Point<TCoordRep, VDimension> *     points,
+                                             ContinuousIndex<TIndexRep, VDimension> * indices,
+                                             SizeValueType                            numberOfPoints,
+                                             bool *                                   isInside = nullptr) const
+  {
+    const RegionType & region = this->GetLargestPossibleRegion();
+    const double       halfMaxLateral = (region.GetSize(1) - 1) / 2.0;
+    const double       inverseRadiusSampleSize = 1.0 / m_RadiusSampleSize;
+    const double       inverseLateralAngularSeparation = 1.0 / m_LateralAngularSeparation;
+    const double       firstSampleIndex = m_FirstSampleDistance * inverseRadiusSampleSize;
+
+    for (SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+    {
+      const double x = points[ii][0];
+      const double y = points[ii][1];
+      const double lateral = (y != 0.0) ? ApproximateArcTangent(x / (y != 0.0 ? y : 1.0)) : Math::pi_over_2;
+      const double radius = std::sqrt(x * x + y * y);
+      indices[ii][0] = static_cast<TIndexRep>(radius * inverseRadiusSampleSize - firstSampleIndex);
+      indices[ii][1] = static_cast<TIndexRep>(lateral * inverseLateralAngularSeparation + halfMaxLateral);
+    }
+    for (unsigned int dim = 2; dim < VDimension; ++dim)
+    {
+      for (SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+      {
+        double sum = 0.0;
+        for (unsigned int jj = 0; jj < VDimension; ++jj)
+        {
+          sum += this->m_PhysicalPointToIndex[dim][jj] * (points[ii][jj] - this->m_Origin[jj]);
+        }
+        indices[ii][dim] = static_cast<TIndexRep>(sum);
+      }
+    }
+
+    if (isInside)
+    {
+      for (SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+      {
+        isInside[ii] = region.IsInside(indices[ii]);
+      }
+    }
+  }
+
+  /** \brief Get the physical points of an array of continuous indices.
+   *
+   * The batched version of TransformContinuousIndexToPhysicalPoint(), with
+   * the geometry fetched once per call.
+   * \sa TransformContinuousIndexToPhysicalPoint */
+  template <typename TCoordRep, typename TIndexRep>
+  void
+  TransformContinuousIndicesToPhysicalPoints(const ContinuousIndex<TIndexRep, VDimension> * indices,
+                                             Point<TCoordRep, VDimension> *                 points,
+                                             SizeValueType                                  numberOfPoints) const
+  {
+    const RegionType & region = this->GetLargestPossibleRegion();
+    const double       halfMaxLateral = (region.GetSize(1) - 1) / 2.0;
+
+    for (SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+    {
+      const double radius = (indices[ii][0] * m_RadiusSampleSize) + m_FirstSampleDistance;
+      const double lateral = (indices[ii][1] - halfMaxLateral) * m_LateralAngularSeparation;
+      points[ii][0] = static_cast<TCoordRep>(radius * std::sin(lateral));
+      points[ii][1] = static_cast<TCoordRep>(radius * std::cos(lateral));
+    }
+    for (unsigned int dim = 2; dim < VDimension; ++dim)
+    {
+      for (SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+      {
+        double sum = this->m_Origin[dim];
+        for (unsigned int jj = 0; jj < VDimension; ++jj)
+        {
+          sum += this->m_IndexToPhysicalPoint[dim][jj] * indices[ii][jj];
+        }
+        points[ii][dim] = static_cast<TCoordRep>(sum);
+      }
+    }
+  }
+
+  /** Arc tangent by reduction to [0, tan(pi/8)] and a polynomial, after
+   * Cephes' atanf().  The error is about 1e-8 radians.  The reductions are
+   * selects, so that the loops that call it vectorize. */
+  static double
+  ApproximateArcTangent(double value)
+  {
+    const double absolute = std::abs(value);
+    const bool   large = absolute > 2.414213562373095; // tan(3 pi / 8)
+    const bool   medium = absolute > 0.4142135623730950; // tan(pi / 8)
+    const double reduced = large ? -1.0 / absolute : (medium ? (absolute - 1.0) / (absolute + 1.0) : absolute);
+    const double offset = large ? Math::pi_over_2 : (medium ? Math::pi_over_4 : 0.0);
+    const double squared = reduced * reduced;
+    const double polynomial =
+      (((8.05374449538e-2 * squared - 1.38776856032e-1) * squared + 1.99777106478e-1) * squared - 3.33329491539e-1) *
+      squared;
+    return std::copysign(offset + reduced + reduced * polynomial, value);
+  }
+
   /** Set/Get the number of radians between each lateral unit.   */
   itkSetMacro(LateralAngularSeparation, double);
   itkGetConstMacro(LateralAngularSeparation, double);
@@ -0,0 +1,253 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDelayAndSumBeamformingImageFilter_h
+#define itkDelayAndSumBeamformingImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class DelayAndSumBeamformingImageFilter
+ * \brief Beamform the RF lines of a curvilinear array from its pre-beamformed
+ * channel data with delay-and-sum.
+ *
+ * The input holds the samples received by every element of the array for
+ * every transmit event: the samples along the first direction, the elements
+ * along the second, and the transmit events along the third.  Transmit event
+ * l is focused along line l of the output, a
+ * CurvilinearArraySpecialCoordinatesImage with the samples along the first
+ * direction and one line per transmit event along the second, which goes to
+ * the BModeImageFilter as any other RF image.
+ *
+ * The elements lie on an arc of ProbeRadius around the origin, every
+ * ElementAngularSeparation radians, symmetric about the second axis as the
+ * lines of the output.  The echo at radius r on the line at angle theta is
+ * received by the element at angle phi after
+ *
+ * \f[
+ *   t = \frac{r - R}{c} + \frac{\sqrt{r^2 + R^2 - 2 r R \cos(\theta - \phi)}}{c}
+ * \f]
+ *
+ * where R is the ProbeRadius and c the SpeedOfSound: the transmitted pulse
+ * leaves the face of the probe on the line, and comes back to the element.
+ * The channel samples at t, linearly interpolated, are weighted by the
+ * receive apodization and summed over the elements.  The receive aperture
+ * grows with the depth d = r - R, to the elements within d / (2 FNumber) of
+ * the line along the face of the probe, with a Hann apodization across it.
+ * An FNumber of 0 sums all the elements with the same weight.  The sums are
+ * not normalized by the apodization.
+ *
+ * The delays, in samples, and the apodization weights are computed once for
+ * the geometry of the probe, the acquisition and the output, and kept until
+ * one of them changes, so the frames of a live acquisition reuse them.  The
+ * table holds, for every line and element, the samples of the line in the
+ * aperture of the element, 2 * sizeof(float) bytes each.  Each update is then
+ * multithreaded over the lines; for every element the samples of a line are
+ * accumulated in a loop without branches over the contiguous delays and
+ * weights, so that it vectorizes with gathers of the channel samples.
+ *
+ * The channel samples past the ends of the acquisition do not contribute.  The
+ * whole input is always requested.
+ *
+ * \sa OpenCLDelayAndSumBeamformingImageFilter
+ * \sa CurvilinearArraySpecialCoordinatesImage
+ * \sa BModeImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT DelayAndSumBeamformingImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(DelayAndSumBeamformingImageFilter);
+
+  /** Standard class type alias. */
+  using Self = DelayAndSumBeamformingImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DelayAndSumBeamformingImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  static_assert(InputImageDimension == 3 && ImageDimension == 2,
+                "DelayAndSumBeamformingImageFilter beamforms 3D channel data into 2D RF lines");
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Type of the delays and apodization weights held by the table. */
+  using TableValueType = float;
+
+  /** Speed of sound, in the physical units of the output per second.  The
+   * default, 1.54e6, is the speed in soft tissue in millimeters. */
+  itkSetMacro(SpeedOfSound, double);
+  itkGetConstMacro(SpeedOfSound, double);
+
+  /** Sampling frequency of the channel data, in Hz. */
+  itkSetMacro(SamplingFrequency, double);
+  itkGetConstMacro(SamplingFrequency, double);
+
+  /** Time of the first channel sample after the transmit, in seconds.  By
+   * default it is 0. */
+  itkSetMacro(StartTime, double);
+  itkGetConstMacro(StartTime, double);
+
+  /** Radius of curvature of the array, in the physical units of the output. */
+  itkSetMacro(ProbeRadius, double);
+  itkGetConstMacro(ProbeRadius, double);
+
+  /** Angle between the centers of neighboring elements, in radians. */
+  itkSetMacro(ElementAngularSeparation, double);
+  itkGetConstMacro(ElementAngularSeparation, double);
+
+  /** Ratio of the depth to the width of the receive aperture.  By default it
+   * is 1.5; 0 sums all the elements. */
+  itkSetClampMacro(FNumber, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(FNumber, double);
+
+  /** Number of samples of the output lines.  By default it is 0, for the
+   * number of channel samples. */
+  itkSetMacro(NumberOfOutputSamples, SizeValueType);
+  itkGetConstMacro(NumberOfOutputSamples, SizeValueType);
+
+  /** Distance between the output samples along the lines.  By default it is
+   * 0, for the distance the sound travels there and back between channel
+   * samples, SpeedOfSound / (2 SamplingFrequency). */
+  itkSetMacro(RadiusSampleSize, double);
+  itkGetConstMacro(RadiusSampleSize, double);
+
+  /** Radius of the first output sample.  By default it is 0, for the
+   * ProbeRadius, i.e. the face of the probe. */
+  itkSetMacro(FirstSampleDistance, double);
+  itkGetConstMacro(FirstSampleDistance, double);
+
+  /** Angle between the output lines, in radians.  By default it is 0, for the
+   * ElementAngularSeparation, one line per element. */
+  itkSetMacro(LateralAngularSeparation, double);
+  itkGetConstMacro(LateralAngularSeparation, double);
+
+  /** Number of times the table was built, i.e. the number of updates where
+   * the geometry had changed. */
+  itkGetConstMacro(NumberOfTableBuilds, SizeValueType);
+
+protected:
+  DelayAndSumBeamformingImageFilter();
+  ~DelayAndSumBeamformingImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  /** The table, for subclasses that beamform on other devices.  It is up to
+   * date after BeforeThreadedGenerateData().  For the element e of the line
+   * l, at entry l * NumberOfElements + e of the first two, the samples of the
+   * line from GetTableFirstSamples() on are in the aperture, and their delays,
+   * in channel samples, and weights start at GetTableOffsets() in the last
+   * two.  Where the delay is not before the last channel sample, both are 0,
+   * so that the two samples around a delay are always in the channel data. */
+  const std::vector<SizeValueType> &
+  GetTableFirstSamples() const
+  {
+    return m_FirstSamples;
+  }
+  const std::vector<SizeValueType> &
+  GetTableOffsets() const
+  {
+    return m_TableOffsets;
+  }
+  const std::vector<TableValueType> &
+  GetTableDelays() const
+  {
+    return m_Delays;
+  }
+  const std::vector<TableValueType> &
+  GetTableWeights() const
+  {
+    return m_Weights;
+  }
+
+  /** The radius sample size, first sample distance and lateral angular
+   * separation of the output, with the defaults resolved. */
+  double
+  GetOutputRadiusSampleSize() const;
+  double
+  GetOutputFirstSampleDistance() const;
+  double
+  GetOutputLateralAngularSeparation() const;
+
+private:
+  using GeometryKeyType = std::vector<double>;
+
+  /** Everything the table depends on. */
+  GeometryKeyType
+  ComputeGeometryKey() const;
+
+  void
+  BuildTable();
+
+  double        m_SpeedOfSound{ 1.54e6 };
+  double        m_SamplingFrequency{ 0.0 };
+  double        m_StartTime{ 0.0 };
+  double        m_ProbeRadius{ 0.0 };
+  double        m_ElementAngularSeparation{ 0.0 };
+  double        m_FNumber{ 1.5 };
+  SizeValueType m_NumberOfOutputSamples{ 0 };
+  double        m_RadiusSampleSize{ 0.0 };
+  double        m_FirstSampleDistance{ 0.0 };
+  double        m_LateralAngularSeparation{ 0.0 };
+
+  std::vector<SizeValueType>  m_FirstSamples;
+  std::vector<SizeValueType>  m_TableOffsets;
+  std::vector<TableValueType> m_Delays;
+  std::vector<TableValueType> m_Weights;
+
+  GeometryKeyType m_TableKey;
+  SizeValueType   m_NumberOfTableBuilds{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkDelayAndSumBeamformingImageFilter.hxx"
+#endif
+
+#endif // itkDelayAndSumBeamformingImageFilter_h
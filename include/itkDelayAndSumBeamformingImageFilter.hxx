@@ -0,0 +1,323 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDelayAndSumBeamformingImageFilter_hxx
+#define itkDelayAndSumBeamformingImageFilter_hxx
+
+#include "itkDelayAndSumBeamformingImageFilter.h"
+
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::DelayAndSumBeamformingImageFilter() = default;
+
+
+template <typename TInputImage, typename TOutputImage>
+double
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GetOutputRadiusSampleSize() const
+{
+  return m_RadiusSampleSize > 0.0 ? m_RadiusSampleSize : m_SpeedOfSound / (2.0 * m_SamplingFrequency);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+double
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GetOutputFirstSampleDistance() const
+{
+  return m_FirstSampleDistance > 0.0 ? m_FirstSampleDistance : m_ProbeRadius;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+double
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GetOutputLateralAngularSeparation() const
+{
+  return m_LateralAngularSeparation > 0.0 ? m_LateralAngularSeparation : m_ElementAngularSeparation;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  // The output does not have the dimension of the input, so its information
+  // is not copied from it.
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  if (!input || !output)
+  {
+    return;
+  }
+  if (!(m_SpeedOfSound > 0.0) || !(m_SamplingFrequency > 0.0) || !(m_ProbeRadius > 0.0))
+  {
+    itkExceptionMacro("SpeedOfSound, SamplingFrequency and ProbeRadius must be positive.");
+  }
+
+  const typename InputImageType::SizeType & inputSize = input->GetLargestPossibleRegion().GetSize();
+  if (inputSize[0] < 2)
+  {
+    itkExceptionMacro("The channel data must have at least 2 samples.");
+  }
+  typename OutputImageType::SizeType outputSize;
+  outputSize[0] = m_NumberOfOutputSamples > 0 ? m_NumberOfOutputSamples : inputSize[0];
+  outputSize[1] = inputSize[2];
+  output->SetLargestPossibleRegion(OutputImageRegionType(outputSize));
+  output->SetLateralAngularSeparation(this->GetOutputLateralAngularSeparation());
+  output->SetRadiusSampleSize(this->GetOutputRadiusSampleSize());
+  output->SetFirstSampleDistance(this->GetOutputFirstSampleDistance());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::ComputeGeometryKey() const -> GeometryKeyType
+{
+  const typename InputImageType::SizeType & inputSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+  const OutputImageRegionType &             outputRegion = this->GetOutput()->GetLargestPossibleRegion();
+
+  GeometryKeyType key;
+  for (unsigned int ii = 0; ii < InputImageDimension; ++ii)
+  {
+    key.push_back(static_cast<double>(inputSize[ii]));
+  }
+  key.push_back(static_cast<double>(outputRegion.GetSize(0)));
+  key.push_back(m_SpeedOfSound);
+  key.push_back(m_SamplingFrequency);
+  key.push_back(m_StartTime);
+  key.push_back(m_ProbeRadius);
+  key.push_back(m_ElementAngularSeparation);
+  key.push_back(m_FNumber);
+  key.push_back(this->GetOutputRadiusSampleSize());
+  key.push_back(this->GetOutputFirstSampleDistance());
+  key.push_back(this->GetOutputLateralAngularSeparation());
+  return key;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::BuildTable()
+{
+  const typename InputImageType::SizeType & inputSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+  const OutputImageRegionType &             outputRegion = this->GetOutput()->GetLargestPossibleRegion();
+
+  const SizeValueType numberOfChannelSamples = inputSize[0];
+  const SizeValueType numberOfElements = inputSize[1];
+  const SizeValueType numberOfLines = outputRegion.GetSize(1);
+  const SizeValueType numberOfSamples = outputRegion.GetSize(0);
+
+  const double probeRadius = m_ProbeRadius;
+  const double radiusSampleSize = this->GetOutputRadiusSampleSize();
+  const double firstSampleDistance = this->GetOutputFirstSampleDistance();
+  const double lateralAngularSeparation = this->GetOutputLateralAngularSeparation();
+  const double elementAngularSeparation = m_ElementAngularSeparation;
+  const double fNumber = m_FNumber;
+  const double samplesPerDistance = m_SamplingFrequency / m_SpeedOfSound;
+  const double startSample = m_StartTime * m_SamplingFrequency;
+  const double lastDelay = static_cast<double>(numberOfChannelSamples - 1);
+
+  const auto lineAngle = [=](SizeValueType line) {
+    return (static_cast<double>(line) - (numberOfLines - 1) / 2.0) * lateralAngularSeparation;
+  };
+  const auto elementAngle = [=](SizeValueType element) {
+    return (static_cast<double>(element) - (numberOfElements - 1) / 2.0) * elementAngularSeparation;
+  };
+
+  // The aperture grows with the depth, so the samples of a line in the
+  // aperture of an element are the ones from the depth where it enters it.
+  const SizeValueType numberOfEntries = numberOfLines * numberOfElements;
+  m_FirstSamples.resize(numberOfEntries);
+  m_TableOffsets.resize(numberOfEntries);
+  SizeValueType tableSize = 0;
+  for (SizeValueType entry = 0; entry < numberOfEntries; ++entry)
+  {
+    SizeValueType firstSample = 0;
+    if (fNumber > 0.0)
+    {
+      const double arc =
+        probeRadius * std::abs(lineAngle(entry / numberOfElements) - elementAngle(entry % numberOfElements));
+      const double apertureRadius = probeRadius + 2.0 * fNumber * arc;
+      if (apertureRadius > firstSampleDistance)
+      {
+        firstSample = std::min(
+          static_cast<SizeValueType>(std::ceil((apertureRadius - firstSampleDistance) / radiusSampleSize)),
+          numberOfSamples);
+      }
+    }
+    m_FirstSamples[entry] = firstSample;
+    m_TableOffsets[entry] = tableSize;
+    tableSize += numberOfSamples - firstSample;
+  }
+  m_Delays.resize(tableSize);
+  m_Weights.resize(tableSize);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfEntries,
+    [&](SizeValueType entry) {
+      const double        angle = lineAngle(entry / numberOfElements) - elementAngle(entry % numberOfElements);
+      const double        arc = probeRadius * std::abs(angle);
+      const double        cosine = std::cos(angle);
+      const SizeValueType firstSample = m_FirstSamples[entry];
+      TableValueType *    delays = m_Delays.data() + m_TableOffsets[entry];
+      TableValueType *    weights = m_Weights.data() + m_TableOffsets[entry];
+      for (SizeValueType sample = firstSample; sample < numberOfSamples; ++sample)
+      {
+        const double radius = firstSampleDistance + sample * radiusSampleSize;
+        const double depth = radius - probeRadius;
+        const double receiveDistance =
+          std::sqrt(std::max(radius * radius + probeRadius * probeRadius - 2.0 * radius * probeRadius * cosine, 0.0));
+        const double delay = (depth + receiveDistance) * samplesPerDistance - startSample;
+
+        double weight = 1.0;
+        if (fNumber > 0.0)
+        {
+          const double apertureHalfWidth = depth / (2.0 * fNumber);
+          weight = apertureHalfWidth > 0.0
+                     ? 0.5 * (1.0 + std::cos(Math::pi * std::min(arc / apertureHalfWidth, 1.0)))
+                     : static_cast<double>(arc == 0.0);
+        }
+        const bool inside = delay >= 0.0 && delay < lastDelay;
+        delays[sample - firstSample] = static_cast<TableValueType>(inside ? delay : 0.0);
+        weights[sample - firstSample] = static_cast<TableValueType>(inside ? weight : 0.0);
+      }
+    },
+    nullptr);
+
+  ++m_NumberOfTableBuilds;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  GeometryKeyType key = this->ComputeGeometryKey();
+  if (m_TableOffsets.empty() || key != m_TableKey)
+  {
+    this->BuildTable();
+    m_TableKey = std::move(key);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  using RealType = typename NumericTraits<OutputPixelType>::RealType;
+  const typename InputImageType::SizeType & inputSize = input->GetBufferedRegion().GetSize();
+  const SizeValueType                       numberOfChannelSamples = inputSize[0];
+  const SizeValueType                       numberOfElements = inputSize[1];
+  const InputPixelType *                    inputBuffer = input->GetBufferPointer();
+
+  const SizeValueType firstSample = outputRegionForThread.GetIndex(0);
+  const SizeValueType lineSize = outputRegionForThread.GetSize(0);
+  const SizeValueType endSample = firstSample + lineSize;
+  std::vector<RealType> sums(lineSize);
+
+  typename OutputImageType::IndexType index = outputRegionForThread.GetIndex();
+  for (SizeValueType ll = 0; ll < outputRegionForThread.GetSize(1); ++ll, ++index[1])
+  {
+    const SizeValueType line = static_cast<SizeValueType>(index[1]);
+    std::fill(sums.begin(), sums.end(), NumericTraits<RealType>::ZeroValue());
+    for (SizeValueType element = 0; element < numberOfElements; ++element)
+    {
+      const SizeValueType entry = line * numberOfElements + element;
+      const SizeValueType entryFirstSample = m_FirstSamples[entry];
+      const SizeValueType start = std::max(entryFirstSample, firstSample);
+      if (start >= endSample)
+      {
+        continue;
+      }
+      const InputPixelType * channel = inputBuffer + entry * numberOfChannelSamples;
+      const TableValueType * delays = m_Delays.data() + m_TableOffsets[entry] + (start - entryFirstSample);
+      const TableValueType * weights = m_Weights.data() + m_TableOffsets[entry] + (start - entryFirstSample);
+      RealType *             lineSums = sums.data() + (start - firstSample);
+      const SizeValueType    count = endSample - start;
+      // No branches, so that it vectorizes with gathers of the channel samples.
+      for (SizeValueType ii = 0; ii < count; ++ii)
+      {
+        const TableValueType delay = delays[ii];
+        const SizeValueType  base = static_cast<SizeValueType>(delay);
+        const RealType       fraction = delay - static_cast<TableValueType>(base);
+        const RealType       before = static_cast<RealType>(channel[base]);
+        const RealType       after = static_cast<RealType>(channel[base + 1]);
+        lineSums[ii] += weights[ii] * (before + fraction * (after - before));
+      }
+    }
+
+    OutputPixelType * outputLine = output->GetBufferPointer() + output->ComputeOffset(index);
+    for (SizeValueType ii = 0; ii < lineSize; ++ii)
+    {
+      outputLine[ii] = static_cast<OutputPixelType>(sums[ii]);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "SpeedOfSound: " << m_SpeedOfSound << std::endl;
+  os << indent << "SamplingFrequency: " << m_SamplingFrequency << std::endl;
+  os << indent << "StartTime: " << m_StartTime << std::endl;
+  os << indent << "ProbeRadius: " << m_ProbeRadius << std::endl;
+  os << indent << "ElementAngularSeparation: " << m_ElementAngularSeparation << std::endl;
+  os << indent << "FNumber: " << m_FNumber << std::endl;
+  os << indent << "NumberOfOutputSamples: " << m_NumberOfOutputSamples << std::endl;
+  os << indent << "RadiusSampleSize: " << m_RadiusSampleSize << std::endl;
+  os << indent << "FirstSampleDistance: " << m_FirstSampleDistance << std::endl;
+  os << indent << "LateralAngularSeparation: " << m_LateralAngularSeparation << std::endl;
+  os << indent << "NumberOfTableBuilds: " << m_NumberOfTableBuilds << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkDelayAndSumBeamformingImageFilter_hxx
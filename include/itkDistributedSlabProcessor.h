@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDistributedSlabProcessor_h
+#define itkDistributedSlabProcessor_h
+
+#include "itkImageIOBase.h"
+#include "itkImageToImageFilter.h"
+#include "itkObject.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class DistributedSlabProcessor
+ * \brief Process a volume that is too large for one node as slabs, one per
+ * process, and merge the results into a single file.
+ *
+ * The volume in the InputFileName is divided along the SlabDimension, by
+ * default the slowest, that is the elevation or the frame of a 3D or 2D+t
+ * acquisition, into NumberOfRanks slabs of nearly equal thickness.
+ * ProcessShard() reads the slab of the Rank, extended on each side by the
+ * Margin, and only that region when the ImageIO streams, as
+ * HDF5UltrasoundImageIO does.  The Filter processes it, and the part of its
+ * output that belongs to the slab is written to the shard file of the rank,
+ * see GetShardFileName().  Once every rank has processed its shard,
+ * MergeShards(), called by a single process, pastes the shards into the
+ * OutputFileName, one streamed write per shard.
+ *
+ * The Rank and the NumberOfRanks default to the ones that mpirun or srun
+ * give the processes they launch, so the same program started on every node
+ * processes a different slab, without linking to MPI.  The shards are merged
+ * afterwards, since the processes cannot write to the same file concurrently
+ * unless the HDF5 library is built for parallel I/O.
+ *
+ * The Filter sees the extended slab as its whole input, so the Margin must
+ * cover the samples along the SlabDimension that contribute to an output
+ * sample: the half-length of the FFT window, or the block radius plus the
+ * search radius of block-matching.  The output samples of a slab are the
+ * ones whose physical location is nearest to an input sample of the slab,
+ * and the Filter must compute its output on a grid that does not depend on
+ * the extent of its input, as the filters that keep the sampling of their
+ * input do.
+ *
+ * \sa HDF5UltrasoundImageIO
+ * \sa StreamingResampleImageFilter
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT DistributedSlabProcessor : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(DistributedSlabProcessor);
+
+  /** Standard class type alias. */
+  using Self = DistributedSlabProcessor;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkTypeMacro(DistributedSlabProcessor, Object);
+  itkNewMacro(Self);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputRegionType = typename InputImageType::RegionType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+  using FilterType = ImageToImageFilter<InputImageType, OutputImageType>;
+
+  static constexpr unsigned int ImageDimension = InputImageType::ImageDimension;
+  static_assert(ImageDimension == OutputImageType::ImageDimension,
+                "The input and the output images must have the same dimension.");
+
+  /** The volume to process. */
+  itkSetStringMacro(InputFileName);
+  itkGetStringMacro(InputFileName);
+
+  /** The merged output.  The shards are written next to it. */
+  itkSetStringMacro(OutputFileName);
+  itkGetStringMacro(OutputFileName);
+
+  /** ImageIO of the input.  Chosen by the file name when not set. */
+  itkSetObjectMacro(ImageIO, ImageIOBase);
+  itkGetModifiableObjectMacro(ImageIO, ImageIOBase);
+
+  /** ImageIO of the shards and of the merged output.  Chosen by the file name
+   * when not set.  It must support streamed writes for MergeShards(). */
+  itkSetObjectMacro(OutputImageIO, ImageIOBase);
+  itkGetModifiableObjectMacro(OutputImageIO, ImageIOBase);
+
+  /** The filter applied to every slab. */
+  itkSetObjectMacro(Filter, FilterType);
+  itkGetModifiableObjectMacro(Filter, FilterType);
+
+  /** Dimension along which the volume is divided.  Defaults to the last. */
+  itkSetClampMacro(SlabDimension, unsigned int, 0, ImageDimension - 1);
+  itkGetConstMacro(SlabDimension, unsigned int);
+
+  /** Number of input samples along the SlabDimension read on each side of the
+   * slab, within the volume.  Defaults to 0. */
+  itkSetMacro(Margin, SizeValueType);
+  itkGetConstMacro(Margin, SizeValueType);
+
+  /** Index of this process, from 0 to NumberOfRanks - 1.  Defaults to
+   * GetEnvironmentRank(). */
+  itkSetMacro(Rank, unsigned int);
+  itkGetConstMacro(Rank, unsigned int);
+
+  /** Number of processes, and slabs.  Defaults to
+   * GetEnvironmentNumberOfRanks(). */
+  itkSetClampMacro(NumberOfRanks, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfRanks, unsigned int);
+
+  /** Read the slab of the Rank with its margins, filter it, and write the
+   * output of the slab to its shard file. */
+  void
+  ProcessShard();
+
+  /** Paste the shards of all the ranks into the OutputFileName, which is
+   * replaced. */
+  void
+  MergeShards();
+
+  /** File of the output of a rank: the OutputFileName, with ".shard<rank>"
+   * before its extension. */
+  std::string
+  GetShardFileName(unsigned int rank) const;
+
+  /** Slab of the rank among numberOfRanks nearly equal slabs of the region
+   * along the dimension. */
+  static InputRegionType
+  ComputeSlabRegion(const InputRegionType & region,
+                    unsigned int            dimension,
+                    unsigned int            rank,
+                    unsigned int            numberOfRanks);
+
+  /** Slab of the Rank, and the region read for it, in the last
+   * ProcessShard(). */
+  itkGetConstReferenceMacro(SlabRegion, InputRegionType);
+  itkGetConstReferenceMacro(PaddedSlabRegion, InputRegionType);
+
+  /** Rank of the process in the OMPI_COMM_WORLD_RANK, PMI_RANK or
+   * SLURM_PROCID environment variables, or 0. */
+  static unsigned int
+  GetEnvironmentRank();
+
+  /** Number of processes in the OMPI_COMM_WORLD_SIZE, PMI_SIZE or
+   * SLURM_NTASKS environment variables, or 1. */
+  static unsigned int
+  GetEnvironmentNumberOfRanks();
+
+protected:
+  DistributedSlabProcessor();
+  ~DistributedSlabProcessor() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Output samples whose location is nearest to an input sample of the
+   * slab. */
+  OutputRegionType
+  ComputeSlabOutputRegion(const OutputImageType * output,
+                          const InputImageType *  input,
+                          const InputRegionType & slabRegion) const;
+
+private:
+  void
+  VerifyParameters() const;
+
+  std::string                  m_InputFileName;
+  std::string                  m_OutputFileName;
+  ImageIOBase::Pointer         m_ImageIO;
+  ImageIOBase::Pointer         m_OutputImageIO;
+  typename FilterType::Pointer m_Filter;
+  unsigned int                 m_SlabDimension{ ImageDimension - 1 };
+  SizeValueType                m_Margin{ 0 };
+  unsigned int                 m_Rank{ 0 };
+  unsigned int                 m_NumberOfRanks{ 1 };
+  InputRegionType              m_SlabRegion;
+  InputRegionType              m_PaddedSlabRegion;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkDistributedSlabProcessor.hxx"
+#endif
+
+#endif // itkDistributedSlabProcessor_h
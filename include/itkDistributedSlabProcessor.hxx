@@ -0,0 +1,331 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDistributedSlabProcessor_hxx
+#define itkDistributedSlabProcessor_hxx
+
+#include "itkDistributedSlabProcessor.h"
+
+#include "itkContinuousIndex.h"
+#include "itkExtractImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageIORegion.h"
+#include "itkMath.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+DistributedSlabProcessor<TInputImage, TOutputImage>::DistributedSlabProcessor()
+  : m_Rank(GetEnvironmentRank())
+  , m_NumberOfRanks(GetEnvironmentNumberOfRanks())
+{}
+
+
+template <typename TInputImage, typename TOutputImage>
+unsigned int
+DistributedSlabProcessor<TInputImage, TOutputImage>::GetEnvironmentRank()
+{
+  for (const char * variable : { "OMPI_COMM_WORLD_RANK", "PMI_RANK", "SLURM_PROCID" })
+  {
+    const char * value = std::getenv(variable);
+    if (value != nullptr && *value != '\0')
+    {
+      return static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+    }
+  }
+  return 0;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+unsigned int
+DistributedSlabProcessor<TInputImage, TOutputImage>::GetEnvironmentNumberOfRanks()
+{
+  for (const char * variable : { "OMPI_COMM_WORLD_SIZE", "PMI_SIZE", "SLURM_NTASKS" })
+  {
+    const char * value = std::getenv(variable);
+    if (value != nullptr && *value != '\0')
+    {
+      return std::max(static_cast<unsigned int>(std::strtoul(value, nullptr, 10)), 1u);
+    }
+  }
+  return 1;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+std::string
+DistributedSlabProcessor<TInputImage, TOutputImage>::GetShardFileName(unsigned int rank) const
+{
+  std::string path = itksys::SystemTools::GetFilenamePath(m_OutputFileName);
+  if (!path.empty())
+  {
+    path += '/';
+  }
+  return path + itksys::SystemTools::GetFilenameWithoutLastExtension(m_OutputFileName) + ".shard" +
+         std::to_string(rank) + itksys::SystemTools::GetFilenameLastExtension(m_OutputFileName);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+DistributedSlabProcessor<TInputImage, TOutputImage>::ComputeSlabRegion(const InputRegionType & region,
+                                                                       unsigned int            dimension,
+                                                                       unsigned int            rank,
+                                                                       unsigned int            numberOfRanks)
+  -> InputRegionType
+{
+  const SizeValueType length = region.GetSize(dimension);
+  const SizeValueType begin = length * rank / numberOfRanks;
+  const SizeValueType end = length * (rank + 1) / numberOfRanks;
+  InputRegionType     slabRegion = region;
+  slabRegion.SetIndex(dimension, region.GetIndex(dimension) + static_cast<IndexValueType>(begin));
+  slabRegion.SetSize(dimension, end - begin);
+  return slabRegion;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DistributedSlabProcessor<TInputImage, TOutputImage>::VerifyParameters() const
+{
+  if (m_InputFileName.empty() || m_OutputFileName.empty())
+  {
+    itkExceptionMacro(<< "The InputFileName and the OutputFileName must be set.");
+  }
+  if (m_Filter.IsNull())
+  {
+    itkExceptionMacro(<< "The Filter must be set.");
+  }
+  if (m_Rank >= m_NumberOfRanks)
+  {
+    itkExceptionMacro(<< "The Rank " << m_Rank << " is not less than the NumberOfRanks " << m_NumberOfRanks);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+DistributedSlabProcessor<TInputImage, TOutputImage>::ComputeSlabOutputRegion(const OutputImageType * output,
+                                                                             const InputImageType *  input,
+                                                                             const InputRegionType & slabRegion) const
+  -> OutputRegionType
+{
+  const unsigned int     dimension = m_SlabDimension;
+  const OutputRegionType outputRegion = output->GetLargestPossibleRegion();
+  const IndexValueType   slabBegin = slabRegion.GetIndex(dimension);
+  const IndexValueType   slabEnd = slabBegin + static_cast<IndexValueType>(slabRegion.GetSize(dimension));
+  const IndexValueType   outputBegin = outputRegion.GetIndex(dimension);
+  const IndexValueType   outputEnd = outputBegin + static_cast<IndexValueType>(outputRegion.GetSize(dimension));
+  IndexValueType         begin = outputEnd;
+  IndexValueType         end = outputBegin;
+
+  typename OutputImageType::IndexType outputIndex = outputRegion.GetIndex();
+  for (IndexValueType ii = outputBegin; ii < outputEnd; ++ii)
+  {
+    outputIndex[dimension] = ii;
+    typename OutputImageType::PointType point;
+    output->TransformIndexToPhysicalPoint(outputIndex, point);
+    ContinuousIndex<double, ImageDimension> inputIndex;
+    input->TransformPhysicalPointToContinuousIndex(point, inputIndex);
+    const IndexValueType nearest = Math::Round<IndexValueType>(inputIndex[dimension]);
+    if (nearest >= slabBegin && nearest < slabEnd)
+    {
+      begin = std::min(begin, ii);
+      end = std::max(end, ii + 1);
+    }
+  }
+
+  OutputRegionType slabOutputRegion = outputRegion;
+  slabOutputRegion.SetIndex(dimension, begin);
+  slabOutputRegion.SetSize(dimension, end > begin ? static_cast<SizeValueType>(end - begin) : 0);
+  return slabOutputRegion;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DistributedSlabProcessor<TInputImage, TOutputImage>::ProcessShard()
+{
+  this->VerifyParameters();
+
+  using ReaderType = ImageFileReader<InputImageType>;
+  auto reader = ReaderType::New();
+  reader->SetFileName(m_InputFileName);
+  if (m_ImageIO.IsNotNull())
+  {
+    reader->SetImageIO(m_ImageIO);
+  }
+  reader->UpdateOutputInformation();
+  const InputImageType * input = reader->GetOutput();
+  const InputRegionType  wholeRegion = input->GetLargestPossibleRegion();
+
+  m_SlabRegion = ComputeSlabRegion(wholeRegion, m_SlabDimension, m_Rank, m_NumberOfRanks);
+  if (m_SlabRegion.GetSize(m_SlabDimension) == 0)
+  {
+    itkExceptionMacro(<< "The slab of rank " << m_Rank << " is empty: the volume has fewer than " << m_NumberOfRanks
+                      << " samples along dimension " << m_SlabDimension);
+  }
+  m_PaddedSlabRegion = m_SlabRegion;
+  m_PaddedSlabRegion.SetIndex(m_SlabDimension,
+                              m_SlabRegion.GetIndex(m_SlabDimension) - static_cast<IndexValueType>(m_Margin));
+  m_PaddedSlabRegion.SetSize(m_SlabDimension, m_SlabRegion.GetSize(m_SlabDimension) + 2 * m_Margin);
+  m_PaddedSlabRegion.Crop(wholeRegion);
+
+  // The filter sees the padded slab as its whole input, and only the padded
+  // slab is read.
+  using InputExtractType = ExtractImageFilter<InputImageType, InputImageType>;
+  auto inputExtract = InputExtractType::New();
+  inputExtract->SetInput(reader->GetOutput());
+  inputExtract->SetExtractionRegion(m_PaddedSlabRegion);
+  inputExtract->SetDirectionCollapseToSubmatrix();
+  m_Filter->SetInput(inputExtract->GetOutput());
+  m_Filter->UpdateOutputInformation();
+
+  using OutputExtractType = ExtractImageFilter<OutputImageType, OutputImageType>;
+  auto outputExtract = OutputExtractType::New();
+  outputExtract->SetInput(m_Filter->GetOutput());
+  outputExtract->SetExtractionRegion(this->ComputeSlabOutputRegion(m_Filter->GetOutput(), input, m_SlabRegion));
+  outputExtract->SetDirectionCollapseToSubmatrix();
+  outputExtract->Update();
+
+  // The meta data describes the whole volume, so the shard is written without
+  // it, and MergeShards() writes the one of the whole output.
+  typename OutputImageType::Pointer shard = outputExtract->GetOutput();
+  shard->DisconnectPipeline();
+  shard->SetMetaDataDictionary(MetaDataDictionary());
+
+  using WriterType = ImageFileWriter<OutputImageType>;
+  auto writer = WriterType::New();
+  writer->SetInput(shard);
+  writer->SetFileName(this->GetShardFileName(m_Rank));
+  if (m_OutputImageIO.IsNotNull())
+  {
+    writer->SetImageIO(m_OutputImageIO);
+  }
+  writer->Update();
+
+  m_Filter->SetInput(nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DistributedSlabProcessor<TInputImage, TOutputImage>::MergeShards()
+{
+  this->VerifyParameters();
+
+  // The regions and the meta data of the whole output.
+  using ReaderType = ImageFileReader<InputImageType>;
+  auto reader = ReaderType::New();
+  reader->SetFileName(m_InputFileName);
+  if (m_ImageIO.IsNotNull())
+  {
+    reader->SetImageIO(m_ImageIO);
+  }
+  m_Filter->SetInput(reader->GetOutput());
+  m_Filter->UpdateOutputInformation();
+  const OutputImageType * output = m_Filter->GetOutput();
+  const OutputRegionType  wholeRegion = output->GetLargestPossibleRegion();
+
+  // The first piece creates the file.
+  if (itksys::SystemTools::FileExists(m_OutputFileName))
+  {
+    itksys::SystemTools::RemoveFile(m_OutputFileName);
+  }
+
+  using ShardReaderType = ImageFileReader<OutputImageType>;
+  using WriterType = ImageFileWriter<OutputImageType>;
+  for (unsigned int rank = 0; rank < m_NumberOfRanks; ++rank)
+  {
+    auto shardReader = ShardReaderType::New();
+    shardReader->SetFileName(this->GetShardFileName(rank));
+    if (m_OutputImageIO.IsNotNull())
+    {
+      shardReader->SetImageIO(m_OutputImageIO);
+    }
+    shardReader->Update();
+    const OutputImageType * shard = shardReader->GetOutput();
+
+    // The shard is located by its first sample along the slab dimension.
+    typename OutputImageType::IndexType shardIndex;
+    output->TransformPhysicalPointToIndex(shard->GetOrigin(), shardIndex);
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      if (ii != m_SlabDimension)
+      {
+        shardIndex[ii] = wholeRegion.GetIndex(ii);
+      }
+    }
+    const OutputRegionType shardRegion(shardIndex, shard->GetLargestPossibleRegion().GetSize());
+    if (!wholeRegion.IsInside(shardRegion))
+    {
+      itkExceptionMacro(<< "The shard " << shardReader->GetFileName() << " is not within the output.");
+    }
+
+    typename OutputImageType::Pointer piece = OutputImageType::New();
+    piece->CopyInformation(output);
+    piece->SetMetaDataDictionary(output->GetMetaDataDictionary());
+    piece->SetBufferedRegion(shardRegion);
+    piece->SetRequestedRegion(shardRegion);
+    piece->SetPixelContainer(shardReader->GetOutput()->GetPixelContainer());
+
+    ImageIORegion ioRegion(ImageDimension);
+    ImageIORegionAdaptor<ImageDimension>::Convert(shardRegion, ioRegion, wholeRegion.GetIndex());
+    auto writer = WriterType::New();
+    writer->SetInput(piece);
+    writer->SetFileName(m_OutputFileName);
+    if (m_OutputImageIO.IsNotNull())
+    {
+      writer->SetImageIO(m_OutputImageIO);
+    }
+    writer->SetIORegion(ioRegion);
+    writer->Update();
+  }
+
+  m_Filter->SetInput(nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+DistributedSlabProcessor<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "InputFileName: " << m_InputFileName << std::endl;
+  os << indent << "OutputFileName: " << m_OutputFileName << std::endl;
+  os << indent << "ImageIO: " << m_ImageIO.GetPointer() << std::endl;
+  os << indent << "OutputImageIO: " << m_OutputImageIO.GetPointer() << std::endl;
+  os << indent << "Filter: " << m_Filter.GetPointer() << std::endl;
+  os << indent << "SlabDimension: " << m_SlabDimension << std::endl;
+  os << indent << "Margin: " << m_Margin << std::endl;
+  os << indent << "Rank: " << m_Rank << std::endl;
+  os << indent << "NumberOfRanks: " << m_NumberOfRanks << std::endl;
+  os << indent << "SlabRegion: " << m_SlabRegion << std::endl;
+  os << indent << "PaddedSlabRegion: " << m_PaddedSlabRegion << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkDistributedSlabProcessor_hxx
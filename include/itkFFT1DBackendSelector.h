@@ -0,0 +1,217 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFT1DBackendSelector_h
+#define itkFFT1DBackendSelector_h
+
+#include "itkImageRegionIterator.h"
+#include "itkMath.h"
+#include "itkNumericTraits.h"
+#include "itkTimeProbe.h"
+
+#include "UltrasoundExport.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class FFT1DBackendSelector
+ *
+ * \brief Run-time choice of the backend of the 1D FFT filters.
+ *
+ * Forward1DFFTImageFilter::New(), Inverse1DFFTImageFilter::New() and
+ * ComplexToComplex1DFFTImageFilter::New() create the backend given by the
+ * override, when one is set, and otherwise the one preferred at build time.
+ *
+ * Their NewForGeometry() methods also honor the override.  Without one,
+ * they time every backend available for the precision once per transform,
+ * line length, number of lines and precision, and create the fastest.  The
+ * choices are kept for the process and, when a cache file is set, in that
+ * file, so that every node of a heterogeneous fleet keeps its own choices.
+ *
+ * The override is initialized from the ITKUltrasound_FFT1D_BACKEND
+ * environment variable, which may be Vnl, FFTW or OpenCL.
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ * */
+class Ultrasound_EXPORT FFT1DBackendSelector
+{
+public:
+  enum BackendType
+  {
+    DEFAULT_BACKEND = 0,
+    VNL_BACKEND,
+    FFTW_BACKEND,
+    OPENCL_BACKEND
+  };
+
+  /** Backend created regardless of the geometry, or DEFAULT_BACKEND. */
+  static void
+  SetOverride(BackendType backend);
+  static BackendType
+  GetOverride();
+
+  /** Name of a backend, as in the cache file, and back.  Unknown names give
+   * DEFAULT_BACKEND. */
+  static std::string
+  GetBackendName(BackendType backend);
+  static BackendType
+  GetBackend(const std::string & name);
+
+  /** Get the fastest backend recorded for a geometry.  Returns false if
+   * there is none. */
+  static bool
+  Lookup(const std::string & transform,
+         SizeValueType       lineLength,
+         SizeValueType       numberOfLines,
+         unsigned int        precision,
+         BackendType &       backend);
+
+  /** Record the fastest backend for a geometry, and save the choices to the
+   * cache file, if any. */
+  static void
+  Record(const std::string & transform,
+         SizeValueType       lineLength,
+         SizeValueType       numberOfLines,
+         unsigned int        precision,
+         BackendType         backend);
+
+  /** Load the choices of the cache file, if it exists, and save to it after
+   * each new choice.  An empty name keeps the choices in memory only. */
+  static void
+  SetCacheFileName(const std::string & fileName);
+  static std::string
+  GetCacheFileName();
+
+  /** Forget all the choices.  The cache file is left as is. */
+  static void
+  Clear();
+
+  /** Create the filter of TFilter for the geometry, following the override,
+   * the recorded choices, or timing the backends. */
+  template <typename TFilter>
+  static typename TFilter::Pointer
+  New(const std::string & transform, SizeValueType lineLength, SizeValueType numberOfLines);
+
+private:
+  template <typename TFilter>
+  static double
+  Time(TFilter * filter, SizeValueType lineLength, SizeValueType numberOfLines);
+};
+
+
+template <typename TFilter>
+typename TFilter::Pointer
+FFT1DBackendSelector::New(const std::string & transform, SizeValueType lineLength, SizeValueType numberOfLines)
+{
+  using ValueType = typename NumericTraits<typename TFilter::InputImageType::PixelType>::ValueType;
+  const unsigned int precision = sizeof(ValueType);
+
+  BackendType backend = GetOverride();
+  if (backend == DEFAULT_BACKEND)
+  {
+    Lookup(transform, lineLength, numberOfLines, precision, backend);
+  }
+  if (backend != DEFAULT_BACKEND)
+  {
+    typename TFilter::Pointer filter = TFilter::New(backend);
+    if (filter.IsNotNull())
+    {
+      return filter;
+    }
+  }
+
+  BackendType fastest = DEFAULT_BACKEND;
+  double      fastestTime = NumericTraits<double>::max();
+  for (BackendType candidate : { VNL_BACKEND, FFTW_BACKEND, OPENCL_BACKEND })
+  {
+    try
+    {
+      typename TFilter::Pointer filter = TFilter::New(candidate);
+      if (filter.IsNull() || Math::GreatestPrimeFactor(lineLength) > filter->GetSizeGreatestPrimeFactor())
+      {
+        continue;
+      }
+      const double time = Time(filter.GetPointer(), lineLength, numberOfLines);
+      if (time < fastestTime)
+      {
+        fastest = candidate;
+        fastestTime = time;
+      }
+    }
+    catch (ExceptionObject &)
+    {
+      // e.g. no OpenCL device on this node
+    }
+  }
+  if (fastest == DEFAULT_BACKEND)
+  {
+    return TFilter::New();
+  }
+  Record(transform, lineLength, numberOfLines, precision, fastest);
+  return TFilter::New(fastest);
+}
+
+
+template <typename TFilter>
+double
+FFT1DBackendSelector::Time(TFilter * filter, SizeValueType lineLength, SizeValueType numberOfLines)
+{
+  using InputImageType = typename TFilter::InputImageType;
+  using PixelType = typename InputImageType::PixelType;
+  using ValueType = typename NumericTraits<PixelType>::ValueType;
+
+  // The lines along the first direction, stacked along the second one.
+  typename InputImageType::SizeType size;
+  size.Fill(1);
+  size[0] = lineLength;
+  if (InputImageType::ImageDimension > 1)
+  {
+    size[1] = numberOfLines;
+  }
+  typename InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions(typename InputImageType::RegionType(size));
+  image->Allocate();
+  unsigned int                        count = 0;
+  ImageRegionIterator<InputImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++count)
+  {
+    it.Set(PixelType(static_cast<ValueType>(count % 7) - 3));
+  }
+
+  filter->SetInput(image);
+  filter->SetDirection(0);
+  // The first update pays for the plans.
+  filter->Update();
+
+  constexpr unsigned int repetitions = 3;
+  TimeProbe              probe;
+  for (unsigned int ii = 0; ii < repetitions; ++ii)
+  {
+    filter->Modified();
+    probe.Start();
+    filter->Update();
+    probe.Stop();
+  }
+  return probe.GetMinimum();
+}
+
+} // end namespace itk
+
+#endif
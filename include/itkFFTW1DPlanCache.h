@@ -0,0 +1,343 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFTW1DPlanCache_h
+#define itkFFTW1DPlanCache_h
+
+#include "itkFFTWCommonExtended.h"
+#include "itkMacro.h"
+#include "itkUltrasoundTrace.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace itk
+{
+
+namespace fftw
+{
+/**
+ * \class Plan1DCache
+ * \brief Process-wide cache of the FFTW plans used by the 1D FFT filters.
+ *
+ * Plans are keyed on the line length, the layout of the batch of lines
+ * they transform, the transform sign, the planner flags and the alignment
+ * of the arrays they will be executed on. The precision is
+ * given by the template parameter, so float and double plans live in
+ * separate caches.
+ *
+ * A plan is created the first time its key is requested and is then shared
+ * by every filter instance in the process.  Plans returned by the cache are
+ * owned by the cache: they must not be destroyed by the caller, and they
+ * must be run with the new-array execute functions,
+ * ComplexToComplexProxy::Execute_dft(), on arrays that have the alignment
+ * that was requested.  Concurrent execution of one plan on different arrays
+ * is safe.
+ *
+ * Since planning with FFTW_MEASURE or FFTW_PATIENT is expensive, the cache
+ * also provides access to the FFTW wisdom.  The wisdom cache configured in
+ * FFTWGlobalConfiguration is honored as well.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TPixel>
+class Plan1DCache
+{
+public:
+  using ProxyType = ComplexToComplexProxy<TPixel>;
+  using PixelType = typename ProxyType::PixelType;
+  using ComplexType = typename ProxyType::ComplexType;
+  using PlanType = typename ProxyType::PlanType;
+
+  /** Get a plan for an out-of-place, complex-to-complex transform of
+   * length samples.  The sign is FFTW_FORWARD or FFTW_BACKWARD, and the
+   * flags are the planner rigor, e.g. FFTW_ESTIMATE or FFTW_MEASURE.  The
+   * alignments are those reported by ProxyType::Alignment_of() for the
+   * arrays that will be passed to Execute_dft(). */
+  static PlanType
+  GetComplexToComplexPlan(int length, int sign, unsigned flags, int inputAlignment, int outputAlignment)
+  {
+    return GetManyComplexToComplexPlan(
+      length, 1, 1, length, 1, length, sign, flags, inputAlignment, outputAlignment, false);
+  }
+
+  /** Get a plan that transforms howMany lines of length samples at once,
+   * following the fftw_plan_many_dft() advanced interface.  Consecutive
+   * samples of a line are stride elements apart and consecutive lines are
+   * distance elements apart, so the plan can be run directly on an image
+   * buffer.  For an in-place plan, the input and output layouts must be
+   * the same. */
+  static PlanType
+  GetManyComplexToComplexPlan(int      length,
+                              int      howMany,
+                              int      inputStride,
+                              int      inputDistance,
+                              int      outputStride,
+                              int      outputDistance,
+                              int      sign,
+                              unsigned flags,
+                              int      inputAlignment,
+                              int      outputAlignment,
+                              bool     inPlace)
+  {
+    const KeyType key{ false,          length, howMany, inputStride,    outputStride,    inputDistance,
+                       outputDistance, sign,   flags,   inputAlignment, outputAlignment, inPlace };
+    return GetPlan(key);
+  }
+
+  /** Get a plan for the real-to-complex transform of howMany lines of
+   * length real samples into howMany half spectra of length / 2 + 1 complex
+   * samples, following fftw_plan_many_dft_r2c().  The layout arguments are
+   * as for GetManyComplexToComplexPlan() and are counted in real elements
+   * for the input and in complex elements for the output.  The plans are
+   * out-of-place and preserve their input; run them with
+   * ProxyType::Execute_dft_r2c(). */
+  static PlanType
+  GetManyRealToComplexPlan(int      length,
+                           int      howMany,
+                           int      inputStride,
+                           int      inputDistance,
+                           int      outputStride,
+                           int      outputDistance,
+                           unsigned flags,
+                           int      inputAlignment,
+                           int      outputAlignment)
+  {
+    // The sign is implied by the kind of transform.
+    const KeyType key{ true,           length, howMany, inputStride,    outputStride,    inputDistance,
+                       outputDistance, 0,      flags,   inputAlignment, outputAlignment, false };
+    return GetPlan(key);
+  }
+
+  /** Number of plans currently held by the cache. */
+  static size_t
+  GetNumberOfPlans()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    return GetMap().size();
+  }
+
+  /** Destroy all the cached plans.  No filter may be executing a plan
+   * obtained from the cache while this is called. */
+  static void
+  Clear()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    MapType &                   plans = GetMap();
+    for (auto & plan : plans)
+    {
+      ProxyType::DestroyPlan(plan.second);
+    }
+    plans.clear();
+  }
+
+  /** Load FFTW wisdom for this precision, e.g. from a previous run that
+   * planned with FFTW_MEASURE. Returns false if the file could not be read. */
+  static bool
+  ImportWisdom(const std::string & filename)
+  {
+    return ProxyType::Import_wisdom_from_filename(filename.c_str());
+  }
+
+  /** Save the FFTW wisdom accumulated for this precision. */
+  static bool
+  ExportWisdom(const std::string & filename)
+  {
+    return ProxyType::Export_wisdom_to_filename(filename.c_str());
+  }
+
+private:
+  /** Upper bound on the SIMD alignment FFTW checks for, in bytes. */
+  static constexpr size_t MaximumAlignment = 64;
+
+  struct KeyType
+  {
+    bool     RealToComplex;
+    int      Length;
+    int      HowMany;
+    int      InputStride;
+    int      OutputStride;
+    int      InputDistance;
+    int      OutputDistance;
+    int      Sign;
+    unsigned Flags;
+    int      InputAlignment;
+    int      OutputAlignment;
+    bool     InPlace;
+
+    bool
+    operator<(const KeyType & other) const
+    {
+      return std::tie(RealToComplex,
+                      Length,
+                      HowMany,
+                      InputStride,
+                      OutputStride,
+                      InputDistance,
+                      OutputDistance,
+                      Sign,
+                      Flags,
+                      InputAlignment,
+                      OutputAlignment,
+                      InPlace) < std::tie(other.RealToComplex,
+                                          other.Length,
+                                          other.HowMany,
+                                          other.InputStride,
+                                          other.OutputStride,
+                                          other.InputDistance,
+                                          other.OutputDistance,
+                                          other.Sign,
+                                          other.Flags,
+                                          other.InputAlignment,
+                                          other.OutputAlignment,
+                                          other.InPlace);
+    }
+  };
+  using MapType = std::map<KeyType, PlanType>;
+
+  static PlanType
+  GetPlan(const KeyType & key)
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    MapType &                   plans = GetMap();
+    const auto                  it = plans.find(key);
+    if (it != plans.end())
+    {
+      return it->second;
+    }
+    itkUltrasoundTraceScopeMacro("FFTWPlan");
+
+    // The planner may overwrite its arrays, so plan on scratch buffers that
+    // reproduce the requested layout and alignment.
+    const int     outputLength = key.RealToComplex ? key.Length / 2 + 1 : key.Length;
+    const size_t  padding = MaximumAlignment / sizeof(ComplexType) + 1;
+    size_t        inputExtent = Extent(key.Length, key.HowMany, key.InputStride, key.InputDistance);
+    const size_t  outputExtent = Extent(outputLength, key.HowMany, key.OutputStride, key.OutputDistance);
+    if (key.RealToComplex)
+    {
+      // counted in complex elements, like the scratch buffers
+      inputExtent = inputExtent / 2 + 1;
+    }
+    ComplexType * inputScratch = ProxyType::Malloc_complex(inputExtent + padding);
+    ComplexType * outputScratch = key.InPlace ? inputScratch : ProxyType::Malloc_complex(outputExtent + padding);
+    if (inputScratch == nullptr || outputScratch == nullptr)
+    {
+      FreeScratch(inputScratch, outputScratch);
+      itkGenericExceptionMacro("Problem allocating memory for FFTW planning");
+    }
+    ComplexType * in = OffsetPointer(inputScratch, key.InputAlignment);
+    ComplexType * out = key.InPlace ? in : OffsetPointer(outputScratch, key.OutputAlignment);
+
+    int      length = key.Length;
+    PlanType plan;
+    if (key.RealToComplex)
+    {
+      plan = ProxyType::Plan_many_dft_r2c(1,
+                                          &length,
+                                          key.HowMany,
+                                          reinterpret_cast<PixelType *>(in),
+                                          nullptr,
+                                          key.InputStride,
+                                          key.InputDistance,
+                                          out,
+                                          nullptr,
+                                          key.OutputStride,
+                                          key.OutputDistance,
+                                          key.Flags,
+                                          1);
+    }
+    else if (key.HowMany == 1 && key.InputStride == 1 && key.OutputStride == 1)
+    {
+      plan = ProxyType::Plan_dft_1d(length, in, out, key.Sign, key.Flags, 1);
+    }
+    else
+    {
+      plan = ProxyType::Plan_many_dft(1,
+                                      &length,
+                                      key.HowMany,
+                                      in,
+                                      nullptr,
+                                      key.InputStride,
+                                      key.InputDistance,
+                                      out,
+                                      nullptr,
+                                      key.OutputStride,
+                                      key.OutputDistance,
+                                      key.Sign,
+                                      key.Flags,
+                                      1);
+    }
+    FreeScratch(inputScratch, outputScratch);
+    if (plan == nullptr)
+    {
+      itkGenericExceptionMacro("Could not create the FFTW plan for " << key.HowMany << " line(s) of length "
+                                                                      << key.Length);
+    }
+
+    plans[key] = plan;
+    return plan;
+  }
+
+  /** Number of elements spanned by howMany lines with the given layout. */
+  static size_t
+  Extent(int length, int howMany, int stride, int distance)
+  {
+    return static_cast<size_t>(howMany - 1) * distance + static_cast<size_t>(length - 1) * stride + 1;
+  }
+
+  static void
+  FreeScratch(ComplexType * inputScratch, ComplexType * outputScratch)
+  {
+    if (inputScratch != nullptr)
+    {
+      ProxyType::Free(inputScratch);
+    }
+    if (outputScratch != nullptr && outputScratch != inputScratch)
+    {
+      ProxyType::Free(outputScratch);
+    }
+  }
+
+  static ComplexType *
+  OffsetPointer(ComplexType * pointer, int alignment)
+  {
+    return reinterpret_cast<ComplexType *>(reinterpret_cast<char *>(pointer) + alignment);
+  }
+
+  // The map is intentionally never destroyed: plans must not outlive the
+  // FFTW library state, which is torn down during static destruction.
+  static MapType &
+  GetMap()
+  {
+    static MapType * plans = new MapType;
+    return *plans;
+  }
+
+  static std::mutex &
+  GetMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+};
+
+} // namespace fftw
+} // namespace itk
+
+#endif // itkFFTW1DPlanCache_h
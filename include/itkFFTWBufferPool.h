@@ -0,0 +1,240 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFFTWBufferPool_h
+#define itkFFTWBufferPool_h
+
+#include "itkFFTWCommonExtended.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace itk
+{
+
+namespace fftw
+{
+/**
+ * \class BufferPool
+ * \brief Process-wide pool of SIMD-aligned FFTW scratch buffers.
+ *
+ * Buffers are allocated with fftw_malloc(), so FFTW can use its aligned
+ * codelets on them, and they all share the same alignment, so one cached
+ * plan, see Plan1DCache, serves every buffer of a given size.
+ *
+ * Released buffers are kept in the pool and handed out again by Acquire()
+ * for requests of up to their size, and of more than half of it, so that the
+ * slabs of the batched filters, whose size follows the requested region,
+ * reuse the buffers of close sizes.  The pool holds at most
+ * GetMaximumPooledBytes(): when a release exceeds it, the buffers released
+ * the longest time ago, such as those of sizes that are no longer
+ * requested, are freed first.  Clear() frees all of them.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TPixel>
+class BufferPool
+{
+public:
+  using ProxyType = ComplexToComplexProxy<TPixel>;
+  using ComplexType = typename ProxyType::ComplexType;
+
+  /** Get a buffer of at least size complex elements, or nullptr if the
+   * allocation failed. */
+  static ComplexType *
+  Acquire(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    PoolType &                  pool = GetPool();
+    ComplexType *               buffer = nullptr;
+    size_t                      capacity = size;
+    // The smallest pooled buffer that fits, unless it is twice as large.
+    const auto it = pool.lower_bound(size);
+    if (it != pool.end() && it->first / 2 < std::max<size_t>(size, 1))
+    {
+      capacity = it->first;
+      buffer = it->second.Buffer;
+      GetPooledBytesUnlocked() -= capacity * sizeof(ComplexType);
+      pool.erase(it);
+    }
+    else
+    {
+      buffer = ProxyType::Malloc_complex(size);
+      if (buffer == nullptr)
+      {
+        return nullptr;
+      }
+    }
+    GetSizes()[buffer] = capacity;
+    return buffer;
+  }
+
+  /** Give a buffer obtained from Acquire() back to the pool.  Passing
+   * nullptr is a no-op. */
+  static void
+  Release(ComplexType * buffer)
+  {
+    if (buffer == nullptr)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(GetMutex());
+    SizeMapType &               sizes = GetSizes();
+    const auto                  it = sizes.find(buffer);
+    if (it == sizes.end())
+    {
+      // not from the pool
+      return;
+    }
+    const size_t capacity = it->second;
+    sizes.erase(it);
+    GetPool().emplace(capacity, PooledBuffer{ buffer, ++GetReleaseCount() });
+    GetPooledBytesUnlocked() += capacity * sizeof(ComplexType);
+    EvictUnlocked();
+  }
+
+  /** Number of buffers waiting in the pool. */
+  static size_t
+  GetNumberOfPooledBuffers()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    return GetPool().size();
+  }
+
+  /** Size in bytes of the buffers waiting in the pool. */
+  static size_t
+  GetPooledBytes()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    return GetPooledBytesUnlocked();
+  }
+
+  /** Set/Get the largest size in bytes of the buffers waiting in the pool.
+   * Defaults to 512 MiB.  Lowering it frees the buffers released the
+   * longest time ago. */
+  static void
+  SetMaximumPooledBytes(size_t bytes)
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    GetMaximumPooledBytesUnlocked() = bytes;
+    EvictUnlocked();
+  }
+  static size_t
+  GetMaximumPooledBytes()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    return GetMaximumPooledBytesUnlocked();
+  }
+
+  /** Free the buffers waiting in the pool.  Buffers currently acquired are
+   * not affected. */
+  static void
+  Clear()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    PoolType &                  pool = GetPool();
+    for (auto & buffer : pool)
+    {
+      ProxyType::Free(buffer.second.Buffer);
+    }
+    pool.clear();
+    GetPooledBytesUnlocked() = 0;
+  }
+
+private:
+  struct PooledBuffer
+  {
+    ComplexType * Buffer;
+    size_t        ReleaseCount;
+  };
+  using PoolType = std::multimap<size_t, PooledBuffer>;
+  using SizeMapType = std::unordered_map<ComplexType *, size_t>;
+
+  /** Free the buffers released the longest time ago until the pool fits in
+   * its maximum size. */
+  static void
+  EvictUnlocked()
+  {
+    PoolType & pool = GetPool();
+    size_t &   pooledBytes = GetPooledBytesUnlocked();
+    while (pooledBytes > GetMaximumPooledBytesUnlocked())
+    {
+      auto oldest = pool.begin();
+      for (auto it = pool.begin(); it != pool.end(); ++it)
+      {
+        if (it->second.ReleaseCount < oldest->second.ReleaseCount)
+        {
+          oldest = it;
+        }
+      }
+      pooledBytes -= oldest->first * sizeof(ComplexType);
+      ProxyType::Free(oldest->second.Buffer);
+      pool.erase(oldest);
+    }
+  }
+
+  // Like the plans, the pooled buffers are intentionally never destroyed
+  // during static destruction.
+  static PoolType &
+  GetPool()
+  {
+    static PoolType * pool = new PoolType;
+    return *pool;
+  }
+
+  static SizeMapType &
+  GetSizes()
+  {
+    static SizeMapType * sizes = new SizeMapType;
+    return *sizes;
+  }
+
+  static size_t &
+  GetPooledBytesUnlocked()
+  {
+    static size_t pooledBytes = 0;
+    return pooledBytes;
+  }
+
+  static size_t &
+  GetMaximumPooledBytesUnlocked()
+  {
+    static size_t maximumPooledBytes = size_t{ 512 } << 20;
+    return maximumPooledBytes;
+  }
+
+  static size_t &
+  GetReleaseCount()
+  {
+    static size_t releaseCount = 0;
+    return releaseCount;
+  }
+
+  static std::mutex &
+  GetMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+};
+
+} // namespace fftw
+} // namespace itk
+
+#endif // itkFFTWBufferPool_h
@@ -27,6 +27,7 @@
 #  endif
 #endif
 
+#include <cstddef>
 #include <mutex>
 
 namespace itk
@@ -158,6 +159,31 @@ public:
     return plan;
   }
   static PlanType
+  Plan_many_dft_r2c(int           rank,
+                    const int *   n,
+                    int           howmany,
+                    PixelType *   in,
+                    const int *   inembed,
+                    int           istride,
+                    int           idist,
+                    ComplexType * out,
+                    const int *   onembed,
+                    int           ostride,
+                    int           odist,
+                    unsigned      flags,
+                    int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftwf_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftwf_plan_many_dft_r2c(rank, n, howmany, in, inembed, istride, idist, out, onembed, ostride, odist, flags);
+    return plan;
+  }
+  static PlanType
   Plan_dft_1d(const int n, ComplexType * in, ComplexType * out, int sign, unsigned flags, int threads = 1)
   {
 #  ifndef ITK_USE_CUFFTW
@@ -169,6 +195,32 @@ public:
     PlanType plan = fftwf_plan_dft_1d(n, in, out, sign, flags);
     return plan;
   }
+  static PlanType
+  Plan_many_dft(int           rank,
+                const int *   n,
+                int           howmany,
+                ComplexType * in,
+                const int *   inembed,
+                int           istride,
+                int           idist,
+                ComplexType * out,
+                const int *   onembed,
+                int           ostride,
+                int           odist,
+                int           sign,
+                unsigned      flags,
+                int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftwf_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftwf_plan_many_dft(rank, n, howmany, in, inembed, istride, idist, out, onembed, ostride, odist, sign, flags);
+    return plan;
+  }
 
 
   static void
@@ -177,10 +229,62 @@ public:
     fftwf_execute(p);
   }
   static void
+  Execute_dft(PlanType p, ComplexType * in, ComplexType * out)
+  {
+    fftwf_execute_dft(p, in, out);
+  }
+  static void
+  Execute_dft_r2c(PlanType p, PixelType * in, ComplexType * out)
+  {
+    fftwf_execute_dft_r2c(p, in, out);
+  }
+  static int
+  Alignment_of(PixelType * p)
+  {
+#  ifndef ITK_USE_CUFFTW
+    return fftwf_alignment_of(p);
+#  else
+    (void)p;
+    return 0;
+#  endif
+  }
+  static bool
+  Import_wisdom_from_filename(const char * filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftwf_import_wisdom_from_filename(filename) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
+  static bool
+  Export_wisdom_to_filename(const char * filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftwf_export_wisdom_to_filename(filename) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
+  static void
   DestroyPlan(PlanType p)
   {
     fftwf_destroy_plan(p);
   }
+  static ComplexType *
+  Malloc_complex(size_t n)
+  {
+    return static_cast<ComplexType *>(fftwf_malloc(sizeof(ComplexType) * n));
+  }
+  static void
+  Free(void * p)
+  {
+    fftwf_free(p);
+  }
 };
 
 #endif // USE_FFTWF
@@ -297,6 +401,31 @@ public:
     return plan;
   }
   static PlanType
+  Plan_many_dft_r2c(int           rank,
+                    const int *   n,
+                    int           howmany,
+                    PixelType *   in,
+                    const int *   inembed,
+                    int           istride,
+                    int           idist,
+                    ComplexType * out,
+                    const int *   onembed,
+                    int           ostride,
+                    int           odist,
+                    unsigned      flags,
+                    int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftw_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftw_plan_many_dft_r2c(rank, n, howmany, in, inembed, istride, idist, out, onembed, ostride, odist, flags);
+    return plan;
+  }
+  static PlanType
   Plan_dft_1d(const int n, ComplexType * in, ComplexType * out, int sign, unsigned flags, int threads = 1)
   {
 #  ifndef ITK_USE_CUFFTW
@@ -308,6 +437,32 @@ public:
     PlanType plan = fftw_plan_dft_1d(n, in, out, sign, flags);
     return plan;
   }
+  static PlanType
+  Plan_many_dft(int           rank,
+                const int *   n,
+                int           howmany,
+                ComplexType * in,
+                const int *   inembed,
+                int           istride,
+                int           idist,
+                ComplexType * out,
+                const int *   onembed,
+                int           ostride,
+                int           odist,
+                int           sign,
+                unsigned      flags,
+                int           threads = 1)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    fftw_plan_with_nthreads(threads);
+#  else
+    (void)threads;
+#  endif
+    PlanType plan =
+      fftw_plan_many_dft(rank, n, howmany, in, inembed, istride, idist, out, onembed, ostride, odist, sign, flags);
+    return plan;
+  }
 
   static void
   Execute(PlanType p)
@@ -315,10 +470,62 @@ public:
     fftw_execute(p);
   }
   static void
+  Execute_dft(PlanType p, ComplexType * in, ComplexType * out)
+  {
+    fftw_execute_dft(p, in, out);
+  }
+  static void
+  Execute_dft_r2c(PlanType p, PixelType * in, ComplexType * out)
+  {
+    fftw_execute_dft_r2c(p, in, out);
+  }
+  static int
+  Alignment_of(PixelType * p)
+  {
+#  ifndef ITK_USE_CUFFTW
+    return fftw_alignment_of(p);
+#  else
+    (void)p;
+    return 0;
+#  endif
+  }
+  static bool
+  Import_wisdom_from_filename(const char * filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftw_import_wisdom_from_filename(filename) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
+  static bool
+  Export_wisdom_to_filename(const char * filename)
+  {
+#  ifndef ITK_USE_CUFFTW
+    std::lock_guard<FFTWGlobalConfiguration::MutexType> lock(FFTWGlobalConfiguration::GetLockMutex());
+    return fftw_export_wisdom_to_filename(filename) != 0;
+#  else
+    (void)filename;
+    return false;
+#  endif
+  }
+  static void
   DestroyPlan(PlanType p)
   {
     fftw_destroy_plan(p);
   }
+  static ComplexType *
+  Malloc_complex(size_t n)
+  {
+    return static_cast<ComplexType *>(fftw_malloc(sizeof(ComplexType) * n));
+  }
+  static void
+  Free(void * p)
+  {
+    fftw_free(p);
+  }
 };
 
 #endif
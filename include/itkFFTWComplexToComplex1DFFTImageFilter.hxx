@@ -25,7 +25,10 @@
 #include "itkIndent.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 #include "itkMetaDataObject.h"
+#include "itkUltrasoundTrace.h"
 
 #if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
 
@@ -36,10 +39,16 @@ template <typename TInputImage, typename TOutputImage>
 FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::FFTWComplexToComplex1DFFTImageFilter()
   : m_PlanComputed(false)
   , m_LastImageSize(0)
+  , m_Batched(false)
 {
   // We cannot split over the FFT direction
   this->m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
   this->DynamicMultiThreadingOff();
+#  ifndef ITK_USE_CUFFTW
+  m_PlanRigor = FFTWGlobalConfiguration::GetPlanRigor();
+#  else
+  m_PlanRigor = FFTW_ESTIMATE;
+#  endif
 }
 
 
@@ -57,13 +66,31 @@ template <typename TInputImage, typename TOutputImage>
 void
 FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::DestroyPlans()
 {
-  for (unsigned int i = 0; i < m_PlanArray.size(); i++)
+  for (unsigned int i = 0; i < m_InputBufferArray.size(); i++)
   {
-    FFTW1DProxyType::DestroyPlan(m_PlanArray[i]);
-    delete[] m_InputBufferArray[i];
-    delete[] m_OutputBufferArray[i];
-    this->m_PlanComputed = false;
+    BufferPoolType::Release(m_InputBufferArray[i]);
+    BufferPoolType::Release(m_OutputBufferArray[i]);
   }
+  m_PlanArray.clear();
+  m_InputBufferArray.clear();
+  m_OutputBufferArray.clear();
+  this->m_PlanComputed = false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+#  ifndef ITK_USE_CUFFTW
+  os << indent << "PlanRigor: " << FFTWGlobalConfiguration::GetPlanRigorName(m_PlanRigor) << " (" << m_PlanRigor
+     << ")" << std::endl;
+#  else
+  os << indent << "PlanRigor: " << m_PlanRigor << std::endl;
+#  endif
+  os << indent << "Batched: " << m_Batched << std::endl;
 }
 
 
@@ -88,46 +115,51 @@ FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::BeforeThreadedG
   const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
   const unsigned int                         lineSize = outputSize[this->m_Direction];
 
+  const int threads = this->GetNumberOfWorkUnits();
   if (this->m_PlanComputed)
   {
     // if the image sizes aren't the same,
-    // we have to comput the plan again
-    if (this->m_LastImageSize != lineSize)
+    // we have to allocate the buffers again
+    if (this->m_LastImageSize != lineSize || static_cast<int>(this->m_PlanArray.size()) != threads)
     {
       this->DestroyPlans();
     }
   }
   if (!this->m_PlanComputed)
   {
-    const int threads = this->GetNumberOfWorkUnits();
     m_PlanArray.resize(threads);
-    m_InputBufferArray.resize(threads);
-    m_OutputBufferArray.resize(threads);
+    m_InputBufferArray.resize(threads, nullptr);
+    m_OutputBufferArray.resize(threads, nullptr);
     for (int i = 0; i < threads; i++)
     {
-      try
-      {
-        m_InputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-        m_OutputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-      }
-      catch (std::bad_alloc &)
+      // SIMD-aligned buffers, reused across filters and updates
+      m_InputBufferArray[i] = BufferPoolType::Acquire(lineSize);
+      m_OutputBufferArray[i] = BufferPoolType::Acquire(lineSize);
+      if (m_InputBufferArray[i] == nullptr || m_OutputBufferArray[i] == nullptr)
       {
+        this->DestroyPlans();
         itkExceptionMacro("Problem allocating memory for internal computations");
       }
-      if (this->m_TransformDirection == Superclass::DIRECT)
-      {
-        m_PlanArray[i] = FFTW1DProxyType::Plan_dft_1d(
-          lineSize, m_InputBufferArray[i], m_OutputBufferArray[i], FFTW_FORWARD, FFTW_ESTIMATE, 1);
-      }
-      else // m_TransformDirection == INVERSE
-      {
-        m_PlanArray[i] = FFTW1DProxyType::Plan_dft_1d(
-          lineSize, m_InputBufferArray[i], m_OutputBufferArray[i], FFTW_BACKWARD, FFTW_ESTIMATE, 1);
-      }
     }
     this->m_LastImageSize = lineSize;
     this->m_PlanComputed = true;
   }
+
+  // The plans are shared through the process-wide cache, so this is only a
+  // lookup unless the geometry or the planner rigor is new.  One plan is
+  // requested per buffer because new-array execution requires the alignment
+  // to match the arrays that were planned on.  The batched mode looks its
+  // plans up per slab of lines instead.
+  for (int i = 0; i < threads && !this->m_Batched; i++)
+  {
+    const int inputAlignment =
+      FFTW1DProxyType::Alignment_of(reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_InputBufferArray[i]));
+    const int outputAlignment =
+      FFTW1DProxyType::Alignment_of(reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_OutputBufferArray[i]));
+    const int sign = (this->m_TransformDirection == Superclass::DIRECT) ? FFTW_FORWARD : FFTW_BACKWARD;
+    m_PlanArray[i] = PlanCacheType::GetComplexToComplexPlan(
+      lineSize, sign, m_PlanRigor, inputAlignment, outputAlignment);
+  }
 }
 
 
@@ -137,6 +169,13 @@ FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerat
   const OutputImageRegionType & outputRegion,
   ThreadIdType                  threadID)
 {
+  itkUltrasoundTraceScopeMacro("FFTWComplexToComplex1DFFT");
+  if (this->m_Batched)
+  {
+    this->BatchedThreadedGenerateData(outputRegion, threadID);
+    return;
+  }
+
   // get pointers to the input and output
   const InputImageType * inputPtr = this->GetInput();
   OutputImageType *      outputPtr = this->GetOutput();
@@ -170,7 +209,7 @@ FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerat
     }
 
     // do the transform
-    FFTW1DProxyType::Execute(m_PlanArray[threadID]);
+    FFTW1DProxyType::Execute_dft(m_PlanArray[threadID], m_InputBufferArray[threadID], m_OutputBufferArray[threadID]);
 
     if (this->m_TransformDirection == Superclass::DIRECT)
     {
@@ -199,6 +238,82 @@ FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerat
   }
 }
 
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::BatchedThreadedGenerateData(
+  const OutputImageRegionType & outputRegion,
+  ThreadIdType                  itkNotUsed(threadID))
+{
+  using ComplexType = typename FFTW1DProxyType::ComplexType;
+  using PixelType = typename FFTW1DProxyType::PixelType;
+  constexpr unsigned int Dimension = OutputImageType::ImageDimension;
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+
+  // The lines of the region that are adjacent along the batch dimension are
+  // transformed together by one plan. The remaining dimensions are looped
+  // over, one slab of lines at a time.
+  const unsigned int    direction = this->GetDirection();
+  const unsigned int    batchDimension = (direction == 0) ? 1 : 0;
+  const int             lineSize = static_cast<int>(outputRegion.GetSize()[direction]);
+  int                   howMany = 1;
+  OutputImageRegionType slabRegion = outputRegion;
+  slabRegion.SetSize(direction, 1);
+  if (Dimension > 1)
+  {
+    howMany = static_cast<int>(outputRegion.GetSize()[batchDimension]);
+    slabRegion.SetSize(batchDimension, 1);
+  }
+  const typename InputImageType::OffsetValueType *  inputOffsets = inputPtr->GetOffsetTable();
+  const typename OutputImageType::OffsetValueType * outputOffsets = outputPtr->GetOffsetTable();
+  const int inputStride = static_cast<int>(inputOffsets[direction]);
+  const int inputDistance = (Dimension > 1) ? static_cast<int>(inputOffsets[batchDimension]) : 0;
+  const int outputStride = static_cast<int>(outputOffsets[direction]);
+  const int outputDistance = (Dimension > 1) ? static_cast<int>(outputOffsets[batchDimension]) : 0;
+  const int sign = (this->m_TransformDirection == Superclass::DIRECT) ? FFTW_FORWARD : FFTW_BACKWARD;
+
+  // FFTW does not modify the input of an out-of-place complex transform.
+  ComplexType * inputBuffer =
+    reinterpret_cast<ComplexType *>(const_cast<typename InputImageType::PixelType *>(inputPtr->GetBufferPointer()));
+  ComplexType * outputBuffer = reinterpret_cast<ComplexType *>(outputPtr->GetBufferPointer());
+
+  ImageRegionConstIteratorWithIndex<OutputImageType> slabIt(outputPtr, slabRegion);
+  for (slabIt.GoToBegin(); !slabIt.IsAtEnd(); ++slabIt)
+  {
+    ComplexType * inputSlab = inputBuffer + inputPtr->ComputeOffset(slabIt.GetIndex());
+    ComplexType * outputSlab = outputBuffer + outputPtr->ComputeOffset(slabIt.GetIndex());
+    const int     inputAlignment = FFTW1DProxyType::Alignment_of(reinterpret_cast<PixelType *>(inputSlab));
+    const int     outputAlignment = FFTW1DProxyType::Alignment_of(reinterpret_cast<PixelType *>(outputSlab));
+    // The output may be grafted onto the input, see
+    // AnalyticSignalImageFilter::SetInPlace().
+    const bool inPlace = (inputSlab == outputSlab);
+    const typename FFTW1DProxyType::PlanType plan = PlanCacheType::GetManyComplexToComplexPlan(lineSize,
+                                                                                              howMany,
+                                                                                              inputStride,
+                                                                                              inputDistance,
+                                                                                              outputStride,
+                                                                                              outputDistance,
+                                                                                              sign,
+                                                                                              m_PlanRigor,
+                                                                                              inputAlignment,
+                                                                                              outputAlignment,
+                                                                                              inPlace);
+    FFTW1DProxyType::Execute_dft(plan, inputSlab, outputSlab);
+  }
+
+  if (this->m_TransformDirection == Superclass::INVERSE)
+  {
+    const typename OutputImageType::PixelType scale = static_cast<typename OutputImageType::PixelType>(lineSize);
+    ImageRegionIterator<OutputImageType>      outputIt(outputPtr, outputRegion);
+    for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt)
+    {
+      outputIt.Set(outputIt.Get() / scale);
+    }
+  }
+}
+
 } // namespace itk
 
 #endif // defined( ITK_USE_FFTWF ) || defined( ITK_USE_FFTWD )
@@ -25,7 +25,9 @@
 #include "itkIndent.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
+#include "itkUltrasoundTrace.h"
 
 #if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
 
@@ -36,10 +38,16 @@ template <typename TInputImage, typename TOutputImage>
 FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::FFTWForward1DFFTImageFilter()
   : m_PlanComputed(false)
   , m_LastImageSize(0)
+  , m_Batched(false)
 {
   // We cannot split over the FFT direction
   this->m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
   this->DynamicMultiThreadingOff();
+#  ifndef ITK_USE_CUFFTW
+  m_PlanRigor = FFTWGlobalConfiguration::GetPlanRigor();
+#  else
+  m_PlanRigor = FFTW_ESTIMATE;
+#  endif
 }
 
 
@@ -57,13 +65,31 @@ template <typename TInputImage, typename TOutputImage>
 void
 FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::DestroyPlans()
 {
-  for (unsigned int i = 0; i < m_PlanArray.size(); i++)
+  for (unsigned int i = 0; i < m_InputBufferArray.size(); i++)
   {
-    FFTW1DProxyType::DestroyPlan(m_PlanArray[i]);
-    delete[] m_InputBufferArray[i];
-    delete[] m_OutputBufferArray[i];
-    this->m_PlanComputed = false;
+    BufferPoolType::Release(m_InputBufferArray[i]);
+    BufferPoolType::Release(m_OutputBufferArray[i]);
   }
+  m_PlanArray.clear();
+  m_InputBufferArray.clear();
+  m_OutputBufferArray.clear();
+  this->m_PlanComputed = false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+#  ifndef ITK_USE_CUFFTW
+  os << indent << "PlanRigor: " << FFTWGlobalConfiguration::GetPlanRigorName(m_PlanRigor) << " (" << m_PlanRigor
+     << ")" << std::endl;
+#  else
+  os << indent << "PlanRigor: " << m_PlanRigor << std::endl;
+#  endif
+  os << indent << "Batched: " << m_Batched << std::endl;
 }
 
 
@@ -88,38 +114,50 @@ FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateDa
   const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
   const unsigned int                         lineSize = outputSize[this->GetDirection()];
 
+  const int threads = this->GetNumberOfWorkUnits();
   if (this->m_PlanComputed)
   {
     // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if (this->m_LastImageSize != lineSize)
+    // we have to allocate the buffers again
+    if (this->m_LastImageSize != lineSize || static_cast<int>(this->m_PlanArray.size()) != threads)
     {
       this->DestroyPlans();
     }
   }
   if (!this->m_PlanComputed)
   {
-    const int threads = this->GetNumberOfWorkUnits();
     m_PlanArray.resize(threads);
-    m_InputBufferArray.resize(threads);
-    m_OutputBufferArray.resize(threads);
+    m_InputBufferArray.resize(threads, nullptr);
+    m_OutputBufferArray.resize(threads, nullptr);
     for (int i = 0; i < threads; i++)
     {
-      try
-      {
-        m_InputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-        m_OutputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-      }
-      catch (std::bad_alloc &)
+      // SIMD-aligned buffers, reused across filters and updates
+      m_InputBufferArray[i] = BufferPoolType::Acquire(lineSize);
+      m_OutputBufferArray[i] = BufferPoolType::Acquire(lineSize);
+      if (m_InputBufferArray[i] == nullptr || m_OutputBufferArray[i] == nullptr)
       {
+        this->DestroyPlans();
         itkExceptionMacro("Problem allocating memory for internal computations");
       }
-      m_PlanArray[i] = FFTW1DProxyType::Plan_dft_1d(
-        lineSize, m_InputBufferArray[i], m_OutputBufferArray[i], FFTW_FORWARD, FFTW_ESTIMATE, 1);
     }
     this->m_LastImageSize = lineSize;
     this->m_PlanComputed = true;
   }
+
+  // The plans are shared through the process-wide cache, so this is only a
+  // lookup unless the geometry or the planner rigor is new.  One plan is
+  // requested per buffer because new-array execution requires the alignment
+  // to match the arrays that were planned on.  The batched mode looks its
+  // plans up per slab of lines instead.
+  for (int i = 0; i < threads && !this->m_Batched; i++)
+  {
+    const int inputAlignment =
+      FFTW1DProxyType::Alignment_of(reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_InputBufferArray[i]));
+    const int outputAlignment =
+      FFTW1DProxyType::Alignment_of(reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_OutputBufferArray[i]));
+    m_PlanArray[i] = PlanCacheType::GetManyRealToComplexPlan(
+      lineSize, 1, 1, lineSize, 1, lineSize / 2 + 1, m_PlanRigor, inputAlignment, outputAlignment);
+  }
 }
 
 
@@ -128,46 +166,140 @@ void
 FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType & outputRegion,
                                                                              ThreadIdType                  threadID)
 {
+  itkUltrasoundTraceScopeMacro("FFTWForward1DFFT");
+  if (this->m_Batched)
+  {
+    this->BatchedThreadedGenerateData(outputRegion, threadID);
+    return;
+  }
+
   // get pointers to the input and output
   const InputImageType * inputPtr = this->GetInput();
   OutputImageType *      outputPtr = this->GetOutput();
 
   using InputIteratorType = itk::ImageLinearConstIteratorWithIndex<InputImageType>;
   using OutputIteratorType = itk::ImageLinearIteratorWithIndex<OutputImageType>;
+  using OutputPixelType = typename OutputImageType::PixelType;
   InputIteratorType  inputIt(inputPtr, outputRegion);
   OutputIteratorType outputIt(outputPtr, outputRegion);
 
   inputIt.SetDirection(this->GetDirection());
   outputIt.SetDirection(this->GetDirection());
 
-  typename FFTW1DProxyType::ComplexType * inputBufferIt;
-  typename FFTW1DProxyType::ComplexType * outputBufferIt;
+  const int             lineSize = static_cast<int>(outputRegion.GetSize()[this->GetDirection()]);
+  const int             halfSize = lineSize / 2;
+  const bool            fullSpectrum = this->GetFullSpectrum();
+  const OutputPixelType zero(0);
+
+  typename FFTW1DProxyType::PixelType * inputBuffer =
+    reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_InputBufferArray[threadID]);
+  const OutputPixelType * spectrum = reinterpret_cast<const OutputPixelType *>(m_OutputBufferArray[threadID]);
 
   // for every fft line
   for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
   {
     // copy the input line into our buffer
     inputIt.GoToBeginOfLine();
-    inputBufferIt = m_InputBufferArray[threadID];
+    typename FFTW1DProxyType::PixelType * inputBufferIt = inputBuffer;
     while (!inputIt.IsAtEndOfLine())
     {
-      (*inputBufferIt)[0] = inputIt.Get();
-      (*inputBufferIt)[1] = 0.;
+      *inputBufferIt = inputIt.Get();
       ++inputIt;
       ++inputBufferIt;
     }
 
-    // do the transform
-    FFTW1DProxyType::Execute(m_PlanArray[threadID]);
+    // do the real-to-complex transform, which gives the half spectrum
+    FFTW1DProxyType::Execute_dft_r2c(m_PlanArray[threadID], inputBuffer, m_OutputBufferArray[threadID]);
 
-    // copy the output from the buffer into our line
-    outputBufferIt = m_OutputBufferArray[threadID];
+    // copy the output from the buffer into our line, completing the
+    // negative frequencies by Hermitian symmetry if requested
     outputIt.GoToBeginOfLine();
-    while (!outputIt.IsAtEndOfLine())
+    for (int k = 0; !outputIt.IsAtEndOfLine(); ++k, ++outputIt)
     {
-      outputIt.Set(*(reinterpret_cast<typename OutputIteratorType::PixelType *>(outputBufferIt)));
-      ++outputIt;
-      ++outputBufferIt;
+      if (k <= halfSize)
+      {
+        outputIt.Set(spectrum[k]);
+      }
+      else if (fullSpectrum)
+      {
+        outputIt.Set(std::conj(spectrum[lineSize - k]));
+      }
+      else
+      {
+        outputIt.Set(zero);
+      }
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::BatchedThreadedGenerateData(
+  const OutputImageRegionType & outputRegion,
+  ThreadIdType                  itkNotUsed(threadID))
+{
+  using ComplexType = typename FFTW1DProxyType::ComplexType;
+  using PixelType = typename FFTW1DProxyType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  constexpr unsigned int Dimension = OutputImageType::ImageDimension;
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+
+  // The lines of the region that are adjacent along the batch dimension are
+  // transformed together by one plan. The remaining dimensions are looped
+  // over, one slab of lines at a time.
+  const unsigned int    direction = this->GetDirection();
+  const unsigned int    batchDimension = (direction == 0) ? 1 : 0;
+  const int             lineSize = static_cast<int>(outputRegion.GetSize()[direction]);
+  int                   howMany = 1;
+  OutputImageRegionType slabRegion = outputRegion;
+  slabRegion.SetSize(direction, 1);
+  if (Dimension > 1)
+  {
+    howMany = static_cast<int>(outputRegion.GetSize()[batchDimension]);
+    slabRegion.SetSize(batchDimension, 1);
+  }
+  const typename InputImageType::OffsetValueType *  inputOffsets = inputPtr->GetOffsetTable();
+  const typename OutputImageType::OffsetValueType * outputOffsets = outputPtr->GetOffsetTable();
+  const int inputStride = static_cast<int>(inputOffsets[direction]);
+  const int inputDistance = (Dimension > 1) ? static_cast<int>(inputOffsets[batchDimension]) : 0;
+  const int outputStride = static_cast<int>(outputOffsets[direction]);
+  const int outputDistance = (Dimension > 1) ? static_cast<int>(outputOffsets[batchDimension]) : 0;
+
+  // The real-to-complex plans read the input buffer directly and do not
+  // modify it.
+  PixelType * inputBuffer = const_cast<PixelType *>(inputPtr->GetBufferPointer());
+  const bool  fullSpectrum = this->GetFullSpectrum();
+
+  ImageRegionConstIteratorWithIndex<OutputImageType> slabIt(outputPtr, slabRegion);
+  for (slabIt.GoToBegin(); !slabIt.IsAtEnd(); ++slabIt)
+  {
+    PixelType *       inputSlab = inputBuffer + inputPtr->ComputeOffset(slabIt.GetIndex());
+    OutputPixelType * outputSlab = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset(slabIt.GetIndex());
+    const int         inputAlignment = FFTW1DProxyType::Alignment_of(inputSlab);
+    const int         outputAlignment = FFTW1DProxyType::Alignment_of(reinterpret_cast<PixelType *>(outputSlab));
+    const typename FFTW1DProxyType::PlanType plan = PlanCacheType::GetManyRealToComplexPlan(lineSize,
+                                                                                           howMany,
+                                                                                           inputStride,
+                                                                                           inputDistance,
+                                                                                           outputStride,
+                                                                                           outputDistance,
+                                                                                           m_PlanRigor,
+                                                                                           inputAlignment,
+                                                                                           outputAlignment);
+    FFTW1DProxyType::Execute_dft_r2c(plan, inputSlab, reinterpret_cast<ComplexType *>(outputSlab));
+
+    // complete the negative frequencies of every line of the slab
+    for (int line = 0; line < howMany; ++line)
+    {
+      OutputPixelType * outputLine = outputSlab + line * outputDistance;
+      for (int k = lineSize / 2 + 1; k < lineSize; ++k)
+      {
+        outputLine[k * outputStride] =
+          fullSpectrum ? std::conj(outputLine[(lineSize - k) * outputStride]) : OutputPixelType(0);
+      }
     }
   }
 }
@@ -20,6 +20,8 @@
 
 #include "itkInverse1DFFTImageFilter.h"
 #include "itkFFTWCommonExtended.h"
+#include "itkFFTW1DPlanCache.h"
+#include "itkFFTWBufferPool.h"
 #include "itkImageRegionSplitterDirection.h"
 
 #include <vector>
@@ -60,6 +62,8 @@ public:
   using FFTW1DProxyType = typename fftw::ComplexToComplexProxy<typename TOutputImage::PixelType>;
   using PlanArrayType = typename std::vector<typename FFTW1DProxyType::PlanType>;
   using PlanBufferPointerType = typename std::vector<typename FFTW1DProxyType::ComplexType *>;
+  using PlanCacheType = typename fftw::Plan1DCache<typename FFTW1DProxyType::PixelType>;
+  using BufferPoolType = typename fftw::BufferPool<typename FFTW1DProxyType::PixelType>;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -67,11 +71,66 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(FFTWInverse1DFFTImageFilter, Inverse1DFFTImageFilter);
 
+  /** FFTW transforms any size, but it only has optimized codelets for the
+   * prime factors up to 13; larger factors are much slower. */
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 13;
+  }
+
+  /**
+   * Set/Get the behavior of wisdom plan creation. The default is
+   * provided by FFTWGlobalConfiguration::GetPlanRigor().
+   *
+   * The parameter is one of the following:
+   *
+   * FFTW_ESTIMATE (estimate the plan, no wisdom)
+   * FFTW_MEASURE (measure the plan, uses and creates wisdom)
+   * FFTW_PATIENT (measure the plan more carefully)
+   * FFTW_EXHAUSTIVE (measure the plan exhaustively)
+   *
+   * Plans are shared through a process-wide cache, see fftw::Plan1DCache,
+   * so the cost of a measured plan is only paid once per line length.
+   */
+  virtual void
+  SetPlanRigor(const int & value)
+  {
+#if !defined(ITK_USE_CUFFTW) && (defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD))
+    // Use that method to check the value
+    FFTWGlobalConfiguration::GetPlanRigorName(value);
+#endif
+    if (m_PlanRigor != value)
+    {
+      m_PlanRigor = value;
+      this->Modified();
+    }
+  }
+  itkGetConstReferenceMacro(PlanRigor, int);
+
+  /** When on, all the lines of a work unit are transformed with a batched
+   * FFTW plan, fftw_plan_many_dft(), that addresses the image buffers
+   * directly with their strides, instead of copying every line through a
+   * scratch buffer and executing one plan per line.  Off by default. */
+  itkSetMacro(Batched, bool);
+  itkGetConstMacro(Batched, bool);
+  itkBooleanMacro(Batched);
+#if !defined(ITK_USE_CUFFTW) && (defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD))
+  void
+  SetPlanRigor(const std::string & name)
+  {
+    this->SetPlanRigor(FFTWGlobalConfiguration::GetPlanRigorValue(name));
+  }
+#endif
+
 
 protected:
   FFTWInverse1DFFTImageFilter();
   virtual ~FFTWInverse1DFFTImageFilter();
 
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
   void
   BeforeThreadedGenerateData() override;
   void
@@ -85,15 +144,23 @@ protected:
 private:
   ImageRegionSplitterDirection::Pointer m_ImageRegionSplitter;
 
-  /** Destroy FFTW Plans and associated buffers. */
+  /** Return the per-thread buffers to the buffer pool. The plans
+   * themselves are owned by the plan cache. */
   void
   DestroyPlans();
 
+  /** ThreadedGenerateData() for the batched mode. */
+  void
+  BatchedThreadedGenerateData(const OutputImageRegionType & outputRegion, ThreadIdType threadID);
+
   bool                  m_PlanComputed;
   PlanArrayType         m_PlanArray;
   unsigned int          m_LastImageSize;
+  unsigned int          m_LastBufferLines;
   PlanBufferPointerType m_InputBufferArray;
   PlanBufferPointerType m_OutputBufferArray;
+  int                   m_PlanRigor;
+  bool                  m_Batched;
 };
 
 } // namespace itk
@@ -25,7 +25,10 @@
 #include "itkIndent.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
 #include "itkMetaDataObject.h"
+#include "itkUltrasoundTrace.h"
 #include "itkMultiThreaderBase.h"
 
 #if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
@@ -37,10 +40,17 @@ template <typename TInputImage, typename TOutputImage>
 FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::FFTWInverse1DFFTImageFilter()
   : m_PlanComputed(false)
   , m_LastImageSize(0)
+  , m_LastBufferLines(0)
+  , m_Batched(false)
 {
   // We cannot split over the FFT direction
   this->m_ImageRegionSplitter = ImageRegionSplitterDirection::New();
   this->DynamicMultiThreadingOff();
+#  ifndef ITK_USE_CUFFTW
+  m_PlanRigor = FFTWGlobalConfiguration::GetPlanRigor();
+#  else
+  m_PlanRigor = FFTW_ESTIMATE;
+#  endif
 }
 
 
@@ -58,13 +68,31 @@ template <typename TInputImage, typename TOutputImage>
 void
 FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::DestroyPlans()
 {
-  for (unsigned int i = 0; i < m_PlanArray.size(); i++)
+  for (unsigned int i = 0; i < m_InputBufferArray.size(); i++)
   {
-    FFTW1DProxyType::DestroyPlan(m_PlanArray[i]);
-    delete[] m_InputBufferArray[i];
-    delete[] m_OutputBufferArray[i];
-    this->m_PlanComputed = false;
+    BufferPoolType::Release(m_InputBufferArray[i]);
+    BufferPoolType::Release(m_OutputBufferArray[i]);
   }
+  m_PlanArray.clear();
+  m_InputBufferArray.clear();
+  m_OutputBufferArray.clear();
+  this->m_PlanComputed = false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+#  ifndef ITK_USE_CUFFTW
+  os << indent << "PlanRigor: " << FFTWGlobalConfiguration::GetPlanRigorName(m_PlanRigor) << " (" << m_PlanRigor
+     << ")" << std::endl;
+#  else
+  os << indent << "PlanRigor: " << m_PlanRigor << std::endl;
+#  endif
+  os << indent << "Batched: " << m_Batched << std::endl;
 }
 
 
@@ -89,38 +117,59 @@ FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateDa
   const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
   const unsigned int                         lineSize = outputSize[this->m_Direction];
 
+  // In batched mode, the output buffer holds a whole slab of lines.
+  unsigned int bufferLines = 1;
+  if (this->m_Batched && OutputImageType::ImageDimension > 1)
+  {
+    bufferLines = outputSize[(this->m_Direction == 0) ? 1 : 0];
+  }
+
+  const int threads = this->GetNumberOfWorkUnits();
   if (this->m_PlanComputed)
   {
     // if the image sizes aren't the same,
-    // we have to comput the plan again
-    if (this->m_LastImageSize != lineSize)
+    // we have to allocate the buffers again
+    if (this->m_LastImageSize != lineSize || this->m_LastBufferLines != bufferLines ||
+        static_cast<int>(this->m_PlanArray.size()) != threads)
     {
       this->DestroyPlans();
     }
   }
   if (!this->m_PlanComputed)
   {
-    const int threads = this->GetNumberOfWorkUnits();
     m_PlanArray.resize(threads);
-    m_InputBufferArray.resize(threads);
-    m_OutputBufferArray.resize(threads);
+    m_InputBufferArray.resize(threads, nullptr);
+    m_OutputBufferArray.resize(threads, nullptr);
     for (int i = 0; i < threads; i++)
     {
-      try
-      {
-        m_InputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-        m_OutputBufferArray[i] = new typename FFTW1DProxyType::ComplexType[lineSize];
-      }
-      catch (std::bad_alloc &)
+      // SIMD-aligned buffers, reused across filters and updates
+      m_InputBufferArray[i] = BufferPoolType::Acquire(lineSize);
+      m_OutputBufferArray[i] = BufferPoolType::Acquire(lineSize * bufferLines);
+      if (m_InputBufferArray[i] == nullptr || m_OutputBufferArray[i] == nullptr)
       {
+        this->DestroyPlans();
         itkExceptionMacro("Problem allocating memory for internal computations");
       }
-      m_PlanArray[i] = FFTW1DProxyType::Plan_dft_1d(
-        lineSize, m_InputBufferArray[i], m_OutputBufferArray[i], FFTW_BACKWARD, FFTW_ESTIMATE, 1);
     }
     this->m_LastImageSize = lineSize;
+    this->m_LastBufferLines = bufferLines;
     this->m_PlanComputed = true;
   }
+
+  // The plans are shared through the process-wide cache, so this is only a
+  // lookup unless the geometry or the planner rigor is new.  One plan is
+  // requested per buffer because new-array execution requires the alignment
+  // to match the arrays that were planned on.  The batched mode looks its
+  // plans up per slab of lines instead.
+  for (int i = 0; i < threads && !this->m_Batched; i++)
+  {
+    const int inputAlignment =
+      FFTW1DProxyType::Alignment_of(reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_InputBufferArray[i]));
+    const int outputAlignment =
+      FFTW1DProxyType::Alignment_of(reinterpret_cast<typename FFTW1DProxyType::PixelType *>(m_OutputBufferArray[i]));
+    m_PlanArray[i] = PlanCacheType::GetComplexToComplexPlan(
+      lineSize, FFTW_BACKWARD, m_PlanRigor, inputAlignment, outputAlignment);
+  }
 }
 
 
@@ -129,6 +178,13 @@ void
 FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(const OutputImageRegionType & outputRegion,
                                                                              ThreadIdType                  threadID)
 {
+  itkUltrasoundTraceScopeMacro("FFTWInverse1DFFT");
+  if (this->m_Batched)
+  {
+    this->BatchedThreadedGenerateData(outputRegion, threadID);
+    return;
+  }
+
   // get pointers to the input and output
   const InputImageType * inputPtr = this->GetInput();
   OutputImageType *      outputPtr = this->GetOutput();
@@ -161,7 +217,7 @@ FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(con
     }
 
     // do the transform
-    FFTW1DProxyType::Execute(m_PlanArray[threadID]);
+    FFTW1DProxyType::Execute_dft(m_PlanArray[threadID], m_InputBufferArray[threadID], m_OutputBufferArray[threadID]);
 
     // copy the output from the buffer into our line
     outputBufferIt = m_OutputBufferArray[threadID];
@@ -175,6 +231,83 @@ FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(con
   }
 }
 
+
+template <typename TInputImage, typename TOutputImage>
+void
+FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::BatchedThreadedGenerateData(
+  const OutputImageRegionType & outputRegion,
+  ThreadIdType                  threadID)
+{
+  using ComplexType = typename FFTW1DProxyType::ComplexType;
+  using PixelType = typename FFTW1DProxyType::PixelType;
+  constexpr unsigned int Dimension = OutputImageType::ImageDimension;
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+
+  // The lines of the region that are adjacent along the batch dimension are
+  // transformed together by one plan. The remaining dimensions are looped
+  // over, one slab of lines at a time.
+  const unsigned int    direction = this->GetDirection();
+  const unsigned int    batchDimension = (direction == 0) ? 1 : 0;
+  const int             lineSize = static_cast<int>(outputRegion.GetSize()[direction]);
+  int                   howMany = 1;
+  OutputImageRegionType slabRegion = outputRegion;
+  slabRegion.SetSize(direction, 1);
+  if (Dimension > 1)
+  {
+    howMany = static_cast<int>(outputRegion.GetSize()[batchDimension]);
+    slabRegion.SetSize(batchDimension, 1);
+  }
+  const typename InputImageType::OffsetValueType *  inputOffsets = inputPtr->GetOffsetTable();
+  const typename OutputImageType::OffsetValueType * outputOffsets = outputPtr->GetOffsetTable();
+  const int inputStride = static_cast<int>(inputOffsets[direction]);
+  const int inputDistance = (Dimension > 1) ? static_cast<int>(inputOffsets[batchDimension]) : 0;
+  const typename OutputImageType::OffsetValueType outputStride = outputOffsets[direction];
+  const typename OutputImageType::OffsetValueType outputDistance =
+    (Dimension > 1) ? outputOffsets[batchDimension] : 0;
+
+  // The slab is transformed straight out of the input buffer into the
+  // thread's scratch buffer, whose lines are contiguous.  FFTW does not
+  // modify the input of an out-of-place complex transform.
+  ComplexType * inputBuffer =
+    reinterpret_cast<ComplexType *>(const_cast<typename InputImageType::PixelType *>(inputPtr->GetBufferPointer()));
+  ComplexType *   scratch = m_OutputBufferArray[threadID];
+  const int       scratchAlignment = FFTW1DProxyType::Alignment_of(reinterpret_cast<PixelType *>(scratch));
+  const PixelType scale = static_cast<PixelType>(lineSize);
+
+  ImageRegionConstIteratorWithIndex<OutputImageType> slabIt(outputPtr, slabRegion);
+  for (slabIt.GoToBegin(); !slabIt.IsAtEnd(); ++slabIt)
+  {
+    ComplexType * inputSlab = inputBuffer + inputPtr->ComputeOffset(slabIt.GetIndex());
+    const int     inputAlignment = FFTW1DProxyType::Alignment_of(reinterpret_cast<PixelType *>(inputSlab));
+    const typename FFTW1DProxyType::PlanType plan = PlanCacheType::GetManyComplexToComplexPlan(lineSize,
+                                                                                              howMany,
+                                                                                              inputStride,
+                                                                                              inputDistance,
+                                                                                              1,
+                                                                                              lineSize,
+                                                                                              FFTW_BACKWARD,
+                                                                                              m_PlanRigor,
+                                                                                              inputAlignment,
+                                                                                              scratchAlignment,
+                                                                                              false);
+    FFTW1DProxyType::Execute_dft(plan, inputSlab, scratch);
+
+    typename OutputImageType::PixelType * outputSlab =
+      outputPtr->GetBufferPointer() + outputPtr->ComputeOffset(slabIt.GetIndex());
+    const ComplexType * scratchIt = scratch;
+    for (int line = 0; line < howMany; ++line)
+    {
+      typename OutputImageType::PixelType * outputLine = outputSlab + line * outputDistance;
+      for (int sample = 0; sample < lineSize; ++sample, ++scratchIt)
+      {
+        outputLine[sample * outputStride] = (*scratchIt)[0] / scale;
+      }
+    }
+  }
+}
+
 } // namespace itk
 
 #endif // defined( ITK_USE_FFTWF ) || defined( ITK_USE_FFTWD )
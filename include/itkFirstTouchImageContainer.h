@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFirstTouchImageContainer_h
+#define itkFirstTouchImageContainer_h
+
+#include "itkImageScanlineIterator.h"
+#include "itkImportImageContainer.h"
+#include "itkMultiThreaderBase.h"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace itk
+{
+
+/** \class FirstTouchImageContainer
+ *
+ * \brief An image pixel container whose elements are allocated without
+ * being constructed.
+ *
+ * ImportImageContainer allocates with new[], so the constructor of pixels
+ * such as std::complex writes every element on the allocating thread, and
+ * the operating system places all of the pages on the NUMA node of that
+ * thread.  The elements of this container are not touched until they are
+ * first written, see AllocateFirstTouch().
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TElementIdentifier, typename TElement>
+class ITK_TEMPLATE_EXPORT FirstTouchImageContainer : public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(FirstTouchImageContainer);
+
+  using Self = FirstTouchImageContainer;
+  using Superclass = ImportImageContainer<TElementIdentifier, TElement>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using ElementIdentifier = TElementIdentifier;
+  using Element = TElement;
+
+  static_assert(std::is_trivially_copyable<Element>::value && std::is_trivially_destructible<Element>::value,
+                "The elements are not constructed, so they must be trivially copyable and destructible");
+
+  itkNewMacro(Self);
+  itkTypeMacro(FirstTouchImageContainer, ImportImageContainer);
+
+  /** Import size uninitialized elements.  The memory lives as long as the
+   * container. */
+  void
+  AllocateUninitialized(ElementIdentifier size)
+  {
+    try
+    {
+      m_Elements.reset(static_cast<Element *>(::operator new(size * sizeof(Element))));
+    }
+    catch (const std::bad_alloc &)
+    {
+      throw MemoryAllocationError(__FILE__, __LINE__, "Failed to allocate memory for image.", ITK_LOCATION);
+    }
+    this->SetImportPointer(m_Elements.get(), size, false);
+  }
+
+protected:
+  FirstTouchImageContainer() = default;
+  ~FirstTouchImageContainer() override = default;
+
+private:
+  struct ElementsDeleter
+  {
+    void
+    operator()(Element * elements) const
+    {
+      ::operator delete(elements);
+    }
+  };
+
+  std::unique_ptr<Element, ElementsDeleter> m_Elements;
+};
+
+
+/** Allocate the buffered region of an image, with a FirstTouchImageContainer
+ * when its pixels have a constructor that writes them, e.g. std::complex,
+ * and set the new buffer to zero with the work units of the multi-threader,
+ * split as for ParallelizeImageRegionRestrictDirection() along the given
+ * direction, which is how the 1D FFT filters split their output.  With
+ * NUMAMultiThreader, every page is then first touched, and placed, on the
+ * node of the work unit that generates it.
+ *
+ * A buffer that is large enough is kept, with its contents, as with
+ * Image::Allocate().  Other pixel types are allocated as with
+ * Image::Allocate(), since the work units touch their pages first anyway.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TImage>
+void
+AllocateFirstTouch(TImage *            image,
+                   MultiThreaderBase * multiThreader,
+                   ThreadIdType        numberOfWorkUnits,
+                   unsigned int        direction)
+{
+  using PixelType = typename TImage::PixelType;
+  if (std::is_trivially_default_constructible<PixelType>::value)
+  {
+    image->Allocate();
+    return;
+  }
+
+  using ContainerType = FirstTouchImageContainer<typename TImage::PixelContainer::ElementIdentifier, PixelType>;
+  const SizeValueType numberOfPixels = image->GetBufferedRegion().GetNumberOfPixels();
+  if (dynamic_cast<ContainerType *>(image->GetPixelContainer()) != nullptr &&
+      image->GetPixelContainer()->Capacity() >= numberOfPixels)
+  {
+    image->Allocate();
+    return;
+  }
+
+  typename ContainerType::Pointer container = ContainerType::New();
+  container->AllocateUninitialized(numberOfPixels);
+  image->SetPixelContainer(container);
+  image->Allocate();
+
+  multiThreader->SetNumberOfWorkUnits(numberOfWorkUnits);
+  multiThreader->template ParallelizeImageRegionRestrictDirection<TImage::ImageDimension>(
+    direction,
+    image->GetBufferedRegion(),
+    [image](const typename TImage::RegionType & lambdaRegion) {
+      ImageScanlineIterator<TImage> it(image, lambdaRegion);
+      while (!it.IsAtEnd())
+      {
+        while (!it.IsAtEndOfLine())
+        {
+          it.Set(PixelType());
+          ++it;
+        }
+        it.NextLine();
+      }
+    },
+    nullptr);
+}
+
+} // end namespace itk
+
+#endif // itkFirstTouchImageContainer_h
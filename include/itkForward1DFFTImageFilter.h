@@ -21,6 +21,7 @@
 #include <complex>
 
 #include "itkImageToImageFilter.h"
+#include "itkFFT1DBackendSelector.h"
 
 namespace itk
 {
@@ -55,17 +56,40 @@ public:
   /** Customized object creation methods that support configuration-based
    * selection of FFT implementation.
    *
-   * Default implementation is VnlFFT1D.
+   * Default implementation is VnlFFT1D.  The backend set as the override of
+   * FFT1DBackendSelector, if any, takes precedence over the build time
+   * preference.
    */
   static Pointer
   New();
 
+  /** Create the filter of the given backend, or a null pointer when the
+   * backend is not available for the pixel type. */
+  static Pointer
+  New(FFT1DBackendSelector::BackendType backend);
+
+  /** Create the filter of the backend that is the fastest on this machine for
+   * numberOfLines lines of lineLength samples.  See FFT1DBackendSelector. */
+  static Pointer
+  NewForGeometry(SizeValueType lineLength, SizeValueType numberOfLines);
+
   /** Get the direction in which the filter is to be applied. */
   itkGetMacro(Direction, unsigned int);
 
   /** Set the direction in which the filter is to be applied. */
   itkSetClampMacro(Direction, unsigned int, 0, ImageDimension - 1);
 
+  /** Set/Get whether the complete spectrum is generated.  Since the input is
+   * real, the bins above the Nyquist frequency are the complex conjugates of
+   * the positive frequency bins.  Consumers that only use the positive
+   * frequencies, like AnalyticSignalImageFilter, can turn this off.  Backends
+   * that compute a real-to-complex transform, e.g. FFTW, then skip the
+   * Hermitian symmetry fill and set those bins to zero; other backends may
+   * still produce the complete spectrum.  Default is on. */
+  itkSetMacro(FullSpectrum, bool);
+  itkGetConstMacro(FullSpectrum, bool);
+  itkBooleanMacro(FullSpectrum);
+
   /** Get the greatest supported prime factor. */
   virtual SizeValueType
   GetSizeGreatestPrimeFactor() const
@@ -85,10 +109,17 @@ protected:
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
+  /** Allocate the output with AllocateFirstTouch(), so that its pages are
+   * first touched by the work units that generate them. */
+  void
+  AllocateOutputs() override;
+
 private:
   /** Direction in which the filter is to be applied
    * this should be in the range [0,ImageDimension-1]. */
   unsigned int m_Direction;
+
+  bool m_FullSpectrum;
 };
 } // namespace itk
 
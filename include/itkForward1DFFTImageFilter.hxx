@@ -19,6 +19,7 @@
 #define itkForward1DFFTImageFilter_hxx
 
 #include "itkForward1DFFTImageFilter.h"
+#include "itkFirstTouchImageContainer.h"
 
 #include "itkVnlForward1DFFTImageFilter.h"
 
@@ -85,12 +86,52 @@ struct Dispatch_1DRealToComplexConjugate_New<TSelfPointer, TInputImage, TOutputI
 
 #endif // ITKUltrasound_USE_clFFT
 
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage, typename TPixel>
+struct Dispatch_1DRealToComplexConjugate_FFTW_New
+{
+  static TSelfPointer
+  Apply()
+  {
+    return nullptr;
+  }
+};
+
+#ifdef ITK_USE_FFTWD
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DRealToComplexConjugate_FFTW_New<TSelfPointer, TInputImage, TOutputImage, double>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
+#ifdef ITK_USE_FFTWF
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DRealToComplexConjugate_FFTW_New<TSelfPointer, TInputImage, TOutputImage, float>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
 template <typename TInputImage, typename TOutputImage>
 typename Forward1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
 Forward1DFFTImageFilter<TInputImage, TOutputImage>::New()
 {
   Pointer smartPtr = ObjectFactory<Self>::Create();
 
+  const FFT1DBackendSelector::BackendType backend = FFT1DBackendSelector::GetOverride();
+  if (smartPtr.IsNull() && backend != FFT1DBackendSelector::DEFAULT_BACKEND)
+  {
+    smartPtr = New(backend);
+  }
+
   if (smartPtr.IsNull())
   {
     smartPtr = Dispatch_1DRealToComplexConjugate_New<
@@ -104,9 +145,42 @@ Forward1DFFTImageFilter<TInputImage, TOutputImage>::New()
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+typename Forward1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::New(FFT1DBackendSelector::BackendType backend)
+{
+  using ValueType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+  switch (backend)
+  {
+    case FFT1DBackendSelector::VNL_BACKEND:
+      return VnlForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case FFT1DBackendSelector::FFTW_BACKEND:
+      return Dispatch_1DRealToComplexConjugate_FFTW_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+    case FFT1DBackendSelector::OPENCL_BACKEND:
+#ifdef ITKUltrasound_USE_clFFT
+      return OpenCLForward1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+#else
+      return nullptr;
+#endif
+    default:
+      return New();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename Forward1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::NewForGeometry(SizeValueType lineLength,
+                                                                   SizeValueType numberOfLines)
+{
+  return FFT1DBackendSelector::New<Self>("Forward", lineLength, numberOfLines);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 Forward1DFFTImageFilter<TInputImage, TOutputImage>::Forward1DFFTImageFilter()
   : m_Direction(0)
+  , m_FullSpectrum(true)
 {}
 
 
@@ -173,6 +247,16 @@ Forward1DFFTImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+Forward1DFFTImageFilter<TInputImage, TOutputImage>::AllocateOutputs()
+{
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  AllocateFirstTouch(output, this->GetMultiThreader(), this->GetNumberOfWorkUnits(), this->m_Direction);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 Forward1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -180,6 +264,7 @@ Forward1DFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "FullSpectrum: " << m_FullSpectrum << std::endl;
 }
 
 } // end namespace itk
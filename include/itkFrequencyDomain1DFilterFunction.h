@@ -28,7 +28,9 @@ namespace itk
  * Class to implment filter functions for FrequencyDomain1DImageFilter
  *
  * Supports caching of precomputed function values (SetUseCache) for applying
- * the function to multiple signals of the same length.
+ * the function to multiple signals of the same length.  The values are
+ * computed by Precompute(), and are recomputed only when the signal size or
+ * the function changed.
  * For the caching to work properly make sure this->Modified gets called in subclasses
  * whenever a parmater is changed that changes the function values.
  *
@@ -57,7 +59,7 @@ public:
   double
   EvaluateIndex(SizeValueType & i) const
   {
-    if (m_UseCache)
+    if (this->IsCacheCurrent())
     {
       // TODO: Check for out of bounds?
       return m_Cache[i];
@@ -74,10 +76,6 @@ public:
     if (this->m_SignalSize != size)
     {
       this->m_SignalSize = size;
-      if (this->m_UseCache)
-      {
-        this->m_Cache.resize(size);
-      }
       this->Modified();
     }
   }
@@ -91,6 +89,34 @@ public:
   itkSetMacro(UseCache, bool);
   itkGetMacro(UseCache, bool);
 
+  /** Set the signal size and, if UseCache is on, evaluate the function for
+   * every index into a contiguous array, unless the values are already up
+   * to date.  Call this before multi-threaded execution: EvaluateIndex() and
+   * GetPrecomputedValues() do not modify the function. */
+  void
+  Precompute(const SizeValueType & size)
+  {
+    this->SetSignalSize(size);
+    if (this->m_UseCache && !this->IsCacheCurrent())
+    {
+      this->m_Cache.resize(size);
+      for (SizeValueType i = 0; i < size; i++)
+      {
+        this->m_Cache[i] = this->EvaluateFrequency(this->GetFrequency(i));
+      }
+      this->m_CacheTime.Modified();
+    }
+  }
+
+  /** Get the GetSignalSize() values computed by Precompute(), so that they
+   * can be multiplied into a whole line at once, or nullptr if they are not
+   * up to date or UseCache is off. */
+  const double *
+  GetPrecomputedValues() const
+  {
+    return this->IsCacheCurrent() ? this->m_Cache.data() : nullptr;
+  }
+
   /**
    * Override this function to implement a specific filter.
    * The input ranges from -1 to 1
@@ -102,14 +128,6 @@ public:
     return 1.0;
   }
 
-  virtual void
-  Modified() const override
-  {
-    // Force a chache update
-    const_cast<FrequencyDomain1DFilterFunction *>(this)->UpdateCache();
-    Superclass::Modified();
-  }
-
 protected:
   virtual void
   PrintSelf(std::ostream & os, Indent indent) const override
@@ -139,20 +157,16 @@ private:
     return f;
   }
 
-  void
-  UpdateCache()
+  bool
+  IsCacheCurrent() const
   {
-    if (this->m_UseCache)
-    {
-      for (SizeValueType i = 0; i < m_Cache.size(); i++)
-      {
-        this->m_Cache[i] = this->EvaluateFrequency(this->GetFrequency(i));
-      }
-    }
+    return this->m_UseCache && this->m_Cache.size() == this->m_SignalSize && this->m_SignalSize > 0 &&
+           this->m_CacheTime.GetMTime() > this->GetMTime();
   }
 
   bool                m_UseCache;
   std::vector<double> m_Cache;
+  TimeStamp           m_CacheTime;
   SizeValueType       m_SignalSize;
 };
 
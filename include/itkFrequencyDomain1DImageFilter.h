@@ -67,6 +67,7 @@ public:
   {
     m_FilterFunction = function;
   };
+  itkGetModifiableObjectMacro(FilterFunction, FrequencyDomain1DFilterFunction);
 
 protected:
   FrequencyDomain1DImageFilter();
@@ -81,6 +82,11 @@ protected:
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
+  /** Allocate the output with AllocateFirstTouch(), so that its pages are
+   * first touched by the work units that generate them. */
+  void
+  AllocateOutputs() override;
+
   void
   GenerateData() override;
 
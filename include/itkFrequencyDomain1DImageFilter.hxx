@@ -19,9 +19,11 @@
 #define itkFrequencyDomain1DImageFilter_hxx
 
 #include "itkFrequencyDomain1DImageFilter.h"
+#include "itkFirstTouchImageContainer.h"
 
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include <vector>
+
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
 #include "itkMath.h"
 
@@ -100,6 +102,16 @@ FrequencyDomain1DImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedR
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+FrequencyDomain1DImageFilter<TInputImage, TOutputImage>::AllocateOutputs()
+{
+  OutputImageType * output = this->GetOutput();
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  AllocateFirstTouch(output, this->GetMultiThreader(), this->GetNumberOfWorkUnits(), this->GetDirection());
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 FrequencyDomain1DImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -122,7 +134,17 @@ FrequencyDomain1DImageFilter<TInputImage, TOutputImage>::GenerateData()
   const unsigned int                         direction = this->GetDirection();
   const SizeValueType                        size = inputSize[direction];
 
-  this->m_FilterFunction->SetSignalSize(size);
+  // Evaluate the filter function once, before threading, so that every
+  // line is a multiplication by the same vector.
+  this->m_FilterFunction->Precompute(size);
+  using WeightType = typename NumericTraits<typename OutputImageType::PixelType>::ValueType;
+  std::vector<WeightType> weights(size);
+  const double *          precomputed = this->m_FilterFunction->GetPrecomputedValues();
+  for (SizeValueType ii = 0; ii < size; ++ii)
+  {
+    weights[ii] = static_cast<WeightType>(precomputed != nullptr ? precomputed[ii]
+                                                                 : this->m_FilterFunction->EvaluateIndex(ii));
+  }
 
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
@@ -131,32 +153,37 @@ FrequencyDomain1DImageFilter<TInputImage, TOutputImage>::GenerateData()
   multiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
     direction,
     output->GetRequestedRegion(),
-    [this](const typename OutputImageType::RegionType & lambdaRegion) {
-      // get pointers to the input and output
-      const InputImageType * input = this->GetInput();
-      OutputImageType *      output = this->GetOutput();
-      const unsigned int     direction = this->GetDirection();
-
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<OutputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+    [input, output, direction, size, &weights](const typename OutputImageType::RegionType & lambdaRegion) {
+      using InputPixelType = typename InputImageType::PixelType;
+      using OutputPixelType = typename OutputImageType::PixelType;
+      const OffsetValueType  inputStride = input->GetOffsetTable()[direction];
+      const OffsetValueType  outputStride = output->GetOffsetTable()[direction];
+      const InputPixelType * inputBuffer = input->GetBufferPointer();
+      OutputPixelType *      outputBuffer = output->GetBufferPointer();
+      const WeightType *     lineWeights = weights.data();
+
+      // for every fft line, addressed directly in the buffers so that the
+      // contiguous case vectorizes
+      typename OutputImageType::RegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(direction, 1);
+      ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+      for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
       {
-        SizeValueType i = 0;
-        inputIt.GoToBeginOfLine();
-        outputIt.GoToBeginOfLine();
-        while (!outputIt.IsAtEndOfLine())
+        const InputPixelType * inputLine = inputBuffer + input->ComputeOffset(lineIt.GetIndex());
+        OutputPixelType *      outputLine = outputBuffer + output->ComputeOffset(lineIt.GetIndex());
+        if (inputStride == 1 && outputStride == 1)
+        {
+          for (SizeValueType ii = 0; ii < size; ++ii)
+          {
+            outputLine[ii] = inputLine[ii] * lineWeights[ii];
+          }
+        }
+        else
         {
-          outputIt.Set(inputIt.Get() *
-                       static_cast<typename TInputImage::PixelType>(m_FilterFunction->EvaluateIndex(i)));
-          ++outputIt;
-          ++inputIt;
-          ++i;
+          for (SizeValueType ii = 0; ii < size; ++ii)
+          {
+            outputLine[ii * outputStride] = inputLine[ii * inputStride] * lineWeights[ii];
+          }
         }
       }
     },
@@ -29,6 +29,7 @@ namespace H5
 class H5File;
 class DataSpace;
 class DataSet;
+class DataType;
 } // namespace H5
 
 #include "itkStreamingImageIOBase.h"
@@ -45,6 +46,36 @@ class MetaDataDictionary;
  * Currently supports reading the format used by Duke University to read mechanically
  * rotated linear array volumes.
  *
+ * Volumes are written in the same layout: the samples in \c /bimg, and the
+ * sample locations in \c /axial, \c /lat and \c /eleAngle, in degrees.  The
+ * locations come from the SliceOrigin, SliceSpacing and ElevationalSliceAngles
+ * meta data when present, otherwise from the image origin and spacing.
+ *
+ * \c /bimg is chunked by elevational slice or by scanline, see
+ * SetChunkLayout(), and can be compressed with deflate, see
+ * SetUseCompression() and SetCompressionLevel(), after an optional shuffle
+ * filter.  The pieces of a streamed ImageFileWriter are written to the
+ * hyperslabs of the dataset.
+ *
+ * Complex samples, such as beamformed IQ data, are read from a \c /bimg of
+ * {re, im} compounds, or with a trailing dimension of two floating point
+ * components, into complex pixels, for example std::complex<float>.  Complex
+ * pixels are written as {re, im} compounds.
+ *
+ * An optional \c /frameIndex lists, for each frame, its slice in \c /bimg,
+ * \c offset, its \c timestamp in seconds, and acquisition parameters, such
+ * as the gain.  Its members are read to, and written from, the
+ * Array<double> meta data named "FrameIndex/" followed by the member name;
+ * it is written when "FrameIndex/timestamp" is present.  FindFrameAtTime()
+ * searches the timestamps, so that a reader can fetch the slices of a time
+ * range only.
+ *
+ * Chunked datasets are read through a chunk cache that, by default, holds the
+ * chunks of the requested region across its slowest direction, so that
+ * consecutive regions along it do not decompress the same chunks again.  The
+ * chunks of deflated datasets can also be decompressed concurrently, see
+ * SetUseParallelDecompression().
+ *
  * \author Matt McCormick
  *
  * \ingroup Ultrasound
@@ -73,6 +104,12 @@ public:
   virtual void
   ReadImageInformation() override;
 
+  /** The requested region is read from the hyperslab of the dataset, so
+   * that an ImageFileReader can stream, for example, one elevational slice
+   * at a time.  The dataset stays open between the pieces. */
+  virtual bool
+  CanStreamRead() override;
+
   virtual void
   Read(void * buffer) override;
 
@@ -85,6 +122,59 @@ public:
   virtual void
   Write(const void * buffer) override;
 
+  /** Layout of the chunks of the written \c /bimg dataset.  Chunks hold one
+   * elevational slice, or one scanline; a contiguous dataset cannot be
+   * compressed. */
+  using ChunkLayoutType = enum { CHUNK_SLICES = 0, CHUNK_SCANLINES, CONTIGUOUS };
+  itkSetMacro(ChunkLayout, ChunkLayoutType);
+  itkGetConstMacro(ChunkLayout, ChunkLayoutType);
+
+  /** Apply the shuffle filter before compression, which groups the bytes of
+   * the samples by significance.  Defaults to off. */
+  itkSetMacro(UseShuffle, bool);
+  itkGetConstMacro(UseShuffle, bool);
+  itkBooleanMacro(UseShuffle);
+
+  /** Size in bytes and number of hash table slots of the chunk cache of the
+   * read dataset.  With a zero size, the default, the cache grows to the
+   * chunks of the requested regions; with zero slots, the default, there
+   * are about one hundred slots per cached chunk. */
+  itkSetMacro(ChunkCacheSize, SizeValueType);
+  itkGetConstMacro(ChunkCacheSize, SizeValueType);
+  itkSetMacro(ChunkCacheSlots, SizeValueType);
+  itkGetConstMacro(ChunkCacheSlots, SizeValueType);
+
+  /** Read the compressed chunks of the requested region directly, and
+   * inflate and unshuffle them with the threads of the multi-threader.  This
+   * applies to datasets with only the deflate and shuffle filters; others are
+   * decoded by the library.  Defaults to off. */
+  itkSetMacro(UseParallelDecompression, bool);
+  itkGetConstMacro(UseParallelDecompression, bool);
+  itkBooleanMacro(UseParallelDecompression);
+
+  /** Offset in bytes in the file of the samples of \c /bimg, after
+   * ReadImageInformation(), when they are stored contiguously, unfiltered, in
+   * the native type, so that they can be memory mapped; otherwise -1. */
+  OffsetValueType
+  GetVoxelDataFileOffset() const;
+
+  /** Whether the file has a frame index with timestamps, after
+   * ReadImageInformation(). */
+  bool
+  HasFrameIndex() const;
+
+  /** The slice of \c /bimg of the last frame with a timestamp not after the
+   * time, in seconds, or of the first frame.  The timestamps are searched
+   * in order. */
+  SizeValueType
+  FindFrameAtTime(double time) const;
+
+  /** Whether the HDF5 library was built thread safe, H5_HAVE_THREADSAFE, so
+   * that files can be accessed from several threads at once.  Otherwise,
+   * only one thread at a time may call the library, in the whole process. */
+  static bool
+  IsLibraryThreadSafe();
+
 protected:
   HDF5UltrasoundImageIO();
   ~HDF5UltrasoundImageIO();
@@ -100,14 +190,67 @@ private:
   std::vector<TScalar>
   ReadVector(const std::string & dataSetName);
 
+  template <typename TScalar>
+  void
+  WriteVector(const std::string & dataSetName, const std::vector<TScalar> & vector);
+
   void
   SetupStreaming(H5::DataSpace * imageSpace, H5::DataSpace * slabSpace);
 
+  /** Read \c /frameIndex, when present, to the meta data. */
+  void
+  ReadFrameIndex();
+
+  /** Write \c /frameIndex from the meta data, when it has timestamps. */
+  void
+  WriteFrameIndex(SizeValueType numberOfSlices);
+
+  /** Open \c /bimg with a chunk cache of the given size and slots; a zero
+   * size is the library default. */
+  void
+  OpenVoxelDataSet(SizeValueType chunkCacheSize = 0, SizeValueType chunkCacheSlots = 0);
+
+  /** Reopen \c /bimg if the chunk cache for the IO region is larger than the
+   * current one. */
+  void
+  ConfigureChunkCache();
+
+  /** Returns false, without reading, when the dataset cannot be
+   * decompressed concurrently. */
+  bool
+  ReadChunksConcurrently(void * buffer);
+
+  void
+  CloseVoxelDataSet();
+
+  /** Pixels of two float or double components, written as {re, im}
+   * compounds. */
+  bool
+  WritesComplexPixels() const;
+
   void
   CloseH5File();
 
-  H5::H5File *  m_H5File;
-  H5::DataSet * m_VoxelDataSet;
+  H5::H5File *    m_H5File;
+  H5::DataSet *   m_VoxelDataSet;
+  H5::DataType *  m_VoxelDataType{ nullptr };
+  H5::DataSpace * m_VoxelDataSpace{ nullptr };
+  SizeValueType   m_VoxelChunkCacheSize{ 0 };
+  // The complex samples of a compound dataset are one element.
+  bool            m_VoxelDataTypeIsCompound{ false };
+
+  // The chunk dimensions, slowest moving first; empty when contiguous.
+  std::vector<SizeValueType> m_VoxelChunkDimensions;
+
+  // The frame index, in order; empty without one.
+  std::vector<double> m_FrameOffsets;
+  std::vector<double> m_FrameTimestamps;
+
+  ChunkLayoutType m_ChunkLayout{ CHUNK_SLICES };
+  bool            m_UseShuffle{ false };
+  SizeValueType   m_ChunkCacheSize{ 0 };
+  SizeValueType   m_ChunkCacheSlots{ 0 };
+  bool            m_UseParallelDecompression{ false };
 };
 } // end namespace itk
 
@@ -0,0 +1,246 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHDF5UltrasoundRecordingWriter_h
+#define itkHDF5UltrasoundRecordingWriter_h
+#include "UltrasoundExport.h"
+
+
+// itk namespace first suppresses
+// kwstyle error for the H5 namespace below
+namespace itk
+{}
+namespace H5
+{
+class H5File;
+class DataSet;
+} // namespace H5
+
+#include "itkImage.h"
+#include "itkImageIOBase.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+
+/** \class HDF5UltrasoundRecordingWriter
+ *
+ * \brief Record frames to an HDF5 ultrasound file on a dedicated I/O thread.
+ *
+ * The file has the layout read by HDF5UltrasoundImageIO: the frames are the
+ * elevational slices of \c /bimg, whose slowest dimension is unlimited and
+ * grows by one frame per write, and \c /eleAngle, extended with it, holds the
+ * angle given with each frame.  \c /axial and \c /lat are the sample
+ * locations of the frame given to Start().  The \c /frameIndex of
+ * HDF5UltrasoundImageIO lists the timestamp of each written frame, so that
+ * the recording can be searched by time.
+ *
+ * PushFrame() copies the frame into a queue of QueueCapacity preallocated
+ * buffers and returns, so that the acquisition or processing thread does not
+ * wait for the disk.  When the queue is full, the frame is dropped, and
+ * counted, unless BlockWhenFull is on.  Stop() writes the queued frames and
+ * closes the file.
+ *
+ * Only the I/O thread uses the HDF5 library between Start() and Stop().
+ * Unless the library is built thread safe, other HDF5 files should not be
+ * accessed meanwhile.
+ *
+ * \sa HDF5UltrasoundImageIO
+ *
+ * \ingroup Ultrasound
+ */
+class Ultrasound_EXPORT HDF5UltrasoundRecordingWriter : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(HDF5UltrasoundRecordingWriter);
+
+  /** Standard class type alias. */
+  using Self = HDF5UltrasoundRecordingWriter;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(HDF5UltrasoundRecordingWriter, Object);
+
+  static constexpr unsigned int FrameDimension = 2;
+  using FrameSizeType = Size<FrameDimension>;
+  using SpacingType = ImageBase<FrameDimension>::SpacingType;
+  using PointType = ImageBase<FrameDimension>::PointType;
+
+  itkSetStringMacro(FileName);
+  itkGetStringMacro(FileName);
+
+  /** Number of frame buffers of the queue.  Defaults to 8. */
+  itkSetClampMacro(QueueCapacity, SizeValueType, 1, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(QueueCapacity, SizeValueType);
+
+  /** Wait for a free buffer when the queue is full instead of dropping the
+   * frame.  Defaults to off. */
+  itkSetMacro(BlockWhenFull, bool);
+  itkGetConstMacro(BlockWhenFull, bool);
+  itkBooleanMacro(BlockWhenFull);
+
+  /** Deflate each frame, after an optional shuffle filter, see
+   * HDF5UltrasoundImageIO.  Defaults to off. */
+  itkSetMacro(UseCompression, bool);
+  itkGetConstMacro(UseCompression, bool);
+  itkBooleanMacro(UseCompression);
+  itkSetClampMacro(CompressionLevel, int, 1, 9);
+  itkGetConstMacro(CompressionLevel, int);
+  itkSetMacro(UseShuffle, bool);
+  itkGetConstMacro(UseShuffle, bool);
+  itkBooleanMacro(UseShuffle);
+
+  /** Create the file for frames of the size, sample locations and pixel type
+   * of the reference frame, and start the I/O thread. */
+  template <typename TPixel>
+  void
+  Start(const Image<TPixel, FrameDimension> * referenceFrame)
+  {
+    const auto & region = referenceFrame->GetLargestPossibleRegion();
+    this->StartRecording(region.GetSize(),
+                         referenceFrame->GetSpacing(),
+                         referenceFrame->GetOrigin(),
+                         ImageIOBase::MapPixelType<TPixel>::CType,
+                         sizeof(TPixel));
+  }
+
+  /** Queue a frame, of the size and pixel type given to Start(), acquired
+   * at the timestamp, in seconds.  Returns false if it was dropped. */
+  template <typename TPixel>
+  bool
+  PushFrame(const Image<TPixel, FrameDimension> * frame, double elevationalAngle, double timestamp)
+  {
+    if (ImageIOBase::MapPixelType<TPixel>::CType != m_ComponentType ||
+        frame->GetBufferedRegion().GetSize() != m_FrameSize)
+    {
+      itkExceptionMacro(<< "The frame differs from the reference frame.");
+    }
+    return this->PushFrameBuffer(frame->GetBufferPointer(), elevationalAngle, timestamp);
+  }
+
+  /** Queue a frame with its time since Start() as its timestamp. */
+  template <typename TPixel>
+  bool
+  PushFrame(const Image<TPixel, FrameDimension> * frame, double elevationalAngle = 0.0)
+  {
+    return this->PushFrame(frame, elevationalAngle, this->GetTimeSinceStart());
+  }
+
+  /** Write the queued frames, close the file and stop the I/O thread.
+   * Throws if a write failed. */
+  void
+  Stop();
+
+  /** Whether the I/O thread is running. */
+  bool
+  IsRecording() const
+  {
+    return m_IOThread.joinable();
+  }
+
+  /** Statistics since Start(). */
+  SizeValueType
+  GetNumberOfWrittenFrames() const;
+  SizeValueType
+  GetNumberOfDroppedFrames() const;
+  SizeValueType
+  GetQueueDepth() const;
+  SizeValueType
+  GetMaximumQueueDepth() const;
+
+protected:
+  HDF5UltrasoundRecordingWriter() = default;
+  ~HDF5UltrasoundRecordingWriter() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  void
+  StartRecording(const FrameSizeType & frameSize,
+                 const SpacingType &   spacing,
+                 const PointType &     origin,
+                 IOComponentEnum       componentType,
+                 SizeValueType         componentSize);
+
+  bool
+  PushFrameBuffer(const void * buffer, double elevationalAngle, double timestamp);
+
+  double
+  GetTimeSinceStart() const;
+
+  /** The loop of the I/O thread. */
+  void
+  WriteFrames();
+
+  /** Append a frame to the datasets. */
+  void
+  WriteFrame(const void * buffer, double elevationalAngle, double timestamp);
+
+  void
+  CloseH5File();
+
+  std::string   m_FileName;
+  SizeValueType m_QueueCapacity{ 8 };
+  bool          m_BlockWhenFull{ false };
+  bool          m_UseCompression{ false };
+  int           m_CompressionLevel{ 5 };
+  bool          m_UseShuffle{ false };
+
+  IOComponentEnum m_ComponentType{ IOComponentEnum::UNKNOWNCOMPONENTTYPE };
+  FrameSizeType   m_FrameSize{ { 0, 0 } };
+  SizeValueType   m_FrameBytes{ 0 };
+
+  H5::H5File *  m_H5File{ nullptr };
+  H5::DataSet * m_VoxelDataSet{ nullptr };
+  H5::DataSet * m_AngleDataSet{ nullptr };
+  H5::DataSet * m_FrameIndexDataSet{ nullptr };
+
+  std::chrono::steady_clock::time_point m_StartTime;
+
+  // The ring of frame buffers; m_QueueHead is the oldest queued frame.
+  std::vector<unsigned char> m_QueueBuffer;
+  std::vector<double>        m_QueueAngles;
+  std::vector<double>        m_QueueTimestamps;
+  SizeValueType              m_QueueHead{ 0 };
+  SizeValueType              m_QueueDepth{ 0 };
+  SizeValueType              m_MaximumQueueDepth{ 0 };
+  SizeValueType              m_NumberOfWrittenFrames{ 0 };
+  SizeValueType              m_NumberOfDroppedFrames{ 0 };
+  bool                       m_Stopping{ false };
+  std::string                m_WriteError;
+
+  mutable std::mutex      m_Mutex;
+  std::condition_variable m_FrameQueued;
+  std::condition_variable m_FrameWritten;
+  std::thread             m_IOThread;
+};
+} // end namespace itk
+
+#endif // itkHDF5UltrasoundRecordingWriter_h
@@ -0,0 +1,353 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHalfPrecision_h
+#define itkHalfPrecision_h
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#include "itkIntTypes.h"
+
+#if defined(__F16C__)
+#  include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
+
+namespace itk
+{
+
+/** \class Float16
+ * \brief IEEE 754 binary16 storage of a float.
+ *
+ * Half precision floats have 11 significant bits, a relative rounding error
+ * of at most 2^-11, and a range of +-65504, with subnormals down to 2^-24.
+ * They halve the memory of large intermediate images, such as the spectra of
+ * Spectra1DImageFilter, whose precision is limited by the estimation rather
+ * than the storage.
+ *
+ * Float16 is a storage type, not an arithmetic type: it converts to float,
+ * and is constructed from a float with rounding to nearest even, so
+ * computations are done in float and only the results are rounded.  Use
+ * ConvertHalfPrecisionBuffer() to convert arrays, with the F16C instructions
+ * on x86 or NEON on AArch64 when the compiler targets them.
+ *
+ * \sa BFloat16
+ *
+ * \ingroup Ultrasound
+ */
+class Float16
+{
+public:
+  Float16() = default;
+
+  explicit Float16(float value)
+    : m_Bits(FromFloat(value))
+  {}
+
+  operator float() const { return ToFloat(m_Bits); }
+
+  /** The binary16 encoding. */
+  uint16_t
+  GetBits() const
+  {
+    return m_Bits;
+  }
+
+  static Float16
+  FromBits(uint16_t bits)
+  {
+    Float16 value;
+    value.m_Bits = bits;
+    return value;
+  }
+
+  /** Encode a float, rounded to nearest even.  Values beyond the range
+   * become infinities, and NaNs stay quiet NaNs. */
+  static uint16_t
+  FromFloat(float value)
+  {
+#if defined(__F16C__)
+    return static_cast<uint16_t>(_cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT));
+#else
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t magnitude = bits & 0x7fffffffu;
+    if (magnitude >= 0x7f800000u)
+    {
+      return static_cast<uint16_t>(sign | (magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u));
+    }
+    if (magnitude >= 0x477ff000u)
+    {
+      // 65520 and above round to infinity.
+      return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    uint32_t shift = 13;
+    uint32_t significand = magnitude - 0x38000000u;
+    if (magnitude < 0x38800000u)
+    {
+      // Subnormal: the significand in units of 2^-24.
+      if (magnitude < 0x33000000u)
+      {
+        return static_cast<uint16_t>(sign);
+      }
+      shift = 126 - (magnitude >> 23);
+      significand = (magnitude & 0x7fffffu) | 0x800000u;
+    }
+    const uint32_t remainder = significand & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    uint32_t       rounded = significand >> shift;
+    if (remainder > halfway || (remainder == halfway && (rounded & 1u)))
+    {
+      ++rounded;
+    }
+    return static_cast<uint16_t>(sign | rounded);
+#endif
+  }
+
+  /** Decode, exactly. */
+  static float
+  ToFloat(uint16_t bits)
+  {
+#if defined(__F16C__)
+    return _cvtsh_ss(bits);
+#else
+    const uint32_t sign = static_cast<uint32_t>(bits & 0x8000u) << 16;
+    const uint32_t exponent = (bits >> 10) & 0x1fu;
+    uint32_t       mantissa = bits & 0x3ffu;
+    uint32_t       result;
+    if (exponent == 0x1fu)
+    {
+      result = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+      result = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+      result = sign;
+    }
+    else
+    {
+      // Normalize the subnormal.
+      uint32_t normalizedExponent = 113;
+      while ((mantissa & 0x400u) == 0)
+      {
+        mantissa <<= 1;
+        --normalizedExponent;
+      }
+      result = sign | (normalizedExponent << 23) | ((mantissa & 0x3ffu) << 13);
+    }
+    float value;
+    std::memcpy(&value, &result, sizeof(value));
+    return value;
+#endif
+  }
+
+private:
+  uint16_t m_Bits{ 0 };
+};
+
+
+/** \class BFloat16
+ * \brief bfloat16 storage of a float: its 16 most significant bits.
+ *
+ * bfloat16 keeps the range of float with 8 significant bits, a relative
+ * rounding error of at most 2^-8.  It suits values with a large dynamic
+ * range whose precision matters less, such as powers.  The conversions are
+ * shifts, which the compiler vectorizes.
+ *
+ * \sa Float16
+ *
+ * \ingroup Ultrasound
+ */
+class BFloat16
+{
+public:
+  BFloat16() = default;
+
+  explicit BFloat16(float value)
+    : m_Bits(FromFloat(value))
+  {}
+
+  operator float() const { return ToFloat(m_Bits); }
+
+  uint16_t
+  GetBits() const
+  {
+    return m_Bits;
+  }
+
+  static BFloat16
+  FromBits(uint16_t bits)
+  {
+    BFloat16 value;
+    value.m_Bits = bits;
+    return value;
+  }
+
+  /** Encode a float, rounded to nearest even.  NaNs stay quiet NaNs. */
+  static uint16_t
+  FromFloat(float value)
+  {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u)
+    {
+      return static_cast<uint16_t>((bits >> 16) | 0x40u);
+    }
+    return static_cast<uint16_t>((bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16);
+  }
+
+  static float
+  ToFloat(uint16_t bits)
+  {
+    const uint32_t result = static_cast<uint32_t>(bits) << 16;
+    float          value;
+    std::memcpy(&value, &result, sizeof(value));
+    return value;
+  }
+
+private:
+  uint16_t m_Bits{ 0 };
+};
+
+static_assert(sizeof(Float16) == 2 && sizeof(BFloat16) == 2, "Half precision floats must be stored in 2 bytes");
+
+inline std::ostream &
+operator<<(std::ostream & os, const Float16 & value)
+{
+  return os << static_cast<float>(value);
+}
+
+inline std::ostream &
+operator<<(std::ostream & os, const BFloat16 & value)
+{
+  return os << static_cast<float>(value);
+}
+
+
+/** \class HalfPrecisionTraits
+ * \brief The type in which the values of a storage type are computed: float
+ * for Float16 and BFloat16, the type itself otherwise.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename T>
+struct HalfPrecisionTraits
+{
+  using ValueType = T;
+  static constexpr bool IsHalfPrecision = false;
+};
+
+template <>
+struct HalfPrecisionTraits<Float16>
+{
+  using ValueType = float;
+  static constexpr bool IsHalfPrecision = true;
+};
+
+template <>
+struct HalfPrecisionTraits<BFloat16>
+{
+  using ValueType = float;
+  static constexpr bool IsHalfPrecision = true;
+};
+
+
+/** Store count floats in half precision. */
+inline void
+ConvertHalfPrecisionBuffer(const float * input, SizeValueType count, Float16 * output)
+{
+  SizeValueType ii = 0;
+#if defined(__F16C__)
+  for (; ii + 8 <= count; ii += 8)
+  {
+    const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(input + ii), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + ii), half);
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  for (; ii + 4 <= count; ii += 4)
+  {
+    const float16x4_t half = vcvt_f16_f32(vld1q_f32(input + ii));
+    vst1_u16(reinterpret_cast<uint16_t *>(output + ii), vreinterpret_u16_f16(half));
+  }
+#endif
+  for (; ii < count; ++ii)
+  {
+    output[ii] = Float16(input[ii]);
+  }
+}
+
+/** Load count half precision floats. */
+inline void
+ConvertHalfPrecisionBuffer(const Float16 * input, SizeValueType count, float * output)
+{
+  SizeValueType ii = 0;
+#if defined(__F16C__)
+  for (; ii + 8 <= count; ii += 8)
+  {
+    const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + ii));
+    _mm256_storeu_ps(output + ii, _mm256_cvtph_ps(half));
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  for (; ii + 4 <= count; ii += 4)
+  {
+    const uint16x4_t half = vld1_u16(reinterpret_cast<const uint16_t *>(input + ii));
+    vst1q_f32(output + ii, vcvt_f32_f16(vreinterpret_f16_u16(half)));
+  }
+#endif
+  for (; ii < count; ++ii)
+  {
+    output[ii] = input[ii];
+  }
+}
+
+inline void
+ConvertHalfPrecisionBuffer(const float * input, SizeValueType count, BFloat16 * output)
+{
+  for (SizeValueType ii = 0; ii < count; ++ii)
+  {
+    output[ii] = BFloat16(input[ii]);
+  }
+}
+
+inline void
+ConvertHalfPrecisionBuffer(const BFloat16 * input, SizeValueType count, float * output)
+{
+  for (SizeValueType ii = 0; ii < count; ++ii)
+  {
+    output[ii] = input[ii];
+  }
+}
+
+/** Copy, when the storage type is the computation type. */
+template <typename T>
+inline void
+ConvertHalfPrecisionBuffer(const T * input, SizeValueType count, T * output)
+{
+  std::copy(input, input + count, output);
+}
+
+} // end namespace itk
+
+#endif // itkHalfPrecision_h
@@ -21,6 +21,7 @@
 #include <complex>
 
 #include "itkImageToImageFilter.h"
+#include "itkFFT1DBackendSelector.h"
 
 namespace itk
 {
@@ -56,11 +57,23 @@ public:
   /** Customized object creation methods that support configuration-based
    * selection of FFT implementation.
    *
-   * Default implementation is VnlFFT1D.
+   * Default implementation is VnlFFT1D.  The backend set as the override of
+   * FFT1DBackendSelector, if any, takes precedence over the build time
+   * preference.
    */
   static Pointer
   New(void);
 
+  /** Create the filter of the given backend, or a null pointer when the
+   * backend is not available for the pixel type. */
+  static Pointer
+  New(FFT1DBackendSelector::BackendType backend);
+
+  /** Create the filter of the backend that is the fastest on this machine for
+   * numberOfLines lines of lineLength samples.  See FFT1DBackendSelector. */
+  static Pointer
+  NewForGeometry(SizeValueType lineLength, SizeValueType numberOfLines);
+
   /** Get the direction in which the filter is to be applied. */
   itkGetMacro(Direction, unsigned int);
 
@@ -84,12 +84,52 @@ struct Dispatch_1DComplexConjugateToReal_New<TSelfPointer, TInputImage, TOutputI
 
 #endif // ITKUltrasound_USE_clFFT
 
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage, typename TPixel>
+struct Dispatch_1DComplexConjugateToReal_FFTW_New
+{
+  static TSelfPointer
+  Apply()
+  {
+    return nullptr;
+  }
+};
+
+#ifdef ITK_USE_FFTWD
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DComplexConjugateToReal_FFTW_New<TSelfPointer, TInputImage, TOutputImage, double>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
+#ifdef ITK_USE_FFTWF
+template <typename TSelfPointer, typename TInputImage, typename TOutputImage>
+struct Dispatch_1DComplexConjugateToReal_FFTW_New<TSelfPointer, TInputImage, TOutputImage, float>
+{
+  static TSelfPointer
+  Apply()
+  {
+    return FFTWInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+  }
+};
+#endif
+
 template <typename TInputImage, typename TOutputImage>
 typename Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
 Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New()
 {
   Pointer smartPtr = ObjectFactory<Self>::Create();
 
+  const FFT1DBackendSelector::BackendType backend = FFT1DBackendSelector::GetOverride();
+  if (smartPtr.IsNull() && backend != FFT1DBackendSelector::DEFAULT_BACKEND)
+  {
+    smartPtr = New(backend);
+  }
+
   if (smartPtr.IsNull())
   {
     smartPtr = Dispatch_1DComplexConjugateToReal_New<
@@ -103,6 +143,38 @@ Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New()
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+typename Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Inverse1DFFTImageFilter<TInputImage, TOutputImage>::New(FFT1DBackendSelector::BackendType backend)
+{
+  using ValueType = typename NumericTraits<typename TOutputImage::PixelType>::ValueType;
+  switch (backend)
+  {
+    case FFT1DBackendSelector::VNL_BACKEND:
+      return VnlInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+    case FFT1DBackendSelector::FFTW_BACKEND:
+      return Dispatch_1DComplexConjugateToReal_FFTW_New<Pointer, TInputImage, TOutputImage, ValueType>::Apply();
+    case FFT1DBackendSelector::OPENCL_BACKEND:
+#ifdef ITKUltrasound_USE_clFFT
+      return OpenCLInverse1DFFTImageFilter<TInputImage, TOutputImage>::New().GetPointer();
+#else
+      return nullptr;
+#endif
+    default:
+      return New();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+typename Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Pointer
+Inverse1DFFTImageFilter<TInputImage, TOutputImage>::NewForGeometry(SizeValueType lineLength,
+                                                                   SizeValueType numberOfLines)
+{
+  return FFT1DBackendSelector::New<Self>("Inverse", lineLength, numberOfLines);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 Inverse1DFFTImageFilter<TInputImage, TOutputImage>::Inverse1DFFTImageFilter()
   : m_Direction(0)
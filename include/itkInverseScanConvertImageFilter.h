@@ -0,0 +1,197 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkInverseScanConvertImageFilter_h
+#define itkInverseScanConvertImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class InverseScanConvertImageFilter
+ * \brief Resample a Cartesian image onto the samples of a special coordinates
+ * image, such as a CurvilinearArraySpecialCoordinatesImage, with a cached
+ * mapping.
+ *
+ * The result is the one of a ResampleImageFilter with an identity transform
+ * and a LinearInterpolateImageFunction.  The physical location of the
+ * samples of a special coordinates image is expensive to compute, so the
+ * filter finds once, for every output sample, the location in the input
+ * buffer of the first of the neighbors to blend and the weights of all of
+ * them.  The following updates, e.g. at every iteration of a registration,
+ * only gather and blend the neighbors.
+ *
+ * The geometry of the output, including its special coordinates parameters,
+ * is copied from the ReferenceImage, which does not need to be allocated.
+ *
+ * The output can be restricted to an OutputRegionOfInterest, and to the
+ * nonzero pixels of an OutputMask defined on the largest possible region of
+ * the output.  Only the samples in both are mapped and computed; the others
+ * are set to the DefaultPixelValue, as are the samples outside of the input.
+ * An empty region of interest, the default, is the whole output.
+ *
+ * The mapping is rebuilt when the geometry of the input changes, when the
+ * region of interest changes, or when the reference image or the mask is
+ * replaced or modified.  The reference image and the mask are only read
+ * when the mapping is rebuilt.
+ *
+ * \sa CurvilinearArrayScanConvertImageFilter
+ * \sa ResampleImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT InverseScanConvertImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(InverseScanConvertImageFilter);
+
+  /** Standard class type alias. */
+  using Self = InverseScanConvertImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(InverseScanConvertImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using IndexType = typename OutputImageType::IndexType;
+  using PointType = typename OutputImageType::PointType;
+
+  using MaskPixelType = unsigned char;
+  using MaskImageType = Image<MaskPixelType, ImageDimension>;
+
+  /** Type of the interpolation weights held by the mapping. */
+  using WeightType = float;
+
+  /** Image the geometry of the output is copied from. */
+  itkSetConstObjectMacro(ReferenceImage, OutputImageType);
+  itkGetConstObjectMacro(ReferenceImage, OutputImageType);
+
+  /** Only the output samples where the mask is nonzero are computed. */
+  itkSetConstObjectMacro(OutputMask, MaskImageType);
+  itkGetConstObjectMacro(OutputMask, MaskImageType);
+
+  /** Only the output samples in the region are computed.  An empty region
+   * is the whole output. */
+  itkSetMacro(OutputRegionOfInterest, OutputImageRegionType);
+  itkGetConstReferenceMacro(OutputRegionOfInterest, OutputImageRegionType);
+
+  /** Value of the output samples that are not computed. */
+  itkSetMacro(DefaultPixelValue, OutputPixelType);
+  itkGetConstReferenceMacro(DefaultPixelValue, OutputPixelType);
+
+  /** Number of output samples interpolated from the input at each update. */
+  SizeValueType
+  GetNumberOfMappedSamples() const
+  {
+    return static_cast<SizeValueType>(m_OutputOffsets.size());
+  }
+
+  /** Number of times the mapping was built. */
+  itkGetConstMacro(NumberOfMappingBuilds, SizeValueType);
+
+  /** Include the modified times of the reference image and the mask. */
+  ModifiedTimeType
+  GetMTime() const override;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  // Begin concept checking
+  itkConceptMacro(SameDimensionCheck, (Concept::SameDimension<InputImageDimension, ImageDimension>));
+  // End concept checking
+#endif
+
+protected:
+  InverseScanConvertImageFilter();
+  virtual ~InverseScanConvertImageFilter() {}
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  /** The output is always generated whole, so that the mapping holds its
+   * offsets. */
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+private:
+  using GeometryKeyType = std::vector<double>;
+
+  /** Number of input pixels blended into an output sample. */
+  static constexpr unsigned int NumberOfNeighbors = 1u << ImageDimension;
+
+  /** The geometry of the input and the region of interest. */
+  GeometryKeyType
+  ComputeGeometryKey() const;
+
+  bool
+  MappingIsOutOfDate(const GeometryKeyType & key) const;
+
+  void
+  BuildMapping();
+
+  typename OutputImageType::ConstPointer m_ReferenceImage;
+  typename MaskImageType::ConstPointer   m_OutputMask;
+  OutputImageRegionType                  m_OutputRegionOfInterest;
+  OutputPixelType                        m_DefaultPixelValue;
+
+  /** For every mapped sample, its offset in the output buffer, the offset
+   * in the input buffer of the neighbor with the smallest index, and the
+   * weights of the neighbors. */
+  std::vector<SizeValueType>   m_OutputOffsets;
+  std::vector<OffsetValueType> m_SourceOffsets;
+  std::vector<WeightType>      m_Weights;
+
+  /** Offsets of the neighbors from the first one in the input buffer. */
+  OffsetValueType m_NeighborOffsets[NumberOfNeighbors];
+
+  GeometryKeyType         m_MappingKey;
+  const OutputImageType * m_MappedReferenceImage{ nullptr };
+  const MaskImageType *   m_MappedOutputMask{ nullptr };
+  TimeStamp               m_MappingTime;
+  SizeValueType           m_NumberOfMappingBuilds{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkInverseScanConvertImageFilter.hxx"
+#endif
+
+#endif // itkInverseScanConvertImageFilter_h
@@ -0,0 +1,348 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkInverseScanConvertImageFilter_hxx
+#define itkInverseScanConvertImageFilter_hxx
+
+#include "itkInverseScanConvertImageFilter.h"
+
+#include "itkContinuousIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::InverseScanConvertImageFilter()
+  : m_DefaultPixelValue(NumericTraits<OutputPixelType>::ZeroValue())
+{
+  for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+  {
+    m_NeighborOffsets[nn] = 0;
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+ModifiedTimeType
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::GetMTime() const
+{
+  ModifiedTimeType mtime = Superclass::GetMTime();
+  if (m_ReferenceImage)
+  {
+    mtime = std::max(mtime, m_ReferenceImage->GetMTime());
+  }
+  if (m_OutputMask)
+  {
+    mtime = std::max(mtime, m_OutputMask->GetMTime());
+  }
+  return mtime;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (!m_ReferenceImage)
+  {
+    itkExceptionMacro(<< "ReferenceImage is not set");
+  }
+  OutputImageType * output = this->GetOutput();
+  output->CopyInformation(m_ReferenceImage);
+  output->SetLargestPossibleRegion(m_ReferenceImage->GetLargestPossibleRegion());
+
+  if (m_OutputMask && m_OutputMask->GetLargestPossibleRegion() != output->GetLargestPossibleRegion())
+  {
+    itkExceptionMacro(<< "The OutputMask region " << m_OutputMask->GetLargestPossibleRegion()
+                      << " is not the region of the output " << output->GetLargestPossibleRegion());
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::ComputeGeometryKey() const -> GeometryKeyType
+{
+  const InputImageType * input = this->GetInput();
+
+  GeometryKeyType                             key;
+  const typename InputImageType::RegionType & inputRegion = input->GetLargestPossibleRegion();
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    key.push_back(static_cast<double>(inputRegion.GetIndex(ii)));
+    key.push_back(static_cast<double>(inputRegion.GetSize(ii)));
+    key.push_back(input->GetOrigin()[ii]);
+    key.push_back(input->GetSpacing()[ii]);
+    key.push_back(static_cast<double>(m_OutputRegionOfInterest.GetIndex(ii)));
+    key.push_back(static_cast<double>(m_OutputRegionOfInterest.GetSize(ii)));
+    for (unsigned int jj = 0; jj < ImageDimension; ++jj)
+    {
+      key.push_back(input->GetDirection()[ii][jj]);
+    }
+  }
+  return key;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+bool
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::MappingIsOutOfDate(const GeometryKeyType & key) const
+{
+  if (m_NumberOfMappingBuilds == 0 || key != m_MappingKey)
+  {
+    return true;
+  }
+  if (m_ReferenceImage.GetPointer() != m_MappedReferenceImage ||
+      m_ReferenceImage->GetMTime() > m_MappingTime.GetMTime())
+  {
+    return true;
+  }
+  if (m_OutputMask.GetPointer() != m_MappedOutputMask ||
+      (m_OutputMask && m_OutputMask->GetMTime() > m_MappingTime.GetMTime()))
+  {
+    return true;
+  }
+  return false;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::BuildMapping()
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  const MaskImageType *  mask = m_OutputMask.GetPointer();
+
+  OutputImageRegionType mappedRegion = output->GetLargestPossibleRegion();
+  if (m_OutputRegionOfInterest.GetNumberOfPixels() > 0 && !mappedRegion.Crop(m_OutputRegionOfInterest))
+  {
+    mappedRegion = OutputImageRegionType();
+  }
+
+  m_OutputOffsets.clear();
+  m_SourceOffsets.clear();
+  m_Weights.clear();
+
+  // A neighbor along a direction with a single sample is the sample itself.
+  const typename InputImageType::RegionType & inputRegion = input->GetBufferedRegion();
+  const OffsetValueType *                     inputOffsetTable = input->GetOffsetTable();
+  for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+  {
+    m_NeighborOffsets[nn] = 0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      if (((nn >> dim) & 1u) && inputRegion.GetSize(dim) > 1)
+      {
+        m_NeighborOffsets[nn] += inputOffsetTable[dim];
+      }
+    }
+  }
+
+  if (mappedRegion.GetNumberOfPixels() > 0)
+  {
+    // The physical location of the output samples is the expensive part, so
+    // the work units map their piece of the region into their own lists.
+    std::mutex          mutex;
+    MultiThreaderBase * multiThreader = this->GetMultiThreader();
+    multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+    multiThreader->template ParallelizeImageRegion<ImageDimension>(
+      mappedRegion,
+      [this, input, output, mask, &inputRegion, inputOffsetTable, &mutex](const OutputImageRegionType & lambdaRegion) {
+        std::vector<SizeValueType>   outputOffsets;
+        std::vector<OffsetValueType> sourceOffsets;
+        std::vector<WeightType>      weights;
+
+        ImageRegionConstIteratorWithIndex<OutputImageType> it(output, lambdaRegion);
+        for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+        {
+          const IndexType & index = it.GetIndex();
+          if (mask && mask->GetPixel(index) == NumericTraits<MaskPixelType>::ZeroValue())
+          {
+            continue;
+          }
+
+          PointType point;
+          output->TransformIndexToPhysicalPoint(index, point);
+          ContinuousIndex<double, ImageDimension> continuousIndex;
+          input->TransformPhysicalPointToContinuousIndex(point, continuousIndex);
+
+          // The same bounds and edge handling as LinearInterpolateImageFunction:
+          // the neighbors past the last sample are the last sample.
+          OffsetValueType sourceOffset = 0;
+          double          fractions[ImageDimension];
+          bool            inside = true;
+          for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+          {
+            const IndexValueType start = inputRegion.GetIndex(dim);
+            const IndexValueType end = start + static_cast<IndexValueType>(inputRegion.GetSize(dim)) - 1;
+            const double         value = continuousIndex[dim];
+            if (!(value >= start - 0.5 && value < end + 0.5))
+            {
+              inside = false;
+              break;
+            }
+            IndexValueType base = Math::Floor<IndexValueType>(value);
+            double         fraction = value - base;
+            if (base < start)
+            {
+              base = start;
+              fraction = 0.0;
+            }
+            else if (base >= end)
+            {
+              base = end > start ? end - 1 : end;
+              fraction = end > start ? 1.0 : 0.0;
+            }
+            sourceOffset += (base - start) * inputOffsetTable[dim];
+            fractions[dim] = fraction;
+          }
+          if (!inside)
+          {
+            continue;
+          }
+
+          outputOffsets.push_back(output->ComputeOffset(index));
+          sourceOffsets.push_back(sourceOffset);
+          for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+          {
+            double weight = 1.0;
+            for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+            {
+              weight *= ((nn >> dim) & 1u) ? fractions[dim] : 1.0 - fractions[dim];
+            }
+            weights.push_back(static_cast<WeightType>(weight));
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        this->m_OutputOffsets.insert(this->m_OutputOffsets.end(), outputOffsets.begin(), outputOffsets.end());
+        this->m_SourceOffsets.insert(this->m_SourceOffsets.end(), sourceOffsets.begin(), sourceOffsets.end());
+        this->m_Weights.insert(this->m_Weights.end(), weights.begin(), weights.end());
+      },
+      nullptr);
+  }
+
+  m_MappedReferenceImage = m_ReferenceImage.GetPointer();
+  m_MappedOutputMask = m_OutputMask.GetPointer();
+  m_MappingTime.Modified();
+  ++m_NumberOfMappingBuilds;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  output->FillBuffer(m_DefaultPixelValue);
+
+  GeometryKeyType key = this->ComputeGeometryKey();
+  if (this->MappingIsOutOfDate(key))
+  {
+    this->BuildMapping();
+    m_MappingKey = std::move(key);
+  }
+
+  using RealType = typename NumericTraits<InputPixelType>::RealType;
+  const InputPixelType * inputBuffer = input->GetBufferPointer();
+  OutputPixelType *      outputBuffer = output->GetBufferPointer();
+  const SizeValueType    numberOfSamples = this->GetNumberOfMappedSamples();
+
+  OffsetValueType neighborOffsets[NumberOfNeighbors];
+  std::copy(m_NeighborOffsets, m_NeighborOffsets + NumberOfNeighbors, neighborOffsets);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  const SizeValueType numberOfWorkUnits = multiThreader->GetNumberOfWorkUnits();
+  const SizeValueType chunkSize =
+    std::max<SizeValueType>((numberOfSamples + numberOfWorkUnits - 1) / numberOfWorkUnits, 1);
+  const SizeValueType numberOfChunks = (numberOfSamples + chunkSize - 1) / chunkSize;
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfChunks,
+    [&](SizeValueType chunk) {
+      const SizeValueType firstSample = chunk * chunkSize;
+      const SizeValueType lastSample = std::min(firstSample + chunkSize, numberOfSamples);
+      for (SizeValueType ii = firstSample; ii < lastSample; ++ii)
+      {
+        const InputPixelType * source = inputBuffer + m_SourceOffsets[ii];
+        const WeightType *     weights = m_Weights.data() + ii * NumberOfNeighbors;
+        RealType               value = NumericTraits<RealType>::ZeroValue();
+        for (unsigned int nn = 0; nn < NumberOfNeighbors; ++nn)
+        {
+          value += weights[nn] * static_cast<RealType>(source[neighborOffsets[nn]]);
+        }
+        outputBuffer[m_OutputOffsets[ii]] = static_cast<OutputPixelType>(value);
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+InverseScanConvertImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  itkPrintSelfObjectMacro(ReferenceImage);
+  itkPrintSelfObjectMacro(OutputMask);
+  os << indent << "OutputRegionOfInterest: " << m_OutputRegionOfInterest << std::endl;
+  os << indent << "DefaultPixelValue: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(m_DefaultPixelValue) << std::endl;
+  os << indent << "NumberOfMappedSamples: " << this->GetNumberOfMappedSamples() << std::endl;
+  os << indent << "NumberOfMappingBuilds: " << m_NumberOfMappingBuilds << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkInverseScanConvertImageFilter_hxx
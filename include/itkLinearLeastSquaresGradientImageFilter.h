@@ -23,6 +23,8 @@
 #include "itkCovariantVector.h"
 #include "itkNeighborhoodAlgorithm.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -37,6 +39,12 @@ namespace itk
  * sign of the underlying function.  If there are a majority of consecutive
  * values with the same sign, then only those values are used in the linear fit.
  *
+ * The weights of the fit only depend on the number of values fitted, so they
+ * are computed once per update, and the slope is a correlation of the values
+ * with those weights.  Away from the boundary of the image, the values are
+ * read directly along each direction from the input buffer, and only the
+ * boundary faces go through the neighborhood boundary condition.
+ *
  * \sa GradientImageFilter
  *
  * \ingroup GradientFilters
@@ -121,6 +129,16 @@ protected:
   inline TOutputValueType
   GetDerivative(const std::slice & s, const NeighborhoodIteratorType & nit);
 
+  /** Slope of the fit to the size values given by value(0), ...,
+   * value(size - 1), with the precomputed weights. */
+  template <typename TValueFunction>
+  OperatorValueType
+  FitSlope(const TValueFunction & value, unsigned int size) const;
+
+  /** Compute the weights of the fits. */
+  void
+  BeforeThreadedGenerateData() override;
+
   /** GradientImageFilter needs a larger input requested region than
    * the output requested region.  As such, GradientImageFilter needs
    * to provide an implementation for GenerateInputRequestedRegion()
@@ -168,6 +186,10 @@ private:
   // flag to take or not the image direction into account
   // when computing the derivatives.
   bool m_UseImageDirection;
+
+  /** Weights of the slope of the fit to n values, for every n up to the
+   * largest diameter. */
+  std::vector<std::vector<OperatorValueType>> m_FitWeights;
 };
 
 } // end namespace itk
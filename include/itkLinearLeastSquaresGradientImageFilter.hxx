@@ -20,11 +20,13 @@
 
 #include "itkLinearLeastSquaresGradientImageFilter.h"
 
+#include <algorithm>
+
 #include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 
 #include "vnl/vnl_math.h"
-#include "vnl/algo/vnl_svd.h"
 
 namespace itk
 {
@@ -88,63 +90,86 @@ LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputVa
 
 
 template <typename TInputImage, typename TOperatorValueType, typename TOutputValueType>
-TOutputValueType
-LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputValueType>::GetDerivative(
-  const std::slice &                             s,
-  const ConstNeighborhoodIterator<TInputImage> & nit)
+void
+LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputValueType>::BeforeThreadedGenerateData()
 {
+  Superclass::BeforeThreadedGenerateData();
+
+  SizeValueType maximumSize = 1;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    maximumSize = std::max<SizeValueType>(maximumSize, 2 * m_Radius[i] + 1);
+  }
+
+  // The slope of the least squares fit of a line to (j, y_j), j = 0, ..., n - 1,
+  // is sum_j (j - (n - 1) / 2) y_j / sum_j (j - (n - 1) / 2)^2.  It is zero
+  // for a single value, as the minimum norm solution.
+  m_FitWeights.assign(maximumSize + 1, std::vector<OperatorValueType>());
+  for (SizeValueType n = 2; n <= maximumSize; ++n)
+  {
+    const double center = 0.5 * static_cast<double>(n - 1);
+    const double sumOfSquares = static_cast<double>(n) * static_cast<double>(n * n - 1) / 12.0;
+    m_FitWeights[n].resize(n);
+    for (SizeValueType j = 0; j < n; ++j)
+    {
+      m_FitWeights[n][j] = static_cast<OperatorValueType>((static_cast<double>(j) - center) / sumOfSquares);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOperatorValueType, typename TOutputValueType>
+template <typename TValueFunction>
+auto
+LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputValueType>::FitSlope(
+  const TValueFunction & value,
+  unsigned int           size) const -> OperatorValueType
+{
+  // The fit is over as many values from the first one as the longest run of
+  // a sign, unless the run is shorter than the radius.
   unsigned int maxConsistentCount = 1;
   unsigned int currentConsistentCount = maxConsistentCount;
-  int          previousSgn = vnl_math_sgn0(nit.GetPixel(s.start()));
-  int          nextSgn;
-  unsigned int maxConsistentIdx = 0;
-  unsigned int currentConsistentIdx = maxConsistentIdx;
-  unsigned int sliceIdx;
-  unsigned int nitIdx;
-  for (sliceIdx = 1, nitIdx = s.start() + s.stride(); sliceIdx < s.size(); ++sliceIdx, nitIdx += s.stride())
+  int          previousSgn = vnl_math_sgn0(value(0));
+  for (unsigned int sliceIdx = 1; sliceIdx < size; ++sliceIdx)
   {
-    nextSgn = vnl_math_sgn0(nit.GetPixel(nitIdx));
+    const int nextSgn = vnl_math_sgn0(value(sliceIdx));
     if (nextSgn == previousSgn)
     {
       ++currentConsistentCount;
-      if (currentConsistentCount > maxConsistentCount)
-      {
-        if (currentConsistentCount != maxConsistentCount + 1)
-        {
-          maxConsistentIdx = currentConsistentIdx;
-        }
-        maxConsistentCount = currentConsistentCount;
-      }
+      maxConsistentCount = std::max(maxConsistentCount, currentConsistentCount);
     }
     else
     {
       currentConsistentCount = 1;
-      currentConsistentIdx = sliceIdx;
     }
     previousSgn = nextSgn;
   }
-
-  // If the max consistent count is less than the radius, then use the entire
-  // slice.
-  if (maxConsistentCount < (s.size() - 1) / 2)
+  if (maxConsistentCount < (size - 1) / 2)
   {
-    maxConsistentIdx = 0;
-    maxConsistentCount = s.size();
+    maxConsistentCount = size;
   }
 
-  vnl_matrix<OperatorValueType> A(maxConsistentCount, 2);
-  A.set_column(1, NumericTraits<OperatorValueType>::One);
-  vnl_vector<OperatorValueType> y(maxConsistentCount);
-  for (unsigned int i = 0, nitIdx = s.start() + maxConsistentIdx * s.stride(); i < maxConsistentCount;
-       ++i, nitIdx += s.stride())
+  const std::vector<OperatorValueType> & weights = m_FitWeights[maxConsistentCount];
+  OperatorValueType                      slope = NumericTraits<OperatorValueType>::ZeroValue();
+  for (unsigned int j = 0; j < weights.size(); ++j)
   {
-    A[i][0] = i;
-    y[i] = nit.GetPixel(nitIdx);
+    slope += weights[j] * static_cast<OperatorValueType>(value(j));
   }
+  return slope;
+}
+
 
-  return static_cast<TOutputValueType>(vnl_svd<OperatorValueType>(A).solve(y)[0]);
+template <typename TInputImage, typename TOperatorValueType, typename TOutputValueType>
+TOutputValueType
+LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputValueType>::GetDerivative(
+  const std::slice &                             s,
+  const ConstNeighborhoodIterator<TInputImage> & nit)
+{
+  const auto value = [&s, &nit](unsigned int sliceIdx) { return nit.GetPixel(s.start() + sliceIdx * s.stride()); };
+  return static_cast<TOutputValueType>(this->FitSlope(value, static_cast<unsigned int>(s.size())));
 }
 
+
 template <typename TInputImage, typename TOperatorValueType, typename TOutputValueType>
 void
 LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputValueType>::DynamicThreadedGenerateData(
@@ -168,11 +193,6 @@ LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputVa
   faceList = bC(inputImage, outputRegionForThread, m_Radius);
 
   typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType>::FaceListType::iterator fit;
-  fit = faceList.begin();
-
-  // Initialize the x_slice array
-  nit = ConstNeighborhoodIterator<InputImageType>(m_Radius, inputImage, *fit);
-
   typename InputImageType::SpacingType spacingScale;
   if (m_UseImageSpacing)
   {
@@ -183,9 +203,54 @@ LinearLeastSquaresGradientImageFilter<TInputImage, TOperatorValueType, TOutputVa
     spacingScale.Fill(1);
   }
 
-  // Process non-boundary face and then each of the boundary faces.
-  // These are N-d regions which border the edge of the buffer.
-  for (fit = faceList.begin(); fit != faceList.end(); ++fit)
+  // The non-boundary face is processed along the lines of the first
+  // direction, with the values of the slices read directly from the buffer.
+  fit = faceList.begin();
+  if (fit->GetNumberOfPixels() > 0)
+  {
+    const InputPixelType *  inputBuffer = inputImage->GetBufferPointer();
+    OutputPixelType *       outputBuffer = outputImage->GetBufferPointer();
+    const OffsetValueType * offsetTable = inputImage->GetOffsetTable();
+    OffsetValueType         strides[ImageDimension];
+    strides[0] = 1;
+    for (i = 1; i < ImageDimension; ++i)
+    {
+      strides[i] = offsetTable[i];
+    }
+    const SizeValueType lineSize = fit->GetSize(0);
+
+    OutputImageRegionType lineStartRegion = *fit;
+    lineStartRegion.SetSize(0, 1);
+    ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(outputImage, lineStartRegion);
+    for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+    {
+      const InputPixelType * inputLine = inputBuffer + inputImage->ComputeOffset(lineIt.GetIndex());
+      OutputPixelType *      outputLine = outputBuffer + outputImage->ComputeOffset(lineIt.GetIndex());
+      for (SizeValueType ii = 0; ii < lineSize; ++ii)
+      {
+        for (i = 0; i < ImageDimension; ++i)
+        {
+          const OffsetValueType  stride = strides[i];
+          const InputPixelType * first = inputLine + ii - static_cast<OffsetValueType>(m_Radius[i]) * stride;
+          const auto value = [first, stride](unsigned int sliceIdx) { return first[sliceIdx * stride]; };
+          gradient[i] = static_cast<TOutputValueType>(this->FitSlope(value, 2 * m_Radius[i] + 1)) / spacingScale[i];
+        }
+
+        if (this->m_UseImageDirection)
+        {
+          inputImage->TransformLocalVectorToPhysicalVector(gradient, outputLine[ii]);
+        }
+        else
+        {
+          outputLine[ii] = gradient;
+        }
+      }
+    }
+  }
+
+  // Process each of the boundary faces.  These are N-d regions which border
+  // the edge of the buffer.
+  for (++fit; fit != faceList.end(); ++fit)
   {
     nit = ConstNeighborhoodIterator<InputImageType>(m_Radius, inputImage, *fit);
     it = ImageRegionIterator<OutputImageType>(outputImage, *fit);
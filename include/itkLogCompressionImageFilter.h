@@ -0,0 +1,125 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkLogCompressionImageFilter_h
+#define itkLogCompressionImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class LogCompressionImageFilter
+ * \brief Compress a linear envelope to a display image in decibels, in one
+ * pass.
+ *
+ * Every envelope sample is converted to decibels, 20 log10 of the envelope,
+ * and the levels from ReferenceLevel - DynamicRange to ReferenceLevel are
+ * mapped linearly to the full range of the integer output pixel, e.g. 0 to
+ * 255 for the default unsigned char, with the levels outside clamped.  This
+ * replaces the plus one, the log compression and the intensity windowing of
+ * three passes over float images with a single pass that writes the
+ * smaller display image.
+ *
+ * The logarithm is the exponent of the float envelope plus a table of the
+ * base 2 logarithm of its mantissa, indexed by its leading bits, so that
+ * the pass has no branch and no call.  Its error, below 0.002 dB, is far
+ * below the step of the output levels.  Zero and negative envelopes give 0.
+ *
+ * The input is typically the envelope of a BModeImageFilter with
+ * CacheEnvelope on, see BModeImageFilter::GetEnvelope(), after its time gain
+ * compensation.
+ *
+ * \sa BModeImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage = Image<unsigned char, TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT LogCompressionImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(LogCompressionImageFilter);
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Standard class type alias. */
+  using Self = LogCompressionImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LogCompressionImageFilter, ImageToImageFilter);
+
+  /** Number of leading bits of the mantissa that index the logarithm
+   * table. */
+  static constexpr unsigned int LogTableBits = 12;
+
+  /** Set/Get the range of levels, in dB, that spans the output.  Defaults to
+   * 60 dB. */
+  itkSetClampMacro(DynamicRange, double, 1e-3, NumericTraits<double>::max());
+  itkGetConstMacro(DynamicRange, double);
+
+  /** Set/Get the level, in dB, of the envelope mapped to the largest output
+   * value.  Defaults to 0 dB, an envelope of 1. */
+  itkSetMacro(ReferenceLevel, double);
+  itkGetConstMacro(ReferenceLevel, double);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  itkConceptMacro(OutputIsIntegerCheck, (Concept::IsInteger<OutputPixelType>));
+#endif
+
+protected:
+  LogCompressionImageFilter();
+  ~LogCompressionImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+private:
+  double m_DynamicRange{ 60.0 };
+  double m_ReferenceLevel{ 0.0 };
+
+  /** Base 2 logarithm of the mantissas of every table entry, and the scale
+   * and offset from the base 2 logarithm to the output value. */
+  std::vector<float> m_LogTable;
+  float              m_Scale{ 0.0f };
+  float              m_Offset{ 0.0f };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkLogCompressionImageFilter.hxx"
+#endif
+
+#endif // itkLogCompressionImageFilter_h
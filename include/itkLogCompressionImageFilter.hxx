@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkLogCompressionImageFilter_hxx
+#define itkLogCompressionImageFilter_hxx
+
+#include "itkLogCompressionImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+LogCompressionImageFilter<TInputImage, TOutputImage>::LogCompressionImageFilter()
+{
+  this->DynamicMultiThreadingOn();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+LogCompressionImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // The logarithm at the middle of the mantissas of every entry.
+  const unsigned int tableSize = 1u << LogTableBits;
+  m_LogTable.resize(tableSize);
+  for (unsigned int ii = 0; ii < tableSize; ++ii)
+  {
+    m_LogTable[ii] = static_cast<float>(std::log2(1.0 + (ii + 0.5) / tableSize));
+  }
+
+  // The output is (20 log10(2) log2(envelope) - ReferenceLevel + DynamicRange) * maximum / DynamicRange, plus
+  // one half to round when it is truncated.
+  const double maximum = static_cast<double>(NumericTraits<OutputPixelType>::max());
+  m_Scale = static_cast<float>(20.0 * std::log10(2.0) * maximum / m_DynamicRange);
+  m_Offset = static_cast<float>((m_DynamicRange - m_ReferenceLevel) * maximum / m_DynamicRange + 0.5);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+LogCompressionImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType *      outputImage = this->GetOutput();
+  const InputPixelType * inputBuffer = inputImage->GetBufferPointer();
+  OutputPixelType *      outputBuffer = outputImage->GetBufferPointer();
+  const SizeValueType    lineSize = outputRegionForThread.GetSize()[0];
+
+  const float * logTable = m_LogTable.data();
+  const float   scale = m_Scale;
+  const float   offset = m_Offset;
+  const float   maximum = static_cast<float>(NumericTraits<OutputPixelType>::max());
+  // The envelopes below the smallest normal float, zero and negative ones
+  // included, are clamped to it, whose level is clamped to 0.
+  const float smallest = std::numeric_limits<float>::min();
+
+  // for every line along the first direction, addressed directly in the
+  // buffers so that the compression vectorizes
+  OutputImageRegionType lineStartRegion = outputRegionForThread;
+  lineStartRegion.SetSize(0, 1);
+  ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(outputImage, lineStartRegion);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+  {
+    const InputPixelType * inputLine = inputBuffer + inputImage->ComputeOffset(lineIt.GetIndex());
+    OutputPixelType *      outputLine = outputBuffer + outputImage->ComputeOffset(lineIt.GetIndex());
+    for (SizeValueType ii = 0; ii < lineSize; ++ii)
+    {
+      const float   envelope = std::max(static_cast<float>(inputLine[ii]), smallest);
+      std::uint32_t bits;
+      std::memcpy(&bits, &envelope, sizeof(bits));
+      const float exponent = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 127);
+      const float log2Envelope = exponent + logTable[(bits >> (23 - LogTableBits)) & ((1u << LogTableBits) - 1)];
+      const float value = std::min(std::max(scale * log2Envelope + offset, 0.0f), maximum);
+      outputLine[ii] = static_cast<OutputPixelType>(value);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+LogCompressionImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "DynamicRange: " << m_DynamicRange << std::endl;
+  os << indent << "ReferenceLevel: " << m_ReferenceLevel << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkLogCompressionImageFilter_hxx
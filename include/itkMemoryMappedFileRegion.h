@@ -0,0 +1,87 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMemoryMappedFileRegion_h
+#define itkMemoryMappedFileRegion_h
+
+#include "itkLightObject.h"
+#include "itkObjectFactory.h"
+
+#include "UltrasoundExport.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class MemoryMappedFileRegion
+ *
+ * \brief A copy on write memory mapping of a range of bytes of a file.
+ *
+ * The pages are read from the file on first access, and writes to the
+ * mapping are private to the process.  The mapping is released with the
+ * object.
+ *
+ * \ingroup Ultrasound
+ * */
+class Ultrasound_EXPORT MemoryMappedFileRegion : public LightObject
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(MemoryMappedFileRegion);
+
+  using Self = MemoryMappedFileRegion;
+  using Superclass = LightObject;
+  using Pointer = SmartPointer<Self>;
+
+  itkNewMacro(Self);
+  itkTypeMacro(MemoryMappedFileRegion, LightObject);
+
+  /** Map length bytes of the file, starting at offset, which does not need
+   * to be aligned to the pages. */
+  void
+  Map(const std::string & fileName, SizeValueType offset, SizeValueType length);
+
+  void
+  Unmap();
+
+  /** Pointer to the byte at the offset, or nullptr when not mapped. */
+  void *
+  GetPointer() const
+  {
+    return m_Pointer;
+  }
+
+  SizeValueType
+  GetLength() const
+  {
+    return m_Length;
+  }
+
+protected:
+  MemoryMappedFileRegion() = default;
+  ~MemoryMappedFileRegion() override;
+
+private:
+  void *        m_Mapping{ nullptr };
+  SizeValueType m_MappingLength{ 0 };
+  void *        m_Pointer{ nullptr };
+  SizeValueType m_Length{ 0 };
+};
+
+} // end namespace itk
+
+#endif
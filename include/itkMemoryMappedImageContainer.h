@@ -0,0 +1,74 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMemoryMappedImageContainer_h
+#define itkMemoryMappedImageContainer_h
+
+#include "itkImportImageContainer.h"
+#include "itkMemoryMappedFileRegion.h"
+
+namespace itk
+{
+
+/** \class MemoryMappedImageContainer
+ *
+ * \brief An image pixel container whose elements are a copy on write memory
+ * mapping of a file.
+ *
+ * MapFile() imports the elements stored contiguously at an offset of a file,
+ * in the order of the image buffer, without reading them.  The mapping lives
+ * as long as the container.
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TElementIdentifier, typename TElement>
+class ITK_TEMPLATE_EXPORT MemoryMappedImageContainer : public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(MemoryMappedImageContainer);
+
+  using Self = MemoryMappedImageContainer;
+  using Superclass = ImportImageContainer<TElementIdentifier, TElement>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using ElementIdentifier = TElementIdentifier;
+  using Element = TElement;
+
+  itkNewMacro(Self);
+  itkTypeMacro(MemoryMappedImageContainer, ImportImageContainer);
+
+  /** Map size elements of the file, starting at the byte offset. */
+  void
+  MapFile(const std::string & fileName, SizeValueType offset, ElementIdentifier size)
+  {
+    m_FileRegion = MemoryMappedFileRegion::New();
+    m_FileRegion->Map(fileName, offset, size * sizeof(Element));
+    this->SetImportPointer(static_cast<Element *>(m_FileRegion->GetPointer()), size, false);
+  }
+
+protected:
+  MemoryMappedImageContainer() = default;
+  ~MemoryMappedImageContainer() override = default;
+
+private:
+  MemoryMappedFileRegion::Pointer m_FileRegion;
+};
+
+} // end namespace itk
+
+#endif // itkMemoryMappedImageContainer_h
@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNUMAMultiThreader_h
+#define itkNUMAMultiThreader_h
+
+#include "itkPlatformMultiThreader.h"
+
+#include "UltrasoundExport.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class NUMAMultiThreader
+ *
+ * \brief A multi-threader that pins every work unit to the CPUs of a NUMA
+ * node.
+ *
+ * As with PlatformMultiThreader, every work unit runs on its own thread, and
+ * with ParallelizeImageRegion(), as used by the dynamic multi-threading of
+ * the filters, or with the classic ThreadedGenerateData(), work unit i
+ * processes the i-th split of the region, along the slowest direction
+ * first.  The work units are divided into contiguous groups, one per NUMA
+ * node, and every work unit is pinned to the CPUs of its node before it
+ * runs, and its previous affinity is restored after it, so that the thread
+ * of the caller, which runs work unit 0, is not left pinned.  Consecutive
+ * slabs of a volume are thus processed on the same node.
+ *
+ * The filters of the module allocate their outputs of scalar pixels without
+ * initializing them, so the pages of a split are first touched, and
+ * allocated by the operating system, on the node of the work unit that
+ * generates it.  Later filters with the same number of work units read
+ * them from the same node.  The std::complex outputs of the FFT, analytic
+ * signal and frequency domain filters, including the intermediates of
+ * BModeImageFilter, are allocated with a FirstTouchImageContainer, which
+ * does not construct them, and zeroed by the same work units, see
+ * AllocateFirstTouch().
+ *
+ * Set it as the MultiThreader of a filter, or call RegisterAsDefault() so
+ * that MultiThreaderBase::New() creates it for every filter, including the
+ * internal filters of BModeImageFilter, Spectra1DImageFilter, the FFT
+ * filters and BlockMatching::DisplacementPipeline, that is created
+ * afterwards.
+ *
+ * The nodes are read from /sys/devices/system/node on Linux.  Elsewhere, or
+ * when there is only one node, the work units are not pinned.
+ *
+ * \ingroup Ultrasound
+ * */
+class Ultrasound_EXPORT NUMAMultiThreader : public PlatformMultiThreader
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NUMAMultiThreader);
+
+  /** Standard class type alias. */
+  using Self = NUMAMultiThreader;
+  using Superclass = PlatformMultiThreader;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkNewMacro(Self);
+  itkTypeMacro(NUMAMultiThreader, PlatformMultiThreader);
+
+  /** Number of NUMA nodes, 1 when they are not known. */
+  unsigned int
+  GetNumberOfNodes() const
+  {
+    return static_cast<unsigned int>(m_NodeCPUs.size());
+  }
+
+  /** Node of a work unit of the given number of work units. */
+  unsigned int
+  GetWorkUnitNode(ThreadIdType workUnit, ThreadIdType numberOfWorkUnits) const;
+
+  /** The method is executed by every work unit after it is pinned. */
+  void
+  SetSingleMethod(ThreadFunctionType method, void * data) override;
+
+  /** Make MultiThreaderBase::New() create a NUMAMultiThreader. */
+  static void
+  RegisterAsDefault();
+
+protected:
+  NUMAMultiThreader();
+  ~NUMAMultiThreader() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  PinnedSingleMethod(void * arg);
+
+  /** Pin the calling thread to the CPUs of the node of the work unit. */
+  void
+  PinWorkUnit(ThreadIdType workUnit, ThreadIdType numberOfWorkUnits) const;
+
+  /** CPUs of every node. */
+  std::vector<std::vector<unsigned int>> m_NodeCPUs;
+
+  ThreadFunctionType m_PinnedMethod{ nullptr };
+  void *             m_PinnedData{ nullptr };
+};
+
+} // end namespace itk
+
+#endif // itkNUMAMultiThreader_h
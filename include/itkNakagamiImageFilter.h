@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNakagamiImageFilter_h
+#define itkNakagamiImageFilter_h
+
+#include "itkBoxImageFilter.h"
+#include "itkImage.h"
+
+namespace itk
+{
+
+/** \class NakagamiImageFilter
+ * \brief Parametric maps of the Nakagami distribution of the envelope over a
+ * box around every pixel.
+ *
+ * The input is the linear envelope, e.g. the modulus of the analytic signal
+ * or of the IQ data.  With the local second and fourth moments of the
+ * envelope R over the box, the scale parameter is Omega = E[R^2] and the
+ * shape parameter is m = Omega^2 / (E[R^4] - Omega^2), the moment estimate:
+ * m is 1 for fully developed speckle, below 1 for pre-Rayleigh and above 1
+ * for post-Rayleigh scattering.  Output 0, GetShapeOutput(), has m, and
+ * output 1, GetScaleOutput(), has Omega.  Where the square of the envelope
+ * is constant over the box, m is the largest output value.
+ *
+ * As in BoxSigmaSqrtNMinusOneImageFilter, the sums over the boxes are taken
+ * from a summed-area table of R^2 and R^4 per work unit, built with
+ * compensated running sums along each direction, so that the cost per pixel
+ * does not depend on the radius.  The boxes are cropped at the boundary of
+ * the image.
+ *
+ * \sa BoxSigmaSqrtNMinusOneImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage = Image<float, TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT NakagamiImageFilter : public BoxImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NakagamiImageFilter);
+
+  /** Standard class type alias. */
+  using Self = NakagamiImageFilter;
+  using Superclass = BoxImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(NakagamiImageFilter, BoxImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  using InputImageType = TInputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename Superclass::OutputImageRegionType;
+
+  /** The shape parameter m. */
+  OutputImageType *
+  GetShapeOutput()
+  {
+    return this->GetOutput(0);
+  }
+
+  /** The scale parameter Omega. */
+  OutputImageType *
+  GetScaleOutput()
+  {
+    return this->GetOutput(1);
+  }
+
+protected:
+  NakagamiImageFilter();
+  ~NakagamiImageFilter() override = default;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkNakagamiImageFilter.hxx"
+#endif
+
+#endif // itkNakagamiImageFilter_h
@@ -0,0 +1,175 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkNakagamiImageFilter_hxx
+#define itkNakagamiImageFilter_hxx
+
+#include "itkNakagamiImageFilter.h"
+
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVector.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+NakagamiImageFilter<TInputImage, TOutputImage>::NakagamiImageFilter()
+{
+  // The second output is the scale parameter.
+  this->SetNumberOfRequiredOutputs(2);
+  this->SetNthOutput(1, this->MakeOutput(1));
+  this->DynamicMultiThreadingOn();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+NakagamiImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  using AccumulateValueType = double;
+  using AccumulatePixelType = Vector<AccumulateValueType, 2>;
+  using AccumulateImageType = Image<AccumulatePixelType, ImageDimension>;
+  using RegionType = typename InputImageType::RegionType;
+  using IndexType = typename InputImageType::IndexType;
+
+  using IndexValueType = typename IndexType::IndexValueType;
+
+  const InputImageType *                    inputImage = this->GetInput();
+  const typename InputImageType::SizeType & radius = this->GetRadius();
+
+  // The table has the sample before every box, so the region is padded by
+  // one more than the radius.
+  typename InputImageType::SizeType tableRadius;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    tableRadius[i] = radius[i] + 1;
+  }
+  RegionType tableRegion = outputRegionForThread;
+  tableRegion.PadByRadius(tableRadius);
+  tableRegion.Crop(inputImage->GetRequestedRegion());
+
+  typename AccumulateImageType::Pointer table = AccumulateImageType::New();
+  table->SetRegions(tableRegion);
+  table->Allocate();
+
+  // The squared and fourth powers of the envelope, summed along each
+  // direction in turn with compensated running sums.
+  ImageRegionConstIterator<InputImageType> inputIt(inputImage, tableRegion);
+  ImageRegionIterator<AccumulateImageType> tableIt(table, tableRegion);
+  AccumulatePixelType                      moments;
+  for (inputIt.GoToBegin(), tableIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++tableIt)
+  {
+    const AccumulateValueType value = static_cast<AccumulateValueType>(inputIt.Get());
+    moments[0] = value * value;
+    moments[1] = moments[0] * moments[0];
+    tableIt.Set(moments);
+  }
+  using LineIteratorType = ImageLinearIteratorWithIndex<AccumulateImageType>;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    LineIteratorType lineIt(table, tableRegion);
+    lineIt.SetDirection(dim);
+    for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); lineIt.NextLine())
+    {
+      AccumulatePixelType sum;
+      AccumulatePixelType compensation;
+      sum.Fill(0.0);
+      compensation.Fill(0.0);
+      for (lineIt.GoToBeginOfLine(); !lineIt.IsAtEndOfLine(); ++lineIt)
+      {
+        const AccumulatePixelType & value = lineIt.Get();
+        for (unsigned int k = 0; k < 2; ++k)
+        {
+          const AccumulateValueType compensated = value[k] - compensation[k];
+          const AccumulateValueType total = sum[k] + compensated;
+          compensation[k] = (total - sum[k]) - compensated;
+          sum[k] = total;
+        }
+        lineIt.Set(sum);
+      }
+    }
+  }
+
+  // The sum over a box, cropped by the table region, is the signed sum of
+  // the table at its 2^ImageDimension corners: the last sample of the box,
+  // or the one before its first sample, which is 0 outside the table.
+  const IndexType &           tableStart = tableRegion.GetIndex();
+  const AccumulatePixelType * tableBuffer = table->GetBufferPointer();
+  const OutputPixelType       largestShape = NumericTraits<OutputPixelType>::max();
+  OutputImageType *           shapeImage = this->GetShapeOutput();
+  OutputImageType *           scaleImage = this->GetScaleOutput();
+
+  ImageRegionIteratorWithIndex<OutputImageType> shapeIt(shapeImage, outputRegionForThread);
+  ImageRegionIterator<OutputImageType>          scaleIt(scaleImage, outputRegionForThread);
+  for (shapeIt.GoToBegin(), scaleIt.GoToBegin(); !shapeIt.IsAtEnd(); ++shapeIt, ++scaleIt)
+  {
+    const IndexType &   index = shapeIt.GetIndex();
+    IndexType           first;
+    IndexType           last;
+    AccumulateValueType count = 1.0;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      const IndexValueType tableEnd = tableStart[i] + static_cast<IndexValueType>(tableRegion.GetSize(i)) - 1;
+      first[i] = std::max(index[i] - static_cast<IndexValueType>(radius[i]), tableStart[i]);
+      last[i] = std::min(index[i] + static_cast<IndexValueType>(radius[i]), tableEnd);
+      count *= static_cast<AccumulateValueType>(last[i] - first[i] + 1);
+    }
+
+    AccumulatePixelType sum;
+    sum.Fill(0.0);
+    for (unsigned int corner = 0; corner < (1u << ImageDimension); ++corner)
+    {
+      IndexType           cornerIndex;
+      AccumulateValueType sign = 1.0;
+      bool                inside = true;
+      for (unsigned int i = 0; i < ImageDimension && inside; ++i)
+      {
+        if (corner & (1u << i))
+        {
+          cornerIndex[i] = last[i];
+        }
+        else
+        {
+          cornerIndex[i] = first[i] - 1;
+          sign = -sign;
+          inside = cornerIndex[i] >= tableStart[i];
+        }
+      }
+      if (inside)
+      {
+        sum += tableBuffer[table->ComputeOffset(cornerIndex)] * sign;
+      }
+    }
+
+    const AccumulateValueType scale = sum[0] / count;
+    const AccumulateValueType variance = sum[1] / count - scale * scale;
+    scaleIt.Set(static_cast<OutputPixelType>(scale));
+    shapeIt.Set(variance > 0.0 ? static_cast<OutputPixelType>(std::min(
+                                   scale * scale / variance, static_cast<AccumulateValueType>(largestShape)))
+                               : largestShape);
+  }
+}
+
+} // end namespace itk
+
+#endif // itkNakagamiImageFilter_hxx
@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCL1DFFTBatchedTransform_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCL1DFFTBatchedTransform_h
+
+#  include <complex>
+#  include <type_traits>
+#  include <vector>
+
+#  include "itkIntTypes.h"
+#  include "itkMacro.h"
+#  include "itkclFFTInitializer.h"
+
+namespace itk
+{
+/** \class OpenCL1DFFTBatchedTransform
+ * \brief In place clFFT transforms of the lines of a pinned host buffer.
+ *
+ * The lines are transformed in batches.  Every batch is uploaded, transformed
+ * and downloaded on one of the NumberOfQueues command queues of
+ * clFFTInitializer, each with its own device buffer, so that the transfers of
+ * a batch overlap the transform of the next one.  The host buffer is
+ * allocated with CL_MEM_ALLOC_HOST_PTR and stays mapped, so the transfers are
+ * DMA from pinned memory.
+ *
+ * The buffers are kept until the line length, the number of lines or the
+ * number of batches changes, so consecutive frames of the same size only pay
+ * for the transfers and the transforms.  The plans come from the plan cache
+ * of clFFTInitializer; BakePlans() bakes them ahead of the first frame.
+ *
+ * This is the device backend of the OpenCL 1D FFT image filters.
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ */
+template <typename TPixel>
+class ITK_TEMPLATE_EXPORT OpenCL1DFFTBatchedTransform
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(OpenCL1DFFTBatchedTransform);
+
+  using ComplexType = std::complex<TPixel>;
+
+  /** Number of command queues the batches are spread over. */
+  static constexpr unsigned int NumberOfQueues = clFFTInitializer::NumberOfQueues;
+
+  OpenCL1DFFTBatchedTransform();
+  ~OpenCL1DFFTBatchedTransform();
+
+  /** Get the host buffer for numberOfLines lines of lineLength, transformed in
+   * at most numberOfBatches batches of the same number of lines.  Its contents
+   * are undefined. */
+  ComplexType *
+  GetHostBuffer(SizeValueType lineLength, SizeValueType numberOfLines, unsigned int numberOfBatches);
+
+  /** Transform the lines of the host buffer in place, and wait for the
+   * results. */
+  void
+  Transform(clfftDirection direction);
+
+  /** Transform the lines of the host buffer forward, multiply every line by
+   * the lineLength weights, and transform them back, and wait for the
+   * results.  The lines stay on the device between the transforms, and the
+   * weights are applied by a small kernel. */
+  void
+  TransformWeightedRoundTrip(const TPixel * weights);
+
+  /** Bake the forward and backward plans used to transform numberOfLines
+   * lines of lineLength in at most numberOfBatches batches. */
+  static void
+  BakePlans(SizeValueType lineLength, SizeValueType numberOfLines, unsigned int numberOfBatches);
+
+  /** Get the number of batches of the last host buffer. */
+  unsigned int
+  GetNumberOfBatches() const
+  {
+    return m_NumberOfBatches;
+  }
+
+private:
+  void
+  ReleaseBuffers();
+
+  void
+  EnqueueTransforms(const TPixel * weights, clfftDirection direction);
+
+  /** Split numberOfLines lines in at most numberOfBatches batches of
+   * linesPerBatch lines, but the last one.  Returns the number of batches. */
+  static SizeValueType
+  SplitBatches(SizeValueType numberOfLines, unsigned int numberOfBatches, SizeValueType & linesPerBatch);
+
+  static constexpr clfftPrecision Precision = std::is_same<TPixel, double>::value ? CLFFT_DOUBLE : CLFFT_SINGLE;
+
+  clFFTInitializer *      m_Initializer = nullptr;
+  std::vector<cl::Buffer> m_DeviceBuffers;
+  cl::Buffer              m_PinnedBuffer;
+  ComplexType *           m_HostBuffer = nullptr;
+  cl::Program             m_WeightProgram;
+  cl::Kernel              m_WeightKernel;
+  cl::Buffer              m_WeightBuffer;
+
+  SizeValueType m_LineLength = 0;
+  SizeValueType m_NumberOfLines = 0;
+  SizeValueType m_LinesPerBatch = 0;
+  unsigned int  m_NumberOfBatches = 0;
+  unsigned int  m_RequestedNumberOfBatches = 0;
+};
+
+} // namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkOpenCL1DFFTBatchedTransform.hxx"
+#  endif
+
+#endif // itkOpenCL1DFFTBatchedTransform_h
@@ -0,0 +1,285 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCL1DFFTBatchedTransform_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCL1DFFTBatchedTransform_hxx
+
+#  include "itkOpenCL1DFFTBatchedTransform.h"
+#  include "itkUltrasoundTrace.h"
+
+#  include <algorithm>
+#  include <mutex>
+#  include <string>
+#  include <type_traits>
+
+namespace itk
+{
+
+template <typename TPixel>
+OpenCL1DFFTBatchedTransform<TPixel>::OpenCL1DFFTBatchedTransform()
+{
+  try
+  {
+    m_Initializer = &clFFFInitialization();
+  }
+  catch (const cl::Error & e)
+  {
+    itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+template <typename TPixel>
+OpenCL1DFFTBatchedTransform<TPixel>::~OpenCL1DFFTBatchedTransform()
+{
+  try
+  {
+    this->ReleaseBuffers();
+  }
+  catch (const cl::Error &)
+  {
+    // nothing left to do with a failing device
+  }
+}
+
+template <typename TPixel>
+SizeValueType
+OpenCL1DFFTBatchedTransform<TPixel>::SplitBatches(SizeValueType   numberOfLines,
+                                                  unsigned int    numberOfBatches,
+                                                  SizeValueType & linesPerBatch)
+{
+  const SizeValueType batches = std::max<SizeValueType>(1, std::min<SizeValueType>(numberOfBatches, numberOfLines));
+  linesPerBatch = (numberOfLines + batches - 1) / batches;
+  return (numberOfLines + linesPerBatch - 1) / linesPerBatch;
+}
+
+template <typename TPixel>
+void
+OpenCL1DFFTBatchedTransform<TPixel>::BakePlans(SizeValueType lineLength,
+                                               SizeValueType numberOfLines,
+                                               unsigned int  numberOfBatches)
+{
+  try
+  {
+    clFFTInitializer &  initializer = clFFFInitialization();
+    SizeValueType       linesPerBatch = 0;
+    const SizeValueType batches = SplitBatches(numberOfLines, numberOfBatches, linesPerBatch);
+    const SizeValueType lastBatchLines = numberOfLines - (batches - 1) * linesPerBatch;
+    for (clfftDirection direction : { CLFFT_FORWARD, CLFFT_BACKWARD })
+    {
+      initializer.BakePlan(lineLength, linesPerBatch, Precision, direction);
+      if (lastBatchLines != linesPerBatch)
+      {
+        initializer.GetPlan((batches - 1) % NumberOfQueues, lineLength, lastBatchLines, Precision, direction);
+      }
+    }
+  }
+  catch (const cl::Error & e)
+  {
+    itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+template <typename TPixel>
+void
+OpenCL1DFFTBatchedTransform<TPixel>::ReleaseBuffers()
+{
+  m_DeviceBuffers.clear();
+  if (m_HostBuffer != nullptr)
+  {
+    std::lock_guard<std::mutex> lock(m_Initializer->GetQueueMutex());
+    cl::CommandQueue &          queue = m_Initializer->GetQueue(0);
+    queue.enqueueUnmapMemObject(m_PinnedBuffer, m_HostBuffer);
+    queue.finish();
+    m_HostBuffer = nullptr;
+  }
+  m_PinnedBuffer = cl::Buffer();
+  m_LineLength = 0;
+  m_NumberOfLines = 0;
+  m_LinesPerBatch = 0;
+  m_NumberOfBatches = 0;
+  m_RequestedNumberOfBatches = 0;
+}
+
+template <typename TPixel>
+auto
+OpenCL1DFFTBatchedTransform<TPixel>::GetHostBuffer(SizeValueType lineLength,
+                                                   SizeValueType numberOfLines,
+                                                   unsigned int  numberOfBatches) -> ComplexType *
+{
+  if (m_HostBuffer != nullptr && lineLength == m_LineLength && numberOfLines == m_NumberOfLines &&
+      numberOfBatches == m_RequestedNumberOfBatches)
+  {
+    return m_HostBuffer;
+  }
+
+  try
+  {
+    this->ReleaseBuffers();
+
+    SizeValueType       linesPerBatch = 0;
+    const SizeValueType batches = SplitBatches(numberOfLines, numberOfBatches, linesPerBatch);
+    const size_t        batchBytes = linesPerBatch * lineLength * sizeof(ComplexType);
+    const size_t        totalBytes = numberOfLines * lineLength * sizeof(ComplexType);
+
+    cl::Context & context = m_Initializer->GetContext();
+    m_PinnedBuffer = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, totalBytes);
+    {
+      std::lock_guard<std::mutex> lock(m_Initializer->GetQueueMutex());
+      m_HostBuffer = static_cast<ComplexType *>(m_Initializer->GetQueue(0).enqueueMapBuffer(
+        m_PinnedBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, totalBytes));
+    }
+
+    const unsigned int usedQueues = std::min<SizeValueType>(NumberOfQueues, batches);
+    for (unsigned int queue = 0; queue < usedQueues; ++queue)
+    {
+      m_DeviceBuffers.emplace_back(context, CL_MEM_READ_WRITE, batchBytes);
+    }
+
+    m_LineLength = lineLength;
+    m_NumberOfLines = numberOfLines;
+    m_LinesPerBatch = linesPerBatch;
+    m_NumberOfBatches = batches;
+    m_RequestedNumberOfBatches = numberOfBatches;
+  }
+  catch (const cl::Error & e)
+  {
+    itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+  return m_HostBuffer;
+}
+
+template <typename TPixel>
+void
+OpenCL1DFFTBatchedTransform<TPixel>::Transform(clfftDirection direction)
+{
+  this->EnqueueTransforms(nullptr, direction);
+}
+
+template <typename TPixel>
+void
+OpenCL1DFFTBatchedTransform<TPixel>::TransformWeightedRoundTrip(const TPixel * weights)
+{
+  this->EnqueueTransforms(weights, CLFFT_FORWARD);
+}
+
+template <typename TPixel>
+void
+OpenCL1DFFTBatchedTransform<TPixel>::EnqueueTransforms(const TPixel * weights, clfftDirection direction)
+{
+  itkUltrasoundTraceScopeMacro("OpenCL1DFFT");
+  if (m_HostBuffer == nullptr)
+  {
+    return;
+  }
+
+  try
+  {
+    cl::Context &               context = m_Initializer->GetContext();
+    std::lock_guard<std::mutex> lock(m_Initializer->GetQueueMutex());
+    if (weights != nullptr)
+    {
+      if (!m_WeightKernel())
+      {
+        std::string source;
+        if (std::is_same<TPixel, double>::value)
+        {
+          source = "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+                   "typedef double REAL;\n"
+                   "typedef double2 REAL2;\n";
+        }
+        else
+        {
+          source = "typedef float REAL;\n"
+                   "typedef float2 REAL2;\n";
+        }
+        // One work item per sample of the batch.
+        source += R"(
+__kernel void WeightLines(__global REAL2 * lines, __global const REAL * weights, const uint lineLength)
+{
+  const uint sample = get_global_id(0);
+  lines[sample] *= weights[sample % lineLength];
+}
+)";
+        std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
+        m_WeightProgram =
+          cl::Program(context, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+        try
+        {
+          m_WeightProgram.build(std::vector<cl::Device>(1, devices[0]));
+        }
+        catch (const cl::Error &)
+        {
+          itkGenericExceptionMacro("Could not build the OpenCL line weighting kernel: "
+                                   << m_WeightProgram.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+        }
+        m_WeightKernel = cl::Kernel(m_WeightProgram, "WeightLines");
+      }
+      m_WeightBuffer = cl::Buffer(context, CL_MEM_READ_ONLY, m_LineLength * sizeof(TPixel));
+      m_Initializer->GetQueue(0).enqueueWriteBuffer(
+        m_WeightBuffer, CL_TRUE, 0, m_LineLength * sizeof(TPixel), weights);
+    }
+
+    for (unsigned int batch = 0; batch < m_NumberOfBatches; ++batch)
+    {
+      // consecutive batches go to different in order queues, so the upload of
+      // one overlaps the transform and the download of the previous ones
+      const unsigned int  queueIndex = batch % NumberOfQueues;
+      cl::CommandQueue &  queue = m_Initializer->GetQueue(queueIndex);
+      const SizeValueType firstLine = batch * m_LinesPerBatch;
+      const SizeValueType lines = std::min(m_LinesPerBatch, m_NumberOfLines - firstLine);
+      const size_t        bytes = lines * m_LineLength * sizeof(ComplexType);
+      ComplexType *       hostBatch = m_HostBuffer + firstLine * m_LineLength;
+
+      queue.enqueueWriteBuffer(m_DeviceBuffers[queueIndex], CL_FALSE, 0, bytes, hostBatch);
+
+      clfftPlanHandle  plan = m_Initializer->GetPlan(queueIndex, m_LineLength, lines, Precision, direction);
+      cl_command_queue clQueue = queue();
+      cl_mem           clPointer = m_DeviceBuffers[queueIndex]();
+      clfftStatus      err =
+        clfftEnqueueTransform(plan, direction, 1, &clQueue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
+      if (!err && weights != nullptr)
+      {
+        // kernel arguments are captured at enqueue time
+        m_WeightKernel.setArg(0, m_DeviceBuffers[queueIndex]);
+        m_WeightKernel.setArg(1, m_WeightBuffer);
+        m_WeightKernel.setArg(2, static_cast<cl_uint>(m_LineLength));
+        queue.enqueueNDRangeKernel(m_WeightKernel, cl::NullRange, cl::NDRange(lines * m_LineLength));
+        plan = m_Initializer->GetPlan(queueIndex, m_LineLength, lines, Precision, CLFFT_BACKWARD);
+        err = clfftEnqueueTransform(
+          plan, CLFFT_BACKWARD, 1, &clQueue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
+      }
+      if (err)
+      {
+        itkGenericExceptionMacro("Error in clfftEnqueueTransform(" << err << ")");
+      }
+
+      queue.enqueueReadBuffer(m_DeviceBuffers[queueIndex], CL_FALSE, 0, bytes, hostBatch);
+    }
+    for (unsigned int queueIndex = 0; queueIndex < NumberOfQueues; ++queueIndex)
+    {
+      m_Initializer->GetQueue(queueIndex).finish();
+    }
+  }
+  catch (const cl::Error & e)
+  {
+    itkGenericExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+} // namespace itk
+
+#endif // itkOpenCL1DFFTBatchedTransform_hxx
@@ -0,0 +1,90 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLAnalyticSignalImageFilter_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLAnalyticSignalImageFilter_h
+
+#  include "itkAnalyticSignalImageFilter.h"
+#  include "itkOpenCL1DFFTBatchedTransform.h"
+
+namespace itk
+{
+/** \class OpenCLAnalyticSignalImageFilter
+ * \brief Generates the analytic signal on an OpenCL device.
+ *
+ * The forward transform, the one-sided spectrum weights and the inverse
+ * transform of every batch of lines run on the device back to back, so the
+ * lines cross the bus once in each direction instead of once per transform.
+ * The weights, including the transfer function of the frequency filter, if
+ * any, are applied by a small kernel.
+ *
+ * The size of the image in the transformed direction must be a multiple of
+ * powers of 2, 3, 5, and 7.  InPlace has no effect.
+ *
+ * \sa AnalyticSignalImageFilter
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT OpenCLAnalyticSignalImageFilter : public AnalyticSignalImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(OpenCLAnalyticSignalImageFilter);
+
+  using Self = OpenCLAnalyticSignalImageFilter;
+  using Superclass = AnalyticSignalImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using TPixel = typename Superclass::SpectrumValueType;
+
+  itkTypeMacro(OpenCLAnalyticSignalImageFilter, AnalyticSignalImageFilter);
+  itkNewMacro(Self);
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 7; // clFFT supports prime factors 2, 3, 5 and 7
+  }
+
+  /** Number of batches the lines are split into, so that the transfer of one
+   * batch overlaps the transforms of another. */
+  itkSetClampMacro(NumberOfBatches, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfBatches, unsigned int);
+
+protected:
+  OpenCLAnalyticSignalImageFilter() = default;
+  ~OpenCLAnalyticSignalImageFilter() override = default;
+
+  void
+  GenerateData() override;
+
+private:
+  unsigned int                        m_NumberOfBatches{ 2 * OpenCL1DFFTBatchedTransform<TPixel>::NumberOfQueues };
+  OpenCL1DFFTBatchedTransform<TPixel> m_Transform;
+};
+
+} // namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkOpenCLAnalyticSignalImageFilter.hxx"
+#  endif
+
+#endif // itkOpenCLAnalyticSignalImageFilter_h
@@ -0,0 +1,79 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLAnalyticSignalImageFilter_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLAnalyticSignalImageFilter_hxx
+
+#  include "itkOpenCLAnalyticSignalImageFilter.h"
+#  include "itkOpenCL1DFFTBatchedTransform.hxx"
+
+#  include "itkImageLinearConstIteratorWithIndex.h"
+#  include "itkImageLinearIteratorWithIndex.h"
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLAnalyticSignalImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  const unsigned int                           direction = this->GetDirection();
+  const typename OutputImageType::RegionType & region = output->GetRequestedRegion();
+  const SizeValueType                          lineLength = region.GetSize()[direction];
+  if (Math::GreatestPrimeFactor(lineLength) > this->GetSizeGreatestPrimeFactor())
+  {
+    itkExceptionMacro("Illegal dimension for FFT: " << lineLength);
+  }
+  const SizeValueType numberOfLines = region.GetNumberOfPixels() / lineLength;
+
+  this->UpdateSpectrumWeights(lineLength);
+  typename OpenCL1DFFTBatchedTransform<TPixel>::ComplexType * hostBuffer =
+    m_Transform.GetHostBuffer(lineLength, numberOfLines, m_NumberOfBatches);
+
+  ImageLinearConstIteratorWithIndex<InputImageType> inputIt(input, region);
+  inputIt.SetDirection(direction);
+  auto * bufferIt = hostBuffer;
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); inputIt.NextLine())
+  {
+    for (inputIt.GoToBeginOfLine(); !inputIt.IsAtEndOfLine(); ++inputIt, ++bufferIt)
+    {
+      *bufferIt = std::complex<TPixel>(static_cast<TPixel>(inputIt.Get()), 0);
+    }
+  }
+
+  m_Transform.TransformWeightedRoundTrip(this->GetSpectrumWeights().data());
+
+  ImageLinearIteratorWithIndex<OutputImageType> outputIt(output, region);
+  outputIt.SetDirection(direction);
+  bufferIt = hostBuffer;
+  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); outputIt.NextLine())
+  {
+    for (outputIt.GoToBeginOfLine(); !outputIt.IsAtEndOfLine(); ++outputIt, ++bufferIt)
+    {
+      outputIt.Set(static_cast<typename OutputImageType::PixelType>(*bufferIt));
+    }
+  }
+}
+
+} // namespace itk
+
+#endif // itkOpenCLAnalyticSignalImageFilter_hxx
@@ -20,9 +20,7 @@
 
 #  include "itkComplexToComplex1DFFTImageFilter.h"
 
-#  define __CL_ENABLE_EXCEPTIONS
-#  include "CL/cl.hpp"
-#  include "clFFT.h"
+#  include "itkOpenCL1DFFTBatchedTransform.h"
 
 namespace itk
 {
@@ -35,7 +33,10 @@ namespace itk
  * There is considerable overhead to generate the FFT plan, which occurs
  * whenever the input image size changes.  Therefore, the throughput benefit
  * will only be realized for large images or many small images of
- * the same size.
+ * the same size.  The pinned staging buffer, the device buffers and the
+ * plans are kept across updates of the same size, and the lines are
+ * transferred and transformed in NumberOfBatches batches so that the
+ * transfers overlap the transforms.
  *
  * \ingroup FourierTransform
  * \ingroup Ultrasound
@@ -72,19 +73,15 @@ public:
     return 7; // clFFT supports prime factors 2, 3, 5 and 7
   }
 
+  /** Number of batches the lines are split into, so that the transfer of one
+   * batch to or from the device overlaps the transform of another.  Defaults
+   * to twice the number of command queues. */
+  itkSetClampMacro(NumberOfBatches, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfBatches, unsigned int);
+
 protected:
-  OpenCLComplexToComplex1DFFTImageFilter();
-  virtual ~OpenCLComplexToComplex1DFFTImageFilter()
-  {
-    if (m_PlanComputed)
-    {
-      clfftDestroyPlan(&this->m_Plan);
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-    }
-    delete m_clQueue;
-    delete m_clContext;
-  }
+  OpenCLComplexToComplex1DFFTImageFilter() = default;
+  ~OpenCLComplexToComplex1DFFTImageFilter() override = default;
 
   virtual void
   GenerateData(); // generates output from input
@@ -94,13 +91,8 @@ protected:
   Legaldim(int n);
 
 private:
-  bool                m_PlanComputed = false;
-  clfftPlanHandle     m_Plan = 0;
-  unsigned int        m_LastImageSize = 0;
-  OpenCLComplexType * m_InputBuffer = nullptr;
-  OpenCLComplexType * m_OutputBuffer = nullptr;
-  cl::Context *       m_clContext = nullptr;
-  cl::CommandQueue *  m_clQueue = nullptr;
+  unsigned int                        m_NumberOfBatches{ 2 * OpenCL1DFFTBatchedTransform<TPixel>::NumberOfQueues };
+  OpenCL1DFFTBatchedTransform<TPixel> m_Transform;
 };
 
 } // namespace itk
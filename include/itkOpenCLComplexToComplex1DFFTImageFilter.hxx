@@ -20,7 +20,6 @@
 
 #  include "itkComplexToComplex1DFFTImageFilter.hxx"
 #  include "itkOpenCLComplexToComplex1DFFTImageFilter.h"
-#  include "itkclFFTInitializer.h"
 
 #  include <vector>
 
@@ -32,28 +31,6 @@
 namespace itk
 {
 
-template <typename TInputImage, typename TOutputImage>
-OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::OpenCLComplexToComplex1DFFTImageFilter()
-{
-  try
-  {
-    auto initObject = clFFFInitialization();
-    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
-    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
-    if (devices.size() < 1)
-    {
-      itkExceptionMacro("No OpenCL devices found.");
-    }
-    // @todo: code to select the fastest device, or the device that is
-    // CL_DEVICE_TYPE_ACCELERATOR
-    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
-  }
-  catch (const cl::Error & e)
-  {
-    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
-  }
-}
-
 template <typename TInputImage, typename TOutputImage>
 bool
 OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::Legaldim(int n)
@@ -78,8 +55,7 @@ OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData(
   outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
   outputPtr->Allocate();
 
-  const typename InputImageType::SizeType &  inputSize = inputPtr->GetRequestedRegion().GetSize();
-  const typename OutputImageType::SizeType & outputSize = outputPtr->GetRequestedRegion().GetSize();
+  const typename InputImageType::SizeType & inputSize = inputPtr->GetRequestedRegion().GetSize();
 
   unsigned int vec_size = inputSize[this->m_Direction];
   if (!this->Legaldim(vec_size))
@@ -90,55 +66,8 @@ OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData(
     throw exception;
   }
 
-  cl_int batchSize = 1;
-  for (unsigned int i = 0; i < TInputImage::ImageDimension; i++)
-  {
-    batchSize *= outputSize[i];
-  }
-  unsigned int totalSize = batchSize;
-  batchSize /= outputSize[this->m_Direction];
-  cl_command_queue queue = (*m_clQueue)();
-
-  if (this->m_PlanComputed) // if we've already computed a plan
-  {
-    // if the image sizes aren't the same,
-    // we have to compute the plan again
-    if (this->m_LastImageSize != totalSize)
-    {
-      delete[] this->m_InputBuffer;
-      delete[] this->m_OutputBuffer;
-      clfftDestroyPlan(&this->m_Plan);
-      this->m_PlanComputed = false;
-    }
-  }
-  if (!this->m_PlanComputed)
-  {
-    try
-    {
-      this->m_InputBuffer = new OpenCLComplexType[totalSize];
-      this->m_OutputBuffer = new OpenCLComplexType[totalSize];
-    }
-    catch (std::bad_alloc &)
-    {
-      itkExceptionMacro("Problem allocating memory for internal computations");
-    }
-    this->m_LastImageSize = totalSize;
-    const size_t n[3] = { inputSize[this->GetDirection()], 1, 1 };
-    clfftStatus  error_code = clfftCreateDefaultPlan(&this->m_Plan, (*m_clContext)(), CLFFT_1D, n);
-    if (!this->m_Plan || error_code)
-    {
-      itkExceptionMacro("Could not create OpenCL FFT Plan.");
-    }
-
-    error_code = clfftSetResultLocation(this->m_Plan, CLFFT_INPLACE);
-    error_code = clfftSetPlanBatchSize(this->m_Plan, batchSize);
-    if (std::is_same<TPixel, double>::value) // float by default
-    {
-      error_code = clfftSetPlanPrecision(this->m_Plan, CLFFT_DOUBLE);
-    }
-    clfftBakePlan(this->m_Plan, 1, &queue, nullptr, nullptr);
-    this->m_PlanComputed = true;
-  }
+  const SizeValueType numberOfLines = inputPtr->GetRequestedRegion().GetNumberOfPixels() / vec_size;
+  OpenCLComplexType * hostBuffer = this->m_Transform.GetHostBuffer(vec_size, numberOfLines, this->m_NumberOfBatches);
 
   using InputIteratorType = itk::ImageLinearConstIteratorWithIndex<InputImageType>;
   using OutputIteratorType = itk::ImageLinearIteratorWithIndex<OutputImageType>;
@@ -148,7 +77,7 @@ OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData(
   inputIt.SetDirection(this->m_Direction);
   outputIt.SetDirection(this->m_Direction);
 
-  OpenCLComplexType * inputBufferIt = this->m_InputBuffer;
+  OpenCLComplexType * inputBufferIt = hostBuffer;
   // for every fft line
   for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); inputIt.NextLine())
   {
@@ -163,32 +92,9 @@ OpenCLComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData(
     }
   }
 
-  try
-  {
-    // do the transform
-    cl::Buffer clDataBuffer(
-      *m_clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, totalSize * sizeof(TPixel) * 2, m_InputBuffer);
-    cl_mem      clPointer = clDataBuffer();
-    clfftStatus err;
-    if (this->m_TransformDirection == Superclass::DIRECT)
-      err = clfftEnqueueTransform(
-        this->m_Plan, CLFFT_FORWARD, 1, &queue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
-    else
-      err = clfftEnqueueTransform(
-        this->m_Plan, CLFFT_BACKWARD, 1, &queue, 0, nullptr, nullptr, &clPointer, nullptr, nullptr);
-    if (err)
-    {
-      itkExceptionMacro("Error in clfftEnqueueTransform(" << err << ")");
-    }
-    cl_int err2 =
-      m_clQueue->enqueueReadBuffer(clDataBuffer, CL_TRUE, 0, totalSize * sizeof(TPixel) * 2, m_OutputBuffer);
-  }
-  catch (const cl::Error & e)
-  {
-    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
-  }
+  this->m_Transform.Transform(this->m_TransformDirection == Superclass::DIRECT ? CLFFT_FORWARD : CLFFT_BACKWARD);
 
-  OpenCLComplexType * outputBufferIt = this->m_OutputBuffer;
+  OpenCLComplexType * outputBufferIt = hostBuffer;
   // for every fft line
   for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); outputIt.NextLine())
   {
@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLCurvilinearArrayScanConvertImageFilter_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLCurvilinearArrayScanConvertImageFilter_h
+
+#  include <string>
+#  include <type_traits>
+
+#  include "itkCurvilinearArrayScanConvertImageFilter.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+
+namespace itk
+{
+/** \class OpenCLCurvilinearArrayScanConvertImageFilter
+ * \brief Scan convert a CurvilinearArraySpecialCoordinatesImage on an
+ * OpenCL device.
+ *
+ * The lookup table of CurvilinearArrayScanConvertImageFilter is built on the
+ * host, as for the CPU filter, and uploaded to the device only when it is
+ * rebuilt, so that it stays resident across the frames of an acquisition.
+ * Each update then uploads the frame, gathers and blends the neighbors of
+ * every output pixel with one work item per pixel, and reads the result
+ * back.
+ *
+ * A frame that is already on the device, e.g. the output of an upstream
+ * OpenCL stage that shares the context returned by GetContext(), is scan
+ * converted without a round trip through the host with
+ * ScanConvertDeviceBuffer(), once the filter has been updated with an input
+ * of the same geometry.
+ *
+ * The pixels of the input and of the output are float or double, of the
+ * same type.  The gather reads buffers rather than images with a linear
+ * sampler, since the sampler weights have 8 bits of precision only.
+ *
+ * \ingroup Ultrasound
+ *
+ * \sa CurvilinearArrayScanConvertImageFilter
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT OpenCLCurvilinearArrayScanConvertImageFilter
+  : public CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(OpenCLCurvilinearArrayScanConvertImageFilter);
+
+  using Self = OpenCLCurvilinearArrayScanConvertImageFilter;
+  using Superclass = CurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(OpenCLCurvilinearArrayScanConvertImageFilter, CurvilinearArrayScanConvertImageFilter);
+
+  using InputPixelType = typename Superclass::InputPixelType;
+  using OutputPixelType = typename Superclass::OutputPixelType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using OutputImageRegionType = typename Superclass::OutputImageRegionType;
+  using WeightType = typename Superclass::WeightType;
+
+  static_assert(std::is_same<InputPixelType, OutputPixelType>::value &&
+                  (std::is_same<OutputPixelType, float>::value || std::is_same<OutputPixelType, double>::value),
+                "OpenCLCurvilinearArrayScanConvertImageFilter converts float or double images");
+
+  /** The OpenCL context and queue of the filter, for the stages that share
+   * device buffers with it. */
+  cl::Context *
+  GetContext() const
+  {
+    return m_clContext;
+  }
+  cl::CommandQueue *
+  GetCommandQueue() const
+  {
+    return m_clQueue;
+  }
+
+  /** Scan convert a frame on the device, laid out as the buffer of the input,
+   * into a device buffer laid out as the buffer of the output, with the
+   * lookup table of the last update.  The kernel is enqueued on
+   * GetCommandQueue() and not waited for. */
+  void
+  ScanConvertDeviceBuffer(const cl::Buffer & input, cl::Buffer & output);
+
+protected:
+  OpenCLCurvilinearArrayScanConvertImageFilter();
+  ~OpenCLCurvilinearArrayScanConvertImageFilter() override
+  {
+    delete m_clKernel;
+    delete m_clProgram;
+    delete m_clQueue;
+    delete m_clContext;
+  }
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateData() override;
+
+private:
+  /** OpenCL C source of the kernel, for the precision of the pixels. */
+  static std::string
+  GetKernelSource();
+
+  /** Upload the lookup table if it was rebuilt since the last upload. */
+  void
+  UpdateDeviceLookupTable();
+
+  cl::Context *      m_clContext = nullptr;
+  cl::CommandQueue * m_clQueue = nullptr;
+  cl::Program *      m_clProgram = nullptr;
+  cl::Kernel *       m_clKernel = nullptr;
+
+  /** The lookup table on the device, and the build of the table it holds. */
+  cl::Buffer    m_clSourceOffsets;
+  cl::Buffer    m_clWeights;
+  cl::Buffer    m_clNeighborOffsets;
+  SizeValueType m_DeviceLookupTableBuild{ 0 };
+  SizeValueType m_DeviceNumberOfPixels{ 0 };
+
+  /** Frame buffers of the host path, kept across updates of the same size. */
+  cl::Buffer    m_clInput;
+  cl::Buffer    m_clOutput;
+  SizeValueType m_InputBufferSize{ 0 };
+};
+
+} // namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkOpenCLCurvilinearArrayScanConvertImageFilter.hxx"
+#  endif
+
+#endif // itkOpenCLCurvilinearArrayScanConvertImageFilter_h
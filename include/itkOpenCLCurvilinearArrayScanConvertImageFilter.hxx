@@ -0,0 +1,216 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLCurvilinearArrayScanConvertImageFilter_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLCurvilinearArrayScanConvertImageFilter_hxx
+
+#  include "itkOpenCLCurvilinearArrayScanConvertImageFilter.h"
+
+#  include <sstream>
+#  include <vector>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+OpenCLCurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::OpenCLCurvilinearArrayScanConvertImageFilter()
+{
+  try
+  {
+    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
+    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
+    if (devices.size() < 1)
+    {
+      itkExceptionMacro("No OpenCL devices found.");
+    }
+    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
+
+    const std::string source = GetKernelSource();
+    this->m_clProgram =
+      new cl::Program(*m_clContext, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+    try
+    {
+      this->m_clProgram->build(std::vector<cl::Device>(1, devices[0]));
+    }
+    catch (const cl::Error &)
+    {
+      itkExceptionMacro("Could not build the OpenCL scan conversion kernel: "
+                        << this->m_clProgram->getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+    }
+    this->m_clKernel = new cl::Kernel(*m_clProgram, "ScanConvert");
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+std::string
+OpenCLCurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::GetKernelSource()
+{
+  static_assert(std::is_same<WeightType, float>::value, "The kernel reads float weights");
+
+  std::ostringstream source;
+  if (std::is_same<OutputPixelType, double>::value)
+  {
+    source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+              "typedef double REAL;\n";
+  }
+  else
+  {
+    source << "typedef float REAL;\n";
+  }
+  source << "#define NUMBER_OF_NEIGHBORS " << Superclass::NumberOfNeighbors << "\n";
+  // One work item per output pixel, as in
+  // CurvilinearArrayScanConvertImageFilter::DynamicThreadedGenerateData.
+  source << R"(
+__kernel void ScanConvert(__global const REAL * input,
+                          __global const long * sourceOffsets,
+                          __global const float * weights,
+                          __global const long * neighborOffsets,
+                          const REAL defaultPixelValue,
+                          __global REAL * output)
+{
+  const size_t pixel = get_global_id(0);
+  const long sourceOffset = sourceOffsets[pixel];
+  if (sourceOffset < 0)
+  {
+    output[pixel] = defaultPixelValue;
+    return;
+  }
+  __global const REAL * source = input + sourceOffset;
+  __global const float * pixelWeights = weights + pixel * NUMBER_OF_NEIGHBORS;
+  REAL value = 0;
+  for (uint nn = 0; nn < NUMBER_OF_NEIGHBORS; ++nn)
+  {
+    value += pixelWeights[nn] * source[neighborOffsets[nn]];
+  }
+  output[pixel] = value;
+}
+)";
+  return source.str();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLCurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::UpdateDeviceLookupTable()
+{
+  if (m_DeviceLookupTableBuild == this->GetNumberOfLookupTableBuilds())
+  {
+    return;
+  }
+
+  // OffsetValueType is not 64 bits on all platforms.
+  const std::vector<OffsetValueType> & sourceOffsets = this->GetLookupTableSourceOffsets();
+  const std::vector<WeightType> &      weights = this->GetLookupTableWeights();
+  const OffsetValueType *              neighborOffsets = this->GetLookupTableNeighborOffsets();
+
+  std::vector<cl_long>  deviceSourceOffsets(sourceOffsets.begin(), sourceOffsets.end());
+  std::vector<cl_float> deviceWeights(weights.begin(), weights.end());
+  std::vector<cl_long>  deviceNeighborOffsets(neighborOffsets, neighborOffsets + Superclass::NumberOfNeighbors);
+
+  const cl_mem_flags copyHost = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+  m_clSourceOffsets =
+    cl::Buffer(*m_clContext, copyHost, deviceSourceOffsets.size() * sizeof(cl_long), deviceSourceOffsets.data());
+  m_clWeights = cl::Buffer(*m_clContext, copyHost, deviceWeights.size() * sizeof(cl_float), deviceWeights.data());
+  m_clNeighborOffsets =
+    cl::Buffer(*m_clContext, copyHost, deviceNeighborOffsets.size() * sizeof(cl_long), deviceNeighborOffsets.data());
+
+  m_DeviceNumberOfPixels = sourceOffsets.size();
+  m_clOutput = cl::Buffer(*m_clContext, CL_MEM_WRITE_ONLY, m_DeviceNumberOfPixels * sizeof(OutputPixelType));
+  m_DeviceLookupTableBuild = this->GetNumberOfLookupTableBuilds();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLCurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::ScanConvertDeviceBuffer(
+  const cl::Buffer & input,
+  cl::Buffer &       output)
+{
+  if (m_DeviceLookupTableBuild == 0)
+  {
+    itkExceptionMacro("The filter must be updated once before it scan converts device buffers.");
+  }
+
+  try
+  {
+    cl::Kernel & kernel = *this->m_clKernel;
+    kernel.setArg(0, input);
+    kernel.setArg(1, m_clSourceOffsets);
+    kernel.setArg(2, m_clWeights);
+    kernel.setArg(3, m_clNeighborOffsets);
+    kernel.setArg(4, static_cast<OutputPixelType>(this->GetDefaultPixelValue()));
+    kernel.setArg(5, output);
+    m_clQueue->enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(m_DeviceNumberOfPixels), cl::NullRange);
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLCurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  // Rebuilds the lookup table on the host if the geometry changed.
+  this->BeforeThreadedGenerateData();
+
+  const TInputImage * input = this->GetInput();
+  OutputImageType *   output = this->GetOutput();
+  const SizeValueType inputBufferSize = input->GetBufferedRegion().GetNumberOfPixels() * sizeof(InputPixelType);
+  const SizeValueType outputBufferSize = output->GetBufferedRegion().GetNumberOfPixels() * sizeof(OutputPixelType);
+  try
+  {
+    this->UpdateDeviceLookupTable();
+    if (m_InputBufferSize != inputBufferSize)
+    {
+      m_clInput = cl::Buffer(*m_clContext, CL_MEM_READ_ONLY, inputBufferSize);
+      m_InputBufferSize = inputBufferSize;
+    }
+    m_clQueue->enqueueWriteBuffer(m_clInput, CL_FALSE, 0, inputBufferSize, input->GetBufferPointer());
+    this->ScanConvertDeviceBuffer(m_clInput, m_clOutput);
+    m_clQueue->enqueueReadBuffer(m_clOutput, CL_TRUE, 0, outputBufferSize, output->GetBufferPointer());
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+
+  this->AfterThreadedGenerateData();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLCurvilinearArrayScanConvertImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                   Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "DeviceLookupTableBuild: " << m_DeviceLookupTableBuild << std::endl;
+}
+
+} // namespace itk
+
+#endif // itkOpenCLCurvilinearArrayScanConvertImageFilter_hxx
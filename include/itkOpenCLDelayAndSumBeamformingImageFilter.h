@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLDelayAndSumBeamformingImageFilter_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLDelayAndSumBeamformingImageFilter_h
+
+#  include <string>
+#  include <type_traits>
+
+#  include "itkDelayAndSumBeamformingImageFilter.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+
+namespace itk
+{
+/** \class OpenCLDelayAndSumBeamformingImageFilter
+ * \brief Beamform the RF lines of a curvilinear array from its channel data
+ * with delay-and-sum on an OpenCL device.
+ *
+ * The delay and apodization table of DelayAndSumBeamformingImageFilter is
+ * built on the host, as for the CPU filter, and uploaded to the device only
+ * when it is rebuilt, so that it stays resident across the frames of an
+ * acquisition.  Each update then uploads the channel data, sums the delayed
+ * channel samples of every output sample with one work item per sample, and
+ * reads the RF lines back.
+ *
+ * Channel data that is already on the device is beamformed without a round
+ * trip through the host with BeamformDeviceBuffer(), once the filter has been
+ * updated with an input of the same geometry.  The RF lines it produces can
+ * stay on the device for the following OpenCL stages that share the context
+ * returned by GetContext().
+ *
+ * The channel samples and the RF lines are float or double, of the same
+ * type.  The whole output is always generated.
+ *
+ * \ingroup Ultrasound
+ *
+ * \sa DelayAndSumBeamformingImageFilter
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT OpenCLDelayAndSumBeamformingImageFilter
+  : public DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(OpenCLDelayAndSumBeamformingImageFilter);
+
+  using Self = OpenCLDelayAndSumBeamformingImageFilter;
+  using Superclass = DelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(OpenCLDelayAndSumBeamformingImageFilter, DelayAndSumBeamformingImageFilter);
+
+  using InputPixelType = typename Superclass::InputPixelType;
+  using OutputPixelType = typename Superclass::OutputPixelType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using OutputImageRegionType = typename Superclass::OutputImageRegionType;
+  using TableValueType = typename Superclass::TableValueType;
+
+  static_assert(std::is_same<InputPixelType, OutputPixelType>::value &&
+                  (std::is_same<OutputPixelType, float>::value || std::is_same<OutputPixelType, double>::value),
+                "OpenCLDelayAndSumBeamformingImageFilter beamforms float or double channel data");
+
+  /** The OpenCL context and queue of the filter, for the stages that share
+   * device buffers with it. */
+  cl::Context *
+  GetContext() const
+  {
+    return m_clContext;
+  }
+  cl::CommandQueue *
+  GetCommandQueue() const
+  {
+    return m_clQueue;
+  }
+
+  /** Beamform channel data on the device, laid out as the buffer of the
+   * input, into a device buffer laid out as the buffer of the output, with
+   * the table of the last update.  The kernel is enqueued on
+   * GetCommandQueue() and not waited for. */
+  void
+  BeamformDeviceBuffer(const cl::Buffer & input, cl::Buffer & output);
+
+protected:
+  OpenCLDelayAndSumBeamformingImageFilter();
+  ~OpenCLDelayAndSumBeamformingImageFilter() override
+  {
+    delete m_clKernel;
+    delete m_clProgram;
+    delete m_clQueue;
+    delete m_clContext;
+  }
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+private:
+  /** OpenCL C source of the kernel, for the precision of the pixels. */
+  static std::string
+  GetKernelSource();
+
+  /** Upload the table if it was rebuilt since the last upload. */
+  void
+  UpdateDeviceTable();
+
+  cl::Context *      m_clContext = nullptr;
+  cl::CommandQueue * m_clQueue = nullptr;
+  cl::Program *      m_clProgram = nullptr;
+  cl::Kernel *       m_clKernel = nullptr;
+
+  /** The table on the device, the build of the table it holds, and the
+   * geometry it was built for. */
+  cl::Buffer    m_clFirstSamples;
+  cl::Buffer    m_clTableOffsets;
+  cl::Buffer    m_clDelays;
+  cl::Buffer    m_clWeights;
+  SizeValueType m_DeviceTableBuild{ 0 };
+  SizeValueType m_DeviceNumberOfElements{ 0 };
+  SizeValueType m_DeviceNumberOfChannelSamples{ 0 };
+  SizeValueType m_DeviceNumberOfSamples{ 0 };
+  SizeValueType m_DeviceNumberOfLines{ 0 };
+
+  /** Buffers of the host path, kept across updates of the same size. */
+  cl::Buffer    m_clInput;
+  cl::Buffer    m_clOutput;
+  SizeValueType m_InputBufferSize{ 0 };
+};
+
+} // namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkOpenCLDelayAndSumBeamformingImageFilter.hxx"
+#  endif
+
+#endif // itkOpenCLDelayAndSumBeamformingImageFilter_h
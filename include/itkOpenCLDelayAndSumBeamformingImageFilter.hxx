@@ -0,0 +1,244 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLDelayAndSumBeamformingImageFilter_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLDelayAndSumBeamformingImageFilter_hxx
+
+#  include "itkOpenCLDelayAndSumBeamformingImageFilter.h"
+
+#  include <sstream>
+#  include <vector>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::OpenCLDelayAndSumBeamformingImageFilter()
+{
+  try
+  {
+    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
+    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
+    if (devices.size() < 1)
+    {
+      itkExceptionMacro("No OpenCL devices found.");
+    }
+    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
+
+    const std::string source = GetKernelSource();
+    this->m_clProgram =
+      new cl::Program(*m_clContext, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+    try
+    {
+      this->m_clProgram->build(std::vector<cl::Device>(1, devices[0]));
+    }
+    catch (const cl::Error &)
+    {
+      itkExceptionMacro("Could not build the OpenCL delay-and-sum kernel: "
+                        << this->m_clProgram->getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+    }
+    this->m_clKernel = new cl::Kernel(*m_clProgram, "DelayAndSum");
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+std::string
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GetKernelSource()
+{
+  static_assert(std::is_same<TableValueType, float>::value, "The kernel reads float delays and weights");
+
+  std::ostringstream source;
+  if (std::is_same<OutputPixelType, double>::value)
+  {
+    source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+              "typedef double REAL;\n";
+  }
+  else
+  {
+    source << "typedef float REAL;\n";
+  }
+  // One work item per output sample, as in
+  // DelayAndSumBeamformingImageFilter::DynamicThreadedGenerateData.
+  source << R"(
+__kernel void DelayAndSum(__global const REAL * channels,
+                          __global const ulong * firstSamples,
+                          __global const ulong * tableOffsets,
+                          __global const float * delays,
+                          __global const float * weights,
+                          const ulong numberOfElements,
+                          const ulong numberOfChannelSamples,
+                          __global REAL * output)
+{
+  const ulong sample = get_global_id(0);
+  const ulong line = get_global_id(1);
+  REAL sum = 0;
+  for (ulong element = 0; element < numberOfElements; ++element)
+  {
+    const ulong entry = line * numberOfElements + element;
+    const ulong firstSample = firstSamples[entry];
+    if (sample < firstSample)
+    {
+      continue;
+    }
+    const ulong tableIndex = tableOffsets[entry] + sample - firstSample;
+    const float delay = delays[tableIndex];
+    const ulong base = (ulong)delay;
+    const REAL fraction = delay - (float)base;
+    __global const REAL * channel = channels + entry * numberOfChannelSamples + base;
+    sum += weights[tableIndex] * (channel[0] + fraction * (channel[1] - channel[0]));
+  }
+  output[line * get_global_size(0) + sample] = sum;
+}
+)";
+  return source.str();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::UpdateDeviceTable()
+{
+  if (m_DeviceTableBuild == this->GetNumberOfTableBuilds())
+  {
+    return;
+  }
+
+  // SizeValueType is not 64 bits on all platforms.
+  const std::vector<SizeValueType> & firstSamples = this->GetTableFirstSamples();
+  const std::vector<SizeValueType> & tableOffsets = this->GetTableOffsets();
+  std::vector<cl_ulong>              deviceFirstSamples(firstSamples.begin(), firstSamples.end());
+  std::vector<cl_ulong>              deviceTableOffsets(tableOffsets.begin(), tableOffsets.end());
+  // Buffers cannot be empty, e.g. when no sample is in any aperture.
+  std::vector<TableValueType> delays = this->GetTableDelays();
+  std::vector<TableValueType> weights = this->GetTableWeights();
+  if (delays.empty())
+  {
+    delays.push_back(0.0f);
+    weights.push_back(0.0f);
+  }
+
+  const cl_mem_flags copyHost = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+  m_clFirstSamples =
+    cl::Buffer(*m_clContext, copyHost, deviceFirstSamples.size() * sizeof(cl_ulong), deviceFirstSamples.data());
+  m_clTableOffsets =
+    cl::Buffer(*m_clContext, copyHost, deviceTableOffsets.size() * sizeof(cl_ulong), deviceTableOffsets.data());
+  m_clDelays = cl::Buffer(*m_clContext, copyHost, delays.size() * sizeof(cl_float), delays.data());
+  m_clWeights = cl::Buffer(*m_clContext, copyHost, weights.size() * sizeof(cl_float), weights.data());
+
+  const typename TInputImage::SizeType & inputSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+  const OutputImageRegionType &          outputRegion = this->GetOutput()->GetLargestPossibleRegion();
+  m_DeviceNumberOfChannelSamples = inputSize[0];
+  m_DeviceNumberOfElements = inputSize[1];
+  m_DeviceNumberOfSamples = outputRegion.GetSize(0);
+  m_DeviceNumberOfLines = outputRegion.GetSize(1);
+  m_clOutput = cl::Buffer(
+    *m_clContext, CL_MEM_WRITE_ONLY, m_DeviceNumberOfSamples * m_DeviceNumberOfLines * sizeof(OutputPixelType));
+  m_DeviceTableBuild = this->GetNumberOfTableBuilds();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::BeamformDeviceBuffer(const cl::Buffer & input,
+                                                                                          cl::Buffer &       output)
+{
+  if (m_DeviceTableBuild == 0)
+  {
+    itkExceptionMacro("The filter must be updated once before it beamforms device buffers.");
+  }
+
+  try
+  {
+    cl::Kernel & kernel = *this->m_clKernel;
+    kernel.setArg(0, input);
+    kernel.setArg(1, m_clFirstSamples);
+    kernel.setArg(2, m_clTableOffsets);
+    kernel.setArg(3, m_clDelays);
+    kernel.setArg(4, m_clWeights);
+    kernel.setArg(5, static_cast<cl_ulong>(m_DeviceNumberOfElements));
+    kernel.setArg(6, static_cast<cl_ulong>(m_DeviceNumberOfChannelSamples));
+    kernel.setArg(7, output);
+    m_clQueue->enqueueNDRangeKernel(
+      kernel, cl::NullRange, cl::NDRange(m_DeviceNumberOfSamples, m_DeviceNumberOfLines), cl::NullRange);
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  // Rebuilds the table on the host if the geometry changed.
+  this->BeforeThreadedGenerateData();
+
+  const TInputImage * input = this->GetInput();
+  OutputImageType *   output = this->GetOutput();
+  const SizeValueType inputBufferSize = input->GetBufferedRegion().GetNumberOfPixels() * sizeof(InputPixelType);
+  const SizeValueType outputBufferSize = output->GetBufferedRegion().GetNumberOfPixels() * sizeof(OutputPixelType);
+  try
+  {
+    this->UpdateDeviceTable();
+    if (m_InputBufferSize != inputBufferSize)
+    {
+      m_clInput = cl::Buffer(*m_clContext, CL_MEM_READ_ONLY, inputBufferSize);
+      m_InputBufferSize = inputBufferSize;
+    }
+    m_clQueue->enqueueWriteBuffer(m_clInput, CL_FALSE, 0, inputBufferSize, input->GetBufferPointer());
+    this->BeamformDeviceBuffer(m_clInput, m_clOutput);
+    m_clQueue->enqueueReadBuffer(m_clOutput, CL_TRUE, 0, outputBufferSize, output->GetBufferPointer());
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+
+  this->AfterThreadedGenerateData();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLDelayAndSumBeamformingImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                              Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "DeviceTableBuild: " << m_DeviceTableBuild << std::endl;
+}
+
+} // namespace itk
+
+#endif // itkOpenCLDelayAndSumBeamformingImageFilter_hxx
@@ -0,0 +1,272 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLPlaneWaveCompoundingImageFilter_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLPlaneWaveCompoundingImageFilter_hxx
+
+#  include "itkOpenCLPlaneWaveCompoundingImageFilter.h"
+
+#  include <sstream>
+#  include <vector>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::OpenCLPlaneWaveCompoundingImageFilter()
+{
+  try
+  {
+    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
+    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
+    if (devices.size() < 1)
+    {
+      itkExceptionMacro("No OpenCL devices found.");
+    }
+    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
+
+    const std::string source = GetKernelSource();
+    this->m_clProgram =
+      new cl::Program(*m_clContext, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+    try
+    {
+      this->m_clProgram->build(std::vector<cl::Device>(1, devices[0]));
+    }
+    catch (const cl::Error &)
+    {
+      itkExceptionMacro("Could not build the OpenCL plane wave compounding kernel: "
+                        << this->m_clProgram->getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+    }
+    this->m_clKernel = new cl::Kernel(*m_clProgram, "PlaneWaveCompound");
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+std::string
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::GetKernelSource()
+{
+  static_assert(std::is_same<TableValueType, float>::value, "The kernel reads float delays and weights");
+
+  std::ostringstream source;
+  if (std::is_same<OutputPixelType, double>::value)
+  {
+    source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+              "typedef double REAL;\n";
+  }
+  else
+  {
+    source << "typedef float REAL;\n";
+  }
+  // One work item per output sample of every frame, as in
+  // PlaneWaveCompoundingImageFilter::DynamicThreadedGenerateData.
+  source << R"(
+__kernel void PlaneWaveCompound(__global const REAL * channels,
+                                __global const ulong * firstSamples,
+                                __global const ulong * tableOffsets,
+                                __global const float * receiveDelays,
+                                __global const float * weights,
+                                __global const float * transmitDelays,
+                                const ulong numberOfAngles,
+                                const ulong numberOfElements,
+                                const ulong numberOfChannelSamples,
+                                __global REAL * output)
+{
+  const ulong sample = get_global_id(0);
+  const ulong line = get_global_id(1);
+  const ulong frame = get_global_id(2);
+  const ulong numberOfSamples = get_global_size(0);
+  const ulong numberOfLines = get_global_size(1);
+  const float lastDelay = (float)(numberOfChannelSamples - 1);
+  REAL sum = 0;
+  for (ulong angle = 0; angle < numberOfAngles; ++angle)
+  {
+    const float transmitDelay = transmitDelays[(angle * numberOfLines + line) * numberOfSamples + sample];
+    const ulong event = frame * numberOfAngles + angle;
+    for (ulong element = 0; element < numberOfElements; ++element)
+    {
+      const ulong entry = line * numberOfElements + element;
+      const ulong firstSample = firstSamples[entry];
+      if (sample < firstSample)
+      {
+        continue;
+      }
+      const ulong tableIndex = tableOffsets[entry] + sample - firstSample;
+      const float delay = receiveDelays[tableIndex] + transmitDelay;
+      if (delay >= 0.0f && delay < lastDelay)
+      {
+        const ulong base = (ulong)delay;
+        const REAL fraction = delay - (float)base;
+        __global const REAL * channel = channels + (event * numberOfElements + element) * numberOfChannelSamples + base;
+        sum += weights[tableIndex] * (channel[0] + fraction * (channel[1] - channel[0]));
+      }
+    }
+  }
+  output[(frame * numberOfLines + line) * numberOfSamples + sample] = sum;
+}
+)";
+  return source.str();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::UpdateDeviceTables()
+{
+  if (m_DeviceTableBuild == this->GetNumberOfTableBuilds())
+  {
+    return;
+  }
+
+  // SizeValueType is not 64 bits on all platforms.
+  const std::vector<SizeValueType> & firstSamples = this->GetTableFirstSamples();
+  const std::vector<SizeValueType> & tableOffsets = this->GetTableOffsets();
+  std::vector<cl_ulong>              deviceFirstSamples(firstSamples.begin(), firstSamples.end());
+  std::vector<cl_ulong>              deviceTableOffsets(tableOffsets.begin(), tableOffsets.end());
+  // Buffers cannot be empty, e.g. when no sample is in any aperture.
+  std::vector<TableValueType> receiveDelays = this->GetTableReceiveDelays();
+  std::vector<TableValueType> weights = this->GetTableWeights();
+  if (receiveDelays.empty())
+  {
+    receiveDelays.push_back(0.0f);
+    weights.push_back(0.0f);
+  }
+  std::vector<TableValueType> transmitDelays = this->GetTableTransmitDelays();
+
+  const cl_mem_flags copyHost = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+  m_clFirstSamples =
+    cl::Buffer(*m_clContext, copyHost, deviceFirstSamples.size() * sizeof(cl_ulong), deviceFirstSamples.data());
+  m_clTableOffsets =
+    cl::Buffer(*m_clContext, copyHost, deviceTableOffsets.size() * sizeof(cl_ulong), deviceTableOffsets.data());
+  m_clReceiveDelays = cl::Buffer(*m_clContext, copyHost, receiveDelays.size() * sizeof(cl_float), receiveDelays.data());
+  m_clWeights = cl::Buffer(*m_clContext, copyHost, weights.size() * sizeof(cl_float), weights.data());
+  m_clTransmitDelays =
+    cl::Buffer(*m_clContext, copyHost, transmitDelays.size() * sizeof(cl_float), transmitDelays.data());
+
+  const typename TInputImage::SizeType & inputSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+  const OutputImageRegionType &          outputRegion = this->GetOutput()->GetLargestPossibleRegion();
+  m_DeviceNumberOfAngles = this->GetSteeringAngles().size();
+  m_DeviceNumberOfChannelSamples = inputSize[0];
+  m_DeviceNumberOfElements = inputSize[1];
+  m_DeviceNumberOfSamples = outputRegion.GetSize(0);
+  m_DeviceNumberOfLines = outputRegion.GetSize(1);
+  m_DeviceTableBuild = this->GetNumberOfTableBuilds();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::CompoundDeviceBuffer(const cl::Buffer & input,
+                                                                                        cl::Buffer &       output)
+{
+  if (m_DeviceTableBuild == 0)
+  {
+    itkExceptionMacro("The filter must be updated once before it compounds device buffers.");
+  }
+
+  try
+  {
+    cl::Kernel & kernel = *this->m_clKernel;
+    kernel.setArg(0, input);
+    kernel.setArg(1, m_clFirstSamples);
+    kernel.setArg(2, m_clTableOffsets);
+    kernel.setArg(3, m_clReceiveDelays);
+    kernel.setArg(4, m_clWeights);
+    kernel.setArg(5, m_clTransmitDelays);
+    kernel.setArg(6, static_cast<cl_ulong>(m_DeviceNumberOfAngles));
+    kernel.setArg(7, static_cast<cl_ulong>(m_DeviceNumberOfElements));
+    kernel.setArg(8, static_cast<cl_ulong>(m_DeviceNumberOfChannelSamples));
+    kernel.setArg(9, output);
+    m_clQueue->enqueueNDRangeKernel(kernel,
+                                    cl::NullRange,
+                                    cl::NDRange(m_DeviceNumberOfSamples, m_DeviceNumberOfLines, m_DeviceNumberOfFrames),
+                                    cl::NullRange);
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  // Rebuilds the tables on the host if the geometry changed.
+  this->BeforeThreadedGenerateData();
+
+  const TInputImage * input = this->GetInput();
+  OutputImageType *   output = this->GetOutput();
+  const SizeValueType inputBufferSize = input->GetBufferedRegion().GetNumberOfPixels() * sizeof(InputPixelType);
+  const SizeValueType outputBufferSize = output->GetBufferedRegion().GetNumberOfPixels() * sizeof(OutputPixelType);
+  try
+  {
+    this->UpdateDeviceTables();
+    // The number of frames of the batch does not change the tables.
+    m_DeviceNumberOfFrames = input->GetBufferedRegion().GetSize(2) / m_DeviceNumberOfAngles;
+    if (m_InputBufferSize != inputBufferSize)
+    {
+      m_clInput = cl::Buffer(*m_clContext, CL_MEM_READ_ONLY, inputBufferSize);
+      m_InputBufferSize = inputBufferSize;
+    }
+    if (m_OutputBufferSize != outputBufferSize)
+    {
+      m_clOutput = cl::Buffer(*m_clContext, CL_MEM_WRITE_ONLY, outputBufferSize);
+      m_OutputBufferSize = outputBufferSize;
+    }
+    m_clQueue->enqueueWriteBuffer(m_clInput, CL_FALSE, 0, inputBufferSize, input->GetBufferPointer());
+    this->CompoundDeviceBuffer(m_clInput, m_clOutput);
+    m_clQueue->enqueueReadBuffer(m_clOutput, CL_TRUE, 0, outputBufferSize, output->GetBufferPointer());
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+
+  this->AfterThreadedGenerateData();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLPlaneWaveCompoundingImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                            Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "DeviceTableBuild: " << m_DeviceTableBuild << std::endl;
+  os << indent << "DeviceNumberOfFrames: " << m_DeviceNumberOfFrames << std::endl;
+}
+
+} // namespace itk
+
+#endif // itkOpenCLPlaneWaveCompoundingImageFilter_hxx
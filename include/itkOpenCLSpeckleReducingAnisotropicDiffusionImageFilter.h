@@ -0,0 +1,107 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter_h
+
+#  include <string>
+
+#  include "itkSpeckleReducingAnisotropicDiffusionImageFilter.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+
+namespace itk
+{
+/** \class OpenCLSpeckleReducingAnisotropicDiffusionImageFilter
+ * \brief Speckle Reducing Anisotropic Diffusion (SRAD) with OpenCL.
+ *
+ * This filter computes the same diffusion as the fused solver of
+ * SpeckleReducingAnisotropicDiffusionImageFilter, with the same parameters,
+ * on an OpenCL device.  The image is uploaded once, all the iterations are
+ * run by two kernels on a pair of device buffers, one computing the
+ * diffusion coefficients and the other the update, and the result is read
+ * back once.
+ *
+ * The image must be 2D, with float or double pixels.  The Fused and
+ * IterationsPerPass options of the CPU filter do not apply.
+ *
+ * \ingroup ImageEnhancement
+ * \ingroup Ultrasound
+ *
+ * \sa SpeckleReducingAnisotropicDiffusionImageFilter
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT OpenCLSpeckleReducingAnisotropicDiffusionImageFilter
+  : public SpeckleReducingAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(OpenCLSpeckleReducingAnisotropicDiffusionImageFilter);
+
+  using Self = OpenCLSpeckleReducingAnisotropicDiffusionImageFilter;
+  using Superclass = SpeckleReducingAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  static constexpr unsigned int ImageDimension = Superclass::ImageDimension;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(OpenCLSpeckleReducingAnisotropicDiffusionImageFilter, SpeckleReducingAnisotropicDiffusionImageFilter);
+
+protected:
+  OpenCLSpeckleReducingAnisotropicDiffusionImageFilter();
+  ~OpenCLSpeckleReducingAnisotropicDiffusionImageFilter() override
+  {
+    delete m_clCoefficientsKernel;
+    delete m_clUpdateKernel;
+    delete m_clProgram;
+    delete m_clQueue;
+    delete m_clContext;
+  }
+
+  using FunctionType = typename Superclass::FunctionType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using PixelType = typename Superclass::PixelType;
+
+  static_assert(std::is_same<PixelType, float>::value || std::is_same<PixelType, double>::value,
+                "OpenCLSpeckleReducingAnisotropicDiffusionImageFilter diffuses float or double images");
+
+  void
+  GenerateData() override;
+
+private:
+  /** OpenCL C source of the kernels, for the precision of PixelType. */
+  static std::string
+  GetKernelSource();
+
+  cl::Context *      m_clContext = nullptr;
+  cl::CommandQueue * m_clQueue = nullptr;
+  cl::Program *      m_clProgram = nullptr;
+  cl::Kernel *       m_clCoefficientsKernel = nullptr;
+  cl::Kernel *       m_clUpdateKernel = nullptr;
+};
+
+} // namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter.hxx"
+#  endif
+
+#endif // itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter_h
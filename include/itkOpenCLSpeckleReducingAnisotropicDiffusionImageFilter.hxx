@@ -0,0 +1,242 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter_hxx
+
+#  include "itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter.h"
+
+#  include <algorithm>
+#  include <iomanip>
+#  include <sstream>
+#  include <vector>
+
+#  include "itkMath.h"
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+OpenCLSpeckleReducingAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::
+  OpenCLSpeckleReducingAnisotropicDiffusionImageFilter()
+{
+  try
+  {
+    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
+    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
+    if (devices.size() < 1)
+    {
+      itkExceptionMacro("No OpenCL devices found.");
+    }
+    // @todo: code to select the fastest device, or the device that is
+    // CL_DEVICE_TYPE_ACCELERATOR
+    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
+
+    const std::string source = GetKernelSource();
+    this->m_clProgram =
+      new cl::Program(*m_clContext, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+    try
+    {
+      this->m_clProgram->build(std::vector<cl::Device>(1, devices[0]));
+    }
+    catch (const cl::Error &)
+    {
+      itkExceptionMacro("Could not build the OpenCL SRAD kernels: "
+                        << this->m_clProgram->getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+    }
+    this->m_clCoefficientsKernel = new cl::Kernel(*m_clProgram, "Coefficients");
+    this->m_clUpdateKernel = new cl::Kernel(*m_clProgram, "Update");
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+std::string
+OpenCLSpeckleReducingAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::GetKernelSource()
+{
+  std::ostringstream source;
+  if (std::is_same<PixelType, double>::value)
+  {
+    source << "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+              "typedef double REAL;\n"
+              "typedef double2 REAL2;\n";
+  }
+  else
+  {
+    source << "typedef float REAL;\n"
+              "typedef float2 REAL2;\n";
+  }
+  // The epsilon of SpeckleReducingAnisotropicDiffusionFunction.
+  source << "#define SRAD_EPSILON ((REAL)" << std::setprecision(17) << static_cast<float>(itk::Math::eps) << ")\n";
+  // One work item per sample.  The coefficients are computed as in
+  // SpeckleReducingAnisotropicDiffusionFunction::ComputeDiffusionCoefficient,
+  // with the zero flux Neumann boundary condition, and the first and last
+  // samples and lines are not updated.
+  source << R"(
+__kernel void Coefficients(__global const REAL * image,
+                           const uint lineLength,
+                           const uint numberOfLines,
+                           const REAL2 halfScales,
+                           const REAL q0_t,
+                           __global REAL * coefficients)
+{
+  const uint ii = get_global_id(0);
+  const uint line = get_global_id(1);
+  __global const REAL * currentLine = image + line * lineLength;
+  __global const REAL * previousLine = image + (line > 0 ? line - 1 : line) * lineLength;
+  __global const REAL * nextLine = image + (line + 1 < numberOfLines ? line + 1 : line) * lineLength;
+  const REAL center = currentLine[ii];
+  const REAL previous = currentLine[ii > 0 ? ii - 1 : ii];
+  const REAL following = currentLine[ii + 1 < lineLength ? ii + 1 : ii];
+  const REAL dx0 = halfScales.x * (following - previous);
+  const REAL dx1 = halfScales.y * (nextLine[ii] - previousLine[ii]);
+  const REAL squaredGradient = dx0 * dx0 + dx1 * dx1;
+  const REAL laplacian = previous + following + previousLine[ii] + nextLine[ii] - 4 * center;
+
+  const REAL inverseIntensity = 1 / (center + SRAD_EPSILON);
+  const REAL normalizedLaplacian = (REAL)0.25 * laplacian * inverseIntensity;
+  const REAL numerator =
+    (REAL)0.5 * squaredGradient * inverseIntensity * inverseIntensity - normalizedLaplacian * normalizedLaplacian;
+  const REAL q_t2 = fmax(numerator, (REAL)0) / ((1 + normalizedLaplacian) * (1 + normalizedLaplacian));
+  const REAL q0_t2 = q0_t * q0_t;
+  coefficients[line * lineLength + ii] = 1 / (1 + (q_t2 - q0_t2) / (q0_t2 * (1 + q0_t2) + SRAD_EPSILON));
+}
+
+__kernel void Update(__global const REAL * current,
+                     __global const REAL * coefficients,
+                     const uint lineLength,
+                     const uint numberOfLines,
+                     const REAL updateScale,
+                     __global REAL * next)
+{
+  const uint ii = get_global_id(0);
+  const uint line = get_global_id(1);
+  const uint offset = line * lineLength + ii;
+  const REAL center = current[offset];
+  if (ii == 0 || line == 0 || ii + 1 == lineLength || line + 1 == numberOfLines)
+  {
+    next[offset] = center;
+    return;
+  }
+  const REAL delta = coefficients[offset + lineLength] * (current[offset + lineLength] - center) +
+                     coefficients[offset + 1] * (current[offset + 1] - center) +
+                     coefficients[offset] * (current[offset - lineLength] + current[offset - 1] - 2 * center);
+  next[offset] = center + updateScale * delta;
+}
+)";
+  return source.str();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+OpenCLSpeckleReducingAnisotropicDiffusionImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  if (ImageDimension != 2)
+  {
+    itkExceptionMacro("The OpenCL solver requires a 2D image.");
+  }
+  auto * f = dynamic_cast<FunctionType *>(this->GetDifferenceFunction().GetPointer());
+  if (!f)
+  {
+    throw ExceptionObject(
+      __FILE__, __LINE__, "Speckle reducing anisotropic diffusion function is not set.", ITK_LOCATION);
+  }
+
+  this->AllocateOutputs();
+  this->CopyInputToOutput();
+
+  f->SetTimeStep(this->GetTimeStep());
+  f->SetRho(this->m_Rho);
+  f->SetQ0(this->m_Q0);
+
+  OutputImageType *                           output = this->GetOutput();
+  const typename OutputImageType::SizeType    size = output->GetBufferedRegion().GetSize();
+  const typename OutputImageType::SpacingType spacing = output->GetSpacing();
+  const SizeValueType                         lineLength = size[0];
+  const SizeValueType                         numberOfLines = size[1];
+  const size_t                                bufferSize = lineLength * numberOfLines * sizeof(PixelType);
+
+  PixelType scales[ImageDimension];
+  PixelType updateScale = static_cast<PixelType>(this->GetTimeStep() / 4);
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    scales[dim] = static_cast<PixelType>(this->GetUseImageSpacing() ? 1.0 / spacing[dim] : 1.0);
+    updateScale *= scales[dim];
+  }
+  using Real2Type = typename std::conditional<std::is_same<PixelType, double>::value, cl_double2, cl_float2>::type;
+  Real2Type halfScales;
+  halfScales.s[0] = static_cast<PixelType>(0.5) * scales[0];
+  halfScales.s[1] = static_cast<PixelType>(0.5) * scales[1];
+
+  try
+  {
+    // The image stays on the device for all the iterations.
+    const cl_mem_flags copyHost = CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR;
+    cl::Buffer         currentBuffer(*m_clContext, copyHost, bufferSize, output->GetBufferPointer());
+    cl::Buffer nextBuffer(*m_clContext, CL_MEM_READ_WRITE, bufferSize);
+    cl::Buffer coefficientsBuffer(*m_clContext, CL_MEM_READ_WRITE, bufferSize);
+    const cl::NDRange globalSize(lineLength, numberOfLines);
+
+    cl::Kernel & coefficients = *this->m_clCoefficientsKernel;
+    coefficients.setArg(1, static_cast<cl_uint>(lineLength));
+    coefficients.setArg(2, static_cast<cl_uint>(numberOfLines));
+    coefficients.setArg(3, halfScales);
+    coefficients.setArg(5, coefficientsBuffer);
+    cl::Kernel & update = *this->m_clUpdateKernel;
+    update.setArg(1, coefficientsBuffer);
+    update.setArg(2, static_cast<cl_uint>(lineLength));
+    update.setArg(3, static_cast<cl_uint>(numberOfLines));
+    update.setArg(4, updateScale);
+
+    const SizeValueType numberOfIterations = this->GetNumberOfIterations();
+    this->m_ElapsedIterations = 0;
+    while (this->m_ElapsedIterations < numberOfIterations)
+    {
+      coefficients.setArg(0, currentBuffer);
+      coefficients.setArg(4, f->ComputeSpeckleScale(this->m_ElapsedIterations));
+      m_clQueue->enqueueNDRangeKernel(coefficients, cl::NullRange, globalSize, cl::NullRange);
+
+      update.setArg(0, currentBuffer);
+      update.setArg(5, nextBuffer);
+      m_clQueue->enqueueNDRangeKernel(update, cl::NullRange, globalSize, cl::NullRange);
+      std::swap(currentBuffer, nextBuffer);
+
+      ++this->m_ElapsedIterations;
+      this->InvokeEvent(IterationEvent());
+      this->UpdateProgress(static_cast<float>(this->m_ElapsedIterations) / static_cast<float>(numberOfIterations));
+      if (this->GetAbortGenerateData())
+      {
+        break;
+      }
+    }
+
+    m_clQueue->enqueueReadBuffer(currentBuffer, CL_TRUE, 0, bufferSize, output->GetBufferPointer());
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+} // namespace itk
+
+#endif // itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter_hxx
@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLSpectra1DImageFilter_h) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLSpectra1DImageFilter_h
+
+#  include <string>
+
+#  include "itkSpectra1DImageFilter.h"
+
+#  define __CL_ENABLE_EXCEPTIONS
+#  include "CL/cl.hpp"
+#  include "clFFT.h"
+
+namespace itk
+{
+/** \class OpenCLSpectra1DImageFilter
+ * \brief Generate an image of local spectra with OpenCL and clFFT.
+ *
+ * This filter computes the same spectra as Spectra1DImageFilter, with the
+ * same parameters, on an OpenCL device.  The input samples are uploaded
+ * once per update.  The windowed Welch's method segments of every line of
+ * the support windows are gathered on the device and transformed by one
+ * batched clFFT plan.  Their periodograms are averaged and the lateral
+ * weighted sum, the normalization by the reference spectra and the
+ * conversion to decibels are done by kernels, so only the output spectra
+ * are read back.
+ *
+ * The segment length, half the FFT1DSize, must only have prime factors 2,
+ * 3, 5 and 7.  The output must hold spectra, not line fits, and the
+ * Batched, ReuseSegments and UseFFTW options of the CPU filter do not
+ * apply.
+ *
+ * There is considerable overhead to generate the FFT plan, which occurs
+ * whenever the number of lines or the segment length changes.  Therefore,
+ * the throughput benefit will only be realized for large images or many
+ * images with the same support windows.
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ *
+ * \sa Spectra1DImageFilter
+ */
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT OpenCLSpectra1DImageFilter
+  : public Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(OpenCLSpectra1DImageFilter);
+
+  using Self = OpenCLSpectra1DImageFilter;
+  using Superclass = Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Standard class type alias.*/
+  using InputImageType = typename Superclass::InputImageType;
+  using SupportWindowImageType = typename Superclass::SupportWindowImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using SpectraImageType = typename Superclass::SpectraImageType;
+  using ScalarType = typename Superclass::ScalarType;
+
+  static_assert(!Superclass::LinearFitOutput, "OpenCLSpectra1DImageFilter only computes spectra");
+  static_assert(!Superclass::HalfPrecisionOutput, "OpenCLSpectra1DImageFilter stores float or double spectra");
+  static_assert(std::is_same<ScalarType, float>::value || std::is_same<ScalarType, double>::value,
+                "OpenCLSpectra1DImageFilter computes float or double spectra");
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(OpenCLSpectra1DImageFilter, Spectra1DImageFilter);
+
+  /** clFFT supports prime factors 2, 3, 5 and 7. */
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    return 7;
+  }
+
+protected:
+  OpenCLSpectra1DImageFilter();
+  virtual ~OpenCLSpectra1DImageFilter()
+  {
+    if (m_PlanComputed)
+    {
+      clfftDestroyPlan(&this->m_Plan);
+    }
+    delete m_clGatherSegmentsKernel;
+    delete m_clPeriodogramsKernel;
+    delete m_clLateralSumKernel;
+    delete m_clProgram;
+    delete m_clQueue;
+    delete m_clContext;
+  }
+
+  using OutputImageRegionType = typename Superclass::OutputImageRegionType;
+  using SpectraVectorType = typename Superclass::SpectraVectorType;
+  using IndexType = typename Superclass::IndexType;
+  using SupportWindowType = typename Superclass::SupportWindowType;
+  using FFT1DSizeType = typename Superclass::FFT1DSizeType;
+
+  void
+  GenerateData() override;
+
+private:
+  /** OpenCL C source of the kernels, for the precision of ScalarType. */
+  static std::string
+  GetKernelSource();
+
+  bool               m_PlanComputed = false;
+  clfftPlanHandle    m_Plan = 0;
+  size_t             m_PlanFFTSize = 0;
+  size_t             m_PlanBatchSize = 0;
+  cl::Context *      m_clContext = nullptr;
+  cl::CommandQueue * m_clQueue = nullptr;
+  cl::Program *      m_clProgram = nullptr;
+  cl::Kernel *       m_clGatherSegmentsKernel = nullptr;
+  cl::Kernel *       m_clPeriodogramsKernel = nullptr;
+  cl::Kernel *       m_clLateralSumKernel = nullptr;
+};
+
+} // namespace itk
+
+#  ifndef ITK_MANUAL_INSTANTIATION
+#    include "itkOpenCLSpectra1DImageFilter.hxx"
+#  endif
+
+#endif // itkOpenCLSpectra1DImageFilter_h
@@ -0,0 +1,385 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if !defined(itkOpenCLSpectra1DImageFilter_hxx) && defined(ITKUltrasound_USE_clFFT)
+#  define itkOpenCLSpectra1DImageFilter_hxx
+
+#  include "itkOpenCLSpectra1DImageFilter.h"
+#  include "itkclFFTInitializer.h"
+
+#  include <algorithm>
+#  include <map>
+#  include <vector>
+
+#  include "itkImageRegionConstIterator.h"
+#  include "itkImageRegionConstIteratorWithIndex.h"
+#  include "itkMetaDataObject.h"
+
+namespace itk
+{
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+OpenCLSpectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::OpenCLSpectra1DImageFilter()
+{
+  try
+  {
+    clFFFInitialization();
+    m_clContext = new cl::Context(CL_DEVICE_TYPE_ALL);
+    std::vector<cl::Device> devices = m_clContext->getInfo<CL_CONTEXT_DEVICES>();
+    if (devices.size() < 1)
+    {
+      itkExceptionMacro("No OpenCL devices found.");
+    }
+    // @todo: code to select the fastest device, or the device that is
+    // CL_DEVICE_TYPE_ACCELERATOR
+    this->m_clQueue = new cl::CommandQueue(*m_clContext, devices[0]);
+
+    const std::string source = GetKernelSource();
+    this->m_clProgram =
+      new cl::Program(*m_clContext, cl::Program::Sources(1, std::make_pair(source.c_str(), source.size())));
+    try
+    {
+      this->m_clProgram->build(std::vector<cl::Device>(1, devices[0]));
+    }
+    catch (const cl::Error &)
+    {
+      itkExceptionMacro("Could not build the OpenCL spectra kernels: "
+                        << this->m_clProgram->getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]));
+    }
+    this->m_clGatherSegmentsKernel = new cl::Kernel(*m_clProgram, "GatherSegments");
+    this->m_clPeriodogramsKernel = new cl::Kernel(*m_clProgram, "Periodograms");
+    this->m_clLateralSumKernel = new cl::Kernel(*m_clProgram, "LateralSum");
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+std::string
+OpenCLSpectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::GetKernelSource()
+{
+  std::string source;
+  if (std::is_same<ScalarType, double>::value)
+  {
+    source = "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+             "typedef double REAL;\n"
+             "typedef double2 REAL2;\n"
+             "#define REAL_EPSILON DBL_EPSILON\n"
+             "#define REAL_MIN DBL_MIN\n";
+  }
+  else
+  {
+    source = "typedef float REAL;\n"
+             "typedef float2 REAL2;\n"
+             "#define REAL_EPSILON FLT_EPSILON\n"
+             "#define REAL_MIN FLT_MIN\n";
+  }
+  // One work item per segment sample, per periodogram bin and per output
+  // spectrum bin.  The line windows are stored as in Spectra1DImageFilter,
+  // the window of n lines starting at n (n - 1) / 2.
+  source += R"(
+__kernel void GatherSegments(__global const REAL * input,
+                             __global const uint * lineOffsets,
+                             __global const uint * segmentOffsets,
+                             __global const REAL * window,
+                             const uint fftSize,
+                             const uint numberOfSegments,
+                             __global REAL2 * segments)
+{
+  const uint sample = get_global_id(0);
+  const uint segment = get_global_id(1);
+  const uint line = get_global_id(2);
+  const REAL value = input[lineOffsets[line] + segmentOffsets[segment] + sample] * window[sample];
+  segments[(line * numberOfSegments + segment) * fftSize + sample] = (REAL2)(value, 0);
+}
+
+__kernel void Periodograms(__global const REAL2 * segments,
+                           const uint fftSize,
+                           const uint numberOfSegments,
+                           const uint firstBin,
+                           const uint numberOfBins,
+                           const REAL scale,
+                           __global REAL * spectra)
+{
+  const uint bin = get_global_id(0);
+  const uint line = get_global_id(1);
+  REAL sum = 0;
+  for (uint segment = 0; segment < numberOfSegments; ++segment)
+  {
+    const REAL2 value = segments[(line * numberOfSegments + segment) * fftSize + firstBin + bin];
+    sum += value.x * value.x + value.y * value.y;
+  }
+  spectra[line * numberOfBins + bin] = sum * scale;
+}
+
+__kernel void LateralSum(__global const REAL * spectra,
+                         __global const uint * windowStarts,
+                         __global const uint * windowLines,
+                         __global const REAL * lineWindows,
+                         const uint numberOfBins,
+                         __global const REAL * reference,
+                         const int normalize,
+                         const int decibel,
+                         __global REAL * output)
+{
+  const uint bin = get_global_id(0);
+  const uint pixel = get_global_id(1);
+  const uint start = windowStarts[pixel];
+  const uint numberOfLines = windowStarts[pixel + 1] - start;
+  __global const REAL * weights = lineWindows + numberOfLines * (numberOfLines - 1) / 2;
+  REAL sum = 0;
+  for (uint line = 0; line < numberOfLines; ++line)
+  {
+    sum += weights[line] * spectra[windowLines[start + line] * numberOfBins + bin];
+  }
+  if (normalize)
+  {
+    const REAL referenceValue = reference[pixel * numberOfBins + bin];
+    sum = fabs(referenceValue) <= (REAL)0.1 * REAL_EPSILON ? 0 : sum / referenceValue;
+  }
+  if (decibel)
+  {
+    sum = 10 * log10(fmax(sum, REAL_MIN));
+  }
+  output[pixel * numberOfBins + bin] = sum;
+}
+)";
+  return source;
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+OpenCLSpectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  this->PrepareSpectraEstimation();
+
+  const InputImageType *         input = this->GetInput();
+  const SupportWindowImageType * supportWindowImage = this->GetSupportWindowImage();
+  const SpectraImageType *       referenceSpectra = this->GetReferenceSpectraImage();
+  OutputImageType *              output = this->GetOutput();
+  const OutputImageRegionType &  outputRegion = output->GetBufferedRegion();
+
+  const FFT1DSizeType fft1DSize = this->GetCurrentFFT1DSize();
+  const FFT1DSizeType fftSize = fft1DSize / 2;
+  if (Math::GreatestPrimeFactor(static_cast<SizeValueType>(fftSize)) > this->GetSizeGreatestPrimeFactor())
+  {
+    itkExceptionMacro("Illegal segment size for the OpenCL FFT: " << fftSize);
+  }
+  const unsigned int  numberOfSegments = this->GetNumberOfSegments();
+  const double        segmentHop = fftSize * (1.0 - this->GetSegmentOverlap());
+  const FFT1DSizeType numberOfBins = this->GetNumberOfOutputFrequencyBins(fft1DSize);
+  const size_t        numberOfPixels = outputRegion.GetNumberOfPixels();
+
+  // Number every line of the support windows once, and list the lines of
+  // the window of each output pixel, in the order of the output buffer.
+  using LineIdMapType =
+    std::map<IndexType, cl_uint, typename Functor::IndexLexicographicCompare<Superclass::ImageDimension>>;
+  LineIdMapType        lineIds;
+  std::vector<cl_uint> lineOffsets;
+  std::vector<cl_uint> windowStarts;
+  std::vector<cl_uint> windowLines;
+  windowStarts.reserve(numberOfPixels + 1);
+  const typename InputImageType::RegionType & inputRegion = input->GetBufferedRegion();
+  ImageRegionConstIterator<SupportWindowImageType> supportWindowIt(supportWindowImage, outputRegion);
+  for (supportWindowIt.GoToBegin(); !supportWindowIt.IsAtEnd(); ++supportWindowIt)
+  {
+    windowStarts.push_back(static_cast<cl_uint>(windowLines.size()));
+    const SupportWindowType & supportWindow = supportWindowIt.Value();
+    for (typename SupportWindowType::const_iterator windowLine = supportWindow.begin();
+         windowLine != supportWindow.end();
+         ++windowLine)
+    {
+      const IndexType lineIndex = *windowLine;
+      IndexType       lineEnd = lineIndex;
+      lineEnd[0] += static_cast<IndexValueType>(fft1DSize) - 1;
+      if (!inputRegion.IsInside(lineIndex) || !inputRegion.IsInside(lineEnd))
+      {
+        itkExceptionMacro("The line at " << lineIndex << " is outside of the input buffered region " << inputRegion);
+      }
+      const typename LineIdMapType::const_iterator lineIt =
+        lineIds.insert(std::make_pair(lineIndex, static_cast<cl_uint>(lineOffsets.size()))).first;
+      if (lineIt->second == lineOffsets.size())
+      {
+        lineOffsets.push_back(static_cast<cl_uint>(input->ComputeOffset(lineIndex)));
+      }
+      windowLines.push_back(lineIt->second);
+    }
+  }
+  windowStarts.push_back(static_cast<cl_uint>(windowLines.size()));
+  const size_t numberOfLines = std::max(lineOffsets.size(), static_cast<size_t>(1));
+  lineOffsets.resize(numberOfLines, 0);
+  windowLines.resize(std::max(windowLines.size(), static_cast<size_t>(1)), 0);
+
+  std::vector<cl_uint> segmentOffsets(numberOfSegments);
+  for (unsigned int segment = 0; segment < numberOfSegments; ++segment)
+  {
+    segmentOffsets[segment] = static_cast<cl_uint>(segment * segmentHop);
+  }
+
+  // The input is uploaded once, converted to the spectra precision.
+  SpectraVectorType inputSamples(inputRegion.GetNumberOfPixels());
+  ImageRegionConstIterator<InputImageType> inputIt(input, inputRegion);
+  typename SpectraVectorType::iterator     inputSampleIt = inputSamples.begin();
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++inputSampleIt)
+  {
+    *inputSampleIt = static_cast<ScalarType>(inputIt.Get());
+  }
+
+  // The reference spectra of the output bins, in the order of the output.
+  SpectraVectorType reference(1);
+  if (referenceSpectra != nullptr)
+  {
+    reference.resize(numberOfPixels * numberOfBins);
+    const unsigned int                                  referenceOffset = this->GetReferenceComponentOffset();
+    ImageRegionConstIteratorWithIndex<SpectraImageType> referenceIt(referenceSpectra, outputRegion);
+    typename SpectraVectorType::iterator                referenceValueIt = reference.begin();
+    for (referenceIt.GoToBegin(); !referenceIt.IsAtEnd(); ++referenceIt)
+    {
+      const typename SpectraImageType::PixelType referencePixel = referenceIt.Get();
+      for (FFT1DSizeType bin = 0; bin < numberOfBins; ++bin, ++referenceValueIt)
+      {
+        *referenceValueIt = referencePixel[referenceOffset + bin];
+      }
+    }
+  }
+
+  // One batched plan transforms the segments of all the lines.
+  cl_command_queue queue = (*m_clQueue)();
+  const size_t     batchSize = numberOfLines * numberOfSegments;
+  if (this->m_PlanComputed && (this->m_PlanFFTSize != fftSize || this->m_PlanBatchSize != batchSize))
+  {
+    clfftDestroyPlan(&this->m_Plan);
+    this->m_PlanComputed = false;
+  }
+  if (!this->m_PlanComputed)
+  {
+    const size_t n[3] = { fftSize, 1, 1 };
+    clfftStatus  error_code = clfftCreateDefaultPlan(&this->m_Plan, (*m_clContext)(), CLFFT_1D, n);
+    if (!this->m_Plan || error_code)
+    {
+      itkExceptionMacro("Could not create OpenCL FFT Plan.");
+    }
+    error_code = clfftSetResultLocation(this->m_Plan, CLFFT_INPLACE);
+    error_code = clfftSetPlanBatchSize(this->m_Plan, batchSize);
+    if (std::is_same<ScalarType, double>::value) // float by default
+    {
+      error_code = clfftSetPlanPrecision(this->m_Plan, CLFFT_DOUBLE);
+    }
+    clfftBakePlan(this->m_Plan, 1, &queue, nullptr, nullptr);
+    this->m_PlanFFTSize = fftSize;
+    this->m_PlanBatchSize = batchSize;
+    this->m_PlanComputed = true;
+  }
+
+  const SpectraVectorType & segmentWindow = this->GetSegmentWindow();
+  try
+  {
+    const cl_mem_flags readOnly = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+    cl::Buffer inputBuffer(*m_clContext, readOnly, inputSamples.size() * sizeof(ScalarType), inputSamples.data());
+    cl::Buffer lineOffsetsBuffer(*m_clContext, readOnly, lineOffsets.size() * sizeof(cl_uint), lineOffsets.data());
+    cl::Buffer segmentOffsetsBuffer(
+      *m_clContext, readOnly, segmentOffsets.size() * sizeof(cl_uint), segmentOffsets.data());
+    cl::Buffer windowBuffer(*m_clContext,
+                            readOnly,
+                            segmentWindow.size() * sizeof(ScalarType),
+                            const_cast<ScalarType *>(segmentWindow.data()));
+    cl::Buffer segmentsBuffer(*m_clContext, CL_MEM_READ_WRITE, batchSize * fftSize * 2 * sizeof(ScalarType));
+    cl::Buffer spectraBuffer(*m_clContext, CL_MEM_READ_WRITE, numberOfLines * numberOfBins * sizeof(ScalarType));
+
+    // Gather and window the segments of every line.
+    cl::Kernel & gatherSegments = *this->m_clGatherSegmentsKernel;
+    gatherSegments.setArg(0, inputBuffer);
+    gatherSegments.setArg(1, lineOffsetsBuffer);
+    gatherSegments.setArg(2, segmentOffsetsBuffer);
+    gatherSegments.setArg(3, windowBuffer);
+    gatherSegments.setArg(4, static_cast<cl_uint>(fftSize));
+    gatherSegments.setArg(5, static_cast<cl_uint>(numberOfSegments));
+    gatherSegments.setArg(6, segmentsBuffer);
+    m_clQueue->enqueueNDRangeKernel(
+      gatherSegments, cl::NullRange, cl::NDRange(fftSize, numberOfSegments, numberOfLines), cl::NullRange);
+
+    // Transform all the segments at once.
+    cl_mem      segmentsPointer = segmentsBuffer();
+    clfftStatus err = clfftEnqueueTransform(
+      this->m_Plan, CLFFT_FORWARD, 1, &queue, 0, nullptr, nullptr, &segmentsPointer, nullptr, nullptr);
+    if (err)
+    {
+      itkExceptionMacro("Error in clfftEnqueueTransform(" << err << ")");
+    }
+
+    // Average the periodograms of the segments of every line, without DC.
+    cl::Kernel & periodograms = *this->m_clPeriodogramsKernel;
+    periodograms.setArg(0, segmentsBuffer);
+    periodograms.setArg(1, static_cast<cl_uint>(fftSize));
+    periodograms.setArg(2, static_cast<cl_uint>(numberOfSegments));
+    periodograms.setArg(3, static_cast<cl_uint>(this->GetFirstFrequencyBin() + 1));
+    periodograms.setArg(4, static_cast<cl_uint>(numberOfBins));
+    periodograms.setArg(5, static_cast<ScalarType>(1.0 / (numberOfSegments * static_cast<double>(fftSize) * fftSize)));
+    periodograms.setArg(6, spectraBuffer);
+    m_clQueue->enqueueNDRangeKernel(
+      periodograms, cl::NullRange, cl::NDRange(numberOfBins, numberOfLines), cl::NullRange);
+
+    // Lateral window and sum, normalization and decibels.
+    SizeValueType windowLength = 0;
+    for (size_t pixel = 0; pixel < numberOfPixels; ++pixel)
+    {
+      windowLength = std::max(windowLength, static_cast<SizeValueType>(windowStarts[pixel + 1] - windowStarts[pixel]));
+    }
+    SpectraVectorType lineWindows(std::max(windowLength * (windowLength + 1) / 2, static_cast<SizeValueType>(1)));
+    for (SizeValueType length = 1; length <= windowLength; ++length)
+    {
+      const ScalarType * lineWindow = this->GetLineWindow(length);
+      std::copy(lineWindow, lineWindow + length, lineWindows.begin() + length * (length - 1) / 2);
+    }
+    cl::Buffer windowStartsBuffer(
+      *m_clContext, readOnly, windowStarts.size() * sizeof(cl_uint), windowStarts.data());
+    cl::Buffer windowLinesBuffer(*m_clContext, readOnly, windowLines.size() * sizeof(cl_uint), windowLines.data());
+    cl::Buffer lineWindowsBuffer(*m_clContext, readOnly, lineWindows.size() * sizeof(ScalarType), lineWindows.data());
+    cl::Buffer referenceBuffer(*m_clContext, readOnly, reference.size() * sizeof(ScalarType), reference.data());
+    cl::Buffer outputBuffer(*m_clContext, CL_MEM_WRITE_ONLY, numberOfPixels * numberOfBins * sizeof(ScalarType));
+
+    cl::Kernel & lateralSum = *this->m_clLateralSumKernel;
+    lateralSum.setArg(0, spectraBuffer);
+    lateralSum.setArg(1, windowStartsBuffer);
+    lateralSum.setArg(2, windowLinesBuffer);
+    lateralSum.setArg(3, lineWindowsBuffer);
+    lateralSum.setArg(4, static_cast<cl_uint>(numberOfBins));
+    lateralSum.setArg(5, referenceBuffer);
+    lateralSum.setArg(6, static_cast<cl_int>(referenceSpectra != nullptr));
+    lateralSum.setArg(7, static_cast<cl_int>(this->GetDecibelOutput()));
+    lateralSum.setArg(8, outputBuffer);
+    m_clQueue->enqueueNDRangeKernel(
+      lateralSum, cl::NullRange, cl::NDRange(numberOfBins, numberOfPixels), cl::NullRange);
+
+    // The output buffer has the bins of every pixel in the same order.
+    m_clQueue->enqueueReadBuffer(
+      outputBuffer, CL_TRUE, 0, numberOfPixels * numberOfBins * sizeof(ScalarType), output->GetBufferPointer());
+  }
+  catch (const cl::Error & e)
+  {
+    itkExceptionMacro("Error in OpenCL: " << e.what() << "(" << e.err() << ")");
+  }
+}
+
+} // namespace itk
+
+#endif // itkOpenCLSpectra1DImageFilter_hxx
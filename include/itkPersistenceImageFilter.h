@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPersistenceImageFilter_h
+#define itkPersistenceImageFilter_h
+
+#include "itkInPlaceImageFilter.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class PersistenceImageFilter
+ * \brief Recursive temporal filter of the frames of a B-mode cine.
+ *
+ * Each update filters a new frame with the frames before it: the output is
+ *
+ *   y_n = x_n + w (y_{n-1} - x_n),
+ *
+ * where x_n is the input frame and w the Persistence, so that the frames are
+ * averaged with exponentially decreasing weights.  The only state is the
+ * previous output frame, kept by the filter in the precision of
+ * NumericTraits<PixelType>::FloatType, so that the memory does not grow with
+ * the length of the averaging.
+ *
+ * With a MotionThreshold, the persistence of every pixel is decreased
+ * linearly with the difference between the new frame and the previous
+ * output, down to 0 at the threshold, so that moving structures are not
+ * smeared.
+ *
+ * The first frame, the first frame after Reset(), and the first frame of a
+ * new size pass through unchanged.  The frames are expected in order, e.g.
+ * as the FrameFilter of a RingBufferedVideoFilter after a BModeImageFilter.
+ * The filter can run in place, see InPlaceImageFilter, and makes a single
+ * pass over the contiguous buffers, multithreaded over blocks of pixels.
+ * The whole frame is always generated.
+ *
+ * \sa BModeImageFilter
+ * \sa RingBufferedVideoFilter
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TImage>
+class ITK_TEMPLATE_EXPORT PersistenceImageFilter : public InPlaceImageFilter<TImage, TImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PersistenceImageFilter);
+
+  /** Standard class type alias. */
+  using ImageType = TImage;
+
+  using Self = PersistenceImageFilter;
+  using Superclass = InPlaceImageFilter<ImageType, ImageType>;
+
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkTypeMacro(PersistenceImageFilter, InPlaceImageFilter);
+  itkNewMacro(Self);
+
+  using PixelType = typename ImageType::PixelType;
+  using RealType = typename NumericTraits<PixelType>::FloatType;
+
+  /** Weight of the previous output frame, between 0, for no filtering, and
+   * 1, excluded.  By default it is 0.5. */
+  itkSetClampMacro(Persistence, double, 0.0, 0.999);
+  itkGetConstMacro(Persistence, double);
+
+  /** Difference between the new frame and the previous output, in pixel
+   * values, at and above which a pixel is not filtered.  By default it is
+   * 0, for the same persistence everywhere. */
+  itkSetClampMacro(MotionThreshold, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(MotionThreshold, double);
+
+  /** Number of frames filtered since the state was last reset. */
+  itkGetConstMacro(NumberOfFilteredFrames, SizeValueType);
+
+  /** Forget the previous frames.  The next frame passes through. */
+  void
+  Reset()
+  {
+    m_State.clear();
+    m_NumberOfFilteredFrames = 0;
+    this->Modified();
+  }
+
+protected:
+  PersistenceImageFilter() = default;
+  ~PersistenceImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+private:
+  double m_Persistence{ 0.5 };
+  double m_MotionThreshold{ 0.0 };
+
+  /** The previous output frame, and its region. */
+  std::vector<RealType>          m_State;
+  typename ImageType::RegionType m_StateRegion;
+  SizeValueType                  m_NumberOfFilteredFrames{ 0 };
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPersistenceImageFilter.hxx"
+#endif
+
+#endif // itkPersistenceImageFilter_h
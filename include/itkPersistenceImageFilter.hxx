@@ -0,0 +1,107 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPersistenceImageFilter_hxx
+#define itkPersistenceImageFilter_hxx
+
+#include "itkPersistenceImageFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TImage>
+void
+PersistenceImageFilter<TImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TImage>
+void
+PersistenceImageFilter<TImage>::GenerateData()
+{
+  // Takes over the buffer of the input when running in place.
+  this->AllocateOutputs();
+
+  const ImageType *   input = this->GetInput();
+  ImageType *         output = this->GetOutput();
+  const PixelType *   inputBuffer = input->GetBufferPointer();
+  PixelType *         outputBuffer = output->GetBufferPointer();
+  const SizeValueType numberOfPixels = output->GetBufferedRegion().GetNumberOfPixels();
+
+  // The first frame is its own history.
+  if (m_State.size() != numberOfPixels || m_StateRegion != output->GetBufferedRegion())
+  {
+    m_State.assign(inputBuffer, inputBuffer + numberOfPixels);
+    m_StateRegion = output->GetBufferedRegion();
+    m_NumberOfFilteredFrames = 0;
+  }
+
+  const RealType persistence = static_cast<RealType>(m_Persistence);
+  // A zero threshold makes the motion term vanish instead of dividing by 0.
+  const RealType inverseThreshold =
+    m_MotionThreshold > 0.0 ? static_cast<RealType>(1.0 / m_MotionThreshold) : static_cast<RealType>(0);
+  RealType * state = m_State.data();
+
+  // Blocks of contiguous pixels, large enough to amortize the scheduling.
+  const SizeValueType blockSize = 16384;
+  const SizeValueType numberOfBlocks = (numberOfPixels + blockSize - 1) / blockSize;
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfBlocks,
+    [=](SizeValueType block) {
+      const SizeValueType begin = block * blockSize;
+      const SizeValueType end = std::min(begin + blockSize, numberOfPixels);
+      // Without branches, so that it vectorizes.
+      for (SizeValueType ii = begin; ii < end; ++ii)
+      {
+        const RealType sample = static_cast<RealType>(inputBuffer[ii]);
+        const RealType difference = state[ii] - sample;
+        const RealType motion = std::max(static_cast<RealType>(1) - std::abs(difference) * inverseThreshold,
+                                         static_cast<RealType>(0));
+        const RealType filtered = sample + persistence * motion * difference;
+        state[ii] = filtered;
+        outputBuffer[ii] = static_cast<PixelType>(filtered);
+      }
+    },
+    this);
+
+  ++m_NumberOfFilteredFrames;
+}
+
+
+template <typename TImage>
+void
+PersistenceImageFilter<TImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Persistence: " << m_Persistence << std::endl;
+  os << indent << "MotionThreshold: " << m_MotionThreshold << std::endl;
+  os << indent << "NumberOfFilteredFrames: " << m_NumberOfFilteredFrames << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkPersistenceImageFilter_hxx
@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseShiftDisplacementImageFilter_h
+#define itkPhaseShiftDisplacementImageFilter_h
+
+#include <complex>
+#include <vector>
+
+#include "itkImageToImageFilter.h"
+#include "itkVector.h"
+
+namespace itk
+{
+
+/** \class PhaseShiftDisplacementImageFilter
+ * \brief Estimate the axial displacements between two frames of complex
+ * echo data from their phase shift.
+ *
+ * The inputs are the analytic signals of two RF frames, e.g. from
+ * AnalyticSignalImageFilter, or their IQ data, e.g. from
+ * QuadratureDemodulationImageFilter, with the axial direction, the direction
+ * of propagation, along the first direction.  The moving frame is the fixed
+ * frame after the tissue moved.
+ *
+ * With the 2D autocorrelator of Loupas et al., the phase of the lag-zero
+ * cross-correlation of the frames, summed over a kernel around every pixel,
+ * is the phase shift of the echo, and the phase of the lag-one axial
+ * autocorrelation of both frames is the mean frequency of the echo in the
+ * kernel, plus the DemodulationFrequency for IQ data.  Their ratio is the
+ * axial displacement, in samples, which is converted to physical units with
+ * the spacing.  The other components of the displacements are 0.  Output 0
+ * has the displacements, as the DisplacementImageType of
+ * BlockMatching::DisplacementPipeline, so that they go through the same
+ * strain estimation.
+ *
+ * The products are summed over the kernel with running sums along each
+ * direction, so that the cost per pixel does not depend on the
+ * KernelRadius.  Displacements beyond a quarter of the wavelength, half of
+ * a period of the phase, wrap around.  Output 1, GetCorrelationOutput(), has
+ * the magnitude of the normalized cross-correlation in the kernel, low
+ * where the phase is not reliable, e.g. to restrict a block matching
+ * estimation to those pixels.
+ *
+ * Both frames are processed whole.
+ *
+ * \sa BlockMatching::DisplacementPipeline
+ * \sa AnalyticSignalImageFilter
+ * \sa QuadratureDemodulationImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TComplexImage,
+          typename TDisplacementImage = Image<
+            Vector<typename NumericTraits<typename TComplexImage::PixelType>::ValueType, TComplexImage::ImageDimension>,
+            TComplexImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT PhaseShiftDisplacementImageFilter
+  : public ImageToImageFilter<TComplexImage, TDisplacementImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PhaseShiftDisplacementImageFilter);
+
+  /** Standard class type alias. */
+  using Self = PhaseShiftDisplacementImageFilter;
+  using Superclass = ImageToImageFilter<TComplexImage, TDisplacementImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PhaseShiftDisplacementImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TComplexImage::ImageDimension);
+
+  using ComplexImageType = TComplexImage;
+  using ComplexPixelType = typename ComplexImageType::PixelType;
+  using RealType = typename NumericTraits<ComplexPixelType>::ValueType;
+  using DisplacementImageType = TDisplacementImage;
+  using DisplacementType = typename DisplacementImageType::PixelType;
+  using CorrelationImageType = Image<RealType, ImageDimension>;
+  using RadiusType = typename ComplexImageType::SizeType;
+
+  /** The frame before the motion. */
+  void
+  SetFixedImage(const ComplexImageType * fixedImage)
+  {
+    this->SetNthInput(0, const_cast<ComplexImageType *>(fixedImage));
+  }
+  const ComplexImageType *
+  GetFixedImage() const
+  {
+    return this->GetInput(0);
+  }
+
+  /** The frame after the motion. */
+  void
+  SetMovingImage(const ComplexImageType * movingImage)
+  {
+    this->SetNthInput(1, const_cast<ComplexImageType *>(movingImage));
+  }
+  const ComplexImageType *
+  GetMovingImage() const
+  {
+    return this->GetInput(1);
+  }
+
+  /** Radius of the kernel the correlations are summed over.  By default it
+   * is 8 samples axially and 2 in the other directions. */
+  itkSetMacro(KernelRadius, RadiusType);
+  itkGetConstReferenceMacro(KernelRadius, RadiusType);
+
+  /** Frequency IQ data was demodulated at, in Hz, and its sampling
+   * frequency.  By default the DemodulationFrequency is 0, for analytic
+   * signals, and the SamplingFrequency is ignored. */
+  itkSetMacro(DemodulationFrequency, double);
+  itkGetConstMacro(DemodulationFrequency, double);
+  itkSetMacro(SamplingFrequency, double);
+  itkGetConstMacro(SamplingFrequency, double);
+
+  /** The magnitude of the normalized cross-correlation in the kernel, between
+   * 0 and 1. */
+  CorrelationImageType *
+  GetCorrelationOutput()
+  {
+    return static_cast<CorrelationImageType *>(this->ProcessObject::GetOutput(1));
+  }
+  const CorrelationImageType *
+  GetCorrelationOutput() const
+  {
+    return static_cast<const CorrelationImageType *>(this->ProcessObject::GetOutput(1));
+  }
+
+  using DataObjectPointerArraySizeType = ProcessObject::DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  DataObject::Pointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
+protected:
+  PhaseShiftDisplacementImageFilter();
+  ~PhaseShiftDisplacementImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+private:
+  /** Replace every value of the buffer by the sum of the values in the
+   * kernel around it, cropped by the buffer, with running sums along each
+   * direction. */
+  template <typename TValue>
+  void
+  SumOverKernel(std::vector<TValue> & buffer, const typename ComplexImageType::SizeType & size);
+
+  RadiusType m_KernelRadius;
+  double     m_DemodulationFrequency{ 0.0 };
+  double     m_SamplingFrequency{ 0.0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPhaseShiftDisplacementImageFilter.hxx"
+#endif
+
+#endif // itkPhaseShiftDisplacementImageFilter_h
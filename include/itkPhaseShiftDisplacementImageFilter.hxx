@@ -0,0 +1,246 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseShiftDisplacementImageFilter_hxx
+#define itkPhaseShiftDisplacementImageFilter_hxx
+
+#include "itkPhaseShiftDisplacementImageFilter.h"
+
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TComplexImage, typename TDisplacementImage>
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::PhaseShiftDisplacementImageFilter()
+{
+  m_KernelRadius.Fill(2);
+  m_KernelRadius[0] = 8;
+
+  this->SetNumberOfRequiredInputs(2);
+  this->SetNumberOfRequiredOutputs(2);
+  this->SetNthOutput(1, this->MakeOutput(1));
+}
+
+
+template <typename TComplexImage, typename TDisplacementImage>
+DataObject::Pointer
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::MakeOutput(DataObjectPointerArraySizeType idx)
+{
+  if (idx == 1)
+  {
+    return CorrelationImageType::New().GetPointer();
+  }
+  return Superclass::MakeOutput(idx);
+}
+
+
+template <typename TComplexImage, typename TDisplacementImage>
+void
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  for (unsigned int ii = 0; ii < 2; ++ii)
+  {
+    ComplexImageType * input = const_cast<ComplexImageType *>(this->GetInput(ii));
+    if (input)
+    {
+      input->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+}
+
+
+template <typename TComplexImage, typename TDisplacementImage>
+void
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TComplexImage, typename TDisplacementImage>
+template <typename TValue>
+void
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::SumOverKernel(
+  std::vector<TValue> &                        buffer,
+  const typename ComplexImageType::SizeType & size)
+{
+  using AccumulatorType = typename NumericTraits<TValue>::RealType;
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  const SizeValueType numberOfPixels = buffer.size();
+  SizeValueType       stride = 1;
+  for (unsigned int dimension = 0; dimension < ImageDimension; ++dimension)
+  {
+    const SizeValueType lineLength = size[dimension];
+    const SizeValueType radius = m_KernelRadius[dimension];
+    const SizeValueType numberOfLines = numberOfPixels / lineLength;
+    // Blocks of lines share a copy of the line being summed.
+    const SizeValueType linesPerBlock = 64;
+    if (radius > 0)
+    {
+      multiThreader->ParallelizeArray(
+        0,
+        (numberOfLines + linesPerBlock - 1) / linesPerBlock,
+        [&, stride](SizeValueType block) {
+          std::vector<TValue> values(lineLength);
+          const SizeValueType endLine = std::min((block + 1) * linesPerBlock, numberOfLines);
+          for (SizeValueType line = block * linesPerBlock; line < endLine; ++line)
+          {
+            TValue * lineStart = buffer.data() + (line / stride) * stride * lineLength + line % stride;
+            for (SizeValueType ii = 0; ii < lineLength; ++ii)
+            {
+              values[ii] = lineStart[ii * stride];
+            }
+            AccumulatorType sum = NumericTraits<AccumulatorType>::ZeroValue();
+            for (SizeValueType ii = 0; ii <= std::min(radius, lineLength - 1); ++ii)
+            {
+              sum += static_cast<AccumulatorType>(values[ii]);
+            }
+            for (SizeValueType ii = 0; ii < lineLength; ++ii)
+            {
+              lineStart[ii * stride] = static_cast<TValue>(sum);
+              if (ii + radius + 1 < lineLength)
+              {
+                sum += static_cast<AccumulatorType>(values[ii + radius + 1]);
+              }
+              if (ii >= radius)
+              {
+                sum -= static_cast<AccumulatorType>(values[ii - radius]);
+              }
+            }
+          }
+        },
+        nullptr);
+    }
+    stride *= lineLength;
+  }
+}
+
+
+template <typename TComplexImage, typename TDisplacementImage>
+void
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const ComplexImageType * fixed = this->GetFixedImage();
+  const ComplexImageType * moving = this->GetMovingImage();
+  if (moving->GetBufferedRegion() != fixed->GetBufferedRegion())
+  {
+    itkExceptionMacro("The fixed and moving images must have the same region.");
+  }
+  if (m_DemodulationFrequency != 0.0 && !(m_SamplingFrequency > 0.0))
+  {
+    itkExceptionMacro("The SamplingFrequency of the IQ data must be positive.");
+  }
+
+  using ComplexType = std::complex<RealType>;
+  const typename ComplexImageType::SizeType & size = fixed->GetBufferedRegion().GetSize();
+  const SizeValueType                         numberOfPixels = fixed->GetBufferedRegion().GetNumberOfPixels();
+  const SizeValueType                         lineLength = size[0];
+  const SizeValueType                         numberOfLines = numberOfPixels / lineLength;
+  const ComplexPixelType *                    fixedBuffer = fixed->GetBufferPointer();
+  const ComplexPixelType *                    movingBuffer = moving->GetBufferPointer();
+
+  // The products of every pixel: lag-zero cross-correlation between the
+  // frames, lag-one axial autocorrelation of both frames, and the energies.
+  std::vector<ComplexType> crossCorrelation(numberOfPixels);
+  std::vector<ComplexType> autocorrelation(numberOfPixels);
+  std::vector<RealType>    fixedEnergy(numberOfPixels);
+  std::vector<RealType>    movingEnergy(numberOfPixels);
+  MultiThreaderBase *      multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfLines,
+    [&](SizeValueType line) {
+      const SizeValueType      begin = line * lineLength;
+      const ComplexPixelType * fixedLine = fixedBuffer + begin;
+      const ComplexPixelType * movingLine = movingBuffer + begin;
+      for (SizeValueType ii = 0; ii < lineLength; ++ii)
+      {
+        crossCorrelation[begin + ii] = std::conj(fixedLine[ii]) * movingLine[ii];
+        fixedEnergy[begin + ii] = std::norm(fixedLine[ii]);
+        movingEnergy[begin + ii] = std::norm(movingLine[ii]);
+      }
+      for (SizeValueType ii = 0; ii + 1 < lineLength; ++ii)
+      {
+        autocorrelation[begin + ii] =
+          std::conj(fixedLine[ii]) * fixedLine[ii + 1] + std::conj(movingLine[ii]) * movingLine[ii + 1];
+      }
+      autocorrelation[begin + lineLength - 1] = ComplexType(0);
+    },
+    nullptr);
+
+  this->SumOverKernel(crossCorrelation, size);
+  this->SumOverKernel(autocorrelation, size);
+  this->SumOverKernel(fixedEnergy, size);
+  this->SumOverKernel(movingEnergy, size);
+
+  // The phase shift over the mean angular frequency, in radians per sample.
+  RealType demodulationFrequency = 0;
+  if (m_DemodulationFrequency != 0.0)
+  {
+    demodulationFrequency = static_cast<RealType>(2.0 * Math::pi * m_DemodulationFrequency / m_SamplingFrequency);
+  }
+  const RealType     axialSpacing = static_cast<RealType>(fixed->GetSpacing()[0]);
+  DisplacementType * displacements = this->GetOutput()->GetBufferPointer();
+  RealType *         correlations = this->GetCorrelationOutput()->GetBufferPointer();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfLines,
+    [&](SizeValueType line) {
+      const SizeValueType begin = line * lineLength;
+      DisplacementType    displacement;
+      displacement.Fill(0);
+      for (SizeValueType ii = begin; ii < begin + lineLength; ++ii)
+      {
+        const RealType frequency = std::arg(autocorrelation[ii]) + demodulationFrequency;
+        const RealType shift = std::arg(crossCorrelation[ii]);
+        displacement[0] = frequency > RealType(0) ? -shift / frequency * axialSpacing : RealType(0);
+        displacements[ii] = displacement;
+        const RealType energy = std::sqrt(fixedEnergy[ii] * movingEnergy[ii]);
+        correlations[ii] = energy > RealType(0) ? std::abs(crossCorrelation[ii]) / energy : RealType(0);
+      }
+    },
+    this);
+}
+
+
+template <typename TComplexImage, typename TDisplacementImage>
+void
+PhaseShiftDisplacementImageFilter<TComplexImage, TDisplacementImage>::PrintSelf(std::ostream & os,
+                                                                                 Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "KernelRadius: " << m_KernelRadius << std::endl;
+  os << indent << "DemodulationFrequency: " << m_DemodulationFrequency << std::endl;
+  os << indent << "SamplingFrequency: " << m_SamplingFrequency << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkPhaseShiftDisplacementImageFilter_hxx
@@ -0,0 +1,304 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPlaneWaveCompoundingImageFilter_h
+#define itkPlaneWaveCompoundingImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+
+/** \class PlaneWaveCompoundingImageFilter
+ * \brief Beamform the steered plane wave transmits of a curvilinear array,
+ * and compound them coherently into RF or IQ lines.
+ *
+ * The input holds the channel data of the transmits, as for the
+ * DelayAndSumBeamformingImageFilter: the samples along the first direction,
+ * the elements along the second, and the transmit events along the third.
+ * Transmit event a of a frame is a plane wave steered by SteeringAngles[a],
+ * and the frames follow each other, so that the third direction has
+ * SteeringAngles.size() events per frame.  The output is a
+ * CurvilinearArraySpecialCoordinatesImage with the samples along the first
+ * direction, NumberOfLines lines along the second and, when it is 3D, the
+ * frames along the third, so that a batch of frames is compounded in one
+ * update.  A 2D output takes a single frame.
+ *
+ * The elements lie on an arc of ProbeRadius around the origin, as for the
+ * DelayAndSumBeamformingImageFilter.  The wavefront of the plane wave steered
+ * by alpha, whose normal makes the angle alpha with the second axis, crosses
+ * the center of the face of the probe at time 0, and reaches the point p
+ * after ((p - f) . n) / c, where f is the center of the face, n the normal
+ * and c the SpeedOfSound.  The echo then comes back to the element as for
+ * the DelayAndSumBeamformingImageFilter, and the receive aperture and
+ * apodization are the same.
+ *
+ * The delayed channel samples of every steering angle and every element are
+ * summed into the output sample in a single pass, without an image per
+ * angle.  The receive delays and apodization are computed once per line and
+ * element, and the transmit delays once per angle, line and sample, for the
+ * geometry of the probe, the acquisition and the output; they are kept until
+ * one of them changes.  Each update is then multithreaded over the lines of
+ * the frames, with a loop without branches over the contiguous samples of a
+ * line for every angle and element.
+ *
+ * Complex channel data is IQ data, demodulated at the DemodulationFrequency
+ * from the time of the transmit.  The delayed IQ samples are rotated back to
+ * the phase of the RF signal, and the compounded sample to the baseband of
+ * the output, at the time the sound takes there and back to its depth.  The
+ * output then goes to the BModeImageFilter as IQ data.
+ *
+ * \sa OpenCLPlaneWaveCompoundingImageFilter
+ * \sa DelayAndSumBeamformingImageFilter
+ * \sa BModeImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT PlaneWaveCompoundingImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PlaneWaveCompoundingImageFilter);
+
+  /** Standard class type alias. */
+  using Self = PlaneWaveCompoundingImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PlaneWaveCompoundingImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  static_assert(InputImageDimension == 3 && (ImageDimension == 2 || ImageDimension == 3),
+                "PlaneWaveCompoundingImageFilter compounds 3D channel data into 2D frames or 3D batches of frames");
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Type of the delays and apodization weights held by the tables. */
+  using TableValueType = float;
+
+  using SteeringAnglesType = std::vector<double>;
+
+  /** Steering angles of the plane waves of a frame, in radians, in the order
+   * of the transmit events.  By default there is a single unsteered plane
+   * wave. */
+  itkSetMacro(SteeringAngles, SteeringAnglesType);
+  itkGetConstReferenceMacro(SteeringAngles, SteeringAnglesType);
+
+  /** Speed of sound, in the physical units of the output per second.  The
+   * default, 1.54e6, is the speed in soft tissue in millimeters. */
+  itkSetMacro(SpeedOfSound, double);
+  itkGetConstMacro(SpeedOfSound, double);
+
+  /** Sampling frequency of the channel data, in Hz. */
+  itkSetMacro(SamplingFrequency, double);
+  itkGetConstMacro(SamplingFrequency, double);
+
+  /** Time of the first channel sample after the transmit, in seconds.  By
+   * default it is 0. */
+  itkSetMacro(StartTime, double);
+  itkGetConstMacro(StartTime, double);
+
+  /** Frequency the IQ channel data was demodulated at, in Hz.  It is ignored
+   * for RF channel data. */
+  itkSetMacro(DemodulationFrequency, double);
+  itkGetConstMacro(DemodulationFrequency, double);
+
+  /** Radius of curvature of the array, in the physical units of the output. */
+  itkSetMacro(ProbeRadius, double);
+  itkGetConstMacro(ProbeRadius, double);
+
+  /** Angle between the centers of neighboring elements, in radians. */
+  itkSetMacro(ElementAngularSeparation, double);
+  itkGetConstMacro(ElementAngularSeparation, double);
+
+  /** Ratio of the depth to the width of the receive aperture.  By default it
+   * is 1.5; 0 sums all the elements. */
+  itkSetClampMacro(FNumber, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(FNumber, double);
+
+  /** Number of samples of the output lines.  By default it is 0, for the
+   * number of channel samples. */
+  itkSetMacro(NumberOfOutputSamples, SizeValueType);
+  itkGetConstMacro(NumberOfOutputSamples, SizeValueType);
+
+  /** Number of output lines.  By default it is 0, for one line per
+   * element. */
+  itkSetMacro(NumberOfLines, SizeValueType);
+  itkGetConstMacro(NumberOfLines, SizeValueType);
+
+  /** Distance between the output samples along the lines.  By default it is
+   * 0, for SpeedOfSound / (2 SamplingFrequency). */
+  itkSetMacro(RadiusSampleSize, double);
+  itkGetConstMacro(RadiusSampleSize, double);
+
+  /** Radius of the first output sample.  By default it is 0, for the
+   * ProbeRadius, i.e. the face of the probe. */
+  itkSetMacro(FirstSampleDistance, double);
+  itkGetConstMacro(FirstSampleDistance, double);
+
+  /** Angle between the output lines, in radians.  By default it is 0, for the
+   * ElementAngularSeparation. */
+  itkSetMacro(LateralAngularSeparation, double);
+  itkGetConstMacro(LateralAngularSeparation, double);
+
+  /** Number of times the tables were built, i.e. the number of updates where
+   * the geometry had changed. */
+  itkGetConstMacro(NumberOfTableBuilds, SizeValueType);
+
+protected:
+  PlaneWaveCompoundingImageFilter();
+  ~PlaneWaveCompoundingImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  /** The tables, for subclasses that compound on other devices.  They are up
+   * to date after BeforeThreadedGenerateData().  For the element e of the
+   * line l, at entry l * NumberOfElements + e of the first two, the samples
+   * of the line from GetTableFirstSamples() on are in the aperture, and their
+   * receive delays, in channel samples, and weights start at
+   * GetTableOffsets() in the next two.  The transmit delays of the angle a,
+   * less the StartTime, in channel samples, start at (a * NumberOfLines + l)
+   * * NumberOfOutputSamples in GetTableTransmitDelays().  The delayed sample
+   * is the sum of the two delays. */
+  const std::vector<SizeValueType> &
+  GetTableFirstSamples() const
+  {
+    return m_FirstSamples;
+  }
+  const std::vector<SizeValueType> &
+  GetTableOffsets() const
+  {
+    return m_TableOffsets;
+  }
+  const std::vector<TableValueType> &
+  GetTableReceiveDelays() const
+  {
+    return m_ReceiveDelays;
+  }
+  const std::vector<TableValueType> &
+  GetTableWeights() const
+  {
+    return m_Weights;
+  }
+  const std::vector<TableValueType> &
+  GetTableTransmitDelays() const
+  {
+    return m_TransmitDelays;
+  }
+  /** For IQ data, the delay of every output sample, in channel samples, whose
+   * phase is the one of the baseband of the output. */
+  const std::vector<TableValueType> &
+  GetTableReferenceDelays() const
+  {
+    return m_ReferenceDelays;
+  }
+
+  /** The number of lines, radius sample size, first sample distance and
+   * lateral angular separation of the output, with the defaults resolved. */
+  SizeValueType
+  GetOutputNumberOfLines() const;
+  double
+  GetOutputRadiusSampleSize() const;
+  double
+  GetOutputFirstSampleDistance() const;
+  double
+  GetOutputLateralAngularSeparation() const;
+
+private:
+  using GeometryKeyType = std::vector<double>;
+
+  /** Everything the tables depend on. */
+  GeometryKeyType
+  ComputeGeometryKey() const;
+
+  void
+  BuildTables();
+
+  /** Rotate a delayed IQ sample by the phase, in radians; RF samples are
+   * left as they are. */
+  template <typename TValue>
+  static TValue
+  RotatePhase(const TValue & value, double)
+  {
+    return value;
+  }
+  template <typename TValue>
+  static std::complex<TValue>
+  RotatePhase(const std::complex<TValue> & value, double phase)
+  {
+    return value * std::complex<TValue>(std::cos(phase), std::sin(phase));
+  }
+
+  SteeringAnglesType m_SteeringAngles;
+  double             m_SpeedOfSound{ 1.54e6 };
+  double             m_SamplingFrequency{ 0.0 };
+  double             m_StartTime{ 0.0 };
+  double             m_DemodulationFrequency{ 0.0 };
+  double             m_ProbeRadius{ 0.0 };
+  double             m_ElementAngularSeparation{ 0.0 };
+  double             m_FNumber{ 1.5 };
+  SizeValueType      m_NumberOfOutputSamples{ 0 };
+  SizeValueType      m_NumberOfLines{ 0 };
+  double             m_RadiusSampleSize{ 0.0 };
+  double             m_FirstSampleDistance{ 0.0 };
+  double             m_LateralAngularSeparation{ 0.0 };
+
+  std::vector<SizeValueType>  m_FirstSamples;
+  std::vector<SizeValueType>  m_TableOffsets;
+  std::vector<TableValueType> m_ReceiveDelays;
+  std::vector<TableValueType> m_Weights;
+  std::vector<TableValueType> m_TransmitDelays;
+  std::vector<TableValueType> m_ReferenceDelays;
+
+  GeometryKeyType m_TableKey;
+  SizeValueType   m_NumberOfTableBuilds{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPlaneWaveCompoundingImageFilter.hxx"
+#endif
+
+#endif // itkPlaneWaveCompoundingImageFilter_h
@@ -0,0 +1,246 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkQuadratureDemodulationImageFilter_hxx
+#define itkQuadratureDemodulationImageFilter_hxx
+
+#include "itkQuadratureDemodulationImageFilter.h"
+
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  if (!input || !output)
+  {
+    return;
+  }
+  if (!(m_SamplingFrequency > 0.0))
+  {
+    itkExceptionMacro("The SamplingFrequency must be positive.");
+  }
+
+  // One output sample per DecimationFactor input samples, from the first
+  // input sample.
+  const unsigned int                          direction = m_Direction;
+  const typename InputImageType::RegionType & inputRegion = input->GetLargestPossibleRegion();
+  OutputImageRegionType                       outputRegion = output->GetLargestPossibleRegion();
+  outputRegion.SetIndex(direction, 0);
+  outputRegion.SetSize(direction, this->GetDecimatedSize(inputRegion.GetSize(direction)));
+  output->SetLargestPossibleRegion(outputRegion);
+
+  typename OutputImageType::SpacingType spacing = input->GetSpacing();
+  spacing[direction] *= m_DecimationFactor;
+  output->SetSpacing(spacing);
+  if (inputRegion.GetIndex(direction) != 0)
+  {
+    typename InputImageType::IndexType firstIndex;
+    firstIndex.Fill(0);
+    firstIndex[direction] = inputRegion.GetIndex(direction);
+    typename OutputImageType::PointType origin;
+    input->TransformIndexToPhysicalPoint(firstIndex, origin);
+    output->SetOrigin(origin);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (!input)
+  {
+    return;
+  }
+
+  // The whole lines, for the lines of the requested region.
+  const unsigned int                  direction = m_Direction;
+  typename InputImageType::RegionType inputRequestedRegion = this->GetOutput()->GetRequestedRegion();
+  inputRequestedRegion.SetIndex(direction, input->GetLargestPossibleRegion().GetIndex(direction));
+  inputRequestedRegion.SetSize(direction, input->GetLargestPossibleRegion().GetSize(direction));
+  input->SetRequestedRegion(inputRequestedRegion);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  OutputImageType *     outputPtr = dynamic_cast<OutputImageType *>(output);
+  OutputImageRegionType enlargedRegion = outputPtr->GetRequestedRegion();
+  enlargedRegion.SetIndex(m_Direction, outputPtr->GetLargestPossibleRegion().GetIndex(m_Direction));
+  enlargedRegion.SetSize(m_Direction, outputPtr->GetLargestPossibleRegion().GetSize(m_Direction));
+  outputPtr->SetRequestedRegion(enlargedRegion);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // An odd number of taps, centered on the output sample.
+  const SizeValueType halfLength = (m_DecimationFactor * m_NumberOfTapsPerPhase + 1) / 2;
+  const SizeValueType numberOfTaps = 2 * halfLength + 1;
+  const double        center = static_cast<double>(halfLength);
+  const double        bandwidth = m_Bandwidth > 0.0 ? m_Bandwidth : m_SamplingFrequency / m_DecimationFactor;
+  const double        cutoff = std::min(bandwidth / (2.0 * m_SamplingFrequency), 0.5);
+  const double        angularFrequency = 2.0 * Math::pi * m_DemodulationFrequency / m_SamplingFrequency;
+
+  // Hamming windowed sinc with a unit gain at 0, doubled so that the modulus
+  // of the IQ data is the envelope of the RF signal.
+  std::vector<double> lowPass(numberOfTaps);
+  double              sum = 0.0;
+  for (SizeValueType ii = 0; ii < numberOfTaps; ++ii)
+  {
+    const double offset = ii - center;
+    const double sinc = offset == 0.0 ? 2.0 * cutoff : std::sin(2.0 * Math::pi * cutoff * offset) / (Math::pi * offset);
+    const double window = 0.54 + 0.46 * std::cos(Math::pi * offset / (center + 1.0));
+    lowPass[ii] = sinc * window;
+    sum += lowPass[ii];
+  }
+  m_InPhaseTaps.resize(numberOfTaps);
+  m_QuadratureTaps.resize(numberOfTaps);
+  for (SizeValueType ii = 0; ii < numberOfTaps; ++ii)
+  {
+    const double tap = 2.0 * lowPass[ii] / sum;
+    m_InPhaseTaps[ii] = static_cast<TapType>(tap * std::cos(angularFrequency * (center - ii)));
+    m_QuadratureTaps[ii] = static_cast<TapType>(tap * std::sin(angularFrequency * (center - ii)));
+  }
+
+  const SizeValueType numberOfOutputSamples = this->GetOutput()->GetLargestPossibleRegion().GetSize(m_Direction);
+  m_OutputCosines.resize(numberOfOutputSamples);
+  m_OutputSines.resize(numberOfOutputSamples);
+  for (SizeValueType ii = 0; ii < numberOfOutputSamples; ++ii)
+  {
+    const double phase = angularFrequency * static_cast<double>(ii * m_DecimationFactor);
+    m_OutputCosines[ii] = static_cast<TapType>(std::cos(phase));
+    m_OutputSines[ii] = static_cast<TapType>(std::sin(phase));
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
+    m_Direction,
+    this->GetOutput()->GetRequestedRegion(),
+    [this](const OutputImageRegionType & lambdaRegion) { this->DemodulateRegion(lambdaRegion); },
+    this);
+
+  this->AfterThreadedGenerateData();
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::DemodulateRegion(
+  const OutputImageRegionType & outputRegion)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  const unsigned int     direction = m_Direction;
+
+  typename InputImageType::RegionType inputRegion = outputRegion;
+  inputRegion.SetIndex(direction, input->GetLargestPossibleRegion().GetIndex(direction));
+  inputRegion.SetSize(direction, input->GetLargestPossibleRegion().GetSize(direction));
+
+  using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
+  using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
+  InputIteratorType  inputIt(input, inputRegion);
+  OutputIteratorType outputIt(output, outputRegion);
+  inputIt.SetDirection(direction);
+  outputIt.SetDirection(direction);
+
+  // The line, zero padded by half of the filter at both ends.
+  const SizeValueType  numberOfTaps = m_InPhaseTaps.size();
+  const SizeValueType  decimationFactor = m_DecimationFactor;
+  const TapType *      inPhaseTaps = m_InPhaseTaps.data();
+  const TapType *      quadratureTaps = m_QuadratureTaps.data();
+  std::vector<TapType> line(inputRegion.GetSize(direction) + numberOfTaps - 1);
+  TapType *            lineStart = line.data() + (numberOfTaps - 1) / 2;
+
+  for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); inputIt.NextLine(), outputIt.NextLine())
+  {
+    inputIt.GoToBeginOfLine();
+    for (TapType * sample = lineStart; !inputIt.IsAtEndOfLine(); ++inputIt, ++sample)
+    {
+      *sample = static_cast<TapType>(inputIt.Get());
+    }
+
+    outputIt.GoToBeginOfLine();
+    for (SizeValueType ii = outputRegion.GetIndex(direction); !outputIt.IsAtEndOfLine(); ++outputIt, ++ii)
+    {
+      // Only the kept samples are filtered, with the taps of the mixing.
+      const TapType * samples = line.data() + ii * decimationFactor;
+      TapType         inPhase = 0;
+      TapType         quadrature = 0;
+      for (SizeValueType tap = 0; tap < numberOfTaps; ++tap)
+      {
+        inPhase += samples[tap] * inPhaseTaps[tap];
+        quadrature += samples[tap] * quadratureTaps[tap];
+      }
+      // Back to the baseband.
+      const TapType cosine = m_OutputCosines[ii];
+      const TapType sine = m_OutputSines[ii];
+      outputIt.Set(OutputPixelType(cosine * inPhase + sine * quadrature, cosine * quadrature - sine * inPhase));
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+QuadratureDemodulationImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Direction: " << m_Direction << std::endl;
+  os << indent << "SamplingFrequency: " << m_SamplingFrequency << std::endl;
+  os << indent << "DemodulationFrequency: " << m_DemodulationFrequency << std::endl;
+  os << indent << "DecimationFactor: " << m_DecimationFactor << std::endl;
+  os << indent << "Bandwidth: " << m_Bandwidth << std::endl;
+  os << indent << "NumberOfTapsPerPhase: " << m_NumberOfTapsPerPhase << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkQuadratureDemodulationImageFilter_hxx
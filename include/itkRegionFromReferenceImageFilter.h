@@ -33,6 +33,15 @@ namespace itk
  *
  * This filter uses ExtractImageFilter to perform the cropping.
  *
+ * When InPlace is on, the filter runs as a view when it can: if the target
+ * region is contiguous in the input buffer, i.e. it spans the input buffered
+ * region along all the directions but the slowest one it crops, the output
+ * aliases the input buffer at the offset of the region instead of copying
+ * it.  This is always the case when the upstream filter only generated the
+ * requested region.  The filter holds on to the input buffer until its next
+ * update, and the output changes if the upstream filter writes into that
+ * buffer again.  InPlace is off by default, as for ExtractImageFilter.
+ *
  * \ingroup GeometricTransforms
  * \ingroup Ultrasound
  */
@@ -113,10 +122,16 @@ protected:
   virtual void
   GenerateOutputInformation() override;
 
+  void
+  GenerateData() override;
+
 private:
   RegionFromReferenceImageFilter(const Self &); // purposely not implemented
   void
   operator=(const Self &); // purposely not implemented
+
+  /** The input buffer aliased by the output. */
+  typename TInputImage::PixelContainerConstPointer m_ViewedPixelContainer;
 };
 
 } // end namespace itk
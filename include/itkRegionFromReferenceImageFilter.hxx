@@ -44,6 +44,56 @@ RegionFromReferenceImageFilter<TInputImage, TOutputImage>::GenerateOutputInforma
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+RegionFromReferenceImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  m_ViewedPixelContainer = nullptr;
+
+  const TInputImage * inputPtr = this->GetInput();
+  TOutputImage *      outputPtr = this->GetOutput();
+  if (!this->GetInPlace() || !this->CanRunInPlace())
+  {
+    Superclass::GenerateData();
+    return;
+  }
+
+  // The region is contiguous in the input buffer if, from the fastest
+  // direction, it matches the buffered region up to one direction, and it
+  // has a single index along all the slower directions.
+  const OutputImageRegionType & outputRegion = outputPtr->GetRequestedRegion();
+  const InputImageRegionType &  bufferedRegion = inputPtr->GetBufferedRegion();
+  unsigned int                  dim = 0;
+  while (dim < ImageDimension && outputRegion.GetIndex(dim) == bufferedRegion.GetIndex(dim) &&
+         outputRegion.GetSize(dim) == bufferedRegion.GetSize(dim))
+  {
+    ++dim;
+  }
+  bool contiguous = bufferedRegion.IsInside(outputRegion);
+  for (++dim; dim < ImageDimension; ++dim)
+  {
+    contiguous = contiguous && outputRegion.GetSize(dim) == 1;
+  }
+  if (!contiguous || outputRegion == bufferedRegion)
+  {
+    // The superclass grafts the input when the regions are the same.
+    Superclass::GenerateData();
+    return;
+  }
+
+  // CanRunInPlace() checked that the pixel types are the same.
+  using PixelContainerType = typename TOutputImage::PixelContainer;
+  auto * viewBuffer = reinterpret_cast<OutputImagePixelType *>(
+    const_cast<InputImagePixelType *>(inputPtr->GetBufferPointer() + inputPtr->ComputeOffset(outputRegion.GetIndex())));
+  typename PixelContainerType::Pointer viewContainer = PixelContainerType::New();
+  viewContainer->SetImportPointer(viewBuffer, outputRegion.GetNumberOfPixels(), false);
+  outputPtr->SetBufferedRegion(outputRegion);
+  outputPtr->SetPixelContainer(viewContainer);
+  m_ViewedPixelContainer = inputPtr->GetPixelContainer();
+  this->UpdateProgress(1.0);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 RegionFromReferenceImageFilter<TInputImage, TOutputImage>::SetReferenceImage(const ReferenceImageType * image)
@@ -20,6 +20,9 @@
 
 #include "itkUnaryFunctorImageFilter.h"
 #include "itkMath.h"
+#include "itkSimpleDataObjectDecorator.h"
+
+#include <mutex>
 
 namespace itk
 {
@@ -89,6 +92,16 @@ private:
  *
  * -inf, inf, and NaN values are replaced by the ReplacementValue.
  *
+ * The filter runs in place by default when the input and output image types
+ * are the same, see InPlaceImageFilter.  Each line of the buffers is
+ * classified and blended in a loop without branches, so that it vectorizes.
+ *
+ * When ReportReplacedPixels is on, the number of replaced pixels and the
+ * bounding box of their indices are available after the update from the
+ * decorated outputs GetNumberOfReplacedPixelsOutput() and
+ * GetReplacedPixelsRegionOutput(), or from GetNumberOfReplacedPixels() and
+ * GetReplacedPixelsRegion().  The region is empty if no pixel was replaced.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage, typename TOutputImage = TInputImage>
@@ -117,11 +130,76 @@ public:
   /** Runtime information support. */
   itkTypeMacro(ReplaceNonFiniteImageFilter, UnaryFunctorImageFilter);
 
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using RegionType = typename OutputImageType::RegionType;
+  using IndexType = typename RegionType::IndexType;
+
+  using SizeObjectType = SimpleDataObjectDecorator<SizeValueType>;
+  using RegionObjectType = SimpleDataObjectDecorator<RegionType>;
+
+  /** When on, the number of replaced pixels and their bounding box are
+   * computed.  Off by default. */
+  itkSetMacro(ReportReplacedPixels, bool);
+  itkGetConstMacro(ReportReplacedPixels, bool);
+  itkBooleanMacro(ReportReplacedPixels);
+
+  /** Number of pixels replaced during the last update. */
+  SizeValueType
+  GetNumberOfReplacedPixels() const
+  {
+    return this->GetNumberOfReplacedPixelsOutput()->Get();
+  }
+  SizeObjectType *
+  GetNumberOfReplacedPixelsOutput();
+  const SizeObjectType *
+  GetNumberOfReplacedPixelsOutput() const;
+
+  /** Bounding box of the pixels replaced during the last update. */
+  RegionType
+  GetReplacedPixelsRegion() const
+  {
+    return this->GetReplacedPixelsRegionOutput()->Get();
+  }
+  RegionObjectType *
+  GetReplacedPixelsRegionOutput();
+  const RegionObjectType *
+  GetReplacedPixelsRegionOutput() const;
+
+  using DataObjectPointerArraySizeType = ProcessObject::DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  DataObject::Pointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
 protected:
-  ReplaceNonFiniteImageFilter() {}
+  ReplaceNonFiniteImageFilter();
   virtual ~ReplaceNonFiniteImageFilter() {}
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  BeforeThreadedGenerateData() override;
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+  void
+  AfterThreadedGenerateData() override;
+
+private:
+  bool m_ReportReplacedPixels{ false };
+
+  /** Merged by the work units during the update. */
+  SizeValueType m_NumberOfReplacedPixels{ 0 };
+  IndexType     m_ReplacedMinimumIndex;
+  IndexType     m_ReplacedMaximumIndex;
+  std::mutex    m_Mutex;
 };
 
 } // end namespace itk
 
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkReplaceNonFiniteImageFilter.hxx"
+#endif
+
 #endif // itkReplaceNonFiniteImageFilter_h
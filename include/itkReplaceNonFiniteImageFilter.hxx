@@ -0,0 +1,225 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkReplaceNonFiniteImageFilter_hxx
+#define itkReplaceNonFiniteImageFilter_hxx
+
+#include "itkReplaceNonFiniteImageFilter.h"
+
+#include <algorithm>
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::ReplaceNonFiniteImageFilter()
+{
+  this->InPlaceOn();
+
+  this->SetNumberOfRequiredOutputs(3);
+  this->SetNthOutput(1, this->MakeOutput(1));
+  this->SetNthOutput(2, this->MakeOutput(2));
+  this->GetNumberOfReplacedPixelsOutput()->Set(0);
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+DataObject::Pointer
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::MakeOutput(DataObjectPointerArraySizeType idx)
+{
+  switch (idx)
+  {
+    case 1:
+      return SizeObjectType::New().GetPointer();
+    case 2:
+      return RegionObjectType::New().GetPointer();
+    default:
+      return Superclass::MakeOutput(idx);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::GetNumberOfReplacedPixelsOutput() -> SizeObjectType *
+{
+  return static_cast<SizeObjectType *>(this->ProcessObject::GetOutput(1));
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::GetNumberOfReplacedPixelsOutput() const
+  -> const SizeObjectType *
+{
+  return static_cast<const SizeObjectType *>(this->ProcessObject::GetOutput(1));
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::GetReplacedPixelsRegionOutput() -> RegionObjectType *
+{
+  return static_cast<RegionObjectType *>(this->ProcessObject::GetOutput(2));
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+auto
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::GetReplacedPixelsRegionOutput() const
+  -> const RegionObjectType *
+{
+  return static_cast<const RegionObjectType *>(this->ProcessObject::GetOutput(2));
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ReplacementValue: "
+     << static_cast<typename NumericTraits<typename OutputImageType::PixelType>::PrintType>(
+          this->GetFunctor().GetReplacementValue())
+     << std::endl;
+  os << indent << "ReportReplacedPixels: " << (m_ReportReplacedPixels ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfReplacedPixels: " << this->GetNumberOfReplacedPixels() << std::endl;
+  os << indent << "ReplacedPixelsRegion: " << this->GetReplacedPixelsRegion() << std::endl;
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  m_NumberOfReplacedPixels = 0;
+  m_ReplacedMinimumIndex.Fill(NumericTraits<IndexValueType>::max());
+  m_ReplacedMaximumIndex.Fill(NumericTraits<IndexValueType>::NonpositiveMin());
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType *      outputImage = this->GetOutput();
+
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  const InputPixelType * inputBuffer = inputImage->GetBufferPointer();
+  OutputPixelType *      outputBuffer = outputImage->GetBufferPointer();
+  const OutputPixelType  replacementValue = this->GetFunctor().GetReplacementValue();
+  const SizeValueType    lineSize = outputRegionForThread.GetSize()[0];
+
+  SizeValueType numberOfReplacedPixels = 0;
+  IndexType     minimumIndex;
+  IndexType     maximumIndex;
+  minimumIndex.Fill(NumericTraits<IndexValueType>::max());
+  maximumIndex.Fill(NumericTraits<IndexValueType>::NonpositiveMin());
+
+  // for every line along the first direction, addressed directly in the
+  // buffers.  A value is finite if it minus itself is zero: the difference
+  // is NaN for NaN and the infinities.  The classification and the blend have
+  // no branches, so that the loops vectorize, and they are the same in place.
+  OutputImageRegionType lineStartRegion = outputRegionForThread;
+  lineStartRegion.SetSize(0, 1);
+  ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(outputImage, lineStartRegion);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+  {
+    const IndexType &      lineIndex = lineIt.GetIndex();
+    const InputPixelType * inputLine = inputBuffer + inputImage->ComputeOffset(lineIndex);
+    OutputPixelType *      outputLine = outputBuffer + outputImage->ComputeOffset(lineIndex);
+    if (!m_ReportReplacedPixels)
+    {
+      for (SizeValueType ii = 0; ii < lineSize; ++ii)
+      {
+        const InputPixelType value = inputLine[ii];
+        const bool           finite = (value - value) == 0;
+        outputLine[ii] = finite ? static_cast<OutputPixelType>(value) : replacementValue;
+      }
+      continue;
+    }
+
+    SizeValueType lineReplaced = 0;
+    SizeValueType firstReplaced = lineSize;
+    SizeValueType lastReplaced = 0;
+    for (SizeValueType ii = 0; ii < lineSize; ++ii)
+    {
+      const InputPixelType value = inputLine[ii];
+      const bool           finite = (value - value) == 0;
+      outputLine[ii] = finite ? static_cast<OutputPixelType>(value) : replacementValue;
+      lineReplaced += !finite;
+      firstReplaced = finite ? firstReplaced : std::min(firstReplaced, ii);
+      lastReplaced = finite ? lastReplaced : ii;
+    }
+    if (lineReplaced > 0)
+    {
+      numberOfReplacedPixels += lineReplaced;
+      minimumIndex[0] = std::min(minimumIndex[0], lineIndex[0] + static_cast<IndexValueType>(firstReplaced));
+      maximumIndex[0] = std::max(maximumIndex[0], lineIndex[0] + static_cast<IndexValueType>(lastReplaced));
+      for (unsigned int dim = 1; dim < OutputImageType::ImageDimension; ++dim)
+      {
+        minimumIndex[dim] = std::min(minimumIndex[dim], lineIndex[dim]);
+        maximumIndex[dim] = std::max(maximumIndex[dim], lineIndex[dim]);
+      }
+    }
+  }
+
+  if (numberOfReplacedPixels > 0)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_NumberOfReplacedPixels += numberOfReplacedPixels;
+    for (unsigned int dim = 0; dim < OutputImageType::ImageDimension; ++dim)
+    {
+      m_ReplacedMinimumIndex[dim] = std::min(m_ReplacedMinimumIndex[dim], minimumIndex[dim]);
+      m_ReplacedMaximumIndex[dim] = std::max(m_ReplacedMaximumIndex[dim], maximumIndex[dim]);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+ReplaceNonFiniteImageFilter<TInputImage, TOutputImage>::AfterThreadedGenerateData()
+{
+  Superclass::AfterThreadedGenerateData();
+
+  RegionType replacedRegion;
+  if (m_NumberOfReplacedPixels > 0)
+  {
+    typename RegionType::SizeType replacedSize;
+    for (unsigned int dim = 0; dim < OutputImageType::ImageDimension; ++dim)
+    {
+      replacedSize[dim] = static_cast<SizeValueType>(m_ReplacedMaximumIndex[dim] - m_ReplacedMinimumIndex[dim] + 1);
+    }
+    replacedRegion.SetIndex(m_ReplacedMinimumIndex);
+    replacedRegion.SetSize(replacedSize);
+  }
+  this->GetNumberOfReplacedPixelsOutput()->Set(m_NumberOfReplacedPixels);
+  this->GetReplacedPixelsRegionOutput()->Set(replacedRegion);
+}
+
+} // end namespace itk
+
+#endif // itkReplaceNonFiniteImageFilter_hxx
@@ -0,0 +1,113 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRingBufferedVideoFilter_h
+#define itkRingBufferedVideoFilter_h
+
+#include "itkVideoToVideoFilter.h"
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+
+/** \class RingBufferedVideoFilter
+ * \brief Run an image filter, such as BModeImageFilter,
+ * TimeGainCompensationImageFilter or BlockMatching::DisplacementPipeline, on
+ * every frame of a VideoStream.
+ *
+ * Each output frame is computed from NumberOfFilterInputs consecutive input
+ * frames, which are the inputs 0, 1, ... of the FrameFilter: one for a
+ * B-mode filter, two, fixed then moving, for a displacement pipeline.
+ *
+ * The output frame is grafted onto the output of the FrameFilter before it
+ * is updated, so that the filter writes directly into the buffer of the
+ * frame.  The output VideoStream holds at least NumberOfBufferedFrames
+ * frames, whose images, and their buffers, are reused when its ring buffer
+ * wraps: once every slot has been filled, no more memory is allocated for
+ * the frames.  A frame is therefore only valid until NumberOfBufferedFrames
+ * more frames have been requested.
+ *
+ * A FrameFilter that can run in place is set to not run in place, so that
+ * the input frames are left unchanged for the next output frame.
+ *
+ * \sa ThreadedFramePipeline
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TInputVideoStream, typename TOutputVideoStream>
+class ITK_TEMPLATE_EXPORT RingBufferedVideoFilter : public VideoToVideoFilter<TInputVideoStream, TOutputVideoStream>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(RingBufferedVideoFilter);
+
+  /** Standard class type alias. */
+  using Self = RingBufferedVideoFilter;
+  using Superclass = VideoToVideoFilter<TInputVideoStream, TOutputVideoStream>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkTypeMacro(RingBufferedVideoFilter, VideoToVideoFilter);
+  itkNewMacro(Self);
+
+  using InputVideoStreamType = TInputVideoStream;
+  using OutputVideoStreamType = TOutputVideoStream;
+  using InputFrameType = typename InputVideoStreamType::FrameType;
+  using OutputFrameType = typename OutputVideoStreamType::FrameType;
+  using FrameFilterType = ImageToImageFilter<InputFrameType, OutputFrameType>;
+
+  /** The filter run on every frame. */
+  itkSetObjectMacro(FrameFilter, FrameFilterType);
+  itkGetModifiableObjectMacro(FrameFilter, FrameFilterType);
+
+  /** Number of consecutive input frames per output frame.  Defaults to 1. */
+  void
+  SetNumberOfFilterInputs(SizeValueType numberOfFilterInputs);
+  SizeValueType
+  GetNumberOfFilterInputs() const
+  {
+    return this->m_UnitInputNumberOfFrames;
+  }
+
+  /** Minimum number of frames held by the output VideoStream.  Defaults to
+   * 3. */
+  itkSetClampMacro(NumberOfBufferedFrames, SizeValueType, 1, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(NumberOfBufferedFrames, SizeValueType);
+
+protected:
+  RingBufferedVideoFilter();
+  ~RingBufferedVideoFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Compute the frame at the start of the requested temporal region. */
+  void
+  TemporalStreamingGenerateData() override;
+
+private:
+  typename FrameFilterType::Pointer m_FrameFilter;
+  SizeValueType                     m_NumberOfBufferedFrames{ 3 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkRingBufferedVideoFilter.hxx"
+#endif
+
+#endif // itkRingBufferedVideoFilter_h
@@ -0,0 +1,103 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRingBufferedVideoFilter_hxx
+#define itkRingBufferedVideoFilter_hxx
+
+#include "itkRingBufferedVideoFilter.h"
+
+#include "itkInPlaceImageFilter.h"
+
+namespace itk
+{
+
+template <typename TInputVideoStream, typename TOutputVideoStream>
+RingBufferedVideoFilter<TInputVideoStream, TOutputVideoStream>::RingBufferedVideoFilter()
+{
+  this->m_UnitInputNumberOfFrames = 1;
+  this->m_UnitOutputNumberOfFrames = 1;
+  this->m_FrameSkipPerOutput = 1;
+}
+
+
+template <typename TInputVideoStream, typename TOutputVideoStream>
+void
+RingBufferedVideoFilter<TInputVideoStream, TOutputVideoStream>::SetNumberOfFilterInputs(
+  SizeValueType numberOfFilterInputs)
+{
+  if (numberOfFilterInputs < 1)
+  {
+    itkExceptionMacro(<< "The number of filter inputs must be at least 1.");
+  }
+  if (this->m_UnitInputNumberOfFrames != numberOfFilterInputs)
+  {
+    this->m_UnitInputNumberOfFrames = numberOfFilterInputs;
+    this->Modified();
+  }
+}
+
+
+template <typename TInputVideoStream, typename TOutputVideoStream>
+void
+RingBufferedVideoFilter<TInputVideoStream, TOutputVideoStream>::TemporalStreamingGenerateData()
+{
+  if (m_FrameFilter.IsNull())
+  {
+    itkExceptionMacro(<< "The FrameFilter is not set.");
+  }
+  using InPlaceFilterType = InPlaceImageFilter<InputFrameType, OutputFrameType>;
+  auto * inPlaceFilter = dynamic_cast<InPlaceFilterType *>(m_FrameFilter.GetPointer());
+  if (inPlaceFilter != nullptr)
+  {
+    inPlaceFilter->InPlaceOff();
+  }
+
+  const InputVideoStreamType * input = this->GetInput();
+  OutputVideoStreamType *      output = this->GetOutput();
+  output->SetMinimumBufferSize(m_NumberOfBufferedFrames);
+  output->InitializeEmptyFrames();
+
+  const SizeValueType inputStart = input->GetRequestedTemporalRegion().GetFrameStart();
+  const SizeValueType outputStart = output->GetRequestedTemporalRegion().GetFrameStart();
+  for (SizeValueType ii = 0; ii < this->m_UnitInputNumberOfFrames; ++ii)
+  {
+    m_FrameFilter->SetInput(static_cast<unsigned int>(ii), input->GetFrame(inputStart + ii));
+  }
+
+  // The filter allocates the buffer of the frame the first time the slot is
+  // used, and reuses it afterwards.
+  OutputFrameType * frame = output->GetFrame(outputStart);
+  m_FrameFilter->GraftOutput(frame);
+  m_FrameFilter->UpdateLargestPossibleRegion();
+  frame->Graft(m_FrameFilter->GetOutput());
+}
+
+
+template <typename TInputVideoStream, typename TOutputVideoStream>
+void
+RingBufferedVideoFilter<TInputVideoStream, TOutputVideoStream>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FrameFilter: " << m_FrameFilter.GetPointer() << std::endl;
+  os << indent << "NumberOfFilterInputs: " << this->GetNumberOfFilterInputs() << std::endl;
+  os << indent << "NumberOfBufferedFrames: " << m_NumberOfBufferedFrames << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkRingBufferedVideoFilter_hxx
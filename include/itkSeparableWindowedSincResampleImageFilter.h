@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSeparableWindowedSincResampleImageFilter_h
+#define itkSeparableWindowedSincResampleImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkWindowedSincInterpolateImageFunction.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class SeparableWindowedSincResampleImageFilter
+ * \brief Resample an image onto a grid with its direction with a separable,
+ * precomputed windowed sinc kernel.
+ *
+ * The result is the one of a ResampleImageFilter with an identity transform,
+ * a WindowedSincInterpolateImageFunction and a
+ * ZeroFluxNeumannBoundaryCondition, up to the rounding of the intermediate
+ * sums, for the uniform upsampling and downsampling case: the output has the
+ * direction of the input, and its own size, start index, spacing and origin.
+ * The continuous index in the input of an output pixel is then separable, so
+ * the 2 * VRadius weights of the kernel and the input samples they apply to
+ * are computed once for every output sample along every direction.  The
+ * kernel is applied one direction at a time, multithreaded over the lines,
+ * instead of evaluating 2 * VRadius to the power ImageDimension neighbors for
+ * every output pixel.  One intermediate image of RealType per direction is
+ * allocated during the update.
+ *
+ * Output pixels outside of the input buffer, as tested by
+ * ImageFunction::IsInsideBuffer(), are set to the DefaultPixelValue.  The other
+ * values are clamped to the range of the output pixel type, which must be a
+ * scalar.  The whole input and the whole output are always processed.
+ *
+ * \sa ResampleImageFilter
+ * \sa WindowedSincInterpolateImageFunction
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage,
+          typename TOutputImage,
+          unsigned int VRadius,
+          typename TWindowFunction = Function::HammingWindowFunction<VRadius>>
+class ITK_TEMPLATE_EXPORT SeparableWindowedSincResampleImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SeparableWindowedSincResampleImageFilter);
+
+  /** Standard class type alias. */
+  using Self = SeparableWindowedSincResampleImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SeparableWindowedSincResampleImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using SizeType = typename OutputImageType::SizeType;
+  using IndexType = typename OutputImageType::IndexType;
+  using SpacingType = typename OutputImageType::SpacingType;
+  using PointType = typename OutputImageType::PointType;
+  using WindowFunctionType = TWindowFunction;
+
+  /** Type of the kernel weights and the intermediate images. */
+  using RealType = double;
+  using RealImageType = Image<RealType, ImageDimension>;
+
+  /** Number of input samples blended along a direction. */
+  static constexpr unsigned int WindowSize = 2 * VRadius;
+
+  /** Size of the output image. */
+  itkSetMacro(Size, SizeType);
+  itkGetConstReferenceMacro(Size, SizeType);
+
+  /** Start index of the output image. */
+  itkSetMacro(OutputStartIndex, IndexType);
+  itkGetConstReferenceMacro(OutputStartIndex, IndexType);
+
+  /** Spacing of the output image. */
+  itkSetMacro(OutputSpacing, SpacingType);
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  /** Origin of the output image. */
+  itkSetMacro(OutputOrigin, PointType);
+  itkGetConstReferenceMacro(OutputOrigin, PointType);
+
+  /** Value of the output pixels outside of the input. */
+  itkSetMacro(DefaultPixelValue, OutputPixelType);
+  itkGetConstReferenceMacro(DefaultPixelValue, OutputPixelType);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  // Begin concept checking
+  itkConceptMacro(SameDimensionCheck, (Concept::SameDimension<InputImageDimension, ImageDimension>));
+  // End concept checking
+#endif
+
+protected:
+  SeparableWindowedSincResampleImageFilter();
+  virtual ~SeparableWindowedSincResampleImageFilter() {}
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+private:
+  /** For every output sample along a direction, the positions of the
+   * WindowSize input samples it blends, relative to the start of the input
+   * buffer and clamped to it, their weights, and whether the sample is inside
+   * the input buffer. */
+  struct DirectionKernel
+  {
+    std::vector<IndexValueType> Neighbors;
+    std::vector<RealType>       Weights;
+    std::vector<bool>           Inside;
+  };
+
+  void
+  ComputeDirectionKernel(unsigned int direction, DirectionKernel & kernel) const;
+
+  /** Apply the kernel of a direction to every line of the input along it. */
+  template <typename TStageImage>
+  void
+  FilterDirection(const TStageImage *     input,
+                  RealImageType *         output,
+                  unsigned int            direction,
+                  const DirectionKernel & kernel);
+
+  SizeType        m_Size;
+  IndexType       m_OutputStartIndex;
+  SpacingType     m_OutputSpacing;
+  PointType       m_OutputOrigin;
+  OutputPixelType m_DefaultPixelValue;
+
+  WindowFunctionType m_WindowFunction;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSeparableWindowedSincResampleImageFilter.hxx"
+#endif
+
+#endif // itkSeparableWindowedSincResampleImageFilter_h
@@ -0,0 +1,286 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSeparableWindowedSincResampleImageFilter_hxx
+#define itkSeparableWindowedSincResampleImageFilter_hxx
+
+#include "itkSeparableWindowedSincResampleImageFilter.h"
+
+#include "itkContinuousIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::
+  SeparableWindowedSincResampleImageFilter()
+  : m_DefaultPixelValue(NumericTraits<OutputPixelType>::ZeroValue())
+{
+  m_Size.Fill(0);
+  m_OutputStartIndex.Fill(0);
+  m_OutputSpacing.Fill(1.0);
+  m_OutputOrigin.Fill(0.0);
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::
+  GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  if (!input || !output)
+  {
+    return;
+  }
+
+  const OutputImageRegionType outputRegion(m_OutputStartIndex, m_Size);
+  output->SetLargestPossibleRegion(outputRegion);
+  output->SetSpacing(m_OutputSpacing);
+  output->SetOrigin(m_OutputOrigin);
+  output->SetDirection(input->GetDirection());
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::
+  GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::
+  EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::ComputeDirectionKernel(
+  unsigned int      direction,
+  DirectionKernel & kernel) const
+{
+  const InputImageType *                      input = this->GetInput();
+  const typename InputImageType::RegionType & inputRegion = input->GetBufferedRegion();
+  const IndexValueType                        inputStart = inputRegion.GetIndex(direction);
+
+  const IndexValueType inputLast = static_cast<IndexValueType>(inputRegion.GetSize(direction)) - 1;
+
+  // With the direction of the input, the continuous index of the output
+  // index j along the direction is that of the output origin plus j times the
+  // ratio of the spacings.
+  ContinuousIndex<double, ImageDimension> originIndex;
+  input->TransformPhysicalPointToContinuousIndex(m_OutputOrigin, originIndex);
+  const double ratio = m_OutputSpacing[direction] / input->GetSpacing()[direction];
+
+  const SizeValueType outputSize = m_Size[direction];
+  kernel.Neighbors.resize(outputSize * WindowSize);
+  kernel.Weights.resize(outputSize * WindowSize);
+  kernel.Inside.resize(outputSize);
+  for (SizeValueType jj = 0; jj < outputSize; ++jj)
+  {
+    const double x = originIndex[direction] + static_cast<double>(m_OutputStartIndex[direction] + jj) * ratio;
+    kernel.Inside[jj] = x >= inputStart - 0.5 && x < inputStart + inputLast + 0.5;
+
+    // The neighbors and weights of WindowedSincInterpolateImageFunction: the
+    // offsets from 1 - VRadius to VRadius from the floor of the continuous
+    // index, and a delta when it falls on a sample.
+    const IndexValueType baseIndex = Math::Floor<IndexValueType>(x);
+    const double         distance = x - baseIndex;
+    for (unsigned int ii = 0; ii < WindowSize; ++ii)
+    {
+      const IndexValueType neighbor = baseIndex + static_cast<IndexValueType>(ii) + 1 - VRadius - inputStart;
+      kernel.Neighbors[jj * WindowSize + ii] = std::min(std::max(neighbor, IndexValueType{ 0 }), inputLast);
+
+      RealType weight;
+      if (distance == 0.0)
+      {
+        weight = (ii == VRadius - 1) ? 1.0 : 0.0;
+      }
+      else
+      {
+        const double sampleDistance = distance + VRadius - 1 - ii;
+        const double px = Math::pi * sampleDistance;
+        weight = m_WindowFunction(sampleDistance) * std::sin(px) / px;
+      }
+      kernel.Weights[jj * WindowSize + ii] = weight;
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+template <typename TStageImage>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::FilterDirection(
+  const TStageImage *     input,
+  RealImageType *         output,
+  unsigned int            direction,
+  const DirectionKernel & kernel)
+{
+  const IndexValueType inputStart = input->GetBufferedRegion().GetIndex(direction);
+  this->GetMultiThreader()->template ParallelizeImageRegionRestrictDirection<ImageDimension>(
+    direction,
+    output->GetBufferedRegion(),
+    [input, output, direction, inputStart, &kernel](const OutputImageRegionType & lambdaRegion) {
+      using StagePixelType = typename TStageImage::PixelType;
+      const OffsetValueType  inputStride = input->GetOffsetTable()[direction];
+      const OffsetValueType  outputStride = output->GetOffsetTable()[direction];
+      const StagePixelType * inputBuffer = input->GetBufferPointer();
+      RealType *             outputBuffer = output->GetBufferPointer();
+      const SizeValueType    lineSize = lambdaRegion.GetSize(direction);
+
+      // Visit the first sample of every line along the direction; the lines
+      // are then addressed directly in the buffers.
+      OutputImageRegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(direction, 1);
+      ImageRegionConstIteratorWithIndex<RealImageType> lineIt(output, lineStartRegion);
+      for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+      {
+        IndexType inputIndex = lineIt.GetIndex();
+        inputIndex[direction] = inputStart;
+        const StagePixelType * inputLine = inputBuffer + input->ComputeOffset(inputIndex);
+        RealType *             outputLine = outputBuffer + output->ComputeOffset(lineIt.GetIndex());
+        const IndexValueType * neighbors = kernel.Neighbors.data();
+        const RealType *       weights = kernel.Weights.data();
+        for (SizeValueType jj = 0; jj < lineSize; ++jj)
+        {
+          RealType sum = 0.0;
+          for (unsigned int ii = 0; ii < WindowSize; ++ii)
+          {
+            sum += weights[ii] * static_cast<RealType>(inputLine[neighbors[ii] * inputStride]);
+          }
+          outputLine[jj * outputStride] = sum;
+          neighbors += WindowSize;
+          weights += WindowSize;
+        }
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  const InputImageType *      input = this->GetInput();
+  OutputImageType *           output = this->GetOutput();
+  const OutputImageRegionType outputRegion = output->GetBufferedRegion();
+
+  std::vector<DirectionKernel> kernels(ImageDimension);
+  for (unsigned int direction = 0; direction < ImageDimension; ++direction)
+  {
+    this->ComputeDirectionKernel(direction, kernels[direction]);
+  }
+
+  // Resample one direction at a time: the stage along a direction has the
+  // output extent along it and the directions before it, and the input extent
+  // along the others.
+  typename RealImageType::Pointer stage;
+  OutputImageRegionType           stageRegion = input->GetBufferedRegion();
+  for (unsigned int direction = 0; direction < ImageDimension; ++direction)
+  {
+    stageRegion.SetIndex(direction, outputRegion.GetIndex(direction));
+    stageRegion.SetSize(direction, outputRegion.GetSize(direction));
+    typename RealImageType::Pointer nextStage = RealImageType::New();
+    nextStage->SetRegions(stageRegion);
+    nextStage->Allocate();
+    if (direction == 0)
+    {
+      this->FilterDirection(input, nextStage.GetPointer(), direction, kernels[direction]);
+    }
+    else
+    {
+      this->FilterDirection(stage.GetPointer(), nextStage.GetPointer(), direction, kernels[direction]);
+    }
+    stage = nextStage;
+  }
+
+  // Clamp to the output pixel range, as ResampleImageFilter does, and set the
+  // pixels outside of the input buffer to the default value.
+  const RealType        minimum = static_cast<RealType>(NumericTraits<OutputPixelType>::NonpositiveMin());
+  const RealType        maximum = static_cast<RealType>(NumericTraits<OutputPixelType>::max());
+  const RealImageType * lastStage = stage.GetPointer();
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+    outputRegion,
+    [this, output, lastStage, &kernels, &outputRegion, minimum, maximum](const OutputImageRegionType & lambdaRegion) {
+      ImageRegionConstIteratorWithIndex<RealImageType> stageIt(lastStage, lambdaRegion);
+      ImageRegionIterator<OutputImageType>             outputIt(output, lambdaRegion);
+      for (stageIt.GoToBegin(), outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++stageIt, ++outputIt)
+      {
+        const IndexType & index = stageIt.GetIndex();
+        bool              inside = true;
+        for (unsigned int direction = 0; direction < ImageDimension; ++direction)
+        {
+          inside = inside && kernels[direction].Inside[index[direction] - outputRegion.GetIndex(direction)];
+        }
+        if (!inside)
+        {
+          outputIt.Set(this->m_DefaultPixelValue);
+          continue;
+        }
+        outputIt.Set(static_cast<OutputPixelType>(std::min(std::max(stageIt.Get(), minimum), maximum)));
+      }
+    },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage, unsigned int VRadius, typename TWindowFunction>
+void
+SeparableWindowedSincResampleImageFilter<TInputImage, TOutputImage, VRadius, TWindowFunction>::PrintSelf(
+  std::ostream & os,
+  Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Size: " << m_Size << std::endl;
+  os << indent << "OutputStartIndex: " << m_OutputStartIndex << std::endl;
+  os << indent << "OutputSpacing: " << m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << m_OutputOrigin << std::endl;
+  os << indent << "DefaultPixelValue: "
+     << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(m_DefaultPixelValue) << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSeparableWindowedSincResampleImageFilter_hxx
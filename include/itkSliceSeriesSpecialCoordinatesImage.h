@@ -19,11 +19,16 @@
 #define itkSliceSeriesSpecialCoordinatesImage_h
 
 #include "itkSpecialCoordinatesImage.h"
+#include "itkCommand.h"
 #include "itkPoint.h"
 #include "itkNeighborhoodAccessorFunctor.h"
 #include "itkVectorContainer.h"
 #include "itkMath.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace itk
 {
 /** \class SliceSeriesSpecialCoordinatesImage
@@ -42,6 +47,18 @@ namespace itk
  * for the Slice image to be a specialized type like the
  * CurvilinearArraySpecialCoordinatesImage.
  *
+ * The slice transforms that are linear, and their inverses, are cached as
+ * matrices in a contiguous array, so that the index and point conversions do
+ * not call the transforms.  The cache, and the inverse transforms, are
+ * refreshed when a slice transform is modified.
+ *
+ * The inverse transforms and the matrices are computed when the slice
+ * transforms are set or modified, never lazily by the queries, so the index
+ * and point conversions are const and may be called concurrently from many
+ * threads, e.g. by a multithreaded resampler, with one slice hint per
+ * thread.  The slice transforms must not be set or modified while
+ * conversions run.
+ *
  * \sa SpecialCoordinatesImage
  * \sa CurvilinearArraySpecialCoordinatesImage
  *
@@ -159,6 +176,8 @@ public:
   itkSetObjectMacro(SliceImage, SliceImageType);
   itkGetConstObjectMacro(SliceImage, SliceImageType);
 
+  /** Set the transform of a slice.  Its inverse is computed here, and again
+   * whenever the transform is modified. */
   void
   SetSliceTransform(IndexValueType sliceIndex, TransformType * transform);
   const TransformType *
@@ -186,85 +205,51 @@ public:
   TransformPhysicalPointToContinuousIndex(const Point<TCoordRep, VDimension> &     point,
                                           ContinuousIndex<TIndexRep, VDimension> & index) const
   {
-    const RegionType &    region = this->GetLargestPossibleRegion();
-    const unsigned int    sliceDimensionIndex = ImageDimension - 1;
-    IndexValueType        lowerIndex = region.GetIndex(sliceDimensionIndex);
-    IndexValueType        upperIndex = lowerIndex + region.GetSize(sliceDimensionIndex) - 1;
-    IndexValueType        nextIndex = lowerIndex;
-    PointType             lowerPoint;
-    const TransformType * transform = this->GetSliceInverseTransform(lowerIndex);
-    if (transform == nullptr)
-    {
-      itkExceptionMacro("Inverse slice transform not available for index: " << lowerIndex);
-    }
-    lowerPoint = transform->TransformPoint(point);
-    int       lowerSign = Math::sgn(lowerPoint[sliceDimensionIndex]);
-    PointType upperPoint;
-    transform = this->GetSliceInverseTransform(upperIndex);
-    if (transform == nullptr)
-    {
-      itkExceptionMacro("Inverse slice transform not available for index: " << upperIndex);
-    }
-    upperPoint = transform->TransformPoint(point);
-    int       upperSign = Math::sgn(upperPoint[sliceDimensionIndex]);
-    PointType nextPoint = lowerPoint;
-    int       nextSign = 0;
-    if (lowerSign == 0)
-    {
-      nextSign = 0;
-      nextPoint = lowerPoint;
-    }
-    else if (upperSign == 0)
-    {
-      nextSign = 0;
-      nextPoint = upperPoint;
-    }
-    else
-    {
-      if (lowerSign == upperSign)
-      {
-        // outside the image
-        return false;
-      }
+    IndexValueType sliceHint = NumericTraits<IndexValueType>::min();
+    return this->TransformPhysicalPointToContinuousIndex(point, index, sliceHint);
+  }
 
-      // Binary search for the transforms that bounds the slice
-      while (upperIndex - lowerIndex > 1)
-      {
-        nextIndex = lowerIndex + (upperIndex - lowerIndex) / 2;
-        transform = this->GetSliceInverseTransform(nextIndex);
-        nextPoint = transform->TransformPoint(point);
-        nextSign = Math::sgn(nextPoint[sliceDimensionIndex]);
-        if (nextSign == 0)
-        {
-          break;
-        }
-        else if (nextSign == lowerSign)
-        {
-          lowerIndex = nextIndex;
-          lowerPoint = nextPoint;
-        }
-        else
-        {
-          upperIndex = nextIndex;
-          upperPoint = nextPoint;
-        }
-      }
+  /** \brief Get the continuous index from a physical point, starting the
+   * search for its slice from a hint.
+   *
+   * sliceHint is the index of a slice close to the point, e.g. the slice
+   * found for the previous point of a scan line; on return it holds the
+   * slice found for this point.  When the point lies between the hinted
+   * slice and the next one, the slice is found with two slice transforms,
+   * and otherwise with a number of them logarithmic in the distance from
+   * the hint.  A hint outside of the image is ignored.  Each thread should
+   * keep its own hint.
+   * \sa Transform */
+  template <typename TCoordRep, typename TIndexRep>
+  bool
+  TransformPhysicalPointToContinuousIndex(const Point<TCoordRep, VDimension> &     point,
+                                          ContinuousIndex<TIndexRep, VDimension> & index,
+                                          IndexValueType &                         sliceHint) const
+  {
+    const RegionType & region = this->GetLargestPossibleRegion();
+    const unsigned int sliceDimensionIndex = ImageDimension - 1;
+
+    IndexValueType lowerIndex;
+    IndexValueType upperIndex;
+    PointType      lowerPoint;
+    PointType      upperPoint;
+    if (!this->FindBoundingSlices(point, sliceHint, lowerIndex, upperIndex, lowerPoint, upperPoint))
+    {
+      return false;
     }
 
-    if (nextSign != 0)
+    PointType nextPoint = lowerPoint;
+    double    sliceCoordinate = lowerIndex;
+    if (upperIndex != lowerIndex)
     {
-      const TCoordRep fraction =
+      const double fraction =
         -lowerPoint[sliceDimensionIndex] / (upperPoint[sliceDimensionIndex] - lowerPoint[sliceDimensionIndex]);
-      nextPoint[sliceDimensionIndex] = lowerIndex + fraction * (upperIndex - lowerIndex);
+      sliceCoordinate = lowerIndex + fraction * (upperIndex - lowerIndex);
       for (unsigned int ii = 0; ii < SliceImageType::ImageDimension; ++ii)
       {
         nextPoint[ii] = lowerPoint[ii] + fraction * (upperPoint[ii] - lowerPoint[ii]);
       }
     }
-    else
-    {
-      nextPoint[sliceDimensionIndex] = nextIndex;
-    }
 
     typename SliceImageType::PointType slicePoint;
     for (unsigned int ii = 0; ii < SliceImageType::ImageDimension; ++ii)
@@ -277,7 +262,8 @@ public:
     {
       index[ii] = sliceIndex[ii];
     }
-    index[sliceDimensionIndex] = nextPoint[sliceDimensionIndex];
+    index[sliceDimensionIndex] = sliceCoordinate;
+
     // Now, check to see if the index is within allowed bounds
     const bool isInside = region.IsInside(index);
 
@@ -315,85 +301,44 @@ public:
   bool
   TransformPhysicalPointToIndex(const Point<TCoordRep, VDimension> & point, IndexType & index) const
   {
-    const RegionType &    region = this->GetLargestPossibleRegion();
-    const unsigned int    sliceDimensionIndex = ImageDimension - 1;
-    IndexValueType        lowerIndex = region.GetIndex(sliceDimensionIndex);
-    IndexValueType        upperIndex = lowerIndex + region.GetSize(sliceDimensionIndex) - 1;
-    IndexValueType        nextIndex = lowerIndex;
-    PointType             lowerPoint;
-    const TransformType * transform = this->GetSliceInverseTransform(lowerIndex);
-    if (transform == nullptr)
-    {
-      itkExceptionMacro("Inverse slice transform not available for index: " << lowerIndex);
-    }
-    lowerPoint = transform->TransformPoint(point);
-    int       lowerSign = Math::sgn(lowerPoint[sliceDimensionIndex]);
-    PointType upperPoint;
-    transform = this->GetSliceInverseTransform(upperIndex);
-    if (transform == nullptr)
-    {
-      itkExceptionMacro("Inverse slice transform not available for index: " << upperIndex);
-    }
-    upperPoint = transform->TransformPoint(point);
-    int       upperSign = Math::sgn(upperPoint[sliceDimensionIndex]);
-    PointType nextPoint = lowerPoint;
-    int       nextSign = 0;
-    if (lowerSign == 0)
-    {
-      nextSign = 0;
-      nextPoint = lowerPoint;
-    }
-    else if (upperSign == 0)
-    {
-      nextSign = 0;
-      nextPoint = upperPoint;
-    }
-    else
-    {
-      if (lowerSign == upperSign)
-      {
-        // outside the image
-        return false;
-      }
+    IndexValueType sliceHint = NumericTraits<IndexValueType>::min();
+    return this->TransformPhysicalPointToIndex(point, index, sliceHint);
+  }
 
-      // Binary search for the transforms that bounds the slice
-      while (upperIndex - lowerIndex > 1)
-      {
-        nextIndex = lowerIndex + (upperIndex - lowerIndex) / 2;
-        transform = this->GetSliceInverseTransform(nextIndex);
-        nextPoint = transform->TransformPoint(point);
-        nextSign = Math::sgn(nextPoint[sliceDimensionIndex]);
-        if (nextSign == 0)
-        {
-          break;
-        }
-        else if (nextSign == lowerSign)
-        {
-          lowerIndex = nextIndex;
-          lowerPoint = nextPoint;
-        }
-        else
-        {
-          upperIndex = nextIndex;
-          upperPoint = nextPoint;
-        }
-      }
+  /** Get the index (discrete) from a physical point, starting the search
+   * for its slice from a hint, as for
+   * TransformPhysicalPointToContinuousIndex().
+   * \sa Transform */
+  template <typename TCoordRep>
+  bool
+  TransformPhysicalPointToIndex(const Point<TCoordRep, VDimension> & point,
+                                IndexType &                          index,
+                                IndexValueType &                     sliceHint) const
+  {
+    const RegionType & region = this->GetLargestPossibleRegion();
+    const unsigned int sliceDimensionIndex = ImageDimension - 1;
+
+    IndexValueType lowerIndex;
+    IndexValueType upperIndex;
+    PointType      lowerPoint;
+    PointType      upperPoint;
+    if (!this->FindBoundingSlices(point, sliceHint, lowerIndex, upperIndex, lowerPoint, upperPoint))
+    {
+      return false;
     }
 
-    if (nextSign != 0)
+    PointType nextPoint = lowerPoint;
+    double    sliceCoordinate = lowerIndex;
+    if (upperIndex != lowerIndex)
     {
-      const TCoordRep fraction =
+      const double fraction =
         -lowerPoint[sliceDimensionIndex] / (upperPoint[sliceDimensionIndex] - lowerPoint[sliceDimensionIndex]);
-      nextPoint[sliceDimensionIndex] = lowerIndex + fraction * (upperIndex - lowerIndex);
+      sliceCoordinate = lowerIndex + fraction * (upperIndex - lowerIndex);
       for (unsigned int ii = 0; ii < SliceImageType::ImageDimension; ++ii)
       {
         nextPoint[ii] = lowerPoint[ii] + fraction * (upperPoint[ii] - lowerPoint[ii]);
       }
     }
-    else
-    {
-      nextPoint[sliceDimensionIndex] = nextIndex;
-    }
 
     typename SliceImageType::PointType slicePoint;
     for (unsigned int ii = 0; ii < SliceImageType::ImageDimension; ++ii)
@@ -406,7 +351,8 @@ public:
     {
       index[ii] = sliceIndex[ii];
     }
-    index[sliceDimensionIndex] = Math::RoundHalfIntegerUp<IndexValueType>(nextPoint[sliceDimensionIndex]);
+    index[sliceDimensionIndex] = Math::RoundHalfIntegerUp<IndexValueType>(sliceCoordinate);
+
     // Now, check to see if the index is within allowed bounds
     const bool isInside = region.IsInside(index);
 
@@ -459,22 +405,19 @@ public:
       point[ii] += slicePoint[ii];
     }
     using PointType = Point<TCoordRep, VDimension>;
-    PointType             lowerPoint;
-    const IndexValueType  floor = Math::Floor<IndexValueType, TIndexRep>(index[ImageDimension - 1]);
-    const IndexValueType  ceil = Math::Ceil<IndexValueType, TIndexRep>(index[ImageDimension - 1]);
-    const TransformType * transform = this->GetSliceTransform(floor);
-    if (transform != nullptr)
-    {
-      lowerPoint = transform->TransformPoint(point);
-    }
-    else
+    const IndexValueType floor = Math::Floor<IndexValueType, TIndexRep>(index[ImageDimension - 1]);
+    const IndexValueType ceil = Math::Ceil<IndexValueType, TIndexRep>(index[ImageDimension - 1]);
+    PointType            lowerPoint;
+    PointType            upperPoint;
+    if (!this->TransformSlicePointToPhysicalPoint(floor, point, lowerPoint) ||
+        !this->TransformSlicePointToPhysicalPoint(ceil, point, upperPoint))
     {
       const RegionType & largestRegion = this->GetLargestPossibleRegion();
       const IndexType &  largestIndex = largestRegion.GetIndex();
       if (index[ImageDimension - 1] < largestIndex[ImageDimension - 1])
       {
         point[ImageDimension - 1] = index[ImageDimension - 1] - largestIndex[ImageDimension - 1];
-        point = transform->TransformPoint(point);
+        this->TransformSlicePointToPhysicalPoint(largestIndex[ImageDimension - 1], point, point);
         return;
       }
 
@@ -483,34 +426,8 @@ public:
       {
         point[ImageDimension - 1] =
           index[ImageDimension - 1] - largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1;
-        point = transform->TransformPoint(point);
-      }
-      return;
-    }
-
-    transform = this->GetSliceTransform(ceil);
-    PointType upperPoint;
-    if (transform != nullptr)
-    {
-      upperPoint = transform->TransformPoint(point);
-    }
-    else
-    {
-      const RegionType & largestRegion = this->GetLargestPossibleRegion();
-      const IndexType &  largestIndex = largestRegion.GetIndex();
-      if (index[ImageDimension - 1] < largestIndex[ImageDimension - 1])
-      {
-        point[ImageDimension - 1] = index[ImageDimension - 1] - largestIndex[ImageDimension - 1];
-        point = transform->TransformPoint(point);
-        return;
-      }
-
-      const SizeType & largestSize = largestRegion.GetSize();
-      if (index[ImageDimension - 1] > largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1)
-      {
-        point[ImageDimension - 1] =
-          index[ImageDimension - 1] - largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1;
-        point = transform->TransformPoint(point);
+        this->TransformSlicePointToPhysicalPoint(
+          largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1, point, point);
       }
       return;
     }
@@ -556,10 +473,8 @@ public:
     {
       point[ii] += slicePoint[ii];
     }
-    const TransformType * transform = this->GetSliceTransform(index[ImageDimension - 1]);
-    if (transform != nullptr)
+    if (this->TransformSlicePointToPhysicalPoint(index[ImageDimension - 1], point, point))
     {
-      point = transform->TransformPoint(point);
       return;
     }
     const RegionType & largestRegion = this->GetLargestPossibleRegion();
@@ -567,8 +482,7 @@ public:
     if (index[ImageDimension - 1] < largestIndex[ImageDimension - 1])
     {
       point[ImageDimension - 1] = index[ImageDimension - 1] - largestIndex[ImageDimension - 1];
-      transform = this->GetSliceTransform(largestIndex[ImageDimension - 1]);
-      point = transform->TransformPoint(point);
+      this->TransformSlicePointToPhysicalPoint(largestIndex[ImageDimension - 1], point, point);
       return;
     }
 
@@ -578,8 +492,8 @@ public:
     {
       point[ImageDimension - 1] =
         index[ImageDimension - 1] - largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1;
-      transform = this->GetSliceTransform(largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1);
-      point = transform->TransformPoint(point);
+      this->TransformSlicePointToPhysicalPoint(
+        largestIndex[ImageDimension - 1] + largestSize[ImageDimension - 1] - 1, point, point);
     }
   }
 
@@ -645,21 +559,232 @@ public:
 protected:
   SliceSeriesSpecialCoordinatesImage();
 
-  virtual ~SliceSeriesSpecialCoordinatesImage() {}
+  virtual ~SliceSeriesSpecialCoordinatesImage();
   virtual void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
   const TransformType *
   GetSliceInverseTransform(IndexValueType sliceIndex) const;
 
+  /** Map a point in the frame of a slice to a physical point.  point may be
+   * slicePoint.  Returns false if the slice has no transform. */
+  template <typename TCoordRep>
+  bool
+  TransformSlicePointToPhysicalPoint(IndexValueType                       sliceIndex,
+                                     const Point<TCoordRep, VDimension> & slicePoint,
+                                     Point<TCoordRep, VDimension> &       point) const
+  {
+    const SizeValueType transformsIndex =
+      static_cast<SizeValueType>(sliceIndex - this->GetLargestPossibleRegion().GetIndex(ImageDimension - 1));
+    if (transformsIndex < m_SliceMatricesAreCached.size() && m_SliceMatricesAreCached[transformsIndex])
+    {
+      const Point<TCoordRep, VDimension> input = slicePoint;
+      this->ApplySliceMatrix(&m_SliceMatrices[transformsIndex * 2 * SliceMatrixSize], input, point);
+      return true;
+    }
+    const TransformType * transform = this->GetSliceTransform(sliceIndex);
+    if (transform == nullptr)
+    {
+      return false;
+    }
+    point = transform->TransformPoint(slicePoint);
+    return true;
+  }
+
+  /** Map a physical point into the frame of a slice, where the slice is the
+   * plane with a zero last coordinate. */
+  PointType
+  TransformPhysicalPointToSlice(IndexValueType sliceIndex, const PointType & point) const
+  {
+    const SizeValueType transformsIndex =
+      static_cast<SizeValueType>(sliceIndex - this->GetLargestPossibleRegion().GetIndex(ImageDimension - 1));
+    PointType slicePoint;
+    if (transformsIndex < m_SliceMatricesAreCached.size() && m_SliceMatricesAreCached[transformsIndex])
+    {
+      this->ApplySliceMatrix(&m_SliceMatrices[(transformsIndex * 2 + 1) * SliceMatrixSize], point, slicePoint);
+      return slicePoint;
+    }
+    const TransformType * transform = this->GetSliceInverseTransform(sliceIndex);
+    if (transform == nullptr)
+    {
+      itkExceptionMacro("Inverse slice transform not available for index: " << sliceIndex);
+    }
+    slicePoint = transform->TransformPoint(point);
+    return slicePoint;
+  }
+
+  /** Find the adjacent slices whose planes bound a point, i.e. between which
+   * the last coordinate of the point in the slice frames changes sign.
+   * upperIndex is lowerIndex + 1, or lowerIndex when the point is on a slice
+   * plane.  lowerPoint and upperPoint are the point in the frames of the
+   * two slices.  Returns false if the point is not between the first and the
+   * last slices.
+   *
+   * The slices are bisected.  When sliceHint is in the image, the slices
+   * are first searched from the hint outwards, with steps that double, in
+   * the direction in which the point gets closer to the slice planes, so
+   * that the slice of a point close to the hinted one is found with a few
+   * slice transforms.  sliceHint is set to lowerIndex. */
+  template <typename TCoordRep>
+  bool
+  FindBoundingSlices(const Point<TCoordRep, VDimension> & point,
+                     IndexValueType &                     sliceHint,
+                     IndexValueType &                     lowerIndex,
+                     IndexValueType &                     upperIndex,
+                     PointType &                          lowerPoint,
+                     PointType &                          upperPoint) const
+  {
+    const RegionType &   region = this->GetLargestPossibleRegion();
+    const unsigned int   sliceDimensionIndex = ImageDimension - 1;
+    const IndexValueType firstIndex = region.GetIndex(sliceDimensionIndex);
+    const IndexValueType lastIndex = firstIndex + static_cast<IndexValueType>(region.GetSize(sliceDimensionIndex)) - 1;
+
+    PointType physicalPoint;
+    for (unsigned int ii = 0; ii < VDimension; ++ii)
+    {
+      physicalPoint[ii] = point[ii];
+    }
+
+    bool bracketed = false;
+    if (sliceHint >= firstIndex && sliceHint < lastIndex)
+    {
+      lowerIndex = sliceHint;
+      upperIndex = sliceHint + 1;
+      lowerPoint = this->TransformPhysicalPointToSlice(lowerIndex, physicalPoint);
+      upperPoint = this->TransformPhysicalPointToSlice(upperIndex, physicalPoint);
+      const int lowerSign = Math::sgn(lowerPoint[sliceDimensionIndex]);
+      const int upperSign = Math::sgn(upperPoint[sliceDimensionIndex]);
+      bracketed = lowerSign != upperSign || lowerSign == 0;
+
+      // Gallop towards the plane of the point.
+      const bool     upwards = std::abs(upperPoint[sliceDimensionIndex]) < std::abs(lowerPoint[sliceDimensionIndex]);
+      IndexValueType nearIndex = upwards ? upperIndex : lowerIndex;
+      PointType      nearPoint = upwards ? upperPoint : lowerPoint;
+      IndexValueType step = 1;
+      while (!bracketed)
+      {
+        step *= 2;
+        const IndexValueType farIndex =
+          upwards ? std::min(nearIndex + step, lastIndex) : std::max(nearIndex - step, firstIndex);
+        if (farIndex == nearIndex)
+        {
+          break;
+        }
+        const PointType farPoint = this->TransformPhysicalPointToSlice(farIndex, physicalPoint);
+        if (Math::sgn(farPoint[sliceDimensionIndex]) != Math::sgn(nearPoint[sliceDimensionIndex]))
+        {
+          lowerIndex = upwards ? nearIndex : farIndex;
+          upperIndex = upwards ? farIndex : nearIndex;
+          lowerPoint = upwards ? nearPoint : farPoint;
+          upperPoint = upwards ? farPoint : nearPoint;
+          bracketed = true;
+        }
+        nearIndex = farIndex;
+        nearPoint = farPoint;
+      }
+    }
+
+    if (!bracketed)
+    {
+      lowerIndex = firstIndex;
+      upperIndex = lastIndex;
+      lowerPoint = this->TransformPhysicalPointToSlice(lowerIndex, physicalPoint);
+      upperPoint = this->TransformPhysicalPointToSlice(upperIndex, physicalPoint);
+      const int lowerSign = Math::sgn(lowerPoint[sliceDimensionIndex]);
+      const int upperSign = Math::sgn(upperPoint[sliceDimensionIndex]);
+      if (lowerSign != 0 && upperSign != 0 && lowerSign == upperSign)
+      {
+        // outside the image
+        return false;
+      }
+    }
+
+    // Bisect the slices between the bounds.
+    if (Math::sgn(lowerPoint[sliceDimensionIndex]) == 0)
+    {
+      upperIndex = lowerIndex;
+      upperPoint = lowerPoint;
+    }
+    else if (Math::sgn(upperPoint[sliceDimensionIndex]) == 0)
+    {
+      lowerIndex = upperIndex;
+      lowerPoint = upperPoint;
+    }
+    const int lowerSign = Math::sgn(lowerPoint[sliceDimensionIndex]);
+    while (upperIndex - lowerIndex > 1)
+    {
+      const IndexValueType nextIndex = lowerIndex + (upperIndex - lowerIndex) / 2;
+      const PointType      nextPoint = this->TransformPhysicalPointToSlice(nextIndex, physicalPoint);
+      const int            nextSign = Math::sgn(nextPoint[sliceDimensionIndex]);
+      if (nextSign == 0)
+      {
+        lowerIndex = nextIndex;
+        upperIndex = nextIndex;
+        lowerPoint = nextPoint;
+        upperPoint = nextPoint;
+      }
+      else if (nextSign == lowerSign)
+      {
+        lowerIndex = nextIndex;
+        lowerPoint = nextPoint;
+      }
+      else
+      {
+        upperIndex = nextIndex;
+        upperPoint = nextPoint;
+      }
+    }
+
+    sliceHint = lowerIndex;
+    return true;
+  }
+
 private:
   SliceSeriesSpecialCoordinatesImage(const Self &); // purposely not implemented
   void
   operator=(const Self &); // purposely not implemented
 
+  /** Number of values of a cached matrix: the rows of the linear part, each
+   * followed by the translation. */
+  static constexpr unsigned int SliceMatrixSize = VDimension * (VDimension + 1);
+
+  template <typename TInputCoordRep, typename TOutputCoordRep>
+  static void
+  ApplySliceMatrix(const double *                            matrix,
+                   const Point<TInputCoordRep, VDimension> & input,
+                   Point<TOutputCoordRep, VDimension> &      output)
+  {
+    for (unsigned int row = 0; row < VDimension; ++row)
+    {
+      const double * rowValues = matrix + row * (VDimension + 1);
+      double         value = rowValues[VDimension];
+      for (unsigned int column = 0; column < VDimension; ++column)
+      {
+        value += rowValues[column] * input[column];
+      }
+      output[row] = static_cast<TOutputCoordRep>(value);
+    }
+  }
+
+  /** Compute the inverse transform and the cached matrices of a slice. */
+  void
+  UpdateSliceTransformCache(SizeValueType transformsIndex);
+
+  /** Called when a slice transform is modified. */
+  void
+  SliceTransformModified(Object * caller, const EventObject & event);
+
   typename SliceImageType::Pointer      m_SliceImage;
   typename SliceTransformsType::Pointer m_SliceTransforms;
   typename SliceTransformsType::Pointer m_SliceInverseTransforms;
+
+  /** Forward and inverse matrices of each slice whose transform is linear. */
+  std::vector<double>        m_SliceMatrices;
+  std::vector<unsigned char> m_SliceMatricesAreCached;
+
+  using SliceTransformCommandType = MemberCommand<Self>;
+  typename SliceTransformCommandType::Pointer m_SliceTransformModifiedCommand;
+  std::vector<unsigned long>                  m_SliceTransformObserverTags;
 };
 } // end namespace itk
 
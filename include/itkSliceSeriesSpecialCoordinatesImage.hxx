@@ -38,6 +38,24 @@ SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>:
   this->m_SliceImage = SliceImageType::New();
   this->m_SliceTransforms = SliceTransformsType::New();
   this->m_SliceInverseTransforms = SliceTransformsType::New();
+  this->m_SliceTransformModifiedCommand = SliceTransformCommandType::New();
+  this->m_SliceTransformModifiedCommand->SetCallbackFunction(this, &Self::SliceTransformModified);
+}
+
+
+template <typename TSliceImage, typename TTransform, typename TPixel, unsigned int VDimension>
+SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>::~SliceSeriesSpecialCoordinatesImage()
+{
+  const SizeValueType numberOfTags = this->m_SliceTransformObserverTags.size();
+  for (SizeValueType transformsIndex = 0; transformsIndex < numberOfTags; ++transformsIndex)
+  {
+    if (this->m_SliceTransforms->Size() > transformsIndex &&
+        this->m_SliceTransforms->GetElement(transformsIndex).IsNotNull())
+    {
+      this->m_SliceTransforms->GetElement(transformsIndex)
+        ->RemoveObserver(this->m_SliceTransformObserverTags[transformsIndex]);
+    }
+  }
 }
 
 
@@ -50,6 +68,9 @@ SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>:
   const SizeType & largestSize = this->GetLargestPossibleRegion().GetSize();
   this->m_SliceTransforms->Reserve(largestSize[ImageDimension - 1] + 1);
   this->m_SliceInverseTransforms->Reserve(largestSize[ImageDimension - 1] + 1);
+  this->m_SliceMatrices.resize((largestSize[ImageDimension - 1] + 1) * 2 * SliceMatrixSize);
+  this->m_SliceMatricesAreCached.resize(largestSize[ImageDimension - 1] + 1, 0);
+  this->m_SliceTransformObserverTags.resize(largestSize[ImageDimension - 1] + 1, 0);
 }
 
 
@@ -108,7 +129,32 @@ SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>:
   {
     return;
   }
+  if (this->m_SliceTransformObserverTags.size() <= transformsIndex)
+  {
+    this->m_SliceMatrices.resize((transformsIndex + 1) * 2 * SliceMatrixSize);
+    this->m_SliceMatricesAreCached.resize(transformsIndex + 1, 0);
+    this->m_SliceTransformObserverTags.resize(transformsIndex + 1, 0);
+  }
+  if (this->m_SliceTransforms->Size() > transformsIndex &&
+      this->m_SliceTransforms->GetElement(transformsIndex).IsNotNull())
+  {
+    this->m_SliceTransforms->GetElement(transformsIndex)
+      ->RemoveObserver(this->m_SliceTransformObserverTags[transformsIndex]);
+  }
   this->m_SliceTransforms->SetElement(transformsIndex, transform);
+  this->UpdateSliceTransformCache(transformsIndex);
+  this->m_SliceTransformObserverTags[transformsIndex] =
+    transform->AddObserver(ModifiedEvent(), this->m_SliceTransformModifiedCommand);
+  this->Modified();
+}
+
+
+template <typename TSliceImage, typename TTransform, typename TPixel, unsigned int VDimension>
+void
+SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>::UpdateSliceTransformCache(
+  SizeValueType transformsIndex)
+{
+  const TransformType *           transform = this->m_SliceTransforms->GetElement(transformsIndex).GetPointer();
   typename TransformType::Pointer inverse = TransformType::New();
   if (transform->GetInverse(inverse))
   {
@@ -118,6 +164,52 @@ SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>:
   {
     itkExceptionMacro("Could not get inverse for transform: " << transform);
   }
+
+  // A linear transform is the image of the origin and of the unit vectors.
+  this->m_SliceMatricesAreCached[transformsIndex] = transform->IsLinear() && inverse->IsLinear();
+  if (!this->m_SliceMatricesAreCached[transformsIndex])
+  {
+    return;
+  }
+  const TransformType * transforms[2] = { transform, inverse.GetPointer() };
+  for (unsigned int direction = 0; direction < 2; ++direction)
+  {
+    double * matrix = &this->m_SliceMatrices[(transformsIndex * 2 + direction) * SliceMatrixSize];
+    typename TransformType::InputPointType input;
+    input.Fill(0.0);
+    const typename TransformType::OutputPointType origin = transforms[direction]->TransformPoint(input);
+    for (unsigned int row = 0; row < VDimension; ++row)
+    {
+      matrix[row * (VDimension + 1) + VDimension] = origin[row];
+    }
+    for (unsigned int column = 0; column < VDimension; ++column)
+    {
+      input.Fill(0.0);
+      input[column] = 1.0;
+      const typename TransformType::OutputPointType image = transforms[direction]->TransformPoint(input);
+      for (unsigned int row = 0; row < VDimension; ++row)
+      {
+        matrix[row * (VDimension + 1) + column] = image[row] - origin[row];
+      }
+    }
+  }
+}
+
+
+template <typename TSliceImage, typename TTransform, typename TPixel, unsigned int VDimension>
+void
+SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>::SliceTransformModified(
+  Object * caller,
+  const EventObject &)
+{
+  // A transform may be shared by slices.
+  for (SizeValueType transformsIndex = 0; transformsIndex < this->m_SliceTransforms->Size(); ++transformsIndex)
+  {
+    if (this->m_SliceTransforms->GetElement(transformsIndex).GetPointer() == caller)
+    {
+      this->UpdateSliceTransformCache(transformsIndex);
+    }
+  }
   this->Modified();
 }
 
@@ -132,7 +224,9 @@ SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>:
   const SizeValueType  transformsIndex = static_cast<SizeValueType>(sliceIndex - largestIndex);
   if (this->m_SliceTransforms->Size() > transformsIndex)
   {
-    return this->m_SliceTransforms->GetElement(transformsIndex).GetPointer();
+    // ElementAt() does not copy the smart pointer, so concurrent queries do
+    // not contend on the reference count of the transform.
+    return this->m_SliceTransforms->ElementAt(transformsIndex).GetPointer();
   }
   return nullptr;
 }
@@ -148,7 +242,7 @@ SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension>:
   const SizeValueType  transformsIndex = static_cast<SizeValueType>(sliceIndex - largestIndex);
   if (this->m_SliceInverseTransforms->Size() > transformsIndex)
   {
-    return this->m_SliceInverseTransforms->GetElement(transformsIndex).GetPointer();
+    return this->m_SliceInverseTransforms->ElementAt(transformsIndex).GetPointer();
   }
   return nullptr;
 }
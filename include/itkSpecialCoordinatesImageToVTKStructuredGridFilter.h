@@ -18,11 +18,18 @@
 #ifndef itkSpecialCoordinatesImageToVTKStructuredGridFilter_h
 #define itkSpecialCoordinatesImageToVTKStructuredGridFilter_h
 
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
 #include "itkProcessObject.h"
 #include "itkSimpleDataObjectDecorator.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "vtkPoints.h"
 #include "vtkStructuredGrid.h"
 #include "vtkSmartPointer.h"
 
+#include <vector>
+
+class vtkDataArray;
+
 namespace itk
 {
 
@@ -30,6 +37,18 @@ namespace itk
  *
  * \brief Convert an itk::SpecialCoordinatesImage to a vtkStructuredGrid.
  *
+ * The grid points are the physical points of the buffered region, computed
+ * in parallel.  With CachePoints, the default, they are reused for the next
+ * frames while the buffered region and the geometry of the input do not
+ * change, so that only the scalars change between the frames of a cine
+ * loop.  The geometry is the LateralAngularSeparation, RadiusSampleSize and
+ * FirstSampleDistance of a CurvilinearArraySpecialCoordinatesImage, the
+ * slice image and the slice transform parameters of a
+ * SliceSeriesSpecialCoordinatesImage, and the physical points of the
+ * corners and the center of any other SpecialCoordinatesImage.  The scalars or vectors of the grid wrap the
+ * pixel buffer of the input without a copy, so the grid is only valid while
+ * the filter or the input hold that buffer.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage>
@@ -68,6 +87,15 @@ public:
   GetOutput();
   itkGetDecoratedOutputMacro(StructuredGrid, StructuredGridPointerType);
 
+  /** Reuse the grid points while the geometry of the input does not change.
+   * Defaults to true. */
+  itkSetMacro(CachePoints, bool);
+  itkGetConstMacro(CachePoints, bool);
+  itkBooleanMacro(CachePoints);
+
+  /** Number of times the grid points were computed. */
+  itkGetConstMacro(NumberOfPointsBuilds, SizeValueType);
+
 protected:
   SpecialCoordinatesImageToVTKStructuredGridFilter();
   virtual ~SpecialCoordinatesImageToVTKStructuredGridFilter();
@@ -80,8 +108,46 @@ protected:
   virtual void
   GenerateData() override;
 
+  virtual void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
 private:
+  /** Values that identify the geometry of the grid points. */
+  std::vector<double>
+  ComputePointsKey(const InputImageType * image) const;
+
+  /** Append the geometry of an image to a key. */
+  template <unsigned int VDimension>
+  static void
+  AppendGeometryKey(const ImageBase<VDimension> * image, std::vector<double> & key);
+  template <typename TPixel, unsigned int VDimension>
+  static void
+  AppendGeometryKey(const SpecialCoordinatesImage<TPixel, VDimension> * image, std::vector<double> & key);
+  template <typename TPixel, unsigned int VDimension>
+  static void
+  AppendGeometryKey(const CurvilinearArraySpecialCoordinatesImage<TPixel, VDimension> * image,
+                    std::vector<double> &                                               key);
+  template <typename TSliceImage, typename TTransform, typename TPixel, unsigned int VDimension>
+  static void
+  AppendGeometryKey(const SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension> * image,
+                    std::vector<double> &                                                                   key);
+
+  /** Compute the physical points of the buffered region of the input. */
+  void
+  BuildPoints(const InputImageType * image);
+
+  /** Wrap the pixel buffer of an image in a VTK array. */
+  template <typename TArray>
+  static vtkDataArray *
+  WrapPixelBuffer(InputImageType * image, SizeValueType tuples, unsigned int components);
+
   vtkSmartPointer<vtkStructuredGrid> m_StructuredGrid;
+
+  bool                                                m_CachePoints{ true };
+  vtkSmartPointer<vtkPoints>                          m_Points;
+  std::vector<double>                                 m_PointsKey;
+  SizeValueType                                       m_NumberOfPointsBuilds{ 0 };
+  typename InputImageType::PixelContainerConstPointer m_PixelContainer;
 };
 
 } // end namespace itk
@@ -21,8 +21,9 @@
 #include "itkSpecialCoordinatesImageToVTKStructuredGridFilter.h"
 
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMultiThreaderBase.h"
 #include "itkPixelTraits.h"
-#include "itkProgressReporter.h"
+#include "itkUltrasoundTrace.h"
 
 #include "vtkPointData.h"
 #include "vtkNew.h"
@@ -39,7 +40,7 @@
 #include "vtkUnsignedCharArray.h"
 #include "vtkSignedCharArray.h"
 
-#include <cstring>
+#include <typeinfo>
 
 namespace itk
 {
@@ -110,10 +111,190 @@ SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::GetOutput()
 }
 
 
+template <typename TInputImage>
+std::vector<double>
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::ComputePointsKey(const InputImageType * image) const
+{
+  const typename InputImageType::RegionType region = image->GetBufferedRegion();
+  std::vector<double>                       key;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    key.push_back(region.GetIndex(dim));
+    key.push_back(region.GetSize(dim));
+  }
+  AppendGeometryKey(image, key);
+  return key;
+}
+
+
+template <typename TInputImage>
+template <unsigned int VDimension>
+void
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::AppendGeometryKey(const ImageBase<VDimension> * image,
+                                                                                 std::vector<double> &        key)
+{
+  const typename ImageBase<VDimension>::RegionType region = image->GetLargestPossibleRegion();
+  for (unsigned int dim = 0; dim < VDimension; ++dim)
+  {
+    key.push_back(region.GetIndex(dim));
+    key.push_back(region.GetSize(dim));
+    key.push_back(image->GetOrigin()[dim]);
+    key.push_back(image->GetSpacing()[dim]);
+    for (unsigned int column = 0; column < VDimension; ++column)
+    {
+      key.push_back(image->GetDirection()[dim][column]);
+    }
+  }
+}
+
+
+template <typename TInputImage>
+template <typename TPixel, unsigned int VDimension>
+void
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::AppendGeometryKey(
+  const SpecialCoordinatesImage<TPixel, VDimension> * image,
+  std::vector<double> &                               key)
+{
+  // Without the parameters of the geometry, the physical points of the
+  // corners of the buffered region, then of its center.
+  using ImageType = SpecialCoordinatesImage<TPixel, VDimension>;
+  const typename ImageType::RegionType region = image->GetBufferedRegion();
+  typename ImageType::IndexType        index;
+  typename ImageType::PointType        point;
+  for (unsigned int corner = 0; corner <= (1u << VDimension); ++corner)
+  {
+    for (unsigned int dim = 0; dim < VDimension; ++dim)
+    {
+      const IndexValueType extent = static_cast<IndexValueType>(region.GetSize(dim)) - 1;
+      if (corner == (1u << VDimension))
+      {
+        index[dim] = region.GetIndex(dim) + extent / 2;
+      }
+      else
+      {
+        index[dim] = region.GetIndex(dim) + ((corner >> dim) & 1u) * extent;
+      }
+    }
+    image->TransformIndexToPhysicalPoint(index, point);
+    for (unsigned int dim = 0; dim < VDimension; ++dim)
+    {
+      key.push_back(point[dim]);
+    }
+  }
+}
+
+
+template <typename TInputImage>
+template <typename TPixel, unsigned int VDimension>
+void
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::AppendGeometryKey(
+  const CurvilinearArraySpecialCoordinatesImage<TPixel, VDimension> * image,
+  std::vector<double> &                                               key)
+{
+  const typename ImageBase<VDimension>::RegionType region = image->GetLargestPossibleRegion();
+  for (unsigned int dim = 0; dim < VDimension; ++dim)
+  {
+    key.push_back(region.GetIndex(dim));
+    key.push_back(region.GetSize(dim));
+  }
+  key.push_back(image->GetLateralAngularSeparation());
+  key.push_back(image->GetRadiusSampleSize());
+  key.push_back(image->GetFirstSampleDistance());
+}
+
+
+template <typename TInputImage>
+template <typename TSliceImage, typename TTransform, typename TPixel, unsigned int VDimension>
+void
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::AppendGeometryKey(
+  const SliceSeriesSpecialCoordinatesImage<TSliceImage, TTransform, TPixel, VDimension> * image,
+  std::vector<double> &                                                                   key)
+{
+  AppendGeometryKey(image->GetSliceImage(), key);
+
+  const typename ImageBase<VDimension>::RegionType region = image->GetLargestPossibleRegion();
+  const IndexValueType                             firstSlice = region.GetIndex(VDimension - 1);
+  for (SizeValueType ii = 0; ii < region.GetSize(VDimension - 1); ++ii)
+  {
+    const TTransform * transform = image->GetSliceTransform(firstSlice + static_cast<IndexValueType>(ii));
+    if (transform == nullptr)
+    {
+      key.push_back(0.0);
+      continue;
+    }
+    key.push_back(1.0);
+    const typename TTransform::ParametersType &      parameters = transform->GetParameters();
+    const typename TTransform::FixedParametersType & fixedParameters = transform->GetFixedParameters();
+    key.insert(key.end(), parameters.begin(), parameters.end());
+    key.insert(key.end(), fixedParameters.begin(), fixedParameters.end());
+  }
+}
+
+
+template <typename TInputImage>
+void
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::BuildPoints(const InputImageType * image)
+{
+  const typename InputImageType::RegionType region = image->GetBufferedRegion();
+
+  m_Points = vtkSmartPointer<vtkPoints>::New();
+  m_Points->SetDataTypeToDouble();
+  m_Points->SetNumberOfPoints(region.GetNumberOfPixels());
+  double * pointBuffer = static_cast<double *>(m_Points->GetVoidPointer(0));
+
+  // for every line along the first direction, in the order of the pixel
+  // buffer.
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegion<ImageDimension>(
+    region,
+    [image, pointBuffer](const typename InputImageType::RegionType & regionForThread) {
+      typename InputImageType::RegionType lineStartRegion = regionForThread;
+      lineStartRegion.SetSize(0, 1);
+      const SizeValueType                               lineSize = regionForThread.GetSize(0);
+      ImageRegionConstIteratorWithIndex<InputImageType> lineIt(image, lineStartRegion);
+      for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+      {
+        typename InputImageType::IndexType index = lineIt.GetIndex();
+        double * linePoints = pointBuffer + 3 * image->ComputeOffset(index);
+        typename InputImageType::PointType point;
+        for (SizeValueType ii = 0; ii < lineSize; ++ii, ++index[0])
+        {
+          image->TransformIndexToPhysicalPoint(index, point);
+          double * gridPoint = linePoints + 3 * ii;
+          gridPoint[0] = point[0];
+          gridPoint[1] = point[1];
+          gridPoint[2] = ImageDimension > 2 ? point[ImageDimension - 1] : 0.0;
+        }
+      }
+    },
+    this);
+  ++m_NumberOfPointsBuilds;
+}
+
+
+template <typename TInputImage>
+template <typename TArray>
+vtkDataArray *
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::WrapPixelBuffer(InputImageType * image,
+                                                                               SizeValueType    tuples,
+                                                                               unsigned int     components)
+{
+  // The array does not own, and does not delete, the buffer.
+  TArray * array = TArray::New();
+  array->SetNumberOfComponents(components);
+  array->SetArray(reinterpret_cast<typename TArray::ValueType *>(image->GetPixelContainer()->GetBufferPointer()),
+                  static_cast<vtkIdType>(tuples * components),
+                  1);
+  return array;
+}
+
+
 template <typename TInputImage>
 void
 SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::GenerateData()
 {
+  itkUltrasoundTraceScopeMacro("VTKStructuredGridExport");
   this->m_StructuredGrid->PrepareForNewData();
   // Const-cast because there is not (yet) a const version of GetBufferPointer()
   InputImageType * inputImage = const_cast<InputImageType *>(this->GetInput());
@@ -128,21 +309,11 @@ SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::GenerateData()
   }
   this->m_StructuredGrid->SetDimensions(dims);
 
-  vtkNew<vtkPoints> gridPoints;
-  gridPoints->SetDataTypeToDouble();
-  gridPoints->SetNumberOfPoints(region.GetNumberOfPixels());
-
-  ProgressReporter progress(this, 0, region.GetNumberOfPixels());
-
-  ImageRegionConstIteratorWithIndex<InputImageType> imageIt(inputImage, region);
-  imageIt.GoToBegin();
-  for (SizeValueType ii = 0; !imageIt.IsAtEnd(); ++imageIt, ++ii)
+  std::vector<double> pointsKey = this->ComputePointsKey(inputImage);
+  if (!m_CachePoints || m_Points.GetPointer() == nullptr || pointsKey != m_PointsKey)
   {
-    const typename InputImageType::IndexType & index = imageIt.GetIndex();
-    typename InputImageType::PointType         point;
-    inputImage->TransformIndexToPhysicalPoint(index, point);
-    gridPoints->SetPoint(ii, point.GetVnlVector().data_block());
-    progress.CompletedPixel();
+    this->BuildPoints(inputImage);
+    m_PointsKey.swap(pointsKey);
   }
 
 
@@ -153,108 +324,50 @@ SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::GenerateData()
   const SizeValueType tuples = region.GetNumberOfPixels();
   if (typeid(ScalarType) == typeid(double))
   {
-    vtkDoubleArray * array = vtkDoubleArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(double));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkDoubleArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(float))
   {
-    vtkFloatArray * array = vtkFloatArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(float));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkFloatArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(long))
   {
-    vtkLongArray * array = vtkLongArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(long));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkLongArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(unsigned long))
   {
-    vtkUnsignedLongArray * array = vtkUnsignedLongArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(unsigned long));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkUnsignedLongArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(int))
   {
-    vtkIntArray * array = vtkIntArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(int));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkIntArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(unsigned int))
   {
-    vtkUnsignedIntArray * array = vtkUnsignedIntArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(unsigned int));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkUnsignedIntArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(short))
   {
-    vtkShortArray * array = vtkShortArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(short));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkShortArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(unsigned short))
   {
-    vtkUnsignedShortArray * array = vtkUnsignedShortArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(unsigned short));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkUnsignedShortArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(unsigned char))
   {
-    vtkUnsignedCharArray * array = vtkUnsignedCharArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(unsigned char));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkUnsignedCharArray>(inputImage, tuples, components);
   }
   else if (typeid(ScalarType) == typeid(signed char))
   {
-    vtkSignedCharArray * array = vtkSignedCharArray::New();
-    array->SetNumberOfComponents(components);
-    array->SetNumberOfTuples(tuples);
-    std::memcpy(array->GetVoidPointer(0),
-                reinterpret_cast<void *>(inputImage->GetPixelContainer()->GetBufferPointer()),
-                tuples * components * sizeof(signed char));
-    pointDataArray = array;
+    pointDataArray = WrapPixelBuffer<vtkSignedCharArray>(inputImage, tuples, components);
   }
   else
   {
     itkExceptionMacro(<< "Type currently not supported");
   }
+  // Hold the buffer that the array wraps.
+  m_PixelContainer = inputImage->GetPixelContainer();
 
   if (components == 1)
   {
@@ -268,7 +381,18 @@ SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::GenerateData()
   }
   pointDataArray->Delete();
 
-  this->m_StructuredGrid->SetPoints(gridPoints.GetPointer());
+  this->m_StructuredGrid->SetPoints(m_Points);
+}
+
+
+template <typename TInputImage>
+void
+SpecialCoordinatesImageToVTKStructuredGridFilter<TInputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "CachePoints: " << (m_CachePoints ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfPointsBuilds: " << m_NumberOfPointsBuilds << std::endl;
 }
 
 } // end namespace itk
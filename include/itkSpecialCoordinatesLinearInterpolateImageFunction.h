@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSpecialCoordinatesLinearInterpolateImageFunction_h
+#define itkSpecialCoordinatesLinearInterpolateImageFunction_h
+
+#include "itkInterpolateImageFunction.h"
+#include "itkMath.h"
+
+namespace itk
+{
+
+/** \class SpecialCoordinatesLinearInterpolateImageFunction
+ * \brief Linearly interpolate a CurvilinearArraySpecialCoordinatesImage or
+ * a SliceSeriesSpecialCoordinatesImage in its index space.
+ *
+ * The weights are computed in the native sampling of the image, e.g. the
+ * radius, the angle and the slice, as with a LinearInterpolateImageFunction.
+ * The neighbors are read from the pixel buffer at offsets computed once per
+ * input image.  Continuous indices that are known to be inside the image,
+ * e.g. precomputed with the batched transforms of the image, may be
+ * evaluated with EvaluateAtInteriorContinuousIndex(), which does not clamp
+ * the neighbors to the buffer, or with EvaluateAtContinuousIndices().
+ *
+ * The results are the ones of a LinearInterpolateImageFunction.
+ *
+ * \sa CurvilinearArraySpecialCoordinatesImage
+ * \sa SliceSeriesSpecialCoordinatesImage
+ * \sa LinearInterpolateImageFunction
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TInputImage, typename TCoordRep = double>
+class ITK_TEMPLATE_EXPORT SpecialCoordinatesLinearInterpolateImageFunction
+  : public InterpolateImageFunction<TInputImage, TCoordRep>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SpecialCoordinatesLinearInterpolateImageFunction);
+
+  /** Standard class type alias. */
+  using Self = SpecialCoordinatesLinearInterpolateImageFunction;
+  using Superclass = InterpolateImageFunction<TInputImage, TCoordRep>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SpecialCoordinatesLinearInterpolateImageFunction, InterpolateImageFunction);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, Superclass::ImageDimension);
+
+  using OutputType = typename Superclass::OutputType;
+  using InputImageType = typename Superclass::InputImageType;
+  using InputPixelType = typename Superclass::InputPixelType;
+  using RealType = typename Superclass::RealType;
+  using IndexType = typename Superclass::IndexType;
+  using ContinuousIndexType = typename Superclass::ContinuousIndexType;
+  using SizeType = typename InputImageType::SizeType;
+
+  void
+  SetInputImage(const InputImageType * image) override;
+
+  /** Interpolate at a continuous index.  The neighbors outside of the
+   * buffer are clamped to it. */
+  OutputType
+  EvaluateAtContinuousIndex(const ContinuousIndexType & index) const override
+  {
+    if (this->IsInsideInterior(index))
+    {
+      return this->EvaluateAtInteriorContinuousIndex(index);
+    }
+    return this->EvaluateAtBoundaryContinuousIndex(index);
+  }
+
+  /** Whether all of the neighbors of a continuous index are in the buffer. */
+  bool
+  IsInsideInterior(const ContinuousIndexType & index) const
+  {
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      // false for NaN
+      if (!(index[dim] >= this->m_StartIndex[dim] && index[dim] < this->m_EndIndex[dim]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** Interpolate at a continuous index for which IsInsideInterior() is
+   * true, without bounds checks. */
+  OutputType
+  EvaluateAtInteriorContinuousIndex(const ContinuousIndexType & index) const
+  {
+    const InputImageType * image = this->GetInputImage();
+    IndexType              baseIndex;
+    double                 distance[ImageDimension];
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      baseIndex[dim] = Math::Floor<IndexValueType>(index[dim]);
+      distance[dim] = index[dim] - static_cast<double>(baseIndex[dim]);
+    }
+    const InputPixelType * basePixel = image->GetBufferPointer() + image->ComputeOffset(baseIndex);
+
+    RealType value = NumericTraits<RealType>::ZeroValue();
+    for (unsigned int neighbor = 0; neighbor < NumberOfNeighbors; ++neighbor)
+    {
+      double weight = 1.0;
+      for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+      {
+        weight *= ((neighbor >> dim) & 1u) ? distance[dim] : 1.0 - distance[dim];
+      }
+      value += static_cast<RealType>(basePixel[m_NeighborOffsets[neighbor]]) * weight;
+    }
+    return static_cast<OutputType>(value);
+  }
+
+  /** Interpolate at many continuous indices, e.g. the ones of an output line
+   * from TransformPhysicalPointsToContinuousIndices(). */
+  void
+  EvaluateAtContinuousIndices(const ContinuousIndexType * indices,
+                              OutputType *                values,
+                              SizeValueType               numberOfIndices) const;
+
+#if ITK_VERSION_MAJOR > 5 || (ITK_VERSION_MAJOR == 5 && ITK_VERSION_MINOR >= 1)
+  SizeType
+  GetRadius() const override
+  {
+    return SizeType::Filled(1);
+  }
+#endif
+
+protected:
+  SpecialCoordinatesLinearInterpolateImageFunction();
+  ~SpecialCoordinatesLinearInterpolateImageFunction() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Number of pixels blended. */
+  static constexpr unsigned int NumberOfNeighbors = 1u << ImageDimension;
+
+  OutputType
+  EvaluateAtBoundaryContinuousIndex(const ContinuousIndexType & index) const;
+
+  /** Offsets of the neighbors from the one with the smallest index in the
+   * buffer. */
+  OffsetValueType m_NeighborOffsets[NumberOfNeighbors];
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSpecialCoordinatesLinearInterpolateImageFunction.hxx"
+#endif
+
+#endif // itkSpecialCoordinatesLinearInterpolateImageFunction_h
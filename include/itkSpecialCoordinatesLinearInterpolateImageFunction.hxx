@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSpecialCoordinatesLinearInterpolateImageFunction_hxx
+#define itkSpecialCoordinatesLinearInterpolateImageFunction_hxx
+
+#include "itkSpecialCoordinatesLinearInterpolateImageFunction.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TCoordRep>
+SpecialCoordinatesLinearInterpolateImageFunction<TInputImage, TCoordRep>::SpecialCoordinatesLinearInterpolateImageFunction()
+{
+  std::fill(m_NeighborOffsets, m_NeighborOffsets + NumberOfNeighbors, 0);
+}
+
+
+template <typename TInputImage, typename TCoordRep>
+void
+SpecialCoordinatesLinearInterpolateImageFunction<TInputImage, TCoordRep>::SetInputImage(const InputImageType * image)
+{
+  Superclass::SetInputImage(image);
+
+  if (image == nullptr)
+  {
+    return;
+  }
+  const OffsetValueType * offsetTable = image->GetOffsetTable();
+  for (unsigned int neighbor = 0; neighbor < NumberOfNeighbors; ++neighbor)
+  {
+    m_NeighborOffsets[neighbor] = 0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      if ((neighbor >> dim) & 1u)
+      {
+        m_NeighborOffsets[neighbor] += offsetTable[dim];
+      }
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TCoordRep>
+auto
+SpecialCoordinatesLinearInterpolateImageFunction<TInputImage, TCoordRep>::EvaluateAtBoundaryContinuousIndex(
+  const ContinuousIndexType & index) const -> OutputType
+{
+  const InputImageType * image = this->GetInputImage();
+  IndexType              lowerIndex;
+  IndexType              upperIndex;
+  double                 distance[ImageDimension];
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    const IndexValueType baseIndex = Math::Floor<IndexValueType>(index[dim]);
+    distance[dim] = index[dim] - static_cast<double>(baseIndex);
+    lowerIndex[dim] = std::max(std::min(baseIndex, this->m_EndIndex[dim]), this->m_StartIndex[dim]);
+    upperIndex[dim] = std::max(std::min(baseIndex + 1, this->m_EndIndex[dim]), this->m_StartIndex[dim]);
+  }
+
+  RealType  value = NumericTraits<RealType>::ZeroValue();
+  IndexType neighborIndex;
+  for (unsigned int neighbor = 0; neighbor < NumberOfNeighbors; ++neighbor)
+  {
+    double weight = 1.0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      const bool upper = (neighbor >> dim) & 1u;
+      weight *= upper ? distance[dim] : 1.0 - distance[dim];
+      neighborIndex[dim] = upper ? upperIndex[dim] : lowerIndex[dim];
+    }
+    value += static_cast<RealType>(image->GetPixel(neighborIndex)) * weight;
+  }
+  return static_cast<OutputType>(value);
+}
+
+
+template <typename TInputImage, typename TCoordRep>
+void
+SpecialCoordinatesLinearInterpolateImageFunction<TInputImage, TCoordRep>::EvaluateAtContinuousIndices(
+  const ContinuousIndexType * indices,
+  OutputType *                values,
+  SizeValueType               numberOfIndices) const
+{
+  for (SizeValueType ii = 0; ii < numberOfIndices; ++ii)
+  {
+    values[ii] = this->IsInsideInterior(indices[ii]) ? this->EvaluateAtInteriorContinuousIndex(indices[ii])
+                                                     : this->EvaluateAtBoundaryContinuousIndex(indices[ii]);
+  }
+}
+
+
+template <typename TInputImage, typename TCoordRep>
+void
+SpecialCoordinatesLinearInterpolateImageFunction<TInputImage, TCoordRep>::PrintSelf(std::ostream & os,
+                                                                                    Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NeighborOffsets:";
+  for (unsigned int neighbor = 0; neighbor < NumberOfNeighbors; ++neighbor)
+  {
+    os << ' ' << m_NeighborOffsets[neighbor];
+  }
+  os << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSpecialCoordinatesLinearInterpolateImageFunction_hxx
@@ -100,6 +100,26 @@ public:
   PixelType
   ComputeDiffusionCoefficient(PixelType intensity, PixelType averageGradient, PixelType laplacian);
 
+  /** Compute the diffusion coefficient with the given speckle scale
+   * function value q0(t). */
+  static PixelType
+  ComputeDiffusionCoefficient(PixelType intensity, PixelType averageGradient, PixelType laplacian, PixelType q0_t);
+
+  /** Compute the diffusion coefficient from the squared gradient magnitude,
+   * with all the arithmetic in TComputation and without branches or square
+   * roots, so that a loop over contiguous samples can be vectorized. */
+  template <typename TComputation>
+  static TComputation
+  ComputeDiffusionCoefficient(TComputation intensity,
+                              TComputation squaredGradient,
+                              TComputation laplacian,
+                              TComputation q0_t);
+
+  /** Compute the speckle scale function q0(t) at the given iteration, with
+   * the current Q0, Rho and time step. */
+  PixelType
+  ComputeSpeckleScale(IdentifierType iteration) const;
+
   /** Set/Get the rho parameter used in calculating the
    *  speckle scale function q_0(t). */
   void
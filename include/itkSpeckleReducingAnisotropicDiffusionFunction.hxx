@@ -82,7 +82,14 @@ SpeckleReducingAnisotropicDiffusionFunction<TImage>::InitializeIteration()
 
   // Estimate q0(t) according to Yu,Acton (37)
   // where t := (n+1) * delta_t
-  m_q0_t = static_cast<PixelType>(m_q0 * std::exp(-1.0f * m_rho * this->GetTimeStep() * (m_ElapsedIterationCount + 1)));
+  m_q0_t = this->ComputeSpeckleScale(m_ElapsedIterationCount);
+}
+
+template <typename TImage>
+typename SpeckleReducingAnisotropicDiffusionFunction<TImage>::PixelType
+SpeckleReducingAnisotropicDiffusionFunction<TImage>::ComputeSpeckleScale(IdentifierType iteration) const
+{
+  return static_cast<PixelType>(m_q0 * std::exp(-1.0f * m_rho * this->GetTimeStep() * (iteration + 1)));
 }
 
 template <typename TImage>
@@ -90,6 +97,16 @@ typename SpeckleReducingAnisotropicDiffusionFunction<TImage>::PixelType
 SpeckleReducingAnisotropicDiffusionFunction<TImage>::ComputeDiffusionCoefficient(PixelType intensity,
                                                                                  PixelType averageGradient,
                                                                                  PixelType laplacian)
+{
+  return ComputeDiffusionCoefficient(intensity, averageGradient, laplacian, m_q0_t);
+}
+
+template <typename TImage>
+typename SpeckleReducingAnisotropicDiffusionFunction<TImage>::PixelType
+SpeckleReducingAnisotropicDiffusionFunction<TImage>::ComputeDiffusionCoefficient(PixelType intensity,
+                                                                                 PixelType averageGradient,
+                                                                                 PixelType laplacian,
+                                                                                 PixelType q0_t)
 {
   // Epsilon to avoid divide-by-zero errors
   const float eps = itk::Math::eps;
@@ -112,11 +129,37 @@ SpeckleReducingAnisotropicDiffusionFunction<TImage>::ComputeDiffusionCoefficient
 
   // Compute diffusion coefficient.
   // See (33) in Yu, Acton.
-  PixelRealType C = 1 / (1 + (itk::Math::sqr(q_t) - itk::Math::sqr(m_q0_t)) /
-                               (itk::Math::sqr(m_q0_t) * (1 + itk::Math::sqr(m_q0_t)) + eps));
+  PixelRealType C = 1 / (1 + (itk::Math::sqr(q_t) - itk::Math::sqr(q0_t)) /
+                               (itk::Math::sqr(q0_t) * (1 + itk::Math::sqr(q0_t)) + eps));
   return C;
 }
 
+template <typename TImage>
+template <typename TComputation>
+TComputation
+SpeckleReducingAnisotropicDiffusionFunction<TImage>::ComputeDiffusionCoefficient(TComputation intensity,
+                                                                                 TComputation squaredGradient,
+                                                                                 TComputation laplacian,
+                                                                                 TComputation q0_t)
+{
+  const TComputation eps = static_cast<TComputation>(static_cast<float>(itk::Math::eps));
+  const TComputation one = 1;
+
+  // Squared instantaneous coefficient of variation, see (35) in Yu, Acton,
+  // with only its real values.
+  const TComputation inverseIntensity = one / (intensity + eps);
+  const TComputation inverseIntensity2 = inverseIntensity * inverseIntensity;
+  const TComputation normalizedLaplacian = static_cast<TComputation>(0.25) * laplacian * inverseIntensity;
+  const TComputation gradientTerm = static_cast<TComputation>(0.5) * squaredGradient * inverseIntensity2;
+  const TComputation numerator = gradientTerm - normalizedLaplacian * normalizedLaplacian;
+  const TComputation denominator = (one + normalizedLaplacian) * (one + normalizedLaplacian);
+  const TComputation q_t2 = (numerator < 0 ? static_cast<TComputation>(0) : numerator) / denominator;
+
+  // See (33) in Yu, Acton.
+  const TComputation q0_t2 = q0_t * q0_t;
+  return one / (one + (q_t2 - q0_t2) / (q0_t2 * (one + q0_t2) + eps));
+}
+
 template <typename TImage>
 typename SpeckleReducingAnisotropicDiffusionFunction<TImage>::PixelType
 SpeckleReducingAnisotropicDiffusionFunction<TImage>::ComputeUpdate(const NeighborhoodType & it,
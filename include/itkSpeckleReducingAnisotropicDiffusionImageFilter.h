@@ -21,6 +21,8 @@
 #include "itkAnisotropicDiffusionImageFilter.h"
 #include "itkSpeckleReducingAnisotropicDiffusionFunction.h"
 
+#include <type_traits>
+
 namespace itk
 {
 /** \class SpeckleReducingAnisotropicDiffusionImageFilter
@@ -40,6 +42,16 @@ namespace itk
  * Please see the description of parameters given in
  * itkAnisotropicDiffusionImageFilter.
  *
+ * \par Fused solver
+ * With FusedOn(), the iterations are run by a specialized solver instead of
+ * the generic finite difference pipeline.  The image is split in tiles of
+ * lines along the second direction, and the diffusion coefficients and the
+ * update of a tile are computed in a single pass over per work unit
+ * scratch buffers.  Each tile, enlarged by a halo of two lines per
+ * iteration, is advanced by IterationsPerPass iterations while it stays in
+ * cache, so the full image is read and written once per IterationsPerPass
+ * iterations.  The fused solver requires a 2D image.
+ *
  * \sa AnisotropicDiffusionImageFilter
  * \sa AnisotropicDiffusionFunction
  * \sa SpeckleReducingAnisotropicDiffusionFunction
@@ -85,10 +97,23 @@ public:
   itkSetMacro(Q0, double);
   itkGetConstMacro(Q0, double);
 
+  /** When on, run the fused, tiled solver.  Off by default. */
+  itkSetMacro(Fused, bool);
+  itkGetConstMacro(Fused, bool);
+  itkBooleanMacro(Fused);
+
+  /** Set/Get the number of iterations applied to a tile in each pass of the
+   * fused solver.  Larger values read the image less often at the cost of
+   * larger halos.  Default is 4. */
+  itkSetClampMacro(IterationsPerPass, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(IterationsPerPass, unsigned int);
+
 protected:
   SpeckleReducingAnisotropicDiffusionImageFilter()
     : m_Q0(1.0)
     , m_Rho(0.2)
+    , m_Fused(false)
+    , m_IterationsPerPass(4)
   {
     typename SpeckleReducingAnisotropicDiffusionFunction<UpdateBufferType>::Pointer p =
       SpeckleReducingAnisotropicDiffusionFunction<UpdateBufferType>::New();
@@ -97,6 +122,40 @@ protected:
 
   ~SpeckleReducingAnisotropicDiffusionImageFilter() override = default;
 
+  using FunctionType = SpeckleReducingAnisotropicDiffusionFunction<UpdateBufferType>;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using PixelType = typename OutputImageType::PixelType;
+  using PixelRealType = typename NumericTraits<PixelType>::RealType;
+
+  /** The fused solver computes in single precision for float images, so
+   * that twice as many samples fit in a vector register, and in the real
+   * type of the pixel otherwise. */
+  using ComputeType = typename std::conditional<std::is_same<PixelType, float>::value, float, PixelRealType>::type;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateData() override;
+
+  /** Iterations of the fused solver, used when Fused is on. */
+  void
+  FusedGenerateData();
+
+  /** Advance the lines [0, numberOfLines) of a tile, stored contiguously
+   * with lineLength samples per line, by one iteration from current to next.
+   * The first and last samples and lines are not updated.  The inner loops
+   * over the samples of a line have no branches, so that they vectorize. */
+  static void
+  FusedIteration(const PixelType *   current,
+                 PixelType *         next,
+                 ComputeType *       coefficients,
+                 SizeValueType       lineLength,
+                 SizeValueType       numberOfLines,
+                 ComputeType         q0_t,
+                 const ComputeType * scales,
+                 ComputeType         timeStep);
+
   /** Prepare for the iteration process. */
   void
   InitializeIteration() override
@@ -121,7 +180,14 @@ protected:
   /** Speckle coefficient of variation in the given image.
    *  Unity (1) assumed unless user specifies otherwise. */
   double m_Q0;
+
+  bool         m_Fused;
+  unsigned int m_IterationsPerPass;
 };
 } // namespace itk
 
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSpeckleReducingAnisotropicDiffusionImageFilter.hxx"
+#endif
+
 #endif
@@ -0,0 +1,202 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSpectra1DCompactSupportWindow_h
+#define itkSpectra1DCompactSupportWindow_h
+
+#include <iterator>
+#include <ostream>
+
+#include "itkIndex.h"
+#include "itkMacro.h"
+
+namespace itk
+{
+
+/** \class Spectra1DCompactSupportWindow
+ * \brief Support window of a local spectrum, encoded as a range of lines.
+ *
+ * The lines of a support window generated by
+ * Spectra1DSupportWindowImageFilter are consecutive along the lateral,
+ * first, dimension and all start at the same axial index.  This pixel type
+ * stores them as the index of the first line, whose zeroth component is the
+ * axial start, and the number of lines, instead of a std::list of indices
+ * with a heap node per line.  It is trivially copyable, so an image of
+ * support windows can be copied or serialized as a flat buffer.
+ *
+ * It provides the subset of the std::list interface used by the Spectra1D
+ * filters, with the lines of the window computed on the fly by the
+ * iterators, so that
+ * Spectra1DSupportWindowImageFilter< TInputImage, Spectra1DCompactSupportWindow< Dimension > >
+ * can be used in place of the default support window image.
+ *
+ * \ingroup Ultrasound
+ *
+ * \sa Spectra1DSupportWindowImageFilter
+ * \sa Spectra1DImageFilter
+ */
+template <unsigned int VDimension>
+struct Spectra1DCompactSupportWindow
+{
+  using IndexType = Index<VDimension>;
+  using value_type = IndexType;
+  using size_type = SizeValueType;
+
+  /** Index of the first line of the window. */
+  IndexType FirstLine;
+  /** Number of lines of the window. */
+  SizeValueType NumberOfLines;
+
+  /** Iterate over the lines of the window. */
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = IndexType;
+    using difference_type = OffsetValueType;
+    using pointer = const IndexType *;
+    using reference = IndexType;
+
+    const_iterator() = default;
+    explicit const_iterator(const IndexType & line)
+      : m_Line(line)
+    {}
+
+    IndexType
+    operator*() const
+    {
+      return m_Line;
+    }
+
+    const_iterator &
+    operator++()
+    {
+      ++m_Line[1];
+      return *this;
+    }
+
+    const_iterator
+    operator++(int)
+    {
+      const_iterator previous = *this;
+      ++m_Line[1];
+      return previous;
+    }
+
+    bool
+    operator==(const const_iterator & other) const
+    {
+      return m_Line == other.m_Line;
+    }
+
+    bool
+    operator!=(const const_iterator & other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    IndexType m_Line;
+  };
+
+  const_iterator
+  begin() const
+  {
+    return const_iterator(FirstLine);
+  }
+
+  const_iterator
+  end() const
+  {
+    IndexType last = FirstLine;
+    last[1] += static_cast<IndexValueType>(NumberOfLines);
+    return const_iterator(last);
+  }
+
+  SizeValueType
+  size() const
+  {
+    return NumberOfLines;
+  }
+
+  bool
+  empty() const
+  {
+    return NumberOfLines == 0;
+  }
+
+  IndexType
+  front() const
+  {
+    return FirstLine;
+  }
+
+  IndexType
+  back() const
+  {
+    IndexType last = FirstLine;
+    last[1] += static_cast<IndexValueType>(NumberOfLines) - 1;
+    return last;
+  }
+
+  void
+  clear()
+  {
+    FirstLine.Fill(0);
+    NumberOfLines = 0;
+  }
+
+  /** Append a line, which must follow the last line of the window along the
+   * lateral dimension. */
+  void
+  push_back(const IndexType & line)
+  {
+    if (NumberOfLines == 0)
+    {
+      FirstLine = line;
+    }
+    else
+    {
+      itkAssertInDebugAndIgnoreInReleaseMacro(line[1] == FirstLine[1] + static_cast<IndexValueType>(NumberOfLines));
+    }
+    ++NumberOfLines;
+  }
+
+  bool
+  operator==(const Spectra1DCompactSupportWindow & other) const
+  {
+    return NumberOfLines == other.NumberOfLines && (NumberOfLines == 0 || FirstLine == other.FirstLine);
+  }
+
+  bool
+  operator!=(const Spectra1DCompactSupportWindow & other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <unsigned int VDimension>
+std::ostream &
+operator<<(std::ostream & os, const Spectra1DCompactSupportWindow<VDimension> & window)
+{
+  os << "[" << window.FirstLine << ", " << window.NumberOfLines << "]";
+  return os;
+}
+
+} // end namespace itk
+
+#endif // itkSpectra1DCompactSupportWindow_h
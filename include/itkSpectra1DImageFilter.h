@@ -18,17 +18,23 @@
 #ifndef itkSpectra1DImageFilter_h
 #define itkSpectra1DImageFilter_h
 
+#include "UltrasoundExport.h"
 #include "itkImageToImageFilter.h"
 #include "itkDefaultConvertPixelTraits.h"
+#include "itkHalfPrecision.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkVector.h"
+#include "itkVectorImage.h"
 
-#include "vnl/algo/vnl_fft_base.h"
-#include "vnl/algo/vnl_fft_1d.h"
+#include "itkComplexToComplex1DLineTransform.h"
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
 #include <utility>
 
-#include <unordered_map>
-
 #include "itkSpectra1DSupportWindowImageFilter.h"
 
 namespace itk
@@ -47,8 +53,43 @@ namespace itk
  * averaged with adjacent local beam lines. Pixel vector values correspond to frequency
  * bins on the range (0,nyquist] with DC content discarded.
  *
- * FFT is computed in each support window using a Hamming window. A reference spectra
- * image may be provided to compensate for system noise.
+ * The spectrum of each line is estimated with Welch's method: by default, 3
+ * segments of half the FFT1DSize, each a third of a segment after the
+ * previous one, are windowed with a Hamming window and their periodograms
+ * are averaged.  The number of segments, their overlap and the window are
+ * configurable; the segments must fit in the FFT1DSize samples of the line.
+ * A reference spectra image may be provided to compensate for system noise.
+ *
+ * When the output pixel type is a Vector of 3 components, the output is
+ * the least squares line fit of the selected frequency bins of each
+ * spectrum instead of the spectrum: its slope, its intercept at zero
+ * frequency and its value at the center frequency of the bins, the midband
+ * fit.  The fit is computed on the fly, so the spectra are never stored.
+ * The frequency of a bin is its index, DC being 0, over the segment length,
+ * times the SamplingFrequency.  Turn DecibelOutput on to fit the spectra in
+ * decibels, as is usual for spectral parameters.
+ *
+ * The spectra may be stored in half precision, as a VectorImage of Float16
+ * or BFloat16, to halve the memory of the output.  They are computed in
+ * float and rounded as they are stored; the reference spectra stay float.
+ *
+ * The transforms are set up once per work unit and reused for every segment
+ * of every line; FFTW is used when it is available for the output component
+ * type, unless UseFFTW is turned off.
+ *
+ * With DynamicMultiThreadingOn(), the output is split into
+ * NumberOfWorkUnits chunks along the slowest, lateral or elevational,
+ * dimensions that the threads pick up as they become idle, which balances
+ * the uneven cost of the truncated windows near the image edges.  Use
+ * several times as many work units as threads.  The scratch data of the
+ * chunks is recycled through a pool, so it is only allocated about once per
+ * thread.  Dynamic multi-threading is off by default.
+ *
+ * The filter streams.  A requested output region only requires the support
+ * windows and reference spectra of the same region, and the input samples
+ * along the beam that their windows span.  Since the lines of the windows
+ * are given by the side lines values of the support window pipeline, all
+ * the input lines are requested, limited to that range of samples.
  *
  * This filter expects that beam input lies along the zeroth dimension and lateral lines
  * lie along the first dimension. Images not matching this description may be permuted
@@ -71,7 +112,25 @@ public:
   using SupportWindowImageType = TSupportWindowImage;
   using OutputImageType = TOutputImage;
 
-  using ScalarType = typename DefaultConvertPixelTraits<typename OutputImageType::PixelType>::ComponentType;
+  /** The output components, and the type in which they are computed, float
+   * for half precision components. */
+  using OutputComponentType = typename DefaultConvertPixelTraits<typename OutputImageType::PixelType>::ComponentType;
+  using ScalarType = typename HalfPrecisionTraits<OutputComponentType>::ValueType;
+
+  /** Whether the output spectra are stored in half precision. */
+  static constexpr bool HalfPrecisionOutput = HalfPrecisionTraits<OutputComponentType>::IsHalfPrecision;
+
+  /** Image of the reference spectra, and of the output spectra unless they
+   * are stored in half precision or the output holds line fits. */
+  using SpectraImageType = VectorImage<ScalarType, ImageDimension>;
+
+  /** Whether the output pixels are (slope, intercept, midband fit) line
+   * fits of the spectra. */
+  static constexpr bool LinearFitOutput =
+    std::is_same<typename OutputImageType::PixelType, Vector<ScalarType, 3>>::value;
+  static_assert(LinearFitOutput ||
+                  std::is_same<OutputImageType, VectorImage<OutputComponentType, ImageDimension>>::value,
+                "The output must be an image of spectra or of 3 component line fits");
 
   /** Standard class type alias. */
   using Self = Spectra1DImageFilter;
@@ -88,57 +147,244 @@ public:
   itkGetInputMacro(SupportWindowImage, SupportWindowImageType);
 
   /** Set/get an optional reference spectra image use to normalize the
-   * output, such as from a phantom image.*/
-  itkSetInputMacro(ReferenceSpectraImage, OutputImageType);
-  itkGetInputMacro(ReferenceSpectraImage, OutputImageType);
+   * output, such as from a phantom image.  It has either all the frequency
+   * bins, or only the ones of the output.*/
+  itkSetInputMacro(ReferenceSpectraImage, SpectraImageType);
+  itkGetInputMacro(ReferenceSpectraImage, SpectraImageType);
+
+  /** Window applied to every segment before its transform. */
+  using WindowType = enum { HAMMING_WINDOW = 0, HANN_WINDOW, BLACKMAN_HARRIS_WINDOW, TUKEY_WINDOW };
+  itkSetMacro(Window, WindowType);
+  itkGetConstMacro(Window, WindowType);
+
+  /** Ratio of the tapered part of the Tukey window to its length, between
+   * 0, a rectangular window, and 1, a Hann window.  0.5 by default. */
+  itkSetClampMacro(TukeyAlpha, double, 0.0, 1.0);
+  itkGetConstMacro(TukeyAlpha, double);
+
+  /** Number of segments averaged for each line.  3 by default. */
+  itkSetClampMacro(NumberOfSegments, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfSegments, unsigned int);
+
+  /** Fraction of a segment shared by consecutive segments, in [0, 1).  The
+   * default, 2/3, starts a segment every third of a segment. */
+  itkSetMacro(SegmentOverlap, double);
+  itkGetConstMacro(SegmentOverlap, double);
+
+  /** When on, all the segments of a line are transformed by one batched
+   * transform instead of one transform per segment.  Off by default. */
+  itkSetMacro(Batched, bool);
+  itkGetConstMacro(Batched, bool);
+  itkBooleanMacro(Batched);
+
+  /** Select the frequency bins of the output, counted from the first bin
+   * after DC.  NumberOfFrequencyBins, 0 by default, is the number of bins
+   * after FirstFrequencyBin, 0 for all the bins up to Nyquist.  Only the
+   * selected bins are computed and stored. */
+  itkSetMacro(FirstFrequencyBin, unsigned int);
+  itkGetConstMacro(FirstFrequencyBin, unsigned int);
+  itkSetMacro(NumberOfFrequencyBins, unsigned int);
+  itkGetConstMacro(NumberOfFrequencyBins, unsigned int);
+
+  /** When on, the output is 10 log10 of the, optionally normalized, power
+   * spectra.  Off by default. */
+  itkSetMacro(DecibelOutput, bool);
+  itkGetConstMacro(DecibelOutput, bool);
+  itkBooleanMacro(DecibelOutput);
+
+  /** Sampling frequency of the input lines, which sets the frequency unit
+   * of the line fits.  1 by default, for frequencies in cycles per
+   * sample. */
+  itkSetMacro(SamplingFrequency, double);
+  itkGetConstMacro(SamplingFrequency, double);
+
+  /** When on, the periodogram of every segment is kept until the next row
+   * of output pixels is computed, and the segments that consecutive output
+   * pixels along the beam share are only transformed once.  Segments are
+   * shared when the axial step of the support windows is a multiple of the
+   * segment hop, (1 - SegmentOverlap) times half the FFT1DSize.  Off by
+   * default. */
+  itkSetMacro(ReuseSegments, bool);
+  itkGetConstMacro(ReuseSegments, bool);
+  itkBooleanMacro(ReuseSegments);
+
+  /** Compute the transforms with FFTW when ITK was built with FFTW for the
+   * output component type, with the VNL FFT otherwise.  On by default. */
+  itkSetMacro(UseFFTW, bool);
+  itkGetConstMacro(UseFFTW, bool);
+  itkBooleanMacro(UseFFTW);
+
+  /** Estimate, in bytes, the memory that an update of the given output
+   * region allocates: the output, the windows, and the scratch data of every
+   * work unit, i.e. the transform buffers and the spectra of the lines and
+   * segments of a window.  The support windows are assumed to span at most
+   * all the input lines, so the scratch data is an upper bound.  The inputs,
+   * including the support window image, are not counted, and nothing is
+   * computed. */
+  SizeValueType
+  EstimateMemoryFootprint(const typename OutputImageType::RegionType & region) const;
+
+  /** Estimate the memory footprint of an update of the largest possible
+   * region, after updating the output information. */
+  SizeValueType
+  EstimateMemoryFootprint();
+
+  /** Run the filter once on an input with the geometry of the given image,
+   * whose pixels are not read, and the current support window image, so
+   * that the first frame of that geometry runs at the speed of the
+   * following ones: the transforms of the work units are planned, the
+   * window tables filled and the output allocated by this update.  The
+   * input is restored, and the output holds the warmup spectra until the
+   * next update. */
+  void
+  Prepare(const InputImageType * geometry);
 
 protected:
   Spectra1DImageFilter();
   virtual ~Spectra1DImageFilter(){};
 
   using OutputImageRegionType = typename OutputImageType::RegionType;
+  using SpectraVectorType = std::vector<ScalarType>;
+  using IndexType = typename InputImageType::IndexType;
+  using SupportWindowType = typename SupportWindowImageType::PixelType;
+
+  using Spectra1DSupportWindowFilterType = Spectra1DSupportWindowImageFilter<InputImageType>;
+  using FFT1DSizeType = typename Spectra1DSupportWindowFilterType::FFT1DSizeType;
 
   void
   GenerateOutputInformation() override;
   void
+  GenerateInputRequestedRegion() override;
+  void
   BeforeThreadedGenerateData() override;
   void
   ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
   void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+  void
   VerifyInputInformation() const override;
 
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Validate the parameters and prepare what the spectra estimation of all
+   * the output pixels shares: the segment window, the lateral windows of the
+   * support windows of the requested region, the line fit weights and the
+   * components of the reference spectra. */
+  void
+  PrepareSpectraEstimation();
+
+  /** Number of frequency bins of the output for the given FFT1DSize. */
+  FFT1DSizeType
+  GetNumberOfOutputFrequencyBins(FFT1DSizeType fft1DSize) const;
+
+  /** The shared data of the current update, for subclasses that estimate
+   * the spectra themselves after PrepareSpectraEstimation(). */
+  const SpectraVectorType &
+  GetSegmentWindow() const
+  {
+    return this->m_SegmentWindow;
+  }
+  const ScalarType *
+  GetLineWindow(SizeValueType numberOfLines) const
+  {
+    return this->m_LineWindows.data() + numberOfLines * (numberOfLines - 1) / 2;
+  }
+  FFT1DSizeType
+  GetCurrentFFT1DSize() const
+  {
+    return this->m_CurrentFFT1DSize;
+  }
+  unsigned int
+  GetReferenceComponentOffset() const
+  {
+    return this->m_ReferenceComponentOffset;
+  }
+
 private:
   using ComplexType = std::complex<ScalarType>;
-  using ComplexVectorType = vnl_vector<ComplexType>;
-  using SpectraVectorType = std::vector<ScalarType>;
-  using IndexType = typename InputImageType::IndexType;
   using SpectraLineType = std::pair<IndexType, SpectraVectorType>;
   using SpectraLinesContainerType = std::list<SpectraLineType>;
-  using SupportWindowType = typename SupportWindowImageType::PixelType;
   using InputImageIteratorType = ImageRegionConstIterator<InputImageType>;
-  using FFT1DType = vnl_fft_1d<ScalarType>;
-
-  using Spectra1DSupportWindowFilterType = Spectra1DSupportWindowImageFilter<InputImageType>;
-  using FFT1DSizeType = typename Spectra1DSupportWindowFilterType::FFT1DSizeType;
+  using VnlLineTransformType = ComplexToComplex1DLineTransform<ScalarType, false>;
+  using LineTransformType = ComplexToComplex1DLineTransform<ScalarType>;
 
-  using LineWindowMapType = std::unordered_map<FFT1DSizeType, SpectraVectorType>;
+  using SegmentSpectraMapType =
+    std::map<IndexType, SpectraVectorType, typename Functor::IndexLexicographicCompare<ImageDimension>>;
 
   struct PerThreadData
   {
-    ComplexVectorType                 ComplexVector;
-    SpectraVectorType                 SpectraVector;
-    typename InputImageType::SizeType LineImageRegionSize;
-    LineWindowMapType                 LineWindowMap;
+    FFT1DSizeType                         FFTSize = 0;
+    std::unique_ptr<VnlLineTransformType> VnlLineTransform;
+    std::unique_ptr<LineTransformType>    LineTransform;
+    SpectraVectorType                     SpectraVector;
+    SpectraVectorType                     OutputSpectra;
+    typename InputImageType::SizeType     LineImageRegionSize;
+    SegmentSpectraMapType                 SegmentSpectra;
+    SegmentSpectraMapType                 PreviousSegmentSpectra;
+    std::vector<IndexType>                SegmentIndices;
+    std::vector<IndexType>                PendingSegmentIndices;
   };
   using PerThreadDataContainerType = std::vector<PerThreadData>;
   PerThreadDataContainerType m_PerThreadDataContainer;
 
-  typename OutputImageType::Pointer m_ReferenceSpectraImage;
+  /** Scratch data of the dynamic work units that are done. */
+  std::vector<std::unique_ptr<PerThreadData>> m_PerThreadDataPool;
+  std::mutex                                  m_PerThreadDataPoolMutex;
 
+  typename SpectraImageType::Pointer m_ReferenceSpectraImage;
+
+  WindowType        m_Window;
+  double            m_TukeyAlpha;
+  unsigned int      m_NumberOfSegments;
+  double            m_SegmentOverlap;
+  bool              m_Batched;
+  bool              m_ReuseSegments;
+  bool              m_UseFFTW;
+  SpectraVectorType m_SegmentWindow;
+  /** Lateral windows of every number of lines up to the largest support
+   * window, the window of n lines starting at n (n - 1) / 2. */
+  SpectraVectorType m_LineWindows;
+  unsigned int      m_FirstFrequencyBin;
+  unsigned int      m_NumberOfFrequencyBins;
+  bool              m_DecibelOutput;
+  double            m_SamplingFrequency;
+  SpectraVectorType m_LinearFitWeights;
+  double            m_LinearFitCenterFrequency;
+  FFT1DSizeType     m_CurrentFFT1DSize;
+  unsigned int      m_ReferenceComponentOffset;
+
+  /** Prepare the scratch data of a work unit for the current update. */
+  void
+  InitializePerThreadData(PerThreadData & perThreadData) const;
+  void
+  GenerateSpectraRegion(const OutputImageRegionType & outputRegionForThread, PerThreadData & perThreadData);
   void
-  ComputeSpectra(const IndexType & lineIndex, ThreadIdType threadId, SpectraLineType & spectraLine);
+  ComputeSpectra(const IndexType & lineIndex, PerThreadData & perThreadData, SpectraLineType & spectraLine);
+  /** Window and transform the segments starting at the given indices, and
+   * store their periodograms in the SegmentSpectra of the thread. */
+  void
+  ComputeSegmentSpectra(const IndexType &              lineIndex,
+                        const std::vector<IndexType> & segmentIndices,
+                        PerThreadData &                perThreadData);
+  /** Store the slope, intercept and midband fit of the line fit of the
+   * spectra. */
+  void
+  StoreLinearFit(const ScalarType * spectra, FFT1DSizeType length, ScalarType * fit) const;
+  static void
+  SetOutputVectorLength(SpectraImageType * output, unsigned int length)
+  {
+    output->SetVectorLength(length);
+  }
+  template <typename TImage>
   static void
-  AddLineWindow(FFT1DSizeType length, LineWindowMapType & lineWindowMap);
+  SetOutputVectorLength(TImage *, unsigned int)
+  {}
+  /** Fill m_LineWindows up to windows of the given number of lines. */
+  void
+  FillLineWindows(SizeValueType maximumNumberOfLines);
+  static void
+  FillWindow(WindowType windowType, double tukeyAlpha, FFT1DSizeType length, SpectraVectorType & window);
 };
 
 } // end namespace itk
@@ -147,4 +393,18 @@ private:
 #  include "itkSpectra1DImageFilter.hxx"
 #endif
 
+// The common instantiations are compiled into the Ultrasound library.
+#if !defined(ITK_TEMPLATE_EXPLICIT_Spectra1DImageFilter)
+namespace itk
+{
+ITK_GCC_PRAGMA_DIAG_PUSH()
+ITK_GCC_PRAGMA_DIAG(ignored "-Wattributes")
+extern template class Ultrasound_EXPORT_EXPLICIT Spectra1DImageFilter<Image<signed short, 2>, Image<std::list<Index<2>>, 2>, VectorImage<float, 2>>;
+extern template class Ultrasound_EXPORT_EXPLICIT Spectra1DImageFilter<Image<signed short, 3>, Image<std::list<Index<3>>, 3>, VectorImage<float, 3>>;
+extern template class Ultrasound_EXPORT_EXPLICIT Spectra1DImageFilter<Image<float, 2>, Image<std::list<Index<2>>, 2>, VectorImage<float, 2>>;
+extern template class Ultrasound_EXPORT_EXPLICIT Spectra1DImageFilter<Image<float, 3>, Image<std::list<Index<3>>, 3>, VectorImage<float, 3>>;
+ITK_GCC_PRAGMA_DIAG_POP()
+} // end namespace itk
+#endif
+
 #endif // itkSpectra1DImageFilter_h
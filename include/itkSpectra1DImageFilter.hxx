@@ -20,12 +20,15 @@
 
 #include "itkSpectra1DImageFilter.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkImageRegionConstIterator.h"
-#include "itkImageScanlineIterator.h"
-#include "itkImageScanlineConstIterator.h"
 #include "itkMetaDataObject.h"
+#include "itkUltrasoundTrace.h"
+#include "itkWarmupImage.h"
 
 #include "itkSpectra1DSupportWindowImageFilter.h"
 
@@ -37,6 +40,21 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::Spectra1DI
 {
   this->AddRequiredInputName("SupportWindowImage");
   this->DynamicMultiThreadingOff();
+
+  m_Window = HAMMING_WINDOW;
+  m_TukeyAlpha = 0.5;
+  m_NumberOfSegments = 3;
+  m_SegmentOverlap = 2.0 / 3.0;
+  m_Batched = false;
+  m_ReuseSegments = false;
+  m_UseFFTW = true;
+  m_FirstFrequencyBin = 0;
+  m_NumberOfFrequencyBins = 0;
+  m_DecibelOutput = false;
+  m_SamplingFrequency = 1.0;
+  m_LinearFitCenterFrequency = 0.0;
+  m_CurrentFFT1DSize = 0;
+  m_ReferenceComponentOffset = 0;
 }
 
 
@@ -56,37 +74,300 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::GenerateOu
   FFT1DSizeType              fft1DSize = 32;
   ExposeMetaData<FFT1DSizeType>(dict, "FFT1DSize", fft1DSize);
 
-  // Number of frequency bins represented by each vector pixel.
-  // Divide by two for Hermitian symmetry. Divide by two for Welch's method
-  // with 50% overlap. Subtract one for discarding DC component.
+  SetOutputVectorLength(output, this->GetNumberOfOutputFrequencyBins(fft1DSize));
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+SizeValueType
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::EstimateMemoryFootprint(
+  const typename OutputImageType::RegionType & region) const
+{
+  const InputImageType *         input = this->GetInput();
+  const SupportWindowImageType * supportWindowImage = this->GetSupportWindowImage();
+  if (!input || !supportWindowImage)
+  {
+    itkExceptionMacro(<< "The input and the support window image are required to estimate the memory footprint.");
+  }
+
+  const MetaDataDictionary & dict = supportWindowImage->GetMetaDataDictionary();
+  FFT1DSizeType              fft1DSize = 32;
+  ExposeMetaData<FFT1DSizeType>(dict, "FFT1DSize", fft1DSize);
+  const SizeValueType fftSize = fft1DSize / 2;
+  const SizeValueType spectraComponents = this->GetNumberOfOutputFrequencyBins(fft1DSize);
+  const SizeValueType outputComponents = LinearFitOutput ? 3 : spectraComponents;
+  const SizeValueType numberOfLines = input->GetLargestPossibleRegion().GetSize(1);
+
+  SizeValueType footprint = region.GetNumberOfPixels() * outputComponents * sizeof(OutputComponentType);
+  // The segment window and the lateral windows.
+  footprint += (fftSize + numberOfLines * (numberOfLines + 1) / 2) * sizeof(ScalarType);
+
+  // The input and output buffers of the transform, of all the segments when
+  // batched.
+  const SizeValueType transformLines = this->m_Batched ? this->m_NumberOfSegments : 1;
+  SizeValueType       perWorkUnit = 2 * transformLines * fftSize * sizeof(ComplexType);
+  perWorkUnit += 2 * spectraComponents * sizeof(ScalarType);
+  // The spectra of the lines of a window, in a std::list, and of their
+  // segments, in a std::map, for the current and the previous row with
+  // ReuseSegments.
+  const SizeValueType spectraBytes = spectraComponents * sizeof(ScalarType);
+  perWorkUnit += numberOfLines * (spectraBytes + sizeof(SpectraLineType) + 2 * sizeof(void *));
+  const SizeValueType numberOfSegmentSpectra =
+    this->m_NumberOfSegments * (this->m_ReuseSegments ? 2 * numberOfLines : 1);
+  perWorkUnit += numberOfSegmentSpectra *
+                 (spectraBytes + sizeof(typename SegmentSpectraMapType::value_type) + 4 * sizeof(void *));
+  footprint += this->GetNumberOfWorkUnits() * perWorkUnit;
+
+  return footprint;
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+SizeValueType
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::EstimateMemoryFootprint()
+{
+  this->UpdateOutputInformation();
+  return this->EstimateMemoryFootprint(this->GetOutput()->GetLargestPossibleRegion());
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::Prepare(const InputImageType * geometry)
+{
+  if (geometry == nullptr)
+  {
+    itkExceptionMacro(<< "The geometry of the frames is required.");
+  }
+
+  const typename InputImageType::ConstPointer input = this->GetInput();
+  this->SetInput(CreateWarmupImage<InputImageType>(geometry));
+  try
+  {
+    this->UpdateLargestPossibleRegion();
+  }
+  catch (...)
+  {
+    this->SetInput(input);
+    throw;
+  }
+  this->SetInput(input);
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  // The support windows and reference spectra are on the output grid.
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType *               input = const_cast<InputImageType *>(this->GetInput());
+  const SupportWindowImageType * supportWindowImage = this->GetSupportWindowImage();
+  if (!input || !supportWindowImage)
+  {
+    return;
+  }
+
+  const MetaDataDictionary & dict = supportWindowImage->GetMetaDataDictionary();
+  FFT1DSizeType              fft1DSize = 32;
+  ExposeMetaData<FFT1DSizeType>(dict, "FFT1DSize", fft1DSize);
+  SizeValueType sampleStep = 1;
+  ExposeMetaData<SizeValueType>(dict, "Step", sampleStep);
+
+  // Map the first and last requested rows to the first sample of their
+  // windows, as truncated by Spectra1DSupportWindowImageFilter.
+  const typename InputImageType::RegionType & inputLargestRegion = input->GetLargestPossibleRegion();
+  const OutputImageRegionType &               outputRequestedRegion = this->GetOutput()->GetRequestedRegion();
+  const IndexValueType                        largestIndexStart = inputLargestRegion.GetIndex(0);
+  const IndexValueType                        largestIndexStop =
+    largestIndexStart + static_cast<IndexValueType>(inputLargestRegion.GetSize(0)) - 1;
+  const auto windowStart = [=](IndexValueType outputIndex) -> IndexValueType {
+    const IndexValueType center =
+      largestIndexStart + (outputIndex - largestIndexStart) * static_cast<IndexValueType>(sampleStep);
+    IndexValueType start = std::max(center - static_cast<IndexValueType>(fft1DSize / 2), largestIndexStart);
+    if (start + static_cast<IndexValueType>(fft1DSize) > largestIndexStop)
+    {
+      start = largestIndexStop - static_cast<IndexValueType>(fft1DSize);
+    }
+    return start;
+  };
+  const IndexValueType firstSample = windowStart(outputRequestedRegion.GetIndex(0));
+  const IndexValueType lastSample =
+    windowStart(outputRequestedRegion.GetIndex(0) + static_cast<IndexValueType>(outputRequestedRegion.GetSize(0)) - 1) +
+    static_cast<IndexValueType>(fft1DSize) - 1;
+
+  typename InputImageType::RegionType inputRequestedRegion = inputLargestRegion;
+  inputRequestedRegion.SetIndex(0, firstSample);
+  inputRequestedRegion.SetSize(0, static_cast<SizeValueType>(lastSample - firstSample + 1));
+  inputRequestedRegion.Crop(inputLargestRegion);
+  input->SetRequestedRegion(inputRequestedRegion);
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+auto
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::GetNumberOfOutputFrequencyBins(
+  FFT1DSizeType fft1DSize) const -> FFT1DSizeType
+{
+  // Number of frequency bins of the spectra.
+  // Divide by two for Hermitian symmetry. Divide by two for the length of
+  // the Welch's method segments. Subtract one for discarding DC component.
   const FFT1DSizeType spectraComponents = fft1DSize / 2 / 2 - 1;
 
-  output->SetVectorLength(spectraComponents);
+  const FFT1DSizeType numberOfBins = this->m_NumberOfFrequencyBins > 0
+                                       ? this->m_NumberOfFrequencyBins
+                                       : spectraComponents - std::min(this->m_FirstFrequencyBin, spectraComponents);
+  if (this->m_FirstFrequencyBin + numberOfBins > spectraComponents || numberOfBins == 0)
+  {
+    itkExceptionMacro("The frequency bins [" << this->m_FirstFrequencyBin << ", "
+                                             << this->m_FirstFrequencyBin + numberOfBins
+                                             << ") are not within the " << spectraComponents
+                                             << " bins of an FFT1DSize of " << fft1DSize);
+  }
+  return numberOfBins;
 }
 
 
 template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
 void
-Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::BeforeThreadedGenerateData()
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::PrepareSpectraEstimation()
 {
   const SupportWindowImageType * supportWindowImage = this->GetSupportWindowImage();
   const MetaDataDictionary &     dict = supportWindowImage->GetMetaDataDictionary();
   FFT1DSizeType                  fft1DSize = 32;
   ExposeMetaData<FFT1DSizeType>(dict, "FFT1DSize", fft1DSize);
-  // Divide by two for Hermitian symmetry. Divide by two for Welch's method
-  // with 50% overlap. Subtract one for discarding DC component.
-  const FFT1DSizeType spectraComponents = fft1DSize / 2 / 2 - 1;
 
-  const ThreadIdType numberOfWorkUnits = this->GetNumberOfWorkUnits();
-  this->m_PerThreadDataContainer.resize(numberOfWorkUnits);
-  for (ThreadIdType threadId = 0; threadId < numberOfWorkUnits; ++threadId)
+  // Welch's method segments are half the FFT1DSize.
+  const FFT1DSizeType fftSize = fft1DSize / 2;
+  if (this->m_SegmentOverlap < 0.0 || this->m_SegmentOverlap >= 1.0)
+  {
+    itkExceptionMacro("SegmentOverlap must be in [0, 1), not " << this->m_SegmentOverlap);
+  }
+  const double segmentHop = fftSize * (1.0 - this->m_SegmentOverlap);
+  if (static_cast<SizeValueType>((this->m_NumberOfSegments - 1) * segmentHop) + fftSize > fft1DSize)
+  {
+    itkExceptionMacro(<< this->m_NumberOfSegments << " segments of " << fftSize << " samples with an overlap of "
+                      << this->m_SegmentOverlap << " do not fit in the FFT1DSize of " << fft1DSize << " samples");
+  }
+  FillWindow(this->m_Window, this->m_TukeyAlpha, fftSize, this->m_SegmentWindow);
+
+  // Prepare the lateral windows of every support window size of the output.
+  SizeValueType                                    maximumNumberOfLines = 0;
+  ImageRegionConstIterator<SupportWindowImageType> supportWindowIt(supportWindowImage,
+                                                                   this->GetOutput()->GetRequestedRegion());
+  for (supportWindowIt.GoToBegin(); !supportWindowIt.IsAtEnd(); ++supportWindowIt)
   {
-    PerThreadData & perThreadData = this->m_PerThreadDataContainer[threadId];
-    perThreadData.ComplexVector.set_size(fft1DSize / 2);
-    perThreadData.SpectraVector.resize(spectraComponents);
-    perThreadData.LineImageRegionSize.Fill(1);
-    perThreadData.LineImageRegionSize[0] = fft1DSize;
+    maximumNumberOfLines = std::max(maximumNumberOfLines, static_cast<SizeValueType>(supportWindowIt.Value().size()));
   }
+  this->FillLineWindows(maximumNumberOfLines);
+
+  this->m_CurrentFFT1DSize = fft1DSize;
+
+  if (LinearFitOutput)
+  {
+    // The least squares slope is the sum of the spectra times these weights.
+    const FFT1DSizeType numberOfBins = this->GetNumberOfOutputFrequencyBins(fft1DSize);
+    const double        binFrequency = this->m_SamplingFrequency / fftSize;
+    this->m_LinearFitCenterFrequency = (this->m_FirstFrequencyBin + 1 + (numberOfBins - 1) / 2.0) * binFrequency;
+    this->m_LinearFitWeights.resize(numberOfBins);
+    double sumOfSquares = 0.0;
+    for (FFT1DSizeType bin = 0; bin < numberOfBins; ++bin)
+    {
+      const double deviation = (this->m_FirstFrequencyBin + 1 + bin) * binFrequency - this->m_LinearFitCenterFrequency;
+      this->m_LinearFitWeights[bin] = deviation;
+      sumOfSquares += deviation * deviation;
+    }
+    for (FFT1DSizeType bin = 0; bin < numberOfBins; ++bin)
+    {
+      this->m_LinearFitWeights[bin] = sumOfSquares > 0.0 ? this->m_LinearFitWeights[bin] / sumOfSquares : 0.0;
+    }
+  }
+
+  // The reference spectra either have all the bins, or only the output ones.
+  const SpectraImageType * referenceSpectra = this->GetReferenceSpectraImage();
+  this->m_ReferenceComponentOffset = 0;
+  if (referenceSpectra != nullptr)
+  {
+    const unsigned int numberOfComponents = referenceSpectra->GetNumberOfComponentsPerPixel();
+    const unsigned int numberOfOutputComponents = this->GetNumberOfOutputFrequencyBins(fft1DSize);
+    if (numberOfComponents == fft1DSize / 2 / 2 - 1)
+    {
+      this->m_ReferenceComponentOffset = this->m_FirstFrequencyBin;
+    }
+    else if (numberOfComponents != numberOfOutputComponents)
+    {
+      itkExceptionMacro("ReferenceSpectraImage has " << numberOfComponents << " while the output image has "
+                                                     << numberOfOutputComponents << " components");
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  this->PrepareSpectraEstimation();
+
+  if (this->GetDynamicMultiThreading())
+  {
+    for (const std::unique_ptr<PerThreadData> & perThreadData : this->m_PerThreadDataPool)
+    {
+      this->InitializePerThreadData(*perThreadData);
+    }
+  }
+  else
+  {
+    const ThreadIdType numberOfWorkUnits = this->GetNumberOfWorkUnits();
+    this->m_PerThreadDataContainer.resize(numberOfWorkUnits);
+    for (ThreadIdType threadId = 0; threadId < numberOfWorkUnits; ++threadId)
+    {
+      this->InitializePerThreadData(this->m_PerThreadDataContainer[threadId]);
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::InitializePerThreadData(
+  PerThreadData & perThreadData) const
+{
+  const FFT1DSizeType fft1DSize = this->m_CurrentFFT1DSize;
+  const FFT1DSizeType fftSize = fft1DSize / 2;
+  const FFT1DSizeType spectraComponents = this->GetNumberOfOutputFrequencyBins(fft1DSize);
+
+  // The transforms survive from one update to the next, so that only a
+  // change of the segment size, batch or backend sets them up again.
+  const bool          useFFTW = this->m_UseFFTW && ComplexToComplex1DLineTransformUsesFFTW<ScalarType>::value;
+  const SizeValueType numberOfLines = this->m_Batched ? this->m_NumberOfSegments : 1;
+
+  const SizeValueType currentNumberOfLines =
+    perThreadData.LineTransform != nullptr
+      ? perThreadData.LineTransform->GetNumberOfLines()
+      : (perThreadData.VnlLineTransform != nullptr ? perThreadData.VnlLineTransform->GetNumberOfLines() : 0);
+  if (perThreadData.FFTSize != fftSize || (perThreadData.LineTransform != nullptr) != useFFTW ||
+      currentNumberOfLines != numberOfLines)
+  {
+    perThreadData.VnlLineTransform.reset();
+    perThreadData.LineTransform.reset();
+    if (useFFTW)
+    {
+      perThreadData.LineTransform.reset(new LineTransformType(fftSize, numberOfLines));
+    }
+    else
+    {
+      perThreadData.VnlLineTransform.reset(new VnlLineTransformType(fftSize, numberOfLines));
+    }
+    perThreadData.FFTSize = fftSize;
+  }
+  perThreadData.SpectraVector.resize(spectraComponents);
+  perThreadData.OutputSpectra.resize(LinearFitOutput || HalfPrecisionOutput ? spectraComponents : 0);
+  perThreadData.SegmentSpectra.clear();
+  perThreadData.PreviousSegmentSpectra.clear();
+  perThreadData.LineImageRegionSize.Fill(1);
+  perThreadData.LineImageRegionSize[0] = fft1DSize;
 }
 
 
@@ -98,85 +379,233 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::VerifyInpu
 
 template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
 void
-Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::AddLineWindow(FFT1DSizeType       length,
-                                                                                    LineWindowMapType & lineWindowMap)
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                Indent         indent) const
 {
-  if (lineWindowMap.count(length) == 1)
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Window: ";
+  switch (this->m_Window)
   {
-    return;
+    case HAMMING_WINDOW:
+      os << "HAMMING_WINDOW" << std::endl;
+      break;
+    case HANN_WINDOW:
+      os << "HANN_WINDOW" << std::endl;
+      break;
+    case BLACKMAN_HARRIS_WINDOW:
+      os << "BLACKMAN_HARRIS_WINDOW" << std::endl;
+      break;
+    case TUKEY_WINDOW:
+      os << "TUKEY_WINDOW" << std::endl;
+      break;
   }
+  os << indent << "TukeyAlpha: " << this->m_TukeyAlpha << std::endl;
+  os << indent << "NumberOfSegments: " << this->m_NumberOfSegments << std::endl;
+  os << indent << "SegmentOverlap: " << this->m_SegmentOverlap << std::endl;
+  os << indent << "Batched: " << (this->m_Batched ? "On" : "Off") << std::endl;
+  os << indent << "FirstFrequencyBin: " << this->m_FirstFrequencyBin << std::endl;
+  os << indent << "NumberOfFrequencyBins: " << this->m_NumberOfFrequencyBins << std::endl;
+  os << indent << "DecibelOutput: " << (this->m_DecibelOutput ? "On" : "Off") << std::endl;
+  os << indent << "SamplingFrequency: " << this->m_SamplingFrequency << std::endl;
+  os << indent << "ReuseSegments: " << (this->m_ReuseSegments ? "On" : "Off") << std::endl;
+  os << indent << "UseFFTW: " << (this->m_UseFFTW ? "On" : "Off") << std::endl;
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::StoreLinearFit(const ScalarType * spectra,
+                                                                                     FFT1DSizeType      length,
+                                                                                     ScalarType *       fit) const
+{
+  // The least squares line goes through the mean of the spectra at the
+  // center frequency.
+  double sum = 0.0;
+  double slope = 0.0;
+  for (FFT1DSizeType bin = 0; bin < length; ++bin)
+  {
+    sum += spectra[bin];
+    slope += this->m_LinearFitWeights[bin] * spectra[bin];
+  }
+  const double midbandFit = sum / length;
+  fit[0] = static_cast<ScalarType>(slope);
+  fit[1] = static_cast<ScalarType>(midbandFit - slope * this->m_LinearFitCenterFrequency);
+  fit[2] = static_cast<ScalarType>(midbandFit);
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::FillLineWindows(
+  SizeValueType maximumNumberOfLines)
+{
   // Currently using a Hamming Window
-  SpectraVectorType window(length);
-  ScalarType        sum = NumericTraits<ScalarType>::ZeroValue();
+  this->m_LineWindows.resize(maximumNumberOfLines * (maximumNumberOfLines + 1) / 2);
+  SpectraVectorType window;
+  for (SizeValueType numberOfLines = 1; numberOfLines <= maximumNumberOfLines; ++numberOfLines)
+  {
+    FillWindow(HAMMING_WINDOW, 0.0, numberOfLines, window);
+    std::copy(window.begin(), window.end(), this->m_LineWindows.begin() + numberOfLines * (numberOfLines - 1) / 2);
+  }
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::FillWindow(WindowType          windowType,
+                                                                                 double              tukeyAlpha,
+                                                                                 FFT1DSizeType       length,
+                                                                                 SpectraVectorType & window)
+{
+  window.resize(length);
+  if (length == 1)
+  {
+    window[0] = 1.0;
+    return;
+  }
+  ScalarType sum = NumericTraits<ScalarType>::ZeroValue();
   for (FFT1DSizeType sample = 0; sample < length; ++sample)
   {
-    window[sample] = 0.54 + 0.46 * std::cos((Math::twopi * sample) / (length - 1));
+    const double x = static_cast<double>(sample) / (length - 1);
+    double       value = 1.0;
+    switch (windowType)
+    {
+      case HAMMING_WINDOW:
+        value = 0.54 + 0.46 * std::cos(Math::twopi * x);
+        break;
+      case HANN_WINDOW:
+        value = 0.5 - 0.5 * std::cos(Math::twopi * x);
+        break;
+      case BLACKMAN_HARRIS_WINDOW:
+        value = 0.35875 - 0.48829 * std::cos(Math::twopi * x) + 0.14128 * std::cos(2.0 * Math::twopi * x) -
+                0.01168 * std::cos(3.0 * Math::twopi * x);
+        break;
+      case TUKEY_WINDOW:
+        if (x < tukeyAlpha / 2.0)
+        {
+          value = 0.5 * (1.0 + std::cos(Math::twopi / tukeyAlpha * (x - tukeyAlpha / 2.0)));
+        }
+        else if (x > 1.0 - tukeyAlpha / 2.0)
+        {
+          value = 0.5 * (1.0 + std::cos(Math::twopi / tukeyAlpha * (x - 1.0 + tukeyAlpha / 2.0)));
+        }
+        break;
+    }
+    window[sample] = value;
     sum += window[sample];
   }
   for (FFT1DSizeType sample = 0; sample < length; ++sample)
   {
     window[sample] /= sum;
   }
-  lineWindowMap[length] = window;
 }
 
 
 template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
 void
 Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ComputeSpectra(const IndexType & lineIndex,
-                                                                                     ThreadIdType      threadId,
+                                                                                     PerThreadData &   perThreadData,
                                                                                      SpectraLineType & spectraLine)
 {
   const InputImageType * input = this->GetInput();
-  PerThreadData &        perThreadData = this->m_PerThreadDataContainer[threadId];
 
-  const FFT1DSizeType fftSize = static_cast<FFT1DSizeType>(perThreadData.ComplexVector.size());
+  const FFT1DSizeType fftSize = perThreadData.FFTSize;
+  ComplexType *       complexBuffer = perThreadData.LineTransform != nullptr
+                                        ? perThreadData.LineTransform->GetBuffer()
+                                        : perThreadData.VnlLineTransform->GetBuffer();
 
   const typename InputImageType::RegionType lineRegion(lineIndex, perThreadData.LineImageRegionSize);
   InputImageIteratorType                    inputIt(input, lineRegion);
   inputIt.GoToBegin();
-  perThreadData.ComplexVector.fill(0);
-  typename ComplexVectorType::iterator       complexVectorIt = perThreadData.ComplexVector.begin();
-  const typename ComplexVectorType::iterator complexVectorEnd = perThreadData.ComplexVector.end();
-  typename SpectraVectorType::const_iterator windowIt = perThreadData.LineWindowMap[fftSize].begin();
-  typename ComplexVectorType::const_iterator complexVectorConstIt = perThreadData.ComplexVector.begin();
-  typename SpectraVectorType::iterator       spectraVectorIt = perThreadData.SpectraVector.begin();
-  const size_t                               highFreq = perThreadData.SpectraVector.size();
+  const ScalarType *                   window = this->m_SegmentWindow.data();
+  typename SpectraVectorType::iterator spectraVectorIt = perThreadData.SpectraVector.begin();
+  const size_t                         highFreq = perThreadData.SpectraVector.size();
   for (size_t freq = 0; freq < highFreq; ++freq)
   {
     spectraVectorIt[freq] = 0.0f;
   }
-  const double overlap = 0.5;
-  IndexType    segmentIndex(lineIndex);
-  const double spectralScale = 1.0 / (fftSize * fftSize);
-  // 3 segments for Welch's method with 50% overlap (D=M/2)
-  for (unsigned int segment = 0; segment < 3; ++segment)
+  const unsigned int numberOfSegments = this->m_NumberOfSegments;
+  const double       segmentHop = fftSize * (1.0 - this->m_SegmentOverlap);
+  IndexType          segmentIndex(lineIndex);
+  if (this->m_ReuseSegments)
+  {
+    // Look the segments up in the current row first, then in the previous
+    // row, and only transform the remaining ones.
+    perThreadData.SegmentIndices.clear();
+    perThreadData.PendingSegmentIndices.clear();
+    for (unsigned int segment = 0; segment < numberOfSegments; ++segment)
+    {
+      segmentIndex[0] = static_cast<IndexValueType>(lineIndex[0] + segment * segmentHop);
+      perThreadData.SegmentIndices.push_back(segmentIndex);
+      if (perThreadData.SegmentSpectra.count(segmentIndex) == 1)
+      {
+        continue;
+      }
+      const typename SegmentSpectraMapType::iterator previousIt =
+        perThreadData.PreviousSegmentSpectra.find(segmentIndex);
+      if (previousIt != perThreadData.PreviousSegmentSpectra.end())
+      {
+        perThreadData.SegmentSpectra[segmentIndex].swap(previousIt->second);
+        perThreadData.PreviousSegmentSpectra.erase(previousIt);
+      }
+      else
+      {
+        perThreadData.PendingSegmentIndices.push_back(segmentIndex);
+      }
+    }
+    this->ComputeSegmentSpectra(lineIndex, perThreadData.PendingSegmentIndices, perThreadData);
+
+    for (unsigned int segment = 0; segment < numberOfSegments; ++segment)
+    {
+      const SpectraVectorType & segmentSpectra = perThreadData.SegmentSpectra[perThreadData.SegmentIndices[segment]];
+      for (size_t freq = 0; freq < highFreq; ++freq)
+      {
+        spectraVectorIt[freq] += segmentSpectra[freq] / numberOfSegments;
+      }
+    }
+
+    spectraLine.first = lineIndex;
+    spectraLine.second = perThreadData.SpectraVector;
+    return;
+  }
+
+  const SizeValueType segmentsPerTransform = perThreadData.LineTransform != nullptr
+                                               ? perThreadData.LineTransform->GetNumberOfLines()
+                                               : perThreadData.VnlLineTransform->GetNumberOfLines();
+  const double        spectralScale = 1.0 / (fftSize * fftSize);
+  // drop DC component
+  const SizeValueType firstBin = this->m_FirstFrequencyBin + 1;
+  for (unsigned int segment = 0; segment < numberOfSegments; segment += segmentsPerTransform)
   {
-    segmentIndex[0] =
-      static_cast<IndexValueType>(lineIndex[0] + segment * perThreadData.LineImageRegionSize[0] * overlap / 3.0);
-    inputIt.SetIndex(segmentIndex);
-    complexVectorIt = perThreadData.ComplexVector.begin();
-    windowIt = perThreadData.LineWindowMap[fftSize].begin();
-    while (complexVectorIt != complexVectorEnd)
+    for (SizeValueType batchSegment = 0; batchSegment < segmentsPerTransform; ++batchSegment)
+    {
+      segmentIndex[0] = static_cast<IndexValueType>(lineIndex[0] + (segment + batchSegment) * segmentHop);
+      inputIt.SetIndex(segmentIndex);
+      ComplexType * segmentBuffer = complexBuffer + batchSegment * fftSize;
+      for (FFT1DSizeType sample = 0; sample < fftSize; ++sample)
+      {
+        segmentBuffer[sample] = inputIt.Value() * window[sample];
+        ++inputIt;
+      }
+    }
+    if (perThreadData.LineTransform != nullptr)
     {
-      *complexVectorIt = inputIt.Value() * *windowIt;
-      ++inputIt;
-      ++complexVectorIt;
-      ++windowIt;
+      perThreadData.LineTransform->Forward();
     }
-    FFT1DType fft1D(fftSize);
-    fft1D.bwd_transform(perThreadData.ComplexVector);
-    complexVectorConstIt = perThreadData.ComplexVector.begin();
-    spectraVectorIt = perThreadData.SpectraVector.begin();
-    // drop DC component
-    ++complexVectorConstIt;
-
-    // Each spectral component = (Re^2 + Im^2) / 3 / (fftSize)^2
-    for (size_t freq = 0; freq < highFreq; ++freq)
+    else
     {
-      spectraVectorIt[freq] +=
-        std::real(*complexVectorConstIt * std::conj(*complexVectorConstIt)) / 3.0 * spectralScale;
-      ++complexVectorConstIt;
+      perThreadData.VnlLineTransform->Forward();
+    }
+
+    // Each spectral component = (Re^2 + Im^2) / numberOfSegments / (fftSize)^2
+    for (SizeValueType batchSegment = 0; batchSegment < segmentsPerTransform; ++batchSegment)
+    {
+      const ComplexType * segmentBuffer = complexBuffer + batchSegment * fftSize;
+      for (size_t freq = 0; freq < highFreq; ++freq)
+      {
+        spectraVectorIt[freq] += std::norm(segmentBuffer[firstBin + freq]) / numberOfSegments * spectralScale;
+      }
     }
   }
 
@@ -185,11 +614,114 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ComputeSpe
 }
 
 
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ComputeSegmentSpectra(
+  const IndexType &              lineIndex,
+  const std::vector<IndexType> & segmentIndices,
+  PerThreadData &                perThreadData)
+{
+  itkUltrasoundTraceScopeMacro("Spectra1DSegments");
+  const InputImageType * input = this->GetInput();
+
+  const FFT1DSizeType fftSize = perThreadData.FFTSize;
+  ComplexType *       complexBuffer = perThreadData.LineTransform != nullptr
+                                        ? perThreadData.LineTransform->GetBuffer()
+                                        : perThreadData.VnlLineTransform->GetBuffer();
+  const SizeValueType segmentsPerTransform = perThreadData.LineTransform != nullptr
+                                               ? perThreadData.LineTransform->GetNumberOfLines()
+                                               : perThreadData.VnlLineTransform->GetNumberOfLines();
+
+  const typename InputImageType::RegionType lineRegion(lineIndex, perThreadData.LineImageRegionSize);
+  InputImageIteratorType                    inputIt(input, lineRegion);
+  const ScalarType *                        window = this->m_SegmentWindow.data();
+  const size_t                              highFreq = perThreadData.SpectraVector.size();
+  const double                              spectralScale = 1.0 / (fftSize * fftSize);
+  const SizeValueType                       firstBin = this->m_FirstFrequencyBin + 1;
+  const size_t                              numberOfPendingSegments = segmentIndices.size();
+  for (size_t first = 0; first < numberOfPendingSegments; first += segmentsPerTransform)
+  {
+    // A batched transform also runs on the unused slots of the last batch.
+    const size_t batchSize = std::min(static_cast<size_t>(segmentsPerTransform), numberOfPendingSegments - first);
+    for (size_t batchSegment = 0; batchSegment < batchSize; ++batchSegment)
+    {
+      inputIt.SetIndex(segmentIndices[first + batchSegment]);
+      ComplexType * segmentBuffer = complexBuffer + batchSegment * fftSize;
+      for (FFT1DSizeType sample = 0; sample < fftSize; ++sample)
+      {
+        segmentBuffer[sample] = inputIt.Value() * window[sample];
+        ++inputIt;
+      }
+    }
+    if (perThreadData.LineTransform != nullptr)
+    {
+      perThreadData.LineTransform->Forward();
+    }
+    else
+    {
+      perThreadData.VnlLineTransform->Forward();
+    }
+
+    for (size_t batchSegment = 0; batchSegment < batchSize; ++batchSegment)
+    {
+      const ComplexType * segmentBuffer = complexBuffer + batchSegment * fftSize;
+      SpectraVectorType & segmentSpectra = perThreadData.SegmentSpectra[segmentIndices[first + batchSegment]];
+      segmentSpectra.resize(highFreq);
+      for (size_t freq = 0; freq < highFreq; ++freq)
+      {
+        segmentSpectra[freq] = std::norm(segmentBuffer[firstBin + freq]) * spectralScale;
+      }
+    }
+  }
+}
+
+
 template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
 void
 Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ThreadedGenerateData(
   const OutputImageRegionType & outputRegionForThread,
   ThreadIdType                  threadId)
+{
+  this->GenerateSpectraRegion(outputRegionForThread, this->m_PerThreadDataContainer[threadId]);
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  // Borrow the scratch data of a previous work unit, if one is done.
+  std::unique_ptr<PerThreadData> perThreadData;
+  {
+    std::lock_guard<std::mutex> lock(this->m_PerThreadDataPoolMutex);
+    if (!this->m_PerThreadDataPool.empty())
+    {
+      perThreadData = std::move(this->m_PerThreadDataPool.back());
+      this->m_PerThreadDataPool.pop_back();
+    }
+  }
+  if (perThreadData == nullptr)
+  {
+    perThreadData.reset(new PerThreadData);
+    this->InitializePerThreadData(*perThreadData);
+  }
+
+  this->GenerateSpectraRegion(outputRegionForThread, *perThreadData);
+
+  // The segment spectra are not shared between work units.
+  perThreadData->SegmentSpectra.clear();
+  perThreadData->PreviousSegmentSpectra.clear();
+  std::lock_guard<std::mutex> lock(this->m_PerThreadDataPoolMutex);
+  this->m_PerThreadDataPool.push_back(std::move(perThreadData));
+}
+
+
+template <typename TInputImage, typename TSupportWindowImage, typename TOutputImage>
+void
+Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::GenerateSpectraRegion(
+  const OutputImageRegionType & outputRegionForThread,
+  PerThreadData &               perThreadData)
 {
   OutputImageType *              output = this->GetOutput();
   const SupportWindowImageType * supportWindowImage = this->GetSupportWindowImage();
@@ -198,9 +730,21 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ThreadedGe
   OutputIteratorType outputIt(output, outputRegionForThread);
   outputIt.SetDirection(1);
 
-  const MetaDataDictionary & dict = supportWindowImage->GetMetaDataDictionary();
-  PerThreadData &            perThreadData = this->m_PerThreadDataContainer[threadId];
-  this->AddLineWindow(perThreadData.ComplexVector.size(), perThreadData.LineWindowMap);
+  // The spectra are written straight into the output buffer, normalized by
+  // the optional reference spectra for system noise, or into a scratch
+  // buffer that is reduced to a line fit or rounded to half precision.
+  const FFT1DSizeType      spectralComponents = perThreadData.SpectraVector.size();
+  const unsigned int       outputComponents = LinearFitOutput ? 3 : spectralComponents;
+  constexpr bool           useScratchSpectra = LinearFitOutput || HalfPrecisionOutput;
+  OutputComponentType *    outputBuffer = reinterpret_cast<OutputComponentType *>(output->GetBufferPointer());
+  const SpectraImageType * referenceSpectra = this->GetReferenceSpectraImage();
+  const ScalarType *       referenceBuffer = nullptr;
+  unsigned int             referenceComponents = 0;
+  if (referenceSpectra != nullptr)
+  {
+    referenceBuffer = referenceSpectra->GetBufferPointer();
+    referenceComponents = referenceSpectra->GetNumberOfComponentsPerPixel();
+  }
 
   SpectraLinesContainerType spectraLines;
 
@@ -213,6 +757,9 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ThreadedGe
        outputIt.NextLine(), supportWindowIt.NextLine())
   {
     spectraLines.clear();
+    // Only the segments of the previous row can be shared with this one.
+    perThreadData.PreviousSegmentSpectra.swap(perThreadData.SegmentSpectra);
+    perThreadData.SegmentSpectra.clear();
     while (!outputIt.IsAtEndOfLine())
     {
       // Compute the per line spectra.
@@ -224,7 +771,7 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ThreadedGe
              ++windowLine)
         {
           const IndexType & lineIndex = *windowLine;
-          this->ComputeSpectra(lineIndex, threadId, spectraLine);
+          this->ComputeSpectra(lineIndex, perThreadData, spectraLine);
           spectraLines.push_back(spectraLine);
         }
       }
@@ -244,14 +791,14 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ThreadedGe
           const IndexType & lineIndex = *windowLine;
           if (spectraLinesIt == spectraLinesEnd) // past the end of the previously processed lines
           {
-            this->ComputeSpectra(lineIndex, threadId, spectraLine);
+            this->ComputeSpectra(lineIndex, perThreadData, spectraLine);
             spectraLines.push_back(spectraLine);
           }
           else if (lineIndex[1] == (spectraLinesIt->first)[1]) // one of the same lines that was previously computed
           {
             if (lineIndex[0] != (spectraLinesIt->first)[0])
             {
-              this->ComputeSpectra(lineIndex, threadId, spectraLine);
+              this->ComputeSpectra(lineIndex, perThreadData, spectraLine);
               *spectraLinesIt = spectraLine;
             }
             ++spectraLinesIt;
@@ -264,74 +811,65 @@ Spectra1DImageFilter<TInputImage, TSupportWindowImage, TOutputImage>::ThreadedGe
       }
 
       // lateral window and sum
-      const size_t spectraLinesCount = spectraLines.size();
-      this->AddLineWindow(spectraLinesCount, perThreadData.LineWindowMap);
-      typename OutputImageType::PixelType outputPixel;
-      const FFT1DSizeType                 spectralComponents = perThreadData.SpectraVector.size();
-      outputPixel.SetSize(spectralComponents);
-      outputPixel.Fill(NumericTraits<ScalarType>::ZeroValue());
-      typename SpectraVectorType::const_iterator   windowIt = perThreadData.LineWindowMap[spectraLinesCount].begin();
-      typename SpectraLinesContainerType::iterator linesIt = spectraLines.begin();
-      for (size_t line = 0; line < spectraLinesCount; ++line)
+      const size_t       spectraLinesCount = spectraLines.size();
+      const ScalarType * window = this->GetLineWindow(spectraLinesCount);
+      OutputComponentType * const storedPixel =
+        outputBuffer + output->ComputeOffset(outputIt.GetIndex()) * outputComponents;
+      ScalarType * outputPixel =
+        useScratchSpectra ? perThreadData.OutputSpectra.data() : reinterpret_cast<ScalarType *>(storedPixel);
+      std::fill(outputPixel, outputPixel + spectralComponents, NumericTraits<ScalarType>::ZeroValue());
+      // The accumulation of each line is a unit stride loop over raw
+      // pointers, which the compiler vectorizes.
+      typename SpectraLinesContainerType::const_iterator linesIt = spectraLines.begin();
+      for (size_t line = 0; line < spectraLinesCount; ++line, ++linesIt)
       {
-        typename SpectraVectorType::const_iterator spectraIt = linesIt->second.begin();
+        const ScalarType * spectra = linesIt->second.data();
+        const ScalarType   weight = window[line];
         for (FFT1DSizeType sample = 0; sample < spectralComponents; ++sample)
         {
-          outputPixel[sample] += *windowIt * *spectraIt;
-          ++spectraIt;
+          outputPixel[sample] += weight * spectra[sample];
         }
-        ++windowIt;
-        ++linesIt;
       }
-      outputIt.Set(outputPixel);
-
-      ++outputIt;
-      ++supportWindowIt;
-    }
-  }
-
-  // Optionally normalize for system noise via reference spectra image input
-  const OutputImageType * referenceSpectra = this->GetReferenceSpectraImage();
-  if (referenceSpectra != nullptr)
-  {
-    using ReferenceSpectraIteratorType = ImageScanlineConstIterator<OutputImageType>;
-    ReferenceSpectraIteratorType referenceSpectraIt(referenceSpectra, outputRegionForThread);
-
-    using PopulatedOutputIteratorType = ImageScanlineIterator<OutputImageType>;
-    PopulatedOutputIteratorType populatedOutputIt(output, outputRegionForThread);
-
-    const unsigned int numberOfComponents = referenceSpectra->GetNumberOfComponentsPerPixel();
-    if (numberOfComponents != output->GetNumberOfComponentsPerPixel())
-    {
-      itkExceptionMacro("ReferenceSpectraImage has " << numberOfComponents << " while the output image has "
-                                                     << output->GetNumberOfComponentsPerPixel() << " components");
-    }
 
-    for (referenceSpectraIt.GoToBegin(), populatedOutputIt.GoToBegin(); !populatedOutputIt.IsAtEnd();)
-    {
-      while (!populatedOutputIt.IsAtEndOfLine())
+      // Optionally normalize for system noise via reference spectra image input
+      if (referenceBuffer != nullptr)
       {
-        using PixelType = typename OutputImageType::PixelType;
-        PixelType       outputPixel = populatedOutputIt.Get();
-        const PixelType referencePixel = referenceSpectraIt.Get();
-        for (unsigned int component = 0; component < numberOfComponents; ++component)
+        const ScalarType * referencePixel = referenceBuffer +
+                                            referenceSpectra->ComputeOffset(outputIt.GetIndex()) * referenceComponents +
+                                            this->m_ReferenceComponentOffset;
+        for (FFT1DSizeType sample = 0; sample < spectralComponents; ++sample)
         {
-          if (Math::FloatAlmostEqual(referencePixel[component], NumericTraits<typename PixelType::ValueType>::Zero))
+          if (Math::FloatAlmostEqual(referencePixel[sample], NumericTraits<ScalarType>::ZeroValue()))
           {
-            outputPixel[component] = NumericTraits<typename PixelType::ValueType>::Zero;
+            outputPixel[sample] = NumericTraits<ScalarType>::ZeroValue();
           }
           else
           {
-            outputPixel[component] /= referencePixel[component];
+            outputPixel[sample] /= referencePixel[sample];
           }
         }
-        populatedOutputIt.Set(outputPixel);
+      }
 
-        ++populatedOutputIt;
-        ++referenceSpectraIt;
+      if (this->m_DecibelOutput)
+      {
+        for (FFT1DSizeType sample = 0; sample < spectralComponents; ++sample)
+        {
+          outputPixel[sample] =
+            10.0 * std::log10(std::max(outputPixel[sample], NumericTraits<ScalarType>::min()));
+        }
       }
-      populatedOutputIt.NextLine();
-      referenceSpectraIt.NextLine();
+
+      if (LinearFitOutput)
+      {
+        this->StoreLinearFit(outputPixel, spectralComponents, reinterpret_cast<ScalarType *>(storedPixel));
+      }
+      else if (HalfPrecisionOutput)
+      {
+        ConvertHalfPrecisionBuffer(outputPixel, spectralComponents, storedPixel);
+      }
+
+      ++outputIt;
+      ++supportWindowIt;
     }
   }
 }
@@ -21,6 +21,7 @@
 #include <list>
 
 #include "itkImageToImageFilter.h"
+#include "itkSpectra1DCompactSupportWindow.h"
 
 namespace itk
 {
@@ -38,7 +39,17 @@ namespace itk
  * the window. The nominal size of the 1D FFT is specified with SetFFTSize()
  *
  * The overlap between windows is specified with SetStep(). By default, the
- * Step is only one sample.
+ * Step is only one sample.  The FFT1DSize and the Step are stored in the
+ * metadata dictionary of the output.
+ *
+ * The filter streams: a requested output region only requires the input
+ * pixels at the center of its windows.  The windows are truncated at the
+ * boundary of the largest possible region of the input, whatever region is
+ * requested.
+ *
+ * By default, each output pixel is a std::list of the indices of the lines
+ * in the window.  Pass Spectra1DCompactSupportWindow as TOutputPixel for a
+ * trivially copyable pixel that encodes the same lines as a range.
  *
  * This filter expects that beam input lies along the zeroth dimension and lateral lines
  * lie along the first dimension. Images not matching this description may be permuted
@@ -49,10 +60,9 @@ namespace itk
  * \sa Spectra1DImageFilter
  * \sa PermuteAxesImageFilter
  */
-template <typename TInputImage>
+template <typename TInputImage, typename TOutputPixel = std::list<typename TInputImage::IndexType>>
 class ITK_TEMPLATE_EXPORT Spectra1DSupportWindowImageFilter
-  : public ImageToImageFilter<TInputImage,
-                              Image<std::list<typename TInputImage::IndexType>, TInputImage::ImageDimension>>
+  : public ImageToImageFilter<TInputImage, Image<TOutputPixel, TInputImage::ImageDimension>>
 {
 public:
   ITK_DISALLOW_COPY_AND_ASSIGN(Spectra1DSupportWindowImageFilter);
@@ -62,7 +72,7 @@ public:
   using InputImageType = TInputImage;
   using IndexType = typename InputImageType::IndexType;
 
-  using OutputPixelType = std::list<IndexType>;
+  using OutputPixelType = TOutputPixel;
   using OutputImageType = Image<OutputPixelType, ImageDimension>;
 
   using FFT1DSizeType = unsigned int;
@@ -85,6 +95,13 @@ public:
   itkGetConstMacro(Step, SizeValueType);
   itkSetMacro(Step, SizeValueType);
 
+  /** Estimate, in bytes, the memory of the support windows of the given
+   * output region when they have the given number of lines.  With std::list
+   * pixels, every line of a window is a node of its list.  The number of lines
+   * is set by the input pixels, so it is a parameter; nothing is computed. */
+  SizeValueType
+  EstimateMemoryFootprint(const typename OutputImageType::RegionType & region, SizeValueType numberOfLines) const;
+
 protected:
   Spectra1DSupportWindowImageFilter();
   virtual ~Spectra1DSupportWindowImageFilter(){};
@@ -93,6 +110,8 @@ protected:
 
   void
   GenerateOutputInformation() override;
+  void
+  GenerateInputRequestedRegion() override;
 
   void
   DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
@@ -103,6 +122,21 @@ protected:
   PrintSelf(std::ostream & os, Indent indent) const override;
 
 private:
+  /** Bytes allocated per line of a window. */
+  template <typename TPixel>
+  static SizeValueType
+  GetWindowLineBytes(const TPixel *)
+  {
+    return 0;
+  }
+  template <typename TIndex, typename TAllocator>
+  static SizeValueType
+  GetWindowLineBytes(const std::list<TIndex, TAllocator> *)
+  {
+    // The index and the links of the list node.
+    return sizeof(TIndex) + 2 * sizeof(void *);
+  }
+
   FFT1DSizeType m_FFT1DSize;
   SizeValueType m_Step;
 };
@@ -20,23 +20,22 @@
 
 #include "itkSpectra1DSupportWindowImageFilter.h"
 #include "itkImageRegionIterator.h"
-#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkMetaDataObject.h"
 #include "itkImageScanlineIterator.h"
 
 namespace itk
 {
 
-template <typename TInputImage>
-Spectra1DSupportWindowImageFilter<TInputImage>::Spectra1DSupportWindowImageFilter()
+template <typename TInputImage, typename TOutputPixel>
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::Spectra1DSupportWindowImageFilter()
   : m_FFT1DSize(32)
   , m_Step(1)
 {}
 
 
-template <typename TInputImage>
+template <typename TInputImage, typename TOutputPixel>
 void
-Spectra1DSupportWindowImageFilter<TInputImage>::GenerateOutputInformation()
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::GenerateOutputInformation()
 {
   Superclass::GenerateOutputInformation();
 
@@ -55,12 +54,40 @@ Spectra1DSupportWindowImageFilter<TInputImage>::GenerateOutputInformation()
 
   MetaDataDictionary & dict = output->GetMetaDataDictionary();
   EncapsulateMetaData<FFT1DSizeType>(dict, "FFT1DSize", this->GetFFT1DSize());
+  EncapsulateMetaData<SizeValueType>(dict, "Step", this->GetStep());
 }
 
 
-template <typename TInputImage>
+template <typename TInputImage, typename TOutputPixel>
 void
-Spectra1DSupportWindowImageFilter<TInputImage>::DynamicThreadedGenerateData(
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (!input)
+  {
+    return;
+  }
+
+  // The output pixels are every Step input pixels along the beam.
+  const typename InputImageType::RegionType & inputLargestRegion = input->GetLargestPossibleRegion();
+  const OutputImageRegionType &               outputRequestedRegion = this->GetOutput()->GetRequestedRegion();
+  typename InputImageType::RegionType         inputRequestedRegion = outputRequestedRegion;
+  const SizeValueType                         sampleStep = this->GetStep();
+  inputRequestedRegion.SetIndex(0,
+                                inputLargestRegion.GetIndex(0) +
+                                  (outputRequestedRegion.GetIndex(0) - inputLargestRegion.GetIndex(0)) *
+                                    static_cast<IndexValueType>(sampleStep));
+  inputRequestedRegion.SetSize(0, outputRequestedRegion.GetSize(0) * sampleStep);
+  inputRequestedRegion.Crop(inputLargestRegion);
+  input->SetRequestedRegion(inputRequestedRegion);
+}
+
+
+template <typename TInputImage, typename TOutputPixel>
+void
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::DynamicThreadedGenerateData(
   const OutputImageRegionType & outputRegionForThread)
 {
   OutputImageType *      output = this->GetOutput();
@@ -75,8 +102,6 @@ Spectra1DSupportWindowImageFilter<TInputImage>::DynamicThreadedGenerateData(
     largestIndexStop[dim] -= 1;
   }
 
-  using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-  InputIteratorType inputIt(input, outputRegionForThread);
   using OutputIteratorType = ImageScanlineIterator<OutputImageType>;
   OutputIteratorType  outputIt(output, outputRegionForThread);
   const FFT1DSizeType fftSize = this->GetFFT1DSize();
@@ -85,16 +110,18 @@ Spectra1DSupportWindowImageFilter<TInputImage>::DynamicThreadedGenerateData(
   {
     itkExceptionMacro("Insufficient size in the FFT direction.");
   }
-  for (inputIt.GoToBegin(), outputIt.GoToBegin(); !outputIt.IsAtEnd();)
+  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); outputIt.NextLine())
   {
+    // The center of the window of an output pixel is every Step input
+    // pixels from the start of the largest possible region.
+    IndexType inputIndex = outputIt.GetIndex();
+    inputIndex[0] = largestIndexStart[0] + (inputIndex[0] - largestIndexStart[0]) * sampleStep;
     while (!outputIt.IsAtEndOfLine())
     {
       OutputPixelType & supportWindow = outputIt.Value();
       supportWindow.clear();
 
-      const IndexType inputIndex = inputIt.GetIndex();
-
-      IndexType lineIndex;
+      IndexType lineIndex = inputIndex;
       lineIndex[0] = inputIndex[0] - fftSize / 2;
       if (lineIndex[0] < largestIndexStart[0])
       {
@@ -106,7 +133,7 @@ Spectra1DSupportWindowImageFilter<TInputImage>::DynamicThreadedGenerateData(
         lineIndex[0] = largestIndexStop[0] - fftSize;
       }
 
-      const IndexValueType sideLines = static_cast<IndexValueType>(inputIt.Get());
+      const IndexValueType sideLines = static_cast<IndexValueType>(input->GetPixel(inputIndex));
       for (IndexValueType line = inputIndex[1] - sideLines; line < inputIndex[1] + sideLines; ++line)
       {
         if (line < largestIndexStart[1] || line > largestIndexStop[1])
@@ -116,27 +143,33 @@ Spectra1DSupportWindowImageFilter<TInputImage>::DynamicThreadedGenerateData(
         lineIndex[1] = line;
         supportWindow.push_back(lineIndex);
       }
-      for (SizeValueType ii = 0; ii < sampleStep; ++ii)
-      {
-        ++inputIt;
-      }
+      inputIndex[0] += sampleStep;
       ++outputIt;
     }
-    inputIt.NextLine();
-    outputIt.NextLine();
   }
 }
 
 
-template <typename TInputImage>
+template <typename TInputImage, typename TOutputPixel>
 void
-Spectra1DSupportWindowImageFilter<TInputImage>::AfterThreadedGenerateData()
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::AfterThreadedGenerateData()
 {}
 
 
-template <typename TInputImage>
+template <typename TInputImage, typename TOutputPixel>
+SizeValueType
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::EstimateMemoryFootprint(
+  const typename OutputImageType::RegionType & region,
+  SizeValueType                                numberOfLines) const
+{
+  const SizeValueType lineBytes = GetWindowLineBytes(static_cast<const OutputPixelType *>(nullptr));
+  return region.GetNumberOfPixels() * (sizeof(OutputPixelType) + numberOfLines * lineBytes);
+}
+
+
+template <typename TInputImage, typename TOutputPixel>
 void
-Spectra1DSupportWindowImageFilter<TInputImage>::PrintSelf(std::ostream & os, Indent indent) const
+Spectra1DSupportWindowImageFilter<TInputImage, TOutputPixel>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
 
@@ -26,6 +26,10 @@ namespace itk
 /** \class Spectra1DSupportWindowToMaskImageFilter
  * \brief Generate a mask image from the support window at a given index.
  *
+ * Only the support window at the MaskIndex is requested from the input, and
+ * only the requested region of the mask is generated, so the filter
+ * streams.
+ *
  * \ingroup Ultrasound
  */
 template <typename TInputImage, typename TOutputImage>
@@ -67,6 +71,9 @@ protected:
   Spectra1DSupportWindowToMaskImageFilter();
   virtual ~Spectra1DSupportWindowToMaskImageFilter(){};
 
+  void
+  GenerateInputRequestedRegion() override;
+
   virtual void
   GenerateData() override;
 
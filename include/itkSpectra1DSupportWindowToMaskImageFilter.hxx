@@ -36,6 +36,30 @@ Spectra1DSupportWindowToMaskImageFilter<TInputImage, TOutputImage>::Spectra1DSup
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+void
+Spectra1DSupportWindowToMaskImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (!input)
+  {
+    return;
+  }
+
+  typename InputImageType::SizeType maskSize;
+  maskSize.Fill(1);
+  const typename InputImageType::RegionType maskRegion(this->GetMaskIndex(), maskSize);
+  if (!input->GetLargestPossibleRegion().IsInside(maskRegion))
+  {
+    itkExceptionMacro("MaskIndex " << this->GetMaskIndex() << " is outside of the input largest possible region "
+                                   << input->GetLargestPossibleRegion());
+  }
+  input->SetRequestedRegion(maskRegion);
+}
+
+
 template <typename TInputImage, typename TOutputImage>
 void
 Spectra1DSupportWindowToMaskImageFilter<TInputImage, TOutputImage>::GenerateData()
@@ -55,6 +79,7 @@ Spectra1DSupportWindowToMaskImageFilter<TInputImage, TOutputImage>::GenerateData
 
   OutputImageType * output = this->GetOutput();
   output->FillBuffer(this->GetBackgroundValue());
+  const typename OutputImageType::RegionType & outputRegion = output->GetBufferedRegion();
 
   for (typename InputPixelType::const_iterator lineIt = inputPixel.begin(); lineIt != inputPixel.end(); ++lineIt)
   {
@@ -63,7 +88,10 @@ Spectra1DSupportWindowToMaskImageFilter<TInputImage, TOutputImage>::GenerateData
     for (FFT1DSizeType sampleIndex = 0; sampleIndex < fft1DSize; ++sampleIndex)
     {
       index[0] = startIndex[0] + sampleIndex;
-      output->SetPixel(index, this->GetForegroundValue());
+      if (outputRegion.IsInside(index))
+      {
+        output->SetPixel(index, this->GetForegroundValue());
+      }
     }
   }
 }
@@ -0,0 +1,156 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSpectralDifferenceAttenuationImageFilter_h
+#define itkSpectralDifferenceAttenuationImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkVectorImage.h"
+
+namespace itk
+{
+
+/** \class SpectralDifferenceAttenuationImageFilter
+ * \brief Estimate the attenuation coefficient slope from the change of the
+ * local spectra with depth.
+ *
+ * The input is an image of local power spectra, as generated by
+ * Spectra1DImageFilter, with the axial direction, the direction of
+ * propagation, along the first direction.  Usually the spectra are
+ * normalized by the ReferenceSpectraImage of a phantom, so that the
+ * diffraction and the system response cancel out.  With the spectra in
+ * decibels, the attenuation at frequency f over the depth z is the slope
+ * of the spectrum along depth, -2 alpha(f), for the round trip.  With
+ * alpha(f) = beta f, the output is beta, the least squares fit over the
+ * frequencies and over the spectra within AxialRadius pixels of every
+ * output pixel, in decibels per unit of the axial spacing per unit of
+ * frequency.  The windows are cropped at the ends of the lines.
+ *
+ * The frequency of component k of the spectra is FirstFrequency + k
+ * FrequencyStep.  For the spectra of Spectra1DImageFilter, which start at
+ * the bin after FirstFrequencyBin, these are (FirstFrequencyBin + 1 + k) /
+ * (FFT1DSize / 2) times its SamplingFrequency.  Turn DecibelInput on when
+ * the spectra are already in decibels, e.g. with its DecibelOutput on.
+ *
+ * Since the fit is linear in the spectra, it only needs, for each spectrum,
+ * the sum of its components weighted by their frequency, which is then
+ * regressed against depth with running sums along the line.  The spectra
+ * are streamed through the filter: the requested region is split along
+ * the axial direction into NumberOfSlabs slabs, and the input is updated
+ * for one slab, padded by AxialRadius, at a time, so that the whole spectra
+ * image is never generated when its source streams, as
+ * Spectra1DImageFilter does.  The lines of a slab are processed in
+ * parallel.
+ *
+ * \sa Spectra1DImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TSpectraImage,
+          typename TOutputImage =
+            Image<typename NumericTraits<typename TSpectraImage::PixelType>::ValueType, TSpectraImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT SpectralDifferenceAttenuationImageFilter
+  : public ImageToImageFilter<TSpectraImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SpectralDifferenceAttenuationImageFilter);
+
+  /** Standard class type alias. */
+  using Self = SpectralDifferenceAttenuationImageFilter;
+  using Superclass = ImageToImageFilter<TSpectraImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SpectralDifferenceAttenuationImageFilter, ImageToImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TSpectraImage::ImageDimension);
+
+  using SpectraImageType = TSpectraImage;
+  using SpectraRegionType = typename SpectraImageType::RegionType;
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+
+  /** Number of spectra on each side of an output pixel along the axial
+   * direction that its fit spans.  4 by default. */
+  itkSetClampMacro(AxialRadius, SizeValueType, 1, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(AxialRadius, SizeValueType);
+
+  /** Frequency of the first component of the spectra, and the frequency
+   * step between components.  Both are 1 by default. */
+  itkSetMacro(FirstFrequency, double);
+  itkGetConstMacro(FirstFrequency, double);
+  itkSetMacro(FrequencyStep, double);
+  itkGetConstMacro(FrequencyStep, double);
+
+  /** Whether the spectra are in decibels rather than power.  Off by
+   * default. */
+  itkSetMacro(DecibelInput, bool);
+  itkGetConstMacro(DecibelInput, bool);
+  itkBooleanMacro(DecibelInput);
+
+  /** Number of slabs along the axial direction the input is updated for in
+   * turn.  8 by default. */
+  itkSetClampMacro(NumberOfSlabs, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfSlabs, unsigned int);
+
+protected:
+  SpectralDifferenceAttenuationImageFilter() = default;
+  ~SpectralDifferenceAttenuationImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Only request the input of the first slab; the others are requested
+   * while the output is generated. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  GenerateData() override;
+
+private:
+  /** Number of slabs the output region is split into. */
+  unsigned int
+  GetNumberOfSlabs(const OutputRegionType & outputRegion) const;
+
+  /** The output region of a slab and the input region its fits span. */
+  void
+  ComputeSlabRegions(const OutputRegionType & outputRegion,
+                     unsigned int             slab,
+                     unsigned int             numberOfSlabs,
+                     OutputRegionType &       outputSlabRegion,
+                     SpectraRegionType &      inputSlabRegion) const;
+
+  SizeValueType m_AxialRadius{ 4 };
+  double        m_FirstFrequency{ 1.0 };
+  double        m_FrequencyStep{ 1.0 };
+  bool          m_DecibelInput{ false };
+  unsigned int  m_NumberOfSlabs{ 8 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSpectralDifferenceAttenuationImageFilter.hxx"
+#endif
+
+#endif // itkSpectralDifferenceAttenuationImageFilter_h
@@ -0,0 +1,241 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSpectralDifferenceAttenuationImageFilter_hxx
+#define itkSpectralDifferenceAttenuationImageFilter_hxx
+
+#include "itkSpectralDifferenceAttenuationImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace itk
+{
+
+template <typename TSpectraImage, typename TOutputImage>
+unsigned int
+SpectralDifferenceAttenuationImageFilter<TSpectraImage, TOutputImage>::GetNumberOfSlabs(
+  const OutputRegionType & outputRegion) const
+{
+  return static_cast<unsigned int>(
+    std::max(std::min(static_cast<SizeValueType>(m_NumberOfSlabs), outputRegion.GetSize(0)), SizeValueType{ 1 }));
+}
+
+
+template <typename TSpectraImage, typename TOutputImage>
+void
+SpectralDifferenceAttenuationImageFilter<TSpectraImage, TOutputImage>::ComputeSlabRegions(
+  const OutputRegionType & outputRegion,
+  unsigned int             slab,
+  unsigned int             numberOfSlabs,
+  OutputRegionType &       outputSlabRegion,
+  SpectraRegionType &      inputSlabRegion) const
+{
+  const SizeValueType  length = outputRegion.GetSize(0);
+  const SizeValueType  slabBegin = length * slab / numberOfSlabs;
+  const SizeValueType  slabEnd = length * (slab + 1) / numberOfSlabs;
+  const IndexValueType outputStart = outputRegion.GetIndex(0) + static_cast<IndexValueType>(slabBegin);
+  outputSlabRegion = outputRegion;
+  outputSlabRegion.SetIndex(0, outputStart);
+  outputSlabRegion.SetSize(0, slabEnd - slabBegin);
+
+  // The fits of the slab span AxialRadius more spectra on each side, within
+  // the lines.
+  const SpectraRegionType & largestRegion = this->GetInput()->GetLargestPossibleRegion();
+  const IndexValueType      radius = static_cast<IndexValueType>(m_AxialRadius);
+  const IndexValueType      largestEnd =
+    largestRegion.GetIndex(0) + static_cast<IndexValueType>(largestRegion.GetSize(0)) - 1;
+  const IndexValueType inputStart = std::max(outputStart - radius, largestRegion.GetIndex(0));
+  const IndexValueType inputEnd =
+    std::min(outputStart + static_cast<IndexValueType>(slabEnd - slabBegin) - 1 + radius, largestEnd);
+  inputSlabRegion = outputSlabRegion;
+  inputSlabRegion.SetIndex(0, inputStart);
+  inputSlabRegion.SetSize(0, static_cast<SizeValueType>(inputEnd - inputStart + 1));
+}
+
+
+template <typename TSpectraImage, typename TOutputImage>
+void
+SpectralDifferenceAttenuationImageFilter<TSpectraImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  SpectraImageType * input = const_cast<SpectraImageType *>(this->GetInput());
+  if (!input)
+  {
+    return;
+  }
+  const OutputRegionType & outputRegion = this->GetOutput()->GetRequestedRegion();
+  OutputRegionType         outputSlabRegion;
+  SpectraRegionType        inputSlabRegion;
+  this->ComputeSlabRegions(
+    outputRegion, 0, this->GetNumberOfSlabs(outputRegion), outputSlabRegion, inputSlabRegion);
+  input->SetRequestedRegion(inputSlabRegion);
+}
+
+
+template <typename TSpectraImage, typename TOutputImage>
+void
+SpectralDifferenceAttenuationImageFilter<TSpectraImage, TOutputImage>::GenerateData()
+{
+  this->AllocateOutputs();
+
+  SpectraImageType * input = const_cast<SpectraImageType *>(this->GetInput());
+  OutputImageType *  output = this->GetOutput();
+  using ComponentType = typename SpectraImageType::InternalPixelType;
+  using IndexType = typename OutputImageType::IndexType;
+
+  // The fit of beta over the frequencies, sum(f alpha(f)) / sum(f^2), is
+  // the fit along depth of the spectra weighted by their frequency.
+  const unsigned int  numberOfComponents = input->GetNumberOfComponentsPerPixel();
+  std::vector<double> frequencies(numberOfComponents);
+  double              sumOfSquaredFrequencies = 0.0;
+  for (unsigned int component = 0; component < numberOfComponents; ++component)
+  {
+    frequencies[component] = m_FirstFrequency + component * m_FrequencyStep;
+    sumOfSquaredFrequencies += frequencies[component] * frequencies[component];
+  }
+  if (!(sumOfSquaredFrequencies > 0.0))
+  {
+    itkExceptionMacro("The frequencies of the spectra must not all be 0.");
+  }
+  // The slope of the spectra is -2 alpha, for the round trip.
+  const double scale = -0.5 / (sumOfSquaredFrequencies * input->GetSpacing()[0]);
+
+  const OutputRegionType outputRegion = output->GetRequestedRegion();
+  OutputRegionType       lineStartRegion = outputRegion;
+  lineStartRegion.SetSize(0, 1);
+  std::vector<IndexType>                             lineStarts;
+  ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
+  {
+    lineStarts.push_back(lineIt.GetIndex());
+  }
+
+  OutputPixelType *   outputBuffer = output->GetBufferPointer();
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  const unsigned int numberOfSlabs = this->GetNumberOfSlabs(outputRegion);
+  for (unsigned int slab = 0; slab < numberOfSlabs; ++slab)
+  {
+    OutputRegionType  outputSlabRegion;
+    SpectraRegionType inputSlabRegion;
+    this->ComputeSlabRegions(outputRegion, slab, numberOfSlabs, outputSlabRegion, inputSlabRegion);
+
+    // The input stays connected to its source, which only generates the
+    // spectra of the slab when it streams.
+    input->SetRequestedRegion(inputSlabRegion);
+    input->PropagateRequestedRegion();
+    input->UpdateOutputData();
+
+    const ComponentType * inputBuffer = input->GetBufferPointer();
+    const IndexValueType  inputStart = inputSlabRegion.GetIndex(0);
+    const IndexValueType  inputLength = static_cast<IndexValueType>(inputSlabRegion.GetSize(0));
+    const IndexValueType  outputStart = outputSlabRegion.GetIndex(0);
+    const IndexValueType  outputLength = static_cast<IndexValueType>(outputSlabRegion.GetSize(0));
+    const IndexValueType  radius = static_cast<IndexValueType>(m_AxialRadius);
+    multiThreader->ParallelizeArray(
+      0,
+      lineStarts.size(),
+      [&](SizeValueType line) {
+        IndexType index = lineStarts[line];
+        index[0] = inputStart;
+        const ComponentType * spectra = inputBuffer + input->ComputeOffset(index) * numberOfComponents;
+        std::vector<double>   weighted(inputLength);
+        for (IndexValueType ii = 0; ii < inputLength; ++ii)
+        {
+          double sum = 0.0;
+          for (unsigned int component = 0; component < numberOfComponents; ++component)
+          {
+            double value = static_cast<double>(spectra[component]);
+            if (!m_DecibelInput)
+            {
+              value = 10.0 * std::log10(std::max(value, NumericTraits<double>::min()));
+            }
+            sum += frequencies[component] * value;
+          }
+          weighted[ii] = sum;
+          spectra += numberOfComponents;
+        }
+
+        // Running sums of the line fit over the window of every output
+        // pixel, with the positions counted from the start of the slab.
+        double     count = 0.0;
+        double     sumOfPositions = 0.0;
+        double     sumOfSquaredPositions = 0.0;
+        double     sumOfValues = 0.0;
+        double     sumOfProducts = 0.0;
+        const auto accumulate = [&](IndexValueType position, double sign) {
+          const double x = static_cast<double>(position);
+          count += sign;
+          sumOfPositions += sign * x;
+          sumOfSquaredPositions += sign * x * x;
+          sumOfValues += sign * weighted[position];
+          sumOfProducts += sign * x * weighted[position];
+        };
+        const IndexValueType first = outputStart - inputStart;
+        for (IndexValueType position = std::max(first - radius, IndexValueType{ 0 });
+             position <= std::min(first + radius, inputLength - 1);
+             ++position)
+        {
+          accumulate(position, 1.0);
+        }
+        index = lineStarts[line];
+        index[0] = outputStart;
+        OutputPixelType * outputLine = outputBuffer + output->ComputeOffset(index);
+        for (IndexValueType ii = 0; ii < outputLength; ++ii)
+        {
+          const double denominator = count * sumOfSquaredPositions - sumOfPositions * sumOfPositions;
+          const double slope =
+            denominator > 0.0 ? (count * sumOfProducts - sumOfPositions * sumOfValues) / denominator : 0.0;
+          outputLine[ii] = static_cast<OutputPixelType>(scale * slope);
+          const IndexValueType position = first + ii;
+          if (position - radius >= 0)
+          {
+            accumulate(position - radius, -1.0);
+          }
+          if (position + radius + 1 < inputLength)
+          {
+            accumulate(position + radius + 1, 1.0);
+          }
+        }
+      },
+      nullptr);
+  }
+}
+
+
+template <typename TSpectraImage, typename TOutputImage>
+void
+SpectralDifferenceAttenuationImageFilter<TSpectraImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                  Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "AxialRadius: " << m_AxialRadius << std::endl;
+  os << indent << "FirstFrequency: " << m_FirstFrequency << std::endl;
+  os << indent << "FrequencyStep: " << m_FrequencyStep << std::endl;
+  os << indent << "DecibelInput: " << (m_DecibelInput ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfSlabs: " << m_NumberOfSlabs << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSpectralDifferenceAttenuationImageFilter_hxx
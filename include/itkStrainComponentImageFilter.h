@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkStrainComponentImageFilter_h
+#define itkStrainComponentImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkFixedArray.h"
+
+namespace itk
+{
+
+/** \class StrainComponentImageFilter
+ *
+ * \brief Compute one component of the infinitesimal strain tensor of a
+ * displacement image in a single pass.
+ *
+ * The component (i, j) of the strain is (du_i/dx_j + du_j/dx_i) / 2, e.g.
+ * the axial strain (0, 0) of the displacements of a
+ * BlockMatching::DisplacementPipeline.  The derivatives are the slopes of
+ * linear least squares fits to the displacement components within the Radius
+ * along the direction of derivation, read directly from the input buffer, so
+ * that no gradient or tensor image is allocated, and the output is streamed
+ * like the input.  Near the boundary of the input, the fits are restricted
+ * to the samples within it.  With the default radius of 1, the derivatives
+ * are central differences away from the boundary, as with the default
+ * gradient filter of StrainImageFilter.
+ *
+ * The derivatives are with respect to the image grid, scaled by the spacing;
+ * the direction cosines are not taken into account.
+ *
+ * \sa StrainImageFilter
+ * \sa LinearLeastSquaresGradientImageFilter
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TDisplacementImage,
+          typename TOutputImage =
+            Image<typename TDisplacementImage::PixelType::ValueType, TDisplacementImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT StrainComponentImageFilter : public ImageToImageFilter<TDisplacementImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(StrainComponentImageFilter);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TDisplacementImage::ImageDimension);
+
+  using DisplacementImageType = TDisplacementImage;
+  using DisplacementType = typename DisplacementImageType::PixelType;
+  using OutputImageType = TOutputImage;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using RadiusType = typename DisplacementImageType::SizeType;
+  using ComponentType = FixedArray<unsigned int, 2>;
+
+  /** Standard class type alias. */
+  using Self = StrainComponentImageFilter;
+  using Superclass = ImageToImageFilter<DisplacementImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(StrainComponentImageFilter, ImageToImageFilter);
+
+  /** Set/Get the radius of the linear least squares fits along every
+   * direction.  Defaults to 1. */
+  itkSetMacro(Radius, RadiusType);
+  itkGetConstReferenceMacro(Radius, RadiusType);
+
+  /** Set/Get the indices (i, j) of the component of the strain tensor.
+   * Defaults to (0, 0). */
+  itkSetMacro(Component, ComponentType);
+  itkGetConstReferenceMacro(Component, ComponentType);
+  void
+  SetComponent(unsigned int i, unsigned int j)
+  {
+    ComponentType component;
+    component[0] = i;
+    component[1] = j;
+    this->SetComponent(component);
+  }
+
+protected:
+  StrainComponentImageFilter();
+  ~StrainComponentImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+private:
+  RadiusType    m_Radius;
+  ComponentType m_Component;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkStrainComponentImageFilter.hxx"
+#endif
+
+#endif // itkStrainComponentImageFilter_h
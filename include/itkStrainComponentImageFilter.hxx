@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkStrainComponentImageFilter_hxx
+#define itkStrainComponentImageFilter_hxx
+
+#include "itkStrainComponentImageFilter.h"
+
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <typename TDisplacementImage, typename TOutputImage>
+StrainComponentImageFilter<TDisplacementImage, TOutputImage>::StrainComponentImageFilter()
+{
+  m_Radius.Fill(1);
+  m_Component.Fill(0);
+  this->DynamicMultiThreadingOn();
+}
+
+
+template <typename TDisplacementImage, typename TOutputImage>
+void
+StrainComponentImageFilter<TDisplacementImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * input = const_cast<DisplacementImageType *>(this->GetInput());
+  if (input == nullptr)
+  {
+    return;
+  }
+
+  // The fits need the samples within the radius, when they are in the
+  // largest possible region.
+  typename DisplacementImageType::RegionType requestedRegion = this->GetOutput()->GetRequestedRegion();
+  requestedRegion.PadByRadius(m_Radius);
+  if (!requestedRegion.Crop(input->GetLargestPossibleRegion()))
+  {
+    input->SetRequestedRegion(requestedRegion);
+
+    InvalidRequestedRegionError e(__FILE__, __LINE__);
+    e.SetLocation(ITK_LOCATION);
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+    e.SetDataObject(input);
+    throw e;
+  }
+  input->SetRequestedRegion(requestedRegion);
+}
+
+
+template <typename TDisplacementImage, typename TOutputImage>
+void
+StrainComponentImageFilter<TDisplacementImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  if (m_Component[0] >= ImageDimension || m_Component[1] >= ImageDimension)
+  {
+    itkExceptionMacro(<< "The component (" << m_Component[0] << ", " << m_Component[1]
+                      << ") is not a component of the strain tensor.");
+  }
+}
+
+
+template <typename TDisplacementImage, typename TOutputImage>
+void
+StrainComponentImageFilter<TDisplacementImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const DisplacementImageType *                       input = this->GetInput();
+  OutputImageType *                                   output = this->GetOutput();
+  const typename DisplacementImageType::RegionType &  bufferedRegion = input->GetBufferedRegion();
+  const DisplacementType *                            inputBuffer = input->GetBufferPointer();
+  const OffsetValueType *                             offsetTable = input->GetOffsetTable();
+  const typename DisplacementImageType::SpacingType & spacing = input->GetSpacing();
+
+  // The terms of the strain: du_i/dx_j, and du_j/dx_i when i != j.
+  const unsigned int numberOfTerms = m_Component[0] == m_Component[1] ? 1 : 2;
+  const unsigned int components[2] = { m_Component[0], m_Component[1] };
+  const unsigned int directions[2] = { m_Component[1], m_Component[0] };
+  const double       termWeight = 1.0 / numberOfTerms;
+
+  ImageRegionIteratorWithIndex<OutputImageType> it(output, outputRegionForThread);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const typename OutputImageType::IndexType & index = it.GetIndex();
+    const DisplacementType *                    center = inputBuffer + input->ComputeOffset(index);
+    double                                      strain = 0.0;
+    for (unsigned int term = 0; term < numberOfTerms; ++term)
+    {
+      const unsigned int   direction = directions[term];
+      const unsigned int   component = components[term];
+      const IndexValueType start = bufferedRegion.GetIndex(direction);
+      const IndexValueType end = start + static_cast<IndexValueType>(bufferedRegion.GetSize(direction)) - 1;
+      const auto           radius = static_cast<IndexValueType>(m_Radius[direction]);
+      const IndexValueType first = std::max(index[direction] - radius, start);
+      const IndexValueType last = std::min(index[direction] + radius, end);
+      if (last <= first)
+      {
+        continue;
+      }
+
+      // The slope of the fit to the samples first, ..., last.
+      const double          count = static_cast<double>(last - first + 1);
+      const double          mean = 0.5 * static_cast<double>(first + last);
+      const OffsetValueType stride = offsetTable[direction];
+      double                slope = 0.0;
+      for (IndexValueType k = first; k <= last; ++k)
+      {
+        const DisplacementType & displacement = center[(k - index[direction]) * stride];
+        slope += (static_cast<double>(k) - mean) * static_cast<double>(displacement[component]);
+      }
+      slope *= 12.0 / (count * (count * count - 1.0));
+      strain += termWeight * slope / spacing[direction];
+    }
+    it.Set(static_cast<OutputPixelType>(strain));
+  }
+}
+
+
+template <typename TDisplacementImage, typename TOutputImage>
+void
+StrainComponentImageFilter<TDisplacementImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "Component: " << m_Component << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkStrainComponentImageFilter_hxx
@@ -31,6 +31,9 @@ namespace itk
  *
  * \brief A simple command that outputs a text progress bar the associated filter.
  *
+ * The bar is only printed when it changes, so frequent progress events cost
+ * little more than a comparison.
+ *
  * \ingroup Ultrasound
  * */
 class Ultrasound_EXPORT TextProgressBarCommand : public Command
@@ -51,7 +54,8 @@ protected:
   void
   Execute(const itk::Object * object, const itk::EventObject & event) override;
 
-  std::string m_Progress;
+  std::string  m_Progress;
+  unsigned int m_Position;
 };
 
 } // end namespace itk
@@ -0,0 +1,201 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkThreadedFramePipeline_h
+#define itkThreadedFramePipeline_h
+
+#include "itkImageToImageFilter.h"
+#include "itkObject.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ThreadedFramePipeline
+ * \brief Overlap the acquisition, processing and display of frames on three
+ * threads, with fixed rings of preallocated frames.
+ *
+ * The FrameSource, typically reading from a file or a probe, fills an input
+ * frame and returns false at the end of the sequence.  The FrameFilter, for
+ * example a BModeImageFilter, computes an output frame from it, and the
+ * FrameSink, typically the display, receives the output frames in order.
+ * Run() calls the source and the filter on two threads, and the sink on the
+ * calling thread, so that the three stages work on different frames at the
+ * same time.
+ *
+ * The input frames are NumberOfSlots images allocated like the
+ * ReferenceInputFrame, and the output frames NumberOfSlots images grafted
+ * onto the output of the filter, which allocates their buffers for the
+ * first frames and reuses them afterwards.  A stage waits when the next
+ * stage has not released a slot, so at most 2 * NumberOfSlots frames are in
+ * flight and the latency is bounded.  The frame passed to the sink is valid
+ * until the sink returns.
+ *
+ * An exception in any stage stops the others, and is rethrown by Run().
+ *
+ * \sa RingBufferedVideoFilter
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TInputFrame, typename TOutputFrame>
+class ITK_TEMPLATE_EXPORT ThreadedFramePipeline : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ThreadedFramePipeline);
+
+  /** Standard class type alias. */
+  using Self = ThreadedFramePipeline;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkTypeMacro(ThreadedFramePipeline, Object);
+  itkNewMacro(Self);
+
+  using InputFrameType = TInputFrame;
+  using OutputFrameType = TOutputFrame;
+  using FrameFilterType = ImageToImageFilter<InputFrameType, OutputFrameType>;
+
+  /** Fill the frame, whose buffer is allocated, and return true, or return
+   * false at the end of the sequence. */
+  using FrameSourceType = std::function<bool(InputFrameType *)>;
+
+  /** Receive the output frames in order. */
+  using FrameSinkType = std::function<void(const OutputFrameType *)>;
+
+  void
+  SetFrameSource(const FrameSourceType & frameSource)
+  {
+    m_FrameSource = frameSource;
+    this->Modified();
+  }
+
+  void
+  SetFrameSink(const FrameSinkType & frameSink)
+  {
+    m_FrameSink = frameSink;
+    this->Modified();
+  }
+
+  /** The filter run on every frame. */
+  itkSetObjectMacro(FrameFilter, FrameFilterType);
+  itkGetModifiableObjectMacro(FrameFilter, FrameFilterType);
+
+  /** The regions, spacing, origin and direction of the input frames. */
+  itkSetConstObjectMacro(ReferenceInputFrame, InputFrameType);
+  itkGetConstObjectMacro(ReferenceInputFrame, InputFrameType);
+
+  /** Number of frames of each ring.  Defaults to 3. */
+  itkSetClampMacro(NumberOfSlots, SizeValueType, 1, NumericTraits<SizeValueType>::max() - 2);
+  itkGetConstMacro(NumberOfSlots, SizeValueType);
+
+  /** Process the frames of the source until its end.  Returns the number of
+   * frames passed to the sink. */
+  SizeValueType
+  Run();
+
+  /** Number of frames passed to the sink by the last Run(). */
+  itkGetConstMacro(NumberOfFrames, SizeValueType);
+
+  /** Longest time, in seconds, from the end of the acquisition of a frame to
+   * the start of its display in the last Run(). */
+  itkGetConstMacro(MaximumLatency, double);
+
+protected:
+  ThreadedFramePipeline() = default;
+  ~ThreadedFramePipeline() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  using ClockType = std::chrono::steady_clock;
+
+  /** A bounded queue of slot indices.  Pop() returns EndOfFrames after the
+   * end marker, or once the queue is aborted. */
+  class SlotQueue
+  {
+  public:
+    void
+    Reset(SizeValueType capacity);
+
+    void
+    Push(SizeValueType slot);
+
+    SizeValueType
+    Pop();
+
+    void
+    Abort();
+
+  private:
+    std::mutex                 m_Mutex;
+    std::condition_variable    m_Condition;
+    std::vector<SizeValueType> m_Slots;
+    SizeValueType              m_Head{ 0 };
+    SizeValueType              m_Tail{ 0 };
+    bool                       m_Aborted{ false };
+  };
+
+  static constexpr SizeValueType EndOfFrames = NumericTraits<SizeValueType>::max();
+
+  /** Allocate the input slots when the reference frame or the number of
+   * slots changed. */
+  void
+  AllocateSlots();
+
+  /** The stages. */
+  void
+  AcquireFrames();
+  void
+  FilterFrames();
+  void
+  DisplayFrames();
+
+  void
+  AbortQueues();
+
+  FrameSourceType                                m_FrameSource;
+  FrameSinkType                                  m_FrameSink;
+  typename FrameFilterType::Pointer              m_FrameFilter;
+  typename InputFrameType::ConstPointer          m_ReferenceInputFrame;
+  SizeValueType                                  m_NumberOfSlots{ 3 };
+  SizeValueType                                  m_NumberOfFrames{ 0 };
+  double                                         m_MaximumLatency{ 0.0 };
+  std::vector<typename InputFrameType::Pointer>  m_InputSlots;
+  std::vector<typename OutputFrameType::Pointer> m_OutputSlots;
+  std::vector<ClockType::time_point>             m_InputSlotTimes;
+  std::vector<ClockType::time_point>             m_OutputSlotTimes;
+
+  SlotQueue m_FreeInputSlots;
+  SlotQueue m_AcquiredInputSlots;
+  SlotQueue m_FreeOutputSlots;
+  SlotQueue m_FilteredOutputSlots;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkThreadedFramePipeline.hxx"
+#endif
+
+#endif // itkThreadedFramePipeline_h
@@ -0,0 +1,307 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkThreadedFramePipeline_hxx
+#define itkThreadedFramePipeline_hxx
+
+#include "itkThreadedFramePipeline.h"
+
+#include "itkInPlaceImageFilter.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace itk
+{
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::SlotQueue::Reset(SizeValueType capacity)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Slots.assign(capacity + 1, 0);
+  m_Head = 0;
+  m_Tail = 0;
+  m_Aborted = false;
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::SlotQueue::Push(SizeValueType slot)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Slots[m_Tail] = slot;
+    m_Tail = (m_Tail + 1) % m_Slots.size();
+  }
+  m_Condition.notify_one();
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+SizeValueType
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::SlotQueue::Pop()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Condition.wait(lock, [this]() { return m_Aborted || m_Head != m_Tail; });
+  if (m_Aborted)
+  {
+    return EndOfFrames;
+  }
+  const SizeValueType slot = m_Slots[m_Head];
+  m_Head = (m_Head + 1) % m_Slots.size();
+  return slot;
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::SlotQueue::Abort()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Aborted = true;
+  }
+  m_Condition.notify_all();
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+SizeValueType
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::Run()
+{
+  if (!m_FrameSource || !m_FrameSink)
+  {
+    itkExceptionMacro(<< "The FrameSource and the FrameSink must be set.");
+  }
+  if (m_FrameFilter.IsNull())
+  {
+    itkExceptionMacro(<< "The FrameFilter is not set.");
+  }
+  if (m_ReferenceInputFrame.IsNull())
+  {
+    itkExceptionMacro(<< "The ReferenceInputFrame is not set.");
+  }
+
+  // The input slot is refilled once the filter released it.
+  using InPlaceFilterType = InPlaceImageFilter<InputFrameType, OutputFrameType>;
+  auto * inPlaceFilter = dynamic_cast<InPlaceFilterType *>(m_FrameFilter.GetPointer());
+  if (inPlaceFilter != nullptr)
+  {
+    inPlaceFilter->InPlaceOff();
+  }
+
+  this->AllocateSlots();
+
+  // Each queue holds at most every slot and the end marker.
+  m_FreeInputSlots.Reset(m_NumberOfSlots + 1);
+  m_AcquiredInputSlots.Reset(m_NumberOfSlots + 1);
+  m_FreeOutputSlots.Reset(m_NumberOfSlots + 1);
+  m_FilteredOutputSlots.Reset(m_NumberOfSlots + 1);
+  for (SizeValueType slot = 0; slot < m_NumberOfSlots; ++slot)
+  {
+    m_FreeInputSlots.Push(slot);
+    m_FreeOutputSlots.Push(slot);
+  }
+  m_NumberOfFrames = 0;
+  m_MaximumLatency = 0.0;
+
+  std::exception_ptr acquisitionError;
+  std::exception_ptr filterError;
+  std::exception_ptr displayError;
+  std::thread        acquisitionThread([this, &acquisitionError]() {
+    try
+    {
+      this->AcquireFrames();
+    }
+    catch (...)
+    {
+      acquisitionError = std::current_exception();
+      this->AbortQueues();
+    }
+  });
+  std::thread filterThread([this, &filterError]() {
+    try
+    {
+      this->FilterFrames();
+    }
+    catch (...)
+    {
+      filterError = std::current_exception();
+      this->AbortQueues();
+    }
+  });
+  try
+  {
+    this->DisplayFrames();
+  }
+  catch (...)
+  {
+    displayError = std::current_exception();
+    this->AbortQueues();
+  }
+  acquisitionThread.join();
+  filterThread.join();
+
+  for (const std::exception_ptr & error : { acquisitionError, filterError, displayError })
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+  return m_NumberOfFrames;
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::AllocateSlots()
+{
+  using InputRegionType = typename InputFrameType::RegionType;
+  const InputRegionType & region = m_ReferenceInputFrame->GetLargestPossibleRegion();
+  if (m_InputSlots.size() == m_NumberOfSlots && m_InputSlots[0]->GetBufferedRegion() == region)
+  {
+    for (const auto & inputSlot : m_InputSlots)
+    {
+      inputSlot->CopyInformation(m_ReferenceInputFrame);
+    }
+    return;
+  }
+
+  m_InputSlots.clear();
+  m_OutputSlots.clear();
+  for (SizeValueType slot = 0; slot < m_NumberOfSlots; ++slot)
+  {
+    typename InputFrameType::Pointer inputSlot = InputFrameType::New();
+    inputSlot->CopyInformation(m_ReferenceInputFrame);
+    inputSlot->SetRegions(region);
+    inputSlot->Allocate();
+    m_InputSlots.push_back(inputSlot);
+    m_OutputSlots.push_back(OutputFrameType::New());
+  }
+  m_InputSlotTimes.assign(m_NumberOfSlots, ClockType::time_point());
+  m_OutputSlotTimes.assign(m_NumberOfSlots, ClockType::time_point());
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::AcquireFrames()
+{
+  while (true)
+  {
+    const SizeValueType slot = m_FreeInputSlots.Pop();
+    if (slot == EndOfFrames)
+    {
+      return;
+    }
+    InputFrameType * frame = m_InputSlots[slot];
+    if (!m_FrameSource(frame))
+    {
+      m_AcquiredInputSlots.Push(EndOfFrames);
+      return;
+    }
+    frame->Modified();
+    m_InputSlotTimes[slot] = ClockType::now();
+    m_AcquiredInputSlots.Push(slot);
+  }
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::FilterFrames()
+{
+  while (true)
+  {
+    const SizeValueType inputSlot = m_AcquiredInputSlots.Pop();
+    if (inputSlot == EndOfFrames)
+    {
+      m_FilteredOutputSlots.Push(EndOfFrames);
+      return;
+    }
+    const SizeValueType outputSlot = m_FreeOutputSlots.Pop();
+    if (outputSlot == EndOfFrames)
+    {
+      return;
+    }
+
+    // The filter allocates the buffer of the output slot the first time it
+    // is used, and reuses it afterwards.
+    OutputFrameType * frame = m_OutputSlots[outputSlot];
+    m_FrameFilter->SetInput(m_InputSlots[inputSlot]);
+    m_FrameFilter->GraftOutput(frame);
+    m_FrameFilter->UpdateLargestPossibleRegion();
+    frame->Graft(m_FrameFilter->GetOutput());
+    m_OutputSlotTimes[outputSlot] = m_InputSlotTimes[inputSlot];
+
+    m_FreeInputSlots.Push(inputSlot);
+    m_FilteredOutputSlots.Push(outputSlot);
+  }
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::DisplayFrames()
+{
+  while (true)
+  {
+    const SizeValueType slot = m_FilteredOutputSlots.Pop();
+    if (slot == EndOfFrames)
+    {
+      return;
+    }
+    const double latency = std::chrono::duration<double>(ClockType::now() - m_OutputSlotTimes[slot]).count();
+    m_MaximumLatency = std::max(m_MaximumLatency, latency);
+    m_FrameSink(m_OutputSlots[slot].GetPointer());
+    ++m_NumberOfFrames;
+    m_FreeOutputSlots.Push(slot);
+  }
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::AbortQueues()
+{
+  m_FreeInputSlots.Abort();
+  m_AcquiredInputSlots.Abort();
+  m_FreeOutputSlots.Abort();
+  m_FilteredOutputSlots.Abort();
+}
+
+
+template <typename TInputFrame, typename TOutputFrame>
+void
+ThreadedFramePipeline<TInputFrame, TOutputFrame>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FrameFilter: " << m_FrameFilter.GetPointer() << std::endl;
+  os << indent << "ReferenceInputFrame: " << m_ReferenceInputFrame.GetPointer() << std::endl;
+  os << indent << "NumberOfSlots: " << m_NumberOfSlots << std::endl;
+  os << indent << "NumberOfFrames: " << m_NumberOfFrames << std::endl;
+  os << indent << "MaximumLatency: " << m_MaximumLatency << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkThreadedFramePipeline_hxx
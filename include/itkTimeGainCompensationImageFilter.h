@@ -18,10 +18,13 @@
 #ifndef itkTimeGainCompensationImageFilter_h
 #define itkTimeGainCompensationImageFilter_h
 
-#include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 
+#include "itkArray.h"
 #include "itkArray2D.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -32,10 +35,19 @@ namespace itk
  * This filter applies a linear piecewise gain with depth.  The depth
  * direction is assumed to be the first direction (0th direction).
  *
+ * Alternatively, the gain of every sample along the depth direction can be
+ * given with SetSampleGain().  Either gain can be given in decibels, with
+ * DecibelGainOn(); the piecewise gain is then interpolated in decibels.
+ *
+ * The gain of every depth is computed once per update, and each line is
+ * multiplied by that profile in a contiguous loop.  When the input and
+ * output image types are the same, the filter can run in place, see
+ * InPlaceImageFilter, so that no additional image is allocated.
+ *
  * \ingroup Ultrasound
  * */
 template <typename TInputImage, typename TOutputImage = TInputImage>
-class ITK_TEMPLATE_EXPORT TimeGainCompensationImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+class ITK_TEMPLATE_EXPORT TimeGainCompensationImageFilter : public InPlaceImageFilter<TInputImage, TOutputImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_ASSIGN(TimeGainCompensationImageFilter);
@@ -45,12 +57,12 @@ public:
   using OutputImageType = TOutputImage;
 
   using Self = TimeGainCompensationImageFilter;
-  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Superclass = InPlaceImageFilter<InputImageType, OutputImageType>;
 
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
-  itkTypeMacro(TimeGainCompensationImageFilter, ImageToImageFilter);
+  itkTypeMacro(TimeGainCompensationImageFilter, InPlaceImageFilter);
   itkNewMacro(Self);
 
   using GainType = Array2D<double>;
@@ -60,6 +72,29 @@ public:
   itkSetMacro(Gain, GainType);
   itkGetConstReferenceMacro(Gain, GainType);
 
+  using SampleGainType = Array<double>;
+
+  /** Set/Get the gain of every sample along the depth direction, starting at
+   * the first sample of the largest possible region.  When it is not empty,
+   * it must have a gain per sample and it is used instead of the Gain.
+   * Empty by default. */
+  itkSetMacro(SampleGain, SampleGainType);
+  itkGetConstReferenceMacro(SampleGain, SampleGainType);
+
+  /** When on, the Gain or the SampleGain are in decibels, 20 log10 of the
+   * amplitude gain.  Off by default. */
+  itkSetMacro(DecibelGain, bool);
+  itkGetConstMacro(DecibelGain, bool);
+  itkBooleanMacro(DecibelGain);
+
+  using ImageBaseType = ImageBase<InputImageType::ImageDimension>;
+
+  /** Compute the amplitude gain of every sample of the largest possible
+   * region of the image along the depth direction, from the SampleGain or
+   * the Gain and the origin and spacing of the image. */
+  void
+  ComputeLineGain(const ImageBaseType * image, std::vector<double> & lineGain) const;
+
 protected:
   using OutputImageRegionType = typename OutputImageType::RegionType;
 
@@ -75,7 +110,13 @@ protected:
   DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
 
 private:
-  GainType m_Gain;
+  GainType       m_Gain;
+  SampleGainType m_SampleGain;
+  bool           m_DecibelGain;
+
+  /** Amplitude gain of every sample of the largest possible region along
+   * the depth direction, for the current update. */
+  std::vector<double> m_LineGain;
 };
 
 } // namespace itk
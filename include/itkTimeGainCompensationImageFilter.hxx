@@ -20,9 +20,9 @@
 
 #include "itkTimeGainCompensationImageFilter.h"
 
-#include "itkImageScanlineIterator.h"
-#include "itkImageScanlineConstIterator.h"
-#include "itkArray.h"
+#include <cmath>
+
+#include "itkImageRegionConstIteratorWithIndex.h"
 
 namespace itk
 {
@@ -30,6 +30,7 @@ namespace itk
 template <typename TInputImage, typename TOutputImage>
 TimeGainCompensationImageFilter<TInputImage, TOutputImage>::TimeGainCompensationImageFilter()
   : m_Gain(2, 2)
+  , m_DecibelGain(false)
 {
   m_Gain(0, 0) = NumericTraits<double>::min();
   m_Gain(0, 1) = NumericTraits<double>::OneValue();
@@ -49,108 +50,134 @@ TimeGainCompensationImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostre
   {
     os << indent.GetNextIndent() << "[" << m_Gain(ii, 0) << ", " << m_Gain(ii, 1) << "]" << std::endl;
   }
+  os << indent << "SampleGain: " << m_SampleGain << std::endl;
+  os << indent << "DecibelGain: " << (m_DecibelGain ? "On" : "Off") << std::endl;
 }
 
 
 template <typename TInputImage, typename TOutputImage>
 void
-TimeGainCompensationImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+TimeGainCompensationImageFilter<TInputImage, TOutputImage>::ComputeLineGain(const ImageBaseType * image,
+                                                                            std::vector<double> & lineGain) const
 {
-  const GainType & gain = this->GetGain();
-  if (gain.cols() != 2)
-  {
-    itkExceptionMacro("Gain should have two columns.");
-  }
-  if (gain.rows() < 2)
-  {
-    itkExceptionMacro("Insufficient depths specified in Gain.");
-  }
-  double depth = gain(0, 0);
-  for (unsigned int ii = 1; ii < gain.rows(); ++ii)
+  const SizeValueType lineGainSize = image->GetLargestPossibleRegion().GetSize()[0];
+
+  const SampleGainType & sampleGain = this->GetSampleGain();
+  if (sampleGain.GetSize() > 0)
   {
-    if (gain(ii, 0) <= depth)
+    if (sampleGain.GetSize() != lineGainSize)
     {
-      itkExceptionMacro("Gain depths must be strictly increasing.");
+      itkExceptionMacro("SampleGain has " << sampleGain.GetSize() << " values for " << lineGainSize << " samples.");
     }
-    depth = gain(ii, 0);
+    lineGain.assign(sampleGain.begin(), sampleGain.end());
   }
-}
-
-
-template <typename TInputImage, typename TOutputImage>
-void
-TimeGainCompensationImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
-  const OutputImageRegionType & outputRegionForThread)
-{
-  const InputImageType * inputImage = this->GetInput();
-  OutputImageType *      outputImage = this->GetOutput();
-
-  // Compute the line gain once.
-  const GainType & gain = this->GetGain();
-  double           pieceStart = gain(0, 0);
-  double           pieceEnd = gain(1, 0);
-  double           gainStart = gain(0, 1);
-  double           gainEnd = gain(1, 1);
-  SizeValueType    gainSegment = 1;
-
-  using LineGainType = Array<double>;
-  const SizeValueType                         lineGainSize = outputRegionForThread.GetSize()[0];
-  const typename InputImageType::RegionType & inputRegion = inputImage->GetLargestPossibleRegion();
-  const IndexValueType                        imageStartIndex = inputRegion.GetIndex()[0];
-  const typename InputImageType::PointType    origin = inputImage->GetOrigin();
-  const SpacePrecisionType                    pixelSpacing = inputImage->GetSpacing()[0];
-  IndexValueType                              indexOffset = outputRegionForThread.GetIndex()[0] - imageStartIndex;
-  LineGainType                                lineGain(lineGainSize);
-  for (SizeValueType lineGainIndex = 0; lineGainIndex < lineGainSize; ++lineGainIndex)
+  else
   {
-    const SpacePrecisionType pixelLocation = origin[0] + pixelSpacing * indexOffset;
-    if (pixelLocation <= pieceStart)
+    const GainType & gain = this->GetGain();
+    if (gain.cols() != 2)
+    {
+      itkExceptionMacro("Gain should have two columns.");
+    }
+    if (gain.rows() < 2)
     {
-      lineGain[lineGainIndex] = gainStart;
+      itkExceptionMacro("Insufficient depths specified in Gain.");
     }
-    else if (pixelLocation > pieceEnd)
+    double depth = gain(0, 0);
+    for (unsigned int ii = 1; ii < gain.rows(); ++ii)
     {
-      if (gainSegment >= gain.rows() - 1)
+      if (gain(ii, 0) <= depth)
       {
-        lineGain[lineGainIndex] = gainEnd;
+        itkExceptionMacro("Gain depths must be strictly increasing.");
       }
-      else
+      depth = gain(ii, 0);
+    }
+
+    // Compute the line gain once for the whole depth.
+    double        pieceStart = gain(0, 0);
+    double        pieceEnd = gain(1, 0);
+    double        gainStart = gain(0, 1);
+    double        gainEnd = gain(1, 1);
+    SizeValueType gainSegment = 1;
+
+    const typename ImageBaseType::PointType origin = image->GetOrigin();
+    const SpacePrecisionType                pixelSpacing = image->GetSpacing()[0];
+    lineGain.resize(lineGainSize);
+    for (SizeValueType lineGainIndex = 0; lineGainIndex < lineGainSize; ++lineGainIndex)
+    {
+      const SpacePrecisionType pixelLocation = origin[0] + pixelSpacing * lineGainIndex;
+      if (pixelLocation <= pieceStart)
+      {
+        lineGain[lineGainIndex] = gainStart;
+        continue;
+      }
+      while (pixelLocation > pieceEnd && gainSegment < gain.rows() - 1)
       {
         ++gainSegment;
         pieceStart = gain(gainSegment - 1, 0);
         pieceEnd = gain(gainSegment, 0);
         gainStart = gain(gainSegment - 1, 1);
         gainEnd = gain(gainSegment, 1);
-
+      }
+      if (pixelLocation > pieceEnd)
+      {
+        lineGain[lineGainIndex] = gainEnd;
+      }
+      else
+      {
         const SpacePrecisionType offset = static_cast<SpacePrecisionType>(pixelLocation - pieceStart);
         lineGain[lineGainIndex] = offset * (gainEnd - gainStart) / (pieceEnd - pieceStart) + gainStart;
       }
     }
-    else
+  }
+
+  if (this->GetDecibelGain())
+  {
+    for (double & sampleLineGain : lineGain)
     {
-      const SpacePrecisionType offset = static_cast<SpacePrecisionType>(pixelLocation - pieceStart);
-      lineGain[lineGainIndex] = offset * (gainEnd - gainStart) / (pieceEnd - pieceStart) + gainStart;
+      sampleLineGain = std::pow(10.0, sampleLineGain / 20.0);
     }
-    ++indexOffset;
   }
+}
+
+
+template <typename TInputImage, typename TOutputImage>
+void
+TimeGainCompensationImageFilter<TInputImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  this->ComputeLineGain(this->GetInput(), this->m_LineGain);
+}
 
-  using InputIteratorType = ImageScanlineConstIterator<InputImageType>;
-  InputIteratorType inputIt(inputImage, outputRegionForThread);
 
-  using OutputIteratorType = ImageScanlineIterator<OutputImageType>;
-  OutputIteratorType outputIt(outputImage, outputRegionForThread);
+template <typename TInputImage, typename TOutputImage>
+void
+TimeGainCompensationImageFilter<TInputImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const InputImageType * inputImage = this->GetInput();
+  OutputImageType *      outputImage = this->GetOutput();
 
-  for (inputIt.GoToBegin(), outputIt.GoToBegin(); !outputIt.IsAtEnd(); inputIt.NextLine(), outputIt.NextLine())
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  const InputPixelType * inputBuffer = inputImage->GetBufferPointer();
+  OutputPixelType *      outputBuffer = outputImage->GetBufferPointer();
+
+  // The gain of the first sample of the region.
+  const IndexValueType imageStartIndex = inputImage->GetLargestPossibleRegion().GetIndex()[0];
+  const double *       lineGain = this->m_LineGain.data() + (outputRegionForThread.GetIndex()[0] - imageStartIndex);
+  const SizeValueType  lineSize = outputRegionForThread.GetSize()[0];
+
+  // for every line along the depth, addressed directly in the buffers so
+  // that the multiplication vectorizes
+  OutputImageRegionType lineStartRegion = outputRegionForThread;
+  lineStartRegion.SetSize(0, 1);
+  ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(outputImage, lineStartRegion);
+  for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
   {
-    inputIt.GoToBeginOfLine();
-    outputIt.GoToBeginOfLine();
-    SizeValueType lineGainIndex = 0;
-    while (!outputIt.IsAtEndOfLine())
+    const InputPixelType * inputLine = inputBuffer + inputImage->ComputeOffset(lineIt.GetIndex());
+    OutputPixelType *      outputLine = outputBuffer + outputImage->ComputeOffset(lineIt.GetIndex());
+    for (SizeValueType ii = 0; ii < lineSize; ++ii)
     {
-      outputIt.Set(inputIt.Value() * lineGain[lineGainIndex]);
-      ++inputIt;
-      ++outputIt;
-      ++lineGainIndex;
+      outputLine[ii] = static_cast<OutputPixelType>(inputLine[ii] * lineGain[ii]);
     }
   }
 }
@@ -35,6 +35,14 @@ namespace itk
  * Read an ultrasound itk::SpecialCoordinatesImage and populate its parameters
  * based on its itk::MetaDataDictionary entries.
  *
+ * With UseMemoryMapping, the samples of an HDF5UltrasoundImageIO file that
+ * are stored contiguously and uncompressed are memory mapped, copy on write,
+ * instead of read, when the whole image is requested.
+ *
+ * With HeaderOnly, an update only populates the geometry of the output,
+ * including the slice transforms of a SliceSeriesSpecialCoordinatesImage,
+ * and its buffered region is empty.
+ *
  * \ingroup Ultrasound
  *
  * \sa ImageFileReader
@@ -65,6 +73,18 @@ public:
 
   itkStaticConstMacro(ImageDimension, unsigned int, OutputImageType::ImageDimension);
 
+  /** Map the samples of the file, when possible, instead of reading them.
+   * The pages are read on first access.  Defaults to off. */
+  itkSetMacro(UseMemoryMapping, bool);
+  itkGetConstMacro(UseMemoryMapping, bool);
+  itkBooleanMacro(UseMemoryMapping);
+
+  /** Read the image information and meta data only, not the pixels.
+   * Defaults to off. */
+  itkSetMacro(HeaderOnly, bool);
+  itkGetConstMacro(HeaderOnly, bool);
+  itkBooleanMacro(HeaderOnly);
+
 protected:
   UltrasoundImageFileReader();
   ~UltrasoundImageFileReader() {}
@@ -73,6 +93,13 @@ protected:
    * propagation of the pipeline. */
   virtual void
   GenerateOutputInformation() override;
+
+  virtual void
+  GenerateData() override;
+
+private:
+  bool m_UseMemoryMapping{ false };
+  bool m_HeaderOnly{ false };
 };
 
 } // end namespace itk
@@ -24,7 +24,11 @@
 #include "itkMetaDataObject.h"
 #include "itkEuler3DTransform.h"
 
+#include <cstdlib>
+
 #include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkMemoryMappedImageContainer.h"
 #include "itkSliceSeriesSpecialCoordinatesImage.h"
 
 #ifdef ITK_HAS_GCC_PRAGMA_DIAG_PUSHPOP
@@ -34,14 +38,21 @@ ITK_GCC_PRAGMA_DIAG(ignored "-Wattributes")
 namespace
 {
 
+// The value of a double entry, or the parsed value of a string entry,
+// without constructing a stream.
 double
 GetMetaDataAsDouble(const itk::MetaDataDictionary & dictionary, const std::string & key)
 {
-  std::string valueAsStr;
-  itk::ExposeMetaData<std::string>(dictionary, key, valueAsStr);
-  std::istringstream istrm(valueAsStr);
-  double             value;
-  istrm >> value;
+  double value = 0.0;
+  if (itk::ExposeMetaData<double>(dictionary, key, value))
+  {
+    return value;
+  }
+  const auto * stringObject = dynamic_cast<const itk::MetaDataObject<std::string> *>(dictionary.Get(key));
+  if (stringObject != nullptr)
+  {
+    value = std::strtod(stringObject->GetMetaDataObjectValue().c_str(), nullptr);
+  }
   return value;
 }
 
@@ -188,6 +199,39 @@ UltrasoundImageFileReader<TOutputImage>::GenerateOutputInformation()
   UltrasoundImageFileReaderDispatch<TOutputImage>::ExtractMetaData(this->GetOutput());
 }
 
+
+template <typename TOutputImage>
+void
+UltrasoundImageFileReader<TOutputImage>::GenerateData()
+{
+  OutputImageType * output = this->GetOutput();
+  if (m_HeaderOnly)
+  {
+    // The geometry is complete after GenerateOutputInformation.
+    output->SetBufferedRegion(typename OutputImageType::RegionType());
+    return;
+  }
+
+  const auto *      imageIO = dynamic_cast<const HDF5UltrasoundImageIO *>(this->GetImageIO());
+  if (m_UseMemoryMapping && imageIO != nullptr &&
+      output->GetRequestedRegion() == output->GetLargestPossibleRegion() &&
+      imageIO->GetComponentType() == ImageIOBase::MapPixelType<OutputImagePixelType>::CType)
+  {
+    const OffsetValueType offset = imageIO->GetVoxelDataFileOffset();
+    if (offset >= 0)
+    {
+      using PixelContainerType = MemoryMappedImageContainer<SizeValueType, OutputImagePixelType>;
+      typename PixelContainerType::Pointer pixelContainer = PixelContainerType::New();
+      output->SetBufferedRegion(output->GetRequestedRegion());
+      pixelContainer->MapFile(this->GetFileName(), offset, output->GetBufferedRegion().GetNumberOfPixels());
+      output->SetPixelContainer(pixelContainer);
+      return;
+    }
+  }
+
+  Superclass::GenerateData();
+}
+
 } // end namespace itk
 
 #endif
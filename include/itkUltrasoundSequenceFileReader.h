@@ -0,0 +1,172 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkUltrasoundSequenceFileReader_h
+#define itkUltrasoundSequenceFileReader_h
+
+#include "itkVideoSource.h"
+
+#include "itkImageIOBase.h"
+
+#include <future>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class UltrasoundSequenceFileReader
+ * \brief Read a sequence of frames, such as RF or B-mode acquisitions, into a
+ * VideoStream.
+ *
+ * The frames are either one file per frame, see SetFileNames(), or the
+ * slices along the last direction of a single file, see SetFileName(), which
+ * are read as streamed IO regions.  The ImageIO is created once for the
+ * series, and a single file is opened once.
+ *
+ * Each frame is read into a pixel container of a pool, which is swapped into
+ * the frame of the output, so that the frames reuse their buffers.  With
+ * UsePrefetch, the default, frame N + 1 is read on a background thread while
+ * frame N is processed.
+ *
+ * \warning Unless the HDF5 library is built thread safe, only one thread at a
+ * time may use it in the whole process, as for HDF5UltrasoundRecordingWriter.
+ * A prefetch would then race with the HDF5 calls of the other threads, for
+ * example of another HDF5UltrasoundImageIO or of a recording writer in the
+ * same ThreadedFramePipeline, so the frames of an HDF5UltrasoundImageIO are
+ * not prefetched in that case.  Other ImageIOs built on HDF5, such as
+ * HDF5ImageIO, are not detected: turn UsePrefetch off for them.
+ *
+ * The pixels are read without conversion: the component type of the files
+ * must be that of the frame pixels.
+ *
+ * \ingroup Ultrasound
+ * */
+template <typename TOutputVideoStream>
+class ITK_TEMPLATE_EXPORT UltrasoundSequenceFileReader : public VideoSource<TOutputVideoStream>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(UltrasoundSequenceFileReader);
+
+  /** Standard class type alias. */
+  using Self = UltrasoundSequenceFileReader;
+  using Superclass = VideoSource<TOutputVideoStream>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkTypeMacro(UltrasoundSequenceFileReader, VideoSource);
+  itkNewMacro(Self);
+
+  using VideoStreamType = TOutputVideoStream;
+  using FrameType = typename VideoStreamType::FrameType;
+  using PixelType = typename FrameType::PixelType;
+  using PixelContainerType = typename FrameType::PixelContainer;
+  using PixelContainerPointer = typename PixelContainerType::Pointer;
+  using FileNamesContainer = std::vector<std::string>;
+
+  static constexpr unsigned int FrameDimension = FrameType::ImageDimension;
+
+  /** One file per frame. */
+  void
+  SetFileNames(const FileNamesContainer & fileNames)
+  {
+    if (m_FileNames != fileNames)
+    {
+      m_FileNames = fileNames;
+      this->Modified();
+    }
+  }
+  const FileNamesContainer &
+  GetFileNames() const
+  {
+    return m_FileNames;
+  }
+
+  /** A single file whose slices along its last direction are the frames. */
+  void
+  SetFileName(const std::string & fileName)
+  {
+    this->SetFileNames(FileNamesContainer(1, fileName));
+  }
+
+  /** Optional ImageIO for the files; otherwise it is created by the
+   * ImageIOFactory from the first file. */
+  itkSetObjectMacro(ImageIO, ImageIOBase);
+  itkGetModifiableObjectMacro(ImageIO, ImageIOBase);
+
+  /** Read the next frame on a background thread, when the ImageIO allows
+   * it, see the class documentation.  Defaults to on. */
+  itkSetMacro(UsePrefetch, bool);
+  itkGetConstMacro(UsePrefetch, bool);
+  itkBooleanMacro(UsePrefetch);
+
+  /** Number of frames, after UpdateOutputInformation(). */
+  itkGetConstMacro(NumberOfFrames, SizeValueType);
+
+  void
+  UpdateOutputInformation() override;
+
+protected:
+  UltrasoundSequenceFileReader();
+  ~UltrasoundSequenceFileReader() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Read the frame at the start of the requested temporal region. */
+  void
+  TemporalStreamingGenerateData() override;
+
+private:
+  /** A container of the frame size, from the pool when possible. */
+  PixelContainerPointer
+  AcquireContainer();
+
+  /** Whether the next frame can be read on a background thread. */
+  bool
+  CanPrefetch() const;
+
+  /** Read a frame into the buffer.  Only one frame is read at a time. */
+  void
+  ReadFrame(SizeValueType frame, PixelType * buffer);
+
+  /** Wait for the prefetch in flight, if any, and return its container to
+   * the pool. */
+  void
+  CancelPrefetch();
+
+  FileNamesContainer   m_FileNames;
+  ImageIOBase::Pointer m_ImageIO;
+  bool                 m_UsePrefetch{ true };
+
+  SizeValueType m_NumberOfFrames{ 0 };
+  bool          m_FramesAlongLastDirection{ false };
+  SizeValueType m_NumberOfPixelsPerFrame{ 0 };
+
+  std::vector<PixelContainerPointer> m_ContainerPool;
+  std::future<void>                  m_Prefetch;
+  PixelContainerPointer              m_PrefetchContainer;
+  SizeValueType                      m_PrefetchFrame{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkUltrasoundSequenceFileReader.hxx"
+#endif
+
+#endif // itkUltrasoundSequenceFileReader_h
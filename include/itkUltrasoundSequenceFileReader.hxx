@@ -0,0 +1,270 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkUltrasoundSequenceFileReader_hxx
+#define itkUltrasoundSequenceFileReader_hxx
+
+#include "itkUltrasoundSequenceFileReader.h"
+
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkImageIOFactory.h"
+
+namespace itk
+{
+
+template <typename TOutputVideoStream>
+UltrasoundSequenceFileReader<TOutputVideoStream>::UltrasoundSequenceFileReader() = default;
+
+
+template <typename TOutputVideoStream>
+UltrasoundSequenceFileReader<TOutputVideoStream>::~UltrasoundSequenceFileReader()
+{
+  this->CancelPrefetch();
+}
+
+
+template <typename TOutputVideoStream>
+void
+UltrasoundSequenceFileReader<TOutputVideoStream>::UpdateOutputInformation()
+{
+  if (m_FileNames.empty())
+  {
+    itkExceptionMacro(<< "No file names are set.");
+  }
+  this->CancelPrefetch();
+
+  if (m_ImageIO.IsNull())
+  {
+    m_ImageIO = ImageIOFactory::CreateImageIO(m_FileNames[0].c_str(), IOFileModeEnum::ReadMode);
+    if (m_ImageIO.IsNull())
+    {
+      itkExceptionMacro(<< "Could not create an ImageIO to read " << m_FileNames[0]);
+    }
+  }
+  m_ImageIO->SetFileName(m_FileNames[0]);
+  m_ImageIO->ReadImageInformation();
+  if (m_ImageIO->GetComponentType() != ImageIOBase::MapPixelType<PixelType>::CType ||
+      m_ImageIO->GetNumberOfComponents() != 1)
+  {
+    itkExceptionMacro(<< "The pixels of " << m_FileNames[0] << " are not of the frame pixel type.");
+  }
+
+  const unsigned int fileDimension = m_ImageIO->GetNumberOfDimensions();
+  m_FramesAlongLastDirection = m_FileNames.size() == 1 && fileDimension == FrameDimension + 1;
+  if (m_FramesAlongLastDirection)
+  {
+    if (!m_ImageIO->CanStreamRead())
+    {
+      itkExceptionMacro(<< "The ImageIO cannot read the frames of " << m_FileNames[0] << " one at a time.");
+    }
+    m_NumberOfFrames = m_ImageIO->GetDimensions(FrameDimension);
+  }
+  else if (fileDimension < FrameDimension)
+  {
+    itkExceptionMacro(<< "The dimension of " << m_FileNames[0] << " is smaller than the frame dimension.");
+  }
+  else
+  {
+    m_NumberOfFrames = m_FileNames.size();
+  }
+
+  using RegionType = typename FrameType::RegionType;
+  typename RegionType::SizeType     size;
+  typename FrameType::PointType     origin;
+  typename FrameType::SpacingType   spacing;
+  typename FrameType::DirectionType direction;
+  for (unsigned int ii = 0; ii < FrameDimension; ++ii)
+  {
+    size[ii] = m_ImageIO->GetDimensions(ii);
+    origin[ii] = m_ImageIO->GetOrigin(ii);
+    spacing[ii] = m_ImageIO->GetSpacing(ii);
+    const std::vector<double> directionInII = m_ImageIO->GetDirection(ii);
+    for (unsigned int jj = 0; jj < FrameDimension; ++jj)
+    {
+      direction[jj][ii] = directionInII[jj];
+    }
+  }
+  const RegionType region(size);
+  m_NumberOfPixelsPerFrame = region.GetNumberOfPixels();
+
+  VideoStreamType * output = this->GetOutput();
+  TemporalRegion    largestPossibleTemporalRegion;
+  largestPossibleTemporalRegion.SetFrameStart(0);
+  largestPossibleTemporalRegion.SetFrameDuration(m_NumberOfFrames);
+  output->SetLargestPossibleTemporalRegion(largestPossibleTemporalRegion);
+  output->SetAllLargestPossibleSpatialRegions(region);
+  output->SetAllRequestedSpatialRegions(region);
+  output->SetAllFramesSpacing(spacing);
+  output->SetAllFramesOrigin(origin);
+  output->SetAllFramesDirection(direction);
+}
+
+
+template <typename TOutputVideoStream>
+void
+UltrasoundSequenceFileReader<TOutputVideoStream>::TemporalStreamingGenerateData()
+{
+  this->AllocateOutputs();
+
+  VideoStreamType *   output = this->GetOutput();
+  const SizeValueType frame = output->GetRequestedTemporalRegion().GetFrameStart();
+
+  PixelContainerPointer container;
+  if (m_Prefetch.valid() && m_PrefetchFrame == frame)
+  {
+    container = m_PrefetchContainer;
+    m_PrefetchContainer = nullptr;
+    m_Prefetch.get();
+  }
+  else
+  {
+    this->CancelPrefetch();
+    container = this->AcquireContainer();
+    this->ReadFrame(frame, container->GetBufferPointer());
+  }
+
+  // The previous buffer of the frame returns to the pool.
+  FrameType * frameImage = output->GetFrame(frame);
+  if (frameImage->GetPixelContainer() != nullptr)
+  {
+    m_ContainerPool.push_back(frameImage->GetPixelContainer());
+  }
+  frameImage->SetPixelContainer(container);
+
+  if (this->CanPrefetch() && frame + 1 < m_NumberOfFrames)
+  {
+    m_PrefetchFrame = frame + 1;
+    m_PrefetchContainer = this->AcquireContainer();
+    PixelType * buffer = m_PrefetchContainer->GetBufferPointer();
+    m_Prefetch = std::async(std::launch::async, [this, buffer]() { this->ReadFrame(m_PrefetchFrame, buffer); });
+  }
+
+  // The next request reads again.
+  this->Modified();
+}
+
+
+template <typename TOutputVideoStream>
+auto
+UltrasoundSequenceFileReader<TOutputVideoStream>::AcquireContainer() -> PixelContainerPointer
+{
+  PixelContainerPointer container;
+  if (m_ContainerPool.empty())
+  {
+    container = PixelContainerType::New();
+  }
+  else
+  {
+    container = m_ContainerPool.back();
+    m_ContainerPool.pop_back();
+  }
+  container->Reserve(m_NumberOfPixelsPerFrame);
+  return container;
+}
+
+
+template <typename TOutputVideoStream>
+bool
+UltrasoundSequenceFileReader<TOutputVideoStream>::CanPrefetch() const
+{
+  if (!m_UsePrefetch)
+  {
+    return false;
+  }
+  // The reads of the prefetch thread would race with the HDF5 calls of the
+  // other threads.
+  return HDF5UltrasoundImageIO::IsLibraryThreadSafe() ||
+         dynamic_cast<const HDF5UltrasoundImageIO *>(m_ImageIO.GetPointer()) == nullptr;
+}
+
+
+template <typename TOutputVideoStream>
+void
+UltrasoundSequenceFileReader<TOutputVideoStream>::ReadFrame(SizeValueType frame, PixelType * buffer)
+{
+  if (m_FramesAlongLastDirection)
+  {
+    ImageIORegion ioRegion(FrameDimension + 1);
+    for (unsigned int ii = 0; ii < FrameDimension; ++ii)
+    {
+      ioRegion.SetIndex(ii, 0);
+      ioRegion.SetSize(ii, m_ImageIO->GetDimensions(ii));
+    }
+    ioRegion.SetIndex(FrameDimension, frame);
+    ioRegion.SetSize(FrameDimension, 1);
+    m_ImageIO->SetIORegion(ioRegion);
+  }
+  else
+  {
+    m_ImageIO->SetFileName(m_FileNames[frame]);
+    m_ImageIO->ReadImageInformation();
+    const unsigned int fileDimension = m_ImageIO->GetNumberOfDimensions();
+    ImageIORegion      ioRegion(fileDimension);
+    SizeValueType      numberOfPixels = 1;
+    for (unsigned int ii = 0; ii < fileDimension; ++ii)
+    {
+      ioRegion.SetIndex(ii, 0);
+      ioRegion.SetSize(ii, m_ImageIO->GetDimensions(ii));
+      numberOfPixels *= m_ImageIO->GetDimensions(ii);
+    }
+    if (numberOfPixels != m_NumberOfPixelsPerFrame ||
+        m_ImageIO->GetComponentType() != ImageIOBase::MapPixelType<PixelType>::CType)
+    {
+      itkExceptionMacro(<< "The frame in " << m_FileNames[frame] << " differs from the first frame.");
+    }
+    m_ImageIO->SetIORegion(ioRegion);
+  }
+  m_ImageIO->Read(buffer);
+}
+
+
+template <typename TOutputVideoStream>
+void
+UltrasoundSequenceFileReader<TOutputVideoStream>::CancelPrefetch()
+{
+  if (!m_Prefetch.valid())
+  {
+    return;
+  }
+  try
+  {
+    m_Prefetch.get();
+  }
+  catch (...)
+  {
+    // The frame is read again if it is requested.
+  }
+  m_ContainerPool.push_back(m_PrefetchContainer);
+  m_PrefetchContainer = nullptr;
+}
+
+
+template <typename TOutputVideoStream>
+void
+UltrasoundSequenceFileReader<TOutputVideoStream>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileNames: " << m_FileNames.size() << std::endl;
+  os << indent << "ImageIO: " << m_ImageIO.GetPointer() << std::endl;
+  os << indent << "UsePrefetch: " << (m_UsePrefetch ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfFrames: " << m_NumberOfFrames << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkUltrasoundSequenceFileReader_hxx
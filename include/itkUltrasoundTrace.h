@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkUltrasoundTrace_h
+#define itkUltrasoundTrace_h
+
+#include "UltrasoundExport.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace itk
+{
+
+/** \class UltrasoundTrace
+ *
+ * \brief Scoped trace points on the hot paths of the module.
+ *
+ * When the module is built with ITKUltrasound_USE_TRACING, the FFT
+ * executions of every work unit, the FFT plan creations, the Welch segment
+ * spectra, the block matching metric evaluations, the regularization
+ * iterations, the HDF5 reads and the VTK exports are wrapped in
+ * itkUltrasoundTraceScopeMacro() trace points.  Without it, the macro
+ * expands to nothing.
+ *
+ * While tracing is enabled with SetEnabled(true), every trace point that
+ * completes records an event: its name, the sequential id of its thread,
+ * its start and its duration.  The events are forwarded to the callback
+ * given with SetCallback(), from the thread of the trace point, or, without
+ * a callback, kept per thread and written by WriteChromeTrace() in the
+ * Chrome trace event format that chrome://tracing and Perfetto load.
+ *
+ * Set the callback, and write or clear the events, while no traced work is
+ * in flight.
+ *
+ * \ingroup Ultrasound
+ */
+class Ultrasound_EXPORT UltrasoundTrace
+{
+public:
+  using ClockType = std::chrono::steady_clock;
+
+  struct EventType
+  {
+    /** Name of the trace point, a string literal. */
+    const char * Name;
+    /** Sequential id of the thread, from 0. */
+    unsigned int ThreadId;
+    /** Start, in microseconds since tracing was first used in the process. */
+    std::int64_t Start;
+    /** Duration, in microseconds. */
+    std::int64_t Duration;
+  };
+  using CallbackType = std::function<void(const EventType &)>;
+
+  /** Record the completed trace points.  Off by default. */
+  static void
+  SetEnabled(bool enabled);
+  static bool
+  GetEnabled();
+
+  /** Forward the events to a thread safe callback instead of keeping them.
+   * An empty callback keeps them. */
+  static void
+  SetCallback(const CallbackType & callback);
+
+  /** Number of events kept. */
+  static size_t
+  GetNumberOfEvents();
+
+  /** Write the events kept as a Chrome trace.  Returns false if the file
+   * could not be written. */
+  static bool
+  WriteChromeTrace(const std::string & fileName);
+
+  /** Forget the events kept. */
+  static void
+  Clear();
+
+  /** Record an event.  Called by the trace points. */
+  static void
+  Record(const char * name, ClockType::time_point start, ClockType::time_point stop);
+
+  /** Trace point that records the lifetime of the scope. */
+  class Scope
+  {
+  public:
+    explicit Scope(const char * name)
+      : m_Name(UltrasoundTrace::GetEnabled() ? name : nullptr)
+    {
+      if (m_Name != nullptr)
+      {
+        m_Start = ClockType::now();
+      }
+    }
+
+    ~Scope()
+    {
+      if (m_Name != nullptr)
+      {
+        UltrasoundTrace::Record(m_Name, m_Start, ClockType::now());
+      }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &
+    operator=(const Scope &) = delete;
+
+  private:
+    const char *          m_Name;
+    ClockType::time_point m_Start;
+  };
+};
+
+} // end namespace itk
+
+#if defined(ITKUltrasound_USE_TRACING)
+#  define itkUltrasoundTraceConcatenateMacro(prefix, line) prefix##line
+#  define itkUltrasoundTraceScopeNameMacro(prefix, line) itkUltrasoundTraceConcatenateMacro(prefix, line)
+/** Trace the rest of the enclosing scope under a string literal name. */
+#  define itkUltrasoundTraceScopeMacro(name)                                                                         \
+    const ::itk::UltrasoundTrace::Scope itkUltrasoundTraceScopeNameMacro(ultrasoundTraceScope, __LINE__)(name)
+#else
+#  define itkUltrasoundTraceScopeMacro(name)
+#endif
+
+#endif // itkUltrasoundTrace_h
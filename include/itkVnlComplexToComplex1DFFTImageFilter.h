@@ -56,6 +56,13 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(VnlComplexToComplex1DFFTImageFilter, ComplexToComplex1DFFTImageFilter);
 
+  /** The VNL FFT supports sizes whose prime factors are 2, 3 and 5. */
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 5;
+  }
+
 protected:
   VnlComplexToComplex1DFFTImageFilter() {}
   virtual ~VnlComplexToComplex1DFFTImageFilter() {}
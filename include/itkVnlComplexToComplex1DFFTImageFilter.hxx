@@ -20,14 +20,15 @@
 
 #include "itkVnlComplexToComplex1DFFTImageFilter.h"
 
+#include <algorithm>
+
 #include "itkComplexToComplex1DFFTImageFilter.hxx"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkMacro.h"
-#include "vnl/algo/vnl_fft_base.h"
-#include "vnl/algo/vnl_fft_1d.h"
+#include "itkUltrasoundTrace.h"
+#include "itkVnlFFT1DTransformPool.h"
 
 namespace itk
 {
@@ -44,8 +45,8 @@ VnlComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
 
   const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
 
-  const unsigned int direction = this->GetDirection();
-  const unsigned int vectorSize = inputSize[direction];
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType vectorSize = inputSize[direction];
 
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
@@ -53,60 +54,112 @@ VnlComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
     direction,
     output->GetRequestedRegion(),
     [this, input, output, direction, vectorSize](const typename OutputImageType::RegionType & lambdaRegion) {
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
-      using PixelType = typename TInputImage::PixelType;
-      using VNLVectorType = vnl_vector<PixelType>;
-      VNLVectorType                    inputBuffer(vectorSize);
-      typename VNLVectorType::iterator inputBufferIt = inputBuffer.begin();
-      // fft is done in-place
-      typename VNLVectorType::iterator                         outputBufferIt = inputBuffer.begin();
-      vnl_fft_1d<typename NumericTraits<PixelType>::ValueType> v1d(vectorSize);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      itkUltrasoundTraceScopeMacro("VnlComplexToComplex1DFFT");
+      using InputPixelType = typename TInputImage::PixelType;
+      using OutputPixelType = typename TOutputImage::PixelType;
+      using TransformPoolType = VnlFFT1DTransformPool<typename NumericTraits<typename TInputImage::PixelType>::ValueType>;
+
+      // The transform tables and the line buffer come from the pool, so
+      // they are only set up once per size and concurrent work unit.
+      typename TransformPoolType::Lease transform(vectorSize);
+      auto *                            buffer = transform.GetBuffer();
+
+      const OffsetValueType  inputStride = input->GetOffsetTable()[direction];
+      const OffsetValueType  outputStride = output->GetOffsetTable()[direction];
+      const InputPixelType * inputBuffer = input->GetBufferPointer();
+      OutputPixelType *      outputBuffer = output->GetBufferPointer();
+
+      // Visit the first sample of every fft line.
+      typename OutputImageType::RegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(direction, 1);
+
+      if (direction == 0)
       {
-        // copy the input line into our buffer
-        inputIt.GoToBeginOfLine();
-        inputBufferIt = inputBuffer.begin();
-        while (!inputIt.IsAtEndOfLine())
+        // The lines are addressed directly in the buffers.
+        ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+        for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
         {
-          *inputBufferIt = inputIt.Get();
-          ++inputIt;
-          ++inputBufferIt;
-        }
+          const InputPixelType * inputLine = inputBuffer + input->ComputeOffset(lineIt.GetIndex());
+          OutputPixelType *      outputLine = outputBuffer + output->ComputeOffset(lineIt.GetIndex());
 
-        // do the transform
-        if (this->m_TransformDirection == Superclass::DIRECT)
-        {
-          v1d.bwd_transform(inputBuffer);
-          // copy the output from the buffer into our line
-          outputBufferIt = inputBuffer.begin();
-          outputIt.GoToBeginOfLine();
-          while (!outputIt.IsAtEndOfLine())
+          for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+          {
+            buffer[ii] = inputLine[ii * inputStride];
+          }
+
+          if (this->m_TransformDirection == Superclass::DIRECT)
+          {
+            transform.Forward();
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              outputLine[ii * outputStride] = buffer[ii];
+            }
+          }
+          else // m_TransformDirection == INVERSE
           {
-            outputIt.Set(*outputBufferIt);
-            ++outputIt;
-            ++outputBufferIt;
+            transform.Backward();
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              outputLine[ii * outputStride] = buffer[ii] / static_cast<InputPixelType>(vectorSize);
+            }
           }
         }
-        else // m_TransformDirection == INVERSE
+      }
+      else
+      {
+        // The samples of a line are a large stride apart, but the lines are
+        // adjacent along the first dimension: blocks of adjacent lines are
+        // transposed into contiguous lines of the block buffer, transformed,
+        // and transposed back, so that the gather and the scatter stream
+        // through the rows of the image.
+        const SizeValueType numberOfLines = lambdaRegion.GetSize(0);
+        const SizeValueType blockSize = TransformPoolType::BlockSize;
+        auto *              block = transform.GetBlockBuffer(std::min(numberOfLines, blockSize));
+        using ScaleType = typename NumericTraits<InputPixelType>::ValueType;
+        const ScaleType scale = (this->m_TransformDirection == Superclass::DIRECT)
+                                  ? ScaleType(1)
+                                  : ScaleType(1) / static_cast<ScaleType>(vectorSize);
+
+        typename OutputImageType::RegionType rowStartRegion = lineStartRegion;
+        rowStartRegion.SetSize(0, 1);
+        ImageRegionConstIteratorWithIndex<OutputImageType> rowIt(output, rowStartRegion);
+        for (rowIt.GoToBegin(); !rowIt.IsAtEnd(); ++rowIt)
         {
-          v1d.fwd_transform(inputBuffer);
-          // copy the output from the buffer into our line
-          outputBufferIt = inputBuffer.begin();
-          outputIt.GoToBeginOfLine();
-          while (!outputIt.IsAtEndOfLine())
+          const InputPixelType * inputRow = inputBuffer + input->ComputeOffset(rowIt.GetIndex());
+          OutputPixelType *      outputRow = outputBuffer + output->ComputeOffset(rowIt.GetIndex());
+
+          for (SizeValueType firstLine = 0; firstLine < numberOfLines; firstLine += blockSize)
           {
-            outputIt.Set((*outputBufferIt) / static_cast<PixelType>(vectorSize));
-            ++outputIt;
-            ++outputBufferIt;
+            const SizeValueType blockLines = std::min(blockSize, numberOfLines - firstLine);
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              const InputPixelType * inputSamples = inputRow + ii * inputStride + firstLine;
+              for (SizeValueType line = 0; line < blockLines; ++line)
+              {
+                block[line * vectorSize + ii] = inputSamples[line];
+              }
+            }
+
+            for (SizeValueType line = 0; line < blockLines; ++line)
+            {
+              if (this->m_TransformDirection == Superclass::DIRECT)
+              {
+                transform.Forward(block + line * vectorSize);
+              }
+              else // m_TransformDirection == INVERSE
+              {
+                transform.Backward(block + line * vectorSize);
+              }
+            }
+
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              OutputPixelType * outputSamples = outputRow + ii * outputStride + firstLine;
+              for (SizeValueType line = 0; line < blockLines; ++line)
+              {
+                outputSamples[line] = block[line * vectorSize + ii] * scale;
+              }
+            }
           }
         }
       }
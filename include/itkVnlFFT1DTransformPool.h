@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVnlFFT1DTransformPool_h
+#define itkVnlFFT1DTransformPool_h
+
+#include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+#include "vnl/algo/vnl_fft_1d.h"
+#include "vnl/vnl_vector.h"
+
+namespace itk
+{
+/**
+ * \class VnlFFT1DTransformPool
+ * \brief Process-wide pool of VNL 1D FFT tables and line buffers.
+ *
+ * Setting up a vnl_fft_1d computes the prime factorization and the twiddle
+ * factors of the size.  The VNL 1D FFT filters lease a transform, with a
+ * line buffer of the same size, per work unit, and give it back to the pool
+ * when the work unit is done, so the tables and buffers are reused across
+ * work units, updates and filter instances.  The pool never holds more
+ * transforms of a size than were in use at the same time.
+ *
+ * A transform also keeps a block buffer of up to BlockSize lines, into which
+ * the filters transpose blocks of adjacent lines when the FFT direction is
+ * not the fastest varying dimension of the image, so that the lines are not
+ * gathered one large stride at a time.
+ *
+ * \ingroup FourierTransform
+ * \ingroup Ultrasound
+ */
+template <typename TPixel>
+class VnlFFT1DTransformPool
+{
+public:
+  using ComplexType = std::complex<TPixel>;
+
+  /** Maximum number of lines of a block buffer. */
+  static constexpr SizeValueType BlockSize = 64;
+
+  struct TransformType
+  {
+    explicit TransformType(SizeValueType size)
+      : FFT(size)
+      , Buffer(size)
+    {}
+
+    vnl_fft_1d<TPixel>      FFT;
+    vnl_vector<ComplexType> Buffer;
+    vnl_vector<ComplexType> Block;
+  };
+  using TransformPointer = std::unique_ptr<TransformType>;
+
+  /** A transform of the pool for the lifetime of the lease. */
+  class Lease
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(Lease);
+
+    explicit Lease(SizeValueType size)
+      : m_Transform(Acquire(size))
+    {}
+    ~Lease() { Release(std::move(m_Transform)); }
+
+    /** The line buffer, of the size of the transform. */
+    ComplexType *
+    GetBuffer()
+    {
+      return m_Transform->Buffer.data_block();
+    }
+
+    /** Buffer of numberOfLines contiguous lines, numberOfLines being at most
+     * BlockSize.  It is only allocated the first time it is requested. */
+    ComplexType *
+    GetBlockBuffer(SizeValueType numberOfLines)
+    {
+      const SizeValueType blockSize = numberOfLines * m_Transform->Buffer.size();
+      if (m_Transform->Block.size() < blockSize)
+      {
+        m_Transform->Block.set_size(blockSize);
+      }
+      return m_Transform->Block.data_block();
+    }
+
+    /** Unnormalized DFT of the buffer, in place. */
+    void
+    Forward()
+    {
+      this->Forward(m_Transform->Buffer.data_block());
+    }
+
+    /** Unnormalized DFT of a line of the size of the transform, in place. */
+    void
+    Forward(ComplexType * line)
+    {
+      // VNL's backward transform has the sign of the forward DFT.
+      m_Transform->FFT.transform(line, -1);
+    }
+
+    /** Unnormalized inverse DFT of the buffer, in place. */
+    void
+    Backward()
+    {
+      this->Backward(m_Transform->Buffer.data_block());
+    }
+
+    /** Unnormalized inverse DFT of a line of the size of the transform, in
+     * place. */
+    void
+    Backward(ComplexType * line)
+    {
+      m_Transform->FFT.transform(line, +1);
+    }
+
+  private:
+    TransformPointer m_Transform;
+  };
+
+  static TransformPointer
+  Acquire(SizeValueType size)
+  {
+    {
+      std::lock_guard<std::mutex> lock(GetMutex());
+      PoolType &                  pool = GetPool();
+      const auto                  it = pool.find(size);
+      if (it != pool.end())
+      {
+        TransformPointer transform = std::move(it->second);
+        pool.erase(it);
+        return transform;
+      }
+    }
+    return TransformPointer(new TransformType(size));
+  }
+
+  static void
+  Release(TransformPointer transform)
+  {
+    if (!transform)
+    {
+      return;
+    }
+    const SizeValueType         size = transform->Buffer.size();
+    std::lock_guard<std::mutex> lock(GetMutex());
+    GetPool().emplace(size, std::move(transform));
+  }
+
+  /** Number of transforms waiting in the pool. */
+  static size_t
+  GetNumberOfPooledTransforms()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    return GetPool().size();
+  }
+
+  /** Free the transforms waiting in the pool. */
+  static void
+  Clear()
+  {
+    std::lock_guard<std::mutex> lock(GetMutex());
+    GetPool().clear();
+  }
+
+private:
+  using PoolType = std::multimap<SizeValueType, TransformPointer>;
+
+  static PoolType &
+  GetPool()
+  {
+    static PoolType pool;
+    return pool;
+  }
+
+  static std::mutex &
+  GetMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+};
+
+} // namespace itk
+
+#endif // itkVnlFFT1DTransformPool_h
@@ -54,6 +54,13 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(VnlForward1DFFTImageFilter, Forward1DFFTImageFilter);
 
+  /** The VNL FFT supports sizes whose prime factors are 2, 3 and 5. */
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 5;
+  }
+
 protected:
   void
   GenerateData() override;
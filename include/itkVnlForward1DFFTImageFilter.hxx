@@ -20,15 +20,16 @@
 
 #include "itkVnlForward1DFFTImageFilter.h"
 
+#include <algorithm>
+
 #include "itkForward1DFFTImageFilter.hxx"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkMacro.h"
+#include "itkUltrasoundTrace.h"
 #include "itkVnlFFTCommon.h"
-#include "vnl/algo/vnl_fft_base.h"
-#include "vnl/algo/vnl_fft_1d.h"
+#include "itkVnlFFT1DTransformPool.h"
 
 namespace itk
 {
@@ -45,8 +46,8 @@ VnlForward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
 
   const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
 
-  const unsigned int direction = this->GetDirection();
-  unsigned int       vectorSize = inputSize[direction];
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType vectorSize = inputSize[direction];
   if (!VnlFFTCommon::IsDimensionSizeLegal(vectorSize))
   {
     itkExceptionMacro("Illegal Array DIM for FFT");
@@ -59,47 +60,92 @@ VnlForward1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
     direction,
     output->GetRequestedRegion(),
     [this, input, output, direction, vectorSize](const typename OutputImageType::RegionType & lambdaRegion) {
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
-
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
-
-      using PixelType = typename TInputImage::PixelType;
-      using ComplexType = std::complex<PixelType>;
-      using ComplexVectorType = vnl_vector<ComplexType>;
-      ComplexVectorType                    inputBuffer(vectorSize);
-      typename ComplexVectorType::iterator inputBufferIt = inputBuffer.begin();
-      // fft is done in-place
-      typename ComplexVectorType::iterator outputBufferIt = inputBuffer.begin();
-      vnl_fft_1d<PixelType>                v1d(vectorSize);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      itkUltrasoundTraceScopeMacro("VnlForward1DFFT");
+      using InputPixelType = typename TInputImage::PixelType;
+      using OutputPixelType = typename TOutputImage::PixelType;
+      using TransformPoolType = VnlFFT1DTransformPool<typename TInputImage::PixelType>;
+
+      // The transform tables and the line buffer come from the pool, so
+      // they are only set up once per size and concurrent work unit.
+      typename TransformPoolType::Lease transform(vectorSize);
+      auto *                            buffer = transform.GetBuffer();
+
+      const OffsetValueType  inputStride = input->GetOffsetTable()[direction];
+      const OffsetValueType  outputStride = output->GetOffsetTable()[direction];
+      const InputPixelType * inputBuffer = input->GetBufferPointer();
+      OutputPixelType *      outputBuffer = output->GetBufferPointer();
+
+      // Visit the first sample of every fft line.
+      typename OutputImageType::RegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(direction, 1);
+
+      if (direction == 0)
       {
-        // copy the input line into our buffer
-        inputIt.GoToBeginOfLine();
-        inputBufferIt = inputBuffer.begin();
-        while (!inputIt.IsAtEndOfLine())
+        // The lines are addressed directly in the buffers.
+        ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+        for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
         {
-          *inputBufferIt = inputIt.Value();
-          ++inputIt;
-          ++inputBufferIt;
-        }
+          const InputPixelType * inputLine = inputBuffer + input->ComputeOffset(lineIt.GetIndex());
+          OutputPixelType *      outputLine = outputBuffer + output->ComputeOffset(lineIt.GetIndex());
+
+          for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+          {
+            buffer[ii] = inputLine[ii * inputStride];
+          }
 
-        // do the transform
-        v1d.bwd_transform(inputBuffer);
+          transform.Forward();
 
-        // copy the output from the buffer into our line
-        outputBufferIt = inputBuffer.begin();
-        outputIt.GoToBeginOfLine();
-        while (!outputIt.IsAtEndOfLine())
+          for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+          {
+            outputLine[ii * outputStride] = static_cast<OutputPixelType>(buffer[ii]);
+          }
+        }
+      }
+      else
+      {
+        // The samples of a line are a large stride apart, but the lines are
+        // adjacent along the first dimension: blocks of adjacent lines are
+        // transposed into contiguous lines of the block buffer, transformed,
+        // and transposed back, so that the gather and the scatter stream
+        // through the rows of the image.
+        const SizeValueType numberOfLines = lambdaRegion.GetSize(0);
+        const SizeValueType blockSize = TransformPoolType::BlockSize;
+        auto *              block = transform.GetBlockBuffer(std::min(numberOfLines, blockSize));
+
+        typename OutputImageType::RegionType rowStartRegion = lineStartRegion;
+        rowStartRegion.SetSize(0, 1);
+        ImageRegionConstIteratorWithIndex<OutputImageType> rowIt(output, rowStartRegion);
+        for (rowIt.GoToBegin(); !rowIt.IsAtEnd(); ++rowIt)
         {
-          outputIt.Set(*outputBufferIt);
-          ++outputIt;
-          ++outputBufferIt;
+          const InputPixelType * inputRow = inputBuffer + input->ComputeOffset(rowIt.GetIndex());
+          OutputPixelType *      outputRow = outputBuffer + output->ComputeOffset(rowIt.GetIndex());
+
+          for (SizeValueType firstLine = 0; firstLine < numberOfLines; firstLine += blockSize)
+          {
+            const SizeValueType blockLines = std::min(blockSize, numberOfLines - firstLine);
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              const InputPixelType * inputSamples = inputRow + ii * inputStride + firstLine;
+              for (SizeValueType line = 0; line < blockLines; ++line)
+              {
+                block[line * vectorSize + ii] = inputSamples[line];
+              }
+            }
+
+            for (SizeValueType line = 0; line < blockLines; ++line)
+            {
+              transform.Forward(block + line * vectorSize);
+            }
+
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              OutputPixelType * outputSamples = outputRow + ii * outputStride + firstLine;
+              for (SizeValueType line = 0; line < blockLines; ++line)
+              {
+                outputSamples[line] = static_cast<OutputPixelType>(block[line * vectorSize + ii]);
+              }
+            }
+          }
         }
       }
     },
@@ -55,6 +55,13 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(VnlInverse1DFFTImageFilter, Inverse1DFFTImageFilter);
 
+  /** The VNL FFT supports sizes whose prime factors are 2, 3 and 5. */
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const override
+  {
+    return 5;
+  }
+
 protected:
   void
   GenerateData() override;
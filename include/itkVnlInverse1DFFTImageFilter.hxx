@@ -20,14 +20,15 @@
 
 #include "itkVnlInverse1DFFTImageFilter.h"
 
+#include <algorithm>
+
 #include "itkInverse1DFFTImageFilter.hxx"
-#include "itkImageLinearConstIteratorWithIndex.h"
-#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkMacro.h"
-#include "vnl/algo/vnl_fft_base.h"
-#include "vnl/algo/vnl_fft_1d.h"
+#include "itkUltrasoundTrace.h"
+#include "itkVnlFFT1DTransformPool.h"
 
 namespace itk
 {
@@ -44,8 +45,8 @@ VnlInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
 
   const typename Superclass::InputImageType::SizeType & inputSize = input->GetRequestedRegion().GetSize();
 
-  const unsigned int direction = this->GetDirection();
-  unsigned int       vectorSize = inputSize[direction];
+  const unsigned int  direction = this->GetDirection();
+  const SizeValueType vectorSize = inputSize[direction];
 
   MultiThreaderBase * multiThreader = this->GetMultiThreader();
   multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
@@ -53,45 +54,92 @@ VnlInverse1DFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
     direction,
     output->GetRequestedRegion(),
     [this, input, output, direction, vectorSize](const typename OutputImageType::RegionType & lambdaRegion) {
-      using InputIteratorType = ImageLinearConstIteratorWithIndex<InputImageType>;
-      using OutputIteratorType = ImageLinearIteratorWithIndex<OutputImageType>;
-      InputIteratorType  inputIt(input, lambdaRegion);
-      OutputIteratorType outputIt(output, lambdaRegion);
+      itkUltrasoundTraceScopeMacro("VnlInverse1DFFT");
+      using InputPixelType = typename TInputImage::PixelType;
+      using OutputPixelType = typename TOutputImage::PixelType;
+      using TransformPoolType = VnlFFT1DTransformPool<typename TOutputImage::PixelType>;
 
-      inputIt.SetDirection(direction);
-      outputIt.SetDirection(direction);
+      // The transform tables and the line buffer come from the pool, so
+      // they are only set up once per size and concurrent work unit.
+      typename TransformPoolType::Lease transform(vectorSize);
+      auto *                            buffer = transform.GetBuffer();
 
-      using OutputPixelType = typename TOutputImage::PixelType;
-      vnl_vector<std::complex<OutputPixelType>>                    inputBuffer(vectorSize);
-      typename vnl_vector<std::complex<OutputPixelType>>::iterator inputBufferIt = inputBuffer.begin();
-      // fft is done in-place
-      typename vnl_vector<std::complex<OutputPixelType>>::iterator outputBufferIt = inputBuffer.begin();
-      vnl_fft_1d<OutputPixelType>                                  v1d(vectorSize);
-
-      // for every fft line
-      for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); outputIt.NextLine(), inputIt.NextLine())
+      const OffsetValueType  inputStride = input->GetOffsetTable()[direction];
+      const OffsetValueType  outputStride = output->GetOffsetTable()[direction];
+      const InputPixelType * inputBuffer = input->GetBufferPointer();
+      OutputPixelType *      outputBuffer = output->GetBufferPointer();
+
+      // Visit the first sample of every fft line.
+      typename OutputImageType::RegionType lineStartRegion = lambdaRegion;
+      lineStartRegion.SetSize(direction, 1);
+
+      if (direction == 0)
       {
-        // copy the input line into our buffer
-        inputIt.GoToBeginOfLine();
-        inputBufferIt = inputBuffer.begin();
-        while (!inputIt.IsAtEndOfLine())
+        // The lines are addressed directly in the buffers.
+        ImageRegionConstIteratorWithIndex<OutputImageType> lineIt(output, lineStartRegion);
+        for (lineIt.GoToBegin(); !lineIt.IsAtEnd(); ++lineIt)
         {
-          *inputBufferIt = inputIt.Get();
-          ++inputIt;
-          ++inputBufferIt;
-        }
+          const InputPixelType * inputLine = inputBuffer + input->ComputeOffset(lineIt.GetIndex());
+          OutputPixelType *      outputLine = outputBuffer + output->ComputeOffset(lineIt.GetIndex());
+
+          for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+          {
+            buffer[ii] = static_cast<std::complex<OutputPixelType>>(inputLine[ii * inputStride]);
+          }
 
-        // do the transform
-        v1d.fwd_transform(inputBuffer);
+          transform.Backward();
 
-        // copy the output from the buffer into our line
-        outputBufferIt = inputBuffer.begin();
-        outputIt.GoToBeginOfLine();
-        while (!outputIt.IsAtEndOfLine())
+          for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+          {
+            outputLine[ii * outputStride] = buffer[ii].real() / vectorSize;
+          }
+        }
+      }
+      else
+      {
+        // The samples of a line are a large stride apart, but the lines are
+        // adjacent along the first dimension: blocks of adjacent lines are
+        // transposed into contiguous lines of the block buffer, transformed,
+        // and transposed back, so that the gather and the scatter stream
+        // through the rows of the image.
+        const SizeValueType numberOfLines = lambdaRegion.GetSize(0);
+        const SizeValueType blockSize = TransformPoolType::BlockSize;
+        auto *              block = transform.GetBlockBuffer(std::min(numberOfLines, blockSize));
+
+        typename OutputImageType::RegionType rowStartRegion = lineStartRegion;
+        rowStartRegion.SetSize(0, 1);
+        ImageRegionConstIteratorWithIndex<OutputImageType> rowIt(output, rowStartRegion);
+        for (rowIt.GoToBegin(); !rowIt.IsAtEnd(); ++rowIt)
         {
-          outputIt.Set((*outputBufferIt).real() / vectorSize);
-          ++outputIt;
-          ++outputBufferIt;
+          const InputPixelType * inputRow = inputBuffer + input->ComputeOffset(rowIt.GetIndex());
+          OutputPixelType *      outputRow = outputBuffer + output->ComputeOffset(rowIt.GetIndex());
+
+          for (SizeValueType firstLine = 0; firstLine < numberOfLines; firstLine += blockSize)
+          {
+            const SizeValueType blockLines = std::min(blockSize, numberOfLines - firstLine);
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              const InputPixelType * inputSamples = inputRow + ii * inputStride + firstLine;
+              for (SizeValueType line = 0; line < blockLines; ++line)
+              {
+                block[line * vectorSize + ii] = static_cast<std::complex<OutputPixelType>>(inputSamples[line]);
+              }
+            }
+
+            for (SizeValueType line = 0; line < blockLines; ++line)
+            {
+              transform.Backward(block + line * vectorSize);
+            }
+
+            for (SizeValueType ii = 0; ii < vectorSize; ++ii)
+            {
+              OutputPixelType * outputSamples = outputRow + ii * outputStride + firstLine;
+              for (SizeValueType line = 0; line < blockLines; ++line)
+              {
+                outputSamples[line] = block[line * vectorSize + ii].real() / vectorSize;
+              }
+            }
+          }
         }
       }
     },
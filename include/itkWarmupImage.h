@@ -0,0 +1,66 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkWarmupImage_h
+#define itkWarmupImage_h
+
+#include "itkImageBase.h"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace itk
+{
+
+/** Create an image with the regions, spacing, origin, direction and meta data
+ * of the geometry, filled with low amplitude deterministic noise, on which a
+ * filter can be run once ahead of the first frame of that geometry.  Noise,
+ * rather than a constant, takes the paths of the filters that real frames
+ * take.  Images of the same geometry with different seeds differ.
+ *
+ * This is the input of the Prepare() methods of the composite filters, such
+ * as BModeImageFilter and BlockMatching::DisplacementPipeline.
+ *
+ * \ingroup Ultrasound
+ */
+template <typename TImage>
+typename TImage::Pointer
+CreateWarmupImage(const ImageBase<TImage::ImageDimension> * geometry, uint32_t seed = 1)
+{
+  using PixelType = typename TImage::PixelType;
+  static_assert(std::is_arithmetic<PixelType>::value, "Warmup images have scalar pixels");
+
+  typename TImage::Pointer image = TImage::New();
+  image->CopyInformation(geometry);
+  image->SetRegions(geometry->GetLargestPossibleRegion());
+  image->SetMetaDataDictionary(geometry->GetMetaDataDictionary());
+  image->Allocate();
+
+  uint32_t            state = 2654435761u * seed;
+  PixelType *         buffer = image->GetBufferPointer();
+  const SizeValueType numberOfPixels = image->GetBufferedRegion().GetNumberOfPixels();
+  for (SizeValueType ii = 0; ii < numberOfPixels; ++ii)
+  {
+    state = 1664525u * state + 1013904223u;
+    buffer[ii] = static_cast<PixelType>(1 + (state >> 25));
+  }
+  return image;
+}
+
+} // end namespace itk
+
+#endif // itkWarmupImage_h
@@ -19,19 +19,116 @@
 #  define itkclFFTInitializer_h
 #  include "UltrasoundExport.h"
 
+#  include <map>
+#  include <mutex>
+#  include <string>
+#  include <vector>
+
 #  define __CL_ENABLE_EXCEPTIONS
 #  include "CL/cl.hpp"
 #  include "clFFT.h"
 
 namespace itk
 {
+/** \class clFFTInitializer
+ * \brief Process-wide clFFT state shared by the OpenCL 1D FFT filters.
+ *
+ * Sets up the clFFT library, and owns the OpenCL context and command queues
+ * the FFT filters run on, together with a cache of baked plans.  Plans are
+ * keyed on the command queue, the line length, the number of lines per
+ * batch, the precision, the direction and the layout of the data.  Baking a
+ * plan compiles its kernels, so BakePlan() can be called at startup for the
+ * sizes that will be processed to keep the compilation off the first live
+ * frame.  When a kernel cache directory is set before the first plan is
+ * baked, clFFT also keeps the compiled kernels on disk across processes.
+ *
+ * Plans returned by the cache are owned by the cache and must not be
+ * destroyed by the caller.  The queues are shared by all the filters, so
+ * they must be used with the queue mutex held.
+ *
+ * \ingroup Ultrasound
+ */
 class Ultrasound_EXPORT clFFTInitializer
 {
 public:
+  /** Number of command queues consecutive batches of lines are spread over. */
+  static constexpr unsigned int NumberOfQueues = 3;
+
   clfftSetupData m_clFFTdefaults;
 
   clFFTInitializer();
-  ~clFFTInitializer() { clfftTeardown(); }
+  ~clFFTInitializer();
+
+  cl::Context &
+  GetContext()
+  {
+    return m_Context;
+  }
+
+  cl::CommandQueue &
+  GetQueue(unsigned int queue)
+  {
+    return m_Queues[queue];
+  }
+
+  std::mutex &
+  GetQueueMutex()
+  {
+    return m_QueueMutex;
+  }
+
+  /** Get the in-place plan for batches of batchSize lines of length samples
+   * on the given queue, creating and baking it if needed. */
+  clfftPlanHandle
+  GetPlan(unsigned int   queue,
+          size_t         length,
+          size_t         batchSize,
+          clfftPrecision precision,
+          clfftDirection direction,
+          clfftLayout    layout = CLFFT_COMPLEX_INTERLEAVED);
+
+  /** Bake the plans for the given geometry on all the queues ahead of time. */
+  void
+  BakePlan(size_t         length,
+           size_t         batchSize,
+           clfftPrecision precision,
+           clfftDirection direction,
+           clfftLayout    layout = CLFFT_COMPLEX_INTERLEAVED);
+
+  /** Number of plans currently held by the cache. */
+  size_t
+  GetNumberOfPlans();
+
+  /** Destroy all the cached plans.  No transform may be in flight. */
+  void
+  ClearPlans();
+
+  /** Directory where clFFT stores the binaries of the kernels it compiles,
+   * and looks them up before compiling.  Must be set before the first plan is
+   * baked. */
+  static void
+  SetKernelCacheDirectory(const std::string & directory);
+
+private:
+  struct PlanKeyType
+  {
+    unsigned int   Queue;
+    size_t         Length;
+    size_t         BatchSize;
+    clfftPrecision Precision;
+    clfftDirection Direction;
+    clfftLayout    Layout;
+
+    bool
+    operator<(const PlanKeyType & other) const;
+  };
+
+  cl::Context                   m_Context;
+  std::vector<cl::CommandQueue> m_Queues;
+  std::mutex                    m_QueueMutex;
+
+  std::map<PlanKeyType, clfftPlanHandle> m_Plans;
+  std::mutex                             m_PlansMutex;
 };
 
 // make sure clFFT has been initialized
@@ -25,6 +25,7 @@ itk_module(Ultrasound
     Strain
   PRIVATE_DEPENDS
     ITKHDF5
+    ITKZLIB
     ITKTestKernel
     ITKImageSources
   EXCLUDE_FROM_DEFAULT
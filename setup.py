@@ -41,7 +41,7 @@ setup(
     keywords='ITK InsightToolkit ultrasound imaging',
     url=r'http://www.insight-journal.org/browse/publication/722',
     install_requires=[
-        r'itk>=5.2.1.post1',
+        r'itk>=5.3.0',
         r'itk-bsplinegradient>=0.2.4',
         r'itk-higherorderaccurategradient>=1.1.0',
         r'itk-splitcomponents>=2.0.4',
@@ -0,0 +1,76 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBlockMatchingProgressCounter.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace itk
+{
+namespace BlockMatching
+{
+
+ProgressCounter ::ProgressCounter(ProcessObject * filter, SizeValueType numberOfBlocks, double eventInterval)
+  : m_Filter(filter)
+  , m_NumberOfBlocks(numberOfBlocks)
+  , m_BatchSize(std::max<SizeValueType>(numberOfBlocks / 1000, 1))
+  , m_EventInterval(static_cast<std::int64_t>(std::max(eventInterval, 0.0) * 1e9))
+  , m_NextEventTime(Now() + m_EventInterval)
+{}
+
+
+bool
+ProgressCounter ::CompletedBlocks(SizeValueType numberOfBlocks)
+{
+  const SizeValueType completedBlocks =
+    m_CompletedBlocks.fetch_add(numberOfBlocks, std::memory_order_relaxed) + numberOfBlocks;
+  const std::int64_t now = Now();
+  if (now >= m_NextEventTime.load(std::memory_order_relaxed) &&
+      !m_InvokingEvent.test_and_set(std::memory_order_acquire))
+  {
+    m_NextEventTime.store(now + m_EventInterval, std::memory_order_relaxed);
+    const SizeValueType total = std::max<SizeValueType>(m_NumberOfBlocks, 1);
+    m_Filter->UpdateProgress(static_cast<float>(std::min(completedBlocks, total)) / static_cast<float>(total));
+    m_InvokingEvent.clear(std::memory_order_release);
+  }
+  return !this->IsAborted();
+}
+
+
+void
+ProgressCounter ::CheckAbort()
+{
+  if (this->IsAborted())
+  {
+    ProcessAborted e(__FILE__, __LINE__);
+    e.SetDescription("Process aborted.");
+    e.SetLocation(ITK_LOCATION);
+    throw e;
+  }
+}
+
+
+std::int64_t
+ProgressCounter ::Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+} // end namespace BlockMatching
+} // end namespace itk
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkFFT1DBackendSelector.h"
+
+#include "itksys/SystemTools.hxx"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace itk
+{
+
+namespace
+{
+using ChoiceKeyType = std::tuple<std::string, SizeValueType, SizeValueType, unsigned int>;
+
+struct BackendChoices
+{
+  std::mutex                                                  Mutex;
+  std::map<ChoiceKeyType, FFT1DBackendSelector::BackendType> Choices;
+  std::string                                                 CacheFileName;
+  FFT1DBackendSelector::BackendType                           Override{ FFT1DBackendSelector::DEFAULT_BACKEND };
+  bool                                                        OverrideInitialized{ false };
+};
+
+BackendChoices &
+GetBackendChoices()
+{
+  static BackendChoices choices;
+  return choices;
+}
+
+void
+LoadChoices(BackendChoices & choices)
+{
+  std::ifstream file(choices.CacheFileName.c_str());
+  std::string   transform;
+  SizeValueType lineLength;
+  SizeValueType numberOfLines;
+  unsigned int  precision;
+  std::string   name;
+  // one "transform lineLength numberOfLines precision backend" per line
+  while (file >> transform >> lineLength >> numberOfLines >> precision >> name)
+  {
+    const FFT1DBackendSelector::BackendType backend = FFT1DBackendSelector::GetBackend(name);
+    if (backend != FFT1DBackendSelector::DEFAULT_BACKEND)
+    {
+      choices.Choices[ChoiceKeyType(transform, lineLength, numberOfLines, precision)] = backend;
+    }
+  }
+}
+
+void
+SaveChoices(const BackendChoices & choices)
+{
+  std::ofstream file(choices.CacheFileName.c_str());
+  for (const auto & choice : choices.Choices)
+  {
+    file << std::get<0>(choice.first) << ' ' << std::get<1>(choice.first) << ' ' << std::get<2>(choice.first) << ' '
+         << std::get<3>(choice.first) << ' ' << FFT1DBackendSelector::GetBackendName(choice.second) << '\n';
+  }
+}
+} // namespace
+
+
+void
+FFT1DBackendSelector::SetOverride(BackendType backend)
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  choices.Override = backend;
+  choices.OverrideInitialized = true;
+}
+
+
+FFT1DBackendSelector::BackendType
+FFT1DBackendSelector::GetOverride()
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  if (!choices.OverrideInitialized)
+  {
+    std::string name;
+    itksys::SystemTools::GetEnv("ITKUltrasound_FFT1D_BACKEND", name);
+    choices.Override = GetBackend(name);
+    choices.OverrideInitialized = true;
+  }
+  return choices.Override;
+}
+
+
+std::string
+FFT1DBackendSelector::GetBackendName(BackendType backend)
+{
+  switch (backend)
+  {
+    case VNL_BACKEND:
+      return "Vnl";
+    case FFTW_BACKEND:
+      return "FFTW";
+    case OPENCL_BACKEND:
+      return "OpenCL";
+    default:
+      return "Default";
+  }
+}
+
+
+FFT1DBackendSelector::BackendType
+FFT1DBackendSelector::GetBackend(const std::string & name)
+{
+  for (BackendType backend : { VNL_BACKEND, FFTW_BACKEND, OPENCL_BACKEND })
+  {
+    if (name == GetBackendName(backend))
+    {
+      return backend;
+    }
+  }
+  return DEFAULT_BACKEND;
+}
+
+
+bool
+FFT1DBackendSelector::Lookup(const std::string & transform,
+                             SizeValueType       lineLength,
+                             SizeValueType       numberOfLines,
+                             unsigned int        precision,
+                             BackendType &       backend)
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  const auto it = choices.Choices.find(ChoiceKeyType(transform, lineLength, numberOfLines, precision));
+  if (it == choices.Choices.end())
+  {
+    return false;
+  }
+  backend = it->second;
+  return true;
+}
+
+
+void
+FFT1DBackendSelector::Record(const std::string & transform,
+                             SizeValueType       lineLength,
+                             SizeValueType       numberOfLines,
+                             unsigned int        precision,
+                             BackendType         backend)
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  choices.Choices[ChoiceKeyType(transform, lineLength, numberOfLines, precision)] = backend;
+  if (!choices.CacheFileName.empty())
+  {
+    SaveChoices(choices);
+  }
+}
+
+
+void
+FFT1DBackendSelector::SetCacheFileName(const std::string & fileName)
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  choices.CacheFileName = fileName;
+  if (!fileName.empty() && itksys::SystemTools::FileExists(fileName))
+  {
+    LoadChoices(choices);
+  }
+}
+
+
+std::string
+FFT1DBackendSelector::GetCacheFileName()
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  return choices.CacheFileName;
+}
+
+
+void
+FFT1DBackendSelector::Clear()
+{
+  BackendChoices &            choices = GetBackendChoices();
+  std::lock_guard<std::mutex> lock(choices.Mutex);
+  choices.Choices.clear();
+}
+
+} // end namespace itk
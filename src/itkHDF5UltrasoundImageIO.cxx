@@ -19,8 +19,17 @@
 #include "itkHDF5UltrasoundImageIO.h"
 #include "itkMetaDataObject.h"
 #include "itkArray.h"
+#include "itkMultiThreaderBase.h"
 #include "itksys/SystemTools.hxx"
 #include "itk_H5Cpp.h"
+#include "itk_zlib.h"
+#include "itkHDF5UltrasoundPredType.h"
+#include "itkUltrasoundTrace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 
 namespace itk
 {
@@ -28,16 +37,18 @@ namespace itk
 HDF5UltrasoundImageIO ::HDF5UltrasoundImageIO()
   : m_H5File(nullptr)
   , m_VoxelDataSet(nullptr)
-{}
+{
+  this->AddSupportedWriteExtension(".hdf5");
+  this->AddSupportedWriteExtension(".h5");
+
+  // The deflate levels.
+  this->Self::SetMaximumCompressionLevel(9);
+  this->Self::SetCompressionLevel(5);
+}
 
 
 HDF5UltrasoundImageIO ::~HDF5UltrasoundImageIO()
 {
-  if (this->m_VoxelDataSet != nullptr)
-  {
-    m_VoxelDataSet->close();
-    delete m_VoxelDataSet;
-  }
   this->CloseH5File();
 }
 
@@ -153,44 +164,6 @@ GetH5TypeSpecialize(float, H5::PredType::NATIVE_FLOAT) GetH5TypeSpecialize(doubl
   itkGenericExceptionMacro(<< "unsupported data type " << type.fromClass());
 }
 
-H5::PredType
-ComponentToPredType(IOComponentEnum cType)
-{
-  switch (cType)
-  {
-    case IOComponentEnum::UCHAR:
-      return H5::PredType::NATIVE_UCHAR;
-    case IOComponentEnum::CHAR:
-      return H5::PredType::NATIVE_CHAR;
-    case IOComponentEnum::USHORT:
-      return H5::PredType::NATIVE_USHORT;
-    case IOComponentEnum::SHORT:
-      return H5::PredType::NATIVE_SHORT;
-    case IOComponentEnum::UINT:
-      return H5::PredType::NATIVE_UINT;
-    case IOComponentEnum::INT:
-      return H5::PredType::NATIVE_INT;
-    case IOComponentEnum::ULONG:
-      return H5::PredType::NATIVE_ULONG;
-    case IOComponentEnum::ULONGLONG:
-      return H5::PredType::NATIVE_ULLONG;
-    case IOComponentEnum::LONG:
-      return H5::PredType::NATIVE_LONG;
-    case IOComponentEnum::LONGLONG:
-      return H5::PredType::NATIVE_LLONG;
-    case IOComponentEnum::FLOAT:
-      return H5::PredType::NATIVE_FLOAT;
-    case IOComponentEnum::DOUBLE:
-      return H5::PredType::NATIVE_DOUBLE;
-    case IOComponentEnum::LDOUBLE:
-      return H5::PredType::NATIVE_LDOUBLE;
-    case IOComponentEnum::UNKNOWNCOMPONENTTYPE:
-      itkGenericExceptionMacro(<< "unsupported IOComponentType" << cType);
-  }
-
-  itkGenericExceptionMacro(<< "unsupported IOComponentType" << cType);
-}
-
 std::string
 ComponentToString(IOComponentEnum cType)
 {
@@ -249,6 +222,101 @@ doesAttrExist(const H5::H5Object & object, const char * const name)
   return (H5Aexists(object.getId(), name) > 0 ? true : false);
 }
 
+// The member names of a compound of complex samples, as written and as
+// accepted.
+const char * const RealMemberName = "re";
+const char * const ImaginaryMemberName = "im";
+
+bool
+IsRealMemberName(const std::string & name)
+{
+  return name == "re" || name == "r" || name == "real";
+}
+
+bool
+IsImaginaryMemberName(const std::string & name)
+{
+  return name == "im" || name == "i" || name == "imag";
+}
+
+// The {re, im} compound of the native component type, in the layout of
+// std::complex.
+H5::CompType
+ComplexCompType(const H5::PredType & componentType,
+                const std::string &  realName = RealMemberName,
+                const std::string &  imaginaryName = ImaginaryMemberName)
+{
+  const size_t componentSize = componentType.getSize();
+  H5::CompType complexType(2 * componentSize);
+  complexType.insertMember(realName, 0, componentType);
+  complexType.insertMember(imaginaryName, componentSize, componentType);
+  return complexType;
+}
+
+// The in-memory type of complex samples stored as a compound with a real and
+// an imaginary floating point member.
+H5::CompType
+ComplexMemoryType(const H5::CompType & fileType)
+{
+  if (fileType.getNmembers() != 2 || fileType.getMemberClass(0) != H5T_FLOAT || fileType.getMemberClass(1) != H5T_FLOAT)
+  {
+    itkGenericExceptionMacro(<< "Only compounds of a real and an imaginary floating point member are supported.");
+  }
+  std::string realName = fileType.getMemberName(0);
+  std::string imaginaryName = fileType.getMemberName(1);
+  if (IsImaginaryMemberName(realName) && IsRealMemberName(imaginaryName))
+  {
+    std::swap(realName, imaginaryName);
+  }
+  if (!IsRealMemberName(realName) || !IsImaginaryMemberName(imaginaryName))
+  {
+    itkGenericExceptionMacro(<< "Unsupported compound members " << realName << " and " << imaginaryName);
+  }
+  const size_t componentSize =
+    std::max(fileType.getMemberFloatType(0).getSize(), fileType.getMemberFloatType(1).getSize());
+  return ComplexCompType(componentSize > sizeof(float) ? H5::PredType::NATIVE_DOUBLE : H5::PredType::NATIVE_FLOAT,
+                         realName,
+                         imaginaryName);
+}
+
+// The type of the samples of /bimg: the component type, or the {re, im}
+// compound of complex pixels.
+H5::DataType
+VoxelPredType(IOComponentEnum componentType, bool complexPixels)
+{
+  if (complexPixels)
+  {
+    return ComplexCompType(ComponentToPredType(componentType));
+  }
+  return ComponentToPredType(componentType);
+}
+
+// The meta data of the members of the frame index are Array<double> with
+// this prefix.
+const std::string FrameIndexMetaDataPrefix = "FrameIndex/";
+
+// The default size of the HDF5 chunk cache.
+constexpr SizeValueType DefaultChunkCacheSize = 1024 * 1024;
+
+// The smallest prime not less than value, for the slots of the chunk cache
+// hash table.
+SizeValueType
+NextPrime(SizeValueType value)
+{
+  for (;; ++value)
+  {
+    bool prime = value > 1;
+    for (SizeValueType divisor = 2; prime && divisor * divisor <= value; ++divisor)
+    {
+      prime = value % divisor != 0;
+    }
+    if (prime)
+    {
+      return value;
+    }
+  }
+}
+
 } // end anonymous namespace
 
 
@@ -271,6 +339,19 @@ HDF5UltrasoundImageIO ::ReadVector(const std::string & dataSetName)
 }
 
 
+template <typename TScalar>
+void
+HDF5UltrasoundImageIO ::WriteVector(const std::string & dataSetName, const std::vector<TScalar> & vector)
+{
+  const hsize_t       dim = vector.size();
+  const H5::DataSpace space(1, &dim);
+  const H5::PredType  vecType = GetType<TScalar>();
+  H5::DataSet         dataSet = this->m_H5File->createDataSet(dataSetName, vecType, space);
+  dataSet.write(vector.data(), vecType);
+  dataSet.close();
+}
+
+
 // This method will only test if the header looks like an
 // HDF5 Header.  Some code is redundant with ReadImageInformation
 // a StateMachine could provide a better implementation
@@ -338,13 +419,298 @@ HDF5UltrasoundImageIO ::CanReadFile(const char * fileNameToRead)
 }
 
 
+void
+HDF5UltrasoundImageIO ::OpenVoxelDataSet(SizeValueType chunkCacheSize, SizeValueType chunkCacheSlots)
+{
+  this->CloseVoxelDataSet();
+  H5::DSetAccPropList accessProperties;
+  if (chunkCacheSize > 0)
+  {
+    accessProperties.setChunkCache(chunkCacheSlots, chunkCacheSize, H5D_CHUNK_CACHE_W0_DEFAULT);
+  }
+  this->m_VoxelDataSet = new H5::DataSet(this->m_H5File->openDataSet("/bimg", accessProperties));
+  // Complex samples in a compound are read in the layout of std::complex.
+  this->m_VoxelDataTypeIsCompound = this->m_VoxelDataSet->getTypeClass() == H5T_COMPOUND;
+  if (this->m_VoxelDataTypeIsCompound)
+  {
+    this->m_VoxelDataType = new H5::CompType(ComplexMemoryType(this->m_VoxelDataSet->getCompType()));
+  }
+  else
+  {
+    this->m_VoxelDataType = new H5::DataType(this->m_VoxelDataSet->getDataType());
+  }
+  this->m_VoxelDataSpace = new H5::DataSpace(this->m_VoxelDataSet->getSpace());
+  this->m_VoxelChunkCacheSize = chunkCacheSize;
+
+  this->m_VoxelChunkDimensions.clear();
+  const H5::DSetCreatPropList creationProperties = this->m_VoxelDataSet->getCreatePlist();
+  if (creationProperties.getLayout() == H5D_CHUNKED)
+  {
+    const int            rank = this->m_VoxelDataSpace->getSimpleExtentNdims();
+    std::vector<hsize_t> chunkDimensions(rank);
+    creationProperties.getChunk(rank, chunkDimensions.data());
+    this->m_VoxelChunkDimensions.assign(chunkDimensions.begin(), chunkDimensions.end());
+  }
+}
+
+
+void
+HDF5UltrasoundImageIO ::ConfigureChunkCache()
+{
+  if (this->m_VoxelChunkDimensions.empty())
+  {
+    return;
+  }
+
+  SizeValueType chunkSize = this->m_VoxelDataType->getSize();
+  for (const SizeValueType chunkDimension : this->m_VoxelChunkDimensions)
+  {
+    chunkSize *= chunkDimension;
+  }
+
+  SizeValueType chunkCacheSize = this->m_ChunkCacheSize;
+  if (chunkCacheSize == 0)
+  {
+    // The chunks across the IO region in all but the slowest direction, which
+    // consecutive regions along the slowest direction read again.
+    const ImageIORegion & ioRegion = this->GetIORegion();
+    const unsigned int    rank = this->m_VoxelChunkDimensions.size();
+    if (rank != ioRegion.GetImageDimension())
+    {
+      return;
+    }
+    chunkCacheSize = chunkSize;
+    for (unsigned int ii = 0; ii + 1 < rank; ++ii)
+    {
+      // HDF5 dimensions listed slowest moving first, ITK are fastest
+      // moving first.
+      const SizeValueType chunkDimension = this->m_VoxelChunkDimensions[rank - ii - 1];
+      const SizeValueType firstChunk = ioRegion.GetIndex(ii) / chunkDimension;
+      const SizeValueType lastChunk = (ioRegion.GetIndex(ii) + ioRegion.GetSize(ii) - 1) / chunkDimension;
+      chunkCacheSize *= lastChunk - firstChunk + 1;
+    }
+    if (chunkCacheSize <= std::max(this->m_VoxelChunkCacheSize, DefaultChunkCacheSize))
+    {
+      return;
+    }
+  }
+  if (chunkCacheSize != this->m_VoxelChunkCacheSize)
+  {
+    SizeValueType chunkCacheSlots = this->m_ChunkCacheSlots;
+    if (chunkCacheSlots == 0)
+    {
+      chunkCacheSlots = NextPrime(100 * (chunkCacheSize / chunkSize + 1));
+    }
+    this->OpenVoxelDataSet(chunkCacheSize, chunkCacheSlots);
+  }
+}
+
+
+bool
+HDF5UltrasoundImageIO ::ReadChunksConcurrently(void * buffer)
+{
+#if H5_VERSION_GE(1, 10, 2)
+  const unsigned int    rank = this->m_VoxelChunkDimensions.size();
+  const ImageIORegion & ioRegion = this->GetIORegion();
+  if (!this->m_UseParallelDecompression || rank < 2 || rank != ioRegion.GetImageDimension() ||
+      this->GetNumberOfComponents() != 1)
+  {
+    return false;
+  }
+
+  // Only the filters that can be undone here.  The datatype is native, so the
+  // stored bytes need no conversion.
+  const H5::DSetCreatPropList creationProperties = this->m_VoxelDataSet->getCreatePlist();
+  const int                   numberOfFilters = creationProperties.getNfilters();
+  std::vector<H5Z_filter_t>   filters(numberOfFilters);
+  for (int ii = 0; ii < numberOfFilters; ++ii)
+  {
+    unsigned int flags = 0;
+    size_t       numberOfValues = 0;
+    unsigned int filterConfig = 0;
+    filters[ii] =
+      H5Pget_filter2(creationProperties.getId(), ii, &flags, &numberOfValues, nullptr, 0, nullptr, &filterConfig);
+    if (filters[ii] != H5Z_FILTER_DEFLATE && filters[ii] != H5Z_FILTER_SHUFFLE)
+    {
+      return false;
+    }
+  }
+
+  // HDF5 dimensions listed slowest moving first, ITK are fastest moving
+  // first.
+  const size_t         elementSize = this->m_VoxelDataType->getSize();
+  std::vector<hsize_t> chunkDimensions(rank);
+  std::vector<hsize_t> regionStart(rank);
+  std::vector<hsize_t> regionEnd(rank);
+  std::vector<hsize_t> firstChunk(rank);
+  std::vector<hsize_t> chunksAcross(rank);
+  std::vector<size_t>  chunkStrides(rank);
+  std::vector<size_t>  bufferStrides(rank);
+  size_t               chunkSize = elementSize;
+  size_t               bufferSize = elementSize;
+  SizeValueType        numberOfChunks = 1;
+  for (int ii = rank - 1; ii >= 0; --ii)
+  {
+    const unsigned int dim = rank - ii - 1;
+    chunkDimensions[ii] = this->m_VoxelChunkDimensions[ii];
+    regionStart[ii] = ioRegion.GetIndex(dim);
+    regionEnd[ii] = regionStart[ii] + ioRegion.GetSize(dim);
+    firstChunk[ii] = regionStart[ii] / chunkDimensions[ii];
+    chunksAcross[ii] = (regionEnd[ii] - 1) / chunkDimensions[ii] - firstChunk[ii] + 1;
+    chunkStrides[ii] = chunkSize;
+    bufferStrides[ii] = bufferSize;
+    chunkSize *= chunkDimensions[ii];
+    bufferSize *= ioRegion.GetSize(dim);
+    numberOfChunks *= chunksAcross[ii];
+  }
+
+  const hid_t dataSetId = this->m_VoxelDataSet->getId();
+  std::mutex  h5Mutex;
+  bool        failed = false;
+  auto        readChunk = [&](SizeValueType chunk) {
+    std::vector<hsize_t> chunkOffset(rank);
+    for (int ii = rank - 1; ii >= 0; --ii)
+    {
+      chunkOffset[ii] = (firstChunk[ii] + chunk % chunksAcross[ii]) * chunkDimensions[ii];
+      chunk /= chunksAcross[ii];
+    }
+
+    // The library calls are serialized, and the decoding is concurrent.
+    std::vector<unsigned char> stored;
+    std::vector<unsigned char> decoded(chunkSize);
+    uint32_t                   filterMask = 0;
+    {
+      std::lock_guard<std::mutex> lock(h5Mutex);
+      hsize_t                     storedSize = 0;
+      if (H5Dget_chunk_storage_size(dataSetId, chunkOffset.data(), &storedSize) < 0 || storedSize == 0)
+      {
+        // An unwritten chunk has the default fill value.
+        stored.assign(chunkSize, 0);
+        filterMask = ~static_cast<uint32_t>(0);
+      }
+      else
+      {
+        stored.resize(storedSize);
+        if (H5Dread_chunk(dataSetId, H5P_DEFAULT, chunkOffset.data(), &filterMask, stored.data()) < 0)
+        {
+          failed = true;
+          return;
+        }
+      }
+    }
+
+    // The filters are undone in the reverse order.
+    for (int ff = numberOfFilters - 1; ff >= 0; --ff)
+    {
+      if (filterMask & (1u << ff))
+      {
+        continue;
+      }
+      if (filters[ff] == H5Z_FILTER_DEFLATE)
+      {
+        uLongf decodedSize = chunkSize;
+        if (uncompress(decoded.data(), &decodedSize, stored.data(), stored.size()) != Z_OK || decodedSize != chunkSize)
+        {
+          std::lock_guard<std::mutex> lock(h5Mutex);
+          failed = true;
+          return;
+        }
+      }
+      else
+      {
+        const size_t numberOfElements = chunkSize / elementSize;
+        for (size_t byte = 0; byte < elementSize; ++byte)
+        {
+          const unsigned char * storedBytes = stored.data() + byte * numberOfElements;
+          for (size_t element = 0; element < numberOfElements; ++element)
+          {
+            decoded[element * elementSize + byte] = storedBytes[element];
+          }
+        }
+      }
+      stored.swap(decoded);
+    }
+
+    // Copy the rows of the chunk that are in the region.
+    std::vector<hsize_t> rowStart(rank);
+    std::vector<hsize_t> rowEnd(rank);
+    for (unsigned int ii = 0; ii < rank; ++ii)
+    {
+      rowStart[ii] = std::max(chunkOffset[ii], regionStart[ii]);
+      rowEnd[ii] = std::min(chunkOffset[ii] + chunkDimensions[ii], regionEnd[ii]);
+    }
+    const size_t         rowSize = (rowEnd[rank - 1] - rowStart[rank - 1]) * elementSize;
+    std::vector<hsize_t> position(rowStart);
+    while (position[0] < rowEnd[0])
+    {
+      size_t chunkPosition = 0;
+      size_t bufferPosition = 0;
+      for (unsigned int ii = 0; ii < rank; ++ii)
+      {
+        chunkPosition += (position[ii] - chunkOffset[ii]) * chunkStrides[ii];
+        bufferPosition += (position[ii] - regionStart[ii]) * bufferStrides[ii];
+      }
+      std::memcpy(static_cast<unsigned char *>(buffer) + bufferPosition, stored.data() + chunkPosition, rowSize);
+
+      int ii = static_cast<int>(rank) - 2;
+      for (; ii > 0 && ++position[ii] == rowEnd[ii]; --ii)
+      {
+        position[ii] = rowStart[ii];
+      }
+      if (ii == 0)
+      {
+        ++position[0];
+      }
+    }
+  };
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(0, numberOfChunks, readChunk, nullptr);
+  if (failed)
+  {
+    itkExceptionMacro(<< "Could not decompress the chunks of " << this->GetFileName());
+  }
+  return true;
+#else
+  (void)buffer;
+  return false;
+#endif
+}
+
+
+void
+HDF5UltrasoundImageIO ::CloseVoxelDataSet()
+{
+  if (this->m_VoxelDataSpace != nullptr)
+  {
+    this->m_VoxelDataSpace->close();
+    delete this->m_VoxelDataSpace;
+    this->m_VoxelDataSpace = nullptr;
+  }
+  if (this->m_VoxelDataType != nullptr)
+  {
+    this->m_VoxelDataType->close();
+    delete this->m_VoxelDataType;
+    this->m_VoxelDataType = nullptr;
+  }
+  if (this->m_VoxelDataSet != nullptr)
+  {
+    this->m_VoxelDataSet->close();
+    delete this->m_VoxelDataSet;
+    this->m_VoxelDataSet = nullptr;
+  }
+}
+
+
 void
 HDF5UltrasoundImageIO ::CloseH5File()
 {
+  this->CloseVoxelDataSet();
   if (this->m_H5File != nullptr)
   {
     this->m_H5File->close();
     delete this->m_H5File;
+    this->m_H5File = nullptr;
   }
 }
 
@@ -379,11 +745,37 @@ HDF5UltrasoundImageIO ::ReadImageInformation()
     }
     this->SetDimensions(2, angles);
 
-    // set the ComponentType
-    const std::string  pixelDataName("/bimg");
-    const H5::DataSet  pixelDataSet = this->m_H5File->openDataSet(pixelDataName);
-    const H5::DataType pixelDataType = pixelDataSet.getDataType();
-    this->SetComponentType(PredTypeToComponentType(pixelDataType));
+    // set the ComponentType.  The dataset, its type and its space are kept
+    // for the reads.
+    this->OpenVoxelDataSet();
+    this->SetPixelType(IOPixelEnum::SCALAR);
+    this->SetNumberOfComponents(1);
+    if (this->m_VoxelDataTypeIsCompound)
+    {
+      const auto * complexType = static_cast<const H5::CompType *>(this->m_VoxelDataType);
+      this->SetComponentType(PredTypeToComponentType(complexType->getMemberDataType(0)));
+      this->SetPixelType(IOPixelEnum::COMPLEX);
+      this->SetNumberOfComponents(2);
+    }
+    else
+    {
+      this->SetComponentType(PredTypeToComponentType(*this->m_VoxelDataType));
+      // Complex samples along a trailing dimension of 2.
+      const int rank = this->m_VoxelDataSpace->getSimpleExtentNdims();
+      if (rank == 4)
+      {
+        hsize_t dimensions[4];
+        this->m_VoxelDataSpace->getSimpleExtentDims(dimensions);
+        if (dimensions[3] != 2 || (this->GetComponentType() != IOComponentEnum::FLOAT &&
+                                   this->GetComponentType() != IOComponentEnum::DOUBLE))
+        {
+          itkExceptionMacro(<< "Only a trailing dimension of two floating point components, the complex samples, "
+                            << "is supported.");
+        }
+        this->SetPixelType(IOPixelEnum::COMPLEX);
+        this->SetNumberOfComponents(2);
+      }
+    }
 
 
     // Read out metadata
@@ -412,6 +804,8 @@ HDF5UltrasoundImageIO ::ReadImageInformation()
                                                                       elevationalSliceAngles.size());
     EncapsulateMetaData<ElevationalSliceAnglesMetaDataType>(
       metaDataDict, "ElevationalSliceAngles", elevationalSliceAnglesMetaData);
+
+    this->ReadFrameIndex();
   }
   // catch failure caused by the H5File operations
   catch (H5::AttributeIException & error)
@@ -439,25 +833,193 @@ HDF5UltrasoundImageIO ::ReadImageInformation()
   }
 }
 
+void
+HDF5UltrasoundImageIO ::ReadFrameIndex()
+{
+  this->m_FrameOffsets.clear();
+  this->m_FrameTimestamps.clear();
+  if (H5Lexists(this->m_H5File->getId(), FrameIndexDataSetName, H5P_DEFAULT) <= 0)
+  {
+    return;
+  }
+
+  H5::DataSet dataSet = this->m_H5File->openDataSet(FrameIndexDataSetName);
+  if (dataSet.getTypeClass() != H5T_COMPOUND || dataSet.getSpace().getSimpleExtentNdims() != 1)
+  {
+    itkExceptionMacro(<< "The frame index of " << this->GetFileName() << " is not a list of compounds.");
+  }
+  const H5::CompType indexType = dataSet.getCompType();
+  hsize_t            numberOfFrames = 0;
+  dataSet.getSpace().getSimpleExtentDims(&numberOfFrames);
+
+  // Every numeric member, read as doubles.
+  MetaDataDictionary & metaDataDict = this->GetMetaDataDictionary();
+  for (int ii = 0; ii < indexType.getNmembers(); ++ii)
+  {
+    const H5T_class_t memberClass = indexType.getMemberClass(ii);
+    if (memberClass != H5T_INTEGER && memberClass != H5T_FLOAT)
+    {
+      continue;
+    }
+    const std::string name = indexType.getMemberName(ii);
+    H5::CompType      memberType(sizeof(double));
+    memberType.insertMember(name, 0, H5::PredType::NATIVE_DOUBLE);
+    std::vector<double> values(numberOfFrames);
+    dataSet.read(values.data(), memberType);
+    EncapsulateMetaData<Array<double>>(
+      metaDataDict, FrameIndexMetaDataPrefix + name, Array<double>(values.data(), values.size()));
+    if (name == FrameOffsetMemberName)
+    {
+      this->m_FrameOffsets = values;
+    }
+    else if (name == FrameTimestampMemberName)
+    {
+      this->m_FrameTimestamps = values;
+    }
+  }
+  dataSet.close();
+
+  if (this->m_FrameOffsets.size() != this->m_FrameTimestamps.size())
+  {
+    this->m_FrameOffsets.resize(this->m_FrameTimestamps.size());
+    for (size_t ii = 0; ii < this->m_FrameOffsets.size(); ++ii)
+    {
+      this->m_FrameOffsets[ii] = ii;
+    }
+  }
+}
+
+
+void
+HDF5UltrasoundImageIO ::WriteFrameIndex(SizeValueType numberOfSlices)
+{
+  using ArrayType = Array<double>;
+  const MetaDataDictionary & metaDataDict = this->GetMetaDataDictionary();
+  ArrayType                  timestamps;
+  if (!ExposeMetaData<ArrayType>(metaDataDict, FrameIndexMetaDataPrefix + FrameTimestampMemberName, timestamps))
+  {
+    return;
+  }
+  if (timestamps.size() != numberOfSlices)
+  {
+    itkExceptionMacro(<< "The frame timestamps do not match the slices.");
+  }
+  ArrayType offsets(numberOfSlices);
+  for (SizeValueType ii = 0; ii < numberOfSlices; ++ii)
+  {
+    offsets[ii] = ii;
+  }
+  ExposeMetaData<ArrayType>(metaDataDict, FrameIndexMetaDataPrefix + FrameOffsetMemberName, offsets);
+  if (offsets.size() != numberOfSlices)
+  {
+    itkExceptionMacro(<< "The frame offsets do not match the slices.");
+  }
+
+  // The offset, then the timestamp and the acquisition parameters, doubles
+  // of the length of the slices.
+  std::vector<std::string> names{ FrameTimestampMemberName };
+  std::vector<ArrayType>   columns{ timestamps };
+  for (const std::string & key : metaDataDict.GetKeys())
+  {
+    ArrayType column;
+    if (key.compare(0, FrameIndexMetaDataPrefix.size(), FrameIndexMetaDataPrefix) != 0 ||
+        !ExposeMetaData<ArrayType>(metaDataDict, key, column) || column.size() != numberOfSlices)
+    {
+      continue;
+    }
+    const std::string name = key.substr(FrameIndexMetaDataPrefix.size());
+    if (name != FrameOffsetMemberName && name != FrameTimestampMemberName)
+    {
+      names.push_back(name);
+      columns.push_back(column);
+    }
+  }
+
+  const size_t rowSize = sizeof(std::uint64_t) + columns.size() * sizeof(double);
+  H5::CompType indexType(rowSize);
+  indexType.insertMember(FrameOffsetMemberName, 0, H5::PredType::NATIVE_UINT64);
+  for (size_t jj = 0; jj < columns.size(); ++jj)
+  {
+    indexType.insertMember(names[jj], sizeof(std::uint64_t) + jj * sizeof(double), H5::PredType::NATIVE_DOUBLE);
+  }
+  std::vector<unsigned char> rows(rowSize * numberOfSlices);
+  for (SizeValueType ii = 0; ii < numberOfSlices; ++ii)
+  {
+    unsigned char *     row = rows.data() + ii * rowSize;
+    const std::uint64_t offset = static_cast<std::uint64_t>(offsets[ii]);
+    std::memcpy(row, &offset, sizeof(offset));
+    for (size_t jj = 0; jj < columns.size(); ++jj)
+    {
+      std::memcpy(row + sizeof(std::uint64_t) + jj * sizeof(double), &columns[jj][ii], sizeof(double));
+    }
+  }
+
+  const hsize_t       dimension = numberOfSlices;
+  const H5::DataSpace space(1, &dimension);
+  H5::DataSet         dataSet = this->m_H5File->createDataSet(FrameIndexDataSetName, indexType, space);
+  dataSet.write(rows.data(), indexType);
+  dataSet.close();
+}
+
+
+bool
+HDF5UltrasoundImageIO ::HasFrameIndex() const
+{
+  return !this->m_FrameTimestamps.empty();
+}
+
+
+SizeValueType
+HDF5UltrasoundImageIO ::FindFrameAtTime(double time) const
+{
+  if (this->m_FrameTimestamps.empty())
+  {
+    itkExceptionMacro(<< "There is no frame index in " << this->GetFileName());
+  }
+  const auto   next = std::upper_bound(this->m_FrameTimestamps.begin(), this->m_FrameTimestamps.end(), time);
+  const size_t frame = next == this->m_FrameTimestamps.begin() ? 0 : next - this->m_FrameTimestamps.begin() - 1;
+  return static_cast<SizeValueType>(this->m_FrameOffsets[frame]);
+}
+
+
+bool
+HDF5UltrasoundImageIO ::IsLibraryThreadSafe()
+{
+#if defined(H5_HAVE_THREADSAFE)
+  return true;
+#else
+  return false;
+#endif
+}
+
+
 void
 HDF5UltrasoundImageIO ::SetupStreaming(H5::DataSpace * imageSpace, H5::DataSpace * slabSpace)
 {
-  const ImageIORegion            regionToRead = this->GetIORegion();
-  const ImageIORegion::SizeType  size = regionToRead.GetSize();
-  const ImageIORegion::IndexType start = regionToRead.GetIndex();
+  const ImageIORegion &            regionToRead = this->GetIORegion();
+  const ImageIORegion::SizeType &  size = regionToRead.GetSize();
+  const ImageIORegion::IndexType & start = regionToRead.GetIndex();
   //
   const int numComponents = this->GetNumberOfComponents();
 
-  const int HDFDim(this->GetNumberOfDimensions() + (numComponents > 1 ? 1 : 0));
+  // The components of a compound are in the datatype.
+  const bool componentDimension = numComponents > 1 && !this->m_VoxelDataTypeIsCompound;
+  const int  HDFDim(this->GetNumberOfDimensions() + (componentDimension ? 1 : 0));
 
-  hsize_t * offset = new hsize_t[HDFDim];
-  hsize_t * HDFSize = new hsize_t[HDFDim];
+  // The volumes have three dimensions, plus the components.
+  constexpr int MaximumHDFDim = 4;
+  if (HDFDim > MaximumHDFDim)
+  {
+    itkExceptionMacro(<< "Unsupported number of dimensions: " << HDFDim);
+  }
+  hsize_t   offset[MaximumHDFDim];
+  hsize_t   HDFSize[MaximumHDFDim];
   const int limit = regionToRead.GetImageDimension();
   //
   // fastest moving dimension is intra-voxel
   // index
   int i = 0;
-  if (numComponents > 1)
+  if (componentDimension)
   {
     offset[HDFDim - 1] = 0;
     HDFSize[HDFDim - 1] = numComponents;
@@ -481,45 +1043,226 @@ HDF5UltrasoundImageIO ::SetupStreaming(H5::DataSpace * imageSpace, H5::DataSpace
 
   slabSpace->setExtentSimple(HDFDim, HDFSize);
   imageSpace->selectHyperslab(H5S_SELECT_SET, HDFSize, offset);
-  delete[] HDFSize;
-  delete[] offset;
 }
 
+OffsetValueType
+HDF5UltrasoundImageIO ::GetVoxelDataFileOffset() const
+{
+  if (this->m_VoxelDataSet == nullptr || !this->m_VoxelChunkDimensions.empty() || this->GetNumberOfComponents() != 1)
+  {
+    return -1;
+  }
+  try
+  {
+    const H5::DSetCreatPropList creationProperties = this->m_VoxelDataSet->getCreatePlist();
+    if (creationProperties.getLayout() != H5D_CONTIGUOUS || H5Pget_external_count(creationProperties.getId()) > 0)
+    {
+      return -1;
+    }
+    // Undefined until the samples are written.  The address includes the
+    // user block.
+    const haddr_t address = H5Dget_offset(this->m_VoxelDataSet->getId());
+    if (address == HADDR_UNDEF)
+    {
+      return -1;
+    }
+    return static_cast<OffsetValueType>(address);
+  }
+  catch (H5::Exception & error)
+  {
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
+}
+
+
+bool
+HDF5UltrasoundImageIO ::CanStreamRead()
+{
+  return true;
+}
+
+
 void
 HDF5UltrasoundImageIO ::Read(void * buffer)
 {
-  ImageIORegion            regionToRead = this->GetIORegion();
-  ImageIORegion::SizeType  size = regionToRead.GetSize();
-  ImageIORegion::IndexType start = regionToRead.GetIndex();
+  itkUltrasoundTraceScopeMacro("HDF5UltrasoundImageIORead");
+  try
+  {
+    if (this->m_VoxelDataSet == nullptr)
+    {
+      this->CloseH5File();
+      this->m_H5File = new H5::H5File(this->GetFileName(), H5F_ACC_RDONLY);
+      this->OpenVoxelDataSet();
+    }
 
-  std::string   pixelDataName("/bimg");
-  H5::DataSet   pixelDataSet = this->m_H5File->openDataSet(pixelDataName);
-  H5::DataType  voxelType = pixelDataSet.getDataType();
-  H5::DataSpace imageSpace = pixelDataSet.getSpace();
+    this->ConfigureChunkCache();
+    if (this->ReadChunksConcurrently(buffer))
+    {
+      return;
+    }
 
-  H5::DataSpace dataSpace;
-  this->SetupStreaming(&imageSpace, &dataSpace);
-  pixelDataSet.read(buffer, voxelType, dataSpace, imageSpace);
+    H5::DataSpace slabSpace;
+    this->SetupStreaming(this->m_VoxelDataSpace, &slabSpace);
+    this->m_VoxelDataSet->read(buffer, *this->m_VoxelDataType, slabSpace, *this->m_VoxelDataSpace);
+  }
+  catch (H5::Exception & error)
+  {
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
 }
 
 
 bool
-HDF5UltrasoundImageIO ::CanWriteFile(const char * FileNameToWrite)
+HDF5UltrasoundImageIO ::CanWriteFile(const char * fileNameToWrite)
 {
-  return false;
+  return this->HasSupportedWriteExtension(fileNameToWrite);
 }
 
 
 void
 HDF5UltrasoundImageIO ::WriteImageInformation()
 {
-  return;
+  if (this->GetNumberOfDimensions() != 3)
+  {
+    itkExceptionMacro(<< "Only volumes can be written, not images of dimension " << this->GetNumberOfDimensions());
+  }
+  if (this->GetNumberOfComponents() != 1 && !this->WritesComplexPixels())
+  {
+    itkExceptionMacro(<< "Only scalar or complex floating point pixels can be written.");
+  }
+  if (this->GetUseCompression() && this->m_ChunkLayout == CONTIGUOUS)
+  {
+    itkExceptionMacro(<< "A contiguous dataset cannot be compressed.");
+  }
+
+  const SizeValueType numberOfSamples = this->GetDimensions(0);
+  const SizeValueType numberOfScanlines = this->GetDimensions(1);
+  const SizeValueType numberOfSlices = this->GetDimensions(2);
+
+  // The sample locations, from the meta data of a slice series when present.
+  const MetaDataDictionary & metaDataDict = this->GetMetaDataDictionary();
+  using ArrayType = Array<double>;
+  ArrayType sliceSpacing(2);
+  ArrayType sliceOrigin(2);
+  for (unsigned int ii = 0; ii < 2; ++ii)
+  {
+    sliceSpacing[ii] = this->GetSpacing(ii);
+    sliceOrigin[ii] = this->GetOrigin(ii);
+  }
+  ExposeMetaData<ArrayType>(metaDataDict, "SliceSpacing", sliceSpacing);
+  ExposeMetaData<ArrayType>(metaDataDict, "SliceOrigin", sliceOrigin);
+  ArrayType elevationalSliceAngles(numberOfSlices);
+  for (SizeValueType ii = 0; ii < numberOfSlices; ++ii)
+  {
+    elevationalSliceAngles[ii] = this->GetOrigin(2) + ii * this->GetSpacing(2);
+  }
+  ExposeMetaData<ArrayType>(metaDataDict, "ElevationalSliceAngles", elevationalSliceAngles);
+  if (sliceSpacing.size() != 2 || sliceOrigin.size() != 2 || elevationalSliceAngles.size() != numberOfSlices)
+  {
+    itkExceptionMacro(<< "The slice meta data does not match the image dimensions.");
+  }
+
+  std::vector<double> axialPixelLocations(numberOfSamples);
+  for (SizeValueType ii = 0; ii < numberOfSamples; ++ii)
+  {
+    axialPixelLocations[ii] = sliceOrigin[0] + ii * sliceSpacing[0];
+  }
+  // The lateral origin is read from the second location.
+  std::vector<double> lateralPixelLocations(numberOfScanlines);
+  for (SizeValueType ii = 0; ii < numberOfScanlines; ++ii)
+  {
+    lateralPixelLocations[ii] = sliceOrigin[1] + (static_cast<double>(ii) - 1.0) * sliceSpacing[1];
+  }
+  std::vector<double> elevationalSliceAnglesInDegrees(numberOfSlices);
+  for (SizeValueType ii = 0; ii < numberOfSlices; ++ii)
+  {
+    elevationalSliceAnglesInDegrees[ii] = elevationalSliceAngles[ii] / Math::pi_over_180;
+  }
+
+  try
+  {
+    this->CloseH5File();
+    this->m_H5File = new H5::H5File(this->GetFileName(), H5F_ACC_TRUNC);
+
+    this->WriteVector<double>("/axial", axialPixelLocations);
+    this->WriteVector<double>("/lat", lateralPixelLocations);
+    this->WriteVector<double>("/eleAngle", elevationalSliceAnglesInDegrees);
+    this->WriteFrameIndex(numberOfSlices);
+
+    // HDF5 dimensions listed slowest moving first.
+    const hsize_t       dimensions[3] = { numberOfSlices, numberOfScanlines, numberOfSamples };
+    const H5::DataSpace imageSpace(3, dimensions);
+    H5::DSetCreatPropList properties;
+    if (this->m_ChunkLayout != CONTIGUOUS)
+    {
+      const hsize_t chunkDimensions[3] = { 1, this->m_ChunkLayout == CHUNK_SLICES ? numberOfScanlines : 1,
+                                           numberOfSamples };
+      properties.setChunk(3, chunkDimensions);
+      if (this->GetUseCompression())
+      {
+        if (this->m_UseShuffle)
+        {
+          properties.setShuffle();
+        }
+        properties.setDeflate(this->GetCompressionLevel());
+      }
+    }
+    H5::DataSet pixelDataSet = this->m_H5File->createDataSet(
+      "/bimg", VoxelPredType(this->GetComponentType(), this->WritesComplexPixels()), imageSpace, properties);
+    pixelDataSet.close();
+  }
+  // catch failure caused by the H5File, DataSet, DataSpace or property list
+  // operations
+  catch (H5::Exception & error)
+  {
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
 }
 
+
 void
 HDF5UltrasoundImageIO ::Write(const void * buffer)
 {
-  return;
+  // The file is removed before the first piece of a streamed write, and the
+  // following pieces are written to its dataset.
+  const bool createFile = !this->RequestedToStream() || !itksys::SystemTools::FileExists(this->GetFileName());
+  if (createFile)
+  {
+    this->WriteImageInformation();
+  }
+
+  try
+  {
+    if (!createFile)
+    {
+      this->CloseH5File();
+      this->m_H5File = new H5::H5File(this->GetFileName(), H5F_ACC_RDWR);
+    }
+
+    const bool    complexPixels = this->WritesComplexPixels();
+    H5::DataSet   pixelDataSet = this->m_H5File->openDataSet("/bimg");
+    H5::DataSpace imageSpace = pixelDataSet.getSpace();
+    H5::DataSpace slabSpace;
+    this->m_VoxelDataTypeIsCompound = complexPixels;
+    this->SetupStreaming(&imageSpace, &slabSpace);
+    pixelDataSet.write(buffer, VoxelPredType(this->GetComponentType(), complexPixels), slabSpace, imageSpace);
+    pixelDataSet.close();
+
+    // Complete the file after every piece.
+    this->CloseH5File();
+  }
+  catch (H5::Exception & error)
+  {
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
+}
+
+
+bool
+HDF5UltrasoundImageIO ::WritesComplexPixels() const
+{
+  return this->GetPixelType() == IOPixelEnum::COMPLEX && this->GetNumberOfComponents() == 2 &&
+         (this->GetComponentType() == IOComponentEnum::FLOAT || this->GetComponentType() == IOComponentEnum::DOUBLE);
 }
 
 
@@ -536,6 +1279,11 @@ HDF5UltrasoundImageIO ::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
   // just prints out the pointer value.
   os << indent << "H5File: " << this->m_H5File << std::endl;
+  os << indent << "ChunkLayout: " << this->m_ChunkLayout << std::endl;
+  os << indent << "UseShuffle: " << (this->m_UseShuffle ? "On" : "Off") << std::endl;
+  os << indent << "ChunkCacheSize: " << this->m_ChunkCacheSize << std::endl;
+  os << indent << "ChunkCacheSlots: " << this->m_ChunkCacheSlots << std::endl;
+  os << indent << "UseParallelDecompression: " << (this->m_UseParallelDecompression ? "On" : "Off") << std::endl;
 }
 
 } // end namespace itk
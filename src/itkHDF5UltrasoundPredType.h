@@ -0,0 +1,75 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkHDF5UltrasoundPredType_h
+#define itkHDF5UltrasoundPredType_h
+
+#include "itkImageIOBase.h"
+#include "itk_H5Cpp.h"
+
+namespace itk
+{
+
+// The native HDF5 type of an IO component type, shared by the HDF5
+// ultrasound IO and the recording writer.
+inline H5::PredType
+ComponentToPredType(IOComponentEnum cType)
+{
+  switch (cType)
+  {
+    case IOComponentEnum::UCHAR:
+      return H5::PredType::NATIVE_UCHAR;
+    case IOComponentEnum::CHAR:
+      return H5::PredType::NATIVE_CHAR;
+    case IOComponentEnum::USHORT:
+      return H5::PredType::NATIVE_USHORT;
+    case IOComponentEnum::SHORT:
+      return H5::PredType::NATIVE_SHORT;
+    case IOComponentEnum::UINT:
+      return H5::PredType::NATIVE_UINT;
+    case IOComponentEnum::INT:
+      return H5::PredType::NATIVE_INT;
+    case IOComponentEnum::ULONG:
+      return H5::PredType::NATIVE_ULONG;
+    case IOComponentEnum::ULONGLONG:
+      return H5::PredType::NATIVE_ULLONG;
+    case IOComponentEnum::LONG:
+      return H5::PredType::NATIVE_LONG;
+    case IOComponentEnum::LONGLONG:
+      return H5::PredType::NATIVE_LLONG;
+    case IOComponentEnum::FLOAT:
+      return H5::PredType::NATIVE_FLOAT;
+    case IOComponentEnum::DOUBLE:
+      return H5::PredType::NATIVE_DOUBLE;
+    case IOComponentEnum::LDOUBLE:
+      return H5::PredType::NATIVE_LDOUBLE;
+    case IOComponentEnum::UNKNOWNCOMPONENTTYPE:
+      itkGenericExceptionMacro(<< "unsupported IOComponentType" << cType);
+  }
+
+  itkGenericExceptionMacro(<< "unsupported IOComponentType" << cType);
+}
+
+// The optional frame index: one compound per frame, with the slice of the
+// frame in /bimg, its timestamp in seconds, and acquisition parameters.
+constexpr const char * FrameIndexDataSetName = "/frameIndex";
+constexpr const char * FrameOffsetMemberName = "offset";
+constexpr const char * FrameTimestampMemberName = "timestamp";
+
+} // end namespace itk
+
+#endif // itkHDF5UltrasoundPredType_h
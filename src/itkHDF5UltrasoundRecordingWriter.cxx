@@ -0,0 +1,398 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkHDF5UltrasoundRecordingWriter.h"
+#include "itkMath.h"
+#include "itk_H5Cpp.h"
+#include "itkHDF5UltrasoundPredType.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace itk
+{
+
+namespace
+{
+
+// A row of the frame index of a recording.
+struct FrameIndexRow
+{
+  std::uint64_t offset;
+  double        timestamp;
+};
+
+H5::CompType
+FrameIndexType()
+{
+  H5::CompType indexType(sizeof(FrameIndexRow));
+  indexType.insertMember(FrameOffsetMemberName, HOFFSET(FrameIndexRow, offset), H5::PredType::NATIVE_UINT64);
+  indexType.insertMember(FrameTimestampMemberName, HOFFSET(FrameIndexRow, timestamp), H5::PredType::NATIVE_DOUBLE);
+  return indexType;
+}
+
+} // end anonymous namespace
+
+
+HDF5UltrasoundRecordingWriter ::~HDF5UltrasoundRecordingWriter()
+{
+  try
+  {
+    this->Stop();
+  }
+  catch (...)
+  {
+    // The error of the last write is lost.
+  }
+}
+
+
+void
+HDF5UltrasoundRecordingWriter ::StartRecording(const FrameSizeType & frameSize,
+                                               const SpacingType &   spacing,
+                                               const PointType &     origin,
+                                               IOComponentEnum       componentType,
+                                               SizeValueType         componentSize)
+{
+  if (this->IsRecording())
+  {
+    itkExceptionMacro(<< "The recording to " << m_FileName << " is not stopped.");
+  }
+  if (m_FileName.empty())
+  {
+    itkExceptionMacro(<< "No file name is set.");
+  }
+  if (frameSize[0] < 1 || frameSize[1] < 1)
+  {
+    itkExceptionMacro(<< "The reference frame is empty.");
+  }
+
+  const SizeValueType numberOfSamples = frameSize[0];
+  const SizeValueType numberOfScanlines = frameSize[1];
+
+  // The sample locations, as written by HDF5UltrasoundImageIO: the lateral
+  // origin is read from the second location.
+  std::vector<double> axialPixelLocations(numberOfSamples);
+  for (SizeValueType ii = 0; ii < numberOfSamples; ++ii)
+  {
+    axialPixelLocations[ii] = origin[0] + ii * spacing[0];
+  }
+  std::vector<double> lateralPixelLocations(numberOfScanlines);
+  for (SizeValueType ii = 0; ii < numberOfScanlines; ++ii)
+  {
+    lateralPixelLocations[ii] = origin[1] + (static_cast<double>(ii) - 1.0) * spacing[1];
+  }
+
+  try
+  {
+    this->CloseH5File();
+    m_H5File = new H5::H5File(m_FileName, H5F_ACC_TRUNC);
+
+    const H5::PredType locationType = H5::PredType::NATIVE_DOUBLE;
+    hsize_t            locationDimension = numberOfSamples;
+    H5::DataSet        axialDataSet =
+      m_H5File->createDataSet("/axial", locationType, H5::DataSpace(1, &locationDimension));
+    axialDataSet.write(axialPixelLocations.data(), locationType);
+    axialDataSet.close();
+    locationDimension = numberOfScanlines;
+    H5::DataSet lateralDataSet = m_H5File->createDataSet("/lat", locationType, H5::DataSpace(1, &locationDimension));
+    lateralDataSet.write(lateralPixelLocations.data(), locationType);
+    lateralDataSet.close();
+
+    // The frames are appended along the unlimited, slowest, dimension.
+    const hsize_t         listDimension = 0;
+    const hsize_t         maximumListDimension = H5S_UNLIMITED;
+    const hsize_t         listChunkDimension = 256;
+    const H5::DataSpace   listSpace(1, &listDimension, &maximumListDimension);
+    H5::DSetCreatPropList listProperties;
+    listProperties.setChunk(1, &listChunkDimension);
+    m_AngleDataSet = new H5::DataSet(m_H5File->createDataSet("/eleAngle", locationType, listSpace, listProperties));
+    m_FrameIndexDataSet =
+      new H5::DataSet(m_H5File->createDataSet(FrameIndexDataSetName, FrameIndexType(), listSpace, listProperties));
+
+    const hsize_t         dimensions[3] = { 0, numberOfScanlines, numberOfSamples };
+    const hsize_t         maximumDimensions[3] = { H5S_UNLIMITED, numberOfScanlines, numberOfSamples };
+    const hsize_t         chunkDimensions[3] = { 1, numberOfScanlines, numberOfSamples };
+    H5::DSetCreatPropList properties;
+    properties.setChunk(3, chunkDimensions);
+    if (m_UseCompression)
+    {
+      if (m_UseShuffle)
+      {
+        properties.setShuffle();
+      }
+      properties.setDeflate(m_CompressionLevel);
+    }
+    m_VoxelDataSet = new H5::DataSet(m_H5File->createDataSet(
+      "/bimg", ComponentToPredType(componentType), H5::DataSpace(3, dimensions, maximumDimensions), properties));
+  }
+  catch (H5::Exception & error)
+  {
+    this->CloseH5File();
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
+
+  m_ComponentType = componentType;
+  m_FrameSize = frameSize;
+  m_FrameBytes = numberOfSamples * numberOfScanlines * componentSize;
+  m_QueueBuffer.assign(m_QueueCapacity * m_FrameBytes, 0);
+  m_QueueAngles.assign(m_QueueCapacity, 0.0);
+  m_QueueTimestamps.assign(m_QueueCapacity, 0.0);
+  m_QueueHead = 0;
+  m_QueueDepth = 0;
+  m_MaximumQueueDepth = 0;
+  m_NumberOfWrittenFrames = 0;
+  m_NumberOfDroppedFrames = 0;
+  m_Stopping = false;
+  m_WriteError.clear();
+
+  m_StartTime = std::chrono::steady_clock::now();
+  m_IOThread = std::thread([this]() { this->WriteFrames(); });
+}
+
+
+bool
+HDF5UltrasoundRecordingWriter ::PushFrameBuffer(const void * buffer, double elevationalAngle, double timestamp)
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (!m_IOThread.joinable() || m_Stopping)
+  {
+    itkExceptionMacro(<< "The recording is not started.");
+  }
+  if (m_BlockWhenFull)
+  {
+    m_FrameWritten.wait(lock, [this]() { return m_QueueDepth < m_QueueCapacity || !m_WriteError.empty(); });
+  }
+  if (m_QueueDepth == m_QueueCapacity || !m_WriteError.empty())
+  {
+    ++m_NumberOfDroppedFrames;
+    return false;
+  }
+
+  // The I/O thread writes the queued frames without the lock, but never the
+  // buffer of the tail.
+  const SizeValueType tail = (m_QueueHead + m_QueueDepth) % m_QueueCapacity;
+  std::memcpy(m_QueueBuffer.data() + tail * m_FrameBytes, buffer, m_FrameBytes);
+  m_QueueAngles[tail] = elevationalAngle;
+  m_QueueTimestamps[tail] = timestamp;
+  ++m_QueueDepth;
+  m_MaximumQueueDepth = std::max(m_MaximumQueueDepth, m_QueueDepth);
+  lock.unlock();
+  m_FrameQueued.notify_one();
+  return true;
+}
+
+
+void
+HDF5UltrasoundRecordingWriter ::WriteFrames()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (true)
+  {
+    m_FrameQueued.wait(lock, [this]() { return m_QueueDepth > 0 || m_Stopping; });
+    if (m_QueueDepth == 0)
+    {
+      return;
+    }
+
+    const SizeValueType head = m_QueueHead;
+    lock.unlock();
+    std::string error;
+    try
+    {
+      this->WriteFrame(m_QueueBuffer.data() + head * m_FrameBytes, m_QueueAngles[head], m_QueueTimestamps[head]);
+    }
+    catch (const ExceptionObject & exception)
+    {
+      error = exception.GetDescription();
+    }
+    lock.lock();
+
+    m_QueueHead = (m_QueueHead + 1) % m_QueueCapacity;
+    --m_QueueDepth;
+    if (error.empty())
+    {
+      ++m_NumberOfWrittenFrames;
+    }
+    else
+    {
+      // The following frames are dropped.
+      m_WriteError = error;
+      m_NumberOfDroppedFrames += m_QueueDepth + 1;
+      m_QueueDepth = 0;
+    }
+    m_FrameWritten.notify_all();
+  }
+}
+
+
+void
+HDF5UltrasoundRecordingWriter ::WriteFrame(const void * buffer, double elevationalAngle, double timestamp)
+{
+  try
+  {
+    // HDF5 dimensions listed slowest moving first.
+    const hsize_t frame = m_NumberOfWrittenFrames;
+    const hsize_t dimensions[3] = { frame + 1, m_FrameSize[1], m_FrameSize[0] };
+    m_VoxelDataSet->extend(dimensions);
+    H5::DataSpace imageSpace = m_VoxelDataSet->getSpace();
+    const hsize_t offset[3] = { frame, 0, 0 };
+    const hsize_t slabDimensions[3] = { 1, m_FrameSize[1], m_FrameSize[0] };
+    H5::DataSpace slabSpace(3, slabDimensions);
+    imageSpace.selectHyperslab(H5S_SELECT_SET, slabDimensions, offset);
+    m_VoxelDataSet->write(buffer, ComponentToPredType(m_ComponentType), slabSpace, imageSpace);
+
+    // One element of the lists per frame.
+    const hsize_t       listDimension = frame + 1;
+    const hsize_t       listOffset = frame;
+    const hsize_t       listSlabDimension = 1;
+    const H5::DataSpace listSlabSpace(1, &listSlabDimension);
+    m_AngleDataSet->extend(&listDimension);
+    H5::DataSpace angleSpace = m_AngleDataSet->getSpace();
+    angleSpace.selectHyperslab(H5S_SELECT_SET, &listSlabDimension, &listOffset);
+    // Stored in degrees.
+    const double elevationalAngleInDegrees = elevationalAngle / Math::pi_over_180;
+    m_AngleDataSet->write(&elevationalAngleInDegrees, H5::PredType::NATIVE_DOUBLE, listSlabSpace, angleSpace);
+
+    m_FrameIndexDataSet->extend(&listDimension);
+    H5::DataSpace indexSpace = m_FrameIndexDataSet->getSpace();
+    indexSpace.selectHyperslab(H5S_SELECT_SET, &listSlabDimension, &listOffset);
+    const FrameIndexRow row{ static_cast<std::uint64_t>(frame), timestamp };
+    m_FrameIndexDataSet->write(&row, FrameIndexType(), listSlabSpace, indexSpace);
+  }
+  catch (H5::Exception & error)
+  {
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
+}
+
+
+void
+HDF5UltrasoundRecordingWriter ::Stop()
+{
+  if (!m_IOThread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stopping = true;
+  }
+  m_FrameQueued.notify_one();
+  m_IOThread.join();
+
+  try
+  {
+    this->CloseH5File();
+  }
+  catch (H5::Exception & error)
+  {
+    itkExceptionMacro(<< error.getCDetailMsg());
+  }
+  if (!m_WriteError.empty())
+  {
+    itkExceptionMacro(<< "Could not write the frames to " << m_FileName << ": " << m_WriteError);
+  }
+}
+
+
+double
+HDF5UltrasoundRecordingWriter ::GetTimeSinceStart() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+}
+
+
+SizeValueType
+HDF5UltrasoundRecordingWriter ::GetNumberOfWrittenFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfWrittenFrames;
+}
+
+
+SizeValueType
+HDF5UltrasoundRecordingWriter ::GetNumberOfDroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfDroppedFrames;
+}
+
+
+SizeValueType
+HDF5UltrasoundRecordingWriter ::GetQueueDepth() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_QueueDepth;
+}
+
+
+SizeValueType
+HDF5UltrasoundRecordingWriter ::GetMaximumQueueDepth() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MaximumQueueDepth;
+}
+
+
+void
+HDF5UltrasoundRecordingWriter ::CloseH5File()
+{
+  if (m_FrameIndexDataSet != nullptr)
+  {
+    m_FrameIndexDataSet->close();
+    delete m_FrameIndexDataSet;
+    m_FrameIndexDataSet = nullptr;
+  }
+  if (m_AngleDataSet != nullptr)
+  {
+    m_AngleDataSet->close();
+    delete m_AngleDataSet;
+    m_AngleDataSet = nullptr;
+  }
+  if (m_VoxelDataSet != nullptr)
+  {
+    m_VoxelDataSet->close();
+    delete m_VoxelDataSet;
+    m_VoxelDataSet = nullptr;
+  }
+  if (m_H5File != nullptr)
+  {
+    m_H5File->close();
+    delete m_H5File;
+    m_H5File = nullptr;
+  }
+}
+
+
+void
+HDF5UltrasoundRecordingWriter ::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileName: " << m_FileName << std::endl;
+  os << indent << "QueueCapacity: " << m_QueueCapacity << std::endl;
+  os << indent << "BlockWhenFull: " << (m_BlockWhenFull ? "On" : "Off") << std::endl;
+  os << indent << "UseCompression: " << (m_UseCompression ? "On" : "Off") << std::endl;
+  os << indent << "CompressionLevel: " << m_CompressionLevel << std::endl;
+  os << indent << "UseShuffle: " << (m_UseShuffle ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfWrittenFrames: " << this->GetNumberOfWrittenFrames() << std::endl;
+  os << indent << "NumberOfDroppedFrames: " << this->GetNumberOfDroppedFrames() << std::endl;
+}
+
+} // end namespace itk
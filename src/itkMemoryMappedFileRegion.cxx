@@ -0,0 +1,122 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkMemoryMappedFileRegion.h"
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+namespace itk
+{
+
+MemoryMappedFileRegion ::~MemoryMappedFileRegion()
+{
+  this->Unmap();
+}
+
+
+void
+MemoryMappedFileRegion ::Map(const std::string & fileName, SizeValueType offset, SizeValueType length)
+{
+  this->Unmap();
+  if (length == 0)
+  {
+    return;
+  }
+
+  // The mapping starts at the page, or allocation granularity, boundary before
+  // the offset.
+#if defined(_WIN32)
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  const SizeValueType granularity = systemInfo.dwAllocationGranularity;
+#else
+  const SizeValueType granularity = sysconf(_SC_PAGESIZE);
+#endif
+  const SizeValueType alignedOffset = offset - offset % granularity;
+  const SizeValueType mappingLength = length + (offset - alignedOffset);
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(
+    fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    itkExceptionMacro(<< "Could not open " << fileName);
+  }
+  HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (fileMapping == nullptr)
+  {
+    itkExceptionMacro(<< "Could not map " << fileName);
+  }
+  const unsigned long long mappingOffset = alignedOffset;
+  const DWORD              mappingOffsetHigh = static_cast<DWORD>(mappingOffset >> 32);
+  const DWORD              mappingOffsetLow = static_cast<DWORD>(mappingOffset & 0xffffffff);
+  void * mapping = MapViewOfFile(fileMapping, FILE_MAP_COPY, mappingOffsetHigh, mappingOffsetLow, mappingLength);
+  // The view keeps the file mapping.
+  CloseHandle(fileMapping);
+  if (mapping == nullptr)
+  {
+    itkExceptionMacro(<< "Could not map " << length << " bytes at " << offset << " of " << fileName);
+  }
+#else
+  const int file = open(fileName.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    itkExceptionMacro(<< "Could not open " << fileName);
+  }
+  void * mapping =
+    mmap(nullptr, mappingLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, static_cast<off_t>(alignedOffset));
+  // The mapping keeps the file.
+  close(file);
+  if (mapping == MAP_FAILED)
+  {
+    itkExceptionMacro(<< "Could not map " << length << " bytes at " << offset << " of " << fileName);
+  }
+#endif
+
+  m_Mapping = mapping;
+  m_MappingLength = mappingLength;
+  m_Pointer = static_cast<char *>(mapping) + (offset - alignedOffset);
+  m_Length = length;
+}
+
+
+void
+MemoryMappedFileRegion ::Unmap()
+{
+  if (m_Mapping == nullptr)
+  {
+    return;
+  }
+#if defined(_WIN32)
+  UnmapViewOfFile(m_Mapping);
+#else
+  munmap(m_Mapping, m_MappingLength);
+#endif
+  m_Mapping = nullptr;
+  m_MappingLength = 0;
+  m_Pointer = nullptr;
+  m_Length = 0;
+}
+
+} // end namespace itk
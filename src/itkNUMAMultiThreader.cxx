@@ -0,0 +1,244 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkNUMAMultiThreader.h"
+
+#include "itkObjectFactoryBase.h"
+#include "itkVersion.h"
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <typeinfo>
+
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+
+namespace itk
+{
+
+namespace
+{
+
+/** Factory of the NUMAMultiThreader override of MultiThreaderBase. */
+class NUMAMultiThreaderFactory : public ObjectFactoryBase
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(NUMAMultiThreaderFactory);
+
+  using Self = NUMAMultiThreaderFactory;
+  using Superclass = ObjectFactoryBase;
+  using Pointer = SmartPointer<Self>;
+
+  itkFactorylessNewMacro(Self);
+  itkTypeMacro(NUMAMultiThreaderFactory, ObjectFactoryBase);
+
+  const char *
+  GetITKSourceVersion() const override
+  {
+    return ITK_SOURCE_VERSION;
+  }
+
+  const char *
+  GetDescription() const override
+  {
+    return "Creates NUMAMultiThreader instances of MultiThreaderBase";
+  }
+
+protected:
+  NUMAMultiThreaderFactory()
+  {
+    this->RegisterOverride(typeid(MultiThreaderBase).name(),
+                           typeid(NUMAMultiThreader).name(),
+                           "NUMA multi-threader",
+                           true,
+                           CreateObjectFunction<NUMAMultiThreader>::New());
+  }
+};
+
+
+/** Restores the CPU affinity of the calling thread when it goes out of scope,
+ * so that the work unit run on the thread of the caller, and the threads
+ * that it creates afterwards, are not left pinned to a node. */
+class ScopedAffinity
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ScopedAffinity);
+
+  explicit ScopedAffinity(bool save)
+  {
+#if defined(__linux__)
+    m_Saved = save && sched_getaffinity(0, sizeof(m_CPUSet), &m_CPUSet) == 0;
+#else
+    (void)save;
+#endif
+  }
+
+  ~ScopedAffinity()
+  {
+#if defined(__linux__)
+    if (m_Saved)
+    {
+      sched_setaffinity(0, sizeof(m_CPUSet), &m_CPUSet);
+    }
+#endif
+  }
+
+private:
+#if defined(__linux__)
+  cpu_set_t m_CPUSet;
+  bool      m_Saved{ false };
+#endif
+};
+
+} // end anonymous namespace
+
+
+NUMAMultiThreader::NUMAMultiThreader()
+{
+#if defined(__linux__)
+  // The nodes are numbered from 0, with a list of CPU ranges each, such as
+  // "0-15,32-47".
+  for (unsigned int node = 0;; ++node)
+  {
+    std::ostringstream fileName;
+    fileName << "/sys/devices/system/node/node" << node << "/cpulist";
+    std::ifstream file(fileName.str());
+    if (!file)
+    {
+      break;
+    }
+    std::vector<unsigned int> cpus;
+    std::string               range;
+    while (std::getline(file, range, ','))
+    {
+      unsigned int      first = 0;
+      unsigned int      last = 0;
+      char              dash = 0;
+      std::stringstream rangeStream(range);
+      if (!(rangeStream >> first))
+      {
+        continue;
+      }
+      if (rangeStream >> dash)
+      {
+        if (dash != '-' || !(rangeStream >> last))
+        {
+          last = first;
+        }
+      }
+      else
+      {
+        last = first;
+      }
+      for (unsigned int cpu = first; cpu <= last; ++cpu)
+      {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty())
+    {
+      m_NodeCPUs.push_back(cpus);
+    }
+  }
+#endif
+  if (m_NodeCPUs.empty())
+  {
+    m_NodeCPUs.resize(1);
+  }
+}
+
+
+unsigned int
+NUMAMultiThreader::GetWorkUnitNode(ThreadIdType workUnit, ThreadIdType numberOfWorkUnits) const
+{
+  if (numberOfWorkUnits == 0)
+  {
+    return 0;
+  }
+  return static_cast<unsigned int>(static_cast<SizeValueType>(workUnit) * m_NodeCPUs.size() / numberOfWorkUnits);
+}
+
+
+void
+NUMAMultiThreader::SetSingleMethod(ThreadFunctionType method, void * data)
+{
+  m_PinnedMethod = method;
+  m_PinnedData = data;
+  Superclass::SetSingleMethod(&Self::PinnedSingleMethod, this);
+}
+
+
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+NUMAMultiThreader::PinnedSingleMethod(void * arg)
+{
+  WorkUnitInfo * workUnitInfo = static_cast<WorkUnitInfo *>(arg);
+  const Self *   self = static_cast<const Self *>(workUnitInfo->UserData);
+  // Work unit 0 runs on the thread of the caller.
+  const ScopedAffinity affinity(self->m_NodeCPUs.size() > 1);
+  self->PinWorkUnit(workUnitInfo->WorkUnitID, workUnitInfo->NumberOfWorkUnits);
+  workUnitInfo->UserData = self->m_PinnedData;
+  return self->m_PinnedMethod(workUnitInfo);
+}
+
+
+void
+NUMAMultiThreader::PinWorkUnit(ThreadIdType workUnit, ThreadIdType numberOfWorkUnits) const
+{
+  if (m_NodeCPUs.size() < 2)
+  {
+    return;
+  }
+#if defined(__linux__)
+  const std::vector<unsigned int> & cpus = m_NodeCPUs[this->GetWorkUnitNode(workUnit, numberOfWorkUnits)];
+  cpu_set_t                         cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (const unsigned int cpu : cpus)
+  {
+    if (cpu < CPU_SETSIZE)
+    {
+      CPU_SET(cpu, &cpuSet);
+    }
+  }
+  // Pinning is only a hint for the placement of the pages, so a failure,
+  // e.g. with CPUs outside of the cpuset of the process, is ignored.
+  sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+#else
+  (void)workUnit;
+  (void)numberOfWorkUnits;
+#endif
+}
+
+
+void
+NUMAMultiThreader::RegisterAsDefault()
+{
+  static std::once_flag registered;
+  std::call_once(registered, []() { ObjectFactoryBase::RegisterFactory(NUMAMultiThreaderFactory::New()); });
+}
+
+
+void
+NUMAMultiThreader::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfNodes: " << this->GetNumberOfNodes() << std::endl;
+}
+
+} // end namespace itk
@@ -17,6 +17,7 @@
  *=========================================================================*/
 #include "itkTextProgressBarCommand.h"
 
+#include "itkNumericTraits.h"
 #include "itkProcessObject.h"
 
 #include <iostream>
@@ -26,6 +27,7 @@ namespace itk
 
 TextProgressBarCommand ::TextProgressBarCommand()
   : m_Progress("[>                                                  ]")
+  , m_Position(NumericTraits<unsigned int>::max())
 {}
 
 
@@ -52,6 +54,11 @@ TextProgressBarCommand ::Execute(const itk::Object * object, const itk::EventObj
   double progress = process->GetProgress();
 
   const unsigned int position = static_cast<unsigned int>(progress * 50);
+  if (position == m_Position)
+  {
+    return;
+  }
+  m_Position = position;
 
   unsigned int i;
   for (i = 0; i < position; i++)
@@ -0,0 +1,187 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkUltrasoundTrace.h"
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+
+namespace
+{
+struct ThreadEvents
+{
+  unsigned int                            ThreadId;
+  std::vector<UltrasoundTrace::EventType> Events;
+};
+
+struct TraceState
+{
+  std::atomic<bool>                            Enabled{ false };
+  std::mutex                                   Mutex;
+  std::vector<std::unique_ptr<ThreadEvents>>   Threads;
+  UltrasoundTrace::CallbackType                Callback;
+  const UltrasoundTrace::ClockType::time_point Epoch{ UltrasoundTrace::ClockType::now() };
+};
+
+TraceState &
+GetTraceState()
+{
+  static TraceState state;
+  return state;
+}
+
+// The events of a thread are appended without locking.  The buffers are
+// registered once per thread and never freed, so that the thread ids stay
+// sequential and stable.
+ThreadEvents &
+GetThreadEvents()
+{
+  thread_local ThreadEvents * threadEvents = nullptr;
+  if (threadEvents == nullptr)
+  {
+    TraceState &                state = GetTraceState();
+    std::lock_guard<std::mutex> lock(state.Mutex);
+    state.Threads.emplace_back(new ThreadEvents{ static_cast<unsigned int>(state.Threads.size()), {} });
+    threadEvents = state.Threads.back().get();
+  }
+  return *threadEvents;
+}
+
+// Escape a trace point name for JSON.
+std::string
+EscapeName(const char * name)
+{
+  std::string escaped;
+  for (const char * character = name; *character != '\0'; ++character)
+  {
+    if (*character == '"' || *character == '\\')
+    {
+      escaped += '\\';
+    }
+    escaped += *character;
+  }
+  return escaped;
+}
+} // namespace
+
+
+void
+UltrasoundTrace::SetEnabled(bool enabled)
+{
+  GetTraceState().Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+bool
+UltrasoundTrace::GetEnabled()
+{
+  return GetTraceState().Enabled.load(std::memory_order_relaxed);
+}
+
+
+void
+UltrasoundTrace::SetCallback(const CallbackType & callback)
+{
+  TraceState &                state = GetTraceState();
+  std::lock_guard<std::mutex> lock(state.Mutex);
+  state.Callback = callback;
+}
+
+
+size_t
+UltrasoundTrace::GetNumberOfEvents()
+{
+  TraceState &                state = GetTraceState();
+  std::lock_guard<std::mutex> lock(state.Mutex);
+  size_t                      numberOfEvents = 0;
+  for (const auto & threadEvents : state.Threads)
+  {
+    numberOfEvents += threadEvents->Events.size();
+  }
+  return numberOfEvents;
+}
+
+
+bool
+UltrasoundTrace::WriteChromeTrace(const std::string & fileName)
+{
+  std::ofstream trace(fileName.c_str());
+  if (!trace)
+  {
+    return false;
+  }
+
+  TraceState &                state = GetTraceState();
+  std::lock_guard<std::mutex> lock(state.Mutex);
+  trace << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  for (const auto & threadEvents : state.Threads)
+  {
+    for (const EventType & event : threadEvents->Events)
+    {
+      trace << (first ? "\n" : ",\n") << "{\"name\": \"" << EscapeName(event.Name)
+            << "\", \"cat\": \"Ultrasound\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.ThreadId
+            << ", \"ts\": " << event.Start << ", \"dur\": " << event.Duration << "}";
+      first = false;
+    }
+  }
+  trace << "\n]}\n";
+  return static_cast<bool>(trace);
+}
+
+
+void
+UltrasoundTrace::Clear()
+{
+  TraceState &                state = GetTraceState();
+  std::lock_guard<std::mutex> lock(state.Mutex);
+  for (const auto & threadEvents : state.Threads)
+  {
+    threadEvents->Events.clear();
+  }
+}
+
+
+void
+UltrasoundTrace::Record(const char * name, ClockType::time_point start, ClockType::time_point stop)
+{
+  TraceState &   state = GetTraceState();
+  ThreadEvents & threadEvents = GetThreadEvents();
+
+  EventType event;
+  event.Name = name;
+  event.ThreadId = threadEvents.ThreadId;
+  event.Start = std::chrono::duration_cast<std::chrono::microseconds>(start - state.Epoch).count();
+  event.Duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+  if (state.Callback)
+  {
+    state.Callback(event);
+  }
+  else
+  {
+    threadEvents.Events.push_back(event);
+  }
+}
+
+} // end namespace itk
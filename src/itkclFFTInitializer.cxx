@@ -16,6 +16,12 @@
  *
  *=========================================================================*/
 #include "itkclFFTInitializer.h"
+#include "itkMacro.h"
+#include "itkUltrasoundTrace.h"
+
+#include "itksys/SystemTools.hxx"
+
+#include <tuple>
 
 namespace itk
 {
@@ -23,6 +29,110 @@ clFFTInitializer::clFFTInitializer()
 {
   clfftInitSetupData(&this->m_clFFTdefaults);
   clfftSetup(&this->m_clFFTdefaults);
+
+  m_Context = cl::Context(CL_DEVICE_TYPE_ALL);
+  std::vector<cl::Device> devices = m_Context.getInfo<CL_CONTEXT_DEVICES>();
+  if (devices.size() < 1)
+  {
+    itkGenericExceptionMacro("No OpenCL devices found.");
+  }
+  // @todo: code to select the fastest device, or the device that is
+  // CL_DEVICE_TYPE_ACCELERATOR
+  for (unsigned int queue = 0; queue < NumberOfQueues; ++queue)
+  {
+    m_Queues.emplace_back(m_Context, devices[0]);
+  }
+}
+
+clFFTInitializer::~clFFTInitializer()
+{
+  this->ClearPlans();
+  clfftTeardown();
+}
+
+bool
+clFFTInitializer::PlanKeyType::operator<(const PlanKeyType & other) const
+{
+  return std::tie(Queue, Length, BatchSize, Precision, Direction, Layout) <
+         std::tie(other.Queue, other.Length, other.BatchSize, other.Precision, other.Direction, other.Layout);
+}
+
+clfftPlanHandle
+clFFTInitializer::GetPlan(unsigned int   queue,
+                          size_t         length,
+                          size_t         batchSize,
+                          clfftPrecision precision,
+                          clfftDirection direction,
+                          clfftLayout    layout)
+{
+  const PlanKeyType           key{ queue, length, batchSize, precision, direction, layout };
+  std::lock_guard<std::mutex> lock(m_PlansMutex);
+  const auto                  it = m_Plans.find(key);
+  if (it != m_Plans.end())
+  {
+    return it->second;
+  }
+  itkUltrasoundTraceScopeMacro("clFFTPlan");
+
+  clfftPlanHandle plan = 0;
+  const size_t    n[3] = { length, 1, 1 };
+  clfftStatus     error_code = clfftCreateDefaultPlan(&plan, m_Context(), CLFFT_1D, n);
+  if (!plan || error_code)
+  {
+    itkGenericExceptionMacro("Could not create OpenCL FFT Plan.");
+  }
+  clfftSetResultLocation(plan, CLFFT_INPLACE);
+  clfftSetLayout(plan, layout, layout);
+  clfftSetPlanBatchSize(plan, batchSize);
+  clfftSetPlanPrecision(plan, precision);
+  cl_command_queue clQueue = m_Queues[queue]();
+  error_code = clfftBakePlan(plan, 1, &clQueue, nullptr, nullptr);
+  if (error_code)
+  {
+    clfftDestroyPlan(&plan);
+    itkGenericExceptionMacro("Could not bake OpenCL FFT Plan (" << error_code << ")");
+  }
+
+  m_Plans[key] = plan;
+  return plan;
+}
+
+void
+clFFTInitializer::BakePlan(size_t         length,
+                           size_t         batchSize,
+                           clfftPrecision precision,
+                           clfftDirection direction,
+                           clfftLayout    layout)
+{
+  for (unsigned int queue = 0; queue < NumberOfQueues; ++queue)
+  {
+    this->GetPlan(queue, length, batchSize, precision, direction, layout);
+  }
+}
+
+size_t
+clFFTInitializer::GetNumberOfPlans()
+{
+  std::lock_guard<std::mutex> lock(m_PlansMutex);
+  return m_Plans.size();
+}
+
+void
+clFFTInitializer::ClearPlans()
+{
+  std::lock_guard<std::mutex> lock(m_PlansMutex);
+  for (auto & plan : m_Plans)
+  {
+    clfftDestroyPlan(&plan.second);
+  }
+  m_Plans.clear();
+}
+
+void
+clFFTInitializer::SetKernelCacheDirectory(const std::string & directory)
+{
+  // clFFT reads the location of its binary kernel cache from the environment.
+  itksys::SystemTools::PutEnv("CLFFT_CACHE_PATH=" + directory);
 }
 
 clFFTInitializer &
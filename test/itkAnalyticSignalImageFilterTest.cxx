@@ -26,6 +26,9 @@
 #include "itkImageFileWriter.h"
 
 #include "itkAnalyticSignalImageFilter.h"
+#ifdef ITKUltrasound_USE_clFFT
+#  include "itkOpenCLAnalyticSignalImageFilter.h"
+#endif
 
 int
 itkAnalyticSignalImageFilterTest(int argc, char * argv[])
@@ -33,7 +36,7 @@ itkAnalyticSignalImageFilterTest(int argc, char * argv[])
   if (argc < 3)
   {
     std::cerr << "Usage: " << argv[0];
-    std::cerr << " inputImage outputImagePrefix";
+    std::cerr << " inputImage outputImagePrefix [inPlace] [openCL]";
     std::cerr << std::endl;
     return EXIT_FAILURE;
   }
@@ -54,6 +57,12 @@ itkAnalyticSignalImageFilterTest(int argc, char * argv[])
   ReaderType::Pointer          reader = ReaderType::New();
   PadType::Pointer             pad = PadType::New();
   AnalyticType::Pointer        analytic = AnalyticType::New();
+#ifdef ITKUltrasound_USE_clFFT
+  if (argc > 4 && std::stoi(argv[4]) != 0)
+  {
+    analytic = itk::OpenCLAnalyticSignalImageFilter<ImageType, ComplexImageType>::New();
+  }
+#endif
   RealFilterType::Pointer      realFilter = RealFilterType::New();
   ImaginaryFilterType::Pointer imaginaryFilter = ImaginaryFilterType::New();
   WriterType::Pointer          writer = WriterType::New();
@@ -67,6 +76,10 @@ itkAnalyticSignalImageFilterTest(int argc, char * argv[])
   pad->SetConstant(0.);
   analytic->SetInput(pad->GetOutput());
   analytic->SetDirection(1);
+  if (argc > 3)
+  {
+    analytic->SetInPlace(std::stoi(argv[3]) != 0);
+  }
   realFilter->SetInput(analytic->GetOutput());
   imaginaryFilter->SetInput(analytic->GetOutput());
 
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Throughput of the B-Mode filter and of the time gain compensation.
+
+#include <iostream>
+#include <string>
+
+#include "itkImage.h"
+
+#include "itkBModeImageFilter.h"
+#include "itkTimeGainCompensationImageFilter.h"
+#include "itkUltrasoundBenchmark.h"
+
+namespace
+{
+
+template <unsigned int VDimension>
+void
+benchmarkBMode(itk::UltrasoundBenchmark::Harness &                      harness,
+               const typename itk::Image<float, VDimension>::SizeType & size,
+               unsigned int                                             repetitions)
+{
+  using ImageType = itk::Image<float, VDimension>;
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  using TGCFilterType = typename BModeFilterType::TimeGainCompensationFilterType;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+
+  typename ImageType::Pointer rf = HarnessType::template MakeRF<ImageType>(size);
+  const std::string           geometry = HarnessType::GetGeometry(size);
+  double                      samples = 1.0;
+  for (unsigned int dimension = 0; dimension < VDimension; ++dimension)
+  {
+    samples *= size[dimension];
+  }
+
+  typename TGCFilterType::GainType gain(2, 2);
+  gain(0, 0) = 0.0;
+  gain(0, 1) = 1.0;
+  gain(1, 0) = static_cast<double>(size[0]);
+  gain(1, 1) = 10.0;
+
+  for (const unsigned int threads : HarnessType::GetThreadCounts())
+  {
+    for (unsigned int fused = 0; fused < 2; ++fused)
+    {
+      typename BModeFilterType::Pointer bMode = BModeFilterType::New();
+      bMode->SetInput(rf);
+      bMode->SetFused(fused);
+      HarnessType::SetThreads(bMode, threads);
+      harness.Run(fused ? "BMode fused" : "BMode", geometry, threads, samples, repetitions, [&bMode]() {
+        bMode->Modified();
+        bMode->Update();
+      });
+
+      typename TGCFilterType::Pointer tgcFilter = TGCFilterType::New();
+      tgcFilter->SetGain(gain);
+      bMode->SetTimeGainCompensationFilter(tgcFilter);
+      harness.Run(
+        fused ? "BMode fused with TGC" : "BMode with TGC", geometry, threads, samples, repetitions, [&bMode]() {
+          bMode->Modified();
+          bMode->Update();
+        });
+    }
+
+    typename TGCFilterType::Pointer tgcFilter = TGCFilterType::New();
+    tgcFilter->SetInput(rf);
+    tgcFilter->SetGain(gain);
+    HarnessType::SetThreads(tgcFilter, threads);
+    harness.Run("TimeGainCompensation", geometry, threads, samples, repetitions, [&tgcFilter]() {
+      tgcFilter->Modified();
+      tgcFilter->Update();
+    });
+  }
+}
+
+} // namespace
+
+int
+itkBModeBenchmark(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " outputJSON [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const unsigned int repetitions = (argc > 2) ? std::stoi(argv[2]) : 10;
+
+  itk::UltrasoundBenchmark::Harness harness("BMode");
+
+  try
+  {
+    // A 2D linear array frame and a 3D volume of frames.
+    itk::Image<float, 2>::SizeType frameSize;
+    frameSize[0] = 2048;
+    frameSize[1] = 256;
+    benchmarkBMode<2>(harness, frameSize, repetitions);
+
+    itk::Image<float, 3>::SizeType volumeSize;
+    volumeSize[0] = 1024;
+    volumeSize[1] = 128;
+    volumeSize[2] = 64;
+    benchmarkBMode<3>(harness, volumeSize, repetitions);
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!harness.WriteJSON(argv[1]))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
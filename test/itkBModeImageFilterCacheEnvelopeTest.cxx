@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+#include "itkBModeImageFilter.h"
+
+namespace
+{
+
+using ImageType = itk::Image<double, 2>;
+
+void
+fillFrame(ImageType * image, unsigned int frame)
+{
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               sample = static_cast<double>(index[0] + (frame + 1) * index[1]);
+    it.Set(500.0 * std::sin(2.0 * itk::Math::pi * 0.15 * sample) + 20.0 * ((index[0] * 7 + index[1] * 3) % 11));
+  }
+  image->Modified();
+}
+
+bool
+sameImages(const ImageType * reference, const ImageType * image)
+{
+  if (reference->GetBufferedRegion() != image->GetBufferedRegion())
+  {
+    std::cerr << "Regions differ: " << reference->GetBufferedRegion() << image->GetBufferedRegion() << std::endl;
+    return false;
+  }
+  itk::ImageRegionConstIterator<ImageType>          referenceIt(reference, reference->GetBufferedRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (referenceIt.GoToBegin(), it.GoToBegin(); !it.IsAtEnd(); ++referenceIt, ++it)
+  {
+    if (itk::Math::NotAlmostEquals(referenceIt.Get(), it.Get()))
+    {
+      std::cerr << "Mismatch at " << it.GetIndex() << ": " << referenceIt.Get() << " vs. " << it.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkBModeImageFilterCacheEnvelopeTest(int, char *[])
+{
+  // 90 samples are padded, so that the envelope is cropped.
+  ImageType::SizeType size;
+  size[0] = 90;
+  size[1] = 40;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  fillFrame(image, 0);
+
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  using TGCFilterType = BModeFilterType::TimeGainCompensationFilterType;
+
+  BModeFilterType::Pointer reference = BModeFilterType::New();
+  reference->SetInput(image);
+  TGCFilterType::Pointer referenceTGC = TGCFilterType::New();
+  reference->SetTimeGainCompensationFilter(referenceTGC);
+
+  BModeFilterType::Pointer bMode = BModeFilterType::New();
+  ITK_TEST_SET_GET_BOOLEAN(bMode, CacheEnvelope, false);
+  bMode->CacheEnvelopeOn();
+  bMode->SetInput(image);
+  TGCFilterType::Pointer tgc = TGCFilterType::New();
+  bMode->SetTimeGainCompensationFilter(tgc);
+  ITK_TEST_EXPECT_TRUE(bMode->GetEnvelope() == nullptr);
+
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_TRUE(sameImages(reference->GetOutput(), bMode->GetOutput()));
+  const ImageType * envelope = bMode->GetEnvelope();
+  ITK_TEST_EXPECT_TRUE(envelope != nullptr);
+  ITK_TEST_EXPECT_EQUAL(envelope->GetBufferedRegion(), bMode->GetOutput()->GetBufferedRegion());
+  ITK_TEST_EXPECT_TRUE(!tgc->GetInPlace());
+
+  // A new gain updates the output from the cached envelope.
+  TGCFilterType::SampleGainType sampleGain(size[0]);
+  for (unsigned int ii = 0; ii < size[0]; ++ii)
+  {
+    sampleGain[ii] = 1.0 + 0.05 * ii;
+  }
+  referenceTGC->SetSampleGain(sampleGain);
+  tgc->SetSampleGain(sampleGain);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_TRUE(sameImages(reference->GetOutput(), bMode->GetOutput()));
+  ITK_TEST_EXPECT_EQUAL(bMode->GetEnvelope(), envelope);
+
+  // So does a gain in decibels, twice.
+  referenceTGC->DecibelGainOn();
+  tgc->DecibelGainOn();
+  for (unsigned int update = 0; update < 2; ++update)
+  {
+    ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+    ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+    ITK_TEST_EXPECT_TRUE(sameImages(reference->GetOutput(), bMode->GetOutput()));
+    ITK_TEST_EXPECT_EQUAL(bMode->GetEnvelope(), envelope);
+  }
+
+  // A new frame computes the envelope again.
+  fillFrame(image, 1);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_TRUE(sameImages(reference->GetOutput(), bMode->GetOutput()));
+  ITK_TEST_EXPECT_TRUE(bMode->GetEnvelope() != envelope);
+  envelope = bMode->GetEnvelope();
+
+  // So does a modification of the filter; the fused path is not used while
+  // the envelope is cached.
+  bMode->FusedOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_TRUE(sameImages(reference->GetOutput(), bMode->GetOutput()));
+  ITK_TEST_EXPECT_TRUE(bMode->GetEnvelope() != envelope);
+  ITK_TEST_EXPECT_TRUE(bMode->GetEnvelope() != nullptr);
+
+  // Without the cache, there is no envelope.
+  bMode->CacheEnvelopeOff();
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_TRUE(bMode->GetEnvelope() == nullptr);
+
+  bMode->Print(std::cout);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+#include "itkBModeImageFilter.h"
+#include "itkButterworthBandpass1DFilterFunction.h"
+
+namespace
+{
+
+template <typename TImage>
+bool
+imagesAgree(const TImage * expected, const TImage * actual, double tolerance, const char * description)
+{
+  if (expected->GetLargestPossibleRegion() != actual->GetLargestPossibleRegion())
+  {
+    std::cerr << description << ": unexpected output region " << actual->GetLargestPossibleRegion() << std::endl;
+    return false;
+  }
+  itk::ImageRegionConstIteratorWithIndex<TImage> expectedIt(expected, expected->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<TImage> actualIt(actual, actual->GetLargestPossibleRegion());
+  for (expectedIt.GoToBegin(), actualIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt, ++actualIt)
+  {
+    if (std::abs(expectedIt.Get() - actualIt.Get()) > tolerance)
+    {
+      std::cerr << description << ": mismatch at " << expectedIt.GetIndex() << ": " << expectedIt.Get() << " vs. "
+                << actualIt.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkBModeImageFilterFusedTest(int, char *[])
+{
+  using PixelType = double;
+  const unsigned int Dimension = 2;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  // 90 samples are padded differently by every padding policy.
+  ImageType::SizeType size;
+  size[0] = 90;
+  size[1] = 90;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               sample = static_cast<double>(index[0] + index[1]);
+    it.Set(500.0 * std::sin(2.0 * itk::Math::pi * 0.15 * sample) + 20.0 * ((index[0] * 7 + index[1] * 3) % 11));
+  }
+
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  using FrequencyFilterType = BModeFilterType::FrequencyFilterType;
+  using FilterFunctionType = itk::ButterworthBandpass1DFilterFunction;
+
+  for (unsigned int direction = 0; direction < Dimension; ++direction)
+  {
+    for (int policy = BModeFilterType::PAD_TO_POWER_OF_TWO; policy <= BModeFilterType::PAD_IF_UNSUPPORTED; ++policy)
+    {
+      for (unsigned int filtered = 0; filtered < 2; ++filtered)
+      {
+        BModeFilterType::Pointer pipeline = BModeFilterType::New();
+        BModeFilterType::Pointer fused = BModeFilterType::New();
+        fused->FusedOn();
+        for (BModeFilterType * bMode : { pipeline.GetPointer(), fused.GetPointer() })
+        {
+          bMode->SetInput(image);
+          bMode->SetDirection(direction);
+          bMode->SetPaddingPolicy(static_cast<BModeFilterType::PaddingPolicyType>(policy));
+          if (filtered)
+          {
+            FilterFunctionType::Pointer filterFunction = FilterFunctionType::New();
+            filterFunction->SetLowerFrequency(0.1);
+            filterFunction->SetUpperFrequency(0.5);
+            FrequencyFilterType::Pointer frequencyFilter = FrequencyFilterType::New();
+            frequencyFilter->SetFilterFunction(filterFunction);
+            bMode->SetFrequencyFilter(frequencyFilter);
+          }
+        }
+
+        // The padded lengths only agree when both paths use the same FFT
+        // backend limits.
+        if (pipeline->GetPaddedSize(size[direction]) != fused->GetPaddedSize(size[direction]))
+        {
+          continue;
+        }
+
+        try
+        {
+          pipeline->Update();
+          fused->Update();
+        }
+        catch (itk::ExceptionObject & excep)
+        {
+          std::cerr << "Exception caught !" << std::endl;
+          std::cerr << excep << std::endl;
+          return EXIT_FAILURE;
+        }
+
+        std::ostringstream description;
+        description << "direction " << direction << ", padding policy " << policy << ", filtered " << filtered;
+        if (!imagesAgree(pipeline->GetOutput(), fused->GetOutput(), 1e-6, description.str().c_str()))
+        {
+          return EXIT_FAILURE;
+        }
+        if (direction == 0 && policy == 0 && filtered == 0)
+        {
+          fused->Print(std::cout);
+        }
+      }
+    }
+  }
+
+#if defined(ITK_USE_FFTWD) && !defined(ITK_USE_CUFFTW)
+  // Both paths plan with the same rigor, by default the one of the FFTW
+  // filters, and give the same images with measured plans.
+  {
+    BModeFilterType::Pointer pipeline = BModeFilterType::New();
+    BModeFilterType::Pointer fused = BModeFilterType::New();
+    fused->FusedOn();
+    ITK_TEST_EXPECT_EQUAL(pipeline->GetPlanRigor(), itk::FFTWGlobalConfiguration::GetPlanRigor());
+    ITK_TEST_EXPECT_EQUAL(fused->GetPlanRigor(), pipeline->GetPlanRigor());
+    for (BModeFilterType * bMode : { pipeline.GetPointer(), fused.GetPointer() })
+    {
+      bMode->SetInput(image);
+      bMode->SetPlanRigor(FFTW_MEASURE);
+      ITK_TEST_SET_GET_VALUE(static_cast<int>(FFTW_MEASURE), bMode->GetPlanRigor());
+      ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+    }
+    if (!imagesAgree(pipeline->GetOutput(), fused->GetOutput(), 1e-6, "FFTW_MEASURE"))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+#endif
+
+  // A time gain compensation multiplies the envelope before the log
+  // compression, in both paths.
+  using TGCFilterType = BModeFilterType::TimeGainCompensationFilterType;
+  TGCFilterType::Pointer  tgcFilter = TGCFilterType::New();
+  TGCFilterType::GainType  gain(2, 2);
+  gain(0, 0) = 10.0;
+  gain(0, 1) = 0.0;
+  gain(1, 0) = 80.0;
+  gain(1, 1) = 12.0;
+  tgcFilter->SetGain(gain);
+  tgcFilter->DecibelGainOn();
+  std::vector<double> lineGain;
+  tgcFilter->ComputeLineGain(image, lineGain);
+
+  BModeFilterType::Pointer reference = BModeFilterType::New();
+  reference->SetInput(image);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+  ImageType::Pointer expected = ImageType::New();
+  expected->SetRegions(image->GetLargestPossibleRegion());
+  expected->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> expectedIt(expected, expected->GetLargestPossibleRegion());
+  for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+  {
+    const ImageType::IndexType index = expectedIt.GetIndex();
+    const double               envelope = std::pow(10.0, reference->GetOutput()->GetPixel(index)) - 1.0;
+    expectedIt.Set(std::log10(envelope * lineGain[index[0]] + 1.0));
+  }
+
+  for (unsigned int fusedPath = 0; fusedPath < 2; ++fusedPath)
+  {
+    BModeFilterType::Pointer bMode = BModeFilterType::New();
+    bMode->SetInput(image);
+    bMode->SetFused(fusedPath);
+    bMode->SetTimeGainCompensationFilter(tgcFilter);
+    ITK_TEST_SET_GET_VALUE(tgcFilter.GetPointer(), bMode->GetTimeGainCompensationFilter());
+    ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+    if (!imagesAgree(expected.GetPointer(), bMode->GetOutput(), 1e-6, fusedPath ? "fused TGC" : "pipeline TGC"))
+    {
+      return EXIT_FAILURE;
+    }
+
+    // The gain is along the zeroth direction.
+    bMode->SetDirection(1);
+    ITK_TRY_EXPECT_EXCEPTION(bMode->Update());
+  }
+
+  // float RF stays in float through the analytic signal, the modulus and the
+  // log compression.
+  using FloatImageType = itk::Image<float, Dimension>;
+  using FloatBModeFilterType = itk::BModeImageFilter<FloatImageType>;
+  static_assert(std::is_same<FloatBModeFilterType::ComplexImageType::PixelType, std::complex<float>>::value,
+                "The default complex image of a float B-Mode filter should be complex<float>.");
+  static_assert(std::is_same<itk::AnalyticSignalImageFilter<FloatImageType>::OutputImageType::PixelType,
+                             std::complex<float>>::value,
+                "The default output of a float analytic signal filter should be complex<float>.");
+
+  FloatImageType::Pointer floatImage = FloatImageType::New();
+  floatImage->SetRegions(image->GetLargestPossibleRegion());
+  floatImage->Allocate();
+  itk::ImageRegionIteratorWithIndex<FloatImageType> floatIt(floatImage, floatImage->GetLargestPossibleRegion());
+  for (floatIt.GoToBegin(); !floatIt.IsAtEnd(); ++floatIt)
+  {
+    floatIt.Set(static_cast<float>(image->GetPixel(floatIt.GetIndex())));
+  }
+
+  using FloatTGCFilterType = FloatBModeFilterType::TimeGainCompensationFilterType;
+  FloatTGCFilterType::Pointer floatTGCFilter = FloatTGCFilterType::New();
+  floatTGCFilter->SetGain(gain);
+  floatTGCFilter->DecibelGainOn();
+
+  FloatBModeFilterType::Pointer floatPipeline = FloatBModeFilterType::New();
+  FloatBModeFilterType::Pointer floatFused = FloatBModeFilterType::New();
+  floatFused->FusedOn();
+  for (FloatBModeFilterType * bMode : { floatPipeline.GetPointer(), floatFused.GetPointer() })
+  {
+    bMode->SetInput(floatImage);
+    bMode->SetTimeGainCompensationFilter(floatTGCFilter);
+    ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  }
+  if (!imagesAgree(floatPipeline->GetOutput(), floatFused->GetOutput(), 1e-4, "float"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+
+#include "itkBModeImageFilter.h"
+
+namespace
+{
+
+template <typename TFilter>
+bool
+checkPaddedSize(const TFilter * filter, itk::SizeValueType size, itk::SizeValueType expected)
+{
+  const itk::SizeValueType padded = filter->GetPaddedSize(size);
+  if (padded != expected)
+  {
+    std::cerr << "Padded size for " << size << " is " << padded << ", expected " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkBModeImageFilterPaddingTest(int, char *[])
+{
+  using PixelType = double;
+  const unsigned int Dimension = 2;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  // 90 samples = 2 * 3^2 * 5, which is not a power of two.
+  ImageType::SizeType size;
+  size[0] = 90;
+  size[1] = 8;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const double sample = static_cast<double>(it.GetIndex()[0]);
+    const double envelope = std::exp(-0.005 * (sample - 45.0) * (sample - 45.0));
+    it.Set(1000.0 * envelope * std::sin(2.0 * itk::Math::pi * 0.2 * sample));
+  }
+
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  BModeFilterType::Pointer bMode = BModeFilterType::New();
+  bMode->SetInput(image);
+  bMode->SetDirection(0);
+
+  if (bMode->GetPaddingPolicy() != BModeFilterType::PAD_TO_POWER_OF_TWO)
+  {
+    std::cerr << "The default padding policy should be PAD_TO_POWER_OF_TWO" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (!checkPaddedSize(bMode.GetPointer(), 90, 128) || !checkPaddedSize(bMode.GetPointer(), 2080, 4096) ||
+      !checkPaddedSize(bMode.GetPointer(), 64, 64))
+  {
+    return EXIT_FAILURE;
+  }
+
+  bMode->SetPaddingPolicy(BModeFilterType::PAD_TO_FIVE_SMOOTH);
+  if (!checkPaddedSize(bMode.GetPointer(), 90, 90) || !checkPaddedSize(bMode.GetPointer(), 2080, 2160) ||
+      !checkPaddedSize(bMode.GetPointer(), 97, 100))
+  {
+    return EXIT_FAILURE;
+  }
+
+  bMode->SetPaddingPolicy(BModeFilterType::PAD_IF_UNSUPPORTED);
+  const itk::SizeValueType greatestPrimeFactor = bMode->GetSizeGreatestPrimeFactor();
+  std::cout << "FFT backend greatest prime factor: " << greatestPrimeFactor << std::endl;
+  if (greatestPrimeFactor < 5)
+  {
+    std::cerr << "Every FFT backend supports the prime factors 2, 3 and 5" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (!checkPaddedSize(bMode.GetPointer(), 90, 90))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Every policy reproduces the input extent, and the unpadded envelope
+  // agrees with the padded one away from the end of the lines.
+  ImageType::Pointer paddedOutput;
+  for (int policy = BModeFilterType::PAD_TO_POWER_OF_TWO; policy <= BModeFilterType::PAD_IF_UNSUPPORTED; ++policy)
+  {
+    bMode->SetPaddingPolicy(static_cast<BModeFilterType::PaddingPolicyType>(policy));
+    try
+    {
+      bMode->Update();
+    }
+    catch (itk::ExceptionObject & excep)
+    {
+      std::cerr << "Exception caught !" << std::endl;
+      std::cerr << excep << std::endl;
+      return EXIT_FAILURE;
+    }
+    ImageType::Pointer output = bMode->GetOutput();
+    if (output->GetLargestPossibleRegion() != image->GetLargestPossibleRegion())
+    {
+      std::cerr << "Unexpected output region for padding policy " << policy << ": "
+                << output->GetLargestPossibleRegion() << std::endl;
+      return EXIT_FAILURE;
+    }
+    output->DisconnectPipeline();
+    if (paddedOutput.IsNull())
+    {
+      paddedOutput = output;
+      continue;
+    }
+
+    itk::ImageRegionIteratorWithIndex<ImageType> paddedIt(paddedOutput, paddedOutput->GetLargestPossibleRegion());
+    itk::ImageRegionIteratorWithIndex<ImageType> outputIt(output, output->GetLargestPossibleRegion());
+    for (paddedIt.GoToBegin(), outputIt.GoToBegin(); !paddedIt.IsAtEnd(); ++paddedIt, ++outputIt)
+    {
+      const ImageType::IndexType index = paddedIt.GetIndex();
+      if (index[0] < 30 || index[0] > 60)
+      {
+        continue;
+      }
+      if (std::abs(paddedIt.Get() - outputIt.Get()) > 0.05)
+      {
+        std::cerr << "B-mode mismatch for padding policy " << policy << " at " << index << ": " << paddedIt.Get()
+                  << " vs. " << outputIt.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // The estimated footprint of the 90 x 8 double image: the output, the
+  // padded input, the cropped envelope, the three complex images of the
+  // analytic signal, the envelope and the envelope plus one.
+  const itk::SizeValueType pixels = 90 * 8;
+  const itk::SizeValueType realBytes = sizeof(double);
+  const itk::SizeValueType complexBytes = sizeof(std::complex<double>);
+  bMode->SetPaddingPolicy(BModeFilterType::PAD_TO_POWER_OF_TWO);
+  const itk::SizeValueType paddedPixels = 128 * 8;
+  itk::SizeValueType       expectedFootprint = 3 * pixels * realBytes;
+  expectedFootprint += 2 * paddedPixels * realBytes + 3 * paddedPixels * complexBytes;
+  if (bMode->EstimateMemoryFootprint() != expectedFootprint)
+  {
+    std::cerr << "Estimated footprint " << bMode->EstimateMemoryFootprint() << ", expected " << expectedFootprint
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Without padding, and for half of the lines; the region is enlarged along
+  // the direction of propagation.
+  bMode->SetPaddingPolicy(BModeFilterType::PAD_TO_FIVE_SMOOTH);
+  ImageType::RegionType halfRegion = image->GetLargestPossibleRegion();
+  halfRegion.SetSize(0, 45);
+  halfRegion.SetSize(1, 4);
+  expectedFootprint = (pixels / 2) * (3 * realBytes + 3 * complexBytes);
+  if (bMode->EstimateMemoryFootprint(halfRegion) != expectedFootprint)
+  {
+    std::cerr << "Estimated footprint of half of the lines " << bMode->EstimateMemoryFootprint(halfRegion)
+              << ", expected " << expectedFootprint << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bMode->Print(std::cout);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+#include "itkBModeImageFilter.h"
+
+namespace
+{
+
+using ImageType = itk::Image<double, 2>;
+
+void
+fillFrame(ImageType * image, unsigned int frame)
+{
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               sample = static_cast<double>(index[0] + (frame + 1) * index[1]);
+    it.Set(500.0 * std::sin(2.0 * itk::Math::pi * 0.15 * sample) + 20.0 * ((index[0] * 7 + index[1] * 3) % 11));
+  }
+  image->Modified();
+}
+
+} // namespace
+
+int
+itkBModeImageFilterReuseAllocationsTest(int, char *[])
+{
+  // 90 samples are padded, so that the envelope is cropped.
+  ImageType::SizeType size;
+  size[0] = 90;
+  size[1] = 40;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  using TGCFilterType = BModeFilterType::TimeGainCompensationFilterType;
+
+  BModeFilterType::Pointer reference = BModeFilterType::New();
+  reference->SetInput(image);
+  TGCFilterType::Pointer referenceTGC = TGCFilterType::New();
+  reference->SetTimeGainCompensationFilter(referenceTGC);
+
+  BModeFilterType::Pointer bMode = BModeFilterType::New();
+  ITK_TEST_EXPECT_TRUE(!bMode->GetReuseAllocations());
+  ITK_TEST_SET_GET_BOOLEAN(bMode, ReuseAllocations, true);
+  bMode->SetInput(image);
+  TGCFilterType::Pointer tgc = TGCFilterType::New();
+  bMode->SetTimeGainCompensationFilter(tgc);
+
+  // After the first frame, the frames of the same size are computed in the
+  // same buffers, and give the same images as without the reuse.
+  const ImageType::PixelType * outputBuffer = nullptr;
+  const ImageType::PixelType * envelopeBuffer = nullptr;
+  for (unsigned int frame = 0; frame < 3; ++frame)
+  {
+    fillFrame(image, frame);
+    ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+    ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+    ITK_TEST_EXPECT_TRUE(!tgc->GetInPlace());
+
+    if (frame > 0)
+    {
+      ITK_TEST_EXPECT_EQUAL(outputBuffer, bMode->GetOutput()->GetBufferPointer());
+      ITK_TEST_EXPECT_EQUAL(envelopeBuffer, tgc->GetOutput()->GetBufferPointer());
+    }
+    outputBuffer = bMode->GetOutput()->GetBufferPointer();
+    envelopeBuffer = tgc->GetOutput()->GetBufferPointer();
+
+    ITK_TEST_EXPECT_EQUAL(reference->GetOutput()->GetLargestPossibleRegion(),
+                          bMode->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<ImageType> referenceIt(reference->GetOutput(),
+                                                         reference->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionConstIteratorWithIndex<ImageType> it(bMode->GetOutput(),
+                                                         bMode->GetOutput()->GetLargestPossibleRegion());
+    for (referenceIt.GoToBegin(), it.GoToBegin(); !it.IsAtEnd(); ++referenceIt, ++it)
+    {
+      if (itk::Math::NotAlmostEquals(referenceIt.Get(), it.Get()))
+      {
+        std::cerr << "Frame " << frame << ": mismatch at " << it.GetIndex() << ": " << referenceIt.Get() << " vs. "
+                  << it.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // A filter prepared on the geometry computes its first frame in the buffers
+  // of the warmup, and gives the same image.
+  BModeFilterType::Pointer prepared = BModeFilterType::New();
+  prepared->ReuseAllocationsOn();
+  prepared->SetInput(image);
+  prepared->SetTimeGainCompensationFilter(TGCFilterType::New());
+  ITK_TRY_EXPECT_EXCEPTION(prepared->Prepare(nullptr));
+  ITK_TRY_EXPECT_NO_EXCEPTION(prepared->Prepare(image));
+  ITK_TEST_EXPECT_TRUE(prepared->GetInput() == image.GetPointer());
+  const ImageType::PixelType * preparedBuffer = prepared->GetOutput()->GetBufferPointer();
+  ITK_TRY_EXPECT_NO_EXCEPTION(prepared->Update());
+  ITK_TEST_EXPECT_EQUAL(preparedBuffer, prepared->GetOutput()->GetBufferPointer());
+  itk::ImageRegionConstIterator<ImageType> referenceIt(reference->GetOutput(),
+                                                       reference->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> preparedIt(prepared->GetOutput(),
+                                                               prepared->GetOutput()->GetLargestPossibleRegion());
+  for (referenceIt.GoToBegin(), preparedIt.GoToBegin(); !preparedIt.IsAtEnd(); ++referenceIt, ++preparedIt)
+  {
+    if (itk::Math::NotAlmostEquals(referenceIt.Get(), preparedIt.Get()))
+    {
+      std::cerr << "Prepared: mismatch at " << preparedIt.GetIndex() << ": " << referenceIt.Get() << " vs. "
+                << preparedIt.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A smaller frame fits in the buffers of the larger one.
+  size[1] = 20;
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  fillFrame(image, 0);
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_EQUAL(outputBuffer, bMode->GetOutput()->GetBufferPointer());
+  ITK_TEST_EXPECT_EQUAL(envelopeBuffer, tgc->GetOutput()->GetBufferPointer());
+  ITK_TEST_EXPECT_EQUAL(size, bMode->GetOutput()->GetLargestPossibleRegion().GetSize());
+
+  bMode->Print(std::cout);
+
+  return EXIT_SUCCESS;
+}
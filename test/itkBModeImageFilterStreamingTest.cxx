@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionSplitterDirection.h"
+#include "itkMath.h"
+#include "itkStreamingImageFilter.h"
+
+#include "itkBModeImageFilter.h"
+
+int
+itkBModeImageFilterStreamingTest(int, char *[])
+{
+  using PixelType = double;
+  const unsigned int Dimension = 3;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  ImageType::SizeType size;
+  size[0] = 100;
+  size[1] = 12;
+  size[2] = 8;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               phase = 2.0 * itk::Math::pi * (0.12 * index[0] + 0.05 * index[1] + 0.02 * index[2]);
+    it.Set(300.0 * std::sin(phase) + 10.0 * ((index[0] + 3 * index[1] + 5 * index[2]) % 7));
+  }
+
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  using StreamingFilterType = itk::StreamingImageFilter<ImageType, ImageType>;
+
+  for (unsigned int fused = 0; fused < 2; ++fused)
+  {
+    BModeFilterType::Pointer reference = BModeFilterType::New();
+    reference->SetInput(image);
+    reference->SetFused(fused != 0);
+
+    BModeFilterType::Pointer bMode = BModeFilterType::New();
+    bMode->SetInput(image);
+    bMode->SetFused(fused != 0);
+
+    // Stream in chunks that keep the lines along the direction of
+    // propagation whole.
+    itk::ImageRegionSplitterDirection::Pointer splitter = itk::ImageRegionSplitterDirection::New();
+    splitter->SetDirection(bMode->GetDirection());
+    StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+    streamer->SetInput(bMode->GetOutput());
+    streamer->SetRegionSplitter(splitter);
+    streamer->SetNumberOfStreamDivisions(4);
+
+    try
+    {
+      reference->Update();
+      streamer->Update();
+    }
+    catch (itk::ExceptionObject & excep)
+    {
+      std::cerr << "Exception caught !" << std::endl;
+      std::cerr << excep << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The B-Mode filter only computed the last chunk in the last pass.
+    const ImageType::RegionType bufferedRegion = bMode->GetOutput()->GetBufferedRegion();
+    if (bufferedRegion.GetNumberOfPixels() >= image->GetLargestPossibleRegion().GetNumberOfPixels() ||
+        bufferedRegion.GetSize()[0] != size[0])
+    {
+      std::cerr << "Expected a streamed chunk with complete lines, got " << bufferedRegion << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    itk::ImageRegionConstIteratorWithIndex<ImageType> referenceIt(reference->GetOutput(),
+                                                                  image->GetLargestPossibleRegion());
+    itk::ImageRegionConstIteratorWithIndex<ImageType> streamedIt(streamer->GetOutput(),
+                                                                 image->GetLargestPossibleRegion());
+    for (referenceIt.GoToBegin(), streamedIt.GoToBegin(); !referenceIt.IsAtEnd(); ++referenceIt, ++streamedIt)
+    {
+      if (std::abs(referenceIt.Get() - streamedIt.Get()) > 1e-9)
+      {
+        std::cerr << "Streamed output mismatch (fused: " << fused << ") at " << referenceIt.GetIndex() << ": "
+                  << referenceIt.Get() << " vs. " << streamedIt.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Throughput of the block matching registration.
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVector.h"
+
+#include "itkBlockMatchingImageRegistrationMethod.h"
+#include "itkBlockMatchingNormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter.h"
+#include "itkBlockMatchingSearchRegionImageInitializer.h"
+#include "itkUltrasoundBenchmark.h"
+
+namespace
+{
+
+template <unsigned int VDimension>
+void
+benchmarkBlockMatching(itk::UltrasoundBenchmark::Harness &                      harness,
+                       const typename itk::Image<short, VDimension>::SizeType & size,
+                       const typename itk::Image<short, VDimension>::SizeType & blockRadius,
+                       const typename itk::Image<short, VDimension>::SizeType & searchRadius,
+                       unsigned int                                             repetitions)
+{
+  using InputImageType = itk::Image<short, VDimension>;
+  using MetricImageType = itk::Image<double, VDimension>;
+  using DisplacementImageType = itk::Image<itk::Vector<double, VDimension>, VDimension>;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+
+  // The moving image is the fixed image moved by three samples axially.
+  typename InputImageType::Pointer fixed = HarnessType::template MakeRF<InputImageType>(size);
+  typename InputImageType::Pointer moving = InputImageType::New();
+  moving->SetRegions(fixed->GetLargestPossibleRegion());
+  moving->Allocate();
+  itk::ImageRegionIteratorWithIndex<InputImageType> movingIt(moving, moving->GetLargestPossibleRegion());
+  for (movingIt.GoToBegin(); !movingIt.IsAtEnd(); ++movingIt)
+  {
+    typename InputImageType::IndexType index = movingIt.GetIndex();
+    index[0] = std::max<itk::IndexValueType>(index[0] - 3, 0);
+    movingIt.Set(fixed->GetPixel(index));
+  }
+  const std::string geometry = HarnessType::GetGeometry(size);
+  double            samples = 1.0;
+  for (unsigned int dimension = 0; dimension < VDimension; ++dimension)
+  {
+    samples *= size[dimension];
+  }
+
+  using SearchRegionInitializerType = itk::BlockMatching::SearchRegionImageInitializer<InputImageType, InputImageType>;
+  typename SearchRegionInitializerType::Pointer searchRegions = SearchRegionInitializerType::New();
+  searchRegions->SetFixedImage(fixed);
+  searchRegions->SetMovingImage(moving);
+  searchRegions->SetFixedBlockRadius(blockRadius);
+  searchRegions->SetSearchRegionRadius(searchRadius);
+
+  using RegistrationMethodType = itk::BlockMatching::
+    ImageRegistrationMethod<InputImageType, InputImageType, MetricImageType, DisplacementImageType, double>;
+  using MetricImageFilterType = itk::BlockMatching::
+    NormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+
+  for (const unsigned int threads : HarnessType::GetThreadCounts())
+  {
+    for (unsigned int parallelizeBlocks = 0; parallelizeBlocks < 2; ++parallelizeBlocks)
+    {
+      typename RegistrationMethodType::Pointer registrationMethod = RegistrationMethodType::New();
+      registrationMethod->SetFixedImage(fixed);
+      registrationMethod->SetMovingImage(moving);
+      registrationMethod->SetInput(searchRegions->GetOutput());
+      registrationMethod->SetRadius(blockRadius);
+      registrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+      registrationMethod->SetParallelizeBlocks(parallelizeBlocks);
+      HarnessType::SetThreads(registrationMethod, threads);
+      harness.Run(parallelizeBlocks ? "BlockMatching parallel blocks" : "BlockMatching",
+                  geometry,
+                  threads,
+                  samples,
+                  repetitions,
+                  [&registrationMethod]() {
+                    registrationMethod->Modified();
+                    registrationMethod->Update();
+                  });
+    }
+  }
+}
+
+} // namespace
+
+int
+itkBlockMatchingBenchmark(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " outputJSON [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const unsigned int repetitions = (argc > 2) ? std::stoi(argv[2]) : 3;
+
+  itk::UltrasoundBenchmark::Harness harness("BlockMatching");
+
+  try
+  {
+    // A 2D RF frame, as in strain imaging.
+    itk::Image<short, 2>::SizeType frameSize;
+    frameSize[0] = 1024;
+    frameSize[1] = 128;
+    itk::Image<short, 2>::SizeType frameBlockRadius;
+    frameBlockRadius[0] = 20;
+    frameBlockRadius[1] = 4;
+    itk::Image<short, 2>::SizeType frameSearchRadius;
+    frameSearchRadius[0] = 30;
+    frameSearchRadius[1] = 5;
+    benchmarkBlockMatching<2>(harness, frameSize, frameBlockRadius, frameSearchRadius, repetitions);
+
+    // A 3D RF volume.
+    itk::Image<short, 3>::SizeType volumeSize;
+    volumeSize[0] = 512;
+    volumeSize[1] = 64;
+    volumeSize[2] = 16;
+    itk::Image<short, 3>::SizeType volumeBlockRadius;
+    volumeBlockRadius[0] = 10;
+    volumeBlockRadius[1] = 2;
+    volumeBlockRadius[2] = 2;
+    itk::Image<short, 3>::SizeType volumeSearchRadius;
+    volumeSearchRadius[0] = 15;
+    volumeSearchRadius[1] = 3;
+    volumeSearchRadius[2] = 3;
+    benchmarkBlockMatching<3>(harness, volumeSize, volumeBlockRadius, volumeSearchRadius, repetitions);
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!harness.WriteJSON(argv[1]))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
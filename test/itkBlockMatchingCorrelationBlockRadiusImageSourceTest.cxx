@@ -0,0 +1,134 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
+#include "itkVector.h"
+
+#include "itkBlockMatchingCorrelationBlockRadiusImageSource.h"
+#include "itkBlockMatchingSearchRegionImageInitializer.h"
+
+int
+itkBlockMatchingCorrelationBlockRadiusImageSourceTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const unsigned int Dimension = 2;
+  using InputPixelType = signed short;
+  using InputImageType = itk::Image<InputPixelType, Dimension>;
+  using RadiusType = InputImageType::SizeType;
+
+  using VectorType = itk::Vector<float, Dimension>;
+  using DisplacementImageType = itk::Image<VectorType, Dimension>;
+
+  using ReaderType = itk::ImageFileReader<InputImageType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->Update());
+
+  // The grid of the blocks.
+  using SearchRegionInitializerType = itk::BlockMatching::SearchRegionImageInitializer<InputImageType, InputImageType>;
+  SearchRegionInitializerType::Pointer searchRegions = SearchRegionInitializerType::New();
+  searchRegions->SetFixedImage(reader->GetOutput());
+  searchRegions->SetMovingImage(reader->GetOutput());
+  RadiusType blockRadius;
+  blockRadius[0] = 20;
+  blockRadius[1] = 4;
+  searchRegions->SetFixedBlockRadius(blockRadius);
+  searchRegions->SetSearchRegionRadius(blockRadius);
+  ITK_TRY_EXPECT_NO_EXCEPTION(searchRegions->UpdateOutputInformation());
+
+  DisplacementImageType::Pointer displacements = DisplacementImageType::New();
+  displacements->CopyInformation(searchRegions->GetOutput());
+  displacements->SetRegions(searchRegions->GetOutput()->GetLargestPossibleRegion());
+  displacements->Allocate();
+  displacements->FillBuffer(VectorType(0.0f));
+
+  using RadiusImageSourceType =
+    itk::BlockMatching::CorrelationBlockRadiusImageSource<InputImageType, InputImageType, DisplacementImageType>;
+  RadiusImageSourceType::Pointer radiusSource = RadiusImageSourceType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(radiusSource, CorrelationBlockRadiusImageSource, ImageSource);
+
+  radiusSource->SetFixedImage(reader->GetOutput());
+  radiusSource->SetMovingImage(reader->GetOutput());
+  radiusSource->SetDisplacements(displacements);
+  ITK_TEST_SET_GET_VALUE(displacements.GetPointer(), radiusSource->GetDisplacements());
+
+  // The MaximumRadius is required.
+  ITK_TRY_EXPECT_EXCEPTION(radiusSource->Update());
+
+  radiusSource->SetMaximumRadius(blockRadius);
+  ITK_TEST_SET_GET_VALUE(blockRadius, radiusSource->GetMaximumRadius());
+  ITK_TEST_SET_GET_VALUE(0.5, radiusSource->GetMinimumRadiusFactor());
+  ITK_TEST_SET_GET_VALUE(3, radiusSource->GetNumberOfRadii());
+  ITK_TEST_SET_GET_VALUE(0.9, radiusSource->GetCorrelationThreshold());
+
+  auto expectRadius = [](const RadiusImageSourceType::OutputImageType * radiusImage, const RadiusType & expected) {
+    itk::ImageRegionConstIterator<RadiusImageSourceType::OutputImageType> it(radiusImage,
+                                                                             radiusImage->GetBufferedRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (it.Get() != expected)
+      {
+        std::cerr << "Expected the radius " << expected << ", got " << it.Get() << std::endl;
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // The image matches itself everywhere, so every block gets the smallest
+  // radius.
+  ITK_TRY_EXPECT_NO_EXCEPTION(radiusSource->Update());
+  ITK_TEST_EXPECT_EQUAL(radiusSource->GetOutput()->GetBufferedRegion(), displacements->GetLargestPossibleRegion());
+  RadiusType smallestRadius;
+  smallestRadius[0] = 10;
+  smallestRadius[1] = 2;
+  if (!expectRadius(radiusSource->GetOutput(), smallestRadius))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // No block reaches an impossible correlation, so every block gets the
+  // MaximumRadius.
+  radiusSource->SetCorrelationThreshold(1.01);
+  ITK_TRY_EXPECT_NO_EXCEPTION(radiusSource->Update());
+  if (!expectRadius(radiusSource->GetOutput(), blockRadius))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A single radius is the MaximumRadius.
+  radiusSource->SetCorrelationThreshold(0.9);
+  radiusSource->SetNumberOfRadii(0);
+  ITK_TEST_SET_GET_VALUE(1, radiusSource->GetNumberOfRadii());
+  ITK_TRY_EXPECT_NO_EXCEPTION(radiusSource->Update());
+  if (!expectRadius(radiusSource->GetOutput(), blockRadius))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+#include "itkBlockMatchingDiamondSearchMetricImageFilter.h"
+#include "itkBlockMatchingSumOfSquaredDifferencesMetricImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using InputImageType = itk::Image<float, Dimension>;
+using MetricImageType = itk::Image<double, Dimension>;
+using RegionType = InputImageType::RegionType;
+
+// The position of the maximum of the metric image, in the moving image.
+InputImageType::IndexType
+maximumPosition(const MetricImageType * metric, const RegionType & movingRegion)
+{
+  itk::ImageRegionConstIteratorWithIndex<MetricImageType> metricIt(metric, metric->GetBufferedRegion());
+  InputImageType::IndexType                               maximum = movingRegion.GetIndex();
+  double                                                  maximumValue = itk::NumericTraits<double>::NonpositiveMin();
+  for (metricIt.GoToBegin(); !metricIt.IsAtEnd(); ++metricIt)
+  {
+    if (metricIt.Get() > maximumValue)
+    {
+      maximumValue = metricIt.Get();
+      for (unsigned int i = 0; i < Dimension; ++i)
+      {
+        maximum[i] = movingRegion.GetIndex()[i] + metricIt.GetIndex()[i];
+      }
+    }
+  }
+  return maximum;
+}
+
+} // namespace
+
+int
+itkBlockMatchingDiamondSearchMetricImageFilterTest(int, char *[])
+{
+  // Smooth speckle-like blobs, and the moving image is the fixed image
+  // displaced by (3, -2).
+  InputImageType::SizeType size;
+  size.Fill(64);
+  InputImageType::Pointer fixed = InputImageType::New();
+  fixed->SetRegions(size);
+  fixed->Allocate();
+  InputImageType::Pointer moving = InputImageType::New();
+  moving->SetRegions(size);
+  moving->Allocate();
+  InputImageType::OffsetType displacement;
+  displacement[0] = 3;
+  displacement[1] = -2;
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(5);
+  const unsigned int  numberOfBlobs = 40;
+  std::vector<double> blobs;
+  for (unsigned int blob = 0; blob < numberOfBlobs; ++blob)
+  {
+    blobs.push_back(generator->GetUniformVariate(0.0, 64.0));
+    blobs.push_back(generator->GetUniformVariate(0.0, 64.0));
+    blobs.push_back(generator->GetUniformVariate(-100.0, 100.0));
+  }
+  auto blobValue = [&](double x, double y) -> float {
+    double value = 0.0;
+    for (unsigned int blob = 0; blob < numberOfBlobs; ++blob)
+    {
+      const double dx = x - blobs[3 * blob];
+      const double dy = y - blobs[3 * blob + 1];
+      value += blobs[3 * blob + 2] * std::exp(-(dx * dx + dy * dy) / (2.0 * 4.0 * 4.0));
+    }
+    return static_cast<float>(value);
+  };
+  itk::ImageRegionIteratorWithIndex<InputImageType> fixedIt(fixed, fixed->GetLargestPossibleRegion());
+  itk::ImageRegionIteratorWithIndex<InputImageType> movingIt(moving, moving->GetLargestPossibleRegion());
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+  {
+    const InputImageType::IndexType & index = fixedIt.GetIndex();
+    fixedIt.Set(blobValue(index[0], index[1]));
+    movingIt.Set(blobValue(index[0] - displacement[0], index[1] - displacement[1]));
+  }
+
+  using SSDFilterType =
+    itk::BlockMatching::SumOfSquaredDifferencesMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+  using FilterType =
+    itk::BlockMatching::DiamondSearchMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+  SSDFilterType::Pointer ssdFilter = SSDFilterType::New();
+  ssdFilter->SetFixedImage(fixed);
+  ssdFilter->SetMovingImage(moving);
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, DiamondSearchMetricImageFilter, MetricImageFilter);
+
+  ITK_TEST_EXPECT_EQUAL(filter->GetExhaustiveSearchThreshold(), itk::NumericTraits<double>::NonpositiveMin());
+  filter->SetMetricImageFilter(ssdFilter);
+  ITK_TEST_SET_GET_VALUE(ssdFilter.GetPointer(), filter->GetMetricImageFilter());
+  filter->SetFixedImage(fixed);
+  filter->SetMovingImage(moving);
+
+  // Blocks of radius 5 over search regions of radius 10, one after the other,
+  // so that each block starts from the displacement of the previous one.
+  RegionType::SizeType fixedSize;
+  fixedSize.Fill(11);
+  RegionType::SizeType movingSize;
+  movingSize.Fill(21);
+  MetricImageType::Pointer diamondMetric = MetricImageType::New();
+  MetricImageType::Pointer exhaustiveMetric = MetricImageType::New();
+  itk::SizeValueType       numberOfMetricEvaluations = 0;
+  itk::SizeValueType       numberOfBlocks = 0;
+  RegionType               fixedRegion;
+  RegionType               movingRegion;
+  for (itk::IndexValueType y = 24; y <= 40; y += 16)
+  {
+    for (itk::IndexValueType x = 16; x <= 48; x += 4)
+    {
+      RegionType::IndexType fixedIndex;
+      fixedIndex[0] = x - 5;
+      fixedIndex[1] = y - 5;
+      fixedRegion = RegionType(fixedIndex, fixedSize);
+      RegionType::IndexType movingIndex;
+      movingIndex[0] = x - 10;
+      movingIndex[1] = y - 10;
+      movingRegion = RegionType(movingIndex, movingSize);
+
+      ITK_TEST_EXPECT_TRUE(filter->ComputeMetricImage(fixedRegion, movingRegion, diamondMetric));
+      ITK_TEST_EXPECT_TRUE(ssdFilter->ComputeMetricImage(fixedRegion, movingRegion, exhaustiveMetric));
+      numberOfMetricEvaluations += filter->GetNumberOfMetricEvaluations();
+      ++numberOfBlocks;
+
+      // The same maximum, and the metric where it was evaluated.
+      InputImageType::IndexType expectedMaximum;
+      expectedMaximum[0] = x + displacement[0];
+      expectedMaximum[1] = y + displacement[1];
+      ITK_TEST_EXPECT_EQUAL(maximumPosition(exhaustiveMetric, movingRegion), expectedMaximum);
+      ITK_TEST_EXPECT_EQUAL(maximumPosition(diamondMetric, movingRegion), expectedMaximum);
+      itk::ImageRegionConstIteratorWithIndex<MetricImageType> diamondIt(diamondMetric,
+                                                                       diamondMetric->GetBufferedRegion());
+      for (diamondIt.GoToBegin(); !diamondIt.IsAtEnd(); ++diamondIt)
+      {
+        if (diamondIt.Get() != itk::NumericTraits<double>::NonpositiveMin() &&
+            diamondIt.Get() != exhaustiveMetric->GetPixel(diamondIt.GetIndex()))
+        {
+          std::cerr << "Metric mismatch at " << diamondIt.GetIndex() << ": expected "
+                    << exhaustiveMetric->GetPixel(diamondIt.GetIndex()) << ", got " << diamondIt.Get() << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+  std::cout << "Metric evaluations per block: "
+            << static_cast<double>(numberOfMetricEvaluations) / static_cast<double>(numberOfBlocks) << std::endl;
+  ITK_TEST_EXPECT_TRUE(numberOfMetricEvaluations * 4 < numberOfBlocks * movingRegion.GetNumberOfPixels());
+
+  // Above the threshold, which no sum of squared differences is, the whole
+  // search region is evaluated.
+  filter->SetExhaustiveSearchThreshold(1.0);
+  ITK_TEST_SET_GET_VALUE(1.0, filter->GetExhaustiveSearchThreshold());
+  ITK_TEST_EXPECT_TRUE(filter->ComputeMetricImage(fixedRegion, movingRegion, diamondMetric));
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfMetricEvaluations(), movingRegion.GetNumberOfPixels());
+  itk::ImageRegionConstIteratorWithIndex<MetricImageType> diamondIt(diamondMetric, diamondMetric->GetBufferedRegion());
+  for (diamondIt.GoToBegin(); !diamondIt.IsAtEnd(); ++diamondIt)
+  {
+    if (diamondIt.Get() != exhaustiveMetric->GetPixel(diamondIt.GetIndex()))
+    {
+      std::cerr << "Exhaustive metric mismatch at " << diamondIt.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // And with the pipeline.
+  filter->SetExhaustiveSearchThreshold(itk::NumericTraits<double>::NonpositiveMin());
+  filter->SetFixedImageRegion(fixedRegion);
+  filter->SetMovingImageRegion(movingRegion);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(maximumPosition(filter->GetOutput(), movingRegion),
+                        maximumPosition(exhaustiveMetric, movingRegion));
+  ITK_TEST_EXPECT_TRUE(filter->GetNumberOfMetricEvaluations() < movingRegion.GetNumberOfPixels());
+
+  return EXIT_SUCCESS;
+}
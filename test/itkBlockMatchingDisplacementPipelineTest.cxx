@@ -0,0 +1,156 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <sstream>
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkBlockMatchingDisplacementPipeline.h"
+
+int
+itkBlockMatchingDisplacementPipelineTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " fixedImage movingImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using PipelineType = itk::BlockMatching::DisplacementPipeline<signed short>;
+  using ReaderType = itk::ImageFileReader<PipelineType::FixedImageType>;
+  ReaderType::Pointer fixedReader = ReaderType::New();
+  fixedReader->SetFileName(argv[1]);
+  ReaderType::Pointer movingReader = ReaderType::New();
+  movingReader->SetFileName(argv[2]);
+
+  PipelineType::Pointer pipeline = PipelineType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(pipeline, DisplacementPipeline, ImageToImageFilter);
+
+  pipeline->SetFixedImage(fixedReader->GetOutput());
+  pipeline->SetMovingImage(movingReader->GetOutput());
+  ITK_TEST_SET_GET_BOOLEAN(pipeline, CollectStatistics, false);
+  pipeline->CollectStatisticsOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(pipeline->Update());
+
+  // One entry per level, with the blocks and the search regions of the level.
+  const PipelineType::Statistics & statistics = pipeline->GetStatistics();
+  ITK_TEST_EXPECT_EQUAL(statistics.Levels.size(), pipeline->GetNumberOfLevels());
+  double levelsTime = statistics.ResamplingTime;
+  for (const PipelineType::LevelStatistics & level : statistics.Levels)
+  {
+    ITK_TEST_EXPECT_TRUE(level.NumberOfBlocks > 0);
+    ITK_TEST_EXPECT_TRUE(level.NumberOfMetricEvaluations > level.NumberOfBlocks);
+    ITK_TEST_EXPECT_TRUE(level.MetricTime >= 0.0);
+    ITK_TEST_EXPECT_TRUE(level.PeakMemory > 0.0);
+    levelsTime += level.SearchRegionTime + level.MetricTime + level.RegularizationTime + level.StrainWindowTime;
+  }
+  ITK_TEST_EXPECT_TRUE(levelsTime <= statistics.TotalTime);
+  ITK_TEST_EXPECT_EQUAL(statistics.Levels.back().RegularizationIterations,
+                        pipeline->GetRegularizationMaximumNumberOfIterations());
+
+  std::ostringstream json;
+  pipeline->WriteStatistics(json);
+  std::cout << json.str();
+  ITK_TEST_EXPECT_TRUE(json.str().find("\"NumberOfMetricEvaluations\"") != std::string::npos);
+
+  // Without statistics, there are none.
+  pipeline->CollectStatisticsOff();
+  pipeline->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(pipeline->Update());
+  ITK_TEST_EXPECT_TRUE(pipeline->GetStatistics().Levels.empty());
+
+  // The estimate covers at least the displacements.
+  const itk::SizeValueType footprint = pipeline->EstimateMemoryFootprint();
+  std::cout << "Estimated memory footprint: " << footprint << " bytes" << std::endl;
+  ITK_TEST_EXPECT_TRUE(footprint > pipeline->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() *
+                                     sizeof(PipelineType::VectorType));
+
+  // Adaptive block sizes give displacements on the same grid.
+  const PipelineType::DisplacementImageType::RegionType region = pipeline->GetOutput()->GetBufferedRegion();
+  ITK_TEST_SET_GET_BOOLEAN(pipeline, AdaptiveBlockRadius, false);
+  pipeline->AdaptiveBlockRadiusOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(pipeline->Update());
+  ITK_TEST_EXPECT_EQUAL(pipeline->GetOutput()->GetBufferedRegion(), region);
+  ITK_TEST_EXPECT_TRUE(
+    pipeline->GetMultiResolutionRegistrationMethod()->GetImageRegistrationMethod()->GetRadiusImage() != nullptr);
+
+  // Float metric images give the double displacements, up to the rounding of
+  // the metric, which may only exchange nearly tied peaks.
+  pipeline->AdaptiveBlockRadiusOff();
+  ITK_TRY_EXPECT_NO_EXCEPTION(pipeline->Update());
+  using FloatPipelineType = itk::BlockMatching::DisplacementPipeline<signed short, signed short, float>;
+  FloatPipelineType::Pointer floatPipeline = FloatPipelineType::New();
+  floatPipeline->SetFixedImage(fixedReader->GetOutput());
+  floatPipeline->SetMovingImage(movingReader->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(floatPipeline->Update());
+
+  const PipelineType::DisplacementImageType *      displacements = pipeline->GetOutput();
+  const FloatPipelineType::DisplacementImageType * floatDisplacements = floatPipeline->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(floatDisplacements->GetBufferedRegion(), displacements->GetBufferedRegion());
+  const PipelineType::FixedImageType::SpacingType & sampleSpacing = fixedReader->GetOutput()->GetSpacing();
+  itk::SizeValueType                                mismatches = 0;
+  double                                            meanDifference = 0.0;
+  using DisplacementIteratorType = itk::ImageRegionConstIteratorWithIndex<PipelineType::DisplacementImageType>;
+  DisplacementIteratorType it(displacements, displacements->GetBufferedRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const FloatPipelineType::VectorType & floatDisplacement = floatDisplacements->GetPixel(it.GetIndex());
+    bool                                  mismatch = false;
+    for (unsigned int i = 0; i < PipelineType::ImageDimension; ++i)
+    {
+      const double difference = std::abs(floatDisplacement[i] - it.Get()[i]) / sampleSpacing[i];
+      meanDifference += difference;
+      mismatch = mismatch || difference > 0.1;
+    }
+    mismatches += mismatch;
+  }
+  const itk::SizeValueType numberOfDisplacements = displacements->GetBufferedRegion().GetNumberOfPixels();
+  meanDifference /= numberOfDisplacements * PipelineType::ImageDimension;
+  std::cout << "Float displacements: " << mismatches << " of " << numberOfDisplacements
+            << " differ by more than 0.1 sample, mean difference " << meanDifference << " sample" << std::endl;
+  ITK_TEST_EXPECT_TRUE(mismatches <= numberOfDisplacements / 50);
+  ITK_TEST_EXPECT_TRUE(meanDifference < 0.05);
+
+  // A pipeline prepared on the geometry of the frames gives the same
+  // displacements.
+  PipelineType::Pointer preparedPipeline = PipelineType::New();
+  preparedPipeline->SetFixedImage(fixedReader->GetOutput());
+  preparedPipeline->SetMovingImage(movingReader->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(preparedPipeline->Prepare(fixedReader->GetOutput()));
+  ITK_TEST_EXPECT_TRUE(preparedPipeline->GetFixedImage() == fixedReader->GetOutput());
+  ITK_TEST_EXPECT_TRUE(preparedPipeline->GetMovingImage() == movingReader->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(preparedPipeline->Update());
+  const PipelineType::DisplacementImageType * preparedDisplacements = preparedPipeline->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(preparedDisplacements->GetBufferedRegion(), displacements->GetBufferedRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    if (preparedDisplacements->GetPixel(it.GetIndex()) != it.Get())
+    {
+      std::cerr << "Prepared: mismatch at " << it.GetIndex() << ": " << it.Get() << " vs. "
+                << preparedDisplacements->GetPixel(it.GetIndex()) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <vector>
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkJoinSeriesImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include "itkBlockMatchingDisplacementSequenceImageFilter.h"
+
+int
+itkBlockMatchingDisplacementSequenceImageFilterTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " fixedImage movingImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using FilterType = itk::BlockMatching::DisplacementSequenceImageFilter<signed short, float>;
+  using FrameImageType = FilterType::FrameImageType;
+  using PipelineType = FilterType::DisplacementPipelineType;
+
+  using ReaderType = itk::ImageFileReader<FrameImageType>;
+  ReaderType::Pointer fixedReader = ReaderType::New();
+  fixedReader->SetFileName(argv[1]);
+  ReaderType::Pointer movingReader = ReaderType::New();
+  movingReader->SetFileName(argv[2]);
+
+  // A stack of three frames: pre, post, pre.
+  using JoinType = itk::JoinSeriesImageFilter<FrameImageType, FilterType::InputImageType>;
+  JoinType::Pointer join = JoinType::New();
+  join->SetInput(0, fixedReader->GetOutput());
+  join->SetInput(1, movingReader->GetOutput());
+  join->SetInput(2, fixedReader->GetOutput());
+  join->SetSpacing(0.05);
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, DisplacementSequenceImageFilter, ImageToImageFilter);
+
+  ITK_TEST_SET_GET_BOOLEAN(filter, ComputeStrain, false);
+  ITK_TEST_SET_GET_BOOLEAN(filter, UsePreviousDisplacements, false);
+
+  filter->SetInput(join->GetOutput());
+  filter->ComputeStrainOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+
+  // The displacements of the first pair are the ones of a pipeline.
+  PipelineType::Pointer pipeline = PipelineType::New();
+  pipeline->SetFixedImage(fixedReader->GetOutput());
+  pipeline->SetMovingImage(movingReader->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(pipeline->Update());
+
+  const FilterType::OutputImageType *         displacements = filter->GetOutput();
+  const PipelineType::DisplacementImageType * pairDisplacements = pipeline->GetOutput();
+  const FilterType::OutputImageType::SizeType size = displacements->GetLargestPossibleRegion().GetSize();
+  ITK_TEST_EXPECT_EQUAL(size[2], 2);
+  ITK_TEST_EXPECT_EQUAL(size[0], pairDisplacements->GetLargestPossibleRegion().GetSize()[0]);
+  ITK_TEST_EXPECT_EQUAL(size[1], pairDisplacements->GetLargestPossibleRegion().GetSize()[1]);
+  ITK_TEST_EXPECT_EQUAL(displacements->GetSpacing()[2], 0.05);
+
+  using PairIteratorType = itk::ImageRegionConstIterator<PipelineType::DisplacementImageType>;
+  PairIteratorType                        pairIt(pairDisplacements, pairDisplacements->GetBufferedRegion());
+  const float *                           stacked = displacements->GetBufferPointer();
+  itk::SizeValueType                      mismatches = 0;
+  ITK_TEST_EXPECT_EQUAL(displacements->GetNumberOfComponentsPerPixel(), 2);
+  for (pairIt.GoToBegin(); !pairIt.IsAtEnd(); ++pairIt, stacked += 2)
+  {
+    const double difference = std::abs(pairIt.Get()[0] - stacked[0]) + std::abs(pairIt.Get()[1] - stacked[1]);
+    mismatches += (difference > 1e-4 * fixedReader->GetOutput()->GetSpacing()[0]);
+  }
+  std::cout << "Displacements of the first pair that differ from the pipeline: " << mismatches << std::endl;
+  ITK_TEST_EXPECT_EQUAL(mismatches, 0);
+
+  // The strains have the geometry of the displacements, with the xx, xy and yy
+  // components of the tensors.
+  ITK_TEST_EXPECT_EQUAL(filter->GetStrainOutput()->GetBufferedRegion(), displacements->GetBufferedRegion());
+  ITK_TEST_EXPECT_EQUAL(filter->GetStrainOutput()->GetNumberOfComponentsPerPixel(), 3);
+
+  // Only the axial strain, which is the first component of the tensors up to
+  // the boundary, where the fits are restricted to the displacements.
+  std::vector<float> tensors(filter->GetStrainOutput()->GetBufferPointer(),
+                             filter->GetStrainOutput()->GetBufferPointer() +
+                               3 * filter->GetStrainOutput()->GetBufferedRegion().GetNumberOfPixels());
+  ITK_TEST_SET_GET_BOOLEAN(filter, StrainComponentOnly, false);
+  filter->StrainComponentOnlyOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  const FilterType::StrainImageType * axialStrain = filter->GetStrainOutput();
+  ITK_TEST_EXPECT_EQUAL(axialStrain->GetBufferedRegion(), displacements->GetBufferedRegion());
+  ITK_TEST_EXPECT_EQUAL(axialStrain->GetNumberOfComponentsPerPixel(), 1);
+  itk::SizeValueType strainMismatches = 0;
+  for (size_t ii = 0; ii < tensors.size() / 3; ++ii)
+  {
+    const itk::IndexValueType axialIndex = ii % size[0];
+    const bool interior = axialIndex > 0 && axialIndex + 1 < static_cast<itk::IndexValueType>(size[0]);
+    strainMismatches += interior && std::abs(axialStrain->GetBufferPointer()[ii] - tensors[3 * ii]) > 1e-4;
+  }
+  std::cout << "Axial strains that differ from the tensors: " << strainMismatches << std::endl;
+  ITK_TEST_EXPECT_EQUAL(strainMismatches, 0);
+  filter->StrainComponentOnlyOff();
+
+  // The displacements of a pair may center the search regions of the next one.
+  filter->UsePreviousDisplacementsOn();
+  filter->ComputeStrainOff();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleRegion().GetSize()[2], 2);
+
+  // A single frame has no pair.
+  JoinType::Pointer singleFrame = JoinType::New();
+  singleFrame->SetInput(0, fixedReader->GetOutput());
+  filter->SetInput(singleFrame->GetOutput());
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  return EXIT_SUCCESS;
+}
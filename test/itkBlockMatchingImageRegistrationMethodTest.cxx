@@ -17,12 +17,21 @@
  *=========================================================================*/
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkTestingMacros.h"
 #include "itkVector.h"
 
 #include "itkBlockMatchingImageRegistrationMethod.h"
+#include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
 #include "itkBlockMatchingNormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter.h"
+#include "itkBlockMatchingParabolicInterpolationDisplacementCalculator.h"
 #include "itkBlockMatchingSearchRegionImageInitializer.h"
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 int
 itkBlockMatchingImageRegistrationMethodTest(int argc, char * argv[])
 {
@@ -80,6 +89,8 @@ itkBlockMatchingImageRegistrationMethodTest(int argc, char * argv[])
 
   registrationMethod->SetMetricImageFilter(metricImageFilter);
 
+  ITK_TEST_SET_GET_BOOLEAN(registrationMethod, ParallelizeBlocks, false);
+
   using WriterType = itk::ImageFileWriter<DisplacementImageType>;
   WriterType::Pointer displacementWriter = WriterType::New();
   displacementWriter->SetFileName(argv[3]);
@@ -94,5 +105,232 @@ itkBlockMatchingImageRegistrationMethodTest(int argc, char * argv[])
     std::cerr << ex << std::endl;
     return EXIT_FAILURE;
   }
+
+  // Matching the blocks in parallel gives the same displacements.
+  RegistrationMethodType::Pointer parallelRegistrationMethod = RegistrationMethodType::New();
+  parallelRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+  parallelRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+  parallelRegistrationMethod->SetInput(searchRegions->GetOutput());
+  parallelRegistrationMethod->SetRadius(blockRadius);
+  parallelRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+  parallelRegistrationMethod->ParallelizeBlocksOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(parallelRegistrationMethod->Update());
+
+  auto sameDisplacements = [](const DisplacementImageType * expected, const DisplacementImageType * displacement) {
+    if (displacement->GetBufferedRegion() != expected->GetBufferedRegion())
+    {
+      std::cerr << "Unexpected displacement region " << displacement->GetBufferedRegion() << std::endl;
+      return false;
+    }
+    itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> expectedIt(expected, expected->GetBufferedRegion());
+    for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+    {
+      if (displacement->GetPixel(expectedIt.GetIndex()) != expectedIt.Get())
+      {
+        std::cerr << "Displacement mismatch at " << expectedIt.GetIndex() << ": expected " << expectedIt.Get()
+                  << ", got " << displacement->GetPixel(expectedIt.GetIndex()) << std::endl;
+        return false;
+      }
+    }
+    return true;
+  };
+  if (!sameDisplacements(registrationMethod->GetOutput(), parallelRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The progress events increase, and an abort request from one of them stops
+  // the matching with a ProcessAborted exception, serially and in parallel.
+  for (unsigned int parallel = 0; parallel < 2; ++parallel)
+  {
+    RegistrationMethodType::Pointer abortRegistrationMethod = RegistrationMethodType::New();
+    abortRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+    abortRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+    abortRegistrationMethod->SetInput(searchRegions->GetOutput());
+    abortRegistrationMethod->SetRadius(blockRadius);
+    abortRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+    abortRegistrationMethod->SetParallelizeBlocks(parallel != 0);
+    ITK_TEST_SET_GET_VALUE(0.1, abortRegistrationMethod->GetProgressEventInterval());
+    abortRegistrationMethod->SetProgressEventInterval(0.0);
+    ITK_TEST_SET_GET_VALUE(0.0, abortRegistrationMethod->GetProgressEventInterval());
+
+    std::vector<float> progress;
+    std::mutex         progressMutex;
+    bool               abort = false;
+    abortRegistrationMethod->AddObserver(itk::ProgressEvent(), [&](const itk::EventObject &) {
+      std::lock_guard<std::mutex> lock(progressMutex);
+      progress.push_back(abortRegistrationMethod->GetProgress());
+      if (abort && progress.back() > 0.0f)
+      {
+        abortRegistrationMethod->AbortGenerateDataOn();
+      }
+    });
+    ITK_TRY_EXPECT_NO_EXCEPTION(abortRegistrationMethod->Update());
+    ITK_TEST_EXPECT_TRUE(progress.size() > 2);
+    ITK_TEST_EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    ITK_TEST_EXPECT_EQUAL(progress.back(), 1.0f);
+
+    progress.clear();
+    abort = true;
+    abortRegistrationMethod->Modified();
+    ITK_TRY_EXPECT_EXCEPTION(abortRegistrationMethod->Update());
+    ITK_TEST_EXPECT_TRUE(!progress.empty());
+    ITK_TEST_EXPECT_TRUE(*std::max_element(progress.begin(), progress.end()) < 1.0f);
+  }
+
+  // Matching the blocks slab by slab, on the parts of the images the slabs
+  // need, gives the same displacements, serially and in parallel.
+  RegistrationMethodType::Pointer slabRegistrationMethod = RegistrationMethodType::New();
+  slabRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+  slabRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+  slabRegistrationMethod->SetInput(searchRegions->GetOutput());
+  slabRegistrationMethod->SetRadius(blockRadius);
+  slabRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+  ITK_TEST_SET_GET_VALUE(1, slabRegistrationMethod->GetNumberOfSlabs());
+  slabRegistrationMethod->SetNumberOfSlabs(4);
+  ITK_TEST_SET_GET_VALUE(4, slabRegistrationMethod->GetNumberOfSlabs());
+  ITK_TRY_EXPECT_NO_EXCEPTION(slabRegistrationMethod->Update());
+  if (!sameDisplacements(registrationMethod->GetOutput(), slabRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+  slabRegistrationMethod->ParallelizeBlocksOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(slabRegistrationMethod->Update());
+  if (!sameDisplacements(registrationMethod->GetOutput(), slabRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Passing only the neighborhoods of the peaks of the metric images to the
+  // displacement calculators gives the same displacements.
+  using MaximumPixelCalculatorType =
+    itk::BlockMatching::MaximumPixelDisplacementCalculator<MetricImageType, DisplacementImageType>;
+  MaximumPixelCalculatorType::Pointer maximumPixelCalculator = MaximumPixelCalculatorType::New();
+  ITK_TEST_SET_GET_BOOLEAN(maximumPixelCalculator, PeakNeighborhoodOnly, true);
+  parallelRegistrationMethod->SetMetricImageToDisplacementCalculator(maximumPixelCalculator);
+  ITK_TRY_EXPECT_NO_EXCEPTION(parallelRegistrationMethod->Update());
+  if (!sameDisplacements(registrationMethod->GetOutput(), parallelRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  using ParabolicCalculatorType =
+    itk::BlockMatching::ParabolicInterpolationDisplacementCalculator<MetricImageType, DisplacementImageType>;
+  ParabolicCalculatorType::Pointer parabolicCalculator = ParabolicCalculatorType::New();
+  parallelRegistrationMethod->SetMetricImageToDisplacementCalculator(parabolicCalculator);
+  ITK_TRY_EXPECT_NO_EXCEPTION(parallelRegistrationMethod->Update());
+  DisplacementImageType::Pointer parabolicDisplacement = parallelRegistrationMethod->GetOutput();
+  parabolicDisplacement->DisconnectPipeline();
+
+  ParabolicCalculatorType::Pointer peakParabolicCalculator = ParabolicCalculatorType::New();
+  peakParabolicCalculator->PeakNeighborhoodOnlyOn();
+  parallelRegistrationMethod->SetMetricImageToDisplacementCalculator(peakParabolicCalculator);
+  ITK_TRY_EXPECT_NO_EXCEPTION(parallelRegistrationMethod->Update());
+  if (!sameDisplacements(parabolicDisplacement, parallelRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Blocks with the radii of a RadiusImage give the displacements of blocks
+  // with the same Radius, and the radii are clamped by the Radius.
+  RadiusType smallBlockRadius;
+  smallBlockRadius[0] = 10;
+  smallBlockRadius[1] = 2;
+  RegistrationMethodType::Pointer smallRegistrationMethod = RegistrationMethodType::New();
+  smallRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+  smallRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+  smallRegistrationMethod->SetInput(searchRegions->GetOutput());
+  smallRegistrationMethod->SetRadius(smallBlockRadius);
+  smallRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+  ITK_TRY_EXPECT_NO_EXCEPTION(smallRegistrationMethod->Update());
+
+  using RadiusImageType = RegistrationMethodType::RadiusImageType;
+  RadiusImageType::Pointer radiusImage = RadiusImageType::New();
+  radiusImage->CopyInformation(searchRegions->GetOutput());
+  radiusImage->SetRegions(searchRegions->GetOutput()->GetLargestPossibleRegion());
+  radiusImage->Allocate();
+  radiusImage->FillBuffer(smallBlockRadius);
+
+  RegistrationMethodType::Pointer radiusImageRegistrationMethod = RegistrationMethodType::New();
+  radiusImageRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+  radiusImageRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+  radiusImageRegistrationMethod->SetInput(searchRegions->GetOutput());
+  radiusImageRegistrationMethod->SetRadius(blockRadius);
+  radiusImageRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+  radiusImageRegistrationMethod->SetRadiusImage(radiusImage);
+  ITK_TEST_SET_GET_VALUE(radiusImage.GetPointer(), radiusImageRegistrationMethod->GetRadiusImage());
+  ITK_TRY_EXPECT_NO_EXCEPTION(radiusImageRegistrationMethod->Update());
+  if (!sameDisplacements(smallRegistrationMethod->GetOutput(), radiusImageRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  RadiusType largeBlockRadius = blockRadius;
+  largeBlockRadius[0] *= 2;
+  radiusImage->FillBuffer(largeBlockRadius);
+  radiusImageRegistrationMethod->ParallelizeBlocksOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(radiusImageRegistrationMethod->Update());
+  if (!sameDisplacements(registrationMethod->GetOutput(), radiusImageRegistrationMethod->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // With a mask, the blocks whose center is in the mask get the displacements
+  // of the unmasked registration, and the others are zero.
+  using MaskImageType = RegistrationMethodType::MaskImageType;
+  const InputImageType * fixedImage = fixedReader->GetOutput();
+  MaskImageType::Pointer mask = MaskImageType::New();
+  mask->CopyInformation(fixedImage);
+  mask->SetRegions(fixedImage->GetLargestPossibleRegion());
+  mask->Allocate();
+  mask->FillBuffer(0);
+  MaskImageType::RegionType maskedRegion = fixedImage->GetLargestPossibleRegion();
+  maskedRegion.SetSize(1, maskedRegion.GetSize(1) / 2);
+  itk::ImageRegionIterator<MaskImageType> maskIt(mask, maskedRegion);
+  for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+  {
+    maskIt.Set(1);
+  }
+
+  for (unsigned int parallel = 0; parallel < 2; ++parallel)
+  {
+    RegistrationMethodType::Pointer maskRegistrationMethod = RegistrationMethodType::New();
+    maskRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+    maskRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+    maskRegistrationMethod->SetInput(searchRegions->GetOutput());
+    maskRegistrationMethod->SetRadius(blockRadius);
+    maskRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+    maskRegistrationMethod->SetParallelizeBlocks(parallel != 0);
+    maskRegistrationMethod->SetMask(mask);
+    ITK_TEST_SET_GET_VALUE(mask.GetPointer(), maskRegistrationMethod->GetMask());
+    ITK_TRY_EXPECT_NO_EXCEPTION(maskRegistrationMethod->Update());
+
+    const DisplacementImageType * expected = registrationMethod->GetOutput();
+    const DisplacementImageType * masked = maskRegistrationMethod->GetOutput();
+    const MaskImageType *         blockMask = maskRegistrationMethod->GetBlockMask();
+    ITK_TEST_EXPECT_TRUE(blockMask != nullptr);
+    itk::SizeValueType                                            matchedBlocks = 0;
+    itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> expectedIt(expected, expected->GetBufferedRegion());
+    for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+    {
+      const DisplacementImageType::IndexType & index = expectedIt.GetIndex();
+      DisplacementImageType::PointType         point;
+      MaskImageType::IndexType                 maskIndex;
+      expected->TransformIndexToPhysicalPoint(index, point);
+      const bool inMask = mask->TransformPhysicalPointToIndex(point, maskIndex) && mask->GetPixel(maskIndex) != 0;
+      ITK_TEST_EXPECT_EQUAL(static_cast<bool>(blockMask->GetPixel(index)), inMask);
+      const VectorType expectedDisplacement = inMask ? expectedIt.Get() : VectorType(0.0);
+      if (masked->GetPixel(index) != expectedDisplacement)
+      {
+        std::cerr << "Masked displacement mismatch at " << index << ": expected " << expectedDisplacement << ", got "
+                  << masked->GetPixel(index) << std::endl;
+        return EXIT_FAILURE;
+      }
+      matchedBlocks += inMask;
+    }
+    ITK_TEST_EXPECT_TRUE(matchedBlocks > 0);
+    ITK_TEST_EXPECT_TRUE(matchedBlocks < expected->GetBufferedRegion().GetNumberOfPixels());
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itkVector.h"
+
+#include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using MetricImageType = itk::Image<double, Dimension>;
+using DisplacementImageType = itk::Image<itk::Vector<double, Dimension>, Dimension>;
+using CalculatorType = itk::BlockMatching::MaximumPixelDisplacementCalculator<MetricImageType, DisplacementImageType>;
+
+double
+metricValue(const DisplacementImageType::IndexType & block, const MetricImageType::IndexType & index, int frame)
+{
+  return 1000.0 * frame + 100.0 * (block[1] * 3 + block[0]) + 10.0 * index[1] + index[0];
+}
+
+
+// Set the metric images of every block of a frame.
+void
+setMetricImages(CalculatorType * calculator, const DisplacementImageType * displacement, int frame)
+{
+  MetricImageType::SizeType metricSize;
+  metricSize[0] = 5;
+  metricSize[1] = 4;
+
+  itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> blockIt(displacement,
+                                                                        displacement->GetLargestPossibleRegion());
+  for (blockIt.GoToBegin(); !blockIt.IsAtEnd(); ++blockIt)
+  {
+    const DisplacementImageType::IndexType block = blockIt.GetIndex();
+    MetricImageType::Pointer               metricImage = MetricImageType::New();
+    metricImage->SetRegions(metricSize);
+    MetricImageType::PointType origin;
+    origin[0] = block[0];
+    origin[1] = block[1] + frame;
+    metricImage->SetOrigin(origin);
+    metricImage->Allocate();
+    itk::ImageRegionIteratorWithIndex<MetricImageType> metricIt(metricImage, metricImage->GetLargestPossibleRegion());
+    for (metricIt.GoToBegin(); !metricIt.IsAtEnd(); ++metricIt)
+    {
+      metricIt.Set(metricValue(block, metricIt.GetIndex(), frame));
+    }
+    DisplacementImageType::PointType center;
+    displacement->TransformIndexToPhysicalPoint(block, center);
+    calculator->SetMetricImagePixel(center, block, metricImage);
+  }
+}
+
+
+// Set the metric images of every block of a frame, and check the cached
+// copies.
+bool
+setFrame(CalculatorType * calculator, const DisplacementImageType * displacement, int frame)
+{
+  setMetricImages(calculator, displacement, frame);
+
+  MetricImageType::SizeType metricSize;
+  metricSize[0] = 5;
+  metricSize[1] = 4;
+  itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> blockIt(displacement,
+                                                                        displacement->GetLargestPossibleRegion());
+  const CalculatorType::MetricImageImageType * metricImageImage = calculator->GetMetricImageImage();
+  const double *                               firstBuffer =
+    metricImageImage->GetPixel(displacement->GetLargestPossibleRegion().GetIndex())->GetBufferPointer();
+  for (blockIt.GoToBegin(); !blockIt.IsAtEnd(); ++blockIt)
+  {
+    const MetricImageType * cachedImage = metricImageImage->GetPixel(blockIt.GetIndex());
+    if (cachedImage->GetBufferPointer() !=
+        firstBuffer + displacement->ComputeOffset(blockIt.GetIndex()) * metricSize[0] * metricSize[1])
+    {
+      std::cerr << "The cached metric image of block " << blockIt.GetIndex() << " is not in the contiguous buffer."
+                << std::endl;
+      return false;
+    }
+    if (cachedImage->GetOrigin()[1] != blockIt.GetIndex()[1] + frame)
+    {
+      std::cerr << "The cached metric image of block " << blockIt.GetIndex() << " has the origin "
+                << cachedImage->GetOrigin() << std::endl;
+      return false;
+    }
+    itk::ImageRegionConstIteratorWithIndex<MetricImageType> cachedIt(cachedImage, cachedImage->GetBufferedRegion());
+    for (cachedIt.GoToBegin(); !cachedIt.IsAtEnd(); ++cachedIt)
+    {
+      if (cachedIt.Get() != metricValue(blockIt.GetIndex(), cachedIt.GetIndex(), frame))
+      {
+        std::cerr << "Cached metric mismatch for block " << blockIt.GetIndex() << " at " << cachedIt.GetIndex()
+                  << ": " << cachedIt.Get() << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+// The maximum of every metric image is at its last index.
+bool
+checkDisplacements(const DisplacementImageType * displacement, int frame)
+{
+  itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> blockIt(displacement,
+                                                                        displacement->GetLargestPossibleRegion());
+  for (blockIt.GoToBegin(); !blockIt.IsAtEnd(); ++blockIt)
+  {
+    if (blockIt.Get()[0] != 4.0 || blockIt.Get()[1] != 3.0 + frame)
+    {
+      std::cerr << "Unexpected displacement of block " << blockIt.GetIndex() << ": " << blockIt.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkBlockMatchingMetricImageToDisplacementCalculatorTest(int, char *[])
+{
+  DisplacementImageType::SizeType gridSize;
+  gridSize[0] = 3;
+  gridSize[1] = 2;
+  DisplacementImageType::Pointer displacement = DisplacementImageType::New();
+  displacement->SetRegions(gridSize);
+  displacement->Allocate();
+
+  CalculatorType::Pointer calculator = CalculatorType::New();
+  ITK_TEST_SET_GET_BOOLEAN(calculator, CacheMetricImage, false);
+  calculator->CacheMetricImageOn();
+  calculator->SetDisplacementImage(displacement);
+
+  if (!setFrame(calculator, displacement, 0))
+  {
+    return EXIT_FAILURE;
+  }
+  DisplacementImageType::IndexType lastBlock;
+  lastBlock[0] = 2;
+  lastBlock[1] = 1;
+  const MetricImageType * cachedImage = calculator->GetMetricImageImage()->GetPixel(lastBlock);
+
+  // The next frame reuses the cached images.
+  if (!setFrame(calculator, displacement, 1))
+  {
+    return EXIT_FAILURE;
+  }
+  ITK_TEST_EXPECT_EQUAL(calculator->GetMetricImageImage()->GetPixel(lastBlock).GetPointer(), cachedImage);
+
+  // The maxima of the cached images are found in the multithreaded Compute().
+  calculator->GetMultiThreader()->SetNumberOfWorkUnits(4);
+  calculator->Compute();
+  if (!checkDisplacements(displacement, 1))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Without the cache, they are found as the metric images are set.
+  CalculatorType::Pointer uncachedCalculator = CalculatorType::New();
+  uncachedCalculator->CacheMetricImageOff();
+  DisplacementImageType::Pointer uncachedDisplacement = DisplacementImageType::New();
+  uncachedDisplacement->SetRegions(gridSize);
+  uncachedDisplacement->Allocate();
+  uncachedCalculator->SetDisplacementImage(uncachedDisplacement);
+  setMetricImages(uncachedCalculator, uncachedDisplacement, 2);
+  uncachedCalculator->Compute();
+  if (!checkDisplacements(uncachedDisplacement, 2))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -15,8 +15,13 @@
  *  limitations under the License.
  *
  *=========================================================================*/
+#include <cmath>
+#include <vector>
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
 #include "itkVector.h"
 
 #include "itkBlockMatchingImageRegistrationMethod.h"
@@ -116,5 +121,76 @@ itkBlockMatchingMultiResolutionImageRegistrationMethodTest(int argc, char * argv
     std::cerr << ex << std::endl;
     return EXIT_FAILURE;
   }
+
+  // Warm start, as for the next frame of a cine sequence: a single level with
+  // a small search region centered on the displacements just estimated.
+  ITK_TEST_EXPECT_TRUE(searchRegionSource->GetInitialDisplacements() == nullptr);
+  searchRegionSource->SetInitialDisplacements(multiResRegistrationMethod->GetOutput());
+  const DisplacementImageType *                    initialDisplacements = searchRegionSource->GetInitialDisplacements();
+  SearchRegionImageSourceType::PyramidScheduleType warmStartSchedule(1, Dimension);
+  warmStartSchedule.Fill(1);
+  searchRegionSource->SetPyramidSchedule(warmStartSchedule);
+  RadiusType warmStartSearchRadius;
+  warmStartSearchRadius[0] = 4;
+  warmStartSearchRadius[1] = 2;
+  searchRegionSource->SetSearchRegionRadiusSchedule(warmStartSearchRadius);
+  multiResRegistrationMethod->SetSchedules(warmStartSchedule, warmStartSchedule);
+  ITK_TRY_EXPECT_NO_EXCEPTION(multiResRegistrationMethod->Update());
+
+  // Every displacement is in the search region around the initial one.
+  const DisplacementImageType * warmStartDisplacements = multiResRegistrationMethod->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(warmStartDisplacements->GetLargestPossibleRegion(),
+                        initialDisplacements->GetLargestPossibleRegion());
+  const InputImageType::SpacingType                  movingSpacing = movingReader->GetOutput()->GetSpacing();
+  itk::ImageRegionConstIterator<DisplacementImageType> warmStartIt(warmStartDisplacements,
+                                                                   warmStartDisplacements->GetBufferedRegion());
+  itk::ImageRegionConstIterator<DisplacementImageType> initialIt(initialDisplacements,
+                                                                 warmStartDisplacements->GetBufferedRegion());
+  for (warmStartIt.GoToBegin(), initialIt.GoToBegin(); !warmStartIt.IsAtEnd(); ++warmStartIt, ++initialIt)
+  {
+    for (unsigned int i = 0; i < Dimension; ++i)
+    {
+      if (std::abs(warmStartIt.Get()[i] - initialIt.Get()[i]) > (warmStartSearchRadius[i] + 1) * movingSpacing[i])
+      {
+        std::cerr << "The displacement " << warmStartIt.Get() << " is not in the search region around "
+                  << initialIt.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // The next frame, whose fixed image is the last moving image, with its
+  // pyramid reused, gives the displacements of the pyramid computed again.
+  ITK_TEST_SET_GET_BOOLEAN(multiResRegistrationMethod, ReuseMovingImagePyramid, true);
+  ITK_TRY_EXPECT_NO_EXCEPTION(multiResRegistrationMethod->Update());
+  ITK_TEST_EXPECT_TRUE(!multiResRegistrationMethod->GetReusedMovingImagePyramid());
+  multiResRegistrationMethod->SetFixedImage(movingReader->GetOutput());
+  multiResRegistrationMethod->SetMovingImage(fixedReader->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(multiResRegistrationMethod->Update());
+  ITK_TEST_EXPECT_TRUE(multiResRegistrationMethod->GetReusedMovingImagePyramid());
+  const DisplacementImageType *                        displacements = multiResRegistrationMethod->GetOutput();
+  std::vector<VectorType>                              reusedDisplacements;
+  itk::ImageRegionConstIterator<DisplacementImageType> reusedIt(displacements, displacements->GetBufferedRegion());
+  for (reusedIt.GoToBegin(); !reusedIt.IsAtEnd(); ++reusedIt)
+  {
+    reusedDisplacements.push_back(reusedIt.Get());
+  }
+
+  multiResRegistrationMethod->ReuseMovingImagePyramidOff();
+  ITK_TRY_EXPECT_NO_EXCEPTION(multiResRegistrationMethod->Update());
+  ITK_TEST_EXPECT_TRUE(!multiResRegistrationMethod->GetReusedMovingImagePyramid());
+  ITK_TEST_EXPECT_EQUAL(reusedDisplacements.size(), displacements->GetBufferedRegion().GetNumberOfPixels());
+  itk::ImageRegionConstIterator<DisplacementImageType> computedIt(displacements, displacements->GetBufferedRegion());
+  std::vector<VectorType>::const_iterator              reusedValueIt = reusedDisplacements.begin();
+  for (computedIt.GoToBegin(); !computedIt.IsAtEnd(); ++computedIt, ++reusedValueIt)
+  {
+    if (computedIt.Get() != *reusedValueIt)
+    {
+      std::cerr << "The displacement with the reused pyramid, " << *reusedValueIt << ", is not " << computedIt.Get()
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   return EXIT_SUCCESS;
 }
@@ -15,8 +15,12 @@
  *  limitations under the License.
  *
  *=========================================================================*/
+#include <cmath>
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
 
 #include "itkBlockMatchingNormalizedCrossCorrelationFFTMetricImageFilter.h"
 
@@ -89,5 +93,95 @@ itkBlockMatchingNormalizedCrossCorrelationFFTMetricImageFilterTest(int argc, cha
     return EXIT_FAILURE;
   }
 
+  // The spectra of moving tiles give the same metric images, for the first
+  // block, and for a neighboring block whose search region is in the same
+  // tile.  Reusing the buffers of the internal pipeline does not change them
+  // either.
+  FilterType::Pointer             tileFilter = FilterType::New();
+  FilterType::MovingImageSizeType tileSize;
+  tileSize[0] = 160;
+  tileSize[1] = 48;
+  tileFilter->SetMovingTileSize(tileSize);
+  ITK_TEST_SET_GET_VALUE(tileSize, tileFilter->GetMovingTileSize());
+  tileFilter->SetFixedImage(readerFixed->GetOutput());
+  tileFilter->SetMovingImage(readerMoving->GetOutput());
+  FilterType::Pointer reuseFilter = FilterType::New();
+  ITK_TEST_SET_GET_BOOLEAN(reuseFilter, ReuseAllocations, true);
+  reuseFilter->SetFixedImage(readerFixed->GetOutput());
+  reuseFilter->SetMovingImage(readerMoving->GetOutput());
+  for (unsigned int block = 0; block < 2; ++block)
+  {
+    fixedIndex[0] = 999 + 7 * block;
+    fixedIndex[1] = 99 + 3 * block;
+    fixedRegion.SetIndex(fixedIndex);
+    movingIndex[0] = fixedIndex[0] - movingSize[0] / 2;
+    movingIndex[1] = fixedIndex[1] - movingSize[1] / 2;
+    movingRegion.SetIndex(movingIndex);
+    filter->SetFixedImageRegion(fixedRegion);
+    filter->SetMovingImageRegion(movingRegion);
+    tileFilter->SetFixedImageRegion(fixedRegion);
+    tileFilter->SetMovingImageRegion(movingRegion);
+    reuseFilter->SetFixedImageRegion(fixedRegion);
+    reuseFilter->SetMovingImageRegion(movingRegion);
+    ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+    ITK_TRY_EXPECT_NO_EXCEPTION(tileFilter->Update());
+    ITK_TRY_EXPECT_NO_EXCEPTION(reuseFilter->Update());
+
+    const MetricImageType * metricImage = filter->GetOutput();
+    const MetricImageType * tileMetricImage = tileFilter->GetOutput();
+    const MetricImageType * reuseMetricImage = reuseFilter->GetOutput();
+    ITK_TEST_EXPECT_EQUAL(tileMetricImage->GetLargestPossibleRegion(), metricImage->GetLargestPossibleRegion());
+    ITK_TEST_EXPECT_EQUAL(reuseMetricImage->GetLargestPossibleRegion(), metricImage->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<MetricImageType> metricIt(metricImage, metricImage->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<MetricImageType> tileMetricIt(tileMetricImage,
+                                                                metricImage->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<MetricImageType> reuseMetricIt(reuseMetricImage,
+                                                                 metricImage->GetLargestPossibleRegion());
+    for (metricIt.GoToBegin(), tileMetricIt.GoToBegin(), reuseMetricIt.GoToBegin(); !metricIt.IsAtEnd();
+         ++metricIt, ++tileMetricIt, ++reuseMetricIt)
+    {
+      if (std::abs(tileMetricIt.Get() - metricIt.Get()) > 1e-6)
+      {
+        std::cerr << "Block " << block << ": the tiled metric image differs by "
+                  << tileMetricIt.Get() - metricIt.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+      ITK_TEST_EXPECT_EQUAL(reuseMetricIt.Get(), metricIt.Get());
+    }
+  }
+
+  // With a DirectCorrelationCostFactor, the metric image of a small block is
+  // computed directly, and the FFT is used for the larger ones.
+  ITK_TEST_SET_GET_VALUE(0.0, tileFilter->GetDirectCorrelationCostFactor());
+  tileFilter->SetDirectCorrelationCostFactor(2.0);
+  ITK_TEST_SET_GET_VALUE(2.0, tileFilter->GetDirectCorrelationCostFactor());
+  MetricImageType::Pointer directMetricImage = MetricImageType::New();
+  ITK_TEST_EXPECT_TRUE(!tileFilter->ComputeMetricImage(fixedRegion, movingRegion, directMetricImage));
+  fixedSize[0] = 5;
+  fixedSize[1] = 3;
+  fixedRegion.SetSize(fixedSize);
+  movingSize[0] = 9;
+  movingSize[1] = 5;
+  movingIndex[0] = fixedIndex[0] - 2;
+  movingIndex[1] = fixedIndex[1] - 1;
+  movingRegion.SetSize(movingSize);
+  movingRegion.SetIndex(movingIndex);
+  ITK_TEST_EXPECT_TRUE(tileFilter->ComputeMetricImage(fixedRegion, movingRegion, directMetricImage));
+
+  using DirectFilterType = FilterType::DirectMetricImageFilterType;
+  DirectFilterType::Pointer directFilter = DirectFilterType::New();
+  directFilter->SetFixedImage(readerFixed->GetOutput());
+  directFilter->SetMovingImage(readerMoving->GetOutput());
+  MetricImageType::Pointer expectedMetricImage = MetricImageType::New();
+  ITK_TEST_EXPECT_TRUE(directFilter->ComputeMetricImage(fixedRegion, movingRegion, expectedMetricImage));
+  ITK_TEST_EXPECT_EQUAL(directMetricImage->GetBufferedRegion(), expectedMetricImage->GetBufferedRegion());
+  itk::ImageRegionConstIterator<MetricImageType> directIt(directMetricImage, directMetricImage->GetBufferedRegion());
+  itk::ImageRegionConstIterator<MetricImageType> expectedIt(expectedMetricImage,
+                                                            expectedMetricImage->GetBufferedRegion());
+  for (directIt.GoToBegin(), expectedIt.GoToBegin(); !directIt.IsAtEnd(); ++directIt, ++expectedIt)
+  {
+    ITK_TEST_EXPECT_EQUAL(directIt.Get(), expectedIt.Get());
+  }
+
   return EXIT_SUCCESS;
 }
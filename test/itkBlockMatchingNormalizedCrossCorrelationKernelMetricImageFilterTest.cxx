@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+#include "itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using InputImageType = itk::Image<float, Dimension>;
+using MetricImageType = itk::Image<double, Dimension>;
+using RegionType = InputImageType::RegionType;
+using FilterType = itk::BlockMatching::
+  NormalizedCrossCorrelationKernelMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+
+// The normalized cross correlation coefficient of the block with the window
+// centered on a moving image pixel, or zero if the window is not inside.
+double
+referenceMetric(const InputImageType *            fixed,
+                const InputImageType *            moving,
+                const RegionType &                fixedRegion,
+                const InputImageType::IndexType & center)
+{
+  RegionType                windowRegion = fixedRegion;
+  InputImageType::IndexType windowIndex;
+  for (unsigned int i = 0; i < Dimension; ++i)
+  {
+    windowIndex[i] = center[i] - static_cast<itk::IndexValueType>(fixedRegion.GetSize()[i] / 2);
+  }
+  windowRegion.SetIndex(windowIndex);
+  if (!moving->GetLargestPossibleRegion().IsInside(windowRegion))
+  {
+    return 0.0;
+  }
+
+  itk::ImageRegionConstIterator<InputImageType> fixedIt(fixed, fixedRegion);
+  itk::ImageRegionConstIterator<InputImageType> movingIt(moving, windowRegion);
+  double                                        fixedMean = 0.0;
+  double                                        movingMean = 0.0;
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+  {
+    fixedMean += fixedIt.Get();
+    movingMean += movingIt.Get();
+  }
+  fixedMean /= fixedRegion.GetNumberOfPixels();
+  movingMean /= fixedRegion.GetNumberOfPixels();
+  double numerator = 0.0;
+  double fixedSquares = 0.0;
+  double movingSquares = 0.0;
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+  {
+    numerator += (fixedIt.Get() - fixedMean) * (movingIt.Get() - movingMean);
+    fixedSquares += (fixedIt.Get() - fixedMean) * (fixedIt.Get() - fixedMean);
+    movingSquares += (movingIt.Get() - movingMean) * (movingIt.Get() - movingMean);
+  }
+  return numerator / std::sqrt(fixedSquares * movingSquares);
+}
+
+
+// Check the metric of the block over the search region, both from the
+// pipeline and computed directly.
+bool
+checkMetric(const InputImageType * fixed,
+            const InputImageType * moving,
+            const RegionType &     fixedRegion,
+            const RegionType &     movingRegion)
+{
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetFixedImage(const_cast<InputImageType *>(fixed));
+  filter->SetMovingImage(const_cast<InputImageType *>(moving));
+  filter->SetFixedImageRegion(fixedRegion);
+  filter->SetMovingImageRegion(movingRegion);
+  try
+  {
+    filter->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+
+  MetricImageType::Pointer direct = MetricImageType::New();
+  if (!filter->ComputeMetricImage(fixedRegion, movingRegion, direct))
+  {
+    std::cerr << "The metric image was not computed directly." << std::endl;
+    return false;
+  }
+  const MetricImageType * metric = filter->GetOutput();
+  if (direct->GetBufferedRegion() != metric->GetBufferedRegion() || direct->GetOrigin() != metric->GetOrigin())
+  {
+    std::cerr << "The direct metric image information differs from the output." << std::endl;
+    return false;
+  }
+
+  itk::ImageRegionConstIteratorWithIndex<MetricImageType> metricIt(metric, metric->GetBufferedRegion());
+  for (metricIt.GoToBegin(); !metricIt.IsAtEnd(); ++metricIt)
+  {
+    InputImageType::IndexType center;
+    for (unsigned int i = 0; i < Dimension; ++i)
+    {
+      center[i] = movingRegion.GetIndex()[i] + metricIt.GetIndex()[i];
+    }
+    const double expected = referenceMetric(fixed, moving, fixedRegion, center);
+    if (std::abs(metricIt.Get() - expected) > 1e-6 || direct->GetPixel(metricIt.GetIndex()) != metricIt.Get())
+    {
+      std::cerr << "Metric mismatch at " << metricIt.GetIndex() << ": expected " << expected << ", got "
+                << metricIt.Get() << " and " << direct->GetPixel(metricIt.GetIndex()) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilterTest(int, char *[])
+{
+  InputImageType::SizeType size;
+  size[0] = 80;
+  size[1] = 40;
+  InputImageType::Pointer fixed = InputImageType::New();
+  fixed->SetRegions(size);
+  fixed->Allocate();
+  InputImageType::Pointer moving = InputImageType::New();
+  moving->SetRegions(size);
+  moving->Allocate();
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(11);
+  itk::ImageRegionIterator<InputImageType> fixedIt(fixed, fixed->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<InputImageType> movingIt(moving, moving->GetLargestPossibleRegion());
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+  {
+    fixedIt.Set(static_cast<float>(generator->GetUniformVariate(-100.0, 100.0)));
+    movingIt.Set(static_cast<float>(generator->GetUniformVariate(-100.0, 100.0)));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, NormalizedCrossCorrelationKernelMetricImageFilter, MetricImageFilter);
+
+  // A block in the interior.
+  RegionType::IndexType fixedIndex;
+  fixedIndex[0] = 36;
+  fixedIndex[1] = 17;
+  RegionType::SizeType fixedSize;
+  fixedSize[0] = 9;
+  fixedSize[1] = 5;
+  const RegionType      fixedRegion(fixedIndex, fixedSize);
+  RegionType::IndexType movingIndex;
+  movingIndex[0] = 30;
+  movingIndex[1] = 12;
+  RegionType::SizeType movingSize;
+  movingSize[0] = 20;
+  movingSize[1] = 10;
+  if (!checkMetric(fixed, moving, fixedRegion, RegionType(movingIndex, movingSize)))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A search region at the corner, where some windows are outside.
+  movingIndex[0] = 0;
+  movingIndex[1] = 0;
+  if (!checkMetric(fixed, moving, fixedRegion, RegionType(movingIndex, movingSize)))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The moving image is the fixed image, so the blocks match where they
+  // coincide.
+  movingIndex[0] = 30;
+  movingIndex[1] = 12;
+  if (!checkMetric(fixed, fixed, fixedRegion, RegionType(movingIndex, movingSize)))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itkVector.h"
+
+#include "itkBlockMatchingImageRegistrationMethod.h"
+#include "itkBlockMatchingMaximumPixelDisplacementCalculator.h"
+#include "itkBlockMatchingNormalizedCrossCorrelationKernelMetricImageFilter.h"
+#include "itkBlockMatchingOpenCLImageRegistrationMethod.h"
+#include "itkBlockMatchingParabolicInterpolationDisplacementCalculator.h"
+#include "itkBlockMatchingSearchRegionImageInitializer.h"
+
+int
+itkBlockMatchingOpenCLImageRegistrationMethodTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " fixedImage movingImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const unsigned int Dimension = 2;
+  using InputPixelType = signed short;
+  using InputImageType = itk::Image<InputPixelType, Dimension>;
+  using RadiusType = InputImageType::SizeType;
+
+  using MetricPixelType = float;
+  using MetricImageType = itk::Image<MetricPixelType, Dimension>;
+
+  using VectorType = itk::Vector<MetricPixelType, Dimension>;
+  using DisplacementImageType = itk::Image<VectorType, Dimension>;
+
+  using CoordRepType = double;
+
+  using ReaderType = itk::ImageFileReader<InputImageType>;
+  ReaderType::Pointer fixedReader = ReaderType::New();
+  fixedReader->SetFileName(argv[1]);
+  ReaderType::Pointer movingReader = ReaderType::New();
+  movingReader->SetFileName(argv[2]);
+
+  using SearchRegionInitializerType = itk::BlockMatching::SearchRegionImageInitializer<InputImageType, InputImageType>;
+  SearchRegionInitializerType::Pointer searchRegions = SearchRegionInitializerType::New();
+  searchRegions->SetFixedImage(fixedReader->GetOutput());
+  searchRegions->SetMovingImage(movingReader->GetOutput());
+  RadiusType blockRadius;
+  blockRadius[0] = 20;
+  blockRadius[1] = 4;
+  RadiusType searchRadius;
+  searchRadius[0] = 130;
+  searchRadius[1] = 5;
+  searchRegions->SetFixedBlockRadius(blockRadius);
+  searchRegions->SetSearchRegionRadius(searchRadius);
+
+  using MetricImageFilterType = itk::BlockMatching::
+    NormalizedCrossCorrelationKernelMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+  using MaximumPixelCalculatorType =
+    itk::BlockMatching::MaximumPixelDisplacementCalculator<MetricImageType, DisplacementImageType>;
+  using ParabolicCalculatorType =
+    itk::BlockMatching::ParabolicInterpolationDisplacementCalculator<MetricImageType, DisplacementImageType>;
+
+  using RegistrationMethodType = itk::BlockMatching::
+    ImageRegistrationMethod<InputImageType, InputImageType, MetricImageType, DisplacementImageType, CoordRepType>;
+  RegistrationMethodType::Pointer registrationMethod = RegistrationMethodType::New();
+  registrationMethod->SetFixedImage(fixedReader->GetOutput());
+  registrationMethod->SetMovingImage(movingReader->GetOutput());
+  registrationMethod->SetInput(searchRegions->GetOutput());
+  registrationMethod->SetRadius(blockRadius);
+  registrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+
+  using OpenCLRegistrationMethodType = itk::BlockMatching::
+    OpenCLImageRegistrationMethod<InputImageType, InputImageType, MetricImageType, DisplacementImageType, CoordRepType>;
+  OpenCLRegistrationMethodType::Pointer openCLRegistrationMethod = OpenCLRegistrationMethodType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(openCLRegistrationMethod, OpenCLImageRegistrationMethod, ImageRegistrationMethod);
+
+  openCLRegistrationMethod->SetFixedImage(fixedReader->GetOutput());
+  openCLRegistrationMethod->SetMovingImage(movingReader->GetOutput());
+  openCLRegistrationMethod->SetInput(searchRegions->GetOutput());
+  openCLRegistrationMethod->SetRadius(blockRadius);
+  openCLRegistrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+
+  // The metric images differ by the rounding of the sums, so the peaks may
+  // only move by a fraction of a sample.
+  auto closeDisplacements = [](const DisplacementImageType * expected,
+                               const DisplacementImageType * displacement,
+                               double                        tolerance) {
+    if (displacement->GetBufferedRegion() != expected->GetBufferedRegion())
+    {
+      std::cerr << "Unexpected displacement region " << displacement->GetBufferedRegion() << std::endl;
+      return false;
+    }
+    const DisplacementImageType::SpacingType & spacing = expected->GetSpacing();
+    itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> expectedIt(expected, expected->GetBufferedRegion());
+    itk::SizeValueType                                            mismatches = 0;
+    for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+    {
+      const VectorType difference = displacement->GetPixel(expectedIt.GetIndex()) - expectedIt.Get();
+      for (unsigned int i = 0; i < Dimension; ++i)
+      {
+        if (std::abs(difference[i]) > tolerance * spacing[i])
+        {
+          ++mismatches;
+          break;
+        }
+      }
+    }
+    // Allow for blocks whose two highest peaks are tied up to the rounding.
+    if (mismatches > expected->GetBufferedRegion().GetNumberOfPixels() / 100)
+    {
+      std::cerr << mismatches << " displacement mismatches" << std::endl;
+      return false;
+    }
+    return true;
+  };
+
+  for (unsigned int peaks = 0; peaks < 2; ++peaks)
+  {
+    if (peaks == 0)
+    {
+      registrationMethod->SetMetricImageToDisplacementCalculator(MaximumPixelCalculatorType::New());
+      openCLRegistrationMethod->SetMetricImageToDisplacementCalculator(MaximumPixelCalculatorType::New());
+    }
+    else
+    {
+      registrationMethod->SetMetricImageToDisplacementCalculator(ParabolicCalculatorType::New());
+      openCLRegistrationMethod->SetMetricImageToDisplacementCalculator(ParabolicCalculatorType::New());
+    }
+    ITK_TRY_EXPECT_NO_EXCEPTION(registrationMethod->Update());
+    ITK_TRY_EXPECT_NO_EXCEPTION(openCLRegistrationMethod->Update());
+    ITK_TEST_EXPECT_TRUE(openCLRegistrationMethod->GetMatchedOnDevice());
+    if (!closeDisplacements(registrationMethod->GetOutput(), openCLRegistrationMethod->GetOutput(), 1e-3))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // With slabs, the superclass matches the blocks.
+  openCLRegistrationMethod->SetNumberOfSlabs(2);
+  ITK_TRY_EXPECT_NO_EXCEPTION(openCLRegistrationMethod->Update());
+  ITK_TEST_EXPECT_TRUE(!openCLRegistrationMethod->GetMatchedOnDevice());
+  if (!closeDisplacements(registrationMethod->GetOutput(), openCLRegistrationMethod->GetOutput(), 0.0))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,214 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+#include "itkBlockMatchingSumOfAbsoluteDifferencesMetricImageFilter.h"
+#include "itkBlockMatchingSumOfSquaredDifferencesMetricImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using InputImageType = itk::Image<signed short, Dimension>;
+using MetricImageType = itk::Image<double, Dimension>;
+using RegionType = InputImageType::RegionType;
+
+// The sum of the squared, or absolute, differences of the block with the
+// window centered on a moving image pixel.
+double
+referenceSum(const InputImageType *            fixed,
+             const InputImageType *            moving,
+             const RegionType &                fixedRegion,
+             const InputImageType::IndexType & center,
+             bool                              squared)
+{
+  RegionType                windowRegion = fixedRegion;
+  InputImageType::IndexType windowIndex;
+  for (unsigned int i = 0; i < Dimension; ++i)
+  {
+    windowIndex[i] = center[i] - static_cast<itk::IndexValueType>(fixedRegion.GetSize()[i] / 2);
+  }
+  windowRegion.SetIndex(windowIndex);
+
+  itk::ImageRegionConstIterator<InputImageType> fixedIt(fixed, fixedRegion);
+  itk::ImageRegionConstIterator<InputImageType> movingIt(moving, windowRegion);
+  double                                        sum = 0.0;
+  for (fixedIt.GoToBegin(), movingIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt, ++movingIt)
+  {
+    const double difference = static_cast<double>(fixedIt.Get()) - static_cast<double>(movingIt.Get());
+    sum += squared ? difference * difference : std::abs(difference);
+  }
+  return sum;
+}
+
+
+// Check the metric image of the block over the search region, and that its
+// maximum is at the displacement.  With early termination, the maximum is the
+// same, and the other metric values are at least the full ones.
+template <typename TFilter>
+bool
+checkMetric(const InputImageType *            fixed,
+            const InputImageType *            moving,
+            const RegionType &                fixedRegion,
+            const RegionType &                movingRegion,
+            const InputImageType::IndexType & expectedMaximum,
+            bool                              squared,
+            bool                              earlyTermination)
+{
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetFixedImage(const_cast<InputImageType *>(fixed));
+  filter->SetMovingImage(const_cast<InputImageType *>(moving));
+  filter->SetFixedImageRegion(fixedRegion);
+  filter->SetMovingImageRegion(movingRegion);
+  filter->SetEarlyTermination(earlyTermination);
+  try
+  {
+    filter->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+
+  const MetricImageType *                                 metric = filter->GetOutput();
+  itk::ImageRegionConstIteratorWithIndex<MetricImageType> metricIt(metric, metric->GetBufferedRegion());
+  InputImageType::IndexType                               maximum;
+  double                                                  maximumValue = itk::NumericTraits<double>::NonpositiveMin();
+  for (metricIt.GoToBegin(); !metricIt.IsAtEnd(); ++metricIt)
+  {
+    InputImageType::IndexType center;
+    for (unsigned int i = 0; i < Dimension; ++i)
+    {
+      center[i] = movingRegion.GetIndex()[i] + metricIt.GetIndex()[i];
+    }
+    const double expected = -referenceSum(fixed, moving, fixedRegion, center, squared);
+    if (earlyTermination ? metricIt.Get() < expected : metricIt.Get() != expected)
+    {
+      std::cerr << "Metric mismatch at " << metricIt.GetIndex() << ": expected " << expected << ", got "
+                << metricIt.Get() << std::endl;
+      return false;
+    }
+    if (metricIt.Get() > maximumValue)
+    {
+      maximumValue = metricIt.Get();
+      maximum = center;
+    }
+  }
+  if (maximum != expectedMaximum || maximumValue != 0.0)
+  {
+    std::cerr << "Expected the maximum 0 at " << expectedMaximum << ", got " << maximumValue << " at " << maximum
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkBlockMatchingSumOfDifferencesMetricImageFilterTest(int, char *[])
+{
+  // Radio frequency like samples, and the moving image is the fixed image
+  // displaced by (3, -2).
+  InputImageType::SizeType size;
+  size[0] = 80;
+  size[1] = 40;
+  InputImageType::Pointer fixed = InputImageType::New();
+  fixed->SetRegions(size);
+  fixed->Allocate();
+  InputImageType::Pointer moving = InputImageType::New();
+  moving->SetRegions(size);
+  moving->Allocate();
+  moving->FillBuffer(0);
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(13);
+  itk::ImageRegionIterator<InputImageType> fixedIt(fixed, fixed->GetLargestPossibleRegion());
+  for (fixedIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt)
+  {
+    fixedIt.Set(static_cast<signed short>(static_cast<int>(generator->GetIntegerVariate(60000)) - 30000));
+  }
+  InputImageType::OffsetType displacement;
+  displacement[0] = 3;
+  displacement[1] = -2;
+  for (fixedIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt)
+  {
+    const InputImageType::IndexType movingIndex = fixedIt.GetIndex() + displacement;
+    if (moving->GetLargestPossibleRegion().IsInside(movingIndex))
+    {
+      moving->SetPixel(movingIndex, fixedIt.Get());
+    }
+  }
+
+  using SSDFilterType =
+    itk::BlockMatching::SumOfSquaredDifferencesMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+  using SADFilterType =
+    itk::BlockMatching::SumOfAbsoluteDifferencesMetricImageFilter<InputImageType, InputImageType, MetricImageType>;
+  SSDFilterType::Pointer ssdFilter = SSDFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(
+    ssdFilter, SumOfSquaredDifferencesMetricImageFilter, SumOfDifferencesMetricImageFilter);
+  ITK_TEST_SET_GET_BOOLEAN(ssdFilter, EarlyTermination, false);
+  SADFilterType::Pointer sadFilter = SADFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(
+    sadFilter, SumOfAbsoluteDifferencesMetricImageFilter, SumOfDifferencesMetricImageFilter);
+
+  RegionType::IndexType fixedIndex;
+  fixedIndex[0] = 36;
+  fixedIndex[1] = 17;
+  RegionType::SizeType fixedSize;
+  fixedSize[0] = 9;
+  fixedSize[1] = 5;
+  const RegionType      fixedRegion(fixedIndex, fixedSize);
+  RegionType::IndexType movingIndex;
+  movingIndex[0] = 30;
+  movingIndex[1] = 12;
+  RegionType::SizeType movingSize;
+  movingSize[0] = 21;
+  movingSize[1] = 11;
+  const RegionType          movingRegion(movingIndex, movingSize);
+  InputImageType::IndexType expectedMaximum;
+  for (unsigned int i = 0; i < Dimension; ++i)
+  {
+    expectedMaximum[i] = fixedIndex[i] + static_cast<itk::IndexValueType>(fixedSize[i] / 2) + displacement[i];
+  }
+
+  for (bool earlyTermination : { false, true })
+  {
+    const bool ssdPassed =
+      checkMetric<SSDFilterType>(fixed, moving, fixedRegion, movingRegion, expectedMaximum, true, earlyTermination);
+    const bool sadPassed =
+      checkMetric<SADFilterType>(fixed, moving, fixedRegion, movingRegion, expectedMaximum, false, earlyTermination);
+    if (!ssdPassed || !sadPassed)
+    {
+      std::cerr << "EarlyTermination: " << earlyTermination << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
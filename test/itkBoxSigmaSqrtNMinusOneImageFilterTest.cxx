@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+#include "itkBoxSigmaSqrtNMinusOneImageFilter.h"
+
+int
+itkBoxSigmaSqrtNMinusOneImageFilterTest(int, char *[])
+{
+  const unsigned int Dimension = 2;
+  using InputImageType = itk::Image<float, Dimension>;
+  using OutputImageType = itk::Image<double, Dimension>;
+
+  // Small variations on a large offset, where the sums of squares cancel.
+  InputImageType::Pointer  input = InputImageType::New();
+  InputImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 23;
+  input->SetRegions(size);
+  input->Allocate();
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(42);
+  itk::ImageRegionIterator<InputImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(static_cast<float>(1.0e4 + generator->GetUniformVariate(-1.0, 1.0)));
+  }
+
+  using FilterType = itk::BoxSigmaSqrtNMinusOneImageFilter<InputImageType, OutputImageType>;
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, BoxSigmaSqrtNMinusOneImageFilter, BoxImageFilter);
+
+  FilterType::RadiusType radius;
+  radius[0] = 4;
+  radius[1] = 2;
+  filter->SetRadius(radius);
+  filter->SetInput(input);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+
+  // Compare with the sums over each box, cropped by the image, including the
+  // boundary faces.
+  const InputImageType::RegionType                       region = input->GetLargestPossibleRegion();
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> sigmaIt(filter->GetOutput(), region);
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> meanIt(filter->GetMeanOutput(), region);
+  for (sigmaIt.GoToBegin(), meanIt.GoToBegin(); !sigmaIt.IsAtEnd(); ++sigmaIt, ++meanIt)
+  {
+    InputImageType::IndexType boxIndex = sigmaIt.GetIndex();
+    InputImageType::SizeType  boxSize;
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      boxIndex[dim] -= radius[dim];
+      boxSize[dim] = 2 * radius[dim] + 1;
+    }
+    InputImageType::RegionType box(boxIndex, boxSize);
+    box.Crop(region);
+
+    double                                        mean = 0.0;
+    itk::ImageRegionConstIterator<InputImageType> boxIt(input, box);
+    for (boxIt.GoToBegin(); !boxIt.IsAtEnd(); ++boxIt)
+    {
+      mean += boxIt.Get();
+    }
+    mean /= box.GetNumberOfPixels();
+    double pseudoSigma = 0.0;
+    for (boxIt.GoToBegin(); !boxIt.IsAtEnd(); ++boxIt)
+    {
+      pseudoSigma += (boxIt.Get() - mean) * (boxIt.Get() - mean);
+    }
+    pseudoSigma = std::sqrt(pseudoSigma);
+
+    if (std::abs(sigmaIt.Get() - pseudoSigma) > 1e-6 * pseudoSigma + 1e-9)
+    {
+      std::cerr << "Pseudo sigma mismatch at " << sigmaIt.GetIndex() << ": expected " << pseudoSigma << ", got "
+                << sigmaIt.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (std::abs(meanIt.Get() - mean) > 1e-9 * std::abs(mean))
+    {
+      std::cerr << "Mean mismatch at " << meanIt.GetIndex() << ": expected " << mean << ", got " << meanIt.Get()
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
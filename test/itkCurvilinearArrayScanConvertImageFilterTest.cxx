@@ -0,0 +1,149 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkResampleImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include "itkCurvilinearArrayScanConvertImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using PixelType = float;
+using CurvilinearImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension>;
+using ImageType = itk::Image<PixelType, Dimension>;
+
+// Compare with a ResampleImageFilter and its linear interpolator.
+bool
+matchesResample(CurvilinearImageType * input, const ImageType * output, PixelType defaultPixelValue)
+{
+  using ResamplerType = itk::ResampleImageFilter<CurvilinearImageType, ImageType>;
+  ResamplerType::Pointer resampler = ResamplerType::New();
+  resampler->SetInput(input);
+  resampler->SetOutputParametersFromImage(output);
+  resampler->SetDefaultPixelValue(defaultPixelValue);
+  try
+  {
+    resampler->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+
+  const ImageType::RegionType                       region = output->GetLargestPossibleRegion();
+  itk::ImageRegionConstIteratorWithIndex<ImageType> outputIt(output, region);
+  itk::ImageRegionConstIteratorWithIndex<ImageType> expectedIt(resampler->GetOutput(), region);
+  for (outputIt.GoToBegin(), expectedIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt, ++expectedIt)
+  {
+    if (std::abs(outputIt.Get() - expectedIt.Get()) > 1e-4 * (1.0 + std::abs(expectedIt.Get())))
+    {
+      std::cerr << "Mismatch at " << outputIt.GetIndex() << ": expected " << expectedIt.Get() << ", got "
+                << outputIt.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkCurvilinearArrayScanConvertImageFilterTest(int, char *[])
+{
+  CurvilinearImageType::SizeType inputSize;
+  inputSize[0] = 96;
+  inputSize[1] = 48;
+  CurvilinearImageType::Pointer input = CurvilinearImageType::New();
+  input->SetRegions(inputSize);
+  input->Allocate();
+  input->SetLateralAngularSeparation((itk::Math::pi / 3.0) / (inputSize[1] - 1));
+  input->SetRadiusSampleSize(0.5);
+  input->SetFirstSampleDistance(10.0);
+  itk::ImageRegionIteratorWithIndex<CurvilinearImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    const CurvilinearImageType::IndexType & index = inputIt.GetIndex();
+    inputIt.Set(static_cast<PixelType>(2.0 + std::sin(0.1 * index[0]) * std::cos(0.2 * index[1])));
+  }
+
+  using FilterType = itk::CurvilinearArrayScanConvertImageFilter<CurvilinearImageType, ImageType>;
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, CurvilinearArrayScanConvertImageFilter, ImageToImageFilter);
+
+  // A field of view larger than the sector, so that some of the output is
+  // outside of the input.
+  FilterType::SizeType size;
+  size[0] = 80;
+  size[1] = 70;
+  filter->SetSize(size);
+  ITK_TEST_SET_GET_VALUE(size, filter->GetSize());
+  FilterType::SpacingType spacing;
+  spacing.Fill(0.8);
+  filter->SetOutputSpacing(spacing);
+  ITK_TEST_SET_GET_VALUE(spacing, filter->GetOutputSpacing());
+  FilterType::PointType origin;
+  origin[0] = -32.0;
+  origin[1] = 5.0;
+  filter->SetOutputOrigin(origin);
+  ITK_TEST_SET_GET_VALUE(origin, filter->GetOutputOrigin());
+  const PixelType defaultPixelValue = -1.0f;
+  filter->SetDefaultPixelValue(defaultPixelValue);
+  ITK_TEST_SET_GET_VALUE(defaultPixelValue, filter->GetDefaultPixelValue());
+  filter->SetInput(input);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfLookupTableBuilds(), 1u);
+  if (!matchesResample(input, filter->GetOutput(), defaultPixelValue))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A new frame with the same geometry reuses the table.
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(inputIt.Get() * 3.0f - 1.0f);
+  }
+  input->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfLookupTableBuilds(), 1u);
+  if (!matchesResample(input, filter->GetOutput(), defaultPixelValue))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A change of the geometry rebuilds it.
+  input->SetRadiusSampleSize(0.6);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfLookupTableBuilds(), 2u);
+  if (!matchesResample(input, filter->GetOutput(), defaultPixelValue))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkTestingMacros.h"
+
+int
+itkCurvilinearArraySpecialCoordinatesImageBatchTransformTest(int, char *[])
+{
+  const unsigned int Dimension = 3;
+  using ImageType = itk::CurvilinearArraySpecialCoordinatesImage<float, Dimension>;
+  using PointType = ImageType::PointType;
+  using ContinuousIndexType = itk::ContinuousIndex<double, Dimension>;
+
+  ImageType::SizeType size;
+  size[0] = 256;
+  size[1] = 128;
+  size[2] = 4;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->SetLateralAngularSeparation((itk::Math::pi / 2.0) / (size[1] - 1));
+  image->SetRadiusSampleSize(0.3);
+  image->SetFirstSampleDistance(12.0);
+  ImageType::SpacingType spacing;
+  spacing.Fill(1.0);
+  spacing[2] = 2.5;
+  image->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin.Fill(0.0);
+  origin[2] = -3.0;
+  image->SetOrigin(origin);
+
+  // The arc tangent, including far from the origin and around zero.
+  double maximumError = 0.0;
+  for (double value = -1.0e4; value <= 1.0e4; value += 0.37)
+  {
+    maximumError = std::max(maximumError, std::abs(ImageType::ApproximateArcTangent(value) - std::atan(value)));
+  }
+  for (double value = -2.0; value <= 2.0; value += 1.0e-4)
+  {
+    maximumError = std::max(maximumError, std::abs(ImageType::ApproximateArcTangent(value) - std::atan(value)));
+  }
+  std::cout << "Maximum arc tangent error: " << maximumError << std::endl;
+  ITK_TEST_EXPECT_TRUE(maximumError < 1.0e-7);
+  ITK_TEST_EXPECT_EQUAL(ImageType::ApproximateArcTangent(0.0), 0.0);
+
+  // Points on a grid that covers the sector, the points behind the
+  // transducer and the x axis.
+  std::vector<PointType> points;
+  for (double x = -60.0; x <= 60.0; x += 1.7)
+  {
+    for (double y = -20.0; y <= 90.0; y += 2.5)
+    {
+      for (double z = -4.0; z <= 8.0; z += 3.1)
+      {
+        PointType point;
+        point[0] = x;
+        point[1] = y;
+        point[2] = z;
+        points.push_back(point);
+      }
+    }
+  }
+  const itk::SizeValueType numberOfPoints = points.size();
+
+  std::vector<ContinuousIndexType> indices(numberOfPoints);
+  std::unique_ptr<bool[]>          isInside(new bool[numberOfPoints]);
+  image->TransformPhysicalPointsToContinuousIndices(points.data(), indices.data(), numberOfPoints, isInside.get());
+  itk::SizeValueType numberOfPointsInside = 0;
+  for (itk::SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+  {
+    ContinuousIndexType expected;
+    const bool          expectedIsInside = image->TransformPhysicalPointToContinuousIndex(points[ii], expected);
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      if (std::abs(indices[ii][dim] - expected[dim]) > 1.0e-5)
+      {
+        std::cerr << "Index mismatch for " << points[ii] << ": expected " << expected << ", got " << indices[ii]
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    // Away from the edges, where the rounding of the arc tangent can differ.
+    bool nearEdge = false;
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      nearEdge |= std::abs(expected[dim] + 0.5) < 1.0e-4 || std::abs(expected[dim] - (size[dim] - 0.5)) < 1.0e-4;
+    }
+    if (!nearEdge && isInside[ii] != expectedIsInside)
+    {
+      std::cerr << "Inside mismatch for " << points[ii] << std::endl;
+      return EXIT_FAILURE;
+    }
+    numberOfPointsInside += isInside[ii];
+  }
+  std::cout << numberOfPointsInside << " of " << numberOfPoints << " points are inside" << std::endl;
+  ITK_TEST_EXPECT_TRUE(numberOfPointsInside > 0);
+  ITK_TEST_EXPECT_TRUE(numberOfPointsInside < numberOfPoints);
+
+  // The indices map back to the points.
+  std::vector<PointType> roundTrip(numberOfPoints);
+  image->TransformContinuousIndicesToPhysicalPoints(indices.data(), roundTrip.data(), numberOfPoints);
+  for (itk::SizeValueType ii = 0; ii < numberOfPoints; ++ii)
+  {
+    PointType expected;
+    image->TransformContinuousIndexToPhysicalPoint(indices[ii], expected);
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      if (std::abs(roundTrip[ii][dim] - expected[dim]) > 1.0e-9 * (1.0 + std::abs(expected[dim])))
+      {
+        std::cerr << "Point mismatch for " << indices[ii] << ": expected " << expected << ", got " << roundTrip[ii]
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    if (points[ii][1] > 0.0 && points[ii].EuclideanDistanceTo(roundTrip[ii]) > 1.0e-5)
+    {
+      std::cerr << "Round trip mismatch for " << points[ii] << ": got " << roundTrip[ii] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
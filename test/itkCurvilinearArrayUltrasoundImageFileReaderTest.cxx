@@ -49,5 +49,17 @@ itkCurvilinearArrayUltrasoundImageFileReaderTest(int argc, char * argv[])
   ITK_TEST_EXPECT_EQUAL(image->GetRadiusSampleSize(), 0.0513434294);
   ITK_TEST_EXPECT_EQUAL(image->GetFirstSampleDistance(), 26.4);
 
+  // The geometry without the pixels.
+  ReaderType::Pointer headerReader = ReaderType::New();
+  headerReader->SetFileName(inputImageFileName);
+  ITK_TEST_SET_GET_BOOLEAN(headerReader, HeaderOnly, true);
+  ITK_TRY_EXPECT_NO_EXCEPTION(headerReader->Update());
+  SpecialCoordinatesImageType::ConstPointer header = headerReader->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(header->GetLargestPossibleRegion(), image->GetLargestPossibleRegion());
+  ITK_TEST_EXPECT_EQUAL(header->GetBufferedRegion().GetNumberOfPixels(), 0);
+  ITK_TEST_EXPECT_EQUAL(header->GetLateralAngularSeparation(), image->GetLateralAngularSeparation());
+  ITK_TEST_EXPECT_EQUAL(header->GetRadiusSampleSize(), image->GetRadiusSampleSize());
+  ITK_TEST_EXPECT_EQUAL(header->GetFirstSampleDistance(), image->GetFirstSampleDistance());
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkDelayAndSumBeamformingImageFilter.h"
+
+namespace
+{
+
+using PixelType = float;
+using ChannelImageType = itk::Image<PixelType, 3>;
+using RFImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, 2>;
+using FilterType = itk::DelayAndSumBeamformingImageFilter<ChannelImageType, RFImageType>;
+
+const double speedOfSound = 1.54e6;
+const double samplingFrequency = 40.0e6;
+const double centerFrequency = 5.0e6;
+const double probeRadius = 40.0;
+const double angularSeparation = 0.01;
+
+} // namespace
+
+int
+itkDelayAndSumBeamformingImageFilterTest(int, char *[])
+{
+  // The echoes of a point scatterer on the middle line, 20 mm deep, received
+  // by every element for every transmit event.
+  const itk::SizeValueType numberOfChannelSamples = 2048;
+  const itk::SizeValueType numberOfElements = 64;
+  const itk::SizeValueType numberOfLines = 33;
+  ChannelImageType::SizeType channelSize;
+  channelSize[0] = numberOfChannelSamples;
+  channelSize[1] = numberOfElements;
+  channelSize[2] = numberOfLines;
+  ChannelImageType::Pointer channels = ChannelImageType::New();
+  channels->SetRegions(channelSize);
+  channels->Allocate();
+
+  const double scattererRadius = probeRadius + 20.0;
+  const double scattererAngle = 0.0;
+  const auto   elementAngle = [](itk::SizeValueType element) {
+    return (element - (numberOfElements - 1) / 2.0) * angularSeparation;
+  };
+  const auto lineAngle = [](itk::SizeValueType line) {
+    return (line - (numberOfLines - 1) / 2.0) * angularSeparation;
+  };
+  const auto distance = [](double radius0, double angle0, double radius1, double angle1) {
+    return std::sqrt(radius0 * radius0 + radius1 * radius1 - 2.0 * radius0 * radius1 * std::cos(angle0 - angle1));
+  };
+  itk::ImageRegionIteratorWithIndex<ChannelImageType> channelIt(channels, channels->GetLargestPossibleRegion());
+  for (channelIt.GoToBegin(); !channelIt.IsAtEnd(); ++channelIt)
+  {
+    const ChannelImageType::IndexType & index = channelIt.GetIndex();
+    const double echoTime = (distance(probeRadius, lineAngle(index[2]), scattererRadius, scattererAngle) +
+                             distance(probeRadius, elementAngle(index[1]), scattererRadius, scattererAngle)) /
+                            speedOfSound;
+    const double phase = (index[0] / samplingFrequency - echoTime) * centerFrequency;
+    channelIt.Set(static_cast<PixelType>(std::exp(-phase * phase) * std::cos(2.0 * itk::Math::pi * phase)));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, DelayAndSumBeamformingImageFilter, ImageToImageFilter);
+
+  filter->SetInput(channels);
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  ITK_TEST_SET_GET_VALUE(1.54e6, filter->GetSpeedOfSound());
+  filter->SetSpeedOfSound(speedOfSound);
+  filter->SetSamplingFrequency(samplingFrequency);
+  ITK_TEST_SET_GET_VALUE(samplingFrequency, filter->GetSamplingFrequency());
+  filter->SetProbeRadius(probeRadius);
+  ITK_TEST_SET_GET_VALUE(probeRadius, filter->GetProbeRadius());
+  filter->SetElementAngularSeparation(angularSeparation);
+  ITK_TEST_SET_GET_VALUE(angularSeparation, filter->GetElementAngularSeparation());
+  ITK_TEST_SET_GET_VALUE(1.5, filter->GetFNumber());
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 1u);
+
+  // One line per transmit event, with the samples of the channel data, from
+  // the face of the probe.
+  const RFImageType *         rf = filter->GetOutput();
+  const RFImageType::SizeType rfSize = rf->GetLargestPossibleRegion().GetSize();
+  ITK_TEST_EXPECT_EQUAL(rfSize[0], numberOfChannelSamples);
+  ITK_TEST_EXPECT_EQUAL(rfSize[1], numberOfLines);
+  ITK_TEST_EXPECT_EQUAL(rf->GetLateralAngularSeparation(), angularSeparation);
+  ITK_TEST_EXPECT_EQUAL(rf->GetFirstSampleDistance(), probeRadius);
+  const double radiusSampleSize = speedOfSound / (2.0 * samplingFrequency);
+  ITK_TEST_EXPECT_TRUE(std::abs(rf->GetRadiusSampleSize() - radiusSampleSize) < 1e-12);
+
+  // The scatterer is focused on the middle line at its depth.
+  const auto findPeak = [](const RFImageType * image, RFImageType::IndexType & peakIndex) {
+    PixelType                                           peak = 0.0f;
+    itk::ImageRegionConstIteratorWithIndex<RFImageType> it(image, image->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (std::abs(it.Get()) > peak)
+      {
+        peak = std::abs(it.Get());
+        peakIndex = it.GetIndex();
+      }
+    }
+    return peak;
+  };
+  const double           scattererSample = (scattererRadius - probeRadius) / radiusSampleSize;
+  RFImageType::IndexType peakIndex;
+  const PixelType        peak = findPeak(rf, peakIndex);
+  std::cout << "Peak " << peak << " at " << peakIndex << std::endl;
+  ITK_TEST_EXPECT_EQUAL(peakIndex[1], static_cast<itk::IndexValueType>(numberOfLines / 2));
+  ITK_TEST_EXPECT_TRUE(std::abs(peakIndex[0] - scattererSample) <= 2.0);
+
+  // A sample off the peak, recomputed from the definition.
+  RFImageType::IndexType sampleIndex;
+  sampleIndex[0] = 700;
+  sampleIndex[1] = 10;
+  double expected = 0.0;
+  {
+    const double radius = probeRadius + sampleIndex[0] * radiusSampleSize;
+    const double apertureHalfWidth = (radius - probeRadius) / (2.0 * 1.5);
+    for (itk::SizeValueType element = 0; element < numberOfElements; ++element)
+    {
+      const double arc = probeRadius * std::abs(lineAngle(sampleIndex[1]) - elementAngle(element));
+      if (arc > apertureHalfWidth)
+      {
+        continue;
+      }
+      const double weight = 0.5 * (1.0 + std::cos(itk::Math::pi * arc / apertureHalfWidth));
+      const double receiveDistance = distance(radius, lineAngle(sampleIndex[1]), probeRadius, elementAngle(element));
+      const double delay = (radius - probeRadius + receiveDistance) * samplingFrequency / speedOfSound;
+      ChannelImageType::IndexType channelIndex;
+      channelIndex[0] = static_cast<itk::IndexValueType>(delay);
+      channelIndex[1] = element;
+      channelIndex[2] = sampleIndex[1];
+      const double before = channels->GetPixel(channelIndex);
+      ++channelIndex[0];
+      const double after = channels->GetPixel(channelIndex);
+      const double fraction = delay - std::floor(delay);
+      expected += weight * (before + fraction * (after - before));
+    }
+  }
+  std::cout << "Sample " << sampleIndex << ": " << rf->GetPixel(sampleIndex) << ", expected " << expected << std::endl;
+  ITK_TEST_EXPECT_TRUE(std::abs(rf->GetPixel(sampleIndex) - expected) < 1e-3 * (1.0 + peak));
+
+  // A new frame with the same geometry reuses the table.
+  for (channelIt.GoToBegin(); !channelIt.IsAtEnd(); ++channelIt)
+  {
+    channelIt.Set(2.0f * channelIt.Get());
+  }
+  channels->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 1u);
+  ITK_TEST_EXPECT_TRUE(std::abs(filter->GetOutput()->GetPixel(peakIndex) - 2.0f * peak) < 1e-3 * peak);
+
+  // A new aperture does not, and the full aperture still focuses on the
+  // scatterer.
+  filter->SetFNumber(0.0);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 2u);
+  RFImageType::IndexType fullAperturePeakIndex;
+  findPeak(filter->GetOutput(), fullAperturePeakIndex);
+  ITK_TEST_EXPECT_EQUAL(fullAperturePeakIndex[1], peakIndex[1]);
+  ITK_TEST_EXPECT_TRUE(std::abs(fullAperturePeakIndex[0] - scattererSample) <= 2.0);
+
+  // Fewer, coarser output samples.
+  filter->SetNumberOfOutputSamples(512);
+  filter->SetRadiusSampleSize(4.0 * radiusSampleSize);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleRegion().GetSize(0), 512u);
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 3u);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itksys/SystemTools.hxx"
+
+#include "itkDistributedSlabProcessor.h"
+#include "itkNakagamiImageFilter.h"
+
+namespace
+{
+
+using ImageType = itk::Image<float, 3>;
+using NakagamiFilterType = itk::NakagamiImageFilter<ImageType, ImageType>;
+using ProcessorType = itk::DistributedSlabProcessor<ImageType, ImageType>;
+
+// Process every shard of the volume, as the ranks would, merge them, and
+// count the merged samples that differ from the expected ones.  Throws when
+// a shard or the merged output is missing.
+itk::SizeValueType
+CountMismatches(const char * inputFileName, const char * outputFileName, itk::SizeValueType margin,
+                const ImageType * expected)
+{
+  NakagamiFilterType::RadiusType radius;
+  radius.Fill(1);
+  auto filter = NakagamiFilterType::New();
+  filter->SetRadius(radius);
+
+  const unsigned int numberOfRanks = 3;
+  for (unsigned int rank = 0; rank < numberOfRanks; ++rank)
+  {
+    auto processor = ProcessorType::New();
+    processor->SetInputFileName(inputFileName);
+    processor->SetOutputFileName(outputFileName);
+    processor->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+    processor->SetOutputImageIO(itk::HDF5UltrasoundImageIO::New());
+    processor->SetFilter(filter);
+    processor->SetMargin(margin);
+    processor->SetRank(rank);
+    processor->SetNumberOfRanks(numberOfRanks);
+    processor->ProcessShard();
+    if (!itksys::SystemTools::FileExists(processor->GetShardFileName(rank)))
+    {
+      itkGenericExceptionMacro(<< "No shard was written for rank " << rank);
+    }
+  }
+  auto processor = ProcessorType::New();
+  processor->SetInputFileName(inputFileName);
+  processor->SetOutputFileName(outputFileName);
+  processor->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  processor->SetOutputImageIO(itk::HDF5UltrasoundImageIO::New());
+  processor->SetFilter(filter);
+  processor->SetNumberOfRanks(numberOfRanks);
+  processor->MergeShards();
+
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  auto reader = ReaderType::New();
+  reader->SetFileName(outputFileName);
+  reader->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  reader->Update();
+  const ImageType * merged = reader->GetOutput();
+  if (merged->GetLargestPossibleRegion().GetSize() != expected->GetLargestPossibleRegion().GetSize())
+  {
+    itkGenericExceptionMacro(<< "The merged output has the size " << merged->GetLargestPossibleRegion().GetSize());
+  }
+
+  itk::SizeValueType                                mismatches = 0;
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(expected, expected->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const double value = merged->GetPixel(it.GetIndex());
+    if (std::abs(value - it.Get()) > 1e-3 * std::abs(it.Get()))
+    {
+      ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+} // namespace
+
+int
+itkDistributedSlabProcessorTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputImage outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * inputFileName = argv[1];
+  const char * outputFileName = argv[2];
+
+  // A Rayleigh envelope, with 9 slices.
+  ImageType::SizeType size;
+  size[0] = 20;
+  size[1] = 12;
+  size[2] = 9;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  unsigned int                                 state = 12345u;
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIt(image, image->GetLargestPossibleRegion());
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+  {
+    state = 1664525u * state + 1013904223u;
+    const double uniform = (static_cast<double>(state >> 8) + 0.5) / 16777216.0;
+    imageIt.Set(static_cast<float>(std::sqrt(-2.0 * std::log(uniform))));
+  }
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  auto writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(inputFileName);
+  writer->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
+
+  auto processor = ProcessorType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(processor, DistributedSlabProcessor, Object);
+
+  ITK_TEST_SET_GET_VALUE(2u, processor->GetSlabDimension());
+  ITK_TEST_SET_GET_VALUE(0, processor->GetMargin());
+
+  // Nearly equal slabs that cover the region.
+  const ImageType::RegionType region = image->GetLargestPossibleRegion();
+  for (unsigned int numberOfRanks = 1; numberOfRanks <= 4; ++numberOfRanks)
+  {
+    itk::SizeValueType covered = 0;
+    for (unsigned int rank = 0; rank < numberOfRanks; ++rank)
+    {
+      const ImageType::RegionType slab = ProcessorType::ComputeSlabRegion(region, 2, rank, numberOfRanks);
+      ITK_TEST_EXPECT_EQUAL(slab.GetIndex(2), static_cast<itk::IndexValueType>(covered));
+      ITK_TEST_EXPECT_TRUE(slab.GetSize(2) == size[2] / numberOfRanks ||
+                           slab.GetSize(2) == size[2] / numberOfRanks + 1);
+      ITK_TEST_EXPECT_EQUAL(slab.GetSize(0), size[0]);
+      covered += slab.GetSize(2);
+    }
+    ITK_TEST_EXPECT_EQUAL(covered, size[2]);
+  }
+
+  // The shard file names are distinct, and keep the extension.
+  processor->SetOutputFileName("/tmp/output.hdf5");
+  ITK_TEST_EXPECT_EQUAL(processor->GetShardFileName(2), std::string("/tmp/output.shard2.hdf5"));
+
+  // Errors.
+  processor->SetOutputFileName(outputFileName);
+  ITK_TRY_EXPECT_EXCEPTION(processor->ProcessShard());
+  processor->SetInputFileName(inputFileName);
+  processor->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  processor->SetOutputImageIO(itk::HDF5UltrasoundImageIO::New());
+  auto filter = NakagamiFilterType::New();
+  processor->SetFilter(filter);
+  processor->SetNumberOfRanks(3);
+  processor->SetRank(3);
+  ITK_TRY_EXPECT_EXCEPTION(processor->ProcessShard());
+  processor->SetNumberOfRanks(10);
+  processor->SetRank(0);
+  ITK_TRY_EXPECT_EXCEPTION(processor->ProcessShard());
+
+  // The middle slab with its margins.
+  processor->SetNumberOfRanks(3);
+  processor->SetRank(1);
+  processor->SetMargin(2);
+  ITK_TRY_EXPECT_NO_EXCEPTION(processor->ProcessShard());
+  ITK_TEST_EXPECT_EQUAL(processor->GetSlabRegion().GetIndex(2), 3);
+  ITK_TEST_EXPECT_EQUAL(processor->GetSlabRegion().GetSize(2), 3);
+  ITK_TEST_EXPECT_EQUAL(processor->GetPaddedSlabRegion().GetIndex(2), 1);
+  ITK_TEST_EXPECT_EQUAL(processor->GetPaddedSlabRegion().GetSize(2), 7);
+  // The first slab is cropped to the volume.
+  processor->SetRank(0);
+  ITK_TRY_EXPECT_NO_EXCEPTION(processor->ProcessShard());
+  ITK_TEST_EXPECT_EQUAL(processor->GetPaddedSlabRegion().GetIndex(2), 0);
+  ITK_TEST_EXPECT_EQUAL(processor->GetPaddedSlabRegion().GetSize(2), 5);
+
+  // The whole volume on one node.
+  auto reader = itk::ImageFileReader<ImageType>::New();
+  reader->SetFileName(inputFileName);
+  reader->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  NakagamiFilterType::RadiusType radius;
+  radius.Fill(1);
+  auto wholeFilter = NakagamiFilterType::New();
+  wholeFilter->SetRadius(radius);
+  wholeFilter->SetInput(reader->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(wholeFilter->Update());
+
+  // With a margin of the box radius, the merged shards are the whole volume
+  // result.  Without, the slices next to the slab boundaries differ.
+  itk::SizeValueType mismatches = 0;
+  ITK_TRY_EXPECT_NO_EXCEPTION(mismatches = CountMismatches(inputFileName, outputFileName, 1, wholeFilter->GetOutput()));
+  std::cout << "Mismatches with a margin: " << mismatches << std::endl;
+  ITK_TEST_EXPECT_EQUAL(mismatches, 0);
+  ITK_TRY_EXPECT_NO_EXCEPTION(mismatches = CountMismatches(inputFileName, outputFileName, 0, wholeFilter->GetOutput()));
+  std::cout << "Mismatches without a margin: " << mismatches << std::endl;
+  ITK_TEST_EXPECT_TRUE(mismatches > 0);
+
+  return EXIT_SUCCESS;
+}
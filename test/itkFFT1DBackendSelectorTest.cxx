@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "itkImage.h"
+
+#include "itkForward1DFFTImageFilter.h"
+#include "itkInverse1DFFTImageFilter.h"
+#include "itkFFT1DBackendSelector.h"
+
+int
+itkFFT1DBackendSelectorTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " cacheFile";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string cacheFileName = argv[1];
+
+  using PixelType = float;
+  const unsigned int Dimension = 2;
+
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PixelType>, Dimension>;
+  using ForwardType = itk::Forward1DFFTImageFilter<ImageType, ComplexImageType>;
+  using InverseType = itk::Inverse1DFFTImageFilter<ComplexImageType, ImageType>;
+  using SelectorType = itk::FFT1DBackendSelector;
+
+  try
+  {
+    SelectorType::SetOverride(SelectorType::DEFAULT_BACKEND);
+    SelectorType::Clear();
+    std::remove(cacheFileName.c_str());
+    SelectorType::SetCacheFileName(cacheFileName);
+
+    // The backends are timed once, and the choice is recorded.
+    ForwardType::Pointer forward = ForwardType::NewForGeometry(64, 16);
+    InverseType::Pointer inverse = InverseType::NewForGeometry(64, 16);
+    if (forward.IsNull() || inverse.IsNull())
+    {
+      std::cerr << "Expected filters for the geometry" << std::endl;
+      return EXIT_FAILURE;
+    }
+    SelectorType::BackendType backend = SelectorType::DEFAULT_BACKEND;
+    if (!SelectorType::Lookup("Forward", 64, 16, sizeof(PixelType), backend) ||
+        backend == SelectorType::DEFAULT_BACKEND)
+    {
+      std::cerr << "Expected a recorded choice for the forward transform" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Fastest forward backend: " << SelectorType::GetBackendName(backend) << std::endl;
+
+    // The choices persist in the cache file.
+    SelectorType::Clear();
+    SelectorType::SetCacheFileName(cacheFileName);
+    SelectorType::BackendType reloaded = SelectorType::DEFAULT_BACKEND;
+    if (!SelectorType::Lookup("Forward", 64, 16, sizeof(PixelType), reloaded) || reloaded != backend)
+    {
+      std::cerr << "Expected the choice to be reloaded from " << cacheFileName << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The override takes precedence, for New() as well.
+    SelectorType::SetOverride(SelectorType::VNL_BACKEND);
+    ForwardType::Pointer overridden = ForwardType::New();
+    ForwardType::Pointer overriddenForGeometry = ForwardType::NewForGeometry(64, 16);
+    SelectorType::SetOverride(SelectorType::DEFAULT_BACKEND);
+    if (std::strcmp(overridden->GetNameOfClass(), "VnlForward1DFFTImageFilter") != 0 ||
+        std::strcmp(overriddenForGeometry->GetNameOfClass(), "VnlForward1DFFTImageFilter") != 0)
+    {
+      std::cerr << "Expected the override to select Vnl, got " << overridden->GetNameOfClass() << " and "
+                << overriddenForGeometry->GetNameOfClass() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  catch (itk::ExceptionObject & excep)
+  {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  SelectorType::SetCacheFileName("");
+  SelectorType::Clear();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Throughput of the 1D FFT backends and of the analytic signal.
+
+#include <complex>
+#include <iostream>
+#include <string>
+
+#include "itkImage.h"
+
+#include "itkAnalyticSignalImageFilter.h"
+#include "itkFFT1DBackendSelector.h"
+#include "itkForward1DFFTImageFilter.h"
+#include "itkInverse1DFFTImageFilter.h"
+#include "itkUltrasoundBenchmark.h"
+
+int
+itkFFT1DBenchmark(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " outputJSON [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const unsigned int repetitions = (argc > 2) ? std::stoi(argv[2]) : 10;
+
+  using PixelType = float;
+  const unsigned int Dimension = 2;
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PixelType>, Dimension>;
+  using ForwardType = itk::Forward1DFFTImageFilter<ImageType, ComplexImageType>;
+  using InverseType = itk::Inverse1DFFTImageFilter<ComplexImageType, ImageType>;
+  using AnalyticType = itk::AnalyticSignalImageFilter<ImageType, ComplexImageType>;
+  using SelectorType = itk::FFT1DBackendSelector;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+
+  HarnessType harness("FFT1D");
+
+  // Line lengths of typical RF lines, including a 5-smooth one, by 256
+  // lines.
+  const itk::SizeValueType lineLengths[] = { 256, 1024, 2048, 3000, 4096 };
+  const itk::SizeValueType numberOfLines = 256;
+
+  try
+  {
+    for (const itk::SizeValueType lineLength : lineLengths)
+    {
+      ImageType::SizeType size;
+      size[0] = lineLength;
+      size[1] = numberOfLines;
+      ImageType::Pointer rf = HarnessType::MakeRF<ImageType>(size);
+      const std::string  geometry = HarnessType::GetGeometry(size);
+      const double       samples = static_cast<double>(lineLength * numberOfLines);
+
+      for (const SelectorType::BackendType backend :
+           { SelectorType::VNL_BACKEND, SelectorType::FFTW_BACKEND, SelectorType::OPENCL_BACKEND })
+      {
+        const std::string backendName = SelectorType::GetBackendName(backend);
+        for (const unsigned int threads : HarnessType::GetThreadCounts())
+        {
+          ForwardType::Pointer forward = ForwardType::New(backend);
+          InverseType::Pointer inverse = InverseType::New(backend);
+          if (forward.IsNull() || inverse.IsNull())
+          {
+            break;
+          }
+          forward->SetInput(rf);
+          inverse->SetInput(forward->GetOutput());
+          HarnessType::SetThreads(forward, threads);
+          HarnessType::SetThreads(inverse, threads);
+
+          harness.Run("Forward1DFFT " + backendName, geometry, threads, samples, repetitions, [&forward]() {
+            forward->Modified();
+            forward->Update();
+          });
+          harness.Run("Inverse1DFFT " + backendName, geometry, threads, samples, repetitions, [&inverse]() {
+            inverse->Modified();
+            inverse->Update();
+          });
+
+          // The lines along the slow direction.
+          ForwardType::Pointer transposed = ForwardType::New(backend);
+          transposed->SetInput(rf);
+          transposed->SetDirection(1);
+          HarnessType::SetThreads(transposed, threads);
+          harness.Run(
+            "Forward1DFFT direction 1 " + backendName, geometry, threads, samples, repetitions, [&transposed]() {
+              transposed->Modified();
+              transposed->Update();
+            });
+        }
+      }
+
+      for (const unsigned int threads : HarnessType::GetThreadCounts())
+      {
+        AnalyticType::Pointer analytic = AnalyticType::New();
+        analytic->SetInput(rf);
+        HarnessType::SetThreads(analytic, threads);
+        harness.Run("AnalyticSignal", geometry, threads, samples, repetitions, [&analytic]() {
+          analytic->Modified();
+          analytic->Update();
+        });
+      }
+    }
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!harness.WriteJSON(argv[1]))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionIterator.h"
+
+#if defined(ITK_USE_FFTWD)
+#  include "itkFFTWForward1DFFTImageFilter.h"
+#  include "itkFFTWInverse1DFFTImageFilter.h"
+#endif
+
+int
+itkFFTW1DPlanCacheTest(int, char *[])
+{
+#if defined(ITK_USE_FFTWD)
+  using PixelType = double;
+  const unsigned int Dimension = 2;
+
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PixelType>, Dimension>;
+  using ForwardType = itk::FFTWForward1DFFTImageFilter<ImageType, ComplexImageType>;
+  using InverseType = itk::FFTWInverse1DFFTImageFilter<ComplexImageType, ImageType>;
+  using PlanCacheType = ForwardType::PlanCacheType;
+
+  ImageType::SizeType size;
+  size[0] = 96;
+  size[1] = 16;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+  unsigned int                        count = 0;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++count)
+  {
+    it.Set(static_cast<PixelType>(count % 7) - 3.0);
+  }
+
+  PlanCacheType::Clear();
+
+  try
+  {
+    ForwardType::Pointer forward = ForwardType::New();
+    forward->SetInput(image);
+    forward->Update();
+    if (PlanCacheType::GetNumberOfPlans() == 0)
+    {
+      std::cerr << "Expected the forward filter to populate the plan cache" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A further filter instance with the same geometry is served from the
+    // cache, without planning.
+    const size_t numberOfPlans = PlanCacheType::GetNumberOfPlans();
+    ForwardType::Pointer cachedForward = ForwardType::New();
+    cachedForward->SetInput(image);
+    cachedForward->Update();
+    if (PlanCacheType::GetNumberOfPlans() != numberOfPlans)
+    {
+      std::cerr << "Expected the second forward filter to reuse the cached plans, but the cache went from "
+                << numberOfPlans << " to " << PlanCacheType::GetNumberOfPlans() << " plans" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Line by line or batched, along either direction, the round trip must
+    // reproduce the input.
+    for (unsigned int direction = 0; direction < Dimension; ++direction)
+    {
+      for (unsigned int batched = 0; batched < 2; ++batched)
+      {
+        ForwardType::Pointer roundTripForward = ForwardType::New();
+        roundTripForward->SetInput(image);
+        roundTripForward->SetDirection(direction);
+        roundTripForward->SetBatched(batched != 0);
+
+        InverseType::Pointer roundTripInverse = InverseType::New();
+        roundTripInverse->SetInput(roundTripForward->GetOutput());
+        roundTripInverse->SetDirection(direction);
+        roundTripInverse->SetBatched(batched != 0);
+        roundTripInverse->Update();
+
+        itk::ImageRegionConstIterator<ImageType> inputIt(image, image->GetLargestPossibleRegion());
+        itk::ImageRegionConstIterator<ImageType> outputIt(roundTripInverse->GetOutput(),
+                                                          image->GetLargestPossibleRegion());
+        for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++outputIt)
+        {
+          if (std::abs(inputIt.Get() - outputIt.Get()) > 1e-9)
+          {
+            std::cerr << "Round trip mismatch along direction " << direction << " (batched: " << batched << ") at "
+                      << inputIt.GetIndex() << ": " << inputIt.Get() << " vs. " << outputIt.Get() << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+    forward->Print(std::cout);
+  }
+  catch (itk::ExceptionObject & excep)
+  {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The filters returned their scratch buffers to the pool.
+  using BufferPoolType = ForwardType::BufferPoolType;
+  if (BufferPoolType::GetNumberOfPooledBuffers() == 0)
+  {
+    std::cerr << "Expected the scratch buffers to be returned to the pool" << std::endl;
+    return EXIT_FAILURE;
+  }
+  BufferPoolType::Clear();
+  if (BufferPoolType::GetNumberOfPooledBuffers() != 0 || BufferPoolType::GetPooledBytes() != 0)
+  {
+    std::cerr << "Clear() did not empty the buffer pool" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A pooled buffer serves the requests of up to its size and of more than
+  // half of it.
+  using BufferType = BufferPoolType::ComplexType;
+  BufferType * buffer = BufferPoolType::Acquire(100);
+  BufferPoolType::Release(buffer);
+  BufferType * smallerBuffer = BufferPoolType::Acquire(80);
+  BufferType * smallBuffer = BufferPoolType::Acquire(30);
+  if (smallerBuffer != buffer || smallBuffer == buffer)
+  {
+    std::cerr << "Expected the pooled buffer to serve the request of 80 elements only" << std::endl;
+    return EXIT_FAILURE;
+  }
+  BufferPoolType::Release(smallerBuffer);
+  BufferPoolType::Release(smallBuffer);
+  if (BufferPoolType::GetPooledBytes() != 130 * sizeof(BufferType))
+  {
+    std::cerr << "Unexpected pooled size: " << BufferPoolType::GetPooledBytes() << " bytes" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Past the maximum size, the buffers released first are freed.
+  const size_t maximumPooledBytes = BufferPoolType::GetMaximumPooledBytes();
+  BufferPoolType::SetMaximumPooledBytes(100 * sizeof(BufferType));
+  if (BufferPoolType::GetNumberOfPooledBuffers() != 1 || BufferPoolType::GetPooledBytes() != 30 * sizeof(BufferType))
+  {
+    std::cerr << "Expected the buffer of 100 elements to be freed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  BufferPoolType::Release(BufferPoolType::Acquire(1000));
+  if (BufferPoolType::GetPooledBytes() > BufferPoolType::GetMaximumPooledBytes())
+  {
+    std::cerr << "The pool exceeds its maximum size" << std::endl;
+    return EXIT_FAILURE;
+  }
+  BufferPoolType::SetMaximumPooledBytes(maximumPooledBytes);
+  BufferPoolType::Clear();
+
+  PlanCacheType::Clear();
+  if (PlanCacheType::GetNumberOfPlans() != 0)
+  {
+    std::cerr << "Clear() did not empty the plan cache" << std::endl;
+    return EXIT_FAILURE;
+  }
+#endif
+
+  return EXIT_SUCCESS;
+}
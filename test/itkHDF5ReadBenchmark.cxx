@@ -0,0 +1,82 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Throughput of the reading of HDF5 ultrasound files.
+
+#include <iostream>
+#include <string>
+
+#include "itkEuler3DTransform.h"
+#include "itkHDF5UltrasoundImageIOFactory.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "itkUltrasoundImageFileReader.h"
+
+#include "itkUltrasoundBenchmark.h"
+
+int
+itkHDF5ReadBenchmark(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImage outputJSON [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char *       inputImageFileName = argv[1];
+  const unsigned int repetitions = (argc > 3) ? std::stoi(argv[3]) : 10;
+
+  itk::HDF5UltrasoundImageIOFactory::RegisterOneFactory();
+
+  const unsigned int Dimension = 3;
+  using PixelType = unsigned char;
+  using SliceImageType = itk::Image<PixelType, Dimension - 1>;
+  using TransformType = itk::Euler3DTransform<double>;
+  using SpecialCoordinatesImageType =
+    itk::SliceSeriesSpecialCoordinatesImage<SliceImageType, TransformType, PixelType, Dimension>;
+  using ReaderType = itk::UltrasoundImageFileReader<SpecialCoordinatesImageType>;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+
+  HarnessType harness("HDF5Read");
+
+  try
+  {
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(inputImageFileName);
+    reader->Update();
+    const SpecialCoordinatesImageType::SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+    const double                                samples = static_cast<double>(size[0] * size[1] * size[2]);
+
+    // The reading is not multi-threaded.
+    harness.Run("HDF5UltrasoundImageIO", HarnessType::GetGeometry(size), 1, samples, repetitions, [&reader]() {
+      reader->Modified();
+      reader->Update();
+    });
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!harness.WriteJSON(argv[2]))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <complex>
+#include <iostream>
+
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+int
+itkHDF5UltrasoundImageIOComplexTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * outputImageFileName = argv[1];
+
+  // Beamformed IQ samples.
+  const unsigned int Dimension = 3;
+  using PixelType = std::complex<float>;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 8;
+  size[2] = 3;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIt(image, image->GetLargestPossibleRegion());
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+  {
+    const ImageType::IndexType & index = imageIt.GetIndex();
+    imageIt.Set(PixelType(index[0] + 100.0f * index[1], -0.5f * index[0] + 1000.0f * index[2]));
+  }
+
+  // Written as {re, im} compounds, streamed.
+  itk::HDF5UltrasoundImageIO::Pointer writeIO = itk::HDF5UltrasoundImageIO::New();
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(outputImageFileName);
+  writer->SetImageIO(writeIO);
+  writer->SetNumberOfStreamDivisions(size[2]);
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
+
+  itk::HDF5UltrasoundImageIO::Pointer readIO = itk::HDF5UltrasoundImageIO::New();
+  readIO->SetFileName(outputImageFileName);
+  ITK_TRY_EXPECT_NO_EXCEPTION(readIO->ReadImageInformation());
+  ITK_TEST_EXPECT_EQUAL(readIO->GetPixelType(), itk::IOPixelEnum::COMPLEX);
+  ITK_TEST_EXPECT_EQUAL(readIO->GetComponentType(), itk::IOComponentEnum::FLOAT);
+  ITK_TEST_EXPECT_EQUAL(readIO->GetNumberOfComponents(), 2u);
+
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(outputImageFileName);
+  reader->SetImageIO(readIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->Update());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> readIt(reader->GetOutput(),
+                                                           reader->GetOutput()->GetLargestPossibleRegion());
+  for (readIt.GoToBegin(); !readIt.IsAtEnd(); ++readIt)
+  {
+    if (readIt.Get() != image->GetPixel(readIt.GetIndex()))
+    {
+      std::cerr << "Mismatch at " << readIt.GetIndex() << ": expected " << image->GetPixel(readIt.GetIndex())
+                << ", got " << readIt.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Vectors are neither scalar nor complex.
+  using VectorImageType = itk::Image<itk::Vector<float, 2>, Dimension>;
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  vectorImage->SetRegions(size);
+  vectorImage->Allocate();
+  using VectorWriterType = itk::ImageFileWriter<VectorImageType>;
+  VectorWriterType::Pointer vectorWriter = VectorWriterType::New();
+  vectorWriter->SetInput(vectorImage);
+  vectorWriter->SetFileName(outputImageFileName);
+  vectorWriter->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  ITK_TRY_EXPECT_EXCEPTION(vectorWriter->Update());
+
+  return EXIT_SUCCESS;
+}
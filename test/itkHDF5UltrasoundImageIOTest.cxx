@@ -101,6 +101,19 @@ itkHDF5UltrasoundImageIOTest(int argc, char * argv[])
   ITK_TEST_EXPECT_EQUAL(buffer[1], 78.0);
   ITK_TEST_EXPECT_EQUAL(buffer[2], 77.0);
 
+  // Stream an elevational slice with the open dataset.
+  ITK_TEST_EXPECT_TRUE(imageIO->CanStreamRead());
+  float * sliceBuffer = new float[10 * 10];
+  ioRegion.SetIndex(2, 3);
+  ioRegion.SetSize(2, 1);
+  imageIO->SetIORegion(ioRegion);
+  imageIO->Read(static_cast<void *>(sliceBuffer));
+  for (unsigned int ii = 0; ii < 10 * 10; ++ii)
+  {
+    ITK_TEST_EXPECT_EQUAL(sliceBuffer[ii], buffer[3 * 10 * 10 + ii]);
+  }
+
+  delete[] sliceBuffer;
   delete[] buffer;
 
   return EXIT_SUCCESS;
@@ -0,0 +1,245 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include <vector>
+
+#include "itkArray.h"
+#include "itkEuler3DTransform.h"
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkMetaDataObject.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "itkTestingMacros.h"
+#include "itkUltrasoundImageFileReader.h"
+
+int
+itkHDF5UltrasoundImageIOWriteTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " outputImage contiguousOutputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * outputImageFileName = argv[1];
+  const char * contiguousOutputImageFileName = argv[2];
+
+  const unsigned int Dimension = 3;
+  using PixelType = float;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  ImageType::SizeType size;
+  size[0] = 24;
+  size[1] = 16;
+  size[2] = 7;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIt(image, image->GetLargestPossibleRegion());
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+  {
+    const ImageType::IndexType & index = imageIt.GetIndex();
+    imageIt.Set(static_cast<PixelType>(index[0] + 100 * index[1] + 10000 * index[2]));
+  }
+
+  using ArrayType = itk::Array<double>;
+  ArrayType sliceSpacing(2);
+  sliceSpacing[0] = 0.1925;
+  sliceSpacing[1] = 0.25;
+  ArrayType sliceOrigin(2);
+  sliceOrigin[0] = 1.5;
+  sliceOrigin[1] = -2.0;
+  ArrayType elevationalSliceAngles(size[2]);
+  for (unsigned int ii = 0; ii < size[2]; ++ii)
+  {
+    elevationalSliceAngles[ii] = -0.3 + 0.1 * ii;
+  }
+  itk::MetaDataDictionary & dictionary = image->GetMetaDataDictionary();
+  itk::EncapsulateMetaData<std::string>(dictionary, "SliceType", "Image");
+  itk::EncapsulateMetaData<ArrayType>(dictionary, "SliceSpacing", sliceSpacing);
+  itk::EncapsulateMetaData<ArrayType>(dictionary, "SliceOrigin", sliceOrigin);
+  itk::EncapsulateMetaData<ArrayType>(dictionary, "ElevationalSliceAngles", elevationalSliceAngles);
+  // A frame index, with the gain of each slice.
+  ArrayType frameTimestamps(size[2]);
+  ArrayType frameGains(size[2]);
+  for (unsigned int ii = 0; ii < size[2]; ++ii)
+  {
+    frameTimestamps[ii] = 1.0 + 0.02 * ii;
+    frameGains[ii] = 30.0 + ii;
+  }
+  itk::EncapsulateMetaData<ArrayType>(dictionary, "FrameIndex/timestamp", frameTimestamps);
+  itk::EncapsulateMetaData<ArrayType>(dictionary, "FrameIndex/gain", frameGains);
+
+  itk::HDF5UltrasoundImageIO::Pointer writeIO = itk::HDF5UltrasoundImageIO::New();
+  ITK_TEST_EXPECT_TRUE(writeIO->CanWriteFile(outputImageFileName));
+  ITK_TEST_EXPECT_TRUE(!writeIO->CanWriteFile("AMetaImage.mha"));
+  ITK_TEST_SET_GET_VALUE(itk::HDF5UltrasoundImageIO::CHUNK_SLICES, writeIO->GetChunkLayout());
+  ITK_TEST_SET_GET_BOOLEAN(writeIO, UseShuffle, true);
+
+  // A contiguous dataset is not compressed.
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(outputImageFileName);
+  writer->SetImageIO(writeIO);
+  writer->UseCompressionOn();
+  writeIO->SetChunkLayout(itk::HDF5UltrasoundImageIO::CONTIGUOUS);
+  ITK_TRY_EXPECT_EXCEPTION(writer->Update());
+
+  // Stream the slices to scanline chunks, compressed.
+  writeIO->SetChunkLayout(itk::HDF5UltrasoundImageIO::CHUNK_SCANLINES);
+  writer->SetNumberOfStreamDivisions(size[2]);
+  writer->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
+
+  itk::HDF5UltrasoundImageIO::Pointer readIO = itk::HDF5UltrasoundImageIO::New();
+  ITK_TEST_EXPECT_TRUE(readIO->CanReadFile(outputImageFileName));
+  readIO->SetFileName(outputImageFileName);
+  ITK_TRY_EXPECT_NO_EXCEPTION(readIO->ReadImageInformation());
+  for (unsigned int ii = 0; ii < Dimension; ++ii)
+  {
+    ITK_TEST_EXPECT_EQUAL(readIO->GetDimensions(ii), size[ii]);
+  }
+  ITK_TEST_EXPECT_EQUAL(readIO->GetComponentType(), itk::IOComponentEnum::FLOAT);
+
+  const itk::MetaDataDictionary & readDictionary = readIO->GetMetaDataDictionary();
+  ArrayType                       readSliceSpacing(2);
+  ArrayType                       readSliceOrigin(2);
+  ArrayType                       readElevationalSliceAngles(size[2]);
+  itk::ExposeMetaData<ArrayType>(readDictionary, "SliceSpacing", readSliceSpacing);
+  itk::ExposeMetaData<ArrayType>(readDictionary, "SliceOrigin", readSliceOrigin);
+  itk::ExposeMetaData<ArrayType>(readDictionary, "ElevationalSliceAngles", readElevationalSliceAngles);
+  for (unsigned int ii = 0; ii < 2; ++ii)
+  {
+    ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(readSliceSpacing[ii], sliceSpacing[ii], 10, 1e-9));
+    ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(readSliceOrigin[ii], sliceOrigin[ii], 10, 1e-9));
+  }
+  for (unsigned int ii = 0; ii < size[2]; ++ii)
+  {
+    ITK_TEST_EXPECT_TRUE(
+      itk::Math::FloatAlmostEqual(readElevationalSliceAngles[ii], elevationalSliceAngles[ii], 10, 1e-9));
+  }
+
+  ITK_TEST_EXPECT_TRUE(readIO->HasFrameIndex());
+  ArrayType readFrameGains;
+  ArrayType readFrameOffsets;
+  ITK_TEST_EXPECT_TRUE(itk::ExposeMetaData<ArrayType>(readDictionary, "FrameIndex/gain", readFrameGains));
+  ITK_TEST_EXPECT_TRUE(itk::ExposeMetaData<ArrayType>(readDictionary, "FrameIndex/offset", readFrameOffsets));
+  ITK_TEST_EXPECT_EQUAL(readFrameGains.size(), size[2]);
+  for (unsigned int ii = 0; ii < size[2]; ++ii)
+  {
+    ITK_TEST_EXPECT_EQUAL(readFrameGains[ii], frameGains[ii]);
+    ITK_TEST_EXPECT_EQUAL(readFrameOffsets[ii], ii);
+  }
+  ITK_TEST_EXPECT_EQUAL(readIO->FindFrameAtTime(1.045), 2);
+  ITK_TEST_EXPECT_EQUAL(readIO->FindFrameAtTime(0.0), 0);
+
+  itk::ImageIORegion ioRegion(Dimension);
+  for (unsigned int ii = 0; ii < Dimension; ++ii)
+  {
+    ioRegion.SetIndex(ii, 0);
+    ioRegion.SetSize(ii, size[ii]);
+  }
+  readIO->SetIORegion(ioRegion);
+  std::vector<PixelType> buffer(image->GetLargestPossibleRegion().GetNumberOfPixels());
+  readIO->Read(buffer.data());
+  const PixelType * expected = image->GetBufferPointer();
+  for (size_t ii = 0; ii < buffer.size(); ++ii)
+  {
+    if (buffer[ii] != expected[ii])
+    {
+      std::cerr << "Mismatch at offset " << ii << ": expected " << expected[ii] << ", got " << buffer[ii] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Decompress the chunks of a region concurrently, with a larger cache.
+  ITK_TEST_SET_GET_BOOLEAN(readIO, UseParallelDecompression, true);
+  const itk::SizeValueType chunkCacheSize = 4 * 1024 * 1024;
+  readIO->SetChunkCacheSize(chunkCacheSize);
+  ITK_TEST_SET_GET_VALUE(chunkCacheSize, readIO->GetChunkCacheSize());
+  const itk::SizeValueType chunkCacheSlots = 10007;
+  readIO->SetChunkCacheSlots(chunkCacheSlots);
+  ITK_TEST_SET_GET_VALUE(chunkCacheSlots, readIO->GetChunkCacheSlots());
+  ioRegion.SetIndex(0, 5);
+  ioRegion.SetSize(0, 11);
+  ioRegion.SetIndex(1, 3);
+  ioRegion.SetSize(1, 9);
+  ioRegion.SetIndex(2, 2);
+  ioRegion.SetSize(2, 4);
+  readIO->SetIORegion(ioRegion);
+  std::vector<PixelType> regionBuffer(11 * 9 * 4);
+  ITK_TRY_EXPECT_NO_EXCEPTION(readIO->Read(regionBuffer.data()));
+  for (size_t ii = 0; ii < regionBuffer.size(); ++ii)
+  {
+    ImageType::IndexType index;
+    index[0] = 5 + ii % 11;
+    index[1] = 3 + (ii / 11) % 9;
+    index[2] = 2 + ii / (11 * 9);
+    if (regionBuffer[ii] != image->GetPixel(index))
+    {
+      std::cerr << "Mismatch at " << index << ": expected " << image->GetPixel(index) << ", got " << regionBuffer[ii]
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A compressed dataset is not memory mapped.
+  ITK_TEST_EXPECT_EQUAL(readIO->GetVoxelDataFileOffset(), -1);
+
+  // Map an uncompressed, contiguous dataset, and propagate the slice series
+  // geometry.
+  writer->UseCompressionOff();
+  writeIO->SetChunkLayout(itk::HDF5UltrasoundImageIO::CONTIGUOUS);
+  writer->SetFileName(contiguousOutputImageFileName);
+  writer->SetNumberOfStreamDivisions(1);
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
+
+  using SliceImageType = itk::Image<PixelType, Dimension - 1>;
+  using TransformType = itk::Euler3DTransform<double>;
+  using SliceSeriesImageType = itk::SliceSeriesSpecialCoordinatesImage<SliceImageType, TransformType, PixelType>;
+  using ReaderType = itk::UltrasoundImageFileReader<SliceSeriesImageType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(contiguousOutputImageFileName);
+  reader->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  ITK_TEST_SET_GET_BOOLEAN(reader, UseMemoryMapping, true);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->Update());
+  SliceSeriesImageType * mappedImage = reader->GetOutput();
+  ITK_TEST_EXPECT_TRUE(
+    dynamic_cast<itk::MemoryMappedImageContainer<itk::SizeValueType, PixelType> *>(mappedImage->GetPixelContainer()) !=
+    nullptr);
+  ITK_TEST_EXPECT_TRUE(
+    itk::Math::FloatAlmostEqual(mappedImage->GetSliceImage()->GetSpacing()[0], sliceSpacing[0], 10, 1e-9));
+  itk::ImageRegionConstIteratorWithIndex<SliceSeriesImageType> mappedIt(mappedImage,
+                                                                         mappedImage->GetLargestPossibleRegion());
+  for (mappedIt.GoToBegin(); !mappedIt.IsAtEnd(); ++mappedIt)
+  {
+    if (mappedIt.Get() != image->GetPixel(mappedIt.GetIndex()))
+    {
+      std::cerr << "Mapped mismatch at " << mappedIt.GetIndex() << ": expected " << image->GetPixel(mappedIt.GetIndex())
+                << ", got " << mappedIt.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include <vector>
+
+#include "itkArray.h"
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkHDF5UltrasoundRecordingWriter.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkMetaDataObject.h"
+#include "itkTestingMacros.h"
+
+int
+itkHDF5UltrasoundRecordingWriterTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " outputImage" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * outputImageFileName = argv[1];
+
+  const unsigned int Dimension = 2;
+  using PixelType = short;
+  using FrameType = itk::Image<PixelType, Dimension>;
+
+  FrameType::SizeType size;
+  size[0] = 48;
+  size[1] = 12;
+  FrameType::Pointer frame = FrameType::New();
+  frame->SetRegions(size);
+  FrameType::SpacingType spacing;
+  spacing[0] = 0.0385;
+  spacing[1] = 0.25;
+  frame->SetSpacing(spacing);
+  FrameType::PointType origin;
+  origin[0] = 2.0;
+  origin[1] = -1.5;
+  frame->SetOrigin(origin);
+  frame->Allocate();
+
+  using WriterType = itk::HDF5UltrasoundRecordingWriter;
+  WriterType::Pointer writer = WriterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(writer, HDF5UltrasoundRecordingWriter, Object);
+
+  const itk::SizeValueType queueCapacity = 3;
+  writer->SetQueueCapacity(queueCapacity);
+  ITK_TEST_SET_GET_VALUE(queueCapacity, writer->GetQueueCapacity());
+  ITK_TEST_SET_GET_BOOLEAN(writer, BlockWhenFull, false);
+  ITK_TEST_SET_GET_BOOLEAN(writer, UseCompression, false);
+  ITK_TEST_SET_GET_BOOLEAN(writer, UseShuffle, false);
+
+  // The file name is required.
+  ITK_TRY_EXPECT_EXCEPTION(writer->Start(frame.GetPointer()));
+  writer->SetFileName(outputImageFileName);
+  ITK_TEST_SET_GET_VALUE(std::string(outputImageFileName), writer->GetFileName());
+  ITK_TRY_EXPECT_EXCEPTION(writer->PushFrame(frame.GetPointer()));
+
+  // Without drops.
+  writer->BlockWhenFullOn();
+  writer->UseCompressionOn();
+  writer->UseShuffleOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Start(frame.GetPointer()));
+  ITK_TEST_EXPECT_TRUE(writer->IsRecording());
+  const itk::SizeValueType numberOfFrames = 20;
+  for (itk::SizeValueType ii = 0; ii < numberOfFrames; ++ii)
+  {
+    itk::ImageRegionIteratorWithIndex<FrameType> it(frame, frame->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const FrameType::IndexType & index = it.GetIndex();
+      it.Set(static_cast<PixelType>(1000 * ii + 50 * index[1] + index[0]));
+    }
+    ITK_TEST_EXPECT_TRUE(writer->PushFrame(frame.GetPointer(), 0.01 * ii, 0.5 * ii));
+  }
+  ITK_TEST_EXPECT_TRUE(writer->GetMaximumQueueDepth() <= queueCapacity);
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Stop());
+  ITK_TEST_EXPECT_TRUE(!writer->IsRecording());
+  ITK_TEST_EXPECT_EQUAL(writer->GetNumberOfWrittenFrames(), numberOfFrames);
+  ITK_TEST_EXPECT_TRUE(writer->GetNumberOfDroppedFrames() == 0);
+  ITK_TEST_EXPECT_TRUE(writer->GetQueueDepth() == 0);
+
+  // The recording is a volume of the frames.
+  itk::HDF5UltrasoundImageIO::Pointer readIO = itk::HDF5UltrasoundImageIO::New();
+  ITK_TEST_EXPECT_TRUE(readIO->CanReadFile(outputImageFileName));
+  readIO->SetFileName(outputImageFileName);
+  ITK_TRY_EXPECT_NO_EXCEPTION(readIO->ReadImageInformation());
+  ITK_TEST_EXPECT_EQUAL(readIO->GetDimensions(0), size[0]);
+  ITK_TEST_EXPECT_EQUAL(readIO->GetDimensions(1), size[1]);
+  ITK_TEST_EXPECT_EQUAL(readIO->GetDimensions(2), numberOfFrames);
+  ITK_TEST_EXPECT_EQUAL(readIO->GetComponentType(), itk::IOComponentEnum::SHORT);
+
+  using ArrayType = itk::Array<double>;
+  ArrayType sliceSpacing(2);
+  ArrayType sliceOrigin(2);
+  ArrayType elevationalSliceAngles(numberOfFrames);
+  itk::ExposeMetaData<ArrayType>(readIO->GetMetaDataDictionary(), "SliceSpacing", sliceSpacing);
+  itk::ExposeMetaData<ArrayType>(readIO->GetMetaDataDictionary(), "SliceOrigin", sliceOrigin);
+  itk::ExposeMetaData<ArrayType>(readIO->GetMetaDataDictionary(), "ElevationalSliceAngles", elevationalSliceAngles);
+  for (unsigned int ii = 0; ii < Dimension; ++ii)
+  {
+    ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(sliceSpacing[ii], spacing[ii], 10, 1e-9));
+    ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(sliceOrigin[ii], origin[ii], 10, 1e-9));
+  }
+  for (itk::SizeValueType ii = 0; ii < numberOfFrames; ++ii)
+  {
+    ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(elevationalSliceAngles[ii], 0.01 * ii, 10, 1e-9));
+  }
+
+  // The frames can be found by time.
+  ITK_TEST_EXPECT_TRUE(readIO->HasFrameIndex());
+  ITK_TEST_EXPECT_EQUAL(readIO->FindFrameAtTime(2.6), 5);
+  ITK_TEST_EXPECT_EQUAL(readIO->FindFrameAtTime(-1.0), 0);
+  ITK_TEST_EXPECT_EQUAL(readIO->FindFrameAtTime(1000.0), numberOfFrames - 1);
+
+  itk::ImageIORegion ioRegion(Dimension + 1);
+  for (unsigned int ii = 0; ii < Dimension + 1; ++ii)
+  {
+    ioRegion.SetIndex(ii, 0);
+    ioRegion.SetSize(ii, readIO->GetDimensions(ii));
+  }
+  readIO->SetIORegion(ioRegion);
+  std::vector<PixelType> buffer(size[0] * size[1] * numberOfFrames);
+  ITK_TRY_EXPECT_NO_EXCEPTION(readIO->Read(buffer.data()));
+  for (size_t ii = 0; ii < buffer.size(); ++ii)
+  {
+    const PixelType expected =
+      static_cast<PixelType>(1000 * (ii / (size[0] * size[1])) + 50 * ((ii / size[0]) % size[1]) + ii % size[0]);
+    if (buffer[ii] != expected)
+    {
+      std::cerr << "Mismatch at offset " << ii << ": expected " << expected << ", got " << buffer[ii] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Every frame is either written or dropped.
+  writer->BlockWhenFullOff();
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Start(frame.GetPointer()));
+  itk::SizeValueType queuedFrames = 0;
+  for (itk::SizeValueType ii = 0; ii < numberOfFrames; ++ii)
+  {
+    queuedFrames += writer->PushFrame(frame.GetPointer());
+  }
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Stop());
+  ITK_TEST_EXPECT_EQUAL(writer->GetNumberOfWrittenFrames(), queuedFrames);
+  ITK_TEST_EXPECT_EQUAL(writer->GetNumberOfWrittenFrames() + writer->GetNumberOfDroppedFrames(), numberOfFrames);
+
+  // The frames have the size of the reference frame.
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Start(frame.GetPointer()));
+  FrameType::Pointer smallFrame = FrameType::New();
+  size[0] = 8;
+  smallFrame->SetRegions(size);
+  smallFrame->Allocate();
+  ITK_TRY_EXPECT_EXCEPTION(writer->PushFrame(smallFrame.GetPointer()));
+  ITK_TRY_EXPECT_NO_EXCEPTION(writer->Stop());
+
+  return EXIT_SUCCESS;
+}
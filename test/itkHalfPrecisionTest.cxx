@@ -0,0 +1,113 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "itkHalfPrecision.h"
+#include "itkTestingMacros.h"
+
+int
+itkHalfPrecisionTest(int, char *[])
+{
+  // Exact values.
+  const float exactValues[] = { 0.0f, 1.0f, -2.0f, 0.5f, 1.5f, std::ldexp(1.0f, -14), std::ldexp(1.0f, -24),
+                                std::ldexp(3.0f, -24) };
+  for (const float value : exactValues)
+  {
+    ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::Float16(value)), value);
+    ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::BFloat16(value)), value);
+  }
+  ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::Float16(-65504.0f)), -65504.0f);
+  // bfloat16 keeps the range of float.
+  ITK_TEST_EXPECT_TRUE(std::abs(static_cast<float>(itk::BFloat16(1.0e30f)) - 1.0e30f) <= std::ldexp(1.0e30f, -8));
+  ITK_TEST_EXPECT_EQUAL(itk::Float16(1.0f).GetBits(), 0x3c00);
+  ITK_TEST_EXPECT_EQUAL(itk::Float16(-2.0f).GetBits(), 0xc000);
+  ITK_TEST_EXPECT_EQUAL(itk::Float16(std::ldexp(1.0f, -24)).GetBits(), 0x0001);
+  ITK_TEST_EXPECT_EQUAL(itk::BFloat16(1.0f).GetBits(), 0x3f80);
+
+  // Rounding to nearest even, to infinity beyond the range, and to zero
+  // below half the smallest subnormal.
+  ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::Float16(1.0f + std::ldexp(1.0f, -11))), 1.0f);
+  ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::Float16(1.0f + std::ldexp(3.0f, -11))), 1.0f + std::ldexp(1.0f, -9));
+  ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::Float16(65519.0f)), 65504.0f);
+  ITK_TEST_EXPECT_TRUE(std::isinf(static_cast<float>(itk::Float16(65520.0f))));
+  ITK_TEST_EXPECT_TRUE(std::isinf(static_cast<float>(itk::Float16(-1.0e6f))));
+  ITK_TEST_EXPECT_EQUAL(itk::Float16(std::ldexp(1.0f, -25)).GetBits(), 0x0000);
+  ITK_TEST_EXPECT_EQUAL(itk::Float16(std::ldexp(3.0f, -26)).GetBits(), 0x0001);
+  ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::BFloat16(1.0f + std::ldexp(1.0f, -8))), 1.0f);
+  ITK_TEST_EXPECT_EQUAL(static_cast<float>(itk::BFloat16(1.0f + std::ldexp(3.0f, -8))), 1.0f + std::ldexp(1.0f, -6));
+  ITK_TEST_EXPECT_TRUE(std::isinf(static_cast<float>(itk::Float16(std::numeric_limits<float>::infinity()))));
+  ITK_TEST_EXPECT_TRUE(std::isnan(static_cast<float>(itk::Float16(std::numeric_limits<float>::quiet_NaN()))));
+  ITK_TEST_EXPECT_TRUE(std::isnan(static_cast<float>(itk::BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+
+  // Every half precision value decodes and encodes back to itself.
+  for (unsigned int bits = 0; bits < 0x10000; ++bits)
+  {
+    const float value = itk::Float16::ToFloat(static_cast<uint16_t>(bits));
+    if (!std::isnan(value) && itk::Float16::FromFloat(value) != bits)
+    {
+      std::cerr << "Float16 " << bits << " does not round trip" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The relative rounding error over the normal range, and the buffer
+  // conversions, with a length that is not a multiple of the vector width.
+  const itk::SizeValueType count = 1001;
+  std::vector<float>       values(count);
+  for (itk::SizeValueType ii = 0; ii < count; ++ii)
+  {
+    values[ii] = (ii % 2 ? -1.0f : 1.0f) * std::exp(-9.0f + 0.02f * ii);
+  }
+  std::vector<itk::Float16>  float16Values(count);
+  std::vector<itk::BFloat16> bfloat16Values(count);
+  std::vector<float>         float16Loaded(count);
+  std::vector<float>         bfloat16Loaded(count);
+  itk::ConvertHalfPrecisionBuffer(values.data(), count, float16Values.data());
+  itk::ConvertHalfPrecisionBuffer(float16Values.data(), count, float16Loaded.data());
+  itk::ConvertHalfPrecisionBuffer(values.data(), count, bfloat16Values.data());
+  itk::ConvertHalfPrecisionBuffer(bfloat16Values.data(), count, bfloat16Loaded.data());
+  for (itk::SizeValueType ii = 0; ii < count; ++ii)
+  {
+    const float value = values[ii];
+    if (float16Loaded[ii] != static_cast<float>(itk::Float16(value)) ||
+        bfloat16Loaded[ii] != static_cast<float>(itk::BFloat16(value)))
+    {
+      std::cerr << "Buffer conversion mismatch at " << ii << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (std::abs(float16Loaded[ii] - value) > std::ldexp(std::abs(value), -11) ||
+        std::abs(bfloat16Loaded[ii] - value) > std::ldexp(std::abs(value), -8))
+    {
+      std::cerr << "Rounding error too large for " << value << ": " << float16Loaded[ii] << ", "
+                << bfloat16Loaded[ii] << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Float buffers are copied.
+  std::vector<float> copied(count);
+  itk::ConvertHalfPrecisionBuffer(values.data(), count, copied.data());
+  ITK_TEST_EXPECT_TRUE(copied == values);
+
+  std::cout << itk::Float16(0.1f) << " " << itk::BFloat16(0.1f) << std::endl;
+
+  return EXIT_SUCCESS;
+}
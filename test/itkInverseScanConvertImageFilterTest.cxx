@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkResampleImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include "itkInverseScanConvertImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using PixelType = float;
+using ImageType = itk::Image<PixelType, Dimension>;
+using CurvilinearImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension>;
+using FilterType = itk::InverseScanConvertImageFilter<ImageType, CurvilinearImageType>;
+
+// Compare with a ResampleImageFilter and its linear interpolator on the
+// samples that are computed, and with the default value on the others.
+bool
+matchesResample(const ImageType * input, const FilterType * filter)
+{
+  const CurvilinearImageType * reference = filter->GetReferenceImage();
+  const CurvilinearImageType * output = filter->GetOutput();
+  const PixelType              defaultPixelValue = filter->GetDefaultPixelValue();
+
+  using ResamplerType = itk::ResampleImageFilter<ImageType, CurvilinearImageType>;
+  ResamplerType::Pointer resampler = ResamplerType::New();
+  resampler->SetInput(input);
+  resampler->SetOutputParametersFromImage(reference);
+  resampler->SetDefaultPixelValue(defaultPixelValue);
+  resampler->GetOutput()->SetLateralAngularSeparation(reference->GetLateralAngularSeparation());
+  resampler->GetOutput()->SetRadiusSampleSize(reference->GetRadiusSampleSize());
+  resampler->GetOutput()->SetFirstSampleDistance(reference->GetFirstSampleDistance());
+  try
+  {
+    resampler->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+
+  const CurvilinearImageType::RegionType region = output->GetLargestPossibleRegion();
+  const CurvilinearImageType::RegionType regionOfInterest = filter->GetOutputRegionOfInterest();
+  const FilterType::MaskImageType *      mask = filter->GetOutputMask();
+  itk::ImageRegionConstIteratorWithIndex<CurvilinearImageType> outputIt(output, region);
+  itk::ImageRegionConstIteratorWithIndex<CurvilinearImageType> expectedIt(resampler->GetOutput(), region);
+  for (outputIt.GoToBegin(), expectedIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt, ++expectedIt)
+  {
+    const CurvilinearImageType::IndexType & index = outputIt.GetIndex();
+    const bool                              inRegion =
+      regionOfInterest.GetNumberOfPixels() == 0 || regionOfInterest.IsInside(index);
+    const bool                              inMask = !mask || mask->GetPixel(index) != 0;
+    const PixelType                         expected = inRegion && inMask ? expectedIt.Get() : defaultPixelValue;
+    if (std::abs(outputIt.Get() - expected) > 1e-4 * (1.0 + std::abs(expected)))
+    {
+      std::cerr << "Mismatch at " << index << ": expected " << expected << ", got " << outputIt.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkInverseScanConvertImageFilterTest(int, char *[])
+{
+  ImageType::SizeType inputSize;
+  inputSize[0] = 120;
+  inputSize[1] = 100;
+  ImageType::Pointer input = ImageType::New();
+  input->SetRegions(inputSize);
+  ImageType::SpacingType inputSpacing;
+  inputSpacing.Fill(0.5);
+  input->SetSpacing(inputSpacing);
+  ImageType::PointType inputOrigin;
+  inputOrigin[0] = -30.0;
+  inputOrigin[1] = 0.0;
+  input->SetOrigin(inputOrigin);
+  input->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    const ImageType::IndexType & index = inputIt.GetIndex();
+    inputIt.Set(static_cast<PixelType>(2.0 + std::sin(0.15 * index[0]) * std::cos(0.1 * index[1])));
+  }
+
+  // The sector reaches past the bottom of the input.
+  CurvilinearImageType::SizeType referenceSize;
+  referenceSize[0] = 96;
+  referenceSize[1] = 40;
+  CurvilinearImageType::Pointer reference = CurvilinearImageType::New();
+  reference->SetRegions(referenceSize);
+  reference->SetLateralAngularSeparation((itk::Math::pi / 3.0) / (referenceSize[1] - 1));
+  reference->SetRadiusSampleSize(0.5);
+  reference->SetFirstSampleDistance(8.0);
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, InverseScanConvertImageFilter, ImageToImageFilter);
+
+  filter->SetInput(input);
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  filter->SetReferenceImage(reference);
+  ITK_TEST_SET_GET_VALUE(reference.GetPointer(), filter->GetReferenceImage());
+  const PixelType defaultPixelValue = -1.0f;
+  filter->SetDefaultPixelValue(defaultPixelValue);
+  ITK_TEST_SET_GET_VALUE(defaultPixelValue, filter->GetDefaultPixelValue());
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfMappingBuilds(), 1u);
+  ITK_TEST_EXPECT_TRUE(filter->GetNumberOfMappedSamples() > 0);
+  ITK_TEST_EXPECT_TRUE(filter->GetNumberOfMappedSamples() < reference->GetLargestPossibleRegion().GetNumberOfPixels());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLateralAngularSeparation(), reference->GetLateralAngularSeparation());
+  if (!matchesResample(input, filter))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // New input values with the same geometry reuse the mapping.
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(inputIt.Get() * 3.0f - 1.0f);
+  }
+  input->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfMappingBuilds(), 1u);
+  if (!matchesResample(input, filter))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Only the samples in the region of interest and the mask are computed.
+  const itk::SizeValueType        allSamples = filter->GetNumberOfMappedSamples();
+  CurvilinearImageType::IndexType roiIndex;
+  CurvilinearImageType::SizeType  roiSize;
+  roiIndex[0] = 10;
+  roiIndex[1] = 5;
+  roiSize[0] = 40;
+  roiSize[1] = 20;
+  const CurvilinearImageType::RegionType regionOfInterest(roiIndex, roiSize);
+  filter->SetOutputRegionOfInterest(regionOfInterest);
+  ITK_TEST_SET_GET_VALUE(regionOfInterest, filter->GetOutputRegionOfInterest());
+
+  FilterType::MaskImageType::Pointer mask = FilterType::MaskImageType::New();
+  mask->SetRegions(referenceSize);
+  mask->Allocate();
+  itk::ImageRegionIteratorWithIndex<FilterType::MaskImageType> maskIt(mask, mask->GetLargestPossibleRegion());
+  for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+  {
+    maskIt.Set(maskIt.GetIndex()[1] % 2 == 0 ? 1 : 0);
+  }
+  filter->SetOutputMask(mask);
+  ITK_TEST_SET_GET_VALUE(mask.GetPointer(), filter->GetOutputMask());
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfMappingBuilds(), 2u);
+  ITK_TEST_EXPECT_TRUE(filter->GetNumberOfMappedSamples() <= regionOfInterest.GetNumberOfPixels() / 2);
+  ITK_TEST_EXPECT_TRUE(filter->GetNumberOfMappedSamples() < allSamples);
+  if (!matchesResample(input, filter))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Modifying the geometry of the reference rebuilds the mapping.
+  reference->SetRadiusSampleSize(0.4);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfMappingBuilds(), 3u);
+  if (!matchesResample(input, filter))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A mask on another region is an error.
+  CurvilinearImageType::SizeType maskSize = referenceSize;
+  maskSize[0] += 1;
+  mask->SetRegions(maskSize);
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+#include "itkZeroFluxNeumannBoundaryCondition.h"
+#include "vnl/vnl_math.h"
+#include "vnl/algo/vnl_svd.h"
+
+#include "itkLinearLeastSquaresGradientImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using ImageType = itk::Image<double, Dimension>;
+using NeighborhoodIteratorType = itk::ConstNeighborhoodIterator<ImageType>;
+
+// The fit to the longest run of a sign from the first value of the slice,
+// or to the whole slice, with a singular value decomposition.
+double
+referenceDerivative(const std::slice & s, const NeighborhoodIteratorType & nit)
+{
+  unsigned int maxConsistentCount = 1;
+  unsigned int currentConsistentCount = 1;
+  int          previousSgn = vnl_math_sgn0(nit.GetPixel(s.start()));
+  for (unsigned int sliceIdx = 1; sliceIdx < s.size(); ++sliceIdx)
+  {
+    const int nextSgn = vnl_math_sgn0(nit.GetPixel(s.start() + sliceIdx * s.stride()));
+    currentConsistentCount = nextSgn == previousSgn ? currentConsistentCount + 1 : 1;
+    maxConsistentCount = std::max(maxConsistentCount, currentConsistentCount);
+    previousSgn = nextSgn;
+  }
+  if (maxConsistentCount < (s.size() - 1) / 2)
+  {
+    maxConsistentCount = s.size();
+  }
+
+  vnl_matrix<double> A(maxConsistentCount, 2);
+  A.set_column(1, 1.0);
+  vnl_vector<double> y(maxConsistentCount);
+  for (unsigned int i = 0; i < maxConsistentCount; ++i)
+  {
+    A[i][0] = i;
+    y[i] = nit.GetPixel(s.start() + i * s.stride());
+  }
+  return vnl_svd<double>(A).solve(y)[0];
+}
+
+} // namespace
+
+int
+itkLinearLeastSquaresGradientImageFilterTest(int, char *[])
+{
+  // Values of both signs, so that the fits are over runs of different lengths.
+  ImageType::SizeType size;
+  size[0] = 31;
+  size[1] = 17;
+  ImageType::Pointer input = ImageType::New();
+  input->SetRegions(size);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 2.0;
+  input->SetSpacing(spacing);
+  input->Allocate();
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(7);
+  itk::ImageRegionIterator<ImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(generator->GetUniformVariate(-0.3, 1.0));
+  }
+
+  using FilterType = itk::LinearLeastSquaresGradientImageFilter<ImageType, double, double>;
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, LinearLeastSquaresGradientImageFilter, ImageToImageFilter);
+
+  ITK_TEST_SET_GET_BOOLEAN(filter, UseImageSpacing, true);
+
+  FilterType::RadiusType radius;
+  radius[0] = 4;
+  radius[1] = 2;
+  filter->SetRadius(radius);
+  ITK_TEST_SET_GET_VALUE(radius, filter->GetRadius());
+  filter->SetInput(input);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+
+  itk::ZeroFluxNeumannBoundaryCondition<ImageType> boundaryCondition;
+  NeighborhoodIteratorType                          nit(radius, input, input->GetLargestPossibleRegion());
+  nit.OverrideBoundaryCondition(&boundaryCondition);
+  using OutputImageType = FilterType::OutputImageType;
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> outputIt(filter->GetOutput(),
+                                                                  filter->GetOutput()->GetLargestPossibleRegion());
+  for (nit.GoToBegin(), outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++nit, ++outputIt)
+  {
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      const double expected = referenceDerivative(nit.GetSlice(dim), nit) / spacing[dim];
+      if (std::abs(outputIt.Get()[dim] - expected) > 1e-9 * (1.0 + std::abs(expected)))
+      {
+        std::cerr << "Gradient mismatch at " << outputIt.GetIndex() << ", direction " << dim << ": expected "
+                  << expected << ", got " << outputIt.Get()[dim] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkLogCompressionImageFilter.h"
+
+int
+itkLogCompressionImageFilterTest(int, char *[])
+{
+  using EnvelopeImageType = itk::Image<float, 2>;
+  using FilterType = itk::LogCompressionImageFilter<EnvelopeImageType>;
+  using OutputImageType = FilterType::OutputImageType;
+
+  // Envelopes from 1e-4 to 1e4, along both directions, and a few zero and
+  // negative ones.
+  EnvelopeImageType::SizeType size;
+  size[0] = 301;
+  size[1] = 17;
+  EnvelopeImageType::Pointer envelope = EnvelopeImageType::New();
+  envelope->SetRegions(size);
+  envelope->Allocate();
+  itk::ImageRegionIteratorWithIndex<EnvelopeImageType> it(envelope, envelope->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const EnvelopeImageType::IndexType & index = it.GetIndex();
+    const double                         exponent = -4.0 + 8.0 * (index[0] + index[1] / 17.0) / (size[0] - 1);
+    it.Set(static_cast<float>(std::pow(10.0, exponent)));
+  }
+  EnvelopeImageType::IndexType index;
+  index[1] = 3;
+  index[0] = 0;
+  envelope->SetPixel(index, 0.0f);
+  index[0] = 1;
+  envelope->SetPixel(index, -5.0f);
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, LogCompressionImageFilter, ImageToImageFilter);
+
+  ITK_TEST_SET_GET_VALUE(60.0, filter->GetDynamicRange());
+  ITK_TEST_SET_GET_VALUE(0.0, filter->GetReferenceLevel());
+
+  filter->SetInput(envelope);
+
+  // The output levels, rounded, are the ones of the exact logarithm, but
+  // for the levels that are rounded the other way by the table.
+  const auto check = [&]() {
+    const double                                            dynamicRange = filter->GetDynamicRange();
+    const double                                            referenceLevel = filter->GetReferenceLevel();
+    const OutputImageType *                                 output = filter->GetOutput();
+    itk::ImageRegionConstIteratorWithIndex<OutputImageType> outputIt(output, output->GetBufferedRegion());
+    itk::SizeValueType                                      rounding = 0;
+    for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt)
+    {
+      const double value = envelope->GetPixel(outputIt.GetIndex());
+      double       expected = 0.0;
+      if (value > 0.0)
+      {
+        const double level = 20.0 * std::log10(value);
+        expected = 255.0 * (level - (referenceLevel - dynamicRange)) / dynamicRange;
+        expected = std::min(std::max(std::floor(expected + 0.5), 0.0), 255.0);
+      }
+      const double difference = std::abs(outputIt.Get() - expected);
+      if (difference > 1.0)
+      {
+        std::cerr << "At " << outputIt.GetIndex() << ", expected " << expected << ", got "
+                  << static_cast<int>(outputIt.Get()) << std::endl;
+        return false;
+      }
+      rounding += difference > 0.0;
+    }
+    std::cout << "Levels rounded the other way: " << rounding << std::endl;
+    return rounding < output->GetBufferedRegion().GetNumberOfPixels() / 100;
+  };
+
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetBufferedRegion(), envelope->GetLargestPossibleRegion());
+  ITK_TEST_EXPECT_TRUE(check());
+  index[0] = 0;
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetPixel(index), 0);
+  index[0] = 1;
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetPixel(index), 0);
+  index[0] = size[0] - 1;
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetPixel(index), 255);
+
+  filter->SetDynamicRange(45.0);
+  filter->SetReferenceLevel(62.5);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(check());
+
+  return EXIT_SUCCESS;
+}
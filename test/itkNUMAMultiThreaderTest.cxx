@@ -0,0 +1,163 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <atomic>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkFirstTouchImageContainer.h"
+#include "itkForward1DFFTImageFilter.h"
+#include "itkLogCompressionImageFilter.h"
+#include "itkNUMAMultiThreader.h"
+
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+
+int
+itkNUMAMultiThreaderTest(int, char *[])
+{
+  using ThreaderType = itk::NUMAMultiThreader;
+  ThreaderType::Pointer threader = ThreaderType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(threader, NUMAMultiThreader, PlatformMultiThreader);
+
+  // Contiguous work units per node, from the first to the last node.
+  const unsigned int numberOfNodes = threader->GetNumberOfNodes();
+  std::cout << "Number of nodes: " << numberOfNodes << std::endl;
+  ITK_TEST_EXPECT_TRUE(numberOfNodes >= 1);
+  const itk::ThreadIdType numberOfWorkUnits = 4 * numberOfNodes;
+  ITK_TEST_EXPECT_EQUAL(threader->GetWorkUnitNode(0, numberOfWorkUnits), 0);
+  ITK_TEST_EXPECT_EQUAL(threader->GetWorkUnitNode(numberOfWorkUnits - 1, numberOfWorkUnits), numberOfNodes - 1);
+  for (itk::ThreadIdType workUnit = 1; workUnit < numberOfWorkUnits; ++workUnit)
+  {
+    ITK_TEST_EXPECT_TRUE(threader->GetWorkUnitNode(workUnit, numberOfWorkUnits) >=
+                         threader->GetWorkUnitNode(workUnit - 1, numberOfWorkUnits));
+  }
+
+  // Every pixel of the region is processed once.
+  using ImageType = itk::Image<float, 3>;
+  using CountImageType = itk::Image<int, 3>;
+  ImageType::SizeType size;
+  size[0] = 32;
+  size[1] = 16;
+  size[2] = 24;
+  const ImageType::RegionType region(size);
+  CountImageType::Pointer     visits = CountImageType::New();
+  visits->SetRegions(region);
+  visits->Allocate();
+  visits->FillBuffer(0);
+  threader->SetNumberOfWorkUnits(numberOfWorkUnits);
+  threader->ParallelizeImageRegion<3>(
+    region,
+    [&](const ImageType::RegionType & split) {
+      itk::ImageRegionIterator<CountImageType> it(visits, split);
+      for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+        it.Set(it.Get() + 1);
+      }
+    },
+    nullptr);
+  itk::ImageRegionConstIterator<CountImageType> visitsIt(visits, region);
+  for (visitsIt.GoToBegin(); !visitsIt.IsAtEnd(); ++visitsIt)
+  {
+    ITK_TEST_EXPECT_EQUAL(visitsIt.Get(), 1);
+  }
+
+  std::atomic<itk::SizeValueType> sum(0);
+  threader->ParallelizeArray(
+    0, 1000, [&](itk::SizeValueType ii) { sum += ii; }, nullptr);
+  ITK_TEST_EXPECT_EQUAL(sum.load(), 999 * 1000 / 2);
+
+  // A filter gives the same output with it.
+  ImageType::Pointer envelope = ImageType::New();
+  envelope->SetRegions(region);
+  envelope->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> envelopeIt(envelope, region);
+  for (envelopeIt.GoToBegin(); !envelopeIt.IsAtEnd(); ++envelopeIt)
+  {
+    const ImageType::IndexType & index = envelopeIt.GetIndex();
+    envelopeIt.Set(static_cast<float>(1 + index[0] * index[1] + index[2]));
+  }
+  using FilterType = itk::LogCompressionImageFilter<ImageType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(envelope);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  FilterType::Pointer numaFilter = FilterType::New();
+  numaFilter->SetInput(envelope);
+  numaFilter->SetMultiThreader(threader);
+  numaFilter->SetNumberOfWorkUnits(numberOfWorkUnits);
+#if defined(__linux__)
+  cpu_set_t callerCPUSet;
+  ITK_TEST_EXPECT_EQUAL(sched_getaffinity(0, sizeof(callerCPUSet), &callerCPUSet), 0);
+#endif
+  ITK_TRY_EXPECT_NO_EXCEPTION(numaFilter->Update());
+#if defined(__linux__)
+  // The caller, which runs work unit 0, is not left pinned to a node.
+  cpu_set_t updatedCPUSet;
+  ITK_TEST_EXPECT_EQUAL(sched_getaffinity(0, sizeof(updatedCPUSet), &updatedCPUSet), 0);
+  ITK_TEST_EXPECT_TRUE(CPU_EQUAL(&callerCPUSet, &updatedCPUSet));
+#endif
+  using OutputImageType = FilterType::OutputImageType;
+  itk::ImageRegionConstIterator<OutputImageType> outputIt(filter->GetOutput(), region);
+  itk::ImageRegionConstIterator<OutputImageType> numaOutputIt(numaFilter->GetOutput(), region);
+  for (; !outputIt.IsAtEnd(); ++outputIt, ++numaOutputIt)
+  {
+    ITK_TEST_EXPECT_EQUAL(numaOutputIt.Get(), outputIt.Get());
+  }
+
+  // The complex output of an FFT is first touched by the work units, and
+  // its buffer is kept by a later update.
+  using FFTFilterType = itk::Forward1DFFTImageFilter<ImageType>;
+  FFTFilterType::Pointer fftFilter = FFTFilterType::New();
+  fftFilter->SetInput(envelope);
+  fftFilter->SetMultiThreader(threader);
+  fftFilter->SetNumberOfWorkUnits(numberOfWorkUnits);
+  ITK_TRY_EXPECT_NO_EXCEPTION(fftFilter->Update());
+  using SpectrumImageType = FFTFilterType::OutputImageType;
+  using SpectrumContainerType = itk::FirstTouchImageContainer<itk::SizeValueType, SpectrumImageType::PixelType>;
+  ITK_TEST_EXPECT_TRUE(dynamic_cast<SpectrumContainerType *>(fftFilter->GetOutput()->GetPixelContainer()) !=
+                       nullptr);
+  const SpectrumImageType::PixelType * spectrumBuffer = fftFilter->GetOutput()->GetBufferPointer();
+  envelope->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(fftFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(fftFilter->GetOutput()->GetBufferPointer(), spectrumBuffer);
+
+  // The new buffer of a FirstTouchImageContainer is zeroed.
+  SpectrumImageType::Pointer spectrum = SpectrumImageType::New();
+  spectrum->SetRegions(region);
+  itk::AllocateFirstTouch(spectrum.GetPointer(), threader.GetPointer(), numberOfWorkUnits, 0);
+  ITK_TEST_EXPECT_TRUE(dynamic_cast<SpectrumContainerType *>(spectrum->GetPixelContainer()) != nullptr);
+  itk::ImageRegionConstIterator<SpectrumImageType> spectrumIt(spectrum, region);
+  for (; !spectrumIt.IsAtEnd(); ++spectrumIt)
+  {
+    ITK_TEST_EXPECT_EQUAL(spectrumIt.Get(), SpectrumImageType::PixelType());
+  }
+
+  // Once registered, it is the default threader of new filters.
+  ThreaderType::RegisterAsDefault();
+  ITK_TEST_EXPECT_TRUE(dynamic_cast<ThreaderType *>(itk::MultiThreaderBase::New().GetPointer()) != nullptr);
+  FilterType::Pointer defaultFilter = FilterType::New();
+  ITK_TEST_EXPECT_TRUE(dynamic_cast<ThreaderType *>(defaultFilter->GetMultiThreader()) != nullptr);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkNakagamiImageFilter.h"
+
+int
+itkNakagamiImageFilterTest(int, char *[])
+{
+  using EnvelopeImageType = itk::Image<float, 2>;
+  using FilterType = itk::NakagamiImageFilter<EnvelopeImageType>;
+  using OutputImageType = FilterType::OutputImageType;
+
+  // Rayleigh envelope of fully developed speckle, for which m is 1 and Omega
+  // is 2 sigma^2.
+  const double                sigma = 3.0;
+  EnvelopeImageType::SizeType size;
+  size[0] = 256;
+  size[1] = 96;
+  EnvelopeImageType::Pointer envelope = EnvelopeImageType::New();
+  envelope->SetRegions(size);
+  envelope->Allocate();
+  unsigned int                                         state = 12345u;
+  itk::ImageRegionIteratorWithIndex<EnvelopeImageType> it(envelope, envelope->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    state = 1664525u * state + 1013904223u;
+    const double uniform = (static_cast<double>(state >> 8) + 0.5) / 16777216.0;
+    it.Set(static_cast<float>(std::sqrt(-2.0 * sigma * sigma * std::log(uniform))));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, NakagamiImageFilter, BoxImageFilter);
+
+  FilterType::RadiusType radius;
+  radius[0] = 12;
+  radius[1] = 5;
+  filter->SetRadius(radius);
+  filter->SetInput(envelope);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+
+  const OutputImageType * shape = filter->GetShapeOutput();
+  const OutputImageType * scale = filter->GetScaleOutput();
+  ITK_TEST_EXPECT_EQUAL(shape->GetBufferedRegion(), envelope->GetLargestPossibleRegion());
+  ITK_TEST_EXPECT_EQUAL(scale->GetBufferedRegion(), envelope->GetLargestPossibleRegion());
+
+  // Over the interior, the means of the estimates.
+  EnvelopeImageType::RegionType interior = envelope->GetLargestPossibleRegion();
+  interior.ShrinkByRadius(radius);
+  double                                                  meanShape = 0.0;
+  double                                                  meanScale = 0.0;
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> shapeIt(shape, interior);
+  for (shapeIt.GoToBegin(); !shapeIt.IsAtEnd(); ++shapeIt)
+  {
+    meanShape += shapeIt.Get();
+    meanScale += scale->GetPixel(shapeIt.GetIndex());
+  }
+  meanShape /= interior.GetNumberOfPixels();
+  meanScale /= interior.GetNumberOfPixels();
+  std::cout << "Mean shape: " << meanShape << ", mean scale: " << meanScale << std::endl;
+  ITK_TEST_EXPECT_TRUE(std::abs(meanShape - 1.0) < 0.1);
+  ITK_TEST_EXPECT_TRUE(std::abs(meanScale - 2.0 * sigma * sigma) < 0.05 * 2.0 * sigma * sigma);
+
+  // The moments over the box, cropped by the image, directly.
+  const auto check = [&](const EnvelopeImageType::IndexType & index) {
+    double       sum2 = 0.0;
+    double       sum4 = 0.0;
+    unsigned int count = 0;
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const EnvelopeImageType::IndexType & sample = it.GetIndex();
+      if (std::abs(sample[0] - index[0]) <= static_cast<itk::IndexValueType>(radius[0]) &&
+          std::abs(sample[1] - index[1]) <= static_cast<itk::IndexValueType>(radius[1]))
+      {
+        const double square = static_cast<double>(it.Get()) * it.Get();
+        sum2 += square;
+        sum4 += square * square;
+        ++count;
+      }
+    }
+    const double expectedScale = sum2 / count;
+    const double expectedShape = expectedScale * expectedScale / (sum4 / count - expectedScale * expectedScale);
+    if (std::abs(scale->GetPixel(index) - expectedScale) > 1e-4 * expectedScale ||
+        std::abs(shape->GetPixel(index) - expectedShape) > 1e-4 * expectedShape)
+    {
+      std::cerr << "At " << index << ", expected " << expectedShape << ", " << expectedScale << ", got "
+                << shape->GetPixel(index) << ", " << scale->GetPixel(index) << std::endl;
+      return false;
+    }
+    return true;
+  };
+  EnvelopeImageType::IndexType index;
+  index[0] = 100;
+  index[1] = 40;
+  ITK_TEST_EXPECT_TRUE(check(index));
+  index[0] = 3;
+  index[1] = 94;
+  ITK_TEST_EXPECT_TRUE(check(index));
+  index[0] = 255;
+  index[1] = 0;
+  ITK_TEST_EXPECT_TRUE(check(index));
+
+  // A constant envelope has the largest shape.
+  envelope->FillBuffer(2.0f);
+  envelope->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(shape->GetPixel(index), itk::NumericTraits<OutputImageType::PixelType>::max());
+  ITK_TEST_EXPECT_TRUE(std::abs(scale->GetPixel(index) - 4.0) < 1e-5);
+
+  return EXIT_SUCCESS;
+}
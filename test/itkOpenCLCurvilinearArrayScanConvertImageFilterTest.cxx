@@ -0,0 +1,139 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkCurvilinearArrayScanConvertImageFilter.h"
+#include "itkOpenCLCurvilinearArrayScanConvertImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using PixelType = float;
+using CurvilinearImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension>;
+using ImageType = itk::Image<PixelType, Dimension>;
+
+bool
+matches(const PixelType * expected, const PixelType * actual, itk::SizeValueType numberOfPixels)
+{
+  for (itk::SizeValueType ii = 0; ii < numberOfPixels; ++ii)
+  {
+    if (std::abs(actual[ii] - expected[ii]) > 1e-4 * (1.0 + std::abs(expected[ii])))
+    {
+      std::cerr << "Mismatch at pixel " << ii << ": expected " << expected[ii] << ", got " << actual[ii] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkOpenCLCurvilinearArrayScanConvertImageFilterTest(int, char *[])
+{
+  CurvilinearImageType::SizeType inputSize;
+  inputSize[0] = 96;
+  inputSize[1] = 48;
+  CurvilinearImageType::Pointer input = CurvilinearImageType::New();
+  input->SetRegions(inputSize);
+  input->Allocate();
+  input->SetLateralAngularSeparation((itk::Math::pi / 3.0) / (inputSize[1] - 1));
+  input->SetRadiusSampleSize(0.5);
+  input->SetFirstSampleDistance(10.0);
+  itk::ImageRegionIteratorWithIndex<CurvilinearImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    const CurvilinearImageType::IndexType & index = inputIt.GetIndex();
+    inputIt.Set(static_cast<PixelType>(2.0 + std::sin(0.1 * index[0]) * std::cos(0.2 * index[1])));
+  }
+
+  using FilterType = itk::CurvilinearArrayScanConvertImageFilter<CurvilinearImageType, ImageType>;
+  using OpenCLFilterType = itk::OpenCLCurvilinearArrayScanConvertImageFilter<CurvilinearImageType, ImageType>;
+  FilterType::Pointer       filter = FilterType::New();
+  OpenCLFilterType::Pointer openCLFilter = OpenCLFilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(
+    openCLFilter, OpenCLCurvilinearArrayScanConvertImageFilter, CurvilinearArrayScanConvertImageFilter);
+
+  FilterType::SizeType size;
+  size[0] = 80;
+  size[1] = 70;
+  FilterType::SpacingType spacing;
+  spacing.Fill(0.8);
+  FilterType::PointType origin;
+  origin[0] = -32.0;
+  origin[1] = 5.0;
+  FilterType * scanConverters[] = { filter.GetPointer(), openCLFilter.GetPointer() };
+  for (FilterType * scanConverter : scanConverters)
+  {
+    scanConverter->SetSize(size);
+    scanConverter->SetOutputSpacing(spacing);
+    scanConverter->SetOutputOrigin(origin);
+    scanConverter->SetDefaultPixelValue(-1.0f);
+    scanConverter->SetInput(input);
+  }
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(openCLFilter->Update());
+  const itk::SizeValueType numberOfPixels = filter->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
+  ITK_TEST_EXPECT_TRUE(
+    matches(filter->GetOutput()->GetBufferPointer(), openCLFilter->GetOutput()->GetBufferPointer(), numberOfPixels));
+
+  // A new frame with the same geometry reuses the table on the device.
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(inputIt.Get() * 3.0f - 1.0f);
+  }
+  input->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(openCLFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(openCLFilter->GetNumberOfLookupTableBuilds(), 1u);
+  ITK_TEST_EXPECT_TRUE(
+    matches(filter->GetOutput()->GetBufferPointer(), openCLFilter->GetOutput()->GetBufferPointer(), numberOfPixels));
+
+  // A frame already on the device.
+  try
+  {
+    const std::size_t inputBufferSize = input->GetBufferedRegion().GetNumberOfPixels() * sizeof(PixelType);
+    cl::Buffer        deviceInput(*openCLFilter->GetContext(),
+                           CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                           inputBufferSize,
+                           input->GetBufferPointer());
+    cl::Buffer deviceOutput(*openCLFilter->GetContext(), CL_MEM_WRITE_ONLY, numberOfPixels * sizeof(PixelType));
+    ITK_TRY_EXPECT_NO_EXCEPTION(openCLFilter->ScanConvertDeviceBuffer(deviceInput, deviceOutput));
+    std::vector<PixelType> output(numberOfPixels);
+    openCLFilter->GetCommandQueue()->enqueueReadBuffer(
+      deviceOutput, CL_TRUE, 0, numberOfPixels * sizeof(PixelType), output.data());
+    ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput()->GetBufferPointer(), output.data(), numberOfPixels));
+  }
+  catch (const cl::Error & e)
+  {
+    std::cerr << "Error in OpenCL: " << e.what() << "(" << e.err() << ")" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
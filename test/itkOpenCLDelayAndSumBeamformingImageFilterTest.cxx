@@ -0,0 +1,128 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkDelayAndSumBeamformingImageFilter.h"
+#include "itkOpenCLDelayAndSumBeamformingImageFilter.h"
+
+namespace
+{
+
+using PixelType = float;
+using ChannelImageType = itk::Image<PixelType, 3>;
+using RFImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, 2>;
+
+bool
+matches(const PixelType * expected, const PixelType * actual, itk::SizeValueType numberOfPixels)
+{
+  for (itk::SizeValueType ii = 0; ii < numberOfPixels; ++ii)
+  {
+    if (std::abs(actual[ii] - expected[ii]) > 1e-4 * (1.0 + std::abs(expected[ii])))
+    {
+      std::cerr << "Mismatch at pixel " << ii << ": expected " << expected[ii] << ", got " << actual[ii] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkOpenCLDelayAndSumBeamformingImageFilterTest(int, char *[])
+{
+  ChannelImageType::SizeType channelSize;
+  channelSize[0] = 1024;
+  channelSize[1] = 48;
+  channelSize[2] = 25;
+  ChannelImageType::Pointer channels = ChannelImageType::New();
+  channels->SetRegions(channelSize);
+  channels->Allocate();
+  itk::ImageRegionIteratorWithIndex<ChannelImageType> channelIt(channels, channels->GetLargestPossibleRegion());
+  for (channelIt.GoToBegin(); !channelIt.IsAtEnd(); ++channelIt)
+  {
+    const ChannelImageType::IndexType & index = channelIt.GetIndex();
+    channelIt.Set(static_cast<PixelType>(std::sin(0.7 * index[0] + 0.3 * index[1]) * std::cos(0.2 * index[2])));
+  }
+
+  using FilterType = itk::DelayAndSumBeamformingImageFilter<ChannelImageType, RFImageType>;
+  using OpenCLFilterType = itk::OpenCLDelayAndSumBeamformingImageFilter<ChannelImageType, RFImageType>;
+  FilterType::Pointer       filter = FilterType::New();
+  OpenCLFilterType::Pointer openCLFilter = OpenCLFilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(
+    openCLFilter, OpenCLDelayAndSumBeamformingImageFilter, DelayAndSumBeamformingImageFilter);
+
+  FilterType * beamformers[] = { filter.GetPointer(), openCLFilter.GetPointer() };
+  for (FilterType * beamformer : beamformers)
+  {
+    beamformer->SetSamplingFrequency(40.0e6);
+    beamformer->SetProbeRadius(40.0);
+    beamformer->SetElementAngularSeparation(0.01);
+    beamformer->SetLateralAngularSeparation(0.015);
+    beamformer->SetInput(channels);
+  }
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(openCLFilter->Update());
+  const itk::SizeValueType numberOfPixels = filter->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
+  ITK_TEST_EXPECT_TRUE(
+    matches(filter->GetOutput()->GetBufferPointer(), openCLFilter->GetOutput()->GetBufferPointer(), numberOfPixels));
+
+  // A new frame with the same geometry reuses the table on the device.
+  for (channelIt.GoToBegin(); !channelIt.IsAtEnd(); ++channelIt)
+  {
+    channelIt.Set(channelIt.Get() * 3.0f - 1.0f);
+  }
+  channels->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(openCLFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(openCLFilter->GetNumberOfTableBuilds(), 1u);
+  ITK_TEST_EXPECT_TRUE(
+    matches(filter->GetOutput()->GetBufferPointer(), openCLFilter->GetOutput()->GetBufferPointer(), numberOfPixels));
+
+  // Channel data already on the device.
+  try
+  {
+    const std::size_t channelBufferSize = channels->GetBufferedRegion().GetNumberOfPixels() * sizeof(PixelType);
+    cl::Buffer        deviceChannels(*openCLFilter->GetContext(),
+                              CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                              channelBufferSize,
+                              channels->GetBufferPointer());
+    cl::Buffer deviceRF(*openCLFilter->GetContext(), CL_MEM_WRITE_ONLY, numberOfPixels * sizeof(PixelType));
+    ITK_TRY_EXPECT_NO_EXCEPTION(openCLFilter->BeamformDeviceBuffer(deviceChannels, deviceRF));
+    std::vector<PixelType> rf(numberOfPixels);
+    openCLFilter->GetCommandQueue()->enqueueReadBuffer(
+      deviceRF, CL_TRUE, 0, numberOfPixels * sizeof(PixelType), rf.data());
+    ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput()->GetBufferPointer(), rf.data(), numberOfPixels));
+  }
+  catch (const cl::Error & e)
+  {
+    std::cerr << "Error in OpenCL: " << e.what() << "(" << e.err() << ")" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMirrorPadImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include "itkSpeckleReducingAnisotropicDiffusionImageFilter.h"
+#include "itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilter.h"
+
+int
+itkOpenCLSpeckleReducingAnisotropicDiffusionImageFilterTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using PixelType = float;
+  const unsigned int Dimension = 2;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  ImageType::Pointer image = itk::ReadImage<ImageType>(argv[1]);
+
+  // SRAD requires input image to be padded with 1 mirrored pixel
+  // at each image border.
+  using PadFilterType = itk::MirrorPadImageFilter<ImageType, ImageType>;
+  PadFilterType::Pointer padFilter = PadFilterType::New();
+  padFilter->SetInput(image);
+  ImageType::SizeType padSize;
+  padSize.Fill(1);
+  padFilter->SetPadLowerBound(padSize);
+  padFilter->SetPadUpperBound(padSize);
+  ITK_TRY_EXPECT_NO_EXCEPTION(padFilter->Update());
+
+  using SpeckleFilterType = itk::SpeckleReducingAnisotropicDiffusionImageFilter<ImageType>;
+  SpeckleFilterType::Pointer speckleFilter = SpeckleFilterType::New();
+  speckleFilter->SetInput(padFilter->GetOutput());
+  speckleFilter->SetNumberOfIterations(100);
+  speckleFilter->SetTimeStep(0.002);
+  ITK_TRY_EXPECT_NO_EXCEPTION(speckleFilter->Update());
+
+  using OpenCLSpeckleFilterType = itk::OpenCLSpeckleReducingAnisotropicDiffusionImageFilter<ImageType>;
+  OpenCLSpeckleFilterType::Pointer openCLSpeckleFilter = OpenCLSpeckleFilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(openCLSpeckleFilter,
+                                    OpenCLSpeckleReducingAnisotropicDiffusionImageFilter,
+                                    SpeckleReducingAnisotropicDiffusionImageFilter);
+
+  openCLSpeckleFilter->SetInput(padFilter->GetOutput());
+  openCLSpeckleFilter->SetNumberOfIterations(100);
+  openCLSpeckleFilter->SetTimeStep(0.002);
+  ITK_TRY_EXPECT_NO_EXCEPTION(openCLSpeckleFilter->Update());
+
+  // The OpenCL diffusion agrees with the CPU diffusion.
+  const ImageType * expected = speckleFilter->GetOutput();
+  const ImageType * actual = openCLSpeckleFilter->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(actual->GetLargestPossibleRegion(), expected->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> expectedIt(expected, expected->GetLargestPossibleRegion());
+  for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+  {
+    const PixelType actualPixel = actual->GetPixel(expectedIt.GetIndex());
+    if (std::abs(actualPixel - expectedIt.Get()) > 1e-3 * std::abs(expectedIt.Get()) + 1e-2)
+    {
+      std::cerr << "SRAD mismatch at " << expectedIt.GetIndex() << ": " << expectedIt.Get() << " vs. " << actualPixel
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkVectorImage.h"
+#include "itkTestingMacros.h"
+
+#include "itkSpectra1DSupportWindowImageFilter.h"
+#include "itkSpectra1DImageFilter.h"
+#include "itkOpenCLSpectra1DImageFilter.h"
+
+int
+itkOpenCLSpectra1DImageFilterTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * inputImageFileName = argv[1];
+
+  const unsigned int Dimension = 2;
+  using PixelType = short;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputImageFileName);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->UpdateLargestPossibleRegion());
+  ImageType::ConstPointer rfImage = reader->GetOutput();
+
+  ImageType::Pointer sideLines = ImageType::New();
+  sideLines->CopyInformation(rfImage);
+  sideLines->SetRegions(rfImage->GetLargestPossibleRegion());
+  sideLines->Allocate();
+  sideLines->FillBuffer(5);
+
+  using SpectraSupportWindowFilterType = itk::Spectra1DSupportWindowImageFilter<ImageType>;
+  SpectraSupportWindowFilterType::Pointer spectraSupportWindowFilter = SpectraSupportWindowFilterType::New();
+  spectraSupportWindowFilter->SetInput(sideLines);
+  spectraSupportWindowFilter->SetFFT1DSize(128);
+  spectraSupportWindowFilter->SetStep(16);
+  ITK_TRY_EXPECT_NO_EXCEPTION(spectraSupportWindowFilter->UpdateLargestPossibleRegion());
+  using SupportWindowImageType = SpectraSupportWindowFilterType::OutputImageType;
+
+  using SpectraImageType = itk::VectorImage<float, Dimension>;
+  using SpectraFilterType = itk::Spectra1DImageFilter<ImageType, SupportWindowImageType, SpectraImageType>;
+  using OpenCLSpectraFilterType = itk::OpenCLSpectra1DImageFilter<ImageType, SupportWindowImageType, SpectraImageType>;
+
+  // The OpenCL spectra agree with the CPU spectra, for all the bins and for
+  // a range of the bins in decibels.
+  for (unsigned int decibel = 0; decibel < 2; ++decibel)
+  {
+    SpectraFilterType::Pointer       spectraFilter = SpectraFilterType::New();
+    OpenCLSpectraFilterType::Pointer openCLSpectraFilter = OpenCLSpectraFilterType::New();
+    for (SpectraFilterType * filter : { spectraFilter.GetPointer(), openCLSpectraFilter.GetPointer() })
+    {
+      filter->SetInput(rfImage);
+      filter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+      if (decibel)
+      {
+        filter->SetFirstFrequencyBin(5);
+        filter->SetNumberOfFrequencyBins(10);
+        filter->DecibelOutputOn();
+      }
+      ITK_TRY_EXPECT_NO_EXCEPTION(filter->UpdateLargestPossibleRegion());
+    }
+
+    using IteratorType = itk::ImageRegionConstIteratorWithIndex<SpectraImageType>;
+    IteratorType expectedIt(spectraFilter->GetOutput(), spectraFilter->GetOutput()->GetLargestPossibleRegion());
+    IteratorType actualIt(openCLSpectraFilter->GetOutput(), spectraFilter->GetOutput()->GetLargestPossibleRegion());
+    for (expectedIt.GoToBegin(), actualIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt, ++actualIt)
+    {
+      const SpectraImageType::PixelType expectedPixel = expectedIt.Get();
+      const SpectraImageType::PixelType actualPixel = actualIt.Get();
+      for (unsigned int component = 0; component < expectedPixel.GetSize(); ++component)
+      {
+        const double tolerance = decibel ? 1e-2 : 1e-3 * std::abs(expectedPixel[component]) + 1e-12;
+        if (std::abs(expectedPixel[component] - actualPixel[component]) > tolerance)
+        {
+          std::cerr << "Spectra mismatch at " << expectedIt.GetIndex() << ", component " << component << ": "
+                    << expectedPixel[component] << " vs. " << actualPixel[component] << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkPersistenceImageFilter.h"
+
+namespace
+{
+
+using PixelType = float;
+using ImageType = itk::Image<PixelType, 2>;
+
+// A frame of a cine, with the values of value(index).
+template <typename TValue>
+ImageType::Pointer
+makeFrame(const ImageType::SizeType & size, TValue value)
+{
+  ImageType::Pointer frame = ImageType::New();
+  frame->SetRegions(size);
+  frame->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(frame, frame->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    it.Set(static_cast<PixelType>(value(it.GetIndex())));
+  }
+  return frame;
+}
+
+// Whether the output is expected(input, previous output) at every pixel.
+template <typename TExpected>
+bool
+matches(const ImageType * output, const ImageType * input, const ImageType * previous, TExpected expected)
+{
+  itk::ImageRegionConstIterator<ImageType> outputIt(output, output->GetBufferedRegion());
+  itk::ImageRegionConstIterator<ImageType> inputIt(input, input->GetBufferedRegion());
+  itk::ImageRegionConstIterator<ImageType> previousIt(previous, previous->GetBufferedRegion());
+  for (; !outputIt.IsAtEnd(); ++outputIt, ++inputIt, ++previousIt)
+  {
+    const double value = expected(inputIt.Get(), previousIt.Get());
+    if (std::abs(outputIt.Get() - value) > 1e-4 * (1.0 + std::abs(value)))
+    {
+      std::cerr << "Expected " << value << ", got " << outputIt.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkPersistenceImageFilterTest(int, char *[])
+{
+  ImageType::SizeType size;
+  size[0] = 300;
+  size[1] = 70;
+  const auto speckle = [](int frame) {
+    return [frame](const ImageType::IndexType & index) {
+      return 50.0 + 10.0 * std::sin(0.37 * index[0] + 1.3 * index[1] + 2.1 * frame);
+    };
+  };
+
+  using FilterType = itk::PersistenceImageFilter<ImageType>;
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, PersistenceImageFilter, InPlaceImageFilter);
+
+  ITK_TEST_SET_GET_VALUE(0.5, filter->GetPersistence());
+  ITK_TEST_SET_GET_VALUE(0.0, filter->GetMotionThreshold());
+  filter->InPlaceOff();
+
+  // The first frame passes through.
+  ImageType::Pointer frame = makeFrame(size, speckle(0));
+  filter->SetInput(frame);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfFilteredFrames(), 1u);
+  ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput(), frame, frame, [](double input, double) { return input; }));
+
+  // The next frames are averaged recursively with the previous output.
+  const double persistence = 0.75;
+  filter->SetPersistence(persistence);
+  ImageType::Pointer previous = filter->GetOutput();
+  for (int ii = 1; ii < 4; ++ii)
+  {
+    previous->DisconnectPipeline();
+    frame = makeFrame(size, speckle(ii));
+    filter->SetInput(frame);
+    ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+    ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput(), frame, previous, [persistence](double input, double last) {
+      return input + persistence * (last - input);
+    }));
+    previous = filter->GetOutput();
+  }
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfFilteredFrames(), 4u);
+
+  // With motion, the persistence decreases with the difference, and the
+  // pixels that moved more than the threshold pass through.
+  const double motionThreshold = 30.0;
+  filter->SetMotionThreshold(motionThreshold);
+  previous->DisconnectPipeline();
+  frame = makeFrame(size, [&speckle](const ImageType::IndexType & index) {
+    return speckle(4)(index) + (index[0] < 150 ? 0.0 : 100.0);
+  });
+  filter->SetInput(frame);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(
+    matches(filter->GetOutput(), frame, previous, [persistence, motionThreshold](double input, double last) {
+      const double difference = last - input;
+      return input + persistence * std::max(1.0 - std::abs(difference) / motionThreshold, 0.0) * difference;
+    }));
+
+  // After a reset, and for a new size, the frame passes through again.
+  filter->Reset();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfFilteredFrames(), 1u);
+  ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput(), frame, frame, [](double input, double) { return input; }));
+  ImageType::SizeType smallSize = size;
+  smallSize[1] = 20;
+  frame = makeFrame(smallSize, speckle(5));
+  filter->SetInput(frame);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfFilteredFrames(), 1u);
+  ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput(), frame, frame, [](double input, double) { return input; }));
+
+  // In place, the output takes over the buffer of the frame.
+  filter->InPlaceOn();
+  filter->SetMotionThreshold(0.0);
+  previous = filter->GetOutput();
+  previous->DisconnectPipeline();
+  frame = makeFrame(smallSize, speckle(6));
+  const ImageType::Pointer expectedInput = makeFrame(smallSize, speckle(6));
+  const PixelType *        frameBuffer = frame->GetBufferPointer();
+  filter->SetInput(frame);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetBufferPointer(), frameBuffer);
+  ITK_TEST_EXPECT_TRUE(matches(filter->GetOutput(), expectedInput, previous, [persistence](double input, double last) {
+    return input + persistence * (last - input);
+  }));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <vector>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+#include "itkPhaseShiftDisplacementImageFilter.h"
+
+namespace
+{
+
+using ComplexPixelType = std::complex<float>;
+using ComplexImageType = itk::Image<ComplexPixelType, 2>;
+
+// The analytic signal of a speckle frame: Gaussian pulses at the scatterers
+// of every line, after they moved by displacement(position) samples, and
+// demodulated by demodulationFrequency radians per sample.
+template <typename TDisplacement>
+ComplexImageType::Pointer
+makeFrame(const ComplexImageType::SizeType & size,
+          double                             frequency,
+          double                             demodulationFrequency,
+          TDisplacement                      displacement)
+{
+  ComplexImageType::Pointer frame = ComplexImageType::New();
+  frame->SetRegions(size);
+  ComplexImageType::SpacingType spacing;
+  spacing[0] = 0.02;
+  spacing[1] = 0.3;
+  frame->SetSpacing(spacing);
+  frame->Allocate();
+  frame->FillBuffer(ComplexPixelType(0.0f));
+
+  unsigned int random = 12345u;
+  const auto   uniform = [&random]() {
+    random = 1664525u * random + 1013904223u;
+    return (random >> 8) / double(1u << 24);
+  };
+  const double sigma = 3.0;
+  for (itk::SizeValueType line = 0; line < size[1]; ++line)
+  {
+    for (itk::SizeValueType scatterer = 0; scatterer < size[0]; ++scatterer)
+    {
+      const double amplitude = uniform() - 0.5;
+      double       position = scatterer + uniform();
+      position += displacement(position);
+      ComplexImageType::IndexType index;
+      index[1] = line;
+      for (index[0] = 0; index[0] < static_cast<itk::IndexValueType>(size[0]); ++index[0])
+      {
+        const double offset = index[0] - position;
+        if (std::abs(offset) < 5.0 * sigma)
+        {
+          const double envelope = amplitude * std::exp(-0.5 * offset * offset / (sigma * sigma));
+          const double phase = frequency * offset - demodulationFrequency * index[0];
+          frame->GetPixel(index) += ComplexPixelType(envelope * std::cos(phase), envelope * std::sin(phase));
+        }
+      }
+    }
+  }
+  return frame;
+}
+
+// Whether the axial displacements away from the edges are the expected ones.
+template <typename TFilter, typename TDisplacement>
+bool
+checkDisplacements(const TFilter * filter, TDisplacement displacement)
+{
+  using DisplacementImageType = typename TFilter::DisplacementImageType;
+  using CorrelationImageType = typename TFilter::CorrelationImageType;
+  const DisplacementImageType * output = filter->GetOutput();
+  const CorrelationImageType *  correlation = filter->GetCorrelationOutput();
+  const double                  spacing = output->GetSpacing()[0];
+
+  typename DisplacementImageType::RegionType region = output->GetBufferedRegion();
+  region.ShrinkByRadius(filter->GetKernelRadius());
+  itk::ImageRegionConstIteratorWithIndex<DisplacementImageType> it(output, region);
+  double                                                         maximumError = 0.0;
+  double                                                         meanError = 0.0;
+  double                                                         minimumCorrelation = 1.0;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const double error = std::abs(it.Get()[0] / spacing - displacement(it.GetIndex()[0]));
+    maximumError = std::max(maximumError, error);
+    meanError += error;
+    minimumCorrelation = std::min(minimumCorrelation, double(correlation->GetPixel(it.GetIndex())));
+    if (it.Get()[1] != 0.0f)
+    {
+      std::cerr << "Lateral displacement " << it.Get()[1] << " at " << it.GetIndex() << std::endl;
+      return false;
+    }
+  }
+  meanError /= region.GetNumberOfPixels();
+  std::cout << "Maximum error: " << maximumError << " sample, mean error: " << meanError
+            << " sample, minimum correlation: " << minimumCorrelation << std::endl;
+  return maximumError < 0.1 && meanError < 0.03 && minimumCorrelation > 0.9;
+}
+
+} // namespace
+
+int
+itkPhaseShiftDisplacementImageFilterTest(int, char *[])
+{
+  ComplexImageType::SizeType size;
+  size[0] = 256;
+  size[1] = 16;
+  const double frequency = 2.0 * itk::Math::pi * 0.1;
+  // An offset plus a strain of 0.001.
+  const auto displacement = [](double position) { return 0.2 + 0.001 * position; };
+  const auto none = [](double) { return 0.0; };
+
+  using FilterType = itk::PhaseShiftDisplacementImageFilter<ComplexImageType>;
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, PhaseShiftDisplacementImageFilter, ImageToImageFilter);
+
+  FilterType::RadiusType kernelRadius;
+  kernelRadius[0] = 8;
+  kernelRadius[1] = 2;
+  ITK_TEST_SET_GET_VALUE(kernelRadius, filter->GetKernelRadius());
+  ITK_TEST_SET_GET_VALUE(0.0, filter->GetDemodulationFrequency());
+  ITK_TEST_SET_GET_VALUE(0.0, filter->GetSamplingFrequency());
+
+  // Analytic signals.
+  ComplexImageType::Pointer fixed = makeFrame(size, frequency, 0.0, none);
+  ComplexImageType::Pointer moving = makeFrame(size, frequency, 0.0, displacement);
+  filter->SetFixedImage(fixed);
+  filter->SetMovingImage(moving);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(checkDisplacements(filter.GetPointer(), displacement));
+
+  // IQ data, with the frequency of the echo from the demodulation.
+  const double samplingFrequency = 50.0e6;
+  filter->SetDemodulationFrequency(0.1 * samplingFrequency);
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+  filter->SetSamplingFrequency(samplingFrequency);
+  filter->SetFixedImage(makeFrame(size, frequency, frequency, none));
+  filter->SetMovingImage(makeFrame(size, frequency, frequency, displacement));
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(checkDisplacements(filter.GetPointer(), displacement));
+
+  // A larger kernel over the same frames.
+  kernelRadius[0] = 16;
+  kernelRadius[1] = 0;
+  filter->SetKernelRadius(kernelRadius);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(checkDisplacements(filter.GetPointer(), displacement));
+
+  // Frames of different sizes.
+  ComplexImageType::SizeType smallSize = size;
+  smallSize[1] = 8;
+  filter->SetMovingImage(makeFrame(smallSize, frequency, frequency, displacement));
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  return EXIT_SUCCESS;
+}
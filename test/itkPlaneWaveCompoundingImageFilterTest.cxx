@@ -0,0 +1,265 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkPlaneWaveCompoundingImageFilter.h"
+
+namespace
+{
+
+using PixelType = float;
+using ChannelImageType = itk::Image<PixelType, 3>;
+using RFImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, 2>;
+using RFBatchImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, 3>;
+using FilterType = itk::PlaneWaveCompoundingImageFilter<ChannelImageType, RFImageType>;
+
+const double speedOfSound = 1.54e6;
+const double samplingFrequency = 40.0e6;
+const double centerFrequency = 5.0e6;
+const double probeRadius = 40.0;
+const double angularSeparation = 0.01;
+
+const itk::SizeValueType numberOfChannelSamples = 2048;
+const itk::SizeValueType numberOfElements = 65;
+
+// A point scatterer on the middle line, 20 mm deep.
+const double scattererRadius = probeRadius + 20.0;
+
+double
+elementAngle(itk::SizeValueType element)
+{
+  return (element - (numberOfElements - 1) / 2.0) * angularSeparation;
+}
+
+// Time of the echo of the plane wave steered by steeringAngle on the
+// scatterer, back to the element.
+double
+echoTime(double steeringAngle, itk::SizeValueType element)
+{
+  const double transmitDistance = scattererRadius * std::cos(steeringAngle) - probeRadius * std::cos(steeringAngle);
+  const double angle = elementAngle(element);
+  const double receiveDistance =
+    std::sqrt(scattererRadius * scattererRadius + probeRadius * probeRadius -
+              2.0 * scattererRadius * probeRadius * std::cos(angle));
+  return (transmitDistance + receiveDistance) / speedOfSound;
+}
+
+template <typename TImage>
+typename TImage::IndexType
+findPeak(const TImage * image)
+{
+  double                     peak = 0.0;
+  typename TImage::IndexType peakIndex;
+  peakIndex.Fill(0);
+  itk::ImageRegionConstIteratorWithIndex<TImage> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    if (std::abs(it.Get()) > peak)
+    {
+      peak = std::abs(it.Get());
+      peakIndex = it.GetIndex();
+    }
+  }
+  return peakIndex;
+}
+
+} // namespace
+
+int
+itkPlaneWaveCompoundingImageFilterTest(int, char *[])
+{
+  const FilterType::SteeringAnglesType steeringAngles{ -0.1, 0.0, 0.1 };
+  const itk::SizeValueType             numberOfAngles = steeringAngles.size();
+  ChannelImageType::SizeType           channelSize;
+  channelSize[0] = numberOfChannelSamples;
+  channelSize[1] = numberOfElements;
+  channelSize[2] = numberOfAngles;
+  ChannelImageType::Pointer channels = ChannelImageType::New();
+  channels->SetRegions(channelSize);
+  channels->Allocate();
+  itk::ImageRegionIteratorWithIndex<ChannelImageType> channelIt(channels, channels->GetLargestPossibleRegion());
+  for (channelIt.GoToBegin(); !channelIt.IsAtEnd(); ++channelIt)
+  {
+    const ChannelImageType::IndexType & index = channelIt.GetIndex();
+    const double time = echoTime(steeringAngles[index[2]], index[1]);
+    const double phase = (index[0] / samplingFrequency - time) * centerFrequency;
+    channelIt.Set(static_cast<PixelType>(std::exp(-phase * phase) * std::cos(2.0 * itk::Math::pi * phase)));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, PlaneWaveCompoundingImageFilter, ImageToImageFilter);
+
+  filter->SetInput(channels);
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  ITK_TEST_SET_GET_VALUE(1.54e6, filter->GetSpeedOfSound());
+  ITK_TEST_EXPECT_EQUAL(filter->GetSteeringAngles().size(), 1u);
+  filter->SetSamplingFrequency(samplingFrequency);
+  filter->SetProbeRadius(probeRadius);
+  filter->SetElementAngularSeparation(angularSeparation);
+  // The three transmit events are not a single plane wave.
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+  filter->SetSteeringAngles(steeringAngles);
+  ITK_TEST_EXPECT_EQUAL(filter->GetSteeringAngles().size(), numberOfAngles);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 1u);
+
+  const RFImageType *         rf = filter->GetOutput();
+  const RFImageType::SizeType rfSize = rf->GetLargestPossibleRegion().GetSize();
+  ITK_TEST_EXPECT_EQUAL(rfSize[0], numberOfChannelSamples);
+  ITK_TEST_EXPECT_EQUAL(rfSize[1], numberOfElements);
+  ITK_TEST_EXPECT_EQUAL(rf->GetLateralAngularSeparation(), angularSeparation);
+  const double radiusSampleSize = speedOfSound / (2.0 * samplingFrequency);
+
+  // The angles are compounded onto the scatterer.
+  const double                 scattererSample = (scattererRadius - probeRadius) / radiusSampleSize;
+  const RFImageType::IndexType peakIndex = findPeak(rf);
+  std::cout << "Peak " << rf->GetPixel(peakIndex) << " at " << peakIndex << std::endl;
+  ITK_TEST_EXPECT_EQUAL(peakIndex[1], static_cast<itk::IndexValueType>(numberOfElements / 2));
+  ITK_TEST_EXPECT_TRUE(std::abs(peakIndex[0] - scattererSample) <= 2.0);
+
+  // The peak of the compounded line is the sum of the peaks of the angles.
+  double angleSum = 0.0;
+  for (itk::SizeValueType angle = 0; angle < numberOfAngles; ++angle)
+  {
+    ChannelImageType::RegionType angleRegion = channels->GetLargestPossibleRegion();
+    angleRegion.SetIndex(2, angle);
+    angleRegion.SetSize(2, 1);
+    ChannelImageType::Pointer angleChannels = ChannelImageType::New();
+    angleChannels->SetRegions(angleRegion.GetSize());
+    angleChannels->Allocate();
+    itk::ImageRegionConstIteratorWithIndex<ChannelImageType> eventIt(channels, angleRegion);
+    itk::ImageRegionIteratorWithIndex<ChannelImageType>      angleIt(angleChannels, angleChannels->GetBufferedRegion());
+    for (eventIt.GoToBegin(), angleIt.GoToBegin(); !angleIt.IsAtEnd(); ++eventIt, ++angleIt)
+    {
+      angleIt.Set(eventIt.Get());
+    }
+    FilterType::Pointer angleFilter = FilterType::New();
+    angleFilter->SetInput(angleChannels);
+    angleFilter->SetSamplingFrequency(samplingFrequency);
+    angleFilter->SetProbeRadius(probeRadius);
+    angleFilter->SetElementAngularSeparation(angularSeparation);
+    angleFilter->SetSteeringAngles(FilterType::SteeringAnglesType(1, steeringAngles[angle]));
+    ITK_TRY_EXPECT_NO_EXCEPTION(angleFilter->Update());
+    angleSum += angleFilter->GetOutput()->GetPixel(peakIndex);
+  }
+  std::cout << "Sum of the angles " << angleSum << std::endl;
+  ITK_TEST_EXPECT_TRUE(std::abs(rf->GetPixel(peakIndex) - angleSum) < 1e-3 * (1.0 + std::abs(angleSum)));
+
+  // A new frame with the same geometry reuses the tables.
+  for (channelIt.GoToBegin(); !channelIt.IsAtEnd(); ++channelIt)
+  {
+    channelIt.Set(2.0f * channelIt.Get());
+  }
+  channels->Modified();
+  const PixelType peak = rf->GetPixel(peakIndex);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 1u);
+  ITK_TEST_EXPECT_TRUE(std::abs(filter->GetOutput()->GetPixel(peakIndex) - 2.0f * peak) < 1e-3 * std::abs(peak));
+
+  // A batch of two frames in one update, the second half the first.
+  using BatchFilterType = itk::PlaneWaveCompoundingImageFilter<ChannelImageType, RFBatchImageType>;
+  ChannelImageType::SizeType batchSize = channelSize;
+  batchSize[2] = 2 * numberOfAngles;
+  ChannelImageType::Pointer batch = ChannelImageType::New();
+  batch->SetRegions(batchSize);
+  batch->Allocate();
+  itk::ImageRegionIteratorWithIndex<ChannelImageType> batchIt(batch, batch->GetLargestPossibleRegion());
+  for (batchIt.GoToBegin(); !batchIt.IsAtEnd(); ++batchIt)
+  {
+    ChannelImageType::IndexType index = batchIt.GetIndex();
+    const itk::IndexValueType   frame = index[2] / numberOfAngles;
+    index[2] %= numberOfAngles;
+    batchIt.Set(channels->GetPixel(index) / (1.0f + frame));
+  }
+  BatchFilterType::Pointer batchFilter = BatchFilterType::New();
+  batchFilter->SetInput(batch);
+  batchFilter->SetSamplingFrequency(samplingFrequency);
+  batchFilter->SetProbeRadius(probeRadius);
+  batchFilter->SetElementAngularSeparation(angularSeparation);
+  batchFilter->SetSteeringAngles(steeringAngles);
+  ITK_TRY_EXPECT_NO_EXCEPTION(batchFilter->Update());
+  const RFBatchImageType * rfBatch = batchFilter->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(rfBatch->GetLargestPossibleRegion().GetSize(2), 2u);
+  bool batchMatches = true;
+  itk::ImageRegionConstIteratorWithIndex<RFImageType> rfIt(rf, rf->GetLargestPossibleRegion());
+  for (rfIt.GoToBegin(); !rfIt.IsAtEnd(); ++rfIt)
+  {
+    RFBatchImageType::IndexType batchIndex;
+    batchIndex[0] = rfIt.GetIndex()[0];
+    batchIndex[1] = rfIt.GetIndex()[1];
+    for (batchIndex[2] = 0; batchIndex[2] < 2; ++batchIndex[2])
+    {
+      const double expected = rfIt.Get() / (1.0 + batchIndex[2]);
+      batchMatches = batchMatches && std::abs(rfBatch->GetPixel(batchIndex) - expected) < 1e-4 * (1.0 + std::abs(peak));
+    }
+  }
+  ITK_TEST_EXPECT_TRUE(batchMatches);
+
+  // IQ channel data demodulated at the center frequency is compounded to the
+  // baseband, with its envelope on the scatterer.
+  using IQPixelType = std::complex<float>;
+  using IQChannelImageType = itk::Image<IQPixelType, 3>;
+  using IQImageType = itk::CurvilinearArraySpecialCoordinatesImage<IQPixelType, 2>;
+  using IQFilterType = itk::PlaneWaveCompoundingImageFilter<IQChannelImageType, IQImageType>;
+  IQChannelImageType::Pointer iqChannels = IQChannelImageType::New();
+  iqChannels->SetRegions(channelSize);
+  iqChannels->Allocate();
+  itk::ImageRegionIteratorWithIndex<IQChannelImageType> iqIt(iqChannels, iqChannels->GetLargestPossibleRegion());
+  for (iqIt.GoToBegin(); !iqIt.IsAtEnd(); ++iqIt)
+  {
+    const IQChannelImageType::IndexType & index = iqIt.GetIndex();
+    const double time = echoTime(steeringAngles[index[2]], index[1]);
+    const double phase = (index[0] / samplingFrequency - time) * centerFrequency;
+    iqIt.Set(static_cast<IQPixelType>(std::polar(0.5 * std::exp(-phase * phase),
+                                                 -2.0 * itk::Math::pi * centerFrequency * time)));
+  }
+  IQFilterType::Pointer iqFilter = IQFilterType::New();
+  iqFilter->SetInput(iqChannels);
+  iqFilter->SetSamplingFrequency(samplingFrequency);
+  iqFilter->SetDemodulationFrequency(centerFrequency);
+  ITK_TEST_SET_GET_VALUE(centerFrequency, iqFilter->GetDemodulationFrequency());
+  iqFilter->SetProbeRadius(probeRadius);
+  iqFilter->SetElementAngularSeparation(angularSeparation);
+  iqFilter->SetSteeringAngles(steeringAngles);
+  ITK_TRY_EXPECT_NO_EXCEPTION(iqFilter->Update());
+  const IQImageType::IndexType iqPeakIndex = findPeak(iqFilter->GetOutput());
+  std::cout << "IQ peak " << iqFilter->GetOutput()->GetPixel(iqPeakIndex) << " at " << iqPeakIndex << std::endl;
+  ITK_TEST_EXPECT_EQUAL(iqPeakIndex[1], peakIndex[1]);
+  ITK_TEST_EXPECT_TRUE(std::abs(iqPeakIndex[0] - scattererSample) <= 2.0);
+
+  // Fewer lines, and a new geometry.
+  filter->SetNumberOfLines(33);
+  filter->SetLateralAngularSeparation(2.0 * angularSeparation);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleRegion().GetSize(1), 33u);
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTableBuilds(), 2u);
+  ITK_TEST_EXPECT_EQUAL(findPeak(filter->GetOutput())[1], 16);
+
+  return EXIT_SUCCESS;
+}
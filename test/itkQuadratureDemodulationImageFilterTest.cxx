@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+#include "itkBModeImageFilter.h"
+#include "itkQuadratureDemodulationImageFilter.h"
+
+int
+itkQuadratureDemodulationImageFilterTest(int, char *[])
+{
+  using PixelType = double;
+  const unsigned int Dimension = 2;
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PixelType>, Dimension>;
+
+  // Gaussian pulses at the center frequency, deeper on every line.
+  const double             samplingFrequency = 40.0e6;
+  const double             centerFrequency = 5.0e6;
+  const double             amplitude = 100.0;
+  const itk::SizeValueType numberOfSamples = 1000;
+  const itk::SizeValueType numberOfLines = 8;
+  const auto               pulseCenter = [](itk::IndexValueType line) { return 400.0 + 10.0 * line; };
+  ImageType::SizeType      size;
+  size[0] = numberOfSamples;
+  size[1] = numberOfLines;
+  ImageType::Pointer rf = ImageType::New();
+  rf->SetRegions(size);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.01925;
+  spacing[1] = 0.3;
+  rf->SetSpacing(spacing);
+  rf->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> rfIt(rf, rf->GetLargestPossibleRegion());
+  for (rfIt.GoToBegin(); !rfIt.IsAtEnd(); ++rfIt)
+  {
+    const ImageType::IndexType & index = rfIt.GetIndex();
+    const double                 offset = index[0] - pulseCenter(index[1]);
+    rfIt.Set(amplitude * std::exp(-offset * offset / 800.0) *
+             std::cos(2.0 * itk::Math::pi * centerFrequency / samplingFrequency * offset));
+  }
+
+  using DemodulationFilterType = itk::QuadratureDemodulationImageFilter<ImageType, ComplexImageType>;
+  DemodulationFilterType::Pointer demodulation = DemodulationFilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(demodulation, QuadratureDemodulationImageFilter, ImageToImageFilter);
+
+  demodulation->SetInput(rf);
+  ITK_TRY_EXPECT_EXCEPTION(demodulation->Update());
+  demodulation->SetSamplingFrequency(samplingFrequency);
+  ITK_TEST_SET_GET_VALUE(samplingFrequency, demodulation->GetSamplingFrequency());
+  demodulation->SetDemodulationFrequency(centerFrequency);
+  ITK_TEST_SET_GET_VALUE(centerFrequency, demodulation->GetDemodulationFrequency());
+  ITK_TEST_SET_GET_VALUE(4u, demodulation->GetDecimationFactor());
+  ITK_TEST_SET_GET_VALUE(8u, demodulation->GetNumberOfTapsPerPhase());
+  ITK_TRY_EXPECT_NO_EXCEPTION(demodulation->Update());
+
+  // One sample in four, with four times the spacing.
+  const ComplexImageType * iq = demodulation->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(iq->GetLargestPossibleRegion().GetSize(0), numberOfSamples / 4);
+  ITK_TEST_EXPECT_EQUAL(iq->GetLargestPossibleRegion().GetSize(1), numberOfLines);
+  ITK_TEST_EXPECT_TRUE(std::abs(iq->GetSpacing()[0] - 4.0 * spacing[0]) < 1e-12);
+  ITK_TEST_EXPECT_EQUAL(iq->GetSpacing()[1], spacing[1]);
+
+  // The modulus is the envelope, and the phase the one of the pulse in the
+  // baseband.
+  const double angularFrequency = 2.0 * itk::Math::pi * centerFrequency / samplingFrequency;
+  double       maximumEnvelopeError = 0.0;
+  double       maximumPhaseError = 0.0;
+  itk::ImageRegionConstIteratorWithIndex<ComplexImageType> iqIt(iq, iq->GetLargestPossibleRegion());
+  for (iqIt.GoToBegin(); !iqIt.IsAtEnd(); ++iqIt)
+  {
+    const ComplexImageType::IndexType & index = iqIt.GetIndex();
+    const double                        offset = 4.0 * index[0] - pulseCenter(index[1]);
+    const double                        envelope = amplitude * std::exp(-offset * offset / 800.0);
+    maximumEnvelopeError = std::max(maximumEnvelopeError, std::abs(std::abs(iqIt.Get()) - envelope));
+    if (envelope > 0.5 * amplitude)
+    {
+      const std::complex<double> expected = std::polar(1.0, -angularFrequency * pulseCenter(index[1]));
+      maximumPhaseError = std::max(maximumPhaseError, std::abs(std::arg(iqIt.Get() / expected)));
+    }
+  }
+  std::cout << "Maximum envelope error " << maximumEnvelopeError << ", maximum phase error " << maximumPhaseError
+            << std::endl;
+  ITK_TEST_EXPECT_TRUE(maximumEnvelopeError < 0.02 * amplitude);
+  ITK_TEST_EXPECT_TRUE(maximumPhaseError < 0.02);
+
+  // The B-mode of the IQ data is the log compressed envelope, on the
+  // decimated samples, and close to the B-mode of the analytic signal.
+  using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+  BModeFilterType::Pointer analyticBMode = BModeFilterType::New();
+  analyticBMode->SetInput(rf);
+  ITK_TRY_EXPECT_NO_EXCEPTION(analyticBMode->Update());
+
+  BModeFilterType::Pointer bMode = BModeFilterType::New();
+  bMode->SetInput(rf);
+  BModeFilterType::DemodulationFilterType::Pointer bModeDemodulation = BModeFilterType::DemodulationFilterType::New();
+  bModeDemodulation->SetSamplingFrequency(samplingFrequency);
+  bModeDemodulation->SetDemodulationFrequency(centerFrequency);
+  bMode->SetDemodulationFilter(bModeDemodulation);
+  ITK_TEST_EXPECT_EQUAL(bMode->GetDemodulationFilter(), bModeDemodulation.GetPointer());
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  const ImageType * output = bMode->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(output->GetLargestPossibleRegion(), iq->GetLargestPossibleRegion());
+  ITK_TEST_EXPECT_EQUAL(output->GetSpacing(), iq->GetSpacing());
+  double maximumLogError = 0.0;
+  double maximumAnalyticError = 0.0;
+  itk::ImageRegionConstIteratorWithIndex<ImageType> outputIt(output, output->GetLargestPossibleRegion());
+  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt)
+  {
+    const ImageType::IndexType & index = outputIt.GetIndex();
+    const double expected = std::log10(std::abs(iq->GetPixel(index)) + 1.0);
+    maximumLogError = std::max(maximumLogError, std::abs(outputIt.Get() - expected));
+    ImageType::IndexType analyticIndex = index;
+    analyticIndex[0] *= 4;
+    if (std::abs(analyticIndex[0] - pulseCenter(index[1])) < 20.0)
+    {
+      maximumAnalyticError =
+        std::max(maximumAnalyticError, std::abs(outputIt.Get() - analyticBMode->GetOutput()->GetPixel(analyticIndex)));
+    }
+  }
+  std::cout << "Maximum log error " << maximumLogError << ", maximum difference to the analytic signal "
+            << maximumAnalyticError << std::endl;
+  ITK_TEST_EXPECT_TRUE(maximumLogError < 1e-9);
+  ITK_TEST_EXPECT_TRUE(maximumAnalyticError < 0.02);
+
+  // Only the decimated images are estimated: the output, the IQ data, the
+  // envelope and the envelope plus one.
+  const itk::SizeValueType decimatedPixels = numberOfSamples / 4 * numberOfLines;
+  ITK_TEST_EXPECT_EQUAL(bMode->EstimateMemoryFootprint(),
+                        decimatedPixels * (3 * sizeof(PixelType) + sizeof(std::complex<PixelType>)));
+
+  // Without the demodulation, the B-mode is the analytic one again.
+  bMode->SetDemodulationFilter(nullptr);
+  ITK_TRY_EXPECT_NO_EXCEPTION(bMode->Update());
+  ITK_TEST_EXPECT_EQUAL(bMode->GetOutput()->GetLargestPossibleRegion(), rf->GetLargestPossibleRegion());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkRegionFromReferenceImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using ImageType = itk::Image<float, Dimension>;
+using FilterType = itk::RegionFromReferenceImageFilter<ImageType>;
+
+float
+pixelValue(const ImageType::IndexType & index)
+{
+  return static_cast<float>(100 * index[1] + index[0]);
+}
+
+// Crop the input to the region of a reference and check the values.  Returns
+// the output, or nullptr on failure.
+ImageType::Pointer
+crop(const ImageType * input, const ImageType::RegionType & referenceRegion, bool inPlace)
+{
+  ImageType::Pointer reference = ImageType::New();
+  reference->SetRegions(referenceRegion);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(input);
+  filter->SetReferenceImage(reference);
+  filter->SetInPlace(inPlace);
+  try
+  {
+    filter->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return nullptr;
+  }
+
+  ImageType::Pointer output = filter->GetOutput();
+  if (output->GetLargestPossibleRegion() != referenceRegion || output->GetBufferedRegion() != referenceRegion)
+  {
+    std::cerr << "Unexpected output region " << output->GetBufferedRegion() << std::endl;
+    return nullptr;
+  }
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(output, referenceRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    if (it.Get() != pixelValue(it.GetIndex()))
+    {
+      std::cerr << "Mismatch at " << it.GetIndex() << ": " << it.Get() << std::endl;
+      return nullptr;
+    }
+  }
+  return output;
+}
+
+} // namespace
+
+int
+itkRegionFromReferenceImageFilterTest(int, char *[])
+{
+  ImageType::SizeType size;
+  size[0] = 16;
+  size[1] = 8;
+  ImageType::Pointer input = ImageType::New();
+  input->SetRegions(size);
+  input->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(pixelValue(inputIt.GetIndex()));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, RegionFromReferenceImageFilter, ExtractImageFilter);
+
+  // Cropping the lines, the slowest direction, is a view of the input.
+  ImageType::IndexType index;
+  index[0] = 0;
+  index[1] = 2;
+  ImageType::SizeType referenceSize;
+  referenceSize[0] = 16;
+  referenceSize[1] = 5;
+  ImageType::RegionType lines(index, referenceSize);
+  ImageType::Pointer    output = crop(input, lines, true);
+  if (!output)
+  {
+    return EXIT_FAILURE;
+  }
+  ITK_TEST_EXPECT_EQUAL(output->GetBufferPointer(), input->GetBufferPointer() + input->ComputeOffset(index));
+
+  // Without InPlace, the region is copied.
+  output = crop(input, lines, false);
+  if (!output)
+  {
+    return EXIT_FAILURE;
+  }
+  ITK_TEST_EXPECT_TRUE(output->GetBufferPointer() != input->GetBufferPointer() + input->ComputeOffset(index));
+
+  // Cropping the samples, the fastest direction, is not contiguous, and is
+  // copied.
+  index[0] = 3;
+  index[1] = 0;
+  referenceSize[0] = 10;
+  referenceSize[1] = 8;
+  ImageType::RegionType samples(index, referenceSize);
+  output = crop(input, samples, true);
+  if (!output)
+  {
+    return EXIT_FAILURE;
+  }
+  ITK_TEST_EXPECT_TRUE(output->GetBufferPointer() != input->GetBufferPointer() + input->ComputeOffset(index));
+
+  return EXIT_SUCCESS;
+}
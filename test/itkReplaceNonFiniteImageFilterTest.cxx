@@ -60,7 +60,14 @@ itkReplaceNonFiniteImageFilterTest(int argc, char * argv[])
 
   using FilterType = itk::ReplaceNonFiniteImageFilter<ImageType>;
   FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, ReplaceNonFiniteImageFilter, UnaryFunctorImageFilter);
+
+  ITK_TEST_SET_GET_BOOLEAN(filter, ReportReplacedPixels, true);
+  ITK_TEST_EXPECT_TRUE(filter->GetInPlace());
+
   filter->SetInput(image);
+  const PixelType * inputBuffer = image->GetBufferPointer();
 
   using WriterType = itk::ImageFileWriter<ImageType>;
   WriterType::Pointer writer = WriterType::New();
@@ -76,5 +83,16 @@ itkReplaceNonFiniteImageFilterTest(int argc, char * argv[])
     return EXIT_FAILURE;
   }
 
+  // The replacement is done in the input buffer.
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetBufferPointer(), inputBuffer);
+
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfReplacedPixels(), 3u);
+  ImageType::RegionType expectedReplacedRegion;
+  index.Fill(3);
+  size.Fill(3);
+  expectedReplacedRegion.SetIndex(index);
+  expectedReplacedRegion.SetSize(size);
+  ITK_TEST_EXPECT_EQUAL(filter->GetReplacedPixelsRegion(), expectedReplacedRegion);
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageToVideoFilter.h"
+#include "itkSubtractImageFilter.h"
+#include "itkTestingMacros.h"
+#include "itkVideoStream.h"
+
+#include "itkRingBufferedVideoFilter.h"
+
+int
+itkRingBufferedVideoFilterTest(int, char *[])
+{
+  const unsigned int Dimension = 2;
+  using PixelType = float;
+  using VolumeType = itk::Image<PixelType, Dimension + 1>;
+  using FrameType = itk::Image<PixelType, Dimension>;
+  using VideoStreamType = itk::VideoStream<FrameType>;
+
+  // The frames are the slices along the last direction.
+  const itk::SizeValueType numberOfFrames = 6;
+  VolumeType::SizeType     size;
+  size[0] = 20;
+  size[1] = 9;
+  size[2] = numberOfFrames;
+  VolumeType::Pointer volume = VolumeType::New();
+  volume->SetRegions(size);
+  volume->Allocate();
+  itk::ImageRegionIteratorWithIndex<VolumeType> volumeIt(volume, volume->GetLargestPossibleRegion());
+  for (volumeIt.GoToBegin(); !volumeIt.IsAtEnd(); ++volumeIt)
+  {
+    const VolumeType::IndexType & index = volumeIt.GetIndex();
+    volumeIt.Set(static_cast<PixelType>(index[0] + 100 * index[1] + 10000 * index[2] * index[2]));
+  }
+  using VideoFilterType = itk::ImageToVideoFilter<VolumeType>;
+  VideoFilterType::Pointer videoFilter = VideoFilterType::New();
+  videoFilter->SetInput(volume);
+  videoFilter->SetFrameAxis(Dimension);
+
+  using FilterType = itk::RingBufferedVideoFilter<VideoStreamType, VideoStreamType>;
+  FilterType::Pointer filter = FilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, RingBufferedVideoFilter, VideoToVideoFilter);
+
+  // The difference of consecutive frames, computed in place by default.
+  using SubtractFilterType = itk::SubtractImageFilter<FrameType, FrameType, FrameType>;
+  SubtractFilterType::Pointer subtractFilter = SubtractFilterType::New();
+  ITK_TRY_EXPECT_EXCEPTION(filter->SetNumberOfFilterInputs(0));
+  const itk::SizeValueType numberOfFilterInputs = 2;
+  filter->SetNumberOfFilterInputs(numberOfFilterInputs);
+  ITK_TEST_SET_GET_VALUE(numberOfFilterInputs, filter->GetNumberOfFilterInputs());
+  const itk::SizeValueType numberOfBufferedFrames = 2;
+  filter->SetNumberOfBufferedFrames(numberOfBufferedFrames);
+  ITK_TEST_SET_GET_VALUE(numberOfBufferedFrames, filter->GetNumberOfBufferedFrames());
+  filter->SetInput(videoFilter->GetOutput());
+
+  // The frame filter is required.
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+  filter->SetFrameFilter(subtractFilter);
+  ITK_TEST_SET_GET_VALUE(subtractFilter.GetPointer(), filter->GetFrameFilter());
+
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->UpdateOutputInformation());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleTemporalRegion().GetFrameDuration(),
+                        numberOfFrames - 1);
+  for (itk::SizeValueType frame = 0; frame + 1 < numberOfFrames; ++frame)
+  {
+    itk::TemporalRegion requestedTemporalRegion;
+    requestedTemporalRegion.SetFrameStart(frame);
+    requestedTemporalRegion.SetFrameDuration(1);
+    filter->GetOutput()->SetRequestedTemporalRegion(requestedTemporalRegion);
+    ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+
+    const PixelType                                   expected = -10000.0f * (2 * frame + 1);
+    const FrameType *                                 frameImage = filter->GetOutput()->GetFrame(frame);
+    itk::ImageRegionConstIteratorWithIndex<FrameType> it(frameImage, frameImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (it.Get() != expected)
+      {
+        std::cerr << "Mismatch in frame " << frame << " at " << it.GetIndex() << ": expected " << expected
+                  << ", got " << it.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  ITK_TEST_EXPECT_TRUE(!subtractFilter->GetInPlace());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkResampleImageFilter.h"
+#include "itkTestingMacros.h"
+#include "itkWindowedSincInterpolateImageFunction.h"
+#include "itkZeroFluxNeumannBoundaryCondition.h"
+
+#include "itkSeparableWindowedSincResampleImageFilter.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+const unsigned int Radius = 4;
+using ImageType = itk::Image<float, Dimension>;
+using WindowType = itk::Function::WelchWindowFunction<Radius>;
+using FilterType = itk::SeparableWindowedSincResampleImageFilter<ImageType, ImageType, Radius, WindowType>;
+
+// Resample with the filter and with a ResampleImageFilter and a
+// WindowedSincInterpolateImageFunction, and compare.
+bool
+resampleMatches(const ImageType *              input,
+                const ImageType::SizeType &    size,
+                const ImageType::SpacingType & spacing,
+                const ImageType::PointType &   origin,
+                FilterType *                   filter)
+{
+  filter->SetInput(input);
+  filter->SetSize(size);
+  filter->SetOutputSpacing(spacing);
+  filter->SetOutputOrigin(origin);
+  filter->SetDefaultPixelValue(-7.0f);
+  try
+  {
+    filter->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+
+  using BoundaryConditionType = itk::ZeroFluxNeumannBoundaryCondition<ImageType>;
+  using InterpolatorType =
+    itk::WindowedSincInterpolateImageFunction<ImageType, Radius, WindowType, BoundaryConditionType, double>;
+  using ResamplerType = itk::ResampleImageFilter<ImageType, ImageType, double>;
+  ResamplerType::Pointer resampler = ResamplerType::New();
+  resampler->SetInput(input);
+  resampler->SetInterpolator(InterpolatorType::New());
+  resampler->SetSize(size);
+  resampler->SetOutputSpacing(spacing);
+  resampler->SetOutputOrigin(origin);
+  resampler->SetOutputDirection(input->GetDirection());
+  resampler->SetDefaultPixelValue(-7.0f);
+  try
+  {
+    resampler->Update();
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return false;
+  }
+
+  const ImageType * output = filter->GetOutput();
+  if (output->GetLargestPossibleRegion() != resampler->GetOutput()->GetLargestPossibleRegion() ||
+      output->GetSpacing() != spacing || output->GetOrigin() != origin)
+  {
+    std::cerr << "Unexpected output information " << output->GetLargestPossibleRegion() << std::endl;
+    return false;
+  }
+  itk::ImageRegionConstIteratorWithIndex<ImageType> outputIt(output, output->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> expectedIt(resampler->GetOutput(),
+                                                               output->GetLargestPossibleRegion());
+  for (outputIt.GoToBegin(), expectedIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt, ++expectedIt)
+  {
+    if (std::abs(outputIt.Get() - expectedIt.Get()) > 1e-4f * (1.0f + std::abs(expectedIt.Get())))
+    {
+      std::cerr << "Mismatch at " << outputIt.GetIndex() << ": expected " << expectedIt.Get() << ", got "
+                << outputIt.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkSeparableWindowedSincResampleImageFilterTest(int, char *[])
+{
+  ImageType::SizeType size;
+  size[0] = 41;
+  size[1] = 13;
+  ImageType::Pointer input = ImageType::New();
+  input->SetRegions(size);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.25;
+  spacing[1] = 0.5;
+  input->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin[0] = 1.0;
+  origin[1] = -2.0;
+  input->SetOrigin(origin);
+  input->Allocate();
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(11);
+  itk::ImageRegionIterator<ImageType> inputIt(input, input->GetLargestPossibleRegion());
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+  {
+    inputIt.Set(static_cast<float>(generator->GetUniformVariate(-100.0, 100.0)));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, SeparableWindowedSincResampleImageFilter, ImageToImageFilter);
+
+  // Upsampling by two, as in the DisplacementPipeline.  The spacings and
+  // origins are exact in binary, so that the output samples on the border of
+  // the input buffer are on the same side for both.
+  ImageType::SizeType    outputSize;
+  ImageType::SpacingType outputSpacing;
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+  {
+    outputSize[dim] = 2 * size[dim];
+    outputSpacing[dim] = spacing[dim] / 2.0;
+  }
+  if (!resampleMatches(input, outputSize, outputSpacing, origin, filter))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Downsampling, from an origin between the input samples, with output
+  // samples outside of the input.
+  ImageType::PointType outputOrigin;
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+  {
+    outputSize[dim] = size[dim] / 2 + 8;
+    outputSpacing[dim] = spacing[dim] * 1.5;
+    outputOrigin[dim] = origin[dim] + 0.25 * spacing[dim];
+  }
+  if (!resampleMatches(input, outputSize, outputSpacing, outputOrigin, filter))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "itkEuler3DTransform.h"
+#include "itkImage.h"
+#include "itkMath.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiThreaderBase.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "itkTestingMacros.h"
+
+int
+itkSliceSeriesSpecialCoordinatesImageSliceHintTest(int, char *[])
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SliceDimension = Dimension - 1;
+  using PixelType = float;
+  using SliceImageType = itk::Image<PixelType, SliceDimension>;
+  using TransformType = itk::Euler3DTransform<double>;
+  using ImageType = itk::SliceSeriesSpecialCoordinatesImage<SliceImageType, TransformType>;
+  using ContinuousIndexType = itk::ContinuousIndex<double, Dimension>;
+  using IndexValueType = ImageType::IndexValueType;
+
+  // A rotational sweep about the y axis, with slices that are not uniformly
+  // spaced.
+  SliceImageType::Pointer  sliceImage = SliceImageType::New();
+  SliceImageType::SizeType sliceSize;
+  sliceSize[0] = 64;
+  sliceSize[1] = 48;
+  sliceImage->SetRegions(sliceSize);
+  SliceImageType::SpacingType sliceSpacing;
+  sliceSpacing.Fill(0.5);
+  sliceImage->SetSpacing(sliceSpacing);
+  SliceImageType::PointType sliceOrigin;
+  sliceOrigin[0] = 5.0;
+  sliceOrigin[1] = -10.0;
+  sliceImage->SetOrigin(sliceOrigin);
+
+  const itk::SizeValueType numberOfSlices = 200;
+  ImageType::Pointer       image = ImageType::New();
+  ImageType::SizeType      size;
+  size[0] = sliceSize[0];
+  size[1] = sliceSize[1];
+  size[2] = numberOfSlices;
+  image->SetRegions(size);
+  image->SetSliceImage(sliceImage);
+  for (itk::SizeValueType sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+  {
+    const double           normalized = static_cast<double>(sliceIndex) / (numberOfSlices - 1);
+    TransformType::Pointer transform = TransformType::New();
+    transform->SetRotation(0.0, (-0.5 + normalized * normalized) * itk::Math::pi / 3.0, 0.0);
+    image->SetSliceTransform(sliceIndex, transform);
+  }
+
+  using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(11);
+
+  // Points on the slices, along lines across the sweep as a resampler would
+  // visit them, and a few outside of the sweep.
+  std::vector<ImageType::PointType> points;
+  for (unsigned int line = 0; line < 20; ++line)
+  {
+    ContinuousIndexType continuousIndex;
+    continuousIndex[0] = generator->GetUniformVariate(0.0, sliceSize[0] - 1);
+    continuousIndex[1] = generator->GetUniformVariate(0.0, sliceSize[1] - 1);
+    for (itk::SizeValueType sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+    {
+      continuousIndex[2] = sliceIndex;
+      ImageType::PointType point;
+      image->TransformContinuousIndexToPhysicalPoint(continuousIndex, point);
+      points.push_back(point);
+    }
+  }
+  for (unsigned int ii = 0; ii < 10; ++ii)
+  {
+    ImageType::PointType point;
+    point[0] = -generator->GetUniformVariate(5.0, 20.0);
+    point[1] = 0.0;
+    point[2] = generator->GetUniformVariate(-1.0, 1.0);
+    points.push_back(point);
+  }
+
+  // The searches from a hint, from the previous point, from no hint and from
+  // random hints, find the same indices.
+  IndexValueType       previousSlice = -5;
+  itk::SizeValueType   numberOfPointsInside = 0;
+  ImageType::IndexType expectedDiscreteIndex;
+  ImageType::IndexType discreteIndex;
+  for (itk::SizeValueType ii = 0; ii < points.size(); ++ii)
+  {
+    ContinuousIndexType expected;
+    const bool          expectedIsInside = image->TransformPhysicalPointToContinuousIndex(points[ii], expected);
+    numberOfPointsInside += expectedIsInside;
+
+    ContinuousIndexType continuousIndex;
+    IndexValueType      randomHint = static_cast<IndexValueType>(generator->GetIntegerVariate(numberOfSlices + 10)) - 5;
+    IndexValueType *    hints[] = { &previousSlice, &randomHint };
+    for (IndexValueType * hint : hints)
+    {
+      const bool isInside = image->TransformPhysicalPointToContinuousIndex(points[ii], continuousIndex, *hint);
+      if (isInside != expectedIsInside)
+      {
+        std::cerr << "Inside mismatch for " << points[ii] << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int dim = 0; expectedIsInside && dim < Dimension; ++dim)
+      {
+        if (std::abs(continuousIndex[dim] - expected[dim]) > 1.0e-9)
+        {
+          std::cerr << "Index mismatch for " << points[ii] << ": expected " << expected << ", got " << continuousIndex
+                    << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    image->TransformPhysicalPointToIndex(points[ii], expectedDiscreteIndex);
+    IndexValueType discreteHint = expectedIsInside ? itk::Math::Floor<IndexValueType>(expected[2]) + 3 : 0;
+    image->TransformPhysicalPointToIndex(points[ii], discreteIndex, discreteHint);
+    if (expectedIsInside && discreteIndex != expectedDiscreteIndex)
+    {
+      std::cerr << "Discrete index mismatch for " << points[ii] << ": expected " << expectedDiscreteIndex << ", got "
+                << discreteIndex << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::cout << numberOfPointsInside << " of " << points.size() << " points are inside" << std::endl;
+  ITK_TEST_EXPECT_TRUE(numberOfPointsInside > 0);
+  ITK_TEST_EXPECT_TRUE(numberOfPointsInside < points.size());
+
+  // Concurrent conversions, with one hint per task, find the same indices.
+  std::vector<ContinuousIndexType> expectedIndices(points.size());
+  std::vector<bool>                expectedInside(points.size());
+  for (itk::SizeValueType ii = 0; ii < points.size(); ++ii)
+  {
+    expectedInside[ii] = image->TransformPhysicalPointToContinuousIndex(points[ii], expectedIndices[ii]);
+  }
+  const itk::SizeValueType        numberOfPoints = points.size();
+  const itk::SizeValueType        numberOfChunks = 64;
+  const itk::SizeValueType        chunkSize = numberOfPoints / numberOfChunks + 1;
+  std::atomic<itk::SizeValueType> numberOfMismatches(0);
+  itk::MultiThreaderBase::Pointer multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfChunks,
+    [&](itk::SizeValueType chunk) {
+      IndexValueType hint = 0;
+      for (itk::SizeValueType ii = chunk * chunkSize; ii < std::min((chunk + 1) * chunkSize, numberOfPoints); ++ii)
+      {
+        ContinuousIndexType index;
+        const bool          isInside = image->TransformPhysicalPointToContinuousIndex(points[ii], index, hint);
+        bool                mismatch = isInside != expectedInside[ii];
+        for (unsigned int dim = 0; isInside && dim < Dimension; ++dim)
+        {
+          mismatch = mismatch || std::abs(index[dim] - expectedIndices[ii][dim]) > 1.0e-9;
+        }
+        numberOfMismatches += mismatch;
+      }
+    },
+    nullptr);
+  ITK_TEST_EXPECT_EQUAL(numberOfMismatches.load(), 0u);
+
+  // A point on a slice is mapped back to it.
+  ContinuousIndexType continuousIndex;
+  continuousIndex[0] = 20.25;
+  continuousIndex[1] = 30.5;
+  continuousIndex[2] = 123.0;
+  ImageType::PointType point;
+  image->TransformContinuousIndexToPhysicalPoint(continuousIndex, point);
+  ContinuousIndexType transformedIndex;
+  IndexValueType      sliceHint = 0;
+  ITK_TEST_EXPECT_TRUE(image->TransformPhysicalPointToContinuousIndex(point, transformedIndex, sliceHint));
+  std::cout << "Transformed continuous index: " << transformedIndex << std::endl;
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+  {
+    ITK_TEST_EXPECT_TRUE(std::abs(transformedIndex[dim] - continuousIndex[dim]) < 1.0e-6);
+  }
+  ITK_TEST_EXPECT_TRUE(sliceHint == 122 || sliceHint == 123);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+
+#include "itkEuler3DTransform.h"
+#include "itkImage.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "itkTestingMacros.h"
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+using SliceImageType = itk::Image<float, Dimension - 1>;
+using TransformType = itk::Euler3DTransform<double>;
+using ImageType = itk::SliceSeriesSpecialCoordinatesImage<SliceImageType, TransformType>;
+
+// The physical points of the pixels of a slice are its pixels in the slice
+// frame through its transform, and map back to the pixels.
+bool
+checkSlice(const ImageType * image, const TransformType * transform, ImageType::IndexValueType sliceIndex)
+{
+  const SliceImageType * sliceImage = image->GetSliceImage();
+  ImageType::IndexType   index;
+  index[2] = sliceIndex;
+  for (index[1] = 0; index[1] < 8; index[1] += 3)
+  {
+    for (index[0] = 0; index[0] < 16; index[0] += 5)
+    {
+      SliceImageType::IndexType sliceImageIndex;
+      sliceImageIndex[0] = index[0];
+      sliceImageIndex[1] = index[1];
+      SliceImageType::PointType slicePoint;
+      sliceImage->TransformIndexToPhysicalPoint(sliceImageIndex, slicePoint);
+      TransformType::InputPointType inputPoint;
+      inputPoint[0] = slicePoint[0];
+      inputPoint[1] = slicePoint[1];
+      inputPoint[2] = 0.0;
+      const TransformType::OutputPointType expected = transform->TransformPoint(inputPoint);
+
+      ImageType::PointType point;
+      image->TransformIndexToPhysicalPoint(index, point);
+      if (point.EuclideanDistanceTo(expected) > 1.0e-9)
+      {
+        std::cerr << "Point mismatch at " << index << ": expected " << expected << ", got " << point << std::endl;
+        return false;
+      }
+      ImageType::IndexType transformedIndex;
+      if (!image->TransformPhysicalPointToIndex(point, transformedIndex) || transformedIndex != index)
+      {
+        std::cerr << "Index mismatch for " << point << ": expected " << index << ", got " << transformedIndex
+                  << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkSliceSeriesSpecialCoordinatesImageTransformCacheTest(int, char *[])
+{
+  SliceImageType::Pointer  sliceImage = SliceImageType::New();
+  SliceImageType::SizeType sliceSize;
+  sliceSize[0] = 16;
+  sliceSize[1] = 8;
+  sliceImage->SetRegions(sliceSize);
+  SliceImageType::PointType sliceOrigin;
+  sliceOrigin[0] = 2.0;
+  sliceOrigin[1] = -4.0;
+  sliceImage->SetOrigin(sliceOrigin);
+
+  const itk::SizeValueType numberOfSlices = 5;
+  ImageType::Pointer       image = ImageType::New();
+  ImageType::SizeType      size;
+  size[0] = sliceSize[0];
+  size[1] = sliceSize[1];
+  size[2] = numberOfSlices;
+  image->SetRegions(size);
+  image->SetSliceImage(sliceImage);
+  TransformType::Pointer transforms[numberOfSlices];
+  for (itk::SizeValueType sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+  {
+    transforms[sliceIndex] = TransformType::New();
+    transforms[sliceIndex]->SetRotation(0.0, 0.1 * sliceIndex, 0.0);
+    TransformType::OutputVectorType translation;
+    translation[0] = 0.5;
+    translation[1] = 1.5;
+    translation[2] = -2.0;
+    transforms[sliceIndex]->SetTranslation(translation);
+    image->SetSliceTransform(sliceIndex, transforms[sliceIndex]);
+  }
+  for (itk::SizeValueType sliceIndex = 0; sliceIndex < numberOfSlices; ++sliceIndex)
+  {
+    ITK_TEST_EXPECT_TRUE(checkSlice(image, transforms[sliceIndex], sliceIndex));
+  }
+
+  // Modifying a slice transform refreshes the image geometry.
+  const itk::ModifiedTimeType   imageTime = image->GetMTime();
+  TransformType::ParametersType parameters = transforms[2]->GetParameters();
+  parameters[1] = 0.25;
+  parameters[2] = 0.05;
+  parameters[5] = 1.0;
+  transforms[2]->SetParameters(parameters);
+  ITK_TEST_EXPECT_TRUE(image->GetMTime() > imageTime);
+  ITK_TEST_EXPECT_TRUE(checkSlice(image, transforms[2], 2));
+
+  // Replacing a slice transform no longer follows the previous one.
+  TransformType::Pointer replacement = TransformType::New();
+  replacement->SetRotation(0.0, 0.2, 0.0);
+  image->SetSliceTransform(2, replacement);
+  parameters[1] = 1.0;
+  transforms[2]->SetParameters(parameters);
+  ITK_TEST_EXPECT_TRUE(checkSlice(image, replacement, 2));
+  ITK_TEST_EXPECT_TRUE(checkSlice(image, transforms[3], 3));
+
+  return EXIT_SUCCESS;
+}
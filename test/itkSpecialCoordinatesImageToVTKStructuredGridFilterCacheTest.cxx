@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkEuler3DTransform.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "itkTestingMacros.h"
+
+#include "itkSpecialCoordinatesImageToVTKStructuredGridFilter.h"
+
+#include "vtkDataArray.h"
+#include "vtkPointData.h"
+
+namespace
+{
+
+const unsigned int Dimension = 3;
+using PixelType = float;
+using ImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension>;
+using FilterType = itk::SpecialCoordinatesImageToVTKStructuredGridFilter<ImageType>;
+
+// The grid points are the physical points of the pixels, and the scalars are
+// the pixel buffer.
+template <typename TImage>
+bool
+checkGrid(const TImage * image, vtkStructuredGrid * grid)
+{
+  if (grid->GetPointData()->GetScalars()->GetVoidPointer(0) != image->GetBufferPointer())
+  {
+    std::cerr << "The scalars are not the pixel buffer" << std::endl;
+    return false;
+  }
+  itk::ImageRegionConstIteratorWithIndex<TImage> imageIt(image, image->GetBufferedRegion());
+  vtkIdType                                      pointId = 0;
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt, ++pointId)
+  {
+    typename TImage::PointType point;
+    image->TransformIndexToPhysicalPoint(imageIt.GetIndex(), point);
+    double gridPoint[3];
+    grid->GetPoint(pointId, gridPoint);
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      if (std::abs(gridPoint[dim] - point[dim]) > 1e-9)
+      {
+        std::cerr << "Point mismatch at " << imageIt.GetIndex() << ": expected " << point << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkSpecialCoordinatesImageToVTKStructuredGridFilterCacheTest(int, char *[])
+{
+  ImageType::Pointer  image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 24;
+  size[2] = 3;
+  image->SetRegions(size);
+  image->SetLateralAngularSeparation((itk::Math::pi / 3.0) / (size[1] - 1));
+  image->SetRadiusSampleSize(0.5);
+  image->SetFirstSampleDistance(10.0);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> imageIt(image, image->GetLargestPossibleRegion());
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+  {
+    imageIt.Set(static_cast<PixelType>(imageIt.GetIndex()[0]));
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, SpecialCoordinatesImageToVTKStructuredGridFilter, ProcessObject);
+
+  ITK_TEST_SET_GET_BOOLEAN(filter, CachePoints, true);
+
+  filter->SetInput(image);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(checkGrid(image.GetPointer(), filter->GetOutput()));
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfPointsBuilds(), 1u);
+
+  // A new frame with the same geometry reuses the points.
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+  {
+    imageIt.Set(imageIt.Get() + 1.0f);
+  }
+  image->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(checkGrid(image.GetPointer(), filter->GetOutput()));
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfPointsBuilds(), 1u);
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetPointData()->GetScalars()->GetTuple1(1), 2.0);
+
+  // A new geometry does not.
+  image->SetRadiusSampleSize(0.6);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(checkGrid(image.GetPointer(), filter->GetOutput()));
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfPointsBuilds(), 2u);
+
+  filter->CachePointsOff();
+  image->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfPointsBuilds(), 3u);
+
+  // The geometry of a slice series includes its slice transforms.
+  using SliceImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension - 1>;
+  using TransformType = itk::Euler3DTransform<double>;
+  using SliceSeriesImageType = itk::SliceSeriesSpecialCoordinatesImage<SliceImageType, TransformType>;
+  SliceImageType::Pointer  sliceImage = SliceImageType::New();
+  SliceImageType::SizeType sliceSize;
+  sliceSize[0] = size[0];
+  sliceSize[1] = size[1];
+  sliceImage->SetRegions(sliceSize);
+  sliceImage->SetLateralAngularSeparation((itk::Math::pi / 3.0) / (size[1] - 1));
+  sliceImage->SetRadiusSampleSize(0.5);
+  sliceImage->SetFirstSampleDistance(10.0);
+  SliceSeriesImageType::Pointer sliceSeries = SliceSeriesImageType::New();
+  sliceSeries->SetRegions(size);
+  sliceSeries->SetSliceImage(sliceImage);
+  std::vector<TransformType::Pointer> transforms;
+  for (itk::SizeValueType sliceIndex = 0; sliceIndex < size[2]; ++sliceIndex)
+  {
+    transforms.push_back(TransformType::New());
+    transforms.back()->SetRotation(0.0, 0.0, 0.1 * sliceIndex);
+    sliceSeries->SetSliceTransform(sliceIndex, transforms.back());
+  }
+  sliceSeries->Allocate();
+  sliceSeries->FillBuffer(1.0f);
+
+  using SliceSeriesFilterType = itk::SpecialCoordinatesImageToVTKStructuredGridFilter<SliceSeriesImageType>;
+  SliceSeriesFilterType::Pointer sliceSeriesFilter = SliceSeriesFilterType::New();
+  sliceSeriesFilter->SetInput(sliceSeries);
+  ITK_TRY_EXPECT_NO_EXCEPTION(sliceSeriesFilter->Update());
+  ITK_TEST_EXPECT_TRUE(checkGrid(sliceSeries.GetPointer(), sliceSeriesFilter->GetOutput()));
+  sliceSeries->FillBuffer(2.0f);
+  sliceSeries->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(sliceSeriesFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(sliceSeriesFilter->GetNumberOfPointsBuilds(), 1u);
+
+  TransformType::ParametersType parameters = transforms[1]->GetParameters();
+  parameters[3] = 1.0;
+  transforms[1]->SetParameters(parameters);
+  ITK_TRY_EXPECT_NO_EXCEPTION(sliceSeriesFilter->Update());
+  ITK_TEST_EXPECT_TRUE(checkGrid(sliceSeries.GetPointer(), sliceSeriesFilter->GetOutput()));
+  ITK_TEST_EXPECT_EQUAL(sliceSeriesFilter->GetNumberOfPointsBuilds(), 2u);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkEuler3DTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkSliceSeriesSpecialCoordinatesImage.h"
+#include "itkTestingMacros.h"
+
+#include "itkSpecialCoordinatesLinearInterpolateImageFunction.h"
+
+namespace
+{
+
+using PixelType = float;
+using GeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+
+// Compare with a LinearInterpolateImageFunction at continuous indices over
+// the whole image and a margin around it, and at physical points.
+template <typename TImage>
+bool
+matchesLinearInterpolator(TImage * image)
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+  itk::ImageRegionIteratorWithIndex<TImage> imageIt(image, image->GetLargestPossibleRegion());
+  for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
+  {
+    double value = 1.0;
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      value += std::sin(0.3 * (dim + 1) * imageIt.GetIndex()[dim]);
+    }
+    imageIt.Set(static_cast<PixelType>(value));
+  }
+
+  using InterpolatorType = itk::SpecialCoordinatesLinearInterpolateImageFunction<TImage>;
+  using ReferenceInterpolatorType = itk::LinearInterpolateImageFunction<TImage>;
+  typename InterpolatorType::Pointer          interpolator = InterpolatorType::New();
+  typename ReferenceInterpolatorType::Pointer referenceInterpolator = ReferenceInterpolatorType::New();
+  interpolator->SetInputImage(image);
+  referenceInterpolator->SetInputImage(image);
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(5);
+  const typename TImage::SizeType                             size = image->GetLargestPossibleRegion().GetSize();
+  std::vector<typename InterpolatorType::ContinuousIndexType> indices(1000);
+  for (auto & index : indices)
+  {
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      index[dim] = generator->GetUniformVariate(-0.5, size[dim] - 0.5);
+    }
+  }
+  std::vector<typename InterpolatorType::OutputType> values(indices.size());
+  interpolator->EvaluateAtContinuousIndices(indices.data(), values.data(), indices.size());
+
+  for (itk::SizeValueType ii = 0; ii < indices.size(); ++ii)
+  {
+    const double expected = referenceInterpolator->EvaluateAtContinuousIndex(indices[ii]);
+    if (std::abs(interpolator->EvaluateAtContinuousIndex(indices[ii]) - expected) > 1e-5 ||
+        std::abs(values[ii] - expected) > 1e-5)
+    {
+      std::cerr << "Mismatch at " << indices[ii] << ": expected " << expected << ", got " << values[ii] << std::endl;
+      return false;
+    }
+    if (interpolator->IsInsideInterior(indices[ii]) &&
+        std::abs(interpolator->EvaluateAtInteriorContinuousIndex(indices[ii]) - expected) > 1e-5)
+    {
+      std::cerr << "Interior mismatch at " << indices[ii] << std::endl;
+      return false;
+    }
+
+    typename TImage::PointType point;
+    image->TransformContinuousIndexToPhysicalPoint(indices[ii], point);
+    if (interpolator->IsInsideBuffer(point) &&
+        std::abs(interpolator->Evaluate(point) - referenceInterpolator->Evaluate(point)) > 1e-5)
+    {
+      std::cerr << "Mismatch at " << point << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+itkSpecialCoordinatesLinearInterpolateImageFunctionTest(int, char *[])
+{
+  const unsigned int Dimension = 2;
+  using CurvilinearImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension>;
+  CurvilinearImageType::Pointer  curvilinearImage = CurvilinearImageType::New();
+  CurvilinearImageType::SizeType size;
+  size[0] = 48;
+  size[1] = 21;
+  curvilinearImage->SetRegions(size);
+  curvilinearImage->SetLateralAngularSeparation((itk::Math::pi / 3.0) / (size[1] - 1));
+  curvilinearImage->SetRadiusSampleSize(0.5);
+  curvilinearImage->SetFirstSampleDistance(10.0);
+  curvilinearImage->Allocate();
+
+  using InterpolatorType = itk::SpecialCoordinatesLinearInterpolateImageFunction<CurvilinearImageType>;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(interpolator, SpecialCoordinatesLinearInterpolateImageFunction,
+                                    InterpolateImageFunction);
+
+  ITK_TEST_EXPECT_TRUE(matchesLinearInterpolator(curvilinearImage.GetPointer()));
+
+  using SliceImageType = itk::Image<PixelType, Dimension>;
+  using TransformType = itk::Euler3DTransform<double>;
+  using SliceSeriesImageType = itk::SliceSeriesSpecialCoordinatesImage<SliceImageType, TransformType>;
+  SliceImageType::Pointer sliceImage = SliceImageType::New();
+  sliceImage->SetRegions(size);
+  SliceSeriesImageType::Pointer  sliceSeriesImage = SliceSeriesImageType::New();
+  SliceSeriesImageType::SizeType sliceSeriesSize;
+  sliceSeriesSize[0] = size[0];
+  sliceSeriesSize[1] = size[1];
+  sliceSeriesSize[2] = 9;
+  sliceSeriesImage->SetRegions(sliceSeriesSize);
+  sliceSeriesImage->SetSliceImage(sliceImage);
+  for (itk::SizeValueType sliceIndex = 0; sliceIndex < sliceSeriesSize[2]; ++sliceIndex)
+  {
+    TransformType::Pointer transform = TransformType::New();
+    transform->SetRotation(0.05 * sliceIndex, 0.0, 0.0);
+    sliceSeriesImage->SetSliceTransform(sliceIndex, transform);
+  }
+  sliceSeriesImage->Allocate();
+
+  ITK_TEST_EXPECT_TRUE(matchesLinearInterpolator(sliceSeriesImage.GetPointer()));
+
+  return EXIT_SUCCESS;
+}
@@ -16,8 +16,11 @@
  *
  *=========================================================================*/
 
+#include <cmath>
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkMirrorPadImageFilter.h"
 #include "itkTestingMacros.h"
 
@@ -69,5 +72,32 @@ itkSpeckleReducingAnisotropicDiffusionImageFilterTest(int argc, char * argv[])
 
   ITK_TRY_EXPECT_NO_EXCEPTION(itk::WriteImage(result, argv[2]));
 
+  // The fused solver agrees with the finite difference pipeline, whether or
+  // not the number of iterations is a multiple of the iterations per pass.
+  for (unsigned int iterationsPerPass : { 1, 3 })
+  {
+    SpeckleFilterType::Pointer fusedFilter = SpeckleFilterType::New();
+    fusedFilter->SetInput(padFilter->GetOutput());
+    fusedFilter->SetNumberOfIterations(100);
+    fusedFilter->SetTimeStep(0.002);
+    ITK_TEST_SET_GET_BOOLEAN(fusedFilter, Fused, true);
+    fusedFilter->SetIterationsPerPass(iterationsPerPass);
+    ITK_TEST_SET_GET_VALUE(iterationsPerPass, fusedFilter->GetIterationsPerPass());
+    ITK_TRY_EXPECT_NO_EXCEPTION(fusedFilter->Update());
+    fusedFilter->Print(std::cout);
+
+    itk::ImageRegionConstIteratorWithIndex<ImageType> expectedIt(result, result->GetLargestPossibleRegion());
+    for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+    {
+      const PixelType actual = fusedFilter->GetOutput()->GetPixel(expectedIt.GetIndex());
+      if (std::abs(actual - expectedIt.Get()) > 1e-3 * std::abs(expectedIt.Get()) + 1e-2)
+      {
+        std::cerr << "Fused solver mismatch at " << expectedIt.GetIndex() << " with " << iterationsPerPass
+                  << " iterations per pass: " << expectedIt.Get() << " vs. " << actual << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
   return EXIT_SUCCESS;
 }
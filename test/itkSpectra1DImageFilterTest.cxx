@@ -16,14 +16,78 @@
  *
  *=========================================================================*/
 
+#include <cmath>
+
+#include "itkHalfPrecision.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkVector.h"
 #include "itkVectorImage.h"
 #include "itkTestingMacros.h"
 
 #include "itkSpectra1DSupportWindowImageFilter.h"
 #include "itkSpectra1DImageFilter.h"
 
+namespace
+{
+
+template <typename TImage>
+bool
+spectraAgree(const TImage * expected, const TImage * actual, const char * description)
+{
+  using IteratorType = itk::ImageRegionConstIterator<TImage>;
+  IteratorType expectedIt(expected, expected->GetLargestPossibleRegion());
+  IteratorType actualIt(actual, expected->GetLargestPossibleRegion());
+  for (expectedIt.GoToBegin(), actualIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt, ++actualIt)
+  {
+    const typename TImage::PixelType expectedPixel = expectedIt.Get();
+    const typename TImage::PixelType actualPixel = actualIt.Get();
+    for (unsigned int component = 0; component < expectedPixel.GetSize(); ++component)
+    {
+      const double difference = std::abs(expectedPixel[component] - actualPixel[component]);
+      if (difference > 1e-4 * std::abs(expectedPixel[component]) + 1e-12)
+      {
+        std::cerr << description << ": spectra mismatch at " << expectedIt.GetIndex() << ", component " << component
+                  << ": " << expectedPixel[component] << " vs. " << actualPixel[component] << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The spectra stored in half precision are the float spectra, rounded with
+// the given relative error.
+template <typename TImage, typename THalfPrecisionImage>
+bool
+halfPrecisionSpectraAgree(const TImage *              expected,
+                          const THalfPrecisionImage * actual,
+                          double                      tolerance,
+                          const char *                description)
+{
+  itk::ImageRegionConstIteratorWithIndex<TImage> expectedIt(expected, expected->GetLargestPossibleRegion());
+  for (expectedIt.GoToBegin(); !expectedIt.IsAtEnd(); ++expectedIt)
+  {
+    const typename TImage::PixelType              expectedPixel = expectedIt.Get();
+    const typename THalfPrecisionImage::PixelType actualPixel = actual->GetPixel(expectedIt.GetIndex());
+    for (unsigned int component = 0; component < expectedPixel.GetSize(); ++component)
+    {
+      const float actualComponent = actualPixel[component];
+      if (std::abs(expectedPixel[component] - actualComponent) > tolerance * std::abs(expectedPixel[component]))
+      {
+        std::cerr << description << ": spectra mismatch at " << expectedIt.GetIndex() << ", component " << component
+                  << ": " << expectedPixel[component] << " vs. " << actualComponent << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 int
 itkSpectra1DImageFilterTest(int argc, char * argv[])
 {
@@ -97,5 +161,279 @@ itkSpectra1DImageFilterTest(int argc, char * argv[])
 
   ITK_TRY_EXPECT_NO_EXCEPTION(writer->UpdateLargestPossibleRegion());
 
+  // The VNL transforms give the same spectra as the default backend.
+  SpectraFilterType::Pointer vnlSpectraFilter = SpectraFilterType::New();
+  vnlSpectraFilter->SetInput(rfImage);
+  vnlSpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  vnlSpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  ITK_TEST_SET_GET_BOOLEAN(vnlSpectraFilter, UseFFTW, false);
+  ITK_TRY_EXPECT_NO_EXCEPTION(vnlSpectraFilter->UpdateLargestPossibleRegion());
+
+  if (!spectraAgree(spectraFilter->GetOutput(), vnlSpectraFilter->GetOutput(), "VNL"))
+  {
+    return EXIT_FAILURE;
+  }
+  vnlSpectraFilter->Print(std::cout);
+
+  // A filter prepared on the geometry of the frames gives the same spectra.
+  SpectraFilterType::Pointer preparedSpectraFilter = SpectraFilterType::New();
+  preparedSpectraFilter->SetInput(rfImage);
+  preparedSpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  preparedSpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(preparedSpectraFilter->Prepare(rfImage));
+  ITK_TEST_EXPECT_TRUE(preparedSpectraFilter->GetInput() == rfImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(preparedSpectraFilter->UpdateLargestPossibleRegion());
+  if (!spectraAgree(spectraFilter->GetOutput(), preparedSpectraFilter->GetOutput(), "Prepared"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A range of the bins in decibels, normalized by the full reference
+  // spectra.
+  SpectraFilterType::Pointer decibelSpectraFilter = SpectraFilterType::New();
+  decibelSpectraFilter->SetInput(rfImage);
+  decibelSpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  decibelSpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  decibelSpectraFilter->SetFirstFrequencyBin(5);
+  decibelSpectraFilter->SetNumberOfFrequencyBins(10);
+  decibelSpectraFilter->DecibelOutputOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(decibelSpectraFilter->UpdateLargestPossibleRegion());
+  ITK_TEST_EXPECT_EQUAL(decibelSpectraFilter->GetOutput()->GetNumberOfComponentsPerPixel(), 10);
+  itk::ImageRegionConstIteratorWithIndex<SpectraImageType> decibelSpectraIt(
+    decibelSpectraFilter->GetOutput(), decibelSpectraFilter->GetOutput()->GetLargestPossibleRegion());
+  for (decibelSpectraIt.GoToBegin(); !decibelSpectraIt.IsAtEnd(); ++decibelSpectraIt)
+  {
+    const SpectraPixelType spectraPixel = spectraFilter->GetOutput()->GetPixel(decibelSpectraIt.GetIndex());
+    const SpectraPixelType decibelSpectraPixel = decibelSpectraIt.Get();
+    for (unsigned int component = 0; component < 10; ++component)
+    {
+      const double power = spectraPixel[5 + component];
+      if (power > 0.0 && std::abs(10.0 * std::log10(power) - decibelSpectraPixel[component]) > 1e-3)
+      {
+        std::cerr << "Decibel spectra mismatch at " << decibelSpectraIt.GetIndex() << ", component " << component
+                  << ": " << 10.0 * std::log10(power) << " vs. " << decibelSpectraPixel[component] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // The same spectra stored in half precision, in half the memory.
+  using Float16SpectraImageType = itk::VectorImage<itk::Float16, Dimension>;
+  using Float16SpectraFilterType =
+    itk::Spectra1DImageFilter<ImageType, SupportWindowImageType, Float16SpectraImageType>;
+  Float16SpectraFilterType::Pointer float16SpectraFilter = Float16SpectraFilterType::New();
+  float16SpectraFilter->SetInput(rfImage);
+  float16SpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  float16SpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  float16SpectraFilter->SetFirstFrequencyBin(5);
+  float16SpectraFilter->SetNumberOfFrequencyBins(10);
+  float16SpectraFilter->DecibelOutputOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(float16SpectraFilter->UpdateLargestPossibleRegion());
+  if (!halfPrecisionSpectraAgree(
+        decibelSpectraFilter->GetOutput(), float16SpectraFilter->GetOutput(), std::ldexp(1.0, -11), "Float16"))
+  {
+    return EXIT_FAILURE;
+  }
+  const itk::SizeValueType numberOfSpectra =
+    float16SpectraFilter->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  const itk::SizeValueType float16Footprint = float16SpectraFilter->EstimateMemoryFootprint();
+  ITK_TEST_EXPECT_EQUAL(decibelSpectraFilter->EstimateMemoryFootprint() - float16Footprint,
+                        numberOfSpectra * 10 * (sizeof(float) - sizeof(itk::Float16)));
+  using BFloat16SpectraImageType = itk::VectorImage<itk::BFloat16, Dimension>;
+  using BFloat16SpectraFilterType =
+    itk::Spectra1DImageFilter<ImageType, SupportWindowImageType, BFloat16SpectraImageType>;
+  BFloat16SpectraFilterType::Pointer bfloat16SpectraFilter = BFloat16SpectraFilterType::New();
+  bfloat16SpectraFilter->SetInput(rfImage);
+  bfloat16SpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  bfloat16SpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  bfloat16SpectraFilter->SetFirstFrequencyBin(5);
+  bfloat16SpectraFilter->SetNumberOfFrequencyBins(10);
+  bfloat16SpectraFilter->DecibelOutputOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(bfloat16SpectraFilter->UpdateLargestPossibleRegion());
+  if (!halfPrecisionSpectraAgree(
+        decibelSpectraFilter->GetOutput(), bfloat16SpectraFilter->GetOutput(), std::ldexp(1.0, -8), "BFloat16"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The line fits of the decibel spectra over the same bins.  The segments
+  // have 64 samples.
+  using LinearFitImageType = itk::Image<itk::Vector<SpectraComponentType, 3>, Dimension>;
+  using LinearFitFilterType = itk::Spectra1DImageFilter<ImageType, SupportWindowImageType, LinearFitImageType>;
+  LinearFitFilterType::Pointer linearFitFilter = LinearFitFilterType::New();
+  linearFitFilter->SetInput(rfImage);
+  linearFitFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  linearFitFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  linearFitFilter->SetFirstFrequencyBin(5);
+  linearFitFilter->SetNumberOfFrequencyBins(10);
+  linearFitFilter->DecibelOutputOn();
+  const double samplingFrequency = 40.0;
+  linearFitFilter->SetSamplingFrequency(samplingFrequency);
+  ITK_TEST_SET_GET_VALUE(samplingFrequency, linearFitFilter->GetSamplingFrequency());
+  ITK_TRY_EXPECT_NO_EXCEPTION(linearFitFilter->UpdateLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<LinearFitImageType> linearFitIt(
+    linearFitFilter->GetOutput(), linearFitFilter->GetOutput()->GetLargestPossibleRegion());
+  for (linearFitIt.GoToBegin(); !linearFitIt.IsAtEnd(); ++linearFitIt)
+  {
+    const SpectraPixelType decibelSpectraPixel = decibelSpectraFilter->GetOutput()->GetPixel(linearFitIt.GetIndex());
+    double                 sumFrequency = 0.0;
+    double                 sumSpectra = 0.0;
+    double                 sumFrequencySquared = 0.0;
+    double                 sumFrequencySpectra = 0.0;
+    for (unsigned int component = 0; component < 10; ++component)
+    {
+      const double frequency = (5 + 1 + component) * samplingFrequency / 64.0;
+      sumFrequency += frequency;
+      sumSpectra += decibelSpectraPixel[component];
+      sumFrequencySquared += frequency * frequency;
+      sumFrequencySpectra += frequency * decibelSpectraPixel[component];
+    }
+    const double slope = (10.0 * sumFrequencySpectra - sumFrequency * sumSpectra) /
+                         (10.0 * sumFrequencySquared - sumFrequency * sumFrequency);
+    const double intercept = (sumSpectra - slope * sumFrequency) / 10.0;
+    const double expectedFit[3] = { slope, intercept, sumSpectra / 10.0 };
+    const LinearFitImageType::PixelType linearFit = linearFitIt.Get();
+    for (unsigned int component = 0; component < 3; ++component)
+    {
+      if (std::abs(expectedFit[component] - linearFit[component]) > 1e-3 * (1.0 + std::abs(expectedFit[component])))
+      {
+        std::cerr << "Line fit mismatch at " << linearFitIt.GetIndex() << ", component " << component << ": "
+                  << expectedFit[component] << " vs. " << linearFit[component] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  linearFitFilter->Print(std::cout);
+
+  decibelSpectraFilter->SetNumberOfFrequencyBins(100);
+  ITK_TRY_EXPECT_EXCEPTION(decibelSpectraFilter->UpdateLargestPossibleRegion());
+
+  // Splitting the output in many dynamically scheduled chunks does not
+  // change the spectra.
+  SpectraFilterType::Pointer dynamicSpectraFilter = SpectraFilterType::New();
+  dynamicSpectraFilter->SetInput(rfImage);
+  dynamicSpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  dynamicSpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  dynamicSpectraFilter->DynamicMultiThreadingOn();
+  dynamicSpectraFilter->SetNumberOfWorkUnits(32);
+  ITK_TRY_EXPECT_NO_EXCEPTION(dynamicSpectraFilter->UpdateLargestPossibleRegion());
+  if (!spectraAgree(spectraFilter->GetOutput(), dynamicSpectraFilter->GetOutput(), "Dynamic"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A requested sub-block of the output only pulls the support windows of
+  // the block and the samples that their lines span from the input.
+  SpectraSupportWindowFilterType::Pointer streamingSupportWindowFilter = SpectraSupportWindowFilterType::New();
+  streamingSupportWindowFilter->SetInput(sideLines);
+  streamingSupportWindowFilter->SetFFT1DSize(128);
+  streamingSupportWindowFilter->SetStep(16);
+  SpectraFilterType::Pointer streamingSpectraFilter = SpectraFilterType::New();
+  streamingSpectraFilter->SetInput(rfImage);
+  streamingSpectraFilter->SetSupportWindowImage(streamingSupportWindowFilter->GetOutput());
+  streamingSpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(streamingSpectraFilter->UpdateOutputInformation());
+  SpectraImageType::RegionType streamingRegion = streamingSpectraFilter->GetOutput()->GetLargestPossibleRegion();
+  streamingRegion.SetIndex(0, streamingRegion.GetIndex(0) + streamingRegion.GetSize(0) / 4);
+  streamingRegion.SetSize(0, streamingRegion.GetSize(0) / 2);
+  streamingRegion.SetIndex(1, streamingRegion.GetIndex(1) + streamingRegion.GetSize(1) / 4);
+  streamingRegion.SetSize(1, streamingRegion.GetSize(1) / 2);
+  streamingSpectraFilter->GetOutput()->SetRequestedRegion(streamingRegion);
+  ITK_TRY_EXPECT_NO_EXCEPTION(streamingSpectraFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(streamingSupportWindowFilter->GetOutput()->GetBufferedRegion(), streamingRegion);
+  const ImageType::RegionType & rfRequestedRegion = rfImage->GetRequestedRegion();
+  ITK_TEST_EXPECT_TRUE(rfRequestedRegion.GetSize(0) < rfImage->GetLargestPossibleRegion().GetSize(0));
+  itk::ImageRegionConstIteratorWithIndex<SpectraImageType> streamingSpectraIt(streamingSpectraFilter->GetOutput(),
+                                                                             streamingRegion);
+  for (streamingSpectraIt.GoToBegin(); !streamingSpectraIt.IsAtEnd(); ++streamingSpectraIt)
+  {
+    const SpectraPixelType spectraPixel = spectraFilter->GetOutput()->GetPixel(streamingSpectraIt.GetIndex());
+    const SpectraPixelType streamingSpectraPixel = streamingSpectraIt.Get();
+    for (unsigned int component = 0; component < spectraPixel.GetSize(); ++component)
+    {
+      if (std::abs(spectraPixel[component] - streamingSpectraPixel[component]) >
+          1e-4 * std::abs(spectraPixel[component]) + 1e-12)
+      {
+        std::cerr << "Streaming spectra mismatch at " << streamingSpectraIt.GetIndex() << ", component " << component
+                  << ": " << spectraPixel[component] << " vs. " << streamingSpectraPixel[component] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // The compact support windows give the same spectra as the lists of lines.
+  using CompactSupportWindowFilterType =
+    itk::Spectra1DSupportWindowImageFilter<ImageType, itk::Spectra1DCompactSupportWindow<Dimension>>;
+  CompactSupportWindowFilterType::Pointer compactSupportWindowFilter = CompactSupportWindowFilterType::New();
+  compactSupportWindowFilter->SetInput(sideLines);
+  compactSupportWindowFilter->SetFFT1DSize(128);
+  compactSupportWindowFilter->SetStep(16);
+  using CompactSpectraFilterType =
+    itk::Spectra1DImageFilter<ImageType, CompactSupportWindowFilterType::OutputImageType, SpectraImageType>;
+  CompactSpectraFilterType::Pointer compactSpectraFilter = CompactSpectraFilterType::New();
+  compactSpectraFilter->SetInput(rfImage);
+  compactSpectraFilter->SetSupportWindowImage(compactSupportWindowFilter->GetOutput());
+  compactSpectraFilter->SetReferenceSpectraImage(referenceSpectraImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(compactSpectraFilter->UpdateLargestPossibleRegion());
+  if (!spectraAgree(spectraFilter->GetOutput(), compactSpectraFilter->GetOutput(), "Compact"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The estimated footprints cover the output, shrink with the requested
+  // region, and the lists of the 11 lines of the support windows take more
+  // than the compact windows.
+  const SpectraImageType * spectraOutput = spectraFilter->GetOutput();
+  const itk::SizeValueType outputBytes = spectraOutput->GetLargestPossibleRegion().GetNumberOfPixels() *
+                                         spectraOutput->GetNumberOfComponentsPerPixel() * sizeof(SpectraComponentType);
+  const itk::SizeValueType spectraFootprint = spectraFilter->EstimateMemoryFootprint();
+  std::cout << "Estimated spectra footprint: " << spectraFootprint << " bytes" << std::endl;
+  ITK_TEST_EXPECT_TRUE(spectraFootprint > outputBytes);
+  ITK_TEST_EXPECT_TRUE(streamingSpectraFilter->EstimateMemoryFootprint(streamingRegion) < spectraFootprint);
+  const SupportWindowImageType::RegionType & supportWindowRegion = supportWindowImage->GetLargestPossibleRegion();
+  using CompactSupportWindowType = CompactSupportWindowFilterType::OutputPixelType;
+  ITK_TEST_EXPECT_EQUAL(compactSupportWindowFilter->EstimateMemoryFootprint(supportWindowRegion, 11),
+                        supportWindowRegion.GetNumberOfPixels() * sizeof(CompactSupportWindowType));
+  ITK_TEST_EXPECT_TRUE(spectraSupportWindowFilter->EstimateMemoryFootprint(supportWindowRegion, 11) >
+                       supportWindowRegion.GetNumberOfPixels() * 11 * sizeof(ImageType::IndexType));
+
+  // Batching the segments of a line, or reusing the segments shared by
+  // consecutive windows, does not change the estimate, whatever the Welch's
+  // method configuration.  The segment hop, 16 samples, is the Step of the
+  // support windows.
+  for (int window = SpectraFilterType::HAMMING_WINDOW; window <= SpectraFilterType::TUKEY_WINDOW; ++window)
+  {
+    SpectraFilterType::Pointer welchSpectraFilters[4];
+    for (unsigned int configuration = 0; configuration < 4; ++configuration)
+    {
+      welchSpectraFilters[configuration] = SpectraFilterType::New();
+      SpectraFilterType * welchSpectraFilter = welchSpectraFilters[configuration];
+      welchSpectraFilter->SetInput(rfImage);
+      welchSpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+      welchSpectraFilter->SetWindow(static_cast<SpectraFilterType::WindowType>(window));
+      welchSpectraFilter->SetTukeyAlpha(0.25);
+      welchSpectraFilter->SetNumberOfSegments(5);
+      welchSpectraFilter->SetSegmentOverlap(0.75);
+      welchSpectraFilter->SetBatched((configuration & 1) != 0);
+      welchSpectraFilter->SetReuseSegments((configuration & 2) != 0);
+      ITK_TRY_EXPECT_NO_EXCEPTION(welchSpectraFilter->UpdateLargestPossibleRegion());
+      if (configuration > 0 &&
+          !spectraAgree(welchSpectraFilters[0]->GetOutput(), welchSpectraFilter->GetOutput(), "Welch"))
+      {
+        std::cerr << "Window " << window << ", configuration " << configuration << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // 5 segments with 50% overlap span three times the segment length, which
+  // is more than the FFT1DSize.
+  SpectraFilterType::Pointer invalidSpectraFilter = SpectraFilterType::New();
+  invalidSpectraFilter->SetInput(rfImage);
+  invalidSpectraFilter->SetSupportWindowImage(spectraSupportWindowFilter->GetOutput());
+  invalidSpectraFilter->SetNumberOfSegments(5);
+  invalidSpectraFilter->SetSegmentOverlap(0.5);
+  ITK_TRY_EXPECT_EXCEPTION(invalidSpectraFilter->UpdateLargestPossibleRegion());
+
   return EXIT_SUCCESS;
 }
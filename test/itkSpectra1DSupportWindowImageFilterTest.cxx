@@ -18,7 +18,11 @@
 
 #include "itkSpectra1DSupportWindowImageFilter.h"
 
+#include <algorithm>
+#include <type_traits>
+
 #include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageFileWriter.h"
 #include "itkPermuteAxesImageFilter.h"
 #include "itkTestingMacros.h"
@@ -74,5 +78,37 @@ itkSpectra1DSupportWindowImageFilterTest(int argc, char * argv[])
   std::cout << "\n\nAfter setting the Step to 10: " << std::endl;
   spectraSupportWindowFilter->Print(std::cout);
 
+  // The compact support windows encode the same lines.
+  using CompactSupportWindowType = itk::Spectra1DCompactSupportWindow<Dimension>;
+  static_assert(std::is_trivially_copyable<CompactSupportWindowType>::value,
+                "The compact support window should be trivially copyable");
+  using CompactSupportWindowFilterType = itk::Spectra1DSupportWindowImageFilter<ImageType, CompactSupportWindowType>;
+  CompactSupportWindowFilterType::Pointer compactSupportWindowFilter = CompactSupportWindowFilterType::New();
+  compactSupportWindowFilter->SetInput(sideLines);
+  compactSupportWindowFilter->SetStep(10);
+  ITK_TRY_EXPECT_NO_EXCEPTION(compactSupportWindowFilter->UpdateLargestPossibleRegion());
+
+  using SupportWindowImageType = SpectraSupportWindowFilterType::OutputImageType;
+  using CompactSupportWindowImageType = CompactSupportWindowFilterType::OutputImageType;
+  const SupportWindowImageType *        supportWindowImage = spectraSupportWindowFilter->GetOutput();
+  const CompactSupportWindowImageType * compactSupportWindowImage = compactSupportWindowFilter->GetOutput();
+  ITK_TEST_EXPECT_EQUAL(supportWindowImage->GetLargestPossibleRegion(),
+                        compactSupportWindowImage->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<SupportWindowImageType> supportWindowIt(
+    supportWindowImage, supportWindowImage->GetLargestPossibleRegion());
+  for (supportWindowIt.GoToBegin(); !supportWindowIt.IsAtEnd(); ++supportWindowIt)
+  {
+    const SupportWindowImageType::PixelType & supportWindow = supportWindowIt.Get();
+    const CompactSupportWindowType &          compactSupportWindow =
+      compactSupportWindowImage->GetPixel(supportWindowIt.GetIndex());
+    if (supportWindow.size() != compactSupportWindow.size() ||
+        !std::equal(supportWindow.begin(), supportWindow.end(), compactSupportWindow.begin()))
+    {
+      std::cerr << "Compact support window mismatch at " << supportWindowIt.GetIndex() << ": "
+                << compactSupportWindow << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Throughput of the spectra, the speckle reducing anisotropic diffusion and
+// the scan conversion.
+
+#include <iostream>
+#include <string>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkImage.h"
+#include "itkMirrorPadImageFilter.h"
+#include "itkVectorImage.h"
+
+#include "itkCurvilinearArrayScanConvertImageFilter.h"
+#include "itkSpeckleReducingAnisotropicDiffusionImageFilter.h"
+#include "itkSpectra1DImageFilter.h"
+#include "itkSpectra1DSupportWindowImageFilter.h"
+#include "itkUltrasoundBenchmark.h"
+
+int
+itkSpectraBenchmark(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " outputJSON [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const unsigned int repetitions = (argc > 2) ? std::stoi(argv[2]) : 10;
+
+  const unsigned int Dimension = 2;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+  HarnessType harness("Spectra");
+
+  try
+  {
+    // Spectra of a 2D RF frame with 128 sample windows.
+    using RFImageType = itk::Image<short, Dimension>;
+    RFImageType::SizeType rfSize;
+    rfSize[0] = 2048;
+    rfSize[1] = 128;
+    RFImageType::Pointer rf = HarnessType::MakeRF<RFImageType>(rfSize);
+    const std::string    rfGeometry = HarnessType::GetGeometry(rfSize);
+    const double         rfSamples = static_cast<double>(rfSize[0] * rfSize[1]);
+
+    RFImageType::Pointer sideLines = RFImageType::New();
+    sideLines->CopyInformation(rf);
+    sideLines->SetRegions(rf->GetLargestPossibleRegion());
+    sideLines->Allocate();
+    sideLines->FillBuffer(5);
+
+    using SupportWindowFilterType = itk::Spectra1DSupportWindowImageFilter<RFImageType>;
+    SupportWindowFilterType::Pointer supportWindowFilter = SupportWindowFilterType::New();
+    supportWindowFilter->SetInput(sideLines);
+    supportWindowFilter->SetFFT1DSize(128);
+    supportWindowFilter->SetStep(16);
+    supportWindowFilter->UpdateLargestPossibleRegion();
+
+    using SupportWindowImageType = SupportWindowFilterType::OutputImageType;
+    using SpectraImageType = itk::VectorImage<float, Dimension>;
+    using SpectraFilterType = itk::Spectra1DImageFilter<RFImageType, SupportWindowImageType, SpectraImageType>;
+
+    // The speckle reducing anisotropic diffusion of a B-Mode frame, padded
+    // with one mirrored pixel.
+    using ImageType = itk::Image<float, Dimension>;
+    ImageType::SizeType imageSize;
+    imageSize[0] = 512;
+    imageSize[1] = 512;
+    ImageType::Pointer image = HarnessType::MakeRF<ImageType>(imageSize);
+    using PadFilterType = itk::MirrorPadImageFilter<ImageType, ImageType>;
+    PadFilterType::Pointer padFilter = PadFilterType::New();
+    padFilter->SetInput(image);
+    ImageType::SizeType padSize;
+    padSize.Fill(1);
+    padFilter->SetPadLowerBound(padSize);
+    padFilter->SetPadUpperBound(padSize);
+    padFilter->Update();
+    const std::string  sradGeometry = HarnessType::GetGeometry(imageSize);
+    const unsigned int sradIterations = 20;
+    const double       sradSamples = static_cast<double>(imageSize[0] * imageSize[1] * sradIterations);
+    using SpeckleFilterType = itk::SpeckleReducingAnisotropicDiffusionImageFilter<ImageType>;
+
+    // The scan conversion of a curvilinear array frame.
+    using CurvilinearImageType = itk::CurvilinearArraySpecialCoordinatesImage<float, Dimension>;
+    CurvilinearImageType::SizeType curvilinearSize;
+    curvilinearSize[0] = 2048;
+    curvilinearSize[1] = 128;
+    CurvilinearImageType::Pointer curvilinear = HarnessType::MakeRF<CurvilinearImageType>(curvilinearSize);
+    curvilinear->SetLateralAngularSeparation((itk::Math::pi / 2.0) / (curvilinearSize[1] - 1));
+    curvilinear->SetRadiusSampleSize(0.05);
+    curvilinear->SetFirstSampleDistance(10.0);
+    const std::string curvilinearGeometry = HarnessType::GetGeometry(curvilinearSize);
+    using ScanConvertFilterType = itk::CurvilinearArrayScanConvertImageFilter<CurvilinearImageType, ImageType>;
+    ScanConvertFilterType::SizeType scanConvertedSize;
+    scanConvertedSize.Fill(600);
+    ScanConvertFilterType::SpacingType scanConvertedSpacing;
+    scanConvertedSpacing.Fill(0.2);
+    ScanConvertFilterType::PointType scanConvertedOrigin;
+    scanConvertedOrigin[0] = -60.0;
+    scanConvertedOrigin[1] = 0.0;
+    const double scanConvertedSamples = static_cast<double>(scanConvertedSize[0] * scanConvertedSize[1]);
+
+    for (const unsigned int threads : HarnessType::GetThreadCounts())
+    {
+      SpectraFilterType::Pointer spectraFilter = SpectraFilterType::New();
+      spectraFilter->SetInput(rf);
+      spectraFilter->SetSupportWindowImage(supportWindowFilter->GetOutput());
+      HarnessType::SetThreads(spectraFilter, threads);
+      harness.Run("Spectra1D", rfGeometry, threads, rfSamples, repetitions, [&spectraFilter]() {
+        spectraFilter->Modified();
+        spectraFilter->UpdateLargestPossibleRegion();
+      });
+
+      for (unsigned int fused = 0; fused < 2; ++fused)
+      {
+        SpeckleFilterType::Pointer speckleFilter = SpeckleFilterType::New();
+        speckleFilter->SetInput(padFilter->GetOutput());
+        speckleFilter->SetNumberOfIterations(sradIterations);
+        speckleFilter->SetTimeStep(0.002);
+        speckleFilter->SetFused(fused);
+        HarnessType::SetThreads(speckleFilter, threads);
+        harness.Run(fused ? "SRAD fused" : "SRAD", sradGeometry, threads, sradSamples, repetitions, [&speckleFilter]() {
+          speckleFilter->Modified();
+          speckleFilter->Update();
+        });
+      }
+
+      // The throughput of the scan conversion is in output samples.
+      ScanConvertFilterType::Pointer scanConvertFilter = ScanConvertFilterType::New();
+      scanConvertFilter->SetInput(curvilinear);
+      scanConvertFilter->SetSize(scanConvertedSize);
+      scanConvertFilter->SetOutputSpacing(scanConvertedSpacing);
+      scanConvertFilter->SetOutputOrigin(scanConvertedOrigin);
+      HarnessType::SetThreads(scanConvertFilter, threads);
+      harness.Run("CurvilinearArrayScanConvert",
+                  curvilinearGeometry,
+                  threads,
+                  scanConvertedSamples,
+                  repetitions,
+                  [&scanConvertFilter]() {
+                    scanConvertFilter->Modified();
+                    scanConvertFilter->Update();
+                  });
+    }
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!harness.WriteJSON(argv[1]))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
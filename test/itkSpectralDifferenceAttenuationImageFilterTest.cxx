@@ -0,0 +1,188 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iostream>
+
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVectorImage.h"
+#include "itkTestingMacros.h"
+
+#include "itkSpectra1DSupportWindowImageFilter.h"
+#include "itkSpectra1DImageFilter.h"
+#include "itkSpectralDifferenceAttenuationImageFilter.h"
+
+int
+itkSpectralDifferenceAttenuationImageFilterTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputImage";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const unsigned int Dimension = 2;
+  using SpectraImageType = itk::VectorImage<float, Dimension>;
+  using FilterType = itk::SpectralDifferenceAttenuationImageFilter<SpectraImageType>;
+  using OutputImageType = FilterType::OutputImageType;
+
+  // Spectra attenuated by beta f dB per unit of depth and frequency, one
+  // way, with a different spectrum on every line.
+  const double                beta = 0.3;
+  const double                firstFrequency = 2.0;
+  const double                frequencyStep = 0.5;
+  const unsigned int          numberOfComponents = 12;
+  SpectraImageType::SizeType  size;
+  size[0] = 40;
+  size[1] = 5;
+  SpectraImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 1.0;
+  SpectraImageType::Pointer spectra = SpectraImageType::New();
+  spectra->SetRegions(size);
+  spectra->SetSpacing(spacing);
+  spectra->SetNumberOfComponentsPerPixel(numberOfComponents);
+  spectra->Allocate();
+  SpectraImageType::Pointer decibelSpectra = SpectraImageType::New();
+  decibelSpectra->CopyInformation(spectra);
+  decibelSpectra->SetRegions(size);
+  decibelSpectra->SetNumberOfComponentsPerPixel(numberOfComponents);
+  decibelSpectra->Allocate();
+  SpectraImageType::PixelType                         pixel(numberOfComponents);
+  SpectraImageType::PixelType                         decibelPixel(numberOfComponents);
+  itk::ImageRegionIteratorWithIndex<SpectraImageType> it(spectra, spectra->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const SpectraImageType::IndexType & index = it.GetIndex();
+    const double                        depth = index[0] * spacing[0];
+    for (unsigned int component = 0; component < numberOfComponents; ++component)
+    {
+      const double frequency = firstFrequency + component * frequencyStep;
+      const double level = 10.0 * std::log10(1.0 + component + index[1]) - 2.0 * beta * frequency * depth;
+      decibelPixel[component] = static_cast<float>(level);
+      pixel[component] = static_cast<float>(std::pow(10.0, level / 10.0));
+    }
+    it.Set(pixel);
+    decibelSpectra->SetPixel(index, decibelPixel);
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, SpectralDifferenceAttenuationImageFilter, ImageToImageFilter);
+
+  ITK_TEST_SET_GET_VALUE(4, filter->GetAxialRadius());
+  ITK_TEST_SET_GET_VALUE(8, filter->GetNumberOfSlabs());
+  filter->SetAxialRadius(3);
+  filter->SetFirstFrequency(firstFrequency);
+  filter->SetFrequencyStep(frequencyStep);
+  ITK_TEST_SET_GET_VALUE(firstFrequency, filter->GetFirstFrequency());
+  ITK_TEST_SET_GET_VALUE(frequencyStep, filter->GetFrequencyStep());
+  filter->SetNumberOfSlabs(3);
+  filter->SetInput(spectra);
+
+  // The attenuation is beta everywhere, including the ends of the lines and
+  // of the slabs.
+  const auto check = [&](const char * description) {
+    const OutputImageType *                        output = filter->GetOutput();
+    itk::ImageRegionConstIterator<OutputImageType> outputIt(output, output->GetLargestPossibleRegion());
+    for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt)
+    {
+      if (std::abs(outputIt.Get() - beta) > 1e-3 * beta)
+      {
+        std::cerr << description << ": expected " << beta << ", got " << outputIt.Get() << std::endl;
+        return false;
+      }
+    }
+    return true;
+  };
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetBufferedRegion(), spectra->GetLargestPossibleRegion());
+  ITK_TEST_EXPECT_TRUE(check("Power spectra"));
+
+  ITK_TEST_SET_GET_BOOLEAN(filter, DecibelInput, false);
+  filter->DecibelInputOn();
+  filter->SetInput(decibelSpectra);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(check("Decibel spectra"));
+
+  // Downstream of Spectra1DImageFilter, the spectra are only generated a
+  // slab at a time, and the attenuation does not depend on the slabs.
+  using RFImageType = itk::Image<short, Dimension>;
+  using ReaderType = itk::ImageFileReader<RFImageType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->UpdateLargestPossibleRegion());
+
+  RFImageType::Pointer sideLines = RFImageType::New();
+  sideLines->CopyInformation(reader->GetOutput());
+  sideLines->SetRegions(reader->GetOutput()->GetLargestPossibleRegion());
+  sideLines->Allocate();
+  sideLines->FillBuffer(5);
+
+  using SupportWindowFilterType = itk::Spectra1DSupportWindowImageFilter<RFImageType>;
+  SupportWindowFilterType::Pointer supportWindowFilter = SupportWindowFilterType::New();
+  supportWindowFilter->SetInput(sideLines);
+  supportWindowFilter->SetFFT1DSize(128);
+  supportWindowFilter->SetStep(16);
+  ITK_TRY_EXPECT_NO_EXCEPTION(supportWindowFilter->UpdateLargestPossibleRegion());
+
+  using SupportWindowImageType = SupportWindowFilterType::OutputImageType;
+  using SpectraFilterType = itk::Spectra1DImageFilter<RFImageType, SupportWindowImageType, SpectraImageType>;
+  SpectraFilterType::Pointer spectraFilter = SpectraFilterType::New();
+  spectraFilter->SetInput(reader->GetOutput());
+  spectraFilter->SetSupportWindowImage(supportWindowFilter->GetOutput());
+  spectraFilter->SetFirstFrequencyBin(5);
+  spectraFilter->SetNumberOfFrequencyBins(10);
+
+  FilterType::Pointer streamedFilter = FilterType::New();
+  streamedFilter->SetInput(spectraFilter->GetOutput());
+  streamedFilter->SetAxialRadius(2);
+  streamedFilter->SetFirstFrequency(6.0 / 64.0);
+  streamedFilter->SetFrequencyStep(1.0 / 64.0);
+  streamedFilter->SetNumberOfSlabs(4);
+  ITK_TRY_EXPECT_NO_EXCEPTION(streamedFilter->Update());
+  const SpectraImageType::RegionType & spectraRegion = spectraFilter->GetOutput()->GetLargestPossibleRegion();
+  ITK_TEST_EXPECT_TRUE(spectraFilter->GetOutput()->GetBufferedRegion().GetSize(0) < spectraRegion.GetSize(0));
+
+  FilterType::Pointer wholeFilter = FilterType::New();
+  wholeFilter->SetInput(spectraFilter->GetOutput());
+  wholeFilter->SetAxialRadius(2);
+  wholeFilter->SetFirstFrequency(6.0 / 64.0);
+  wholeFilter->SetFrequencyStep(1.0 / 64.0);
+  wholeFilter->SetNumberOfSlabs(1);
+  ITK_TRY_EXPECT_NO_EXCEPTION(wholeFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(spectraFilter->GetOutput()->GetBufferedRegion(), spectraRegion);
+
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> wholeIt(wholeFilter->GetOutput(), spectraRegion);
+  for (wholeIt.GoToBegin(); !wholeIt.IsAtEnd(); ++wholeIt)
+  {
+    const float streamed = streamedFilter->GetOutput()->GetPixel(wholeIt.GetIndex());
+    if (std::abs(streamed - wholeIt.Get()) > 1e-4 * (std::abs(wholeIt.Get()) + 1.0))
+    {
+      std::cerr << "Streamed attenuation mismatch at " << wholeIt.GetIndex() << ": " << streamed << " vs. "
+                << wholeIt.Get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
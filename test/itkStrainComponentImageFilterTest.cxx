@@ -0,0 +1,142 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itkVector.h"
+
+#include "itkStrainComponentImageFilter.h"
+
+int
+itkStrainComponentImageFilterTest(int, char *[])
+{
+  using DisplacementImageType = itk::Image<itk::Vector<float, 2>, 2>;
+  using FilterType = itk::StrainComponentImageFilter<DisplacementImageType>;
+  using OutputImageType = FilterType::OutputImageType;
+
+  // u_0 = a x_0 + b x_1 + q x_0^2, u_1 = c x_0 + d x_1, in physical units.
+  const double a = 0.01;
+  const double b = -0.003;
+  const double c = 0.007;
+  const double d = -0.02;
+  const double q = 0.0005;
+
+  DisplacementImageType::Pointer displacements = DisplacementImageType::New();
+  DisplacementImageType::SizeType size;
+  size[0] = 60;
+  size[1] = 25;
+  DisplacementImageType::IndexType start;
+  start[0] = 3;
+  start[1] = -2;
+  displacements->SetRegions(DisplacementImageType::RegionType(start, size));
+  DisplacementImageType::SpacingType spacing;
+  spacing[0] = 0.05;
+  spacing[1] = 0.2;
+  displacements->SetSpacing(spacing);
+  displacements->Allocate();
+  itk::ImageRegionIteratorWithIndex<DisplacementImageType> it(displacements,
+                                                              displacements->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const double                      x0 = it.GetIndex()[0] * spacing[0];
+    const double                      x1 = it.GetIndex()[1] * spacing[1];
+    DisplacementImageType::PixelType displacement;
+    displacement[0] = static_cast<float>(a * x0 + b * x1 + q * x0 * x0);
+    displacement[1] = static_cast<float>(c * x0 + d * x1);
+    it.Set(displacement);
+  }
+
+  FilterType::Pointer filter = FilterType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, StrainComponentImageFilter, ImageToImageFilter);
+
+  FilterType::RadiusType radius;
+  radius.Fill(1);
+  ITK_TEST_SET_GET_VALUE(radius, filter->GetRadius());
+  FilterType::ComponentType component;
+  component.Fill(0);
+  ITK_TEST_SET_GET_VALUE(component, filter->GetComponent());
+
+  filter->SetInput(displacements);
+
+  // Whether the strain is expected(x_0) wherever the fit along x_0 has its
+  // full radius, or everywhere for a linear component.
+  const auto check = [&](double tolerance, bool interiorOnly, auto expected) {
+    const OutputImageType * output = filter->GetOutput();
+    itk::ImageRegionConstIteratorWithIndex<OutputImageType> outputIt(output, output->GetBufferedRegion());
+    double                                                  maximumError = 0.0;
+    for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt)
+    {
+      const itk::IndexValueType axialIndex = outputIt.GetIndex()[0];
+      const itk::IndexValueType radius0 = static_cast<itk::IndexValueType>(filter->GetRadius()[0]);
+      const itk::IndexValueType end0 = start[0] + static_cast<itk::IndexValueType>(size[0]);
+      if (interiorOnly && (axialIndex < start[0] + radius0 || axialIndex >= end0 - radius0))
+      {
+        continue;
+      }
+      maximumError = std::max(maximumError, std::abs(outputIt.Get() - expected(axialIndex * spacing[0])));
+    }
+    std::cout << "Component (" << filter->GetComponent()[0] << ", " << filter->GetComponent()[1]
+              << "), maximum error: " << maximumError << std::endl;
+    return maximumError < tolerance;
+  };
+
+  // The axial strain has the quadratic term, fitted exactly away from the
+  // boundary.
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetBufferedRegion(), displacements->GetLargestPossibleRegion());
+  ITK_TEST_EXPECT_TRUE(check(1e-5, true, [&](double x0) { return a + 2.0 * q * x0; }));
+
+  radius[0] = 4;
+  filter->SetRadius(radius);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(check(1e-5, true, [&](double x0) { return a + 2.0 * q * x0; }));
+
+  // The shear and lateral strains are linear, fitted exactly everywhere.
+  filter->SetComponent(0, 1);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(check(1e-5, false, [&](double) { return 0.5 * (b + c); }));
+  filter->SetComponent(1, 0);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(check(1e-5, false, [&](double) { return 0.5 * (b + c); }));
+  filter->SetComponent(1, 1);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(check(1e-5, false, [&](double) { return d; }));
+
+  // A streamed region gives the same strains.
+  OutputImageType::RegionType streamedRegion = displacements->GetLargestPossibleRegion();
+  streamedRegion.ShrinkByRadius(5);
+  filter->GetOutput()->SetRequestedRegion(streamedRegion);
+  filter->Modified();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->GetOutput()->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetBufferedRegion(), streamedRegion);
+  ITK_TEST_EXPECT_TRUE(check(1e-5, false, [&](double) { return d; }));
+
+  // There is no component 2 in 2D.
+  filter->SetComponent(2, 0);
+  filter->GetOutput()->SetRequestedRegionToLargestPossibleRegion();
+  ITK_TRY_EXPECT_EXCEPTION(filter->Update());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include <set>
+
+#include "itkAbsImageFilter.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include "itkThreadedFramePipeline.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using PixelType = float;
+using FrameType = itk::Image<PixelType, Dimension>;
+
+PixelType
+pixelValue(itk::SizeValueType frame, const FrameType::IndexType & index)
+{
+  return -static_cast<PixelType>(10000 * frame + 100 * index[1] + index[0]);
+}
+
+} // namespace
+
+int
+itkThreadedFramePipelineTest(int, char *[])
+{
+  using PipelineType = itk::ThreadedFramePipeline<FrameType, FrameType>;
+  PipelineType::Pointer pipeline = PipelineType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(pipeline, ThreadedFramePipeline, Object);
+
+  const itk::SizeValueType numberOfSlots = 2;
+  pipeline->SetNumberOfSlots(numberOfSlots);
+  ITK_TEST_SET_GET_VALUE(numberOfSlots, pipeline->GetNumberOfSlots());
+
+  // The stages are required.
+  ITK_TRY_EXPECT_EXCEPTION(pipeline->Run());
+
+  FrameType::SizeType size;
+  size[0] = 64;
+  size[1] = 16;
+  FrameType::Pointer reference = FrameType::New();
+  reference->SetRegions(size);
+  FrameType::SpacingType spacing;
+  spacing[0] = 0.05;
+  spacing[1] = 0.3;
+  reference->SetSpacing(spacing);
+  pipeline->SetReferenceInputFrame(reference);
+  ITK_TEST_SET_GET_VALUE(reference.GetPointer(), pipeline->GetReferenceInputFrame());
+
+  using AbsFilterType = itk::AbsImageFilter<FrameType, FrameType>;
+  AbsFilterType::Pointer absFilter = AbsFilterType::New();
+  pipeline->SetFrameFilter(absFilter);
+
+  const itk::SizeValueType numberOfFrames = 25;
+  itk::SizeValueType       acquiredFrames = 0;
+  pipeline->SetFrameSource([&acquiredFrames, numberOfFrames](FrameType * frame) {
+    if (acquiredFrames == numberOfFrames)
+    {
+      return false;
+    }
+    itk::ImageRegionIteratorWithIndex<FrameType> it(frame, frame->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      it.Set(pixelValue(acquiredFrames, it.GetIndex()));
+    }
+    ++acquiredFrames;
+    return true;
+  });
+
+  // The frames arrive in order, in the buffers of the output slots.
+  itk::SizeValueType          displayedFrames = 0;
+  bool                        valid = true;
+  std::set<const PixelType *> buffers;
+  pipeline->SetFrameSink([&](const FrameType * frame) {
+    buffers.insert(frame->GetBufferPointer());
+    valid = valid && frame->GetSpacing() == spacing;
+    itk::ImageRegionConstIteratorWithIndex<FrameType> it(frame, frame->GetLargestPossibleRegion());
+    for (it.GoToBegin(); valid && !it.IsAtEnd(); ++it)
+    {
+      if (it.Get() != -pixelValue(displayedFrames, it.GetIndex()))
+      {
+        std::cerr << "Mismatch in frame " << displayedFrames << " at " << it.GetIndex() << ": " << it.Get()
+                  << std::endl;
+        valid = false;
+      }
+    }
+    ++displayedFrames;
+  });
+
+  ITK_TRY_EXPECT_NO_EXCEPTION(pipeline->Run());
+  ITK_TEST_EXPECT_TRUE(valid);
+  ITK_TEST_EXPECT_EQUAL(pipeline->GetNumberOfFrames(), numberOfFrames);
+  ITK_TEST_EXPECT_EQUAL(displayedFrames, numberOfFrames);
+  ITK_TEST_EXPECT_TRUE(buffers.size() <= numberOfSlots);
+  ITK_TEST_EXPECT_TRUE(pipeline->GetMaximumLatency() >= 0.0);
+
+  // A failing stage stops the others, and the error is rethrown.
+  acquiredFrames = 0;
+  displayedFrames = 0;
+  pipeline->SetFrameSink([&displayedFrames](const FrameType *) {
+    if (++displayedFrames == 3)
+    {
+      itkGenericExceptionMacro(<< "The display failed.");
+    }
+  });
+  ITK_TRY_EXPECT_EXCEPTION(pipeline->Run());
+  ITK_TEST_EXPECT_TRUE(acquiredFrames < numberOfFrames);
+
+  return EXIT_SUCCESS;
+}
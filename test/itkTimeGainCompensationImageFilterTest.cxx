@@ -24,9 +24,12 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkResampleImageFilter.h"
 #include "itkTestingMacros.h"
 
+#include <cmath>
+
 int
 itkTimeGainCompensationImageFilterTest(int argc, char * argv[])
 {
@@ -133,5 +136,96 @@ itkTimeGainCompensationImageFilterTest(int argc, char * argv[])
   writer->SetInput(rescaler->GetOutput());
   ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
 
+  // The same gain given per sample, or in decibels, gives the same output.
+  using SmallImageType = itk::Image<RealPixelType, Dimension>;
+  SmallImageType::Pointer    smallImage = SmallImageType::New();
+  SmallImageType::RegionType smallRegion;
+  smallRegion.SetSize(0, 100);
+  smallRegion.SetSize(1, 3);
+  smallImage->SetRegions(smallRegion);
+  SmallImageType::SpacingType smallSpacing;
+  smallSpacing[0] = 30.0;
+  smallSpacing[1] = 1.0;
+  smallImage->SetSpacing(smallSpacing);
+  smallImage->Allocate();
+  smallImage->FillBuffer(2.0f);
+
+  // These filters share their input, so they must not overwrite it.
+  using SmallTGCFilterType = itk::TimeGainCompensationImageFilter<SmallImageType>;
+  SmallTGCFilterType::Pointer piecewiseFilter = SmallTGCFilterType::New();
+  piecewiseFilter->SetInput(smallImage);
+  ITK_TEST_SET_GET_BOOLEAN(piecewiseFilter, InPlace, false);
+  piecewiseFilter->SetGain(gain);
+  ITK_TRY_EXPECT_NO_EXCEPTION(piecewiseFilter->Update());
+
+  SmallTGCFilterType::SampleGainType sampleGain(100);
+  SmallTGCFilterType::SampleGainType decibelSampleGain(100);
+  for (unsigned int sample = 0; sample < 100; ++sample)
+  {
+    const double depth = sample * smallSpacing[0];
+    sampleGain[sample] = depth <= 1000.0 ? 1.0 + 2.0 * depth / 1000.0
+                                         : (depth <= 2000.0 ? 3.0 + 2.0 * (depth - 1000.0) / 1000.0 : 5.0);
+    decibelSampleGain[sample] = 20.0 * std::log10(sampleGain[sample]);
+  }
+  SmallTGCFilterType::Pointer sampleGainFilter = SmallTGCFilterType::New();
+  sampleGainFilter->SetInput(smallImage);
+  sampleGainFilter->InPlaceOff();
+  sampleGainFilter->SetSampleGain(sampleGain);
+  ITK_TRY_EXPECT_NO_EXCEPTION(sampleGainFilter->Update());
+
+  SmallTGCFilterType::Pointer decibelGainFilter = SmallTGCFilterType::New();
+  decibelGainFilter->SetInput(smallImage);
+  decibelGainFilter->InPlaceOff();
+  decibelGainFilter->SetSampleGain(decibelSampleGain);
+  ITK_TEST_SET_GET_BOOLEAN(decibelGainFilter, DecibelGain, true);
+  ITK_TRY_EXPECT_NO_EXCEPTION(decibelGainFilter->Update());
+  decibelGainFilter->Print(std::cout);
+
+  itk::ImageRegionConstIteratorWithIndex<SmallImageType> smallIt(piecewiseFilter->GetOutput(), smallRegion);
+  for (smallIt.GoToBegin(); !smallIt.IsAtEnd(); ++smallIt)
+  {
+    const SmallImageType::IndexType index = smallIt.GetIndex();
+    const double                    expected = 2.0 * sampleGain[index[0]];
+    if (std::abs(smallIt.Get() - expected) > 1e-4 ||
+        std::abs(sampleGainFilter->GetOutput()->GetPixel(index) - expected) > 1e-4 ||
+        std::abs(decibelGainFilter->GetOutput()->GetPixel(index) - expected) > 1e-4)
+    {
+      std::cerr << "Gain mismatch at " << index << ": expected " << expected << ", piecewise " << smallIt.Get()
+                << ", per sample " << sampleGainFilter->GetOutput()->GetPixel(index) << ", decibels "
+                << decibelGainFilter->GetOutput()->GetPixel(index) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // In place, the gain is applied to the input buffer.
+  SmallImageType::Pointer inPlaceImage = SmallImageType::New();
+  inPlaceImage->SetRegions(smallRegion);
+  inPlaceImage->SetSpacing(smallSpacing);
+  inPlaceImage->Allocate();
+  inPlaceImage->FillBuffer(2.0f);
+  const RealPixelType * inPlaceBuffer = inPlaceImage->GetBufferPointer();
+
+  SmallTGCFilterType::Pointer inPlaceFilter = SmallTGCFilterType::New();
+  inPlaceFilter->SetInput(inPlaceImage);
+  inPlaceFilter->SetGain(gain);
+  ITK_TEST_EXPECT_TRUE(inPlaceFilter->GetInPlace());
+  ITK_TRY_EXPECT_NO_EXCEPTION(inPlaceFilter->Update());
+  ITK_TEST_EXPECT_TRUE(inPlaceFilter->GetOutput()->GetBufferPointer() == inPlaceBuffer);
+  for (smallIt.GoToBegin(); !smallIt.IsAtEnd(); ++smallIt)
+  {
+    const SmallImageType::IndexType index = smallIt.GetIndex();
+    if (std::abs(inPlaceFilter->GetOutput()->GetPixel(index) - smallIt.Get()) > 1e-4)
+    {
+      std::cerr << "In place gain mismatch at " << index << ": expected " << smallIt.Get() << ", in place "
+                << inPlaceFilter->GetOutput()->GetPixel(index) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A sample gain must have a value per sample.
+  sampleGain.SetSize(10);
+  sampleGainFilter->SetSampleGain(sampleGain);
+  ITK_TRY_EXPECT_EXCEPTION(sampleGainFilter->Update());
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,294 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkUltrasoundBenchmark_h
+#define itkUltrasoundBenchmark_h
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "itkHighPriorityRealTimeProbe.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMath.h"
+#include "itkMultiThreaderBase.h"
+#include "itkProcessObject.h"
+
+namespace itk
+{
+namespace UltrasoundBenchmark
+{
+
+/** \class Harness
+ *
+ * \brief Times the stages of the Ultrasound module for the benchmark driver.
+ *
+ * Every case is run once to warm up the plans, tables and pools, then
+ * timed for a number of repetitions with a HighPriorityRealTimeProbe.  The
+ * throughput is reported in millions of input samples per second, for
+ * every number of threads given by GetThreadCounts(), so that the scaling
+ * can be read from the report.  WriteJSON() writes the results for
+ * regression tracking, and CompareToBaseline() gates the run times on a
+ * baseline of the machine class.
+ *
+ * \ingroup Ultrasound
+ */
+class Harness
+{
+public:
+  explicit Harness(std::string suite)
+    : m_Suite(std::move(suite))
+  {}
+
+  struct ResultType
+  {
+    std::string  Name;
+    std::string  Geometry;
+    unsigned int Threads;
+    unsigned int Repetitions;
+    double       Samples;
+    double       MeanSeconds;
+    double       MinimumSeconds;
+  };
+
+  /** Powers of two up to the global default number of threads, and that
+   * number. */
+  static std::vector<unsigned int>
+  GetThreadCounts()
+  {
+    const unsigned int        maximumThreads = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maximumThreads; threads *= 2)
+    {
+      threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maximumThreads);
+    return threadCounts;
+  }
+
+  /** Restrict a filter to a number of threads. */
+  static void
+  SetThreads(ProcessObject * process, unsigned int threads)
+  {
+    process->GetMultiThreader()->SetMaximumNumberOfThreads(threads);
+    process->SetNumberOfWorkUnits(threads);
+  }
+
+  /** Time a case.  run() is called repetitions + 1 times, and must redo
+   * the whole computation every time, e.g. by calling Modified() before
+   * Update().  samples is the number of input samples of one run. */
+  template <typename TRun>
+  void
+  Run(const std::string & name,
+      const std::string & geometry,
+      unsigned int        threads,
+      double              samples,
+      unsigned int        repetitions,
+      TRun &&             run)
+  {
+    run();
+
+    HighPriorityRealTimeProbe probe;
+    for (unsigned int repetition = 0; repetition < repetitions; ++repetition)
+    {
+      probe.Start();
+      run();
+      probe.Stop();
+    }
+
+    ResultType result;
+    result.Name = name;
+    result.Geometry = geometry;
+    result.Threads = threads;
+    result.Repetitions = repetitions;
+    result.Samples = samples;
+    result.MeanSeconds = probe.GetMean();
+    result.MinimumSeconds = probe.GetMinimum();
+    m_Results.push_back(result);
+
+    std::cout << std::left << std::setw(40) << name << std::setw(16) << geometry << std::right << std::setw(4)
+              << threads << " threads " << std::setw(12) << std::fixed << std::setprecision(3)
+              << GetThroughput(result) << " MSamples/s" << std::endl;
+  }
+
+  /** Millions of input samples per second, from the mean run time. */
+  static double
+  GetThroughput(const ResultType & result)
+  {
+    return result.MeanSeconds > 0.0 ? result.Samples / result.MeanSeconds / 1.0e6 : 0.0;
+  }
+
+  const std::vector<ResultType> &
+  GetResults() const
+  {
+    return m_Results;
+  }
+
+  /** Write the results, one object per case and number of threads. */
+  bool
+  WriteJSON(const std::string & fileName) const
+  {
+    std::ofstream json(fileName.c_str());
+    if (!json)
+    {
+      std::cerr << "Could not write " << fileName << std::endl;
+      return false;
+    }
+    json << "{\n";
+    json << "  \"suite\": \"" << m_Suite << "\",\n";
+    json << "  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n";
+    json << "  \"benchmarks\": [\n";
+    json << std::setprecision(9);
+    for (size_t ii = 0; ii < m_Results.size(); ++ii)
+    {
+      const ResultType & result = m_Results[ii];
+      json << "    {\"name\": \"" << result.Name << "\", \"geometry\": \"" << result.Geometry
+           << "\", \"threads\": " << result.Threads << ", \"repetitions\": " << result.Repetitions
+           << ", \"samples\": " << result.Samples << ", \"mean_seconds\": " << result.MeanSeconds
+           << ", \"minimum_seconds\": " << result.MinimumSeconds
+           << ", \"msamples_per_second\": " << GetThroughput(result) << "}"
+           << (ii + 1 < m_Results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n";
+    json << "}\n";
+    return static_cast<bool>(json);
+  }
+
+  /** Write the minimum run times as a baseline: one tab separated line of
+   * name, geometry, threads and seconds per case. */
+  bool
+  WriteBaseline(const std::string & fileName) const
+  {
+    std::ofstream baseline(fileName.c_str());
+    if (!baseline)
+    {
+      std::cerr << "Could not write " << fileName << std::endl;
+      return false;
+    }
+    baseline << std::setprecision(9);
+    for (const ResultType & result : m_Results)
+    {
+      baseline << result.Name << '\t' << result.Geometry << '\t' << result.Threads << '\t' << result.MinimumSeconds
+               << '\n';
+    }
+    return static_cast<bool>(baseline);
+  }
+
+  /** Compare the minimum run times with a baseline written by
+   * WriteBaseline().  Returns false if a case is slower than its baseline
+   * by more than the tolerance, e.g. 0.15 for 15%, or has no baseline. */
+  bool
+  CompareToBaseline(const std::string & fileName, double tolerance) const
+  {
+    std::ifstream baseline(fileName.c_str());
+    if (!baseline)
+    {
+      std::cerr << "Could not read the baseline " << fileName << std::endl;
+      return false;
+    }
+    std::map<std::string, double> baselineSeconds;
+    std::string                   line;
+    while (std::getline(baseline, line))
+    {
+      const std::string::size_type secondsStart = line.find_last_of('\t');
+      if (line.empty() || line[0] == '#' || secondsStart == std::string::npos)
+      {
+        continue;
+      }
+      baselineSeconds[line.substr(0, secondsStart)] = std::stod(line.substr(secondsStart + 1));
+    }
+
+    bool passed = true;
+    for (const ResultType & result : m_Results)
+    {
+      std::ostringstream key;
+      key << result.Name << '\t' << result.Geometry << '\t' << result.Threads;
+      const auto it = baselineSeconds.find(key.str());
+      if (it == baselineSeconds.end())
+      {
+        std::cerr << "No baseline for " << result.Name << ", " << result.Geometry << ", " << result.Threads
+                  << " threads" << std::endl;
+        passed = false;
+        continue;
+      }
+      const double ratio = result.MinimumSeconds / it->second;
+      std::cout << result.Name << ", " << result.Geometry << ", " << result.Threads << " threads: " << std::fixed
+                << std::setprecision(6) << result.MinimumSeconds << " s for a baseline of " << it->second << " s ("
+                << std::setprecision(1) << 100.0 * (ratio - 1.0) << "%)" << std::endl;
+      if (ratio > 1.0 + tolerance)
+      {
+        std::cerr << "Performance regression of " << result.Name << ", " << result.Geometry << ", "
+                  << result.Threads << " threads: " << 100.0 * (ratio - 1.0) << "% slower than the baseline, "
+                  << "beyond the tolerance of " << 100.0 * tolerance << "%" << std::endl;
+        passed = false;
+      }
+    }
+    return passed;
+  }
+
+  /** Geometry of a size, e.g. 2048x128. */
+  template <typename TSize>
+  static std::string
+  GetGeometry(const TSize & size)
+  {
+    std::ostringstream geometry;
+    for (unsigned int dimension = 0; dimension < TSize::Dimension; ++dimension)
+    {
+      geometry << (dimension > 0 ? "x" : "") << size[dimension];
+    }
+    return geometry.str();
+  }
+
+  /** Allocate an image and fill it with a deterministic RF-like signal: a
+   * carrier at a fifth of the sampling frequency along the first dimension,
+   * with a random speckle amplitude. */
+  template <typename TImage>
+  static typename TImage::Pointer
+  MakeRF(const typename TImage::SizeType & size)
+  {
+    typename TImage::Pointer image = TImage::New();
+    image->SetRegions(typename TImage::RegionType(size));
+    image->Allocate();
+
+    std::mt19937                         generator(42);
+    std::normal_distribution<double>     speckle(0.0, 100.0);
+    ImageRegionIteratorWithIndex<TImage> it(image, image->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const double carrier = std::sin(2.0 * Math::pi * 0.2 * it.GetIndex()[0]);
+      it.Set(static_cast<typename TImage::PixelType>(speckle(generator) * carrier));
+    }
+    return image;
+  }
+
+private:
+  std::string             m_Suite;
+  std::vector<ResultType> m_Results;
+};
+
+} // end namespace UltrasoundBenchmark
+} // end namespace itk
+
+#endif // itkUltrasoundBenchmark_h
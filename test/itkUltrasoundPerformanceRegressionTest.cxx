@@ -0,0 +1,206 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Gate the run times of the B-Mode, Spectra1D and block matching stages on
+// a baseline of the machine class.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMultiThreaderBase.h"
+#include "itkVector.h"
+#include "itkVectorImage.h"
+
+#include "itkBModeImageFilter.h"
+#include "itkBlockMatchingImageRegistrationMethod.h"
+#include "itkBlockMatchingNormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter.h"
+#include "itkBlockMatchingSearchRegionImageInitializer.h"
+#include "itkSpectra1DImageFilter.h"
+#include "itkSpectra1DSupportWindowImageFilter.h"
+#include "itkUltrasoundBenchmark.h"
+
+int
+itkUltrasoundPerformanceRegressionTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " baselineFile measuredFile tolerance [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string  baselineFileName = argv[1];
+  const std::string  measuredFileName = argv[2];
+  const double       tolerance = std::stod(argv[3]);
+  const unsigned int repetitions = (argc > 4) ? std::stoi(argv[4]) : 5;
+
+  const unsigned int Dimension = 2;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+  HarnessType harness("PerformanceRegression");
+
+  // Single threaded, for the kernels, and with all the threads, for the
+  // scaling.
+  std::vector<unsigned int> threadCounts{ 1 };
+  if (itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads() > 1)
+  {
+    threadCounts.push_back(itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+  }
+
+  try
+  {
+    // B-Mode of a float RF frame.
+    using ImageType = itk::Image<float, Dimension>;
+    ImageType::SizeType frameSize;
+    frameSize[0] = 2048;
+    frameSize[1] = 256;
+    ImageType::Pointer frame = HarnessType::MakeRF<ImageType>(frameSize);
+    using BModeFilterType = itk::BModeImageFilter<ImageType, ImageType>;
+
+    // Spectra of a short RF frame.
+    using RFImageType = itk::Image<short, Dimension>;
+    RFImageType::SizeType rfSize;
+    rfSize[0] = 2048;
+    rfSize[1] = 128;
+    RFImageType::Pointer rf = HarnessType::MakeRF<RFImageType>(rfSize);
+    RFImageType::Pointer sideLines = RFImageType::New();
+    sideLines->CopyInformation(rf);
+    sideLines->SetRegions(rf->GetLargestPossibleRegion());
+    sideLines->Allocate();
+    sideLines->FillBuffer(5);
+    using SupportWindowFilterType = itk::Spectra1DSupportWindowImageFilter<RFImageType>;
+    SupportWindowFilterType::Pointer supportWindowFilter = SupportWindowFilterType::New();
+    supportWindowFilter->SetInput(sideLines);
+    supportWindowFilter->SetFFT1DSize(128);
+    supportWindowFilter->SetStep(16);
+    supportWindowFilter->UpdateLargestPossibleRegion();
+    using SupportWindowImageType = SupportWindowFilterType::OutputImageType;
+    using SpectraImageType = itk::VectorImage<float, Dimension>;
+    using SpectraFilterType = itk::Spectra1DImageFilter<RFImageType, SupportWindowImageType, SpectraImageType>;
+
+    // Block matching of the short RF frame with itself moved by three
+    // samples axially.
+    RFImageType::SizeType matchingSize;
+    matchingSize[0] = 1024;
+    matchingSize[1] = 128;
+    RFImageType::Pointer fixed = HarnessType::MakeRF<RFImageType>(matchingSize);
+    RFImageType::Pointer moving = RFImageType::New();
+    moving->SetRegions(fixed->GetLargestPossibleRegion());
+    moving->Allocate();
+    itk::ImageRegionIteratorWithIndex<RFImageType> movingIt(moving, moving->GetLargestPossibleRegion());
+    for (movingIt.GoToBegin(); !movingIt.IsAtEnd(); ++movingIt)
+    {
+      RFImageType::IndexType index = movingIt.GetIndex();
+      index[0] = std::max<itk::IndexValueType>(index[0] - 3, 0);
+      movingIt.Set(fixed->GetPixel(index));
+    }
+    RFImageType::SizeType blockRadius;
+    blockRadius[0] = 20;
+    blockRadius[1] = 4;
+    RFImageType::SizeType searchRadius;
+    searchRadius[0] = 30;
+    searchRadius[1] = 5;
+    using SearchRegionInitializerType = itk::BlockMatching::SearchRegionImageInitializer<RFImageType, RFImageType>;
+    SearchRegionInitializerType::Pointer searchRegions = SearchRegionInitializerType::New();
+    searchRegions->SetFixedImage(fixed);
+    searchRegions->SetMovingImage(moving);
+    searchRegions->SetFixedBlockRadius(blockRadius);
+    searchRegions->SetSearchRegionRadius(searchRadius);
+    using MetricImageType = itk::Image<double, Dimension>;
+    using DisplacementImageType = itk::Image<itk::Vector<double, Dimension>, Dimension>;
+    using RegistrationMethodType = itk::BlockMatching::
+      ImageRegistrationMethod<RFImageType, RFImageType, MetricImageType, DisplacementImageType, double>;
+    using MetricImageFilterType = itk::BlockMatching::
+      NormalizedCrossCorrelationNeighborhoodIteratorMetricImageFilter<RFImageType, RFImageType, MetricImageType>;
+
+    for (const unsigned int threads : threadCounts)
+    {
+      BModeFilterType::Pointer bMode = BModeFilterType::New();
+      bMode->SetInput(frame);
+      HarnessType::SetThreads(bMode, threads);
+      harness.Run("BMode",
+                  HarnessType::GetGeometry(frameSize),
+                  threads,
+                  static_cast<double>(frameSize[0] * frameSize[1]),
+                  repetitions,
+                  [&bMode]() {
+                    bMode->Modified();
+                    bMode->Update();
+                  });
+
+      SpectraFilterType::Pointer spectraFilter = SpectraFilterType::New();
+      spectraFilter->SetInput(rf);
+      spectraFilter->SetSupportWindowImage(supportWindowFilter->GetOutput());
+      HarnessType::SetThreads(spectraFilter, threads);
+      harness.Run("Spectra1D",
+                  HarnessType::GetGeometry(rfSize),
+                  threads,
+                  static_cast<double>(rfSize[0] * rfSize[1]),
+                  repetitions,
+                  [&spectraFilter]() {
+                    spectraFilter->Modified();
+                    spectraFilter->UpdateLargestPossibleRegion();
+                  });
+
+      RegistrationMethodType::Pointer registrationMethod = RegistrationMethodType::New();
+      registrationMethod->SetFixedImage(fixed);
+      registrationMethod->SetMovingImage(moving);
+      registrationMethod->SetInput(searchRegions->GetOutput());
+      registrationMethod->SetRadius(blockRadius);
+      registrationMethod->SetMetricImageFilter(MetricImageFilterType::New());
+      registrationMethod->ParallelizeBlocksOn();
+      HarnessType::SetThreads(registrationMethod, threads);
+      harness.Run("BlockMatching",
+                  HarnessType::GetGeometry(matchingSize),
+                  threads,
+                  static_cast<double>(matchingSize[0] * matchingSize[1]),
+                  repetitions,
+                  [&registrationMethod]() {
+                    registrationMethod->Modified();
+                    registrationMethod->Update();
+                  });
+    }
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The measured run times can be copied as the baseline of the machine
+  // class.
+  if (!harness.WriteBaseline(measuredFileName))
+  {
+    return EXIT_FAILURE;
+  }
+  if (!std::ifstream(baselineFileName.c_str()))
+  {
+    std::cerr << "There is no baseline " << baselineFileName << " for this machine class. Copy " << measuredFileName
+              << " there after checking it." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (!harness.CompareToBaseline(baselineFileName, tolerance))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
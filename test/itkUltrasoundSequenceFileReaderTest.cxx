@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include <sstream>
+
+#include "itkHDF5UltrasoundImageIO.h"
+#include "itkImage.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+#include "itkVideoStream.h"
+
+#include "itkUltrasoundSequenceFileReader.h"
+
+namespace
+{
+
+const unsigned int Dimension = 2;
+using PixelType = float;
+using FrameType = itk::Image<PixelType, Dimension>;
+using VideoStreamType = itk::VideoStream<FrameType>;
+using ReaderType = itk::UltrasoundSequenceFileReader<VideoStreamType>;
+
+PixelType
+pixelValue(const itk::IndexValueType frame, const FrameType::IndexType & index)
+{
+  return static_cast<PixelType>(10000 * frame + 100 * index[1] + index[0]);
+}
+
+// Read every frame, in order, and check the values.
+int
+readFrames(ReaderType * reader, itk::SizeValueType numberOfFrames)
+{
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->UpdateOutputInformation());
+  ITK_TEST_EXPECT_EQUAL(reader->GetNumberOfFrames(), numberOfFrames);
+  for (itk::SizeValueType frame = 0; frame < numberOfFrames; ++frame)
+  {
+    itk::TemporalRegion requestedTemporalRegion;
+    requestedTemporalRegion.SetFrameStart(frame);
+    requestedTemporalRegion.SetFrameDuration(1);
+    reader->GetOutput()->SetRequestedTemporalRegion(requestedTemporalRegion);
+    ITK_TRY_EXPECT_NO_EXCEPTION(reader->Update());
+
+    const FrameType *                                frameImage = reader->GetOutput()->GetFrame(frame);
+    itk::ImageRegionConstIteratorWithIndex<FrameType> it(frameImage, frameImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (it.Get() != pixelValue(frame, it.GetIndex()))
+      {
+        std::cerr << "Mismatch in frame " << frame << " at " << it.GetIndex() << ": " << it.Get() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int
+itkUltrasoundSequenceFileReaderTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " outputPrefix" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string outputPrefix = argv[1];
+
+  const itk::SizeValueType numberOfFrames = 5;
+  FrameType::SizeType      size;
+  size[0] = 32;
+  size[1] = 12;
+
+  // One file per frame.
+  ReaderType::FileNamesContainer fileNames;
+  for (itk::SizeValueType frame = 0; frame < numberOfFrames; ++frame)
+  {
+    FrameType::Pointer frameImage = FrameType::New();
+    frameImage->SetRegions(size);
+    frameImage->Allocate();
+    itk::ImageRegionIteratorWithIndex<FrameType> it(frameImage, frameImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      it.Set(pixelValue(frame, it.GetIndex()));
+    }
+    std::ostringstream fileName;
+    fileName << outputPrefix << "Frame" << frame << ".mha";
+    fileNames.push_back(fileName.str());
+    ITK_TRY_EXPECT_NO_EXCEPTION(itk::WriteImage(frameImage, fileNames.back()));
+  }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(reader, UltrasoundSequenceFileReader, VideoSource);
+  ITK_TEST_SET_GET_BOOLEAN(reader, UsePrefetch, true);
+  reader->SetFileNames(fileNames);
+  if (readFrames(reader, numberOfFrames) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The frames along the last direction of a single file.
+  using VolumeType = itk::Image<PixelType, Dimension + 1>;
+  VolumeType::Pointer  volume = VolumeType::New();
+  VolumeType::SizeType volumeSize;
+  volumeSize[0] = size[0];
+  volumeSize[1] = size[1];
+  volumeSize[2] = numberOfFrames;
+  volume->SetRegions(volumeSize);
+  volume->Allocate();
+  itk::ImageRegionIteratorWithIndex<VolumeType> volumeIt(volume, volume->GetLargestPossibleRegion());
+  for (volumeIt.GoToBegin(); !volumeIt.IsAtEnd(); ++volumeIt)
+  {
+    const VolumeType::IndexType & index = volumeIt.GetIndex();
+    FrameType::IndexType          frameIndex;
+    frameIndex[0] = index[0];
+    frameIndex[1] = index[1];
+    volumeIt.Set(pixelValue(index[2], frameIndex));
+  }
+  const std::string volumeFileName = outputPrefix + "Volume.mha";
+  ITK_TRY_EXPECT_NO_EXCEPTION(itk::WriteImage(volume, volumeFileName));
+
+  ReaderType::Pointer volumeReader = ReaderType::New();
+  volumeReader->SetFileName(volumeFileName);
+  volumeReader->UsePrefetchOff();
+  if (readFrames(volumeReader, numberOfFrames) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The frames of an HDF5 file are only prefetched with a thread safe HDF5
+  // library, and are read the same either way.
+  std::cout << "HDF5 library thread safe: " << itk::HDF5UltrasoundImageIO::IsLibraryThreadSafe() << std::endl;
+  const std::string hdf5VolumeFileName = outputPrefix + "Volume.hdf5";
+  using WriterType = itk::ImageFileWriter<VolumeType>;
+  WriterType::Pointer hdf5Writer = WriterType::New();
+  hdf5Writer->SetInput(volume);
+  hdf5Writer->SetFileName(hdf5VolumeFileName);
+  hdf5Writer->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  ITK_TRY_EXPECT_NO_EXCEPTION(hdf5Writer->Update());
+
+  ReaderType::Pointer hdf5Reader = ReaderType::New();
+  hdf5Reader->SetFileName(hdf5VolumeFileName);
+  hdf5Reader->SetImageIO(itk::HDF5UltrasoundImageIO::New());
+  ITK_TEST_EXPECT_TRUE(hdf5Reader->GetUsePrefetch());
+  if (readFrames(hdf5Reader, numberOfFrames) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "itkUltrasoundTrace.h"
+
+int
+itkUltrasoundTraceTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " traceFile";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string traceFileName = argv[1];
+
+  using TraceType = itk::UltrasoundTrace;
+
+  TraceType::Clear();
+
+  // Nothing is recorded while tracing is disabled.
+  TraceType::SetEnabled(false);
+  {
+    const TraceType::Scope scope("Disabled");
+  }
+  if (TraceType::GetNumberOfEvents() != 0)
+  {
+    std::cerr << "Expected no events while disabled" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Events are kept per thread.
+  TraceType::SetEnabled(true);
+  const unsigned int       numberOfThreads = 4;
+  const unsigned int       scopesPerThread = 100;
+  std::vector<std::thread> threads;
+  for (unsigned int ii = 0; ii < numberOfThreads; ++ii)
+  {
+    threads.emplace_back([scopesPerThread]() {
+      for (unsigned int jj = 0; jj < scopesPerThread; ++jj)
+      {
+        const TraceType::Scope scope("Worker");
+      }
+    });
+  }
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+  if (TraceType::GetNumberOfEvents() != numberOfThreads * scopesPerThread)
+  {
+    std::cerr << "Expected " << numberOfThreads * scopesPerThread << " events, got "
+              << TraceType::GetNumberOfEvents() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!TraceType::WriteChromeTrace(traceFileName))
+  {
+    std::cerr << "Could not write " << traceFileName << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::ifstream     traceFile(traceFileName.c_str());
+  std::stringstream trace;
+  trace << traceFile.rdbuf();
+  if (trace.str().find("\"traceEvents\"") == std::string::npos ||
+      trace.str().find("\"name\": \"Worker\"") == std::string::npos)
+  {
+    std::cerr << "Unexpected trace contents:\n" << trace.str() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A callback receives the events instead.
+  TraceType::Clear();
+  std::atomic<unsigned int> forwarded(0);
+  TraceType::SetCallback([&forwarded](const TraceType::EventType & event) {
+    if (std::string(event.Name) == "Callback" && event.Duration >= 0)
+    {
+      ++forwarded;
+    }
+  });
+  {
+    const TraceType::Scope scope("Callback");
+  }
+  TraceType::SetCallback(TraceType::CallbackType());
+  TraceType::SetEnabled(false);
+  if (forwarded.load() != 1 || TraceType::GetNumberOfEvents() != 0)
+  {
+    std::cerr << "Expected the event to be forwarded to the callback" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Throughput of the export of special coordinates images to VTK.
+
+#include <iostream>
+#include <string>
+
+#include "itkCurvilinearArraySpecialCoordinatesImage.h"
+#include "itkSpecialCoordinatesImageToVTKStructuredGridFilter.h"
+
+#include "itkUltrasoundBenchmark.h"
+
+int
+itkVTKExportBenchmark(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " outputJSON [repetitions]";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+  }
+  const unsigned int repetitions = (argc > 2) ? std::stoi(argv[2]) : 10;
+
+  const unsigned int Dimension = 3;
+  using PixelType = unsigned char;
+  using SpecialCoordinatesImageType = itk::CurvilinearArraySpecialCoordinatesImage<PixelType, Dimension>;
+  using ConversionFilterType = itk::SpecialCoordinatesImageToVTKStructuredGridFilter<SpecialCoordinatesImageType>;
+  using HarnessType = itk::UltrasoundBenchmark::Harness;
+
+  HarnessType harness("VTKExport");
+
+  try
+  {
+    // A volume of curvilinear array frames.
+    SpecialCoordinatesImageType::SizeType size;
+    size[0] = 1024;
+    size[1] = 128;
+    size[2] = 32;
+    SpecialCoordinatesImageType::Pointer image = HarnessType::MakeRF<SpecialCoordinatesImageType>(size);
+    image->SetLateralAngularSeparation((itk::Math::pi / 2.0) / (size[1] - 1));
+    image->SetRadiusSampleSize(0.05);
+    image->SetFirstSampleDistance(10.0);
+    const double samples = static_cast<double>(size[0] * size[1] * size[2]);
+
+    for (const unsigned int threads : HarnessType::GetThreadCounts())
+    {
+      ConversionFilterType::Pointer conversionFilter = ConversionFilterType::New();
+      conversionFilter->SetInput(image);
+      HarnessType::SetThreads(conversionFilter, threads);
+      harness.Run("SpecialCoordinatesImageToVTKStructuredGrid",
+                  HarnessType::GetGeometry(size),
+                  threads,
+                  samples,
+                  repetitions,
+                  [&conversionFilter]() {
+                    conversionFilter->Modified();
+                    conversionFilter->Update();
+                  });
+    }
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!harness.WriteJSON(argv[1]))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <complex>
+#include <iostream>
+
+#include "itkImage.h"
+#include "itkImageRegionIterator.h"
+
+#include "itkOpenCLForward1DFFTImageFilter.h"
+
+int
+itkclFFTPlanCacheTest(int, char *[])
+{
+  using PixelType = float;
+  const unsigned int Dimension = 2;
+
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PixelType>, Dimension>;
+  using ForwardType = itk::OpenCLForward1DFFTImageFilter<ImageType, ComplexImageType>;
+  using TransformType = itk::OpenCL1DFFTBatchedTransform<PixelType>;
+
+  ImageType::SizeType size;
+  size[0] = 128;
+  size[1] = 100;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+  unsigned int                        count = 0;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++count)
+  {
+    it.Set(static_cast<PixelType>(count % 7) - 3.0f);
+  }
+
+  try
+  {
+    itk::clFFTInitializer & initializer = itk::clFFFInitialization();
+    initializer.ClearPlans();
+
+    // 100 lines in 6 batches of 17 lines, but the last one of 15 lines,
+    // forward and backward.
+    const unsigned int numberOfBatches = 6;
+    TransformType::BakePlans(size[0], size[1], numberOfBatches);
+    const size_t bakedPlans = 2 * (TransformType::NumberOfQueues + 1);
+    if (initializer.GetNumberOfPlans() != bakedPlans)
+    {
+      std::cerr << "Expected " << bakedPlans << " baked plans, got " << initializer.GetNumberOfPlans() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The filters of the baked geometry are served from the cache.
+    for (unsigned int frame = 0; frame < 2; ++frame)
+    {
+      ForwardType::Pointer forward = ForwardType::New();
+      forward->SetInput(image);
+      forward->SetNumberOfBatches(numberOfBatches);
+      forward->Update();
+    }
+    if (initializer.GetNumberOfPlans() != bakedPlans)
+    {
+      std::cerr << "Expected the filters to use the baked plans" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    initializer.ClearPlans();
+    if (initializer.GetNumberOfPlans() != 0)
+    {
+      std::cerr << "ClearPlans() did not empty the plan cache" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  catch (itk::ExceptionObject & excep)
+  {
+    std::cerr << "Exception caught !" << std::endl;
+    std::cerr << excep << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
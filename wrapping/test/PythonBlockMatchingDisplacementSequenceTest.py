@@ -0,0 +1,53 @@
+#==========================================================================
+#
+#   Copyright NumFOCUS
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          http://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+#==========================================================================*/
+
+
+#
+#  Compute the displacements and strains of a stack of RF frames in one call,
+#  and read an HDF5 ultrasound file with the wrapped image IO
+#
+
+import itk
+import numpy as np
+from sys import argv
+
+pre_filename = argv[1]
+post_filename = argv[2]
+
+pre = itk.array_from_image(itk.imread(pre_filename, itk.SS))
+post = itk.array_from_image(itk.imread(post_filename, itk.SS))
+
+# Frames along the first NumPy axis, the last ITK direction
+frames = np.ascontiguousarray(np.stack([pre, post, pre]))
+stack = itk.image_view_from_array(frames)
+
+SequenceFilterType = itk.DisplacementSequenceImageFilter[itk.SS, itk.F, 2]
+sequence_filter = SequenceFilterType.New(Input=stack)
+sequence_filter.ComputeStrainOn()
+sequence_filter.Update()
+
+displacements = itk.array_view_from_image(sequence_filter.GetOutput())
+strains = itk.array_view_from_image(sequence_filter.GetStrainOutput())
+print("Displacements: {}, strains: {}".format(displacements.shape, strains.shape))
+assert displacements.shape[0] == 2 and displacements.shape[-1] == 2, displacements.shape
+assert strains.shape[:-1] == displacements.shape[:-1] and strains.shape[-1] == 3, strains.shape
+assert np.all(np.isfinite(displacements))
+
+# The HDF5 ultrasound image IO can be given to the readers
+image_io = itk.HDF5UltrasoundImageIO.New()
+assert not image_io.CanReadFile(pre_filename)
@@ -0,0 +1,130 @@
+#==========================================================================
+#
+#   Copyright NumFOCUS
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          http://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+#==========================================================================*/
+
+
+#
+#  Check that NumPy arrays go in and out of the ultrasound filters as
+#  zero-copy views, and that Update() lets other Python threads run
+#
+
+import threading
+import time
+from sys import argv
+
+import itk
+import numpy as np
+
+# Whether the wrapping releases the GIL, ITK_PYTHON_RELEASE_GIL, which is not
+# reported by itk at run time
+release_gil = len(argv) < 2 or argv[1].upper() not in ("0", "OFF", "FALSE", "NO")
+
+itk.auto_progress(0)
+
+rng = np.random.default_rng(42)
+axial = np.arange(512, dtype=np.float32)
+rf_array = np.ascontiguousarray(
+    np.sin(0.2 * np.pi * axial)[np.newaxis, np.newaxis, :] * rng.standard_normal((4, 32, 1)).astype(np.float32),
+    dtype=np.float32,
+)
+
+# Views in: the image shares the NumPy buffer
+rf_image = itk.image_view_from_array(rf_array)
+assert np.shares_memory(itk.array_view_from_image(rf_image), rf_array)
+
+# Complex analytic signal out, as complex64
+analytic_image = itk.analytic_signal_image_filter(rf_image, direction=0)
+analytic_array = itk.array_view_from_image(analytic_image)
+assert analytic_array.dtype == np.complex64, analytic_array.dtype
+assert analytic_array.shape == rf_array.shape, analytic_array.shape
+assert np.allclose(analytic_array.real, rf_array, atol=1e-3 * np.abs(rf_array).max())
+
+# B-mode and time gain compensation out, as float32 views of the filter outputs
+ImageType = itk.Image[itk.F, 3]
+bmode_filter = itk.BModeImageFilter[ImageType, ImageType].New(Input=rf_image, Direction=0)
+bmode_filter.Update()
+bmode_image = bmode_filter.GetOutput()
+bmode_image.DisconnectPipeline()
+bmode_array = itk.array_view_from_image(bmode_image)
+assert bmode_array.dtype == np.float32 and bmode_array.shape == rf_array.shape
+
+tgc_filter = itk.TimeGainCompensationImageFilter[ImageType].New(Input=rf_image)
+tgc_filter.Update()
+tgc_array = itk.array_view_from_image(tgc_filter.GetOutput())
+assert tgc_array.dtype == np.float32 and tgc_array.shape == rf_array.shape
+
+# Spectra out, as (y, x, bins) and (z, y, x, bins) views of the VectorImage
+def spectra_view(rf_short_array):
+    dimension = rf_short_array.ndim
+    RFImageType = itk.Image[itk.SS, dimension]
+    rf_short_image = itk.image_view_from_array(rf_short_array)
+    side_lines = itk.image_view_from_array(np.full(rf_short_array.shape, 5, dtype=np.int16))
+    side_lines.CopyInformation(rf_short_image)
+    support_window_filter = itk.Spectra1DSupportWindowImageFilter[RFImageType].New(
+        Input=side_lines, FFT1DSize=64, Step=16
+    )
+    support_window_filter.Update()
+    SupportWindowImageType = type(support_window_filter.GetOutput())
+    SpectraImageType = itk.VectorImage[itk.F, dimension]
+    spectra_filter = itk.Spectra1DImageFilter[RFImageType, SupportWindowImageType, SpectraImageType].New()
+    spectra_filter.SetInput(rf_short_image)
+    spectra_filter.SetSupportWindowImage(support_window_filter.GetOutput())
+    spectra_filter.Update()
+    spectra_image = spectra_filter.GetOutput()
+    spectra_array = itk.array_view_from_image(spectra_image)
+    size = itk.size(spectra_image)
+    assert spectra_array.dtype == np.float32
+    expected_shape = tuple(reversed(tuple(size))) + (spectra_image.GetNumberOfComponentsPerPixel(),)
+    assert spectra_array.shape == expected_shape, spectra_array.shape
+
+    # The array is a view of the output buffer: a second view shares its
+    # memory, and writes through it reach the image.
+    assert np.shares_memory(spectra_array, itk.array_view_from_image(spectra_image))
+    spectra_array[(0,) * (dimension + 1)] = 123.0
+    assert spectra_image.GetPixel([0] * dimension)[0] == 123.0
+
+
+rf_short_array = np.ascontiguousarray((1000.0 * rf_array).astype(np.int16))
+spectra_view(np.ascontiguousarray(rf_short_array[0]))
+spectra_view(rf_short_array)
+
+# Python threads keep running while a filter updates
+large_rf_image = itk.image_view_from_array(np.tile(rf_array, (16, 4, 1)))
+large_bmode_filter = itk.BModeImageFilter[ImageType, ImageType].New(Input=large_rf_image, Direction=0)
+ticks = []
+updating = threading.Event()
+
+
+def count_ticks():
+    updating.wait()
+    while updating.is_set():
+        ticks.append(time.perf_counter())
+        time.sleep(0.0001)
+
+
+counter = threading.Thread(target=count_ticks)
+counter.start()
+updating.set()
+update_start = time.perf_counter()
+large_bmode_filter.Update()
+update_end = time.perf_counter()
+updating.clear()
+counter.join()
+update_ticks = sum(1 for tick in ticks if update_start <= tick <= update_end)
+print("Python thread ticks during Update(): {} in {:.3f} s".format(update_ticks, update_end - update_start))
+if release_gil:
+    assert update_ticks > 10, update_ticks